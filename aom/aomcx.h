@@ -1570,6 +1570,40 @@ enum aome_enc_control_id {
    */
   AV1E_SET_MAX_CONSEC_FRAME_DROP_MS_CBR = 169,
 
+  /*!\brief Codec control to get the usage of the scratch memory the encoder
+   * reserves for its per-frame and per-GOP working buffers,
+   * aom_scratch_mem_stats_t * parameter.
+   *
+   * The scratch memory grows to the peak requirement of the encoder and is
+   * then reused, so that the encoder stops allocating these buffers once the
+   * counters stabilize.
+   */
+  AV1E_GET_SCRATCH_MEM_STATS = 170,
+
+  /*!\brief Codec control to let the encoder reference the images passed to
+   * aom_codec_encode() instead of copying them, aom_input_buffer_cb_t *
+   * parameter.
+   *
+   * While set, the encoder keeps pointers to the planes of the input images
+   * and calls aom_input_buffer_cb_t::release_cb once for every image passed
+   * to aom_codec_encode(), when it no longer reads it. The application must
+   * not modify or free the image data until then. The aom_image_t structure
+   * itself is not referenced after aom_codec_encode() returns.
+   *
+   * The encoder extends the image into the border declared by
+   * aom_input_buffer_cb_t::border, which must be allocated on all sides of
+   * each plane, e.g. with aom_img_alloc_with_border(). Images that cannot be
+   * referenced, because of their format, size or border, are copied as
+   * without this control and released before aom_codec_encode() returns, as
+   * are images not queued because aom_codec_encode() failed. The images still
+   * held by the encoder are released by aom_codec_destroy().
+   *
+   * A NULL parameter, or a NULL release_cb, restores the default behavior of
+   * copying the input images. Images referenced earlier are still released
+   * through the callback they were passed with.
+   */
+  AV1E_SET_INPUT_BUFFER_CB = 171,
+
   // Any new encoder control IDs should be added above.
   // Maximum allowed encoder control ID is 229.
   // No encoder control ID should be added below.
@@ -1631,6 +1665,39 @@ typedef struct aom_active_map {
   unsigned int cols; /**< number of cols */
 } aom_active_map_t;
 
+/*!\brief Scratch memory statistics of the encoder
+ *
+ * Returned by #AV1E_GET_SCRATCH_MEM_STATS. Sizes are in bytes. When frames are
+ * encoded in parallel, the values of all the frame contexts are summed.
+ */
+typedef struct aom_scratch_mem_stats {
+  size_t frame_peak;     /**< Peak usage of the per-frame scratch memory */
+  size_t frame_reserved; /**< Per-frame scratch memory held by the encoder */
+  size_t gop_peak;       /**< Peak usage of the per-GOP scratch memory */
+  size_t gop_reserved;   /**< Per-GOP scratch memory held by the encoder */
+  /*! Number of times scratch memory was allocated from the system. */
+  unsigned int num_system_allocs;
+} aom_scratch_mem_stats_t;
+
+/*!\brief Callback releasing an input image
+ *
+ * \param[in] cb_priv    aom_input_buffer_cb_t::cb_priv
+ * \param[in] user_priv  aom_image_t::user_priv of the released image
+ */
+typedef void (*aom_release_input_buffer_cb_fn_t)(void *cb_priv,
+                                                 void *user_priv);
+
+/*!\brief Input buffer callback of the encoder
+ *
+ * Set with #AV1E_SET_INPUT_BUFFER_CB.
+ */
+typedef struct aom_input_buffer_cb {
+  aom_release_input_buffer_cb_fn_t release_cb; /**< Release callback */
+  void *cb_priv; /**< Private data passed to release_cb */
+  /*! Border, in luma pixels, allocated around each plane of the images. */
+  unsigned int border;
+} aom_input_buffer_cb_t;
+
 /*!\brief  aom image scaling mode
  *
  * This defines the data structure for image scaling mode
@@ -2239,6 +2306,12 @@ AOM_CTRL_USE_TYPE(AV1E_SET_POSTENCODE_DROP_RTC, int)
 AOM_CTRL_USE_TYPE(AV1E_SET_MAX_CONSEC_FRAME_DROP_MS_CBR, int)
 #define AOM_CTRL_AV1E_SET_MAX_CONSEC_FRAME_DROP_MS_CBR
 
+AOM_CTRL_USE_TYPE(AV1E_GET_SCRATCH_MEM_STATS, aom_scratch_mem_stats_t *)
+#define AOM_CTRL_AV1E_GET_SCRATCH_MEM_STATS
+
+AOM_CTRL_USE_TYPE(AV1E_SET_INPUT_BUFFER_CB, aom_input_buffer_cb_t *)
+#define AOM_CTRL_AV1E_SET_INPUT_BUFFER_CB
+
 /*!\endcond */
 /*! @} - end defgroup aom_encoder */
 #ifdef __cplusplus
@@ -466,6 +466,27 @@ enum aom_dec_control_id {
    * be used.
    */
   AV1D_GET_MI_INFO,
+
+  /*!\brief Codec control function to set the number of temporal units that
+   * are decoded in parallel, unsigned int parameter
+   *
+   * - 0 or 1 = disabled (default)
+   * - 2 to 8 = number of temporal units in flight
+   *
+   * Frame parallel decoding delays the output: aom_codec_get_frame() only
+   * returns the frames of a temporal unit once the given number of later
+   * temporal units has been passed to aom_codec_decode(), or once the decoder
+   * has been flushed. Decoding errors are reported by aom_codec_get_frame()
+   * returning NULL rather than by aom_codec_decode(). The decoder threads set
+   * by aom_codec_dec_cfg_t::threads are split between the temporal units.
+   *
+   * \note Must be called before the first call to aom_codec_decode(). Large
+   * scale tile decoding, external references, the inspection callback and
+   * AV1_SET_REFERENCE are not supported in this mode. Applications that
+   * provide external frame buffers must allow for #AOM_MAXIMUM_REF_BUFFERS +
+   * #AOM_MAXIMUM_WORK_BUFFERS additional buffers per temporal unit in flight.
+   */
+  AV1D_SET_FRAME_PARALLEL,
 };
 
 /*!\cond */
@@ -595,6 +616,9 @@ AOM_CTRL_USE_TYPE(AOMD_GET_BASE_Q_IDX, int *)
 AOM_CTRL_USE_TYPE(AOMD_GET_ORDER_HINT, unsigned int *)
 #define AOM_CTRL_AOMD_GET_ORDER_HINT
 
+AOM_CTRL_USE_TYPE(AV1D_SET_FRAME_PARALLEL, unsigned int)
+#define AOM_CTRL_AV1D_SET_FRAME_PARALLEL
+
 // The AOM_CTRL_USE_TYPE macro can't be used with AV1D_GET_MI_INFO because
 // AV1D_GET_MI_INFO takes more than one parameter.
 #define AOM_CTRL_AV1D_GET_MI_INFO
@@ -260,6 +260,10 @@ if(CONFIG_AV1_ENCODER)
               "${AOM_ROOT}/aom_dsp/x86/blk_sse_sum_avx2.c"
               "${AOM_ROOT}/aom_dsp/x86/sum_squares_avx2.c")
 
+  list(APPEND AOM_DSP_ENCODER_INTRIN_AVX512
+              "${AOM_ROOT}/aom_dsp/x86/sad4d_avx512.c"
+              "${AOM_ROOT}/aom_dsp/x86/variance_avx512.c")
+
   list(APPEND AOM_DSP_ENCODER_INTRIN_AVX
               "${AOM_ROOT}/aom_dsp/x86/aom_quantize_avx.c")
 
@@ -326,6 +330,9 @@ if(CONFIG_AV1_ENCODER)
                 "${AOM_ROOT}/aom_dsp/x86/highbd_sad_avx2.c"
                 "${AOM_ROOT}/aom_dsp/x86/highbd_variance_avx2.c")
 
+    list(APPEND AOM_DSP_ENCODER_INTRIN_AVX512
+                "${AOM_ROOT}/aom_dsp/x86/highbd_sad_avx512.c")
+
     list(APPEND AOM_DSP_ENCODER_INTRIN_SSE4_1
                 "${AOM_ROOT}/aom_dsp/x86/highbd_variance_sse4.c")
 
@@ -483,6 +490,14 @@ function(setup_aom_dsp_targets)
     endif()
   endif()
 
+  if(HAVE_AVX512)
+    if(CONFIG_AV1_ENCODER)
+      add_intrinsics_object_library("${AOM_AVX512_INTRIN_FLAG}" "avx512"
+                                    "aom_dsp_encoder"
+                                    "AOM_DSP_ENCODER_INTRIN_AVX512")
+    endif()
+  endif()
+
   if(HAVE_NEON)
     add_intrinsics_object_library("${AOM_NEON_INTRIN_FLAG}" "neon"
                                   "aom_dsp_common" "AOM_DSP_COMMON_INTRIN_NEON")
@@ -923,14 +923,14 @@ if (aom_config("CONFIG_AV1_ENCODER") eq "yes") {
       }
       add_proto qw/unsigned int/, "aom_highbd_dist_wtd_sad${w}x${h}_avg", "const uint8_t *src_ptr, int src_stride, const uint8_t *ref_ptr, int ref_stride, const uint8_t *second_pred, const DIST_WTD_COMP_PARAMS* jcp_param";
     }
-    specialize qw/aom_highbd_sad128x128 avx2      neon/;
-    specialize qw/aom_highbd_sad128x64  avx2      neon/;
-    specialize qw/aom_highbd_sad64x128  avx2      neon/;
-    specialize qw/aom_highbd_sad64x64   avx2 sse2 neon/;
-    specialize qw/aom_highbd_sad64x32   avx2 sse2 neon/;
-    specialize qw/aom_highbd_sad32x64   avx2 sse2 neon/;
-    specialize qw/aom_highbd_sad32x32   avx2 sse2 neon/;
-    specialize qw/aom_highbd_sad32x16   avx2 sse2 neon/;
+    specialize qw/aom_highbd_sad128x128 avx2 avx512      neon/;
+    specialize qw/aom_highbd_sad128x64  avx2 avx512      neon/;
+    specialize qw/aom_highbd_sad64x128  avx2 avx512      neon/;
+    specialize qw/aom_highbd_sad64x64   avx2 avx512 sse2 neon/;
+    specialize qw/aom_highbd_sad64x32   avx2 avx512 sse2 neon/;
+    specialize qw/aom_highbd_sad32x64   avx2 avx512 sse2 neon/;
+    specialize qw/aom_highbd_sad32x32   avx2 avx512 sse2 neon/;
+    specialize qw/aom_highbd_sad32x16   avx2 avx512 sse2 neon/;
     specialize qw/aom_highbd_sad16x32   avx2 sse2 neon/;
     specialize qw/aom_highbd_sad16x16   avx2 sse2 neon/;
     specialize qw/aom_highbd_sad16x8    avx2 sse2 neon/;
@@ -943,18 +943,18 @@ if (aom_config("CONFIG_AV1_ENCODER") eq "yes") {
     specialize qw/aom_highbd_sad4x16         sse2 neon/;
     specialize qw/aom_highbd_sad16x4    avx2 sse2 neon/;
     specialize qw/aom_highbd_sad8x32         sse2 neon/;
-    specialize qw/aom_highbd_sad32x8    avx2 sse2 neon/;
+    specialize qw/aom_highbd_sad32x8    avx2 avx512 sse2 neon/;
     specialize qw/aom_highbd_sad16x64   avx2 sse2 neon/;
-    specialize qw/aom_highbd_sad64x16   avx2 sse2 neon/;
-
-    specialize qw/aom_highbd_sad_skip_128x128 avx2      neon/;
-    specialize qw/aom_highbd_sad_skip_128x64  avx2      neon/;
-    specialize qw/aom_highbd_sad_skip_64x128  avx2      neon/;
-    specialize qw/aom_highbd_sad_skip_64x64   avx2 sse2 neon/;
-    specialize qw/aom_highbd_sad_skip_64x32   avx2 sse2 neon/;
-    specialize qw/aom_highbd_sad_skip_32x64   avx2 sse2 neon/;
-    specialize qw/aom_highbd_sad_skip_32x32   avx2 sse2 neon/;
-    specialize qw/aom_highbd_sad_skip_32x16   avx2 sse2 neon/;
+    specialize qw/aom_highbd_sad64x16   avx2 avx512 sse2 neon/;
+
+    specialize qw/aom_highbd_sad_skip_128x128 avx2 avx512      neon/;
+    specialize qw/aom_highbd_sad_skip_128x64  avx2 avx512      neon/;
+    specialize qw/aom_highbd_sad_skip_64x128  avx2 avx512      neon/;
+    specialize qw/aom_highbd_sad_skip_64x64   avx2 avx512 sse2 neon/;
+    specialize qw/aom_highbd_sad_skip_64x32   avx2 avx512 sse2 neon/;
+    specialize qw/aom_highbd_sad_skip_32x64   avx2 avx512 sse2 neon/;
+    specialize qw/aom_highbd_sad_skip_32x32   avx2 avx512 sse2 neon/;
+    specialize qw/aom_highbd_sad_skip_32x16   avx2 avx512 sse2 neon/;
     specialize qw/aom_highbd_sad_skip_16x32   avx2 sse2 neon/;
     specialize qw/aom_highbd_sad_skip_16x16   avx2 sse2 neon/;
     specialize qw/aom_highbd_sad_skip_16x8    avx2 sse2 neon/;
@@ -967,9 +967,9 @@ if (aom_config("CONFIG_AV1_ENCODER") eq "yes") {
 
     specialize qw/aom_highbd_sad_skip_4x16         sse2 neon/;
     specialize qw/aom_highbd_sad_skip_8x32         sse2 neon/;
-    specialize qw/aom_highbd_sad_skip_32x8    avx2 sse2 neon/;
+    specialize qw/aom_highbd_sad_skip_32x8    avx2 avx512 sse2 neon/;
     specialize qw/aom_highbd_sad_skip_16x64   avx2 sse2 neon/;
-    specialize qw/aom_highbd_sad_skip_64x16   avx2 sse2 neon/;
+    specialize qw/aom_highbd_sad_skip_64x16   avx2 avx512 sse2 neon/;
 
     specialize qw/aom_highbd_sad128x128_avg avx2      neon/;
     specialize qw/aom_highbd_sad128x64_avg  avx2      neon/;
@@ -1045,14 +1045,14 @@ if (aom_config("CONFIG_AV1_ENCODER") eq "yes") {
     add_proto qw/void/, "aom_sad_skip_${w}x${h}x4d", "const uint8_t *src_ptr, int src_stride, const uint8_t * const ref_ptr[4], int ref_stride, uint32_t sad_array[4]";
   }
 
-  specialize qw/aom_sad128x128x4d avx2 sse2 neon neon_dotprod/;
-  specialize qw/aom_sad128x64x4d  avx2 sse2 neon neon_dotprod/;
-  specialize qw/aom_sad64x128x4d  avx2 sse2 neon neon_dotprod/;
-  specialize qw/aom_sad64x64x4d   avx2 sse2 neon neon_dotprod/;
-  specialize qw/aom_sad64x32x4d   avx2 sse2 neon neon_dotprod/;
-  specialize qw/aom_sad32x64x4d   avx2 sse2 neon neon_dotprod/;
-  specialize qw/aom_sad32x32x4d   avx2 sse2 neon neon_dotprod/;
-  specialize qw/aom_sad32x16x4d   avx2 sse2 neon neon_dotprod/;
+  specialize qw/aom_sad128x128x4d avx2 avx512 sse2 neon neon_dotprod/;
+  specialize qw/aom_sad128x64x4d  avx2 avx512 sse2 neon neon_dotprod/;
+  specialize qw/aom_sad64x128x4d  avx2 avx512 sse2 neon neon_dotprod/;
+  specialize qw/aom_sad64x64x4d   avx2 avx512 sse2 neon neon_dotprod/;
+  specialize qw/aom_sad64x32x4d   avx2 avx512 sse2 neon neon_dotprod/;
+  specialize qw/aom_sad32x64x4d   avx2 avx512 sse2 neon neon_dotprod/;
+  specialize qw/aom_sad32x32x4d   avx2 avx512 sse2 neon neon_dotprod/;
+  specialize qw/aom_sad32x16x4d   avx2 avx512 sse2 neon neon_dotprod/;
   specialize qw/aom_sad16x32x4d   avx2 sse2 neon neon_dotprod/;
   specialize qw/aom_sad16x16x4d   avx2 sse2 neon neon_dotprod/;
   specialize qw/aom_sad16x8x4d    avx2 sse2 neon neon_dotprod/;
@@ -1063,23 +1063,23 @@ if (aom_config("CONFIG_AV1_ENCODER") eq "yes") {
   specialize qw/aom_sad4x8x4d          sse2 neon/;
   specialize qw/aom_sad4x4x4d          sse2 neon/;
 
-  specialize qw/aom_sad64x16x4d   avx2 sse2 neon neon_dotprod/;
-  specialize qw/aom_sad32x8x4d    avx2 sse2 neon neon_dotprod/;
+  specialize qw/aom_sad64x16x4d   avx2 avx512 sse2 neon neon_dotprod/;
+  specialize qw/aom_sad32x8x4d    avx2 avx512 sse2 neon neon_dotprod/;
   specialize qw/aom_sad16x64x4d   avx2 sse2 neon neon_dotprod/;
   specialize qw/aom_sad16x4x4d    avx2 sse2 neon neon_dotprod/;
   specialize qw/aom_sad8x32x4d         sse2 neon/;
   specialize qw/aom_sad4x16x4d         sse2 neon/;
 
-  specialize qw/aom_sad_skip_128x128x4d avx2 sse2 neon neon_dotprod/;
-  specialize qw/aom_sad_skip_128x64x4d  avx2 sse2 neon neon_dotprod/;
-  specialize qw/aom_sad_skip_64x128x4d  avx2 sse2 neon neon_dotprod/;
-  specialize qw/aom_sad_skip_64x64x4d   avx2 sse2 neon neon_dotprod/;
-  specialize qw/aom_sad_skip_64x32x4d   avx2 sse2 neon neon_dotprod/;
-  specialize qw/aom_sad_skip_64x16x4d   avx2 sse2 neon neon_dotprod/;
-  specialize qw/aom_sad_skip_32x64x4d   avx2 sse2 neon neon_dotprod/;
-  specialize qw/aom_sad_skip_32x32x4d   avx2 sse2 neon neon_dotprod/;
-  specialize qw/aom_sad_skip_32x16x4d   avx2 sse2 neon neon_dotprod/;
-  specialize qw/aom_sad_skip_32x8x4d    avx2 sse2 neon neon_dotprod/;
+  specialize qw/aom_sad_skip_128x128x4d avx2 avx512 sse2 neon neon_dotprod/;
+  specialize qw/aom_sad_skip_128x64x4d  avx2 avx512 sse2 neon neon_dotprod/;
+  specialize qw/aom_sad_skip_64x128x4d  avx2 avx512 sse2 neon neon_dotprod/;
+  specialize qw/aom_sad_skip_64x64x4d   avx2 avx512 sse2 neon neon_dotprod/;
+  specialize qw/aom_sad_skip_64x32x4d   avx2 avx512 sse2 neon neon_dotprod/;
+  specialize qw/aom_sad_skip_64x16x4d   avx2 avx512 sse2 neon neon_dotprod/;
+  specialize qw/aom_sad_skip_32x64x4d   avx2 avx512 sse2 neon neon_dotprod/;
+  specialize qw/aom_sad_skip_32x32x4d   avx2 avx512 sse2 neon neon_dotprod/;
+  specialize qw/aom_sad_skip_32x16x4d   avx2 avx512 sse2 neon neon_dotprod/;
+  specialize qw/aom_sad_skip_32x8x4d    avx2 avx512 sse2 neon neon_dotprod/;
 
   specialize qw/aom_sad_skip_16x64x4d   avx2 sse2 neon neon_dotprod/;
   specialize qw/aom_sad_skip_16x32x4d   avx2 sse2 neon neon_dotprod/;
@@ -1131,14 +1131,14 @@ if (aom_config("CONFIG_AV1_ENCODER") eq "yes") {
         specialize "aom_highbd_sad${w}x${h}x4d", qw/sse2/;
       }
     }
-    specialize qw/aom_highbd_sad128x128x4d      avx2 neon/;
-    specialize qw/aom_highbd_sad128x64x4d       avx2 neon/;
-    specialize qw/aom_highbd_sad64x128x4d       avx2 neon/;
-    specialize qw/aom_highbd_sad64x64x4d   sse2 avx2 neon/;
-    specialize qw/aom_highbd_sad64x32x4d   sse2 avx2 neon/;
-    specialize qw/aom_highbd_sad32x64x4d   sse2 avx2 neon/;
-    specialize qw/aom_highbd_sad32x32x4d   sse2 avx2 neon/;
-    specialize qw/aom_highbd_sad32x16x4d   sse2 avx2 neon/;
+    specialize qw/aom_highbd_sad128x128x4d      avx2 avx512 neon/;
+    specialize qw/aom_highbd_sad128x64x4d       avx2 avx512 neon/;
+    specialize qw/aom_highbd_sad64x128x4d       avx2 avx512 neon/;
+    specialize qw/aom_highbd_sad64x64x4d   sse2 avx2 avx512 neon/;
+    specialize qw/aom_highbd_sad64x32x4d   sse2 avx2 avx512 neon/;
+    specialize qw/aom_highbd_sad32x64x4d   sse2 avx2 avx512 neon/;
+    specialize qw/aom_highbd_sad32x32x4d   sse2 avx2 avx512 neon/;
+    specialize qw/aom_highbd_sad32x16x4d   sse2 avx2 avx512 neon/;
     specialize qw/aom_highbd_sad16x32x4d   sse2 avx2 neon/;
     specialize qw/aom_highbd_sad16x16x4d   sse2 avx2 neon/;
     specialize qw/aom_highbd_sad16x8x4d    sse2 avx2 neon/;
@@ -1151,18 +1151,18 @@ if (aom_config("CONFIG_AV1_ENCODER") eq "yes") {
     specialize qw/aom_highbd_sad4x16x4d         sse2 neon/;
     specialize qw/aom_highbd_sad16x4x4d    avx2 sse2 neon/;
     specialize qw/aom_highbd_sad8x32x4d         sse2 neon/;
-    specialize qw/aom_highbd_sad32x8x4d    avx2 sse2 neon/;
+    specialize qw/aom_highbd_sad32x8x4d    avx2 avx512 sse2 neon/;
     specialize qw/aom_highbd_sad16x64x4d   avx2 sse2 neon/;
-    specialize qw/aom_highbd_sad64x16x4d   avx2 sse2 neon/;
-
-    specialize qw/aom_highbd_sad_skip_128x128x4d avx2      neon/;
-    specialize qw/aom_highbd_sad_skip_128x64x4d  avx2      neon/;
-    specialize qw/aom_highbd_sad_skip_64x128x4d  avx2      neon/;
-    specialize qw/aom_highbd_sad_skip_64x64x4d   avx2 sse2 neon/;
-    specialize qw/aom_highbd_sad_skip_64x32x4d   avx2 sse2 neon/;
-    specialize qw/aom_highbd_sad_skip_32x64x4d   avx2 sse2 neon/;
-    specialize qw/aom_highbd_sad_skip_32x32x4d   avx2 sse2 neon/;
-    specialize qw/aom_highbd_sad_skip_32x16x4d   avx2 sse2 neon/;
+    specialize qw/aom_highbd_sad64x16x4d   avx2 avx512 sse2 neon/;
+
+    specialize qw/aom_highbd_sad_skip_128x128x4d avx2 avx512      neon/;
+    specialize qw/aom_highbd_sad_skip_128x64x4d  avx2 avx512      neon/;
+    specialize qw/aom_highbd_sad_skip_64x128x4d  avx2 avx512      neon/;
+    specialize qw/aom_highbd_sad_skip_64x64x4d   avx2 avx512 sse2 neon/;
+    specialize qw/aom_highbd_sad_skip_64x32x4d   avx2 avx512 sse2 neon/;
+    specialize qw/aom_highbd_sad_skip_32x64x4d   avx2 avx512 sse2 neon/;
+    specialize qw/aom_highbd_sad_skip_32x32x4d   avx2 avx512 sse2 neon/;
+    specialize qw/aom_highbd_sad_skip_32x16x4d   avx2 avx512 sse2 neon/;
     specialize qw/aom_highbd_sad_skip_16x32x4d   avx2 sse2 neon/;
     specialize qw/aom_highbd_sad_skip_16x16x4d   avx2 sse2 neon/;
     specialize qw/aom_highbd_sad_skip_16x8x4d    avx2 sse2 neon/;
@@ -1175,9 +1175,9 @@ if (aom_config("CONFIG_AV1_ENCODER") eq "yes") {
 
     specialize qw/aom_highbd_sad_skip_4x16x4d         sse2 neon/;
     specialize qw/aom_highbd_sad_skip_8x32x4d         sse2 neon/;
-    specialize qw/aom_highbd_sad_skip_32x8x4d    avx2 sse2 neon/;
+    specialize qw/aom_highbd_sad_skip_32x8x4d    avx2 avx512 sse2 neon/;
     specialize qw/aom_highbd_sad_skip_16x64x4d   avx2 sse2 neon/;
-    specialize qw/aom_highbd_sad_skip_64x16x4d   avx2 sse2 neon/;
+    specialize qw/aom_highbd_sad_skip_64x16x4d   avx2 avx512 sse2 neon/;
 
     specialize qw/aom_highbd_sad128x128x3d avx2 neon/;
     specialize qw/aom_highbd_sad128x64x3d  avx2 neon/;
@@ -1357,14 +1357,14 @@ if (aom_config("CONFIG_AV1_ENCODER") eq "yes") {
     add_proto qw/uint32_t/, "aom_sub_pixel_avg_variance${w}x${h}", "const uint8_t *src_ptr, int source_stride, int xoffset, int  yoffset, const uint8_t *ref_ptr, int ref_stride, uint32_t *sse, const uint8_t *second_pred";
     add_proto qw/uint32_t/, "aom_dist_wtd_sub_pixel_avg_variance${w}x${h}", "const uint8_t *src_ptr, int source_stride, int xoffset, int  yoffset, const uint8_t *ref_ptr, int ref_stride, uint32_t *sse, const uint8_t *second_pred, const DIST_WTD_COMP_PARAMS *jcp_param";
   }
-  specialize qw/aom_variance128x128   sse2 avx2 neon neon_dotprod/;
-  specialize qw/aom_variance128x64    sse2 avx2 neon neon_dotprod/;
-  specialize qw/aom_variance64x128    sse2 avx2 neon neon_dotprod/;
-  specialize qw/aom_variance64x64     sse2 avx2 neon neon_dotprod/;
-  specialize qw/aom_variance64x32     sse2 avx2 neon neon_dotprod/;
-  specialize qw/aom_variance32x64     sse2 avx2 neon neon_dotprod/;
-  specialize qw/aom_variance32x32     sse2 avx2 neon neon_dotprod/;
-  specialize qw/aom_variance32x16     sse2 avx2 neon neon_dotprod/;
+  specialize qw/aom_variance128x128   sse2 avx2 avx512 neon neon_dotprod/;
+  specialize qw/aom_variance128x64    sse2 avx2 avx512 neon neon_dotprod/;
+  specialize qw/aom_variance64x128    sse2 avx2 avx512 neon neon_dotprod/;
+  specialize qw/aom_variance64x64     sse2 avx2 avx512 neon neon_dotprod/;
+  specialize qw/aom_variance64x32     sse2 avx2 avx512 neon neon_dotprod/;
+  specialize qw/aom_variance32x64     sse2 avx2 avx512 neon neon_dotprod/;
+  specialize qw/aom_variance32x32     sse2 avx2 avx512 neon neon_dotprod/;
+  specialize qw/aom_variance32x16     sse2 avx2 avx512 neon neon_dotprod/;
   specialize qw/aom_variance16x32     sse2 avx2 neon neon_dotprod/;
   specialize qw/aom_variance16x16     sse2 avx2 neon neon_dotprod/;
   specialize qw/aom_variance16x8      sse2 avx2 neon neon_dotprod/;
@@ -1374,11 +1374,11 @@ if (aom_config("CONFIG_AV1_ENCODER") eq "yes") {
   specialize qw/aom_variance4x8       sse2      neon neon_dotprod/;
   specialize qw/aom_variance4x4       sse2      neon neon_dotprod/;
 
-  specialize qw/aom_sub_pixel_variance128x128   avx2 neon ssse3/;
-  specialize qw/aom_sub_pixel_variance128x64    avx2 neon ssse3/;
-  specialize qw/aom_sub_pixel_variance64x128    avx2 neon ssse3/;
-  specialize qw/aom_sub_pixel_variance64x64     avx2 neon ssse3/;
-  specialize qw/aom_sub_pixel_variance64x32     avx2 neon ssse3/;
+  specialize qw/aom_sub_pixel_variance128x128   avx2 avx512 neon ssse3/;
+  specialize qw/aom_sub_pixel_variance128x64    avx2 avx512 neon ssse3/;
+  specialize qw/aom_sub_pixel_variance64x128    avx2 avx512 neon ssse3/;
+  specialize qw/aom_sub_pixel_variance64x64     avx2 avx512 neon ssse3/;
+  specialize qw/aom_sub_pixel_variance64x32     avx2 avx512 neon ssse3/;
   specialize qw/aom_sub_pixel_variance32x64     avx2 neon ssse3/;
   specialize qw/aom_sub_pixel_variance32x32     avx2 neon ssse3/;
   specialize qw/aom_sub_pixel_variance32x16     avx2 neon ssse3/;
@@ -1412,16 +1412,16 @@ if (aom_config("CONFIG_AV1_ENCODER") eq "yes") {
     specialize qw/aom_variance4x16  neon neon_dotprod sse2/;
     specialize qw/aom_variance16x4  neon neon_dotprod sse2 avx2/;
     specialize qw/aom_variance8x32  neon neon_dotprod sse2/;
-    specialize qw/aom_variance32x8  neon neon_dotprod sse2 avx2/;
+    specialize qw/aom_variance32x8  neon neon_dotprod sse2 avx2 avx512/;
     specialize qw/aom_variance16x64 neon neon_dotprod sse2 avx2/;
-    specialize qw/aom_variance64x16 neon neon_dotprod sse2 avx2/;
+    specialize qw/aom_variance64x16 neon neon_dotprod sse2 avx2 avx512/;
 
     specialize qw/aom_sub_pixel_variance4x16 neon ssse3/;
     specialize qw/aom_sub_pixel_variance16x4 neon avx2 ssse3/;
     specialize qw/aom_sub_pixel_variance8x32 neon ssse3/;
     specialize qw/aom_sub_pixel_variance32x8 neon ssse3/;
     specialize qw/aom_sub_pixel_variance16x64 neon avx2 ssse3/;
-    specialize qw/aom_sub_pixel_variance64x16 neon ssse3/;
+    specialize qw/aom_sub_pixel_variance64x16 neon ssse3 avx512/;
     specialize qw/aom_sub_pixel_avg_variance4x16 neon ssse3/;
     specialize qw/aom_sub_pixel_avg_variance16x4 neon ssse3/;
     specialize qw/aom_sub_pixel_avg_variance8x32 neon ssse3/;
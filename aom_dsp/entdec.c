@@ -10,8 +10,10 @@
  */
 
 #include <assert.h>
+#include <string.h>
 #include "aom_dsp/entdec.h"
 #include "aom_dsp/prob.h"
+#include "aom_util/endian_inl.h"
 
 /*A range decoder.
   This is an entropy decoder based upon \cite{Mar79}, which is itself a
@@ -86,6 +88,24 @@ static void od_ec_dec_refill(od_ec_dec *dec) {
   bptr = dec->bptr;
   end = dec->end;
   s = OD_EC_WINDOW_SIZE - 9 - (cnt + 15);
+#if CONFIG_EC_WINDOW_64
+  if (s >= 0 && end - bptr >= 8) {
+    /*Fast path: insert all (s >> 3) + 1 bytes the loop below would insert with
+       a single unaligned big-endian load. At least 8 bytes are readable, so
+       the load stays inside the buffer; near the end we fall back to the
+       byte-wise loop.*/
+    const int nbytes = (s >> 3) + 1;
+    uint64_t val;
+    assert(nbytes < 8);
+    memcpy(&val, bptr, sizeof(val));
+    /*Byte swapping is its own inverse, so HToBE64 also converts from BE.*/
+    val = HToBE64(val);
+    dif ^= (od_ec_window)(val >> (64 - 8 * nbytes)) << (s & 7);
+    bptr += nbytes;
+    cnt += 8 * nbytes;
+    s -= 8 * nbytes;
+  }
+#endif
   for (; s >= 0 && bptr < end; s -= 8, bptr++) {
     /*Each time a byte is inserted into the window (dif), bptr advances and cnt
        is incremented by 8, so the total number of consumed bits (the return
@@ -143,7 +163,10 @@ static int od_ec_dec_normalize(od_ec_dec *dec, od_ec_window dif, unsigned rng,
 void od_ec_dec_init(od_ec_dec *dec, const unsigned char *buf,
                     uint32_t storage) {
   dec->buf = buf;
-  dec->tell_offs = 10 - (OD_EC_WINDOW_SIZE - 8);
+  /*No bytes have been read yet and cnt starts at -15, so this makes
+     od_ec_dec_tell() start at 1 bit, matching the encoder. It must not depend
+     on OD_EC_WINDOW_SIZE: refilling the window preserves the tell.*/
+  dec->tell_offs = -14;
   dec->end = buf + storage;
   dec->bptr = buf;
   dec->dif = ((od_ec_window)1 << (OD_EC_WINDOW_SIZE - 1)) - 1;
@@ -28,7 +28,7 @@
 // e.g., DOWNSAMPLE_SHIFT = 2 (DOWNSAMPLE_FACTOR == 4) means we calculate
 // one flow point for each 4x4 pixel region of the frame
 // Must be a power of 2
-#define DOWNSAMPLE_SHIFT 3
+#define DOWNSAMPLE_SHIFT DISFLOW_FLOW_BLOCK_SIZE_LOG2
 #define DOWNSAMPLE_FACTOR (1 << DOWNSAMPLE_SHIFT)
 
 // Filters used when upscaling the flow field from one pyramid level
@@ -727,7 +727,7 @@ free_tmpbuf:
   return mem_status;
 }
 
-static FlowField *alloc_flow_field(int frame_width, int frame_height) {
+FlowField *av1_alloc_flow_field(int frame_width, int frame_height) {
   FlowField *flow = (FlowField *)aom_malloc(sizeof(FlowField));
   if (flow == NULL) return NULL;
 
@@ -751,11 +751,71 @@ static FlowField *alloc_flow_field(int frame_width, int frame_height) {
   return flow;
 }
 
-static void free_flow_field(FlowField *flow) {
+void av1_free_flow_field(FlowField *flow) {
+  if (flow == NULL) return;
   aom_free(flow->buf0);
   aom_free(flow);
 }
 
+bool av1_compute_flow_field(const YV12_BUFFER_CONFIG *src,
+                            const YV12_BUFFER_CONFIG *ref, int bit_depth,
+                            FlowField *flow) {
+  ImagePyramid *src_pyramid = src->y_pyramid;
+  ImagePyramid *ref_pyramid = ref->y_pyramid;
+
+  const int src_layers =
+      aom_compute_pyramid(src, bit_depth, DISFLOW_PYRAMID_LEVELS, src_pyramid);
+  const int ref_layers =
+      aom_compute_pyramid(ref, bit_depth, DISFLOW_PYRAMID_LEVELS, ref_pyramid);
+  if (src_layers < 0 || ref_layers < 0) return false;
+  assert(src_layers == ref_layers);
+  assert(src_pyramid->layers[0].width >> DOWNSAMPLE_SHIFT == flow->width);
+  assert(src_pyramid->layers[0].height >> DOWNSAMPLE_SHIFT == flow->height);
+
+  // compute_flow_field() starts from a zero field.
+  const size_t flow_size =
+      flow->stride * (size_t)(flow->height + 2 * FLOW_BORDER_OUTER);
+  memset(flow->buf0, 0, 2 * flow_size * sizeof(*flow->buf0));
+  return compute_flow_field(src_pyramid, ref_pyramid, src_layers, flow);
+}
+
+void av1_get_block_flow(const ImagePyramid *src_pyr,
+                        const ImagePyramid *ref_pyr, const FlowField *flow,
+                        int x, int y, int width, int height, double *u,
+                        double *v) {
+  // Average the entries of the field covering the block.
+  const int col_start = AOMMIN(x >> DOWNSAMPLE_SHIFT, flow->width - 1);
+  const int col_end =
+      AOMMIN((x + width - 1) >> DOWNSAMPLE_SHIFT, flow->width - 1);
+  const int row_start = AOMMIN(y >> DOWNSAMPLE_SHIFT, flow->height - 1);
+  const int row_end =
+      AOMMIN((y + height - 1) >> DOWNSAMPLE_SHIFT, flow->height - 1);
+  double sum_u = 0;
+  double sum_v = 0;
+  for (int i = row_start; i <= row_end; ++i) {
+    for (int j = col_start; j <= col_end; ++j) {
+      sum_u += flow->u[i * flow->stride + j];
+      sum_v += flow->v[i * flow->stride + j];
+    }
+  }
+  const int count = (row_end - row_start + 1) * (col_end - col_start + 1);
+  *u = sum_u / count;
+  *v = sum_v / count;
+
+  // Refine it on the patch at the center of the block, as
+  // determine_disflow_correspondence() does for the corners.
+  const PyramidLayer *src_layer = &src_pyr->layers[0];
+  const int patch_tl_x =
+      clamp(x + width / 2 - DISFLOW_PATCH_SIZE / 2, 0,
+            src_layer->width - DISFLOW_PATCH_SIZE);
+  const int patch_tl_y =
+      clamp(y + height / 2 - DISFLOW_PATCH_SIZE / 2, 0,
+            src_layer->height - DISFLOW_PATCH_SIZE);
+  aom_compute_flow_at_point(src_layer->buffer, ref_pyr->layers[0].buffer,
+                            patch_tl_x, patch_tl_y, src_layer->width,
+                            src_layer->height, src_layer->stride, u, v);
+}
+
 // Compute flow field between `src` and `ref`, and then use that flow to
 // compute a global motion model relating the two frames.
 //
@@ -792,7 +852,7 @@ bool av1_compute_global_motion_disflow(
   assert(ref_pyramid->layers[0].width == src_width);
   assert(ref_pyramid->layers[0].height == src_height);
 
-  FlowField *flow = alloc_flow_field(src_width, src_height);
+  FlowField *flow = av1_alloc_flow_field(src_width, src_height);
   if (!flow) {
     *mem_alloc_failed = true;
     return false;
@@ -800,7 +860,7 @@ bool av1_compute_global_motion_disflow(
 
   if (!compute_flow_field(src_pyramid, ref_pyramid, src_layers, flow)) {
     *mem_alloc_failed = true;
-    free_flow_field(flow);
+    av1_free_flow_field(flow);
     return false;
   }
 
@@ -809,7 +869,7 @@ bool av1_compute_global_motion_disflow(
       aom_malloc(src_corners->num_corners * sizeof(*correspondences));
   if (!correspondences) {
     *mem_alloc_failed = true;
-    free_flow_field(flow);
+    av1_free_flow_field(flow);
     return false;
   }
 
@@ -820,6 +880,6 @@ bool av1_compute_global_motion_disflow(
                        motion_models, num_motion_models, mem_alloc_failed);
 
   aom_free(correspondences);
-  free_flow_field(flow);
+  av1_free_flow_field(flow);
   return result;
 }
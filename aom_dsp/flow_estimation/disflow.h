@@ -15,6 +15,7 @@
 #include <stdbool.h>
 
 #include "aom_dsp/flow_estimation/flow_estimation.h"
+#include "aom_dsp/pyramid.h"
 #include "aom_scale/yv12config.h"
 
 #ifdef __cplusplus
@@ -91,6 +92,35 @@ typedef struct {
   int stride;
 } FlowField;
 
+// Dense flow fields are computed with one vector per block of
+// (1 << DISFLOW_FLOW_BLOCK_SIZE_LOG2) x (1 << DISFLOW_FLOW_BLOCK_SIZE_LOG2)
+// pixels.
+#define DISFLOW_FLOW_BLOCK_SIZE_LOG2 3
+
+// Allocates a flow field for frames of frame_width x frame_height pixels.
+// Returns NULL on allocation failure.
+FlowField *av1_alloc_flow_field(int frame_width, int frame_height);
+void av1_free_flow_field(FlowField *flow);
+
+// Computes the dense flow field from src to ref, which must have the
+// dimensions 'flow' was allocated for. The pyramids of the frames are computed
+// if they are not valid yet, so that the pyramids can be shared with other
+// users of the frames, e.g. global motion search. As for global motion, the
+// field is not refined at full resolution; see av1_get_block_flow().
+// Returns false on allocation failure.
+bool av1_compute_flow_field(const YV12_BUFFER_CONFIG *src,
+                            const YV12_BUFFER_CONFIG *ref, int bit_depth,
+                            FlowField *flow);
+
+// Returns in (u, v) the flow of the block of width x height pixels at (x, y)
+// in the source frame of 'flow': the average of the field over the block,
+// refined at full resolution on the patch at the center of the block. The
+// pyramids must be those 'flow' was computed with.
+void av1_get_block_flow(const ImagePyramid *src_pyr,
+                        const ImagePyramid *ref_pyr, const FlowField *flow,
+                        int x, int y, int width, int height, double *u,
+                        double *v);
+
 bool av1_compute_global_motion_disflow(
     TransformationType type, YV12_BUFFER_CONFIG *src, YV12_BUFFER_CONFIG *ref,
     int bit_depth, int downsample_level, MotionModel *motion_models,
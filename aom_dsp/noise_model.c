@@ -26,6 +26,78 @@
 
 static const int kMaxLag = 4;
 
+// Work split in num_jobs independent jobs, which are spread over num_threads
+// threads.
+typedef struct noise_job noise_job_t;
+struct noise_job {
+  // Runs job 'index' with the scratch buffers of thread 'thread'. Returns 0 on
+  // failure.
+  int (*run)(noise_job_t *job, int index, int thread);
+  int num_jobs;
+  int num_threads;
+};
+
+// Returns the number of threads used to run num_jobs jobs on the workers.
+static int get_num_threads(int num_jobs, const AVxWorker *workers,
+                           int num_workers) {
+#ifdef NOISE_MODEL_LOG_SCORE
+  // Keep the log in order.
+  (void)num_jobs;
+  (void)workers;
+  (void)num_workers;
+  return 1;
+#else
+  if (workers == NULL) return 1;
+  return AOMMAX(AOMMIN(num_workers, num_jobs), 1);
+#endif
+}
+
+typedef struct {
+  noise_job_t *job;
+  int thread;
+} noise_worker_data_t;
+
+static int noise_worker_hook(void *arg1, void *unused) {
+  const noise_worker_data_t *const data = (const noise_worker_data_t *)arg1;
+  noise_job_t *const job = data->job;
+  (void)unused;
+  for (int i = data->thread; i < job->num_jobs; i += job->num_threads) {
+    if (!job->run(job, i, data->thread)) return 0;
+  }
+  return 1;
+}
+
+// Runs the jobs on the first job->num_threads workers, the first worker on the
+// calling thread. Returns 0 if a job failed.
+static int run_noise_jobs(noise_job_t *job, AVxWorker *workers) {
+  noise_worker_data_t data_1 = { job, 0 };
+  if (job->num_threads <= 1) return noise_worker_hook(&data_1, NULL);
+
+  noise_worker_data_t *const data =
+      (noise_worker_data_t *)aom_malloc(job->num_threads * sizeof(*data));
+  if (!data) return 0;
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  for (int i = job->num_threads - 1; i >= 0; --i) {
+    AVxWorker *const worker = &workers[i];
+    data[i].job = job;
+    data[i].thread = i;
+    worker->hook = noise_worker_hook;
+    worker->data1 = &data[i];
+    worker->data2 = NULL;
+    worker->had_error = 0;
+    if (i == 0)
+      winterface->execute(worker);
+    else
+      winterface->launch(worker);
+  }
+  int ret = !workers[0].had_error;
+  for (int i = job->num_threads - 1; i > 0; --i) {
+    ret &= winterface->sync(&workers[i]);
+  }
+  aom_free(data);
+  return ret;
+}
+
 // Defines a function that can be used to obtain the mean of a block for the
 // provided data type (uint8_t, or uint16_t)
 #define GET_BLOCK_MEAN(INT_TYPE, suffix)                                    \
@@ -556,114 +628,156 @@ static int compare_scores(const void *a, const void *b) {
   return 0;
 }
 
-int aom_flat_block_finder_run(const aom_flat_block_finder_t *block_finder,
-                              const uint8_t *const data, int w, int h,
-                              int stride, uint8_t *flat_blocks) {
+typedef struct {
+  noise_job_t job;
+  const aom_flat_block_finder_t *block_finder;
+  const uint8_t *data;
+  int w;
+  int h;
+  int stride;
+  int num_blocks_w;
+  // Plane and block buffers of each thread.
+  double *scratch;
+  uint8_t *flat_blocks;
+  index_and_score_t *scores;
+} flat_block_job_t;
+
+// Scores the blocks of block row 'by'.
+static int find_flat_blocks_in_row(noise_job_t *job, int by, int thread) {
   // The gradient-based features used in this code are based on:
   //  A. Kokaram, D. Kelly, H. Denman and A. Crawford, "Measuring noise
   //  correlation for improved video denoising," 2012 19th, ICIP.
   // The thresholds are more lenient to allow for correct grain modeling
   // if extreme cases.
-  const int block_size = block_finder->block_size;
+  const flat_block_job_t *const flat_job = (const flat_block_job_t *)job;
+  const int block_size = flat_job->block_finder->block_size;
   const int n = block_size * block_size;
   const double kTraceThreshold = 0.15 / (32 * 32);
   const double kRatioThreshold = 1.25;
   const double kNormThreshold = 0.08 / (32 * 32);
   const double kVarThreshold = 0.005 / (double)n;
+  const int num_blocks_w = flat_job->num_blocks_w;
+  double *const plane = flat_job->scratch + (size_t)thread * 2 * n;
+  double *const block = plane + n;
+  uint8_t *const flat_blocks = flat_job->flat_blocks;
+  index_and_score_t *const scores = flat_job->scores;
+
+  for (int bx = 0; bx < num_blocks_w; ++bx) {
+    // Compute gradient covariance matrix.
+    aom_flat_block_finder_extract_block(
+        flat_job->block_finder, flat_job->data, flat_job->w, flat_job->h,
+        flat_job->stride, bx * block_size, by * block_size, plane, block);
+    double Gxx = 0, Gxy = 0, Gyy = 0;
+    double mean = 0;
+    double var = 0;
+
+    for (int yi = 1; yi < block_size - 1; ++yi) {
+      for (int xi = 1; xi < block_size - 1; ++xi) {
+        const double gx = (block[yi * block_size + xi + 1] -
+                           block[yi * block_size + xi - 1]) /
+                          2;
+        const double gy = (block[yi * block_size + xi + block_size] -
+                           block[yi * block_size + xi - block_size]) /
+                          2;
+        Gxx += gx * gx;
+        Gxy += gx * gy;
+        Gyy += gy * gy;
+
+        const double value = block[yi * block_size + xi];
+        mean += value;
+        var += value * value;
+      }
+    }
+    mean /= (block_size - 2) * (block_size - 2);
+
+    // Normalize gradients by block_size.
+    Gxx /= ((block_size - 2) * (block_size - 2));
+    Gxy /= ((block_size - 2) * (block_size - 2));
+    Gyy /= ((block_size - 2) * (block_size - 2));
+    var = var / ((block_size - 2) * (block_size - 2)) - mean * mean;
+
+    {
+      const double trace = Gxx + Gyy;
+      const double det = Gxx * Gyy - Gxy * Gxy;
+      const double e1 = (trace + sqrt(trace * trace - 4 * det)) / 2.;
+      const double e2 = (trace - sqrt(trace * trace - 4 * det)) / 2.;
+      const double norm = e1;  // Spectral norm
+      const double ratio = (e1 / AOMMAX(e2, 1e-6));
+      const int is_flat = (trace < kTraceThreshold) &&
+                          (ratio < kRatioThreshold) &&
+                          (norm < kNormThreshold) && (var > kVarThreshold);
+      // The following weights are used to combine the above features to give
+      // a sigmoid score for flatness. If the input was normalized to [0,100]
+      // the magnitude of these values would be close to 1 (e.g., weights
+      // corresponding to variance would be a factor of 10000x smaller).
+      // The weights are given in the following order:
+      //    [{var}, {ratio}, {trace}, {norm}, offset]
+      // with one of the most discriminative being simply the variance.
+      const double weights[5] = { -6682, -0.2056, 13087, -12434, 2.5694 };
+      double sum_weights = weights[0] * var + weights[1] * ratio +
+                           weights[2] * trace + weights[3] * norm +
+                           weights[4];
+      // clamp the value to [-25.0, 100.0] to prevent overflow
+      sum_weights = fclamp(sum_weights, -25.0, 100.0);
+      const float score = (float)(1.0 / (1 + exp(-sum_weights)));
+      flat_blocks[by * num_blocks_w + bx] = is_flat ? 255 : 0;
+      scores[by * num_blocks_w + bx].score = var > kVarThreshold ? score : 0;
+      scores[by * num_blocks_w + bx].index = by * num_blocks_w + bx;
+#ifdef NOISE_MODEL_LOG_SCORE
+      fprintf(stderr, "%g %g %g %g %g %d ", score, var, ratio, trace, norm,
+              is_flat);
+#endif
+    }
+  }
+#ifdef NOISE_MODEL_LOG_SCORE
+  fprintf(stderr, "\n");
+#endif
+  return 1;
+}
+
+static int flat_block_finder_run(const aom_flat_block_finder_t *block_finder,
+                                 const uint8_t *const data, int w, int h,
+                                 int stride, uint8_t *flat_blocks,
+                                 AVxWorker *workers, int num_workers) {
+  const int block_size = block_finder->block_size;
+  const int n = block_size * block_size;
   const int num_blocks_w = (w + block_size - 1) / block_size;
   const int num_blocks_h = (h + block_size - 1) / block_size;
+  const int num_threads = get_num_threads(num_blocks_h, workers, num_workers);
   int num_flat = 0;
-  double *plane = (double *)aom_malloc(n * sizeof(*plane));
-  double *block = (double *)aom_malloc(n * sizeof(*block));
+  double *scratch =
+      (double *)aom_malloc((size_t)num_threads * 2 * n * sizeof(*scratch));
   index_and_score_t *scores = (index_and_score_t *)aom_malloc(
       num_blocks_w * num_blocks_h * sizeof(*scores));
-  if (plane == NULL || block == NULL || scores == NULL) {
+  if (scratch == NULL || scores == NULL) {
     fprintf(stderr, "Failed to allocate memory for block of size %d\n", n);
-    aom_free(plane);
-    aom_free(block);
+    aom_free(scratch);
     aom_free(scores);
     return -1;
   }
 
+  flat_block_job_t flat_job = {
+    { find_flat_blocks_in_row, num_blocks_h, num_threads },
+    block_finder,
+    data,
+    w,
+    h,
+    stride,
+    num_blocks_w,
+    scratch,
+    flat_blocks,
+    scores,
+  };
 #ifdef NOISE_MODEL_LOG_SCORE
   fprintf(stderr, "score = [");
 #endif
-  for (int by = 0; by < num_blocks_h; ++by) {
-    for (int bx = 0; bx < num_blocks_w; ++bx) {
-      // Compute gradient covariance matrix.
-      aom_flat_block_finder_extract_block(block_finder, data, w, h, stride,
-                                          bx * block_size, by * block_size,
-                                          plane, block);
-      double Gxx = 0, Gxy = 0, Gyy = 0;
-      double mean = 0;
-      double var = 0;
-
-      for (int yi = 1; yi < block_size - 1; ++yi) {
-        for (int xi = 1; xi < block_size - 1; ++xi) {
-          const double gx = (block[yi * block_size + xi + 1] -
-                             block[yi * block_size + xi - 1]) /
-                            2;
-          const double gy = (block[yi * block_size + xi + block_size] -
-                             block[yi * block_size + xi - block_size]) /
-                            2;
-          Gxx += gx * gx;
-          Gxy += gx * gy;
-          Gyy += gy * gy;
-
-          const double value = block[yi * block_size + xi];
-          mean += value;
-          var += value * value;
-        }
-      }
-      mean /= (block_size - 2) * (block_size - 2);
-
-      // Normalize gradients by block_size.
-      Gxx /= ((block_size - 2) * (block_size - 2));
-      Gxy /= ((block_size - 2) * (block_size - 2));
-      Gyy /= ((block_size - 2) * (block_size - 2));
-      var = var / ((block_size - 2) * (block_size - 2)) - mean * mean;
-
-      {
-        const double trace = Gxx + Gyy;
-        const double det = Gxx * Gyy - Gxy * Gxy;
-        const double e1 = (trace + sqrt(trace * trace - 4 * det)) / 2.;
-        const double e2 = (trace - sqrt(trace * trace - 4 * det)) / 2.;
-        const double norm = e1;  // Spectral norm
-        const double ratio = (e1 / AOMMAX(e2, 1e-6));
-        const int is_flat = (trace < kTraceThreshold) &&
-                            (ratio < kRatioThreshold) &&
-                            (norm < kNormThreshold) && (var > kVarThreshold);
-        // The following weights are used to combine the above features to give
-        // a sigmoid score for flatness. If the input was normalized to [0,100]
-        // the magnitude of these values would be close to 1 (e.g., weights
-        // corresponding to variance would be a factor of 10000x smaller).
-        // The weights are given in the following order:
-        //    [{var}, {ratio}, {trace}, {norm}, offset]
-        // with one of the most discriminative being simply the variance.
-        const double weights[5] = { -6682, -0.2056, 13087, -12434, 2.5694 };
-        double sum_weights = weights[0] * var + weights[1] * ratio +
-                             weights[2] * trace + weights[3] * norm +
-                             weights[4];
-        // clamp the value to [-25.0, 100.0] to prevent overflow
-        sum_weights = fclamp(sum_weights, -25.0, 100.0);
-        const float score = (float)(1.0 / (1 + exp(-sum_weights)));
-        flat_blocks[by * num_blocks_w + bx] = is_flat ? 255 : 0;
-        scores[by * num_blocks_w + bx].score = var > kVarThreshold ? score : 0;
-        scores[by * num_blocks_w + bx].index = by * num_blocks_w + bx;
-#ifdef NOISE_MODEL_LOG_SCORE
-        fprintf(stderr, "%g %g %g %g %g %d ", score, var, ratio, trace, norm,
-                is_flat);
-#endif
-        num_flat += is_flat;
-      }
-    }
-#ifdef NOISE_MODEL_LOG_SCORE
-    fprintf(stderr, "\n");
-#endif
-  }
+  run_noise_jobs(&flat_job.job, workers);
 #ifdef NOISE_MODEL_LOG_SCORE
   fprintf(stderr, "];\n");
 #endif
+  for (int i = 0; i < num_blocks_w * num_blocks_h; ++i) {
+    num_flat += flat_blocks[i] != 0;
+  }
   // Find the top-scored blocks (most likely to be flat) and set the flat blocks
   // be the union of the thresholded results and the top 10th percentile of the
   // scored results.
@@ -676,12 +790,18 @@ int aom_flat_block_finder_run(const aom_flat_block_finder_t *block_finder,
       flat_blocks[scores[i].index] |= 1;
     }
   }
-  aom_free(block);
-  aom_free(plane);
+  aom_free(scratch);
   aom_free(scores);
   return num_flat;
 }
 
+int aom_flat_block_finder_run(const aom_flat_block_finder_t *block_finder,
+                              const uint8_t *const data, int w, int h,
+                              int stride, uint8_t *flat_blocks) {
+  return flat_block_finder_run(block_finder, data, w, h, stride, flat_blocks,
+                               NULL, 0);
+}
+
 int aom_noise_model_init(aom_noise_model_t *model,
                          const aom_noise_model_params_t params) {
   const int n = num_coeffs(params);
@@ -803,71 +923,173 @@ void aom_noise_model_free(aom_noise_model_t *model) {
 EXTRACT_AR_ROW(uint8_t, lowbd)
 EXTRACT_AR_ROW(uint16_t, highbd)
 
+typedef struct {
+  noise_job_t job;
+  const aom_noise_model_t *noise_model;
+  int c;
+  const uint8_t *data;
+  const uint8_t *denoised;
+  int w;
+  int h;
+  int stride;
+  int *sub_log2;
+  const uint8_t *alt_data;
+  const uint8_t *alt_denoised;
+  int alt_stride;
+  const uint8_t *flat_blocks;
+  int block_size;
+  int num_blocks_w;
+  // Buffer of the coordinates of a sample, for each thread.
+  double *buffers;
+  // Upper triangle of A, b and number of observations of each block row.
+  double *row_A;
+  double *row_b;
+  int *row_num_observations;
+} block_observations_job_t;
+
+// Adds the observations of the flat blocks of block row 'by' to the equation
+// system of the row.
+static int add_block_row_observations(noise_job_t *job, int by, int thread) {
+  const block_observations_job_t *const obs_job =
+      (const block_observations_job_t *)job;
+  const aom_noise_model_t *const noise_model = obs_job->noise_model;
+  const int lag = noise_model->params.lag;
+  const int num_coords = noise_model->n;
+  const double normalization = (1 << noise_model->params.bit_depth) - 1;
+  const int n = noise_model->latest_state[obs_job->c].eqns.n;
+  double *const A = obs_job->row_A + (size_t)by * n * n;
+  double *const b = obs_job->row_b + (size_t)by * n;
+  double *const buffer = obs_job->buffers + (size_t)thread * (num_coords + 1);
+  int *const sub_log2 = obs_job->sub_log2;
+  const int block_size = obs_job->block_size;
+  const int num_blocks_w = obs_job->num_blocks_w;
+  const uint8_t *const flat_blocks = obs_job->flat_blocks;
+  const int w = obs_job->w;
+  const int h = obs_job->h;
+  int num_observations = 0;
+
+  const int y_o = by * (block_size >> sub_log2[1]);
+  for (int bx = 0; bx < num_blocks_w; ++bx) {
+    const int x_o = bx * (block_size >> sub_log2[0]);
+    if (!flat_blocks[by * num_blocks_w + bx]) {
+      continue;
+    }
+    int y_start =
+        (by > 0 && flat_blocks[(by - 1) * num_blocks_w + bx]) ? 0 : lag;
+    int x_start = (bx > 0 && flat_blocks[by * num_blocks_w + bx - 1]) ? 0 : lag;
+    int y_end = AOMMIN((h >> sub_log2[1]) - by * (block_size >> sub_log2[1]),
+                       block_size >> sub_log2[1]);
+    int x_end = AOMMIN(
+        (w >> sub_log2[0]) - bx * (block_size >> sub_log2[0]) - lag,
+        (bx + 1 < num_blocks_w && flat_blocks[by * num_blocks_w + bx + 1])
+            ? (block_size >> sub_log2[0])
+            : ((block_size >> sub_log2[0]) - lag));
+    for (int y = y_start; y < y_end; ++y) {
+      for (int x = x_start; x < x_end; ++x) {
+        const double val =
+            noise_model->params.use_highbd
+                ? extract_ar_row_highbd(
+                      noise_model->coords, num_coords,
+                      (const uint16_t *const)obs_job->data,
+                      (const uint16_t *const)obs_job->denoised,
+                      obs_job->stride, sub_log2,
+                      (const uint16_t *const)obs_job->alt_data,
+                      (const uint16_t *const)obs_job->alt_denoised,
+                      obs_job->alt_stride, x + x_o, y + y_o, buffer)
+                : extract_ar_row_lowbd(
+                      noise_model->coords, num_coords, obs_job->data,
+                      obs_job->denoised, obs_job->stride, sub_log2,
+                      obs_job->alt_data, obs_job->alt_denoised,
+                      obs_job->alt_stride, x + x_o, y + y_o, buffer);
+        // A is symmetric, so only its upper triangle is accumulated.
+        for (int i = 0; i < n; ++i) {
+          for (int j = i; j < n; ++j) {
+            A[i * n + j] +=
+                (buffer[i] * buffer[j]) / (normalization * normalization);
+          }
+          b[i] += (buffer[i] * val) / (normalization * normalization);
+        }
+        num_observations++;
+      }
+    }
+  }
+  obs_job->row_num_observations[by] = num_observations;
+  return 1;
+}
+
+// Accumulates the equations of each block row separately, then adds them to
+// the latest state of channel c in order, so that the sums do not depend on
+// the number of threads.
 static int add_block_observations(
     aom_noise_model_t *noise_model, int c, const uint8_t *const data,
     const uint8_t *const denoised, int w, int h, int stride, int sub_log2[2],
     const uint8_t *const alt_data, const uint8_t *const alt_denoised,
     int alt_stride, const uint8_t *const flat_blocks, int block_size,
-    int num_blocks_w, int num_blocks_h) {
-  const int lag = noise_model->params.lag;
+    int num_blocks_w, int num_blocks_h, AVxWorker *workers, int num_workers) {
   const int num_coords = noise_model->n;
-  const double normalization = (1 << noise_model->params.bit_depth) - 1;
-  double *A = noise_model->latest_state[c].eqns.A;
-  double *b = noise_model->latest_state[c].eqns.b;
-  double *buffer = (double *)aom_malloc(sizeof(*buffer) * (num_coords + 1));
-  const int n = noise_model->latest_state[c].eqns.n;
-
-  if (!buffer) {
-    fprintf(stderr, "Unable to allocate buffer of size %d\n", num_coords + 1);
+  aom_noise_state_t *const state = &noise_model->latest_state[c];
+  double *A = state->eqns.A;
+  double *b = state->eqns.b;
+  const int n = state->eqns.n;
+  const int num_threads = get_num_threads(num_blocks_h, workers, num_workers);
+  double *buffers = (double *)aom_malloc((size_t)num_threads *
+                                         (num_coords + 1) * sizeof(*buffers));
+  double *row_A =
+      (double *)aom_calloc((size_t)num_blocks_h * n * n, sizeof(*row_A));
+  double *row_b =
+      (double *)aom_calloc((size_t)num_blocks_h * n, sizeof(*row_b));
+  int *row_num_observations =
+      (int *)aom_malloc(num_blocks_h * sizeof(*row_num_observations));
+
+  if (!buffers || !row_A || !row_b || !row_num_observations) {
+    fprintf(stderr, "Unable to allocate block observation buffers\n");
+    aom_free(buffers);
+    aom_free(row_A);
+    aom_free(row_b);
+    aom_free(row_num_observations);
     return 0;
   }
-  for (int by = 0; by < num_blocks_h; ++by) {
-    const int y_o = by * (block_size >> sub_log2[1]);
-    for (int bx = 0; bx < num_blocks_w; ++bx) {
-      const int x_o = bx * (block_size >> sub_log2[0]);
-      if (!flat_blocks[by * num_blocks_w + bx]) {
-        continue;
-      }
-      int y_start =
-          (by > 0 && flat_blocks[(by - 1) * num_blocks_w + bx]) ? 0 : lag;
-      int x_start =
-          (bx > 0 && flat_blocks[by * num_blocks_w + bx - 1]) ? 0 : lag;
-      int y_end = AOMMIN((h >> sub_log2[1]) - by * (block_size >> sub_log2[1]),
-                         block_size >> sub_log2[1]);
-      int x_end = AOMMIN(
-          (w >> sub_log2[0]) - bx * (block_size >> sub_log2[0]) - lag,
-          (bx + 1 < num_blocks_w && flat_blocks[by * num_blocks_w + bx + 1])
-              ? (block_size >> sub_log2[0])
-              : ((block_size >> sub_log2[0]) - lag));
-      for (int y = y_start; y < y_end; ++y) {
-        for (int x = x_start; x < x_end; ++x) {
-          const double val =
-              noise_model->params.use_highbd
-                  ? extract_ar_row_highbd(noise_model->coords, num_coords,
-                                          (const uint16_t *const)data,
-                                          (const uint16_t *const)denoised,
-                                          stride, sub_log2,
-                                          (const uint16_t *const)alt_data,
-                                          (const uint16_t *const)alt_denoised,
-                                          alt_stride, x + x_o, y + y_o, buffer)
-                  : extract_ar_row_lowbd(noise_model->coords, num_coords, data,
-                                         denoised, stride, sub_log2, alt_data,
-                                         alt_denoised, alt_stride, x + x_o,
-                                         y + y_o, buffer);
-          for (int i = 0; i < n; ++i) {
-            for (int j = 0; j < n; ++j) {
-              A[i * n + j] +=
-                  (buffer[i] * buffer[j]) / (normalization * normalization);
-            }
-            b[i] += (buffer[i] * val) / (normalization * normalization);
-          }
-          noise_model->latest_state[c].num_observations++;
-        }
+  block_observations_job_t obs_job = {
+    { add_block_row_observations, num_blocks_h, num_threads },
+    noise_model,
+    c,
+    data,
+    denoised,
+    w,
+    h,
+    stride,
+    sub_log2,
+    alt_data,
+    alt_denoised,
+    alt_stride,
+    flat_blocks,
+    block_size,
+    num_blocks_w,
+    buffers,
+    row_A,
+    row_b,
+    row_num_observations,
+  };
+  const int ret = run_noise_jobs(&obs_job.job, workers);
+  if (ret) {
+    for (int by = 0; by < num_blocks_h; ++by) {
+      const double *const A_row = row_A + (size_t)by * n * n;
+      const double *const b_row = row_b + (size_t)by * n;
+      for (int i = 0; i < n; ++i) {
+        for (int j = i; j < n; ++j) A[i * n + j] += A_row[i * n + j];
+        b[i] += b_row[i];
       }
+      state->num_observations += row_num_observations[by];
+    }
+    for (int i = 1; i < n; ++i) {
+      for (int j = 0; j < i; ++j) A[i * n + j] = A[j * n + i];
     }
   }
-  aom_free(buffer);
-  return 1;
+  aom_free(buffers);
+  aom_free(row_A);
+  aom_free(row_b);
+  aom_free(row_num_observations);
+  return ret;
 }
 
 static void add_noise_std_observations(
@@ -1013,10 +1235,11 @@ static int ar_equation_system_solve(aom_noise_state_t *state, int is_chroma) {
   return ret;
 }
 
-aom_noise_status_t aom_noise_model_update(
+static aom_noise_status_t noise_model_update(
     aom_noise_model_t *const noise_model, const uint8_t *const data[3],
     const uint8_t *const denoised[3], int w, int h, int stride[3],
-    int chroma_sub_log2[2], const uint8_t *const flat_blocks, int block_size) {
+    int chroma_sub_log2[2], const uint8_t *const flat_blocks, int block_size,
+    AVxWorker *workers, int num_workers) {
   const int num_blocks_w = (w + block_size - 1) / block_size;
   const int num_blocks_h = (h + block_size - 1) / block_size;
   int y_model_different = 0;
@@ -1063,7 +1286,8 @@ aom_noise_status_t aom_noise_model_update(
     if (!add_block_observations(noise_model, channel, data[channel],
                                 denoised[channel], w, h, stride[channel], sub,
                                 alt_data, alt_denoised, stride[0], flat_blocks,
-                                block_size, num_blocks_w, num_blocks_h)) {
+                                block_size, num_blocks_w, num_blocks_h, workers,
+                                num_workers)) {
       fprintf(stderr, "Adding block observation failed\n");
       return AOM_NOISE_STATUS_INTERNAL_ERROR;
     }
@@ -1133,6 +1357,14 @@ aom_noise_status_t aom_noise_model_update(
                            : AOM_NOISE_STATUS_OK;
 }
 
+aom_noise_status_t aom_noise_model_update(
+    aom_noise_model_t *const noise_model, const uint8_t *const data[3],
+    const uint8_t *const denoised[3], int w, int h, int stride[3],
+    int chroma_sub_log2[2], const uint8_t *const flat_blocks, int block_size) {
+  return noise_model_update(noise_model, data, denoised, w, h, stride,
+                            chroma_sub_log2, flat_blocks, block_size, NULL, 0);
+}
+
 void aom_noise_model_save_latest(aom_noise_model_t *noise_model) {
   for (int c = 0; c < 3; c++) {
     equation_system_copy(&noise_model->combined_state[c].eqns,
@@ -1358,19 +1590,152 @@ static float *get_half_cos_window(int block_size) {
 DITHER_AND_QUANTIZE(uint8_t, lowbd)
 DITHER_AND_QUANTIZE(uint16_t, highbd)
 
-int aom_wiener_denoise_2d(const uint8_t *const data[3], uint8_t *denoised[3],
-                          int w, int h, int stride[3], int chroma_sub[2],
-                          float *noise_psd[3], int block_size, int bit_depth,
-                          int use_highbd) {
-  float *plane = NULL, *block = NULL, *window_full = NULL,
-        *window_chroma = NULL;
-  double *block_d = NULL, *plane_d = NULL;
-  struct aom_noise_tx_t *tx_full = NULL;
-  struct aom_noise_tx_t *tx_chroma = NULL;
+// Scratch buffers of a thread of wiener_denoise_2d().
+typedef struct {
+  struct aom_noise_tx_t *tx_full;
+  struct aom_noise_tx_t *tx_chroma;
+  // A row of blocks and of their plane approximations.
+  float *blocks;
+  float *planes;
+  double *block_d;
+  double *plane_d;
+} wiener_scratch_t;
+
+typedef struct {
+  noise_job_t job;
+  const aom_flat_block_finder_t *block_finder;
+  const uint8_t *data;
+  // Dimensions of the plane and of its blocks.
+  int w;
+  int h;
+  int stride;
+  int block_w;
+  int block_h;
+  int num_blocks_w;
+  int num_blocks_h;
+  int use_tx_chroma;
+  const float *window_function;
+  const float *noise_psd;
+  // Distance between the blocks of wiener_scratch_t.
+  int block_stride;
+  wiener_scratch_t *scratch;
+  float *result;
+  int result_stride;
+  int result_height;
+  int rows_per_job;
+} wiener_job_t;
+
+// Denoises the rows of the result in band 'band'. The blocks overlapping the
+// band are processed in the same order as for the whole plane, so that the
+// sum of the overlapping blocks of each sample does not depend on the bands.
+static int wiener_denoise_rows(noise_job_t *job, int band, int thread) {
+  const wiener_job_t *const wiener_job = (const wiener_job_t *)job;
+  const wiener_scratch_t *const scratch = &wiener_job->scratch[thread];
+  struct aom_noise_tx_t *const tx =
+      wiener_job->use_tx_chroma ? scratch->tx_chroma : scratch->tx_full;
+  const float *const window_function = wiener_job->window_function;
+  const int block_w = wiener_job->block_w;
+  const int block_h = wiener_job->block_h;
+  const int pixels_per_block = block_w * block_h;
+  const int block_stride = wiener_job->block_stride;
+  const int num_blocks_w = wiener_job->num_blocks_w;
+  const int result_stride = wiener_job->result_stride;
+  const int y_start = band * wiener_job->rows_per_job;
+  const int y_stop =
+      AOMMIN(y_start + wiener_job->rows_per_job, wiener_job->result_height);
+
+  // Do overlapped block processing (half overlapped).
+  for (int offsy = 0; offsy < block_h; offsy += block_h / 2) {
+    for (int offsx = 0; offsx < block_w; offsx += block_w / 2) {
+      // Pad the boundary when processing each block-set.
+      for (int by = -1; by < wiener_job->num_blocks_h; ++by) {
+        const int y_block = (by + 1) * block_h + offsy;
+        if (y_block + block_h <= y_start || y_block >= y_stop) continue;
+        for (int bx = -1; bx < num_blocks_w; ++bx) {
+          float *const block = scratch->blocks + (bx + 1) * block_stride;
+          float *const plane = scratch->planes + (bx + 1) * block_stride;
+          aom_flat_block_finder_extract_block(
+              wiener_job->block_finder, wiener_job->data, wiener_job->w,
+              wiener_job->h, wiener_job->stride, bx * block_w + offsx,
+              by * block_h + offsy, scratch->plane_d, scratch->block_d);
+          for (int j = 0; j < pixels_per_block; ++j) {
+            block[j] = (float)scratch->block_d[j];
+            plane[j] = (float)scratch->plane_d[j];
+          }
+          pointwise_multiply(window_function, block, pixels_per_block);
+        }
+        aom_noise_tx_filter_blocks(tx, wiener_job->noise_psd, scratch->blocks,
+                                   block_stride, num_blocks_w + 1);
+
+        const int y_begin = AOMMAX(y_start - y_block, 0);
+        const int y_end = AOMMIN(y_stop - y_block, block_h);
+        for (int bx = -1; bx < num_blocks_w; ++bx) {
+          const float *const block = scratch->blocks + (bx + 1) * block_stride;
+          float *const plane = scratch->planes + (bx + 1) * block_stride;
+          // Apply window function to the plane approximation (we will apply
+          // it to the sum of plane + block when composing the results).
+          pointwise_multiply(window_function, plane, pixels_per_block);
+
+          for (int y = y_begin; y < y_end; ++y) {
+            float *const result_row =
+                wiener_job->result + (y + y_block) * result_stride +
+                (bx + 1) * block_w + offsx;
+            for (int x = 0; x < block_w; ++x) {
+              const int i = y * block_w + x;
+              result_row[x] += (block[i] + plane[i]) * window_function[i];
+            }
+          }
+        }
+      }
+    }
+  }
+  return 1;
+}
+
+static void free_wiener_scratch(wiener_scratch_t *scratch, int chroma_sub) {
+  if (chroma_sub != 0) aom_noise_tx_free(scratch->tx_chroma);
+  aom_noise_tx_free(scratch->tx_full);
+  aom_free(scratch->blocks);
+  aom_free(scratch->planes);
+  aom_free(scratch->block_d);
+  aom_free(scratch->plane_d);
+}
+
+static int alloc_wiener_scratch(wiener_scratch_t *scratch, int block_size,
+                                int chroma_sub, int num_blocks,
+                                int block_stride) {
+  const size_t batch_size = (size_t)num_blocks * block_stride;
+  scratch->tx_full = aom_noise_tx_malloc(block_size);
+  scratch->tx_chroma = chroma_sub != 0
+                           ? aom_noise_tx_malloc(block_size >> chroma_sub)
+                           : scratch->tx_full;
+  scratch->blocks =
+      (float *)aom_memalign(32, batch_size * sizeof(*scratch->blocks));
+  scratch->planes = (float *)aom_malloc(batch_size * sizeof(*scratch->planes));
+  scratch->block_d = (double *)aom_malloc(block_size * block_size *
+                                          sizeof(*scratch->block_d));
+  scratch->plane_d = (double *)aom_malloc(block_size * block_size *
+                                          sizeof(*scratch->plane_d));
+  return scratch->tx_full != NULL && scratch->tx_chroma != NULL &&
+         scratch->blocks != NULL && scratch->planes != NULL &&
+         scratch->block_d != NULL && scratch->plane_d != NULL;
+}
+
+static int wiener_denoise_2d(const uint8_t *const data[3], uint8_t *denoised[3],
+                             int w, int h, int stride[3], int chroma_sub[2],
+                             float *noise_psd[3], int block_size, int bit_depth,
+                             int use_highbd, AVxWorker *workers,
+                             int num_workers) {
+  float *window_full = NULL, *window_chroma = NULL;
+  wiener_scratch_t *scratch = NULL;
   const int num_blocks_w = (w + block_size - 1) / block_size;
   const int num_blocks_h = (h + block_size - 1) / block_size;
   const int result_stride = (num_blocks_w + 2) * block_size;
   const int result_height = (num_blocks_h + 2) * block_size;
+  // Keep each block of a row of blocks 32-byte aligned.
+  const int block_stride = (block_size * block_size + 7) & ~7;
+  const int num_threads =
+      get_num_threads(num_blocks_h + 2, workers, num_workers);
   float *result = NULL;
   int init_success = 1;
   aom_flat_block_finder_t block_finder_full;
@@ -1386,85 +1751,56 @@ int aom_wiener_denoise_2d(const uint8_t *const data[3], uint8_t *denoised[3],
                                              bit_depth, use_highbd);
   result = (float *)aom_malloc((num_blocks_h + 2) * block_size * result_stride *
                                sizeof(*result));
-  plane = (float *)aom_malloc(block_size * block_size * sizeof(*plane));
-  block =
-      (float *)aom_memalign(32, 2 * block_size * block_size * sizeof(*block));
-  block_d = (double *)aom_malloc(block_size * block_size * sizeof(*block_d));
-  plane_d = (double *)aom_malloc(block_size * block_size * sizeof(*plane_d));
   window_full = get_half_cos_window(block_size);
-  tx_full = aom_noise_tx_malloc(block_size);
+  scratch = (wiener_scratch_t *)aom_calloc(num_threads, sizeof(*scratch));
+  if (scratch) {
+    for (int i = 0; i < num_threads; ++i) {
+      init_success &= alloc_wiener_scratch(&scratch[i], block_size,
+                                           chroma_sub[0], num_blocks_w + 1,
+                                           block_stride);
+    }
+  }
 
   if (chroma_sub[0] != 0) {
     init_success &= aom_flat_block_finder_init(&block_finder_chroma,
                                                block_size >> chroma_sub[0],
                                                bit_depth, use_highbd);
     window_chroma = get_half_cos_window(block_size >> chroma_sub[0]);
-    tx_chroma = aom_noise_tx_malloc(block_size >> chroma_sub[0]);
   } else {
     window_chroma = window_full;
-    tx_chroma = tx_full;
   }
 
-  init_success &= (tx_full != NULL) && (tx_chroma != NULL) && (plane != NULL) &&
-                  (plane_d != NULL) && (block != NULL) && (block_d != NULL) &&
-                  (window_full != NULL) && (window_chroma != NULL) &&
-                  (result != NULL);
+  init_success &= (scratch != NULL) && (window_full != NULL) &&
+                  (window_chroma != NULL) && (result != NULL);
   for (int c = init_success ? 0 : 3; c < 3; ++c) {
-    float *window_function = c == 0 ? window_full : window_chroma;
-    aom_flat_block_finder_t *block_finder = &block_finder_full;
     const int chroma_sub_h = c > 0 ? chroma_sub[1] : 0;
     const int chroma_sub_w = c > 0 ? chroma_sub[0] : 0;
-    struct aom_noise_tx_t *tx =
-        (c > 0 && chroma_sub[0] > 0) ? tx_chroma : tx_full;
     if (!data[c] || !denoised[c]) continue;
-    if (c > 0 && chroma_sub[0] != 0) {
-      block_finder = &block_finder_chroma;
-    }
     memset(result, 0, sizeof(*result) * result_stride * result_height);
-    // Do overlapped block processing (half overlapped). The block rows can
-    // easily be done in parallel
-    for (int offsy = 0; offsy < (block_size >> chroma_sub_h);
-         offsy += (block_size >> chroma_sub_h) / 2) {
-      for (int offsx = 0; offsx < (block_size >> chroma_sub_w);
-           offsx += (block_size >> chroma_sub_w) / 2) {
-        // Pad the boundary when processing each block-set.
-        for (int by = -1; by < num_blocks_h; ++by) {
-          for (int bx = -1; bx < num_blocks_w; ++bx) {
-            const int pixels_per_block =
-                (block_size >> chroma_sub_w) * (block_size >> chroma_sub_h);
-            aom_flat_block_finder_extract_block(
-                block_finder, data[c], w >> chroma_sub_w, h >> chroma_sub_h,
-                stride[c], bx * (block_size >> chroma_sub_w) + offsx,
-                by * (block_size >> chroma_sub_h) + offsy, plane_d, block_d);
-            for (int j = 0; j < pixels_per_block; ++j) {
-              block[j] = (float)block_d[j];
-              plane[j] = (float)plane_d[j];
-            }
-            pointwise_multiply(window_function, block, pixels_per_block);
-            aom_noise_tx_forward(tx, block);
-            aom_noise_tx_filter(tx, noise_psd[c]);
-            aom_noise_tx_inverse(tx, block);
-
-            // Apply window function to the plane approximation (we will apply
-            // it to the sum of plane + block when composing the results).
-            pointwise_multiply(window_function, plane, pixels_per_block);
-
-            for (int y = 0; y < (block_size >> chroma_sub_h); ++y) {
-              const int y_result =
-                  y + (by + 1) * (block_size >> chroma_sub_h) + offsy;
-              for (int x = 0; x < (block_size >> chroma_sub_w); ++x) {
-                const int x_result =
-                    x + (bx + 1) * (block_size >> chroma_sub_w) + offsx;
-                result[y_result * result_stride + x_result] +=
-                    (block[y * (block_size >> chroma_sub_w) + x] +
-                     plane[y * (block_size >> chroma_sub_w) + x]) *
-                    window_function[y * (block_size >> chroma_sub_w) + x];
-              }
-            }
-          }
-        }
-      }
-    }
+    // The rows of the result are split in one band per thread.
+    wiener_job_t wiener_job = {
+      { wiener_denoise_rows, num_threads, num_threads },
+      (c > 0 && chroma_sub[0] != 0) ? &block_finder_chroma
+                                    : &block_finder_full,
+      data[c],
+      w >> chroma_sub_w,
+      h >> chroma_sub_h,
+      stride[c],
+      block_size >> chroma_sub_w,
+      block_size >> chroma_sub_h,
+      num_blocks_w,
+      num_blocks_h,
+      c > 0 && chroma_sub[0] > 0,
+      c == 0 ? window_full : window_chroma,
+      noise_psd[c],
+      block_stride,
+      scratch,
+      result,
+      result_stride,
+      result_height,
+      (result_height + num_threads - 1) / num_threads,
+    };
+    run_noise_jobs(&wiener_job.job, workers);
     if (use_highbd) {
       dither_and_quantize_highbd(result, result_stride, (uint16_t *)denoised[c],
                                  w, h, stride[c], chroma_sub_w, chroma_sub_h,
@@ -1476,23 +1812,30 @@ int aom_wiener_denoise_2d(const uint8_t *const data[3], uint8_t *denoised[3],
     }
   }
   aom_free(result);
-  aom_free(plane);
-  aom_free(block);
-  aom_free(plane_d);
-  aom_free(block_d);
   aom_free(window_full);
-
-  aom_noise_tx_free(tx_full);
+  if (scratch) {
+    for (int i = 0; i < num_threads; ++i) {
+      free_wiener_scratch(&scratch[i], chroma_sub[0]);
+    }
+    aom_free(scratch);
+  }
 
   aom_flat_block_finder_free(&block_finder_full);
   if (chroma_sub[0] != 0) {
     aom_flat_block_finder_free(&block_finder_chroma);
     aom_free(window_chroma);
-    aom_noise_tx_free(tx_chroma);
   }
   return init_success;
 }
 
+int aom_wiener_denoise_2d(const uint8_t *const data[3], uint8_t *denoised[3],
+                          int w, int h, int stride[3], int chroma_sub[2],
+                          float *noise_psd[3], int block_size, int bit_depth,
+                          int use_highbd) {
+  return wiener_denoise_2d(data, denoised, w, h, stride, chroma_sub, noise_psd,
+                           block_size, bit_depth, use_highbd, NULL, 0);
+}
+
 struct aom_denoise_and_model_t {
   int block_size;
   int bit_depth;
@@ -1625,9 +1968,11 @@ static int denoise_and_model_realloc_if_necessary(
 
 // TODO(aomedia:3151): Handle a monochrome image (sd->u_buffer and sd->v_buffer
 // are null pointers) correctly.
-int aom_denoise_and_model_run(struct aom_denoise_and_model_t *ctx,
-                              const YV12_BUFFER_CONFIG *sd,
-                              aom_film_grain_t *film_grain, int apply_denoise) {
+int aom_denoise_and_model_run_mt(struct aom_denoise_and_model_t *ctx,
+                                 const YV12_BUFFER_CONFIG *sd,
+                                 aom_film_grain_t *film_grain,
+                                 int apply_denoise, AVxWorker *workers,
+                                 int num_workers) {
   const int block_size = ctx->block_size;
   const int use_highbd = (sd->flags & YV12_FLAG_HIGHBITDEPTH) != 0;
   uint8_t *raw_data[3] = {
@@ -1644,20 +1989,21 @@ int aom_denoise_and_model_run(struct aom_denoise_and_model_t *ctx,
     return 0;
   }
 
-  aom_flat_block_finder_run(&ctx->flat_block_finder, data[0], sd->y_width,
-                            sd->y_height, strides[0], ctx->flat_blocks);
+  flat_block_finder_run(&ctx->flat_block_finder, data[0], sd->y_width,
+                        sd->y_height, strides[0], ctx->flat_blocks, workers,
+                        num_workers);
 
-  if (!aom_wiener_denoise_2d(data, ctx->denoised, sd->y_width, sd->y_height,
-                             strides, chroma_sub_log2, ctx->noise_psd,
-                             block_size, ctx->bit_depth, use_highbd)) {
+  if (!wiener_denoise_2d(data, ctx->denoised, sd->y_width, sd->y_height,
+                         strides, chroma_sub_log2, ctx->noise_psd, block_size,
+                         ctx->bit_depth, use_highbd, workers, num_workers)) {
     fprintf(stderr, "Unable to denoise image\n");
     return 0;
   }
 
-  const aom_noise_status_t status = aom_noise_model_update(
+  const aom_noise_status_t status = noise_model_update(
       &ctx->noise_model, data, (const uint8_t *const *)ctx->denoised,
       sd->y_width, sd->y_height, strides, chroma_sub_log2, ctx->flat_blocks,
-      block_size);
+      block_size, workers, num_workers);
   int have_noise_estimate = 0;
   if (status == AOM_NOISE_STATUS_OK) {
     have_noise_estimate = 1;
@@ -1692,3 +2038,10 @@ int aom_denoise_and_model_run(struct aom_denoise_and_model_t *ctx,
   }
   return 1;
 }
+
+int aom_denoise_and_model_run(struct aom_denoise_and_model_t *ctx,
+                              const YV12_BUFFER_CONFIG *sd,
+                              aom_film_grain_t *film_grain, int apply_denoise) {
+  return aom_denoise_and_model_run_mt(ctx, sd, film_grain, apply_denoise, NULL,
+                                      0);
+}
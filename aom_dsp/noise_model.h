@@ -20,6 +20,7 @@ extern "C" {
 #include "aom_dsp/grain_params.h"
 #include "aom_ports/mem.h"
 #include "aom_scale/yv12config.h"
+#include "aom_util/aom_thread.h"
 
 /*!\brief Wrapper of data required to represent linear system of eqns and soln.
  */
@@ -306,6 +307,26 @@ int aom_denoise_and_model_run(struct aom_denoise_and_model_t *ctx,
                               const YV12_BUFFER_CONFIG *sd,
                               aom_film_grain_t *grain, int apply_denoise);
 
+/*!\brief Same as aom_denoise_and_model_run, using worker threads.
+ *
+ * The flat block search, the denoising and the accumulation of the noise
+ * model equations are split in rows of blocks that are processed by up to
+ * num_workers of the workers, the first one running on the calling thread.
+ * The results do not depend on the number of workers.
+ *
+ * \param[in]     ctx           Same as for aom_denoise_and_model_run
+ * \param[in,out] sd            Same as for aom_denoise_and_model_run
+ * \param[out]    grain         Same as for aom_denoise_and_model_run
+ * \param[in]     apply_denoise Same as for aom_denoise_and_model_run
+ * \param[in]     workers       Idle workers, or NULL to run on the calling
+ *                              thread only
+ * \param[in]     num_workers   Number of workers
+ */
+int aom_denoise_and_model_run_mt(struct aom_denoise_and_model_t *ctx,
+                                 const YV12_BUFFER_CONFIG *sd,
+                                 aom_film_grain_t *grain, int apply_denoise,
+                                 AVxWorker *workers, int num_workers);
+
 /*!\brief Allocates a context that can be used for denoising and noise modeling.
  *
  * \param[in]  bit_depth   Bit depth of buffers this will be run on.
@@ -118,6 +118,17 @@ void aom_noise_tx_inverse(struct aom_noise_tx_t *noise_tx, float *data) {
   }
 }
 
+void aom_noise_tx_filter_blocks(struct aom_noise_tx_t *noise_tx,
+                                const float *psd, float *data,
+                                int block_stride, int num_blocks) {
+  for (int i = 0; i < num_blocks; ++i) {
+    float *const block = data + (size_t)i * block_stride;
+    aom_noise_tx_forward(noise_tx, block);
+    aom_noise_tx_filter(noise_tx, psd);
+    aom_noise_tx_inverse(noise_tx, block);
+  }
+}
+
 void aom_noise_tx_add_energy(const struct aom_noise_tx_t *noise_tx,
                              float *psd) {
   const int block_size = noise_tx->block_size;
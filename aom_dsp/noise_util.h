@@ -44,6 +44,14 @@ void aom_noise_tx_filter(struct aom_noise_tx_t *aom_noise_tx, const float *psd);
 // aligned.
 void aom_noise_tx_inverse(struct aom_noise_tx_t *aom_noise_tx, float *data);
 
+// Denoises num_blocks blocks of data, which are block_stride floats apart, in
+// place: each block goes through aom_noise_tx_forward, aom_noise_tx_filter
+// with the given psd and aom_noise_tx_inverse. Each block must be 32-byte
+// aligned.
+void aom_noise_tx_filter_blocks(struct aom_noise_tx_t *aom_noise_tx,
+                                const float *psd, float *data,
+                                int block_stride, int num_blocks);
+
 // Aggregates the power of the buffered transform data into the psd buffer.
 void aom_noise_tx_add_energy(const struct aom_noise_tx_t *aom_noise_tx,
                              float *psd);
@@ -27,6 +27,9 @@
 //   limit
 // * Then calls aom_alloc_pyramid() to actually create the pyramid
 // * Pyramid is initially marked as containing no valid data
+// * The memory for the pyramid levels is allocated the first time the pyramid
+//   is computed, so that frame buffers whose pyramid is never used (e.g. when
+//   global motion search is disabled by the speed features) do not pay for it
 // * Each pyramid layer is computed on-demand, the first time it is requested
 // * Whenever frame buffer is reused, reset the counter of filled levels.
 //   This invalidates all of the existing pyramid levels.
@@ -116,18 +119,13 @@ ImagePyramid *aom_alloc_pyramid(int width, int height, bool image_is_16bit) {
 
   pyr->max_levels = n_levels;
   pyr->filled_levels = 0;
+  pyr->image_is_16bit = image_is_16bit;
 
-  // Compute sizes and offsets for each pyramid level
+  // Compute sizes for each pyramid level
   // These are gathered up first, so that we can allocate all pyramid levels
-  // in a single buffer
-  size_t buffer_size = 0;
-  size_t *layer_offsets = aom_calloc(n_levels, sizeof(*layer_offsets));
-  if (!layer_offsets) {
-    aom_free(pyr->layers);
-    aom_free(pyr);
-    return NULL;
-  }
-
+  // in a single buffer. The buffer itself is only allocated the first time the
+  // pyramid is computed, see alloc_pyramid_buffer().
+  //
   // Work out if we need to allocate a few extra bytes for alignment.
   // aom_memalign() will ensure that the start of the allocation is aligned
   // to a multiple of PYRAMID_ALIGNMENT. But we want the first image pixel
@@ -152,8 +150,7 @@ ImagePyramid *aom_alloc_pyramid(int width, int height, bool image_is_16bit) {
   // how many extra bytes are needed.
   size_t first_px_offset =
       (PYRAMID_PADDING + PYRAMID_ALIGNMENT - 1) & ~(PYRAMID_ALIGNMENT - 1);
-  size_t extra_bytes = first_px_offset - PYRAMID_PADDING;
-  buffer_size += extra_bytes;
+  size_t buffer_size = first_px_offset - PYRAMID_PADDING;
 
   // If the original image is stored in an 8-bit buffer, then we can point the
   // lowest pyramid level at that buffer rather than allocating a new one.
@@ -176,43 +173,49 @@ ImagePyramid *aom_alloc_pyramid(int width, int height, bool image_is_16bit) {
     int level_stride =
         (padded_width + PYRAMID_ALIGNMENT - 1) & ~(PYRAMID_ALIGNMENT - 1);
 
-    size_t level_alloc_start = buffer_size;
-    size_t level_start =
-        level_alloc_start + PYRAMID_PADDING * level_stride + PYRAMID_PADDING;
-
     buffer_size += level_stride * padded_height;
 
-    layer_offsets[level] = level_start;
     layer->width = level_width;
     layer->height = level_height;
     layer->stride = level_stride;
   }
-
-  pyr->buffer_alloc =
-      aom_memalign(PYRAMID_ALIGNMENT, buffer_size * sizeof(*pyr->buffer_alloc));
-  if (!pyr->buffer_alloc) {
-    aom_free(pyr->layers);
-    aom_free(pyr);
-    aom_free(layer_offsets);
-    return NULL;
-  }
-
-  // Fill in pointers for each level
-  // If image is 8-bit, then the lowest level is left unconfigured for now,
-  // and will be set up properly when the pyramid is filled in
-  for (int level = first_allocated_level; level < n_levels; level++) {
-    PyramidLayer *layer = &pyr->layers[level];
-    layer->buffer = pyr->buffer_alloc + layer_offsets[level];
-  }
+  pyr->buffer_size = buffer_size;
 
 #if CONFIG_MULTITHREAD
   pthread_mutex_init(&pyr->mutex, NULL);
 #endif  // CONFIG_MULTITHREAD
 
-  aom_free(layer_offsets);
   return pyr;
 }
 
+// Allocate the buffer holding the pyramid levels, and fill in pointers for
+// each level, following the layout computed by aom_alloc_pyramid().
+// If image is 8-bit, then the lowest level is left unconfigured for now,
+// and will be set up properly when the pyramid is filled in.
+//
+// Returns false on allocation failure.
+// This must only be called while holding pyr->mutex
+static bool alloc_pyramid_buffer(ImagePyramid *pyr) {
+  pyr->buffer_alloc = aom_memalign(
+      PYRAMID_ALIGNMENT, pyr->buffer_size * sizeof(*pyr->buffer_alloc));
+  if (!pyr->buffer_alloc) return false;
+
+  size_t first_px_offset =
+      (PYRAMID_PADDING + PYRAMID_ALIGNMENT - 1) & ~(PYRAMID_ALIGNMENT - 1);
+  size_t level_alloc_start = first_px_offset - PYRAMID_PADDING;
+  int first_allocated_level = pyr->image_is_16bit ? 0 : 1;
+  for (int level = first_allocated_level; level < pyr->max_levels; level++) {
+    PyramidLayer *layer = &pyr->layers[level];
+    size_t level_start = level_alloc_start + PYRAMID_PADDING * layer->stride +
+                         PYRAMID_PADDING;
+    layer->buffer = pyr->buffer_alloc + level_start;
+    level_alloc_start +=
+        layer->stride * (size_t)(layer->height + 2 * PYRAMID_PADDING);
+  }
+  assert(level_alloc_start == pyr->buffer_size);
+  return true;
+}
+
 // Fill the border region of a pyramid frame.
 // This must be called after the main image area is filled out.
 // `img_buf` should point to the first pixel in the image area,
@@ -265,6 +268,10 @@ static inline int fill_pyramid(const YV12_BUFFER_CONFIG *frame, int bit_depth,
     return n_levels;
   }
 
+  if (!frame_pyr->buffer_alloc && !alloc_pyramid_buffer(frame_pyr)) {
+    return -1;
+  }
+
   const int frame_width = frame->y_crop_width;
   const int frame_height = frame->y_crop_height;
   const int frame_stride = frame->y_stride;
@@ -409,19 +416,9 @@ int aom_compute_pyramid(const YV12_BUFFER_CONFIG *frame, int bit_depth,
   return result;
 }
 
-#ifndef NDEBUG
-// Check if a pyramid has already been computed to at least n levels
-// This is mostly a debug helper - as it is necessary to hold pyr->mutex
-// while reading the number of already-computed levels, we cannot just write:
-//   assert(pyr->filled_levels >= n_levels);
-// This function allows the check to be correctly written as:
-//   assert(aom_is_pyramid_valid(pyr, n_levels));
-//
-// Note: This deliberately does not restrict n_levels based on the maximum
-// number of permitted levels for the frame size. This allows the check to
-// catch cases where the caller forgets to handle the case where
-// max_levels is less than the requested number of levels
-bool aom_is_pyramid_valid(ImagePyramid *pyr, int n_levels) {
+// Returns the number of levels of a pyramid which currently hold valid data.
+// Levels [0, returned value) may be read without holding pyr->mutex.
+int aom_get_pyramid_filled_levels(ImagePyramid *pyr) {
   assert(pyr);
 
   // Per the comments in the ImagePyramid struct, we must take this mutex
@@ -431,13 +428,29 @@ bool aom_is_pyramid_valid(ImagePyramid *pyr, int n_levels) {
   pthread_mutex_lock(&pyr->mutex);
 #endif  // CONFIG_MULTITHREAD
 
-  bool result = (pyr->filled_levels >= n_levels);
+  int filled_levels = pyr->filled_levels;
 
 #if CONFIG_MULTITHREAD
   pthread_mutex_unlock(&pyr->mutex);
 #endif  // CONFIG_MULTITHREAD
 
-  return result;
+  return filled_levels;
+}
+
+#ifndef NDEBUG
+// Check if a pyramid has already been computed to at least n levels
+// This is mostly a debug helper - as it is necessary to hold pyr->mutex
+// while reading the number of already-computed levels, we cannot just write:
+//   assert(pyr->filled_levels >= n_levels);
+// This function allows the check to be correctly written as:
+//   assert(aom_is_pyramid_valid(pyr, n_levels));
+//
+// Note: This deliberately does not restrict n_levels based on the maximum
+// number of permitted levels for the frame size. This allows the check to
+// catch cases where the caller forgets to handle the case where
+// max_levels is less than the requested number of levels
+bool aom_is_pyramid_valid(ImagePyramid *pyr, int n_levels) {
+  return aom_get_pyramid_filled_levels(pyr) >= n_levels;
 }
 #endif
 
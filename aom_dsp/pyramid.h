@@ -82,6 +82,12 @@ typedef struct image_pyramid {
   int max_levels;
   // Number of levels which currently hold valid data
   int filled_levels;
+  // Whether the frame is stored in a 16-bit buffer, in which case the lowest
+  // level is a separately allocated 8-bit copy of it
+  bool image_is_16bit;
+  // Size of buffer_alloc in bytes. The buffer is allocated the first time the
+  // pyramid is computed, and is NULL until then
+  size_t buffer_size;
   // Pointer to allocated buffer
   uint8_t *buffer_alloc;
   // Data for each level
@@ -109,6 +115,13 @@ ImagePyramid *aom_alloc_pyramid(int width, int height, bool image_is_16bit);
 int aom_compute_pyramid(const YV12_BUFFER_CONFIG *frame, int bit_depth,
                         int n_levels, ImagePyramid *pyr);
 
+// Returns the number of levels which currently hold valid data. These levels
+// are those with index 0 to (returned value - 1), and they can be read without
+// holding pyr->mutex. This allows consumers which share the pyramid of a frame
+// to check whether it needs to be computed, e.g. to schedule the computation
+// of the pyramids of several frames on different threads.
+int aom_get_pyramid_filled_levels(ImagePyramid *pyr);
+
 #ifndef NDEBUG
 // Check if a pyramid has already been computed to at least n levels
 // This is mostly a debug helper - as it is necessary to hold pyr->mutex
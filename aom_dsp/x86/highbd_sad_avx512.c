@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <immintrin.h>  // AVX512
+
+#include "config/aom_config.h"
+#include "config/aom_dsp_rtcd.h"
+
+#include "aom/aom_integer.h"
+#include "aom_ports/mem.h"
+
+// Adds the absolute differences of 32 pixels to the 32-bit lanes of 'sad'.
+static AOM_FORCE_INLINE __m512i highbd_sad32_avx512(const uint16_t *src,
+                                                    const uint16_t *ref,
+                                                    __m512i sad) {
+  const __m512i s = _mm512_loadu_si512((const void *)src);
+  const __m512i r = _mm512_loadu_si512((const void *)ref);
+  const __m512i diff =
+      _mm512_sub_epi16(_mm512_max_epu16(s, r), _mm512_min_epu16(s, r));
+  return _mm512_add_epi32(sad, _mm512_madd_epi16(diff, _mm512_set1_epi16(1)));
+}
+
+static AOM_FORCE_INLINE unsigned int aom_highbd_sadMxN_avx512(
+    int M, int N, const uint8_t *src, int src_stride, const uint8_t *ref,
+    int ref_stride) {
+  const uint16_t *srcp = CONVERT_TO_SHORTPTR(src);
+  const uint16_t *refp = CONVERT_TO_SHORTPTR(ref);
+  __m512i sad = _mm512_setzero_si512();
+  for (int i = 0; i < N; ++i) {
+    for (int j = 0; j < M; j += 32) {
+      sad = highbd_sad32_avx512(srcp + j, refp + j, sad);
+    }
+    srcp += src_stride;
+    refp += ref_stride;
+  }
+  return (unsigned int)_mm512_reduce_add_epi32(sad);
+}
+
+static AOM_FORCE_INLINE void aom_highbd_sadMxNx4d_avx512(
+    int M, int N, const uint8_t *src, int src_stride,
+    const uint8_t *const ref_array[4], int ref_stride, uint32_t sad_array[4]) {
+  const uint16_t *srcp = CONVERT_TO_SHORTPTR(src);
+  const uint16_t *refp[4];
+  __m512i sad[4];
+  for (int k = 0; k < 4; ++k) {
+    refp[k] = CONVERT_TO_SHORTPTR(ref_array[k]);
+    sad[k] = _mm512_setzero_si512();
+  }
+  for (int i = 0; i < N; ++i) {
+    for (int j = 0; j < M; j += 32) {
+      sad[0] = highbd_sad32_avx512(srcp + j, refp[0] + j, sad[0]);
+      sad[1] = highbd_sad32_avx512(srcp + j, refp[1] + j, sad[1]);
+      sad[2] = highbd_sad32_avx512(srcp + j, refp[2] + j, sad[2]);
+      sad[3] = highbd_sad32_avx512(srcp + j, refp[3] + j, sad[3]);
+    }
+    srcp += src_stride;
+    for (int k = 0; k < 4; ++k) refp[k] += ref_stride;
+  }
+  for (int k = 0; k < 4; ++k) {
+    sad_array[k] = (uint32_t)_mm512_reduce_add_epi32(sad[k]);
+  }
+}
+
+#define HIGHBD_SADMXN_AVX512(m, n)                                            \
+  unsigned int aom_highbd_sad##m##x##n##_avx512(                              \
+      const uint8_t *src, int src_stride, const uint8_t *ref,                 \
+      int ref_stride) {                                                       \
+    return aom_highbd_sadMxN_avx512(m, n, src, src_stride, ref, ref_stride);  \
+  }                                                                           \
+  unsigned int aom_highbd_sad_skip_##m##x##n##_avx512(                        \
+      const uint8_t *src, int src_stride, const uint8_t *ref,                 \
+      int ref_stride) {                                                       \
+    return 2 * aom_highbd_sadMxN_avx512(m, (n / 2), src, 2 * src_stride, ref, \
+                                        2 * ref_stride);                      \
+  }                                                                           \
+  void aom_highbd_sad##m##x##n##x4d_avx512(                                   \
+      const uint8_t *src, int src_stride, const uint8_t *const ref_array[4],  \
+      int ref_stride, uint32_t sad_array[4]) {                                \
+    aom_highbd_sadMxNx4d_avx512(m, n, src, src_stride, ref_array, ref_stride, \
+                                sad_array);                                   \
+  }                                                                           \
+  void aom_highbd_sad_skip_##m##x##n##x4d_avx512(                             \
+      const uint8_t *src, int src_stride, const uint8_t *const ref_array[4],  \
+      int ref_stride, uint32_t sad_array[4]) {                                \
+    aom_highbd_sadMxNx4d_avx512(m, (n / 2), src, 2 * src_stride, ref_array,   \
+                                2 * ref_stride, sad_array);                   \
+    sad_array[0] <<= 1;                                                       \
+    sad_array[1] <<= 1;                                                       \
+    sad_array[2] <<= 1;                                                       \
+    sad_array[3] <<= 1;                                                       \
+  }
+
+HIGHBD_SADMXN_AVX512(32, 16)
+HIGHBD_SADMXN_AVX512(32, 32)
+HIGHBD_SADMXN_AVX512(32, 64)
+
+HIGHBD_SADMXN_AVX512(64, 32)
+HIGHBD_SADMXN_AVX512(64, 64)
+HIGHBD_SADMXN_AVX512(64, 128)
+
+HIGHBD_SADMXN_AVX512(128, 64)
+HIGHBD_SADMXN_AVX512(128, 128)
+
+#if !CONFIG_REALTIME_ONLY
+HIGHBD_SADMXN_AVX512(32, 8)
+HIGHBD_SADMXN_AVX512(64, 16)
+#endif  // !CONFIG_REALTIME_ONLY
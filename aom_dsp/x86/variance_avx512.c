@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <assert.h>
+#include <immintrin.h>  // AVX512
+
+#include "config/aom_dsp_rtcd.h"
+
+#include "aom_dsp/aom_filter.h"
+#include "aom_ports/mem.h"
+
+// Loads 64 bytes of a block: one row of a block at least 64 pixels wide, or
+// two rows of a 32 pixel wide block.
+static AOM_FORCE_INLINE __m512i load_64(const uint8_t *p, int stride, int w) {
+  if (w == 32) {
+    return _mm512_inserti64x4(
+        _mm512_castsi256_si512(_mm256_loadu_si256((const __m256i *)p)),
+        _mm256_loadu_si256((const __m256i *)(p + stride)), 1);
+  }
+  return _mm512_loadu_si512((const void *)p);
+}
+
+static AOM_FORCE_INLINE void variance_kernel_avx512(const __m512i src,
+                                                    const __m512i ref,
+                                                    __m512i *const sse,
+                                                    __m512i *const sum) {
+  const __m512i adj_sub = _mm512_set1_epi16((short)0xff01);  // (1,-1)
+  const __m512i one = _mm512_set1_epi16(1);
+
+  // unpack into pairs of source and reference values
+  const __m512i src_ref0 = _mm512_unpacklo_epi8(src, ref);
+  const __m512i src_ref1 = _mm512_unpackhi_epi8(src, ref);
+
+  // subtract adjacent elements using src*1 + ref*-1
+  const __m512i diff0 = _mm512_maddubs_epi16(src_ref0, adj_sub);
+  const __m512i diff1 = _mm512_maddubs_epi16(src_ref1, adj_sub);
+  const __m512i madd0 = _mm512_madd_epi16(diff0, diff0);
+  const __m512i madd1 = _mm512_madd_epi16(diff1, diff1);
+
+  // add to the running totals, widening the sum to 32 bits right away so that
+  // no block size can overflow it
+  *sum = _mm512_add_epi32(
+      *sum, _mm512_madd_epi16(_mm512_add_epi16(diff0, diff1), one));
+  *sse = _mm512_add_epi32(*sse, _mm512_add_epi32(madd0, madd1));
+}
+
+static AOM_FORCE_INLINE unsigned int variance_avx512(
+    const uint8_t *src, int src_stride, const uint8_t *ref, int ref_stride,
+    int w, int h, int bits, unsigned int *sse) {
+  const int rows_per_iter = w == 32 ? 2 : 1;
+  __m512i vsse = _mm512_setzero_si512();
+  __m512i vsum = _mm512_setzero_si512();
+  assert(h % rows_per_iter == 0);
+
+  for (int i = 0; i < h; i += rows_per_iter) {
+    for (int j = 0; j < w; j += 64) {
+      variance_kernel_avx512(load_64(src + j, src_stride, w),
+                             load_64(ref + j, ref_stride, w), &vsse, &vsum);
+    }
+    src += rows_per_iter * src_stride;
+    ref += rows_per_iter * ref_stride;
+  }
+
+  *sse = (unsigned int)_mm512_reduce_add_epi32(vsse);
+  const int sum = _mm512_reduce_add_epi32(vsum);
+  return *sse - (unsigned int)(((int64_t)sum * sum) >> bits);
+}
+
+#define AOM_VAR_AVX512(bw, bh, bits)                                          \
+  unsigned int aom_variance##bw##x##bh##_avx512(                              \
+      const uint8_t *src, int src_stride, const uint8_t *ref, int ref_stride, \
+      unsigned int *sse) {                                                    \
+    return variance_avx512(src, src_stride, ref, ref_stride, bw, bh, bits,    \
+                           sse);                                              \
+  }
+
+AOM_VAR_AVX512(32, 16, 9)
+AOM_VAR_AVX512(32, 32, 10)
+AOM_VAR_AVX512(32, 64, 11)
+
+AOM_VAR_AVX512(64, 32, 11)
+AOM_VAR_AVX512(64, 64, 12)
+AOM_VAR_AVX512(64, 128, 13)
+
+AOM_VAR_AVX512(128, 64, 13)
+AOM_VAR_AVX512(128, 128, 14)
+
+#if !CONFIG_REALTIME_ONLY
+AOM_VAR_AVX512(64, 16, 10)
+AOM_VAR_AVX512(32, 8, 8)
+#endif
+
+// Applies the 2-tap bilinear filter to 64 pairs of pixels. The taps are packed
+// in 'filter' as (f0, f1) byte pairs. f0 is at most 112 when both taps are
+// used, so maddubs cannot saturate and the rounding matches the C code
+// exactly.
+static AOM_FORCE_INLINE __m512i bilinear_64(const __m512i a, const __m512i b,
+                                            const __m512i filter) {
+  const __m512i round = _mm512_set1_epi16(1 << (FILTER_BITS - 1));
+  const __m512i lo = _mm512_maddubs_epi16(_mm512_unpacklo_epi8(a, b), filter);
+  const __m512i hi = _mm512_maddubs_epi16(_mm512_unpackhi_epi8(a, b), filter);
+  return _mm512_packus_epi16(
+      _mm512_srli_epi16(_mm512_add_epi16(lo, round), FILTER_BITS),
+      _mm512_srli_epi16(_mm512_add_epi16(hi, round), FILTER_BITS));
+}
+
+static AOM_FORCE_INLINE __m512i bilinear_filter_avx512(int offset) {
+  const uint8_t *const f = bilinear_filters_2t[offset];
+  return _mm512_set1_epi16((short)(f[0] | (f[1] << 8)));
+}
+
+// Sub-pixel variance of blocks at least 64 pixels wide. The horizontal and
+// vertical passes are skipped when their offset is 0, in which case the C
+// filter is the identity.
+static AOM_FORCE_INLINE unsigned int sub_pixel_variance_avx512(
+    const uint8_t *src, int src_stride, int xoffset, int yoffset,
+    const uint8_t *ref, int ref_stride, int w, int h, int bits,
+    unsigned int *sse) {
+  DECLARE_ALIGNED(64, uint8_t, fdata[(128 + 1) * 128]);
+  DECLARE_ALIGNED(64, uint8_t, temp[128 * 128]);
+  const uint8_t *p = src;
+  int p_stride = src_stride;
+  assert(w % 64 == 0);
+
+  if (xoffset) {
+    const __m512i filter = bilinear_filter_avx512(xoffset);
+    const int out_h = yoffset ? h + 1 : h;
+    for (int i = 0; i < out_h; ++i) {
+      for (int j = 0; j < w; j += 64) {
+        const __m512i a = _mm512_loadu_si512((const void *)(p + j));
+        const __m512i b = _mm512_loadu_si512((const void *)(p + j + 1));
+        _mm512_store_si512((void *)(fdata + i * w + j),
+                           bilinear_64(a, b, filter));
+      }
+      p += p_stride;
+    }
+    p = fdata;
+    p_stride = w;
+  }
+
+  if (yoffset) {
+    const __m512i filter = bilinear_filter_avx512(yoffset);
+    for (int i = 0; i < h; ++i) {
+      for (int j = 0; j < w; j += 64) {
+        const __m512i a = _mm512_loadu_si512((const void *)(p + j));
+        const __m512i b = _mm512_loadu_si512((const void *)(p + p_stride + j));
+        _mm512_store_si512((void *)(temp + i * w + j),
+                           bilinear_64(a, b, filter));
+      }
+      p += p_stride;
+    }
+    p = temp;
+    p_stride = w;
+  }
+
+  return variance_avx512(p, p_stride, ref, ref_stride, w, h, bits, sse);
+}
+
+#define AOM_SUB_PIXEL_VAR_AVX512(bw, bh, bits)                                 \
+  unsigned int aom_sub_pixel_variance##bw##x##bh##_avx512(                     \
+      const uint8_t *src, int src_stride, int xoffset, int yoffset,            \
+      const uint8_t *ref, int ref_stride, unsigned int *sse) {                 \
+    return sub_pixel_variance_avx512(src, src_stride, xoffset, yoffset, ref,   \
+                                     ref_stride, bw, bh, bits, sse);           \
+  }
+
+AOM_SUB_PIXEL_VAR_AVX512(64, 32, 11)
+AOM_SUB_PIXEL_VAR_AVX512(64, 64, 12)
+AOM_SUB_PIXEL_VAR_AVX512(64, 128, 13)
+
+AOM_SUB_PIXEL_VAR_AVX512(128, 64, 13)
+AOM_SUB_PIXEL_VAR_AVX512(128, 128, 14)
+
+#if !CONFIG_REALTIME_ONLY
+AOM_SUB_PIXEL_VAR_AVX512(64, 16, 10)
+#endif
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "aom_mem/aom_arena.h"
+#include "aom_mem/aom_mem.h"
+#include "aom_mem/include/aom_mem_intrnl.h"
+
+typedef struct AVxArenaBlock {
+  struct AVxArenaBlock *next;
+  // Size of the data following the header.
+  size_t size;
+  // Offset of the first free byte in the data.
+  size_t used;
+} AVxArenaBlock;
+
+static inline uint8_t *block_data(AVxArenaBlock *block) {
+  return (uint8_t *)(block + 1);
+}
+
+// Allocates a block of at least 'size' bytes and appends it to the arena.
+static AVxArenaBlock *alloc_block(AVxArena *arena, size_t size) {
+  if (size > AOM_MAX_ALLOCABLE_MEMORY - sizeof(AVxArenaBlock)) return NULL;
+  AVxArenaBlock *const block =
+      (AVxArenaBlock *)aom_malloc(sizeof(*block) + size);
+  if (block == NULL) return NULL;
+  block->next = NULL;
+  block->size = size;
+  block->used = 0;
+  if (arena->head == NULL) {
+    arena->head = block;
+  } else {
+    AVxArenaBlock *last = arena->cur != NULL ? arena->cur : arena->head;
+    while (last->next != NULL) last = last->next;
+    last->next = block;
+  }
+  arena->reserved += size;
+  ++arena->num_system_allocs;
+  return block;
+}
+
+static void free_blocks(AVxArena *arena) {
+  AVxArenaBlock *block = arena->head;
+  while (block != NULL) {
+    AVxArenaBlock *const next = block->next;
+    aom_free(block);
+    block = next;
+  }
+  arena->head = NULL;
+  arena->cur = NULL;
+  arena->reserved = 0;
+}
+
+void aom_arena_init(AVxArena *arena, size_t min_block_size) {
+  memset(arena, 0, sizeof(*arena));
+  arena->min_block_size = min_block_size;
+}
+
+void aom_arena_free(AVxArena *arena) {
+  free_blocks(arena);
+  arena->used = 0;
+}
+
+void *aom_arena_memalign(AVxArena *arena, size_t align, size_t size) {
+  assert(align > 0 && (align & (align - 1)) == 0);
+  if (size > AOM_MAX_ALLOCABLE_MEMORY - align) return NULL;
+
+  AVxArenaBlock *block = arena->cur;
+  if (block == NULL && arena->head != NULL) {
+    block = arena->cur = arena->head;
+    block->used = 0;
+  }
+  while (block != NULL) {
+    const uintptr_t data = (uintptr_t)block_data(block);
+    const size_t start =
+        (size_t)((data + block->used + align - 1) & ~(uintptr_t)(align - 1)) -
+        (size_t)data;
+    if (start <= block->size && size <= block->size - start) {
+      arena->used += start + size - block->used;
+      if (arena->used > arena->peak_used) arena->peak_used = arena->used;
+      block->used = start + size;
+      return block_data(block) + start;
+    }
+    block = block->next;
+    if (block != NULL) {
+      arena->cur = block;
+      block->used = 0;
+    }
+  }
+
+  // Grow geometrically, so that the number of blocks stays logarithmic in the
+  // peak usage.
+  size_t block_size = size + align - 1;
+  if (block_size < arena->min_block_size) block_size = arena->min_block_size;
+  if (block_size < arena->reserved) block_size = arena->reserved;
+  block = alloc_block(arena, block_size);
+  if (block == NULL) return NULL;
+  arena->cur = block;
+  return aom_arena_memalign(arena, align, size);
+}
+
+void *aom_arena_malloc(AVxArena *arena, size_t size) {
+  return aom_arena_memalign(arena, DEFAULT_ALIGNMENT, size);
+}
+
+void *aom_arena_calloc(AVxArena *arena, size_t num, size_t size) {
+  if (num != 0 && size > AOM_MAX_ALLOCABLE_MEMORY / num) return NULL;
+  void *const x = aom_arena_malloc(arena, num * size);
+  if (x) memset(x, 0, num * size);
+  return x;
+}
+
+AVxArenaMark aom_arena_mark(const AVxArena *arena) {
+  AVxArenaMark mark;
+  mark.block = arena->cur;
+  mark.block_used = arena->cur != NULL ? arena->cur->used : 0;
+  mark.used = arena->used;
+  return mark;
+}
+
+void aom_arena_release(AVxArena *arena, AVxArenaMark mark) {
+  assert(mark.used <= arena->used);
+  arena->cur = mark.block;
+  if (mark.block != NULL) mark.block->used = mark.block_used;
+  arena->used = mark.used;
+}
+
+void aom_arena_reset(AVxArena *arena) {
+  arena->cur = NULL;
+  arena->used = 0;
+  if (arena->head == NULL || arena->head->next == NULL) return;
+
+  // Merge the blocks, so that the next cycle fits in one block.
+  const size_t reserved = arena->reserved;
+  free_blocks(arena);
+  // On failure the arena is left empty, and grows again on demand.
+  alloc_block(arena, reserved);
+}
+
+void aom_arena_get_stats(const AVxArena *arena, AVxArenaStats *stats) {
+  stats->used = arena->used;
+  stats->peak_used = arena->peak_used;
+  stats->reserved = arena->reserved;
+  stats->num_system_allocs = arena->num_system_allocs;
+}
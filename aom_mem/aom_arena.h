@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+// Bump allocator for scratch buffers with a well defined lifetime, e.g. the
+// buffers used while encoding one frame.
+//
+// Memory is obtained from aom_malloc() in blocks and handed out sequentially.
+// Individual allocations are never freed: the arena is rolled back to a mark
+// taken earlier, or reset as a whole. Blocks are kept when the arena is rolled
+// back, and reset merges them into a single block, so once the arena has
+// grown to the peak requirement of its users no further system allocations
+// are made.
+//
+// An arena is not thread safe. Memory obtained from it may be used by any
+// thread, but allocations, marks and resets must be done by one thread at a
+// time.
+
+#ifndef AOM_AOM_MEM_AOM_ARENA_H_
+#define AOM_AOM_MEM_AOM_ARENA_H_
+
+#include <stddef.h>
+
+#include "config/aom_config.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+struct AVxArenaBlock;
+
+typedef struct AVxArena {
+  // All the blocks, in allocation order.
+  struct AVxArenaBlock *head;
+  // Block allocations are made from. The blocks after it are unused.
+  struct AVxArenaBlock *cur;
+  // Minimum size of the blocks allocated from the system.
+  size_t min_block_size;
+  // Bytes handed out, including alignment padding.
+  size_t used;
+  // Highest value of 'used' since aom_arena_init().
+  size_t peak_used;
+  // Total size of the blocks.
+  size_t reserved;
+  // Number of blocks allocated from the system since aom_arena_init().
+  unsigned int num_system_allocs;
+} AVxArena;
+
+// Position in an arena. Rolling back to it releases everything allocated
+// after the mark was taken.
+typedef struct AVxArenaMark {
+  struct AVxArenaBlock *block;
+  size_t block_used;
+  size_t used;
+} AVxArenaMark;
+
+typedef struct AVxArenaStats {
+  size_t used;
+  size_t peak_used;
+  size_t reserved;
+  unsigned int num_system_allocs;
+} AVxArenaStats;
+
+// Initializes an empty arena. No memory is allocated until the first
+// allocation.
+void aom_arena_init(AVxArena *arena, size_t min_block_size);
+
+// Frees all the memory held by the arena. The arena may be initialized again
+// afterwards.
+void aom_arena_free(AVxArena *arena);
+
+// Returns a buffer of 'size' bytes aligned to 'align', which must be a power
+// of two, or NULL if the allocation fails.
+void *aom_arena_memalign(AVxArena *arena, size_t align, size_t size);
+
+// Returns a buffer of 'size' bytes with the same alignment as aom_malloc(), or
+// NULL if the allocation fails.
+void *aom_arena_malloc(AVxArena *arena, size_t size);
+
+// Returns a zeroed buffer of num * size bytes with the same alignment as
+// aom_calloc(), or NULL if the allocation fails.
+void *aom_arena_calloc(AVxArena *arena, size_t num, size_t size);
+
+AVxArenaMark aom_arena_mark(const AVxArena *arena);
+
+// Releases the allocations made since 'mark' was taken. Marks must be
+// released in the reverse order in which they were taken.
+void aom_arena_release(AVxArena *arena, AVxArenaMark mark);
+
+// Releases all the allocations. Also reclaims the allocations of callers that
+// did not release their mark, e.g. because of an error.
+void aom_arena_reset(AVxArena *arena);
+
+void aom_arena_get_stats(const AVxArena *arena, AVxArenaStats *stats);
+
+#if defined(__cplusplus)
+}  // extern "C"
+#endif
+
+#endif  // AOM_AOM_MEM_AOM_ARENA_H_
@@ -13,7 +13,9 @@ if(AOM_AOM_MEM_AOM_MEM_CMAKE_)
 endif() # AOM_AOM_MEM_AOM_MEM_CMAKE_
 set(AOM_AOM_MEM_AOM_MEM_CMAKE_ 1)
 
-list(APPEND AOM_MEM_SOURCES "${AOM_ROOT}/aom_mem/aom_mem.c"
+list(APPEND AOM_MEM_SOURCES "${AOM_ROOT}/aom_mem/aom_arena.c"
+            "${AOM_ROOT}/aom_mem/aom_arena.h"
+            "${AOM_ROOT}/aom_mem/aom_mem.c"
             "${AOM_ROOT}/aom_mem/aom_mem.h"
             "${AOM_ROOT}/aom_mem/include/aom_mem_intrnl.h")
 
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+// Minimal set of atomic operations on int, for compilers without C11
+// <stdatomic.h> support.
+
+#ifndef AOM_AOM_UTIL_AOM_ATOMICS_H_
+#define AOM_AOM_UTIL_AOM_ATOMICS_H_
+
+#if defined(__GNUC__) || defined(__clang__)
+#define AOM_USE_GCC_ATOMICS 1
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#define AOM_USE_MSVC_ATOMICS 1
+#else
+#error "aom_atomics.h: atomic operations are not supported by this compiler."
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct aom_atomic_int {
+  volatile int value;
+} aom_atomic_int;
+
+// Initialization is not atomic; the object must not be shared yet.
+static inline void aom_atomic_init(aom_atomic_int *atomic, int value) {
+  atomic->value = value;
+}
+
+static inline int aom_atomic_load_acquire(const aom_atomic_int *atomic) {
+#if AOM_USE_GCC_ATOMICS
+  return __atomic_load_n(&atomic->value, __ATOMIC_ACQUIRE);
+#else
+  return _InterlockedCompareExchange((volatile long *)&atomic->value, 0, 0);
+#endif
+}
+
+// Sequentially consistent load.
+static inline int aom_atomic_load(const aom_atomic_int *atomic) {
+#if AOM_USE_GCC_ATOMICS
+  return __atomic_load_n(&atomic->value, __ATOMIC_SEQ_CST);
+#else
+  return _InterlockedCompareExchange((volatile long *)&atomic->value, 0, 0);
+#endif
+}
+
+static inline void aom_atomic_store_release(aom_atomic_int *atomic,
+                                            int value) {
+#if AOM_USE_GCC_ATOMICS
+  __atomic_store_n(&atomic->value, value, __ATOMIC_RELEASE);
+#else
+  _InterlockedExchange((volatile long *)&atomic->value, value);
+#endif
+}
+
+// Sequentially consistent add. Returns the previous value.
+static inline int aom_atomic_fetch_add(aom_atomic_int *atomic, int value) {
+#if AOM_USE_GCC_ATOMICS
+  return __atomic_fetch_add(&atomic->value, value, __ATOMIC_SEQ_CST);
+#else
+  return _InterlockedExchangeAdd((volatile long *)&atomic->value, value);
+#endif
+}
+
+// Sequentially consistent maximum. Returns the previous value.
+static inline int aom_atomic_fetch_max(aom_atomic_int *atomic, int value) {
+  int prev = aom_atomic_load(atomic);
+  while (prev < value) {
+#if AOM_USE_GCC_ATOMICS
+    if (__atomic_compare_exchange_n(&atomic->value, &prev, value,
+                                    /*weak=*/1, __ATOMIC_SEQ_CST,
+                                    __ATOMIC_SEQ_CST)) {
+      break;
+    }
+#else
+    const int cur = _InterlockedCompareExchange(
+        (volatile long *)&atomic->value, value, prev);
+    if (cur == prev) break;
+    prev = cur;
+#endif
+  }
+  return prev;
+}
+
+// Hints the processor that the caller is in a spin-wait loop.
+static inline void aom_cpu_relax(void) {
+#if AOM_USE_GCC_ATOMICS
+#if defined(__i386__) || defined(__x86_64__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__) || (defined(__arm__) && __ARM_ARCH >= 7)
+  __asm__ __volatile__("yield" ::: "memory");
+#else
+  __asm__ __volatile__("" ::: "memory");
+#endif
+#else
+#if defined(_M_IX86) || defined(_M_X64)
+  _mm_pause();
+#elif defined(_M_ARM64) || defined(_M_ARM)
+  __yield();
+#else
+  _ReadWriteBarrier();
+#endif
+#endif
+}
+
+#undef AOM_USE_GCC_ATOMICS
+#undef AOM_USE_MSVC_ATOMICS
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AOM_AOM_UTIL_AOM_ATOMICS_H_
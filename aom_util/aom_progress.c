@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <stddef.h>
+
+#include "config/aom_config.h"
+
+#include "aom_mem/aom_mem.h"
+#include "aom_util/aom_progress.h"
+
+// Number of times a waiter polls the counter before blocking. Row
+// dependencies are usually satisfied within a few microseconds, which is much
+// less than the cost of sleeping and being woken up.
+#define PROGRESS_SPIN_COUNT 1024
+
+void aom_progress_init(AVxProgress *progress, int value) {
+  aom_atomic_init(&progress->value, value);
+  aom_atomic_init(&progress->num_waiters, 0);
+#if CONFIG_MULTITHREAD
+  pthread_mutex_init(&progress->mutex, NULL);
+  pthread_cond_init(&progress->cond, NULL);
+#endif  // CONFIG_MULTITHREAD
+}
+
+void aom_progress_destroy(AVxProgress *progress) {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_destroy(&progress->mutex);
+  pthread_cond_destroy(&progress->cond);
+#else
+  (void)progress;
+#endif  // CONFIG_MULTITHREAD
+}
+
+void aom_progress_reset(AVxProgress *progress, int value) {
+  aom_atomic_init(&progress->value, value);
+}
+
+void aom_progress_wait(AVxProgress *progress, int target) {
+  if (aom_atomic_load_acquire(&progress->value) >= target) return;
+#if CONFIG_MULTITHREAD
+  for (int i = 0; i < PROGRESS_SPIN_COUNT; ++i) {
+    aom_cpu_relax();
+    if (aom_atomic_load_acquire(&progress->value) >= target) return;
+  }
+
+  // The waiter count is incremented before the value is checked again, and
+  // aom_progress_set() updates the value before checking the waiter count.
+  // With sequentially consistent operations, at least one of the two threads
+  // sees the other's update, so a wakeup cannot be missed.
+  pthread_mutex_lock(&progress->mutex);
+  aom_atomic_fetch_add(&progress->num_waiters, 1);
+  while (aom_atomic_load(&progress->value) < target) {
+    pthread_cond_wait(&progress->cond, &progress->mutex);
+  }
+  aom_atomic_fetch_add(&progress->num_waiters, -1);
+  pthread_mutex_unlock(&progress->mutex);
+#endif  // CONFIG_MULTITHREAD
+}
+
+void aom_progress_set(AVxProgress *progress, int value) {
+  if (aom_atomic_fetch_max(&progress->value, value) >= value) return;
+#if CONFIG_MULTITHREAD
+  if (aom_atomic_load(&progress->num_waiters) > 0) {
+    pthread_mutex_lock(&progress->mutex);
+    pthread_cond_broadcast(&progress->cond);
+    pthread_mutex_unlock(&progress->mutex);
+  }
+#endif  // CONFIG_MULTITHREAD
+}
+
+int aom_progress_alloc_array(AVxProgress **progress, int num, int value) {
+  *progress = aom_malloc(sizeof(**progress) * num);
+  if (*progress == NULL) return 0;
+  for (int i = 0; i < num; ++i) aom_progress_init(&(*progress)[i], value);
+  return 1;
+}
+
+void aom_progress_free_array(AVxProgress **progress, int num) {
+  if (*progress == NULL) return;
+  for (int i = 0; i < num; ++i) aom_progress_destroy(&(*progress)[i]);
+  aom_free(*progress);
+  *progress = NULL;
+}
+
+void aom_progress_reset_array(AVxProgress *progress, int num, int value) {
+  for (int i = 0; i < num; ++i) aom_progress_reset(&progress[i], value);
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+// Progress counter used to synchronize the rows of a wavefront: the thread
+// processing a row publishes how far it got, and the thread processing the
+// next row waits until that position is far enough ahead.
+//
+// The counter is an atomic int, so publishing and checking progress do not
+// take a lock. A waiter first spins for a bounded number of iterations, then
+// blocks on a condition variable. The mutex is only taken by a writer when a
+// thread is blocked on the counter.
+
+#ifndef AOM_AOM_UTIL_AOM_PROGRESS_H_
+#define AOM_AOM_UTIL_AOM_PROGRESS_H_
+
+#include "config/aom_config.h"
+
+#include "aom_util/aom_atomics.h"
+#include "aom_util/aom_pthread.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct AVxProgress {
+  aom_atomic_int value;
+  // Number of threads blocked on cond.
+  aom_atomic_int num_waiters;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+#endif  // CONFIG_MULTITHREAD
+} AVxProgress;
+
+void aom_progress_init(AVxProgress *progress, int value);
+
+void aom_progress_destroy(AVxProgress *progress);
+
+// Sets the value unconditionally. Must not be called while other threads
+// access the counter, e.g. between frames.
+void aom_progress_reset(AVxProgress *progress, int value);
+
+static inline int aom_progress_get(const AVxProgress *progress) {
+  return aom_atomic_load_acquire(&progress->value);
+}
+
+// Waits until the value is at least 'target'. Writes made by the thread that
+// published that value are visible once this returns.
+void aom_progress_wait(AVxProgress *progress, int target);
+
+// Raises the value to 'value' and wakes up the threads waiting for it. The
+// value never decreases, so that a thread that aborts on error can publish a
+// final value without being overwritten by a late, smaller update.
+void aom_progress_set(AVxProgress *progress, int value);
+
+// Helpers for arrays of counters, one per row.
+int aom_progress_alloc_array(AVxProgress **progress, int num, int value);
+void aom_progress_free_array(AVxProgress **progress, int num);
+void aom_progress_reset_array(AVxProgress *progress, int num, int value);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AOM_AOM_UTIL_AOM_PROGRESS_H_
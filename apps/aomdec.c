@@ -83,6 +83,9 @@ static const arg_def_t threadsarg =
     ARG_DEF("t", "threads", 1, "Max threads to use");
 static const arg_def_t rowmtarg =
     ARG_DEF(NULL, "row-mt", 1, "Enable row based multi-threading, default: 0");
+static const arg_def_t frameparallelarg =
+    ARG_DEF(NULL, "frame-parallel", 1,
+            "Number of temporal units to decode in parallel, default: 0");
 static const arg_def_t verbosearg =
     ARG_DEF("v", "verbose", 0, "Show version string");
 static const arg_def_t scalearg =
@@ -107,13 +110,13 @@ static const arg_def_t skipfilmgrain =
     ARG_DEF(NULL, "skip-film-grain", 0, "Skip film grain application");
 
 static const arg_def_t *all_args[] = {
-  &help,           &codecarg, &use_yv12,      &use_i420,
-  &flipuvarg,      &rawvideo, &noblitarg,     &progressarg,
-  &limitarg,       &skiparg,  &summaryarg,    &outputfile,
-  &threadsarg,     &rowmtarg, &verbosearg,    &scalearg,
-  &fb_arg,         &md5arg,   &framestatsarg, &continuearg,
-  &outbitdeptharg, &isannexb, &oppointarg,    &outallarg,
-  &skipfilmgrain,  NULL
+  &help,        &codecarg,       &use_yv12,         &use_i420,
+  &flipuvarg,   &rawvideo,       &noblitarg,        &progressarg,
+  &limitarg,    &skiparg,        &summaryarg,       &outputfile,
+  &threadsarg,  &rowmtarg,       &frameparallelarg, &verbosearg,
+  &scalearg,    &fb_arg,         &md5arg,           &framestatsarg,
+  &continuearg, &outbitdeptharg, &isannexb,         &oppointarg,
+  &outallarg,   &skipfilmgrain,  NULL
 };
 
 #if CONFIG_LIBYUV
@@ -472,6 +475,7 @@ static int main_loop(int argc, const char **argv_) {
   int output_all_layers = 0;
   int skip_film_grain = 0;
   int enable_row_mt = 0;
+  unsigned int frame_parallel = 0;
   aom_image_t *scaled_img = NULL;
   aom_image_t *img_shifted = NULL;
   int frame_avail, got_data, flush_decoder = 0;
@@ -574,6 +578,8 @@ static int main_loop(int argc, const char **argv_) {
 #endif
     } else if (arg_match(&arg, &rowmtarg, argi)) {
       enable_row_mt = arg_parse_uint(&arg);
+    } else if (arg_match(&arg, &frameparallelarg, argi)) {
+      frame_parallel = arg_parse_uint(&arg);
     } else if (arg_match(&arg, &verbosearg, argi)) {
       quiet = 0;
     } else if (arg_match(&arg, &scalearg, argi)) {
@@ -748,6 +754,14 @@ static int main_loop(int argc, const char **argv_) {
     goto fail;
   }
 
+  if (frame_parallel > 1 &&
+      AOM_CODEC_CONTROL_TYPECHECKED(&decoder, AV1D_SET_FRAME_PARALLEL,
+                                    frame_parallel)) {
+    fprintf(stderr, "Failed to set frame parallel mode: %s\n",
+            aom_codec_error(&decoder));
+    goto fail;
+  }
+
   if (arg_skip) fprintf(stderr, "Skipping first %d frames.\n", arg_skip);
   while (arg_skip) {
     if (read_frame(&input, &buf, &bytes_in_buffer, &buffer_size)) break;
@@ -33,6 +33,8 @@
 #include "aom_ports/aom_timer.h"
 #include "aom_ports/mem_ops.h"
 #include "common/args.h"
+#include "common/async_writer.h"
+#include "common/input_prefetch.h"
 #include "common/ivfenc.h"
 #include "common/tools_common.h"
 #include "common/warnings.h"
@@ -64,6 +66,12 @@ static size_t wrap_fwrite(const void *ptr, size_t size, size_t nmemb,
 
 static const char *exec_name;
 
+// Output is written in blocks of OUTPUT_BUFFER_SIZE bytes. The output writer
+// thread may fall up to OUTPUT_QUEUE_SIZE bytes behind the encoder before the
+// encoder waits for it.
+#define OUTPUT_BUFFER_SIZE (4 << 20)
+#define OUTPUT_QUEUE_SIZE (64 << 20)
+
 static AOM_TOOLS_FORMAT_PRINTF(3, 0) void warn_or_exit_on_errorv(
     aom_codec_ctx_t *ctx, int fatal, const char *s, va_list ap) {
   if (ctx->err) {
@@ -105,7 +113,9 @@ static int read_frame(struct AvxInputContext *input_ctx, aom_image_t *img) {
   y4m_input *y4m = &input_ctx->y4m;
   int shortread = 0;
 
-  if (input_ctx->file_type == FILE_TYPE_Y4M) {
+  if (input_ctx->prefetch) {
+    return input_prefetch_read(input_ctx->prefetch, img);
+  } else if (input_ctx->file_type == FILE_TYPE_Y4M) {
     if (y4m_input_fetch_frame(y4m, f, img) < 1) return 0;
   } else {
     shortread = read_yuv_frame(input_ctx, img);
@@ -114,6 +124,12 @@ static int read_frame(struct AvxInputContext *input_ctx, aom_image_t *img) {
   return !shortread;
 }
 
+// Returns the offset in the input just past the last frame read.
+static int64_t input_tell(const struct AvxInputContext *input_ctx) {
+  if (input_ctx->prefetch) return input_prefetch_tell(input_ctx->prefetch);
+  return ftello(input_ctx->file);
+}
+
 static int file_is_y4m(const char detect[4]) {
   if (memcmp(detect, "YUV4", 4) == 0) {
     return 1;
@@ -561,6 +577,10 @@ struct stream_state {
   struct stream_state *next;
   struct stream_config config;
   FILE *file;
+  // Writes frame packets to 'file' on a separate thread.
+  AsyncWriter *writer;
+  FileOffset ivf_header_pos;
+  size_t ivf_frame_size;
   struct rate_hist *rate_hist;
   struct WebmOutputContext webm_ctx;
   uint64_t psnr_sse_total[2];
@@ -797,6 +817,8 @@ static void open_input_file(struct AvxInputContext *input,
 }
 
 static void close_input_file(struct AvxInputContext *input) {
+  input_prefetch_destroy(input->prefetch);
+  input->prefetch = NULL;
   fclose(input->file);
   if (input->file_type == FILE_TYPE_Y4M) y4m_input_close(&input->y4m);
 }
@@ -1415,6 +1437,39 @@ static void show_stream_config(struct stream_state *stream,
   }
 }
 
+// Writes a frame packet to the output file. Called on the output writer
+// thread, which owns the file and the WebM context while it runs.
+static void write_frame_packet(void *priv, const aom_codec_cx_pkt_t *pkt) {
+  struct stream_state *const stream = (struct stream_state *)priv;
+#if CONFIG_WEBM_IO
+  if (stream->config.write_webm) {
+    if (write_webm_block(&stream->webm_ctx, &stream->config.cfg, pkt) != 0) {
+      fatal("WebM writer failed.");
+    }
+  }
+#endif
+  if (!stream->config.write_webm) {
+    if (stream->config.write_ivf) {
+      if (pkt->data.frame.partition_id <= 0) {
+        stream->ivf_header_pos = ftello(stream->file);
+        stream->ivf_frame_size = pkt->data.frame.sz;
+
+        ivf_write_frame_header(stream->file, pkt->data.frame.pts,
+                               stream->ivf_frame_size);
+      } else {
+        stream->ivf_frame_size += pkt->data.frame.sz;
+
+        const FileOffset currpos = ftello(stream->file);
+        fseeko(stream->file, stream->ivf_header_pos, SEEK_SET);
+        ivf_write_frame_size(stream->file, stream->ivf_frame_size);
+        fseeko(stream->file, currpos, SEEK_SET);
+      }
+    }
+
+    (void)fwrite(pkt->data.frame.buf, 1, pkt->data.frame.sz, stream->file);
+  }
+}
+
 static void open_output_file(struct stream_state *stream,
                              struct AvxEncoderConfig *global,
                              const struct AvxRational *pixel_aspect_ratio,
@@ -1427,6 +1482,8 @@ static void open_output_file(struct stream_state *stream,
   stream->file = strcmp(fn, "-") ? fopen(fn, "wb") : set_binary_mode(stdout);
 
   if (!stream->file) fatal("Failed to open output file");
+  // Batch the many small writes of a frame into large writes.
+  setvbuf(stream->file, NULL, _IOFBF, OUTPUT_BUFFER_SIZE);
 
   if (stream->config.write_webm && fseek(stream->file, 0, SEEK_CUR))
     fatal("WebM output to pipes not supported.");
@@ -1450,6 +1507,10 @@ static void open_output_file(struct stream_state *stream,
     ivf_write_file_header(stream->file, cfg,
                           get_fourcc_by_aom_encoder(global->codec), 0);
   }
+
+  stream->writer =
+      async_writer_create(write_frame_packet, stream, OUTPUT_QUEUE_SIZE);
+  if (!stream->writer) fatal("Failed to create output writer");
 }
 
 static void close_output_file(struct stream_state *stream,
@@ -1458,6 +1519,9 @@ static void close_output_file(struct stream_state *stream,
 
   if (cfg->g_pass == AOM_RC_FIRST_PASS) return;
 
+  async_writer_destroy(stream->writer);
+  stream->writer = NULL;
+
 #if CONFIG_WEBM_IO
   if (stream->config.write_webm) {
     if (write_webm_file_footer(&stream->webm_ctx) != 0) {
@@ -1739,9 +1803,6 @@ static void get_cx_data(struct stream_state *stream,
 
   *got_data = 0;
   while ((pkt = aom_codec_get_cx_data(&stream->encoder, &iter))) {
-    static size_t fsize = 0;
-    static FileOffset ivf_header_pos = 0;
-
     switch (pkt->kind) {
       case AOM_CODEC_CX_FRAME_PKT:
         ++stream->frames_out;
@@ -1749,32 +1810,12 @@ static void get_cx_data(struct stream_state *stream,
           fprintf(stderr, " %6luF", (unsigned long)pkt->data.frame.sz);
 
         update_rate_histogram(stream->rate_hist, cfg, pkt);
-#if CONFIG_WEBM_IO
-        if (stream->config.write_webm) {
-          if (write_webm_block(&stream->webm_ctx, cfg, pkt) != 0) {
-            fatal("WebM writer failed.");
-          }
-        }
-#endif
-        if (!stream->config.write_webm) {
-          if (stream->config.write_ivf) {
-            if (pkt->data.frame.partition_id <= 0) {
-              ivf_header_pos = ftello(stream->file);
-              fsize = pkt->data.frame.sz;
-
-              ivf_write_frame_header(stream->file, pkt->data.frame.pts, fsize);
-            } else {
-              fsize += pkt->data.frame.sz;
-
-              const FileOffset currpos = ftello(stream->file);
-              fseeko(stream->file, ivf_header_pos, SEEK_SET);
-              ivf_write_frame_size(stream->file, fsize);
-              fseeko(stream->file, currpos, SEEK_SET);
-            }
+        if (stream->writer) {
+          if (async_writer_push(stream->writer, pkt) != 0) {
+            fatal("Failed to queue output packet.");
           }
-
-          (void)fwrite(pkt->data.frame.buf, 1, pkt->data.frame.sz,
-                       stream->file);
+        } else {
+          write_frame_packet(stream, pkt);
         }
         stream->nbytes += pkt->data.raw.sz;
 
@@ -2382,11 +2423,15 @@ int main(int argc, const char **argv_) {
       }
     }
 
+    // Read ahead of the encoder from here on. The prefetcher and the Y4M
+    // reader do their own allocation.
+    input.prefetch = input_prefetch_create(&input);
+    if (input.file_type != FILE_TYPE_Y4M && !input.prefetch &&
+        !raw.img_data) {
+      aom_img_alloc(&raw, input.fmt, input.width, input.height, 32);
+    }
+
     if (pass == (global.pass ? global.pass - 1 : 0)) {
-      // The Y4M reader does its own allocation.
-      if (input.file_type != FILE_TYPE_Y4M) {
-        aom_img_alloc(&raw, input.fmt, input.width, input.height, 32);
-      }
       FOREACH_STREAM(stream, streams) {
         stream->rate_hist =
             init_rate_histogram(&stream->config.cfg, &global.framerate);
@@ -2517,7 +2562,7 @@ int main(int argc, const char **argv_) {
 
         if (!got_data && input.length && streams != NULL &&
             !streams->frames_out) {
-          lagged_count = global.limit ? seen_frames : ftello(input.file);
+          lagged_count = global.limit ? seen_frames : input_tell(&input);
         } else if (input.length) {
           int64_t remaining;
           int64_t rate;
@@ -2529,7 +2574,7 @@ int main(int argc, const char **argv_) {
             remaining = 1000 * (global.limit - global.skip_frames -
                                 seen_frames + lagged_count);
           } else {
-            const int64_t input_pos = ftello(input.file);
+            const int64_t input_pos = input_tell(&input);
             const int64_t input_pos_lagged = input_pos - lagged_count;
             const int64_t input_limit = input.length;
 
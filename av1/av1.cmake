@@ -104,6 +104,7 @@ list(APPEND AOM_AV1_DECODER_SOURCES
             "${AOM_ROOT}/av1/decoder/decodetxb.h"
             "${AOM_ROOT}/av1/decoder/detokenize.c"
             "${AOM_ROOT}/av1/decoder/detokenize.h"
+            "${AOM_ROOT}/av1/decoder/dthread.c"
             "${AOM_ROOT}/av1/decoder/dthread.h"
             "${AOM_ROOT}/av1/decoder/grain_synthesis.c"
             "${AOM_ROOT}/av1/decoder/grain_synthesis.h"
@@ -189,6 +190,8 @@ list(APPEND AOM_AV1_ENCODER_SOURCES
             "${AOM_ROOT}/av1/encoder/ml.c"
             "${AOM_ROOT}/av1/encoder/ml.h"
             "${AOM_ROOT}/av1/encoder/model_rd.h"
+            "${AOM_ROOT}/av1/encoder/motion_field_cache.c"
+            "${AOM_ROOT}/av1/encoder/motion_field_cache.h"
             "${AOM_ROOT}/av1/encoder/motion_search_facade.c"
             "${AOM_ROOT}/av1/encoder/motion_search_facade.h"
             "${AOM_ROOT}/av1/encoder/mv_prec.c"
@@ -230,6 +233,8 @@ list(APPEND AOM_AV1_ENCODER_SOURCES
             "${AOM_ROOT}/av1/encoder/superres_scale.h"
             "${AOM_ROOT}/av1/encoder/svc_layercontext.c"
             "${AOM_ROOT}/av1/encoder/svc_layercontext.h"
+            "${AOM_ROOT}/av1/encoder/task_pool.c"
+            "${AOM_ROOT}/av1/encoder/task_pool.h"
             "${AOM_ROOT}/av1/encoder/temporal_filter.c"
             "${AOM_ROOT}/av1/encoder/temporal_filter.h"
             "${AOM_ROOT}/av1/encoder/thirdpass.c"
@@ -255,8 +260,6 @@ list(APPEND AOM_AV1_ENCODER_SOURCES
             "${AOM_ROOT}/third_party/fastfeat/fast.h"
             "${AOM_ROOT}/third_party/fastfeat/fast_9.c"
             "${AOM_ROOT}/third_party/fastfeat/nonmax.c"
-            "${AOM_ROOT}/third_party/vector/vector.c"
-            "${AOM_ROOT}/third_party/vector/vector.h"
             "${AOM_ROOT}/av1/encoder/dwt.c"
             "${AOM_ROOT}/av1/encoder/dwt.h")
 
@@ -308,6 +311,18 @@ list(APPEND AOM_AV1_COMMON_INTRIN_AVX2
             "${AOM_ROOT}/av1/common/x86/warp_plane_avx2.c"
             "${AOM_ROOT}/av1/common/x86/wiener_convolve_avx2.c")
 
+list(APPEND AOM_AV1_COMMON_INTRIN_AVX512
+            "${AOM_ROOT}/av1/common/x86/convolve_2d_avx512.c")
+
+list(APPEND AOM_AV1_DECODER_INTRIN_SSE4_1
+            "${AOM_ROOT}/av1/decoder/x86/grain_synthesis_sse4.c")
+
+list(APPEND AOM_AV1_DECODER_INTRIN_AVX2
+            "${AOM_ROOT}/av1/decoder/x86/grain_synthesis_avx2.c")
+
+list(APPEND AOM_AV1_DECODER_INTRIN_NEON
+            "${AOM_ROOT}/av1/decoder/arm/grain_synthesis_neon.c")
+
 list(APPEND AOM_AV1_ENCODER_ASM_SSE2 "${AOM_ROOT}/av1/encoder/x86/dct_sse2.asm"
             "${AOM_ROOT}/av1/encoder/x86/error_sse2.asm")
 
@@ -351,6 +366,7 @@ list(APPEND AOM_AV1_ENCODER_INTRIN_AVX2
             "${AOM_ROOT}/av1/encoder/x86/encodetxb_avx2.c"
             "${AOM_ROOT}/av1/encoder/x86/rdopt_avx2.c"
             "${AOM_ROOT}/av1/encoder/x86/av1_k_means_avx2.c"
+            "${AOM_ROOT}/av1/encoder/x86/pickcdef_avx2.c"
             "${AOM_ROOT}/av1/encoder/x86/temporal_filter_avx2.c"
             "${AOM_ROOT}/av1/encoder/x86/pickrst_avx2.c")
 
@@ -370,6 +386,7 @@ list(APPEND AOM_AV1_ENCODER_INTRIN_NEON
             "${AOM_ROOT}/av1/encoder/arm/encodetxb_neon.c"
             "${AOM_ROOT}/av1/encoder/arm/highbd_fwd_txfm_neon.c"
             "${AOM_ROOT}/av1/encoder/arm/hybrid_fwd_txfm_neon.c"
+            "${AOM_ROOT}/av1/encoder/arm/pickcdef_neon.c"
             "${AOM_ROOT}/av1/encoder/arm/pickrst_neon.c"
             "${AOM_ROOT}/av1/encoder/arm/pickrst_neon.h"
             "${AOM_ROOT}/av1/encoder/arm/quantize_neon.c"
@@ -671,6 +688,11 @@ function(setup_av1_targets)
     add_intrinsics_object_library("-msse4.1" "sse4" "aom_av1_common"
                                   "AOM_AV1_COMMON_INTRIN_SSE4_1")
 
+    if(CONFIG_AV1_DECODER)
+      add_intrinsics_object_library("-msse4.1" "sse4" "aom_av1_decoder"
+                                    "AOM_AV1_DECODER_INTRIN_SSE4_1")
+    endif()
+
     if(CONFIG_AV1_ENCODER)
       if("${AOM_TARGET_CPU}" STREQUAL "x86_64")
         add_asm_library("aom_av1_encoder_ssse3"
@@ -699,15 +721,31 @@ function(setup_av1_targets)
     add_intrinsics_object_library("-mavx2" "avx2" "aom_av1_common"
                                   "AOM_AV1_COMMON_INTRIN_AVX2")
 
+    if(CONFIG_AV1_DECODER)
+      add_intrinsics_object_library("-mavx2" "avx2" "aom_av1_decoder"
+                                    "AOM_AV1_DECODER_INTRIN_AVX2")
+    endif()
+
     if(CONFIG_AV1_ENCODER)
       add_intrinsics_object_library("-mavx2" "avx2" "aom_av1_encoder"
                                     "AOM_AV1_ENCODER_INTRIN_AVX2")
     endif()
   endif()
 
+  if(HAVE_AVX512)
+    add_intrinsics_object_library("${AOM_AVX512_INTRIN_FLAG}" "avx512"
+                                  "aom_av1_common"
+                                  "AOM_AV1_COMMON_INTRIN_AVX512")
+  endif()
+
   if(HAVE_NEON)
     add_intrinsics_object_library("${AOM_NEON_INTRIN_FLAG}" "neon"
                                   "aom_av1_common" "AOM_AV1_COMMON_INTRIN_NEON")
+    if(CONFIG_AV1_DECODER)
+      add_intrinsics_object_library("${AOM_NEON_INTRIN_FLAG}" "neon"
+                                    "aom_av1_decoder"
+                                    "AOM_AV1_DECODER_INTRIN_NEON")
+    endif()
     if(CONFIG_AV1_ENCODER)
       add_intrinsics_object_library("${AOM_NEON_INTRIN_FLAG}" "neon"
                                     "aom_av1_encoder"
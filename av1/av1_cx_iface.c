@@ -549,6 +549,11 @@ struct aom_codec_alg_priv {
   int num_lap_buffers;
   STATS_BUFFER_CTX stats_buf_context;
   bool monochrome_on_init;
+  // Set by AV1E_SET_INPUT_BUFFER_CB.
+  aom_input_buffer_cb_t input_buffer_cb;
+  // Input image of the aom_codec_encode() call in progress, while it is not
+  // referenced by the lookahead.
+  struct lookahead_input_buffer pending_input;
 };
 
 static inline int gcd(int64_t a, int b) {
@@ -3028,11 +3033,11 @@ static inline int get_src_border_in_pixels(AV1_COMP *cpi, BLOCK_SIZE sb_size) {
 
 // TODO(Mufaddal): Check feasibility of abstracting functions related to LAP
 // into a separate function.
-static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
-                                      const aom_image_t *img,
-                                      aom_codec_pts_t pts,
-                                      unsigned long duration,
-                                      aom_enc_frame_flags_t enc_flags) {
+static aom_codec_err_t encode_frames(aom_codec_alg_priv_t *ctx,
+                                     const aom_image_t *img,
+                                     aom_codec_pts_t pts,
+                                     unsigned long duration,
+                                     aom_enc_frame_flags_t enc_flags) {
   const size_t kMinCompressedSize = 8192;
   volatile aom_codec_err_t res = AOM_CODEC_OK;
   AV1_PRIMARY *const ppi = ctx->ppi;
@@ -3249,8 +3254,11 @@ static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
 
       // Store the original flags in to the frame buffer. Will extract the
       // key frame flag when we actually encode this frame.
-      if (av1_receive_raw_frame(cpi, flags | ctx->next_frame_flags, &sd,
-                                src_time_stamp, src_end_time_stamp)) {
+      if (av1_receive_raw_frame(
+              cpi, flags | ctx->next_frame_flags, &sd, src_time_stamp,
+              src_end_time_stamp,
+              ctx->pending_input.release_cb != NULL ? &ctx->pending_input
+                                                    : NULL)) {
         res = update_error_state(ctx, cpi->common.error);
       }
       ctx->next_frame_flags = 0;
@@ -3533,6 +3541,31 @@ static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
   return res;
 }
 
+static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
+                                      const aom_image_t *img,
+                                      aom_codec_pts_t pts,
+                                      unsigned long duration,
+                                      aom_enc_frame_flags_t enc_flags) {
+  struct lookahead_input_buffer *const input = &ctx->pending_input;
+  input->release_cb = NULL;
+  if (img != NULL && ctx->input_buffer_cb.release_cb != NULL) {
+    input->release_cb = ctx->input_buffer_cb.release_cb;
+    input->cb_priv = ctx->input_buffer_cb.cb_priv;
+    input->user_priv = img->user_priv;
+    // aom_img_alloc_with_border() limits the border to 65536.
+    input->border = (int)AOMMIN(ctx->input_buffer_cb.border, 65536);
+  }
+  const aom_codec_err_t res =
+      encode_frames(ctx, img, pts, duration, enc_flags);
+  // The lookahead clears the callback of the images it references. The
+  // others were copied, or not queued at all.
+  if (input->release_cb != NULL) {
+    input->release_cb(input->cb_priv, input->user_priv);
+    input->release_cb = NULL;
+  }
+  return res;
+}
+
 static const aom_codec_cx_pkt_t *encoder_get_cxdata(aom_codec_alg_priv_t *ctx,
                                                     aom_codec_iter_t *iter) {
   return aom_codec_pkt_list_get(&ctx->pkt_list.head, iter);
@@ -4467,6 +4500,45 @@ static aom_codec_err_t ctrl_get_high_motion_content_screen_rtc(
   return AOM_CODEC_OK;
 }
 
+static void accumulate_scratch_mem_stats(const AV1_COMP *cpi,
+                                         aom_scratch_mem_stats_t *stats) {
+  AVxArenaStats arena_stats;
+  aom_arena_get_stats(&cpi->frame_arena, &arena_stats);
+  stats->frame_peak += arena_stats.peak_used;
+  stats->frame_reserved += arena_stats.reserved;
+  stats->num_system_allocs += arena_stats.num_system_allocs;
+  aom_arena_get_stats(&cpi->gop_arena, &arena_stats);
+  stats->gop_peak += arena_stats.peak_used;
+  stats->gop_reserved += arena_stats.reserved;
+  stats->num_system_allocs += arena_stats.num_system_allocs;
+}
+
+static aom_codec_err_t ctrl_set_input_buffer_cb(aom_codec_alg_priv_t *ctx,
+                                                va_list args) {
+  const aom_input_buffer_cb_t *const arg =
+      va_arg(args, const aom_input_buffer_cb_t *);
+  if (arg == NULL) {
+    memset(&ctx->input_buffer_cb, 0, sizeof(ctx->input_buffer_cb));
+  } else {
+    ctx->input_buffer_cb = *arg;
+  }
+  return AOM_CODEC_OK;
+}
+
+static aom_codec_err_t ctrl_get_scratch_mem_stats(aom_codec_alg_priv_t *ctx,
+                                                  va_list args) {
+  aom_scratch_mem_stats_t *const arg = va_arg(args, aom_scratch_mem_stats_t *);
+  if (arg == NULL) return AOM_CODEC_INVALID_PARAM;
+  memset(arg, 0, sizeof(*arg));
+  for (int i = 0; i < ctx->ppi->num_fp_contexts; i++) {
+    accumulate_scratch_mem_stats(ctx->ppi->parallel_cpi[i], arg);
+  }
+  if (ctx->ppi->cpi_lap != NULL) {
+    accumulate_scratch_mem_stats(ctx->ppi->cpi_lap, arg);
+  }
+  return AOM_CODEC_OK;
+}
+
 static aom_codec_ctrl_fn_map_t encoder_ctrl_maps[] = {
   { AV1_COPY_REFERENCE, ctrl_copy_reference },
   { AOME_USE_REFERENCE, ctrl_use_reference },
@@ -4635,6 +4707,8 @@ static aom_codec_ctrl_fn_map_t encoder_ctrl_maps[] = {
   { AV1E_GET_LUMA_CDEF_STRENGTH, ctrl_get_luma_cdef_strength },
   { AV1E_GET_HIGH_MOTION_CONTENT_SCREEN_RTC,
     ctrl_get_high_motion_content_screen_rtc },
+  { AV1E_GET_SCRATCH_MEM_STATS, ctrl_get_scratch_mem_stats },
+  { AV1E_SET_INPUT_BUFFER_CB, ctrl_set_input_buffer_cb },
 
   CTRL_MAP_END,
 };
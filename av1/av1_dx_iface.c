@@ -9,6 +9,7 @@
  * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
  */
 
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -41,6 +42,13 @@
 
 #include "av1/av1_iface_common.h"
 
+#define MAX_FRAME_PARALLEL 8
+// Frame buffers needed for each temporal unit in flight in frame parallel
+// mode: the references held by its frame worker, the frame being decoded and
+// the frames waiting to be output.
+#define FRAME_PARALLEL_EXTRA_BUFFERS \
+  (REF_FRAMES + 1 + MAX_NUM_SPATIAL_LAYERS)
+
 struct aom_codec_alg_priv {
   aom_codec_priv_t base;
   aom_codec_dec_cfg_t cfg;
@@ -62,8 +70,21 @@ struct aom_codec_alg_priv {
   unsigned int is_annexb;
   int operating_point;
   int output_all_layers;
+  unsigned int frame_parallel;
 
+  // The frame worker whose frames are being output.
   AVxWorker *frame_worker;
+  AVxWorker *frame_workers;
+  int num_frame_workers;
+
+  // Frame parallel decoding. The temporal units are submitted to the frame
+  // workers in round robin order, and output in the same order.
+  AV1FrameSync frame_sync;
+  unsigned int num_temporal_units;
+  int next_submit_worker_id;
+  int next_output_worker_id;
+  int num_pending_frame_workers;
+  int output_worker_selected;
 
   aom_image_t image_with_grain;
   aom_codec_frame_buffer_t grain_image_frame_buffers[MAX_NUM_SPATIAL_LAYERS];
@@ -117,9 +138,9 @@ static aom_codec_err_t decoder_init(aom_codec_ctx_t *ctx) {
   return AOM_CODEC_OK;
 }
 
-static aom_codec_err_t decoder_destroy(aom_codec_alg_priv_t *ctx) {
-  if (ctx->frame_worker != NULL) {
-    AVxWorker *const worker = ctx->frame_worker;
+static void free_frame_workers(aom_codec_alg_priv_t *ctx) {
+  for (int i = 0; i < ctx->num_frame_workers; ++i) {
+    AVxWorker *const worker = &ctx->frame_workers[i];
     aom_get_worker_interface()->end(worker);
     FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
     if (frame_worker_data != NULL && frame_worker_data->pbi != NULL) {
@@ -132,10 +153,21 @@ static aom_codec_err_t decoder_destroy(aom_codec_alg_priv_t *ctx) {
       av1_free_restoration_buffers(&pbi->common);
       av1_decoder_remove(pbi);
     }
+    if (frame_worker_data != NULL) aom_free(frame_worker_data->scratch_buffer);
     aom_free(frame_worker_data);
   }
+  aom_free(ctx->frame_workers);
+  ctx->frame_workers = NULL;
+  ctx->num_frame_workers = 0;
+  ctx->frame_worker = NULL;
+}
+
+static aom_codec_err_t decoder_destroy(aom_codec_alg_priv_t *ctx) {
+  free_frame_workers(ctx);
 
   if (ctx->buffer_pool) {
+    // Releases the references held by the frame parallel decoder state.
+    av1_frame_sync_dealloc(&ctx->frame_sync);
     for (size_t i = 0; i < ctx->num_grain_image_frame_buffers; i++) {
       ctx->buffer_pool->release_fb_cb(ctx->buffer_pool->cb_priv,
                                       &ctx->grain_image_frame_buffers[i]);
@@ -147,7 +179,6 @@ static aom_codec_err_t decoder_destroy(aom_codec_alg_priv_t *ctx) {
 #endif
   }
 
-  aom_free(ctx->frame_worker);
   aom_free(ctx->buffer_pool);
   assert(!ctx->img.self_allocd);
   aom_img_free(&ctx->img);
@@ -379,17 +410,19 @@ static aom_codec_err_t update_error_state(
   return error->error_code;
 }
 
-static void init_buffer_callbacks(aom_codec_alg_priv_t *ctx) {
-  AVxWorker *const worker = ctx->frame_worker;
-  FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
-  AV1Decoder *const pbi = frame_worker_data->pbi;
-  AV1_COMMON *const cm = &pbi->common;
-  BufferPool *const pool = cm->buffer_pool;
-
-  cm->cur_frame = NULL;
-  cm->features.byte_alignment = ctx->byte_alignment;
-  pbi->skip_loop_filter = ctx->skip_loop_filter;
-  pbi->skip_film_grain = ctx->skip_film_grain;
+static void init_buffer_callbacks(aom_codec_alg_priv_t *ctx,
+                                  int num_extra_bufs) {
+  AV1Decoder *pbi = NULL;
+  for (int i = 0; i < ctx->num_frame_workers; ++i) {
+    AVxWorker *const worker = &ctx->frame_workers[i];
+    FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
+    pbi = frame_worker_data->pbi;
+    pbi->common.cur_frame = NULL;
+    pbi->common.features.byte_alignment = ctx->byte_alignment;
+    pbi->skip_loop_filter = ctx->skip_loop_filter;
+    pbi->skip_film_grain = ctx->skip_film_grain;
+  }
+  BufferPool *const pool = ctx->buffer_pool;
 
   if (ctx->get_ext_fb_cb != NULL && ctx->release_ext_fb_cb != NULL) {
     pool->get_fb_cb = ctx->get_ext_fb_cb;
@@ -399,7 +432,10 @@ static void init_buffer_callbacks(aom_codec_alg_priv_t *ctx) {
     pool->get_fb_cb = av1_get_frame_buffer;
     pool->release_fb_cb = av1_release_frame_buffer;
 
-    if (av1_alloc_internal_frame_buffers(&pool->int_frame_buffers))
+    if (av1_alloc_internal_frame_buffers(
+            &pool->int_frame_buffers,
+            AOM_MAXIMUM_REF_BUFFERS + AOM_MAXIMUM_WORK_BUFFERS +
+                num_extra_bufs))
       aom_internal_error(&pbi->error, AOM_CODEC_MEM_ERROR,
                          "Failed to initialize internal frame buffers");
 
@@ -423,8 +459,65 @@ static int frame_worker_hook(void *arg1, void *arg2) {
   return !result;
 }
 
+// Decodes a whole temporal unit in frame parallel mode.
+static int frame_parallel_worker_hook(void *arg1, void *arg2) {
+  FrameWorkerData *const frame_worker_data = (FrameWorkerData *)arg1;
+  AV1Decoder *const pbi = frame_worker_data->pbi;
+  const uint8_t *data = frame_worker_data->data;
+  const uint8_t *const data_end = data + frame_worker_data->data_size;
+  int result = 0;
+  (void)arg2;
+
+  av1_frame_sync_inherit_state(pbi);
+
+  // Any temporal unit size was stripped by decode_frame_parallel().
+  while (data < data_end) {
+    size_t frame_size = (size_t)(data_end - data);
+    if (pbi->is_annexb) {
+      // read the size of this frame unit
+      uint64_t frame_unit_size;
+      size_t length_of_size;
+      if (aom_uleb_decode(data, frame_size, &frame_unit_size,
+                          &length_of_size) != 0 ||
+          frame_unit_size > frame_size - length_of_size) {
+        pbi->error.error_code = AOM_CODEC_CORRUPT_FRAME;
+        result = 1;
+        break;
+      }
+      data += length_of_size;
+      frame_size = (size_t)frame_unit_size;
+    }
+
+    result = av1_receive_compressed_data(pbi, frame_size, &data);
+    if (result != 0) break;
+
+    // Allow extra zero bytes after the frame end
+    while (data < data_end) {
+      const uint8_t marker = data[0];
+      if (marker) break;
+      ++data;
+    }
+  }
+
+  if (result != 0) pbi->need_resync = 1;
+  // Hands the decoder state over to the next temporal unit, unless this was
+  // already done once the last frame header was read.
+  av1_frame_sync_publish_state(pbi, /*frame_in_progress=*/0);
+  frame_worker_data->data_end = data;
+  return !result;
+}
+
 static aom_codec_err_t init_decoder(aom_codec_alg_priv_t *ctx) {
   const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  // In frame parallel mode, one frame worker more than the number of temporal
+  // units in flight is created, so that the worker whose frames are being
+  // output is never handed a new temporal unit.
+  const int frame_parallel = ctx->frame_parallel > 1;
+  const int num_frame_workers =
+      frame_parallel ? (int)ctx->frame_parallel + 1 : 1;
+  const int num_extra_bufs =
+      frame_parallel ? (int)ctx->frame_parallel * FRAME_PARALLEL_EXTRA_BUFFERS
+                     : 0;
 
   ctx->last_show_frame = NULL;
   ctx->need_resync = 1;
@@ -432,7 +525,7 @@ static aom_codec_err_t init_decoder(aom_codec_alg_priv_t *ctx) {
 
   ctx->buffer_pool = (BufferPool *)aom_calloc(1, sizeof(BufferPool));
   if (ctx->buffer_pool == NULL) return AOM_CODEC_MEM_ERROR;
-  ctx->buffer_pool->num_frame_bufs = FRAME_BUFFERS;
+  ctx->buffer_pool->num_frame_bufs = FRAME_BUFFERS + num_extra_bufs;
   ctx->buffer_pool->frame_bufs = (RefCntBuffer *)aom_calloc(
       ctx->buffer_pool->num_frame_bufs, sizeof(*ctx->buffer_pool->frame_bufs));
   if (ctx->buffer_pool->frame_bufs == NULL) {
@@ -454,54 +547,91 @@ static aom_codec_err_t init_decoder(aom_codec_alg_priv_t *ctx) {
   }
 #endif
 
-  ctx->frame_worker = (AVxWorker *)aom_malloc(sizeof(*ctx->frame_worker));
-  if (ctx->frame_worker == NULL) {
-    set_error_detail(ctx, "Failed to allocate frame_worker");
-    return AOM_CODEC_MEM_ERROR;
-  }
-
-  AVxWorker *const worker = ctx->frame_worker;
-  winterface->init(worker);
-  worker->thread_name = "aom frameworker";
-  worker->data1 = aom_memalign(32, sizeof(FrameWorkerData));
-  if (worker->data1 == NULL) {
-    winterface->end(worker);
-    aom_free(worker);
-    ctx->frame_worker = NULL;
-    set_error_detail(ctx, "Failed to allocate frame_worker_data");
+  ctx->frame_workers = (AVxWorker *)aom_calloc(num_frame_workers,
+                                               sizeof(*ctx->frame_workers));
+  if (ctx->frame_workers == NULL) {
+    set_error_detail(ctx, "Failed to allocate frame_workers");
     return AOM_CODEC_MEM_ERROR;
   }
-  FrameWorkerData *frame_worker_data = (FrameWorkerData *)worker->data1;
-  frame_worker_data->pbi = av1_decoder_create(ctx->buffer_pool);
-  if (frame_worker_data->pbi == NULL) {
-    winterface->end(worker);
-    aom_free(frame_worker_data);
-    aom_free(worker);
-    ctx->frame_worker = NULL;
-    set_error_detail(ctx, "Failed to allocate frame_worker_data->pbi");
-    return AOM_CODEC_MEM_ERROR;
+  ctx->num_frame_workers = num_frame_workers;
+
+  for (int i = 0; i < num_frame_workers; ++i) {
+    AVxWorker *const worker = &ctx->frame_workers[i];
+    winterface->init(worker);
+    worker->thread_name = "aom frameworker";
+    worker->data1 = aom_memalign(32, sizeof(FrameWorkerData));
+    if (worker->data1 == NULL) {
+      free_frame_workers(ctx);
+      set_error_detail(ctx, "Failed to allocate frame_worker_data");
+      return AOM_CODEC_MEM_ERROR;
+    }
+    FrameWorkerData *frame_worker_data = (FrameWorkerData *)worker->data1;
+    frame_worker_data->scratch_buffer = NULL;
+    frame_worker_data->scratch_buffer_size = 0;
+    frame_worker_data->pbi = av1_decoder_create(ctx->buffer_pool);
+    if (frame_worker_data->pbi == NULL) {
+      free_frame_workers(ctx);
+      set_error_detail(ctx, "Failed to allocate frame_worker_data->pbi");
+      return AOM_CODEC_MEM_ERROR;
+    }
+    frame_worker_data->frame_context_ready = 0;
+    frame_worker_data->received_frame = 0;
+    frame_worker_data->pbi->allow_lowbitdepth = ctx->cfg.allow_lowbitdepth;
+
+    // If decoding in serial mode, FrameWorker thread could create tile worker
+    // thread or loopfilter thread. In frame parallel mode, the threads are
+    // split between the temporal units in flight.
+    frame_worker_data->pbi->max_threads =
+        frame_parallel ? AOMMAX(1, (int)ctx->cfg.threads /
+                                       (int)ctx->frame_parallel)
+                       : ctx->cfg.threads;
+    frame_worker_data->pbi->inv_tile_order = ctx->invert_tile_order;
+    frame_worker_data->pbi->common.tiles.large_scale = ctx->tile_mode;
+    frame_worker_data->pbi->is_annexb = ctx->is_annexb;
+    frame_worker_data->pbi->dec_tile_row = ctx->decode_tile_row;
+    frame_worker_data->pbi->dec_tile_col = ctx->decode_tile_col;
+    frame_worker_data->pbi->operating_point = ctx->operating_point;
+    frame_worker_data->pbi->output_all_layers = ctx->output_all_layers;
+    frame_worker_data->pbi->ext_tile_debug = ctx->ext_tile_debug;
+    frame_worker_data->pbi->row_mt = ctx->row_mt;
+    frame_worker_data->pbi->is_fwd_kf_present = 0;
+    frame_worker_data->pbi->is_arf_frame_present = 0;
+    if (frame_parallel) {
+      frame_worker_data->pbi->frame_sync = &ctx->frame_sync;
+      worker->hook = frame_parallel_worker_hook;
+      // Unlike the serial frame worker, which runs in the calling thread,
+      // frame parallel workers decode in their own thread.
+      if (!winterface->reset(worker)) {
+        free_frame_workers(ctx);
+        set_error_detail(ctx, "Frame worker thread creation failed");
+        return AOM_CODEC_MEM_ERROR;
+      }
+    } else {
+      worker->hook = frame_worker_hook;
+    }
   }
-  frame_worker_data->frame_context_ready = 0;
-  frame_worker_data->received_frame = 0;
-  frame_worker_data->pbi->allow_lowbitdepth = ctx->cfg.allow_lowbitdepth;
+  ctx->frame_worker = &ctx->frame_workers[num_frame_workers - 1];
 
-  // If decoding in serial mode, FrameWorker thread could create tile worker
-  // thread or loopfilter thread.
-  frame_worker_data->pbi->max_threads = ctx->cfg.threads;
-  frame_worker_data->pbi->inv_tile_order = ctx->invert_tile_order;
-  frame_worker_data->pbi->common.tiles.large_scale = ctx->tile_mode;
-  frame_worker_data->pbi->is_annexb = ctx->is_annexb;
-  frame_worker_data->pbi->dec_tile_row = ctx->decode_tile_row;
-  frame_worker_data->pbi->dec_tile_col = ctx->decode_tile_col;
-  frame_worker_data->pbi->operating_point = ctx->operating_point;
-  frame_worker_data->pbi->output_all_layers = ctx->output_all_layers;
-  frame_worker_data->pbi->ext_tile_debug = ctx->ext_tile_debug;
-  frame_worker_data->pbi->row_mt = ctx->row_mt;
-  frame_worker_data->pbi->is_fwd_kf_present = 0;
-  frame_worker_data->pbi->is_arf_frame_present = 0;
-  worker->hook = frame_worker_hook;
+  init_buffer_callbacks(ctx, num_extra_bufs);
 
-  init_buffer_callbacks(ctx);
+  if (frame_parallel) {
+    if (av1_frame_sync_alloc(&ctx->frame_sync, ctx->buffer_pool)) {
+      av1_frame_sync_dealloc(&ctx->frame_sync);
+      free_frame_workers(ctx);
+      set_error_detail(ctx, "Failed to allocate frame_sync");
+      return AOM_CODEC_MEM_ERROR;
+    }
+    // The state of a newly created decoder is what the first temporal unit
+    // starts from.
+    AV1Decoder *const pbi = ((FrameWorkerData *)ctx->frame_workers[0].data1)->pbi;
+    pbi->frame_sync_tu = UINT_MAX;
+    av1_frame_sync_publish_state(pbi, /*frame_in_progress=*/0);
+    ctx->num_temporal_units = 0;
+    ctx->next_submit_worker_id = 0;
+    ctx->next_output_worker_id = 0;
+    ctx->num_pending_frame_workers = 0;
+    ctx->output_worker_selected = 0;
+  }
 
   return AOM_CODEC_OK;
 }
@@ -566,6 +696,12 @@ static void release_pending_output_frames(aom_codec_alg_priv_t *ctx) {
   // Release any pending output frames from the previous decoder_decode or
   // decoder_inspect call. We need to do this even if the decoder is being
   // flushed or the input arguments are invalid.
+  // In frame parallel mode, only the frames of the temporal unit selected for
+  // output are released.
+  if (ctx->num_frame_workers > 1) {
+    if (!ctx->output_worker_selected) return;
+    ctx->output_worker_selected = 0;
+  }
   if (ctx->frame_worker) {
     BufferPool *const pool = ctx->buffer_pool;
     lock_buffer_pool(pool);
@@ -576,7 +712,6 @@ static void release_pending_output_frames(aom_codec_alg_priv_t *ctx) {
       decrease_ref_count(pbi->output_frames[j], pool);
     }
     pbi->num_output_frames = 0;
-    unlock_buffer_pool(pool);
     for (size_t j = 0; j < ctx->num_grain_image_frame_buffers; j++) {
       pool->release_fb_cb(pool->cb_priv, &ctx->grain_image_frame_buffers[j]);
       ctx->grain_image_frame_buffers[j].data = NULL;
@@ -584,7 +719,156 @@ static void release_pending_output_frames(aom_codec_alg_priv_t *ctx) {
       ctx->grain_image_frame_buffers[j].priv = NULL;
     }
     ctx->num_grain_image_frame_buffers = 0;
+    unlock_buffer_pool(pool);
+  }
+}
+
+// Returns the number of frame headers in the temporal unit, or 0 if the
+// decoder state can only be handed over to the next temporal unit once this
+// one is fully decoded.
+static int count_frame_headers(const uint8_t *data, size_t data_sz,
+                               int is_annexb) {
+  const uint8_t *const data_end = data + data_sz;
+  int num_frame_headers = 0;
+  while (data < data_end) {
+    const uint8_t *unit_end = data_end;
+    if (is_annexb) {
+      // read the size of this frame unit
+      uint64_t frame_size;
+      size_t length_of_size;
+      if (aom_uleb_decode(data, (size_t)(data_end - data), &frame_size,
+                          &length_of_size) != 0) {
+        return 0;
+      }
+      data += length_of_size;
+      if (frame_size > (size_t)(data_end - data)) return 0;
+      unit_end = data + frame_size;
+    }
+    while (data < unit_end) {
+      ObuHeader obu_header;
+      size_t payload_size, bytes_read;
+      if (aom_read_obu_header_and_size(data, (size_t)(unit_end - data),
+                                       is_annexb, &obu_header, &payload_size,
+                                       &bytes_read) != AOM_CODEC_OK) {
+        return 0;
+      }
+      data += bytes_read;
+      if (payload_size > (size_t)(unit_end - data)) return 0;
+      data += payload_size;
+      switch (obu_header.type) {
+        case OBU_FRAME_HEADER:
+        case OBU_FRAME: ++num_frame_headers; break;
+        case OBU_SEQUENCE_HEADER:
+        case OBU_TILE_LIST:
+          // These change the decoder state after a frame header.
+          if (num_frame_headers > 0) return 0;
+          break;
+        default: break;
+      }
+      // Allow extra zero bytes after the frame end
+      while (data < unit_end && !data[0]) ++data;
+    }
+  }
+  return num_frame_headers;
+}
+
+// Selects the oldest temporal unit in flight for output. Returns 0 if there is
+// none.
+static int select_output_worker(aom_codec_alg_priv_t *ctx) {
+  if (ctx->num_pending_frame_workers == 0) return 0;
+  release_pending_output_frames(ctx);
+  ctx->frame_worker = &ctx->frame_workers[ctx->next_output_worker_id];
+  ctx->next_output_worker_id =
+      (ctx->next_output_worker_id + 1) % ctx->num_frame_workers;
+  --ctx->num_pending_frame_workers;
+  ctx->output_worker_selected = 1;
+  return 1;
+}
+
+static aom_codec_err_t decode_frame_parallel(aom_codec_alg_priv_t *ctx,
+                                             const uint8_t *data,
+                                             size_t data_sz,
+                                             void *user_priv) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+
+  if (ctx->tile_mode || ctx->ext_refs.num > 0) return AOM_CODEC_INCAPABLE;
+
+  // Determine the stream parameters from the first frame unit.
+  if (!ctx->si.h) {
+    const uint8_t *frame_data = data;
+    size_t frame_size = data_sz;
+    if (ctx->is_annexb) {
+      uint64_t frame_unit_size;
+      size_t length_of_size;
+      if (aom_uleb_decode(data, data_sz, &frame_unit_size, &length_of_size) !=
+              0 ||
+          frame_unit_size > data_sz - length_of_size) {
+        return AOM_CODEC_CORRUPT_FRAME;
+      }
+      frame_data += length_of_size;
+      frame_size = (size_t)frame_unit_size;
+    }
+    int is_intra_only = 0;
+    ctx->si.is_annexb = ctx->is_annexb;
+    const aom_codec_err_t res = decoder_peek_si_internal(
+        frame_data, frame_size, &ctx->si, &is_intra_only);
+    if (res != AOM_CODEC_OK) return res;
+
+    if (!ctx->si.is_kf && !is_intra_only) return AOM_CODEC_ERROR;
+  }
+
+  // All the temporal units in flight wait for output. Drop the oldest one.
+  if (ctx->num_pending_frame_workers == ctx->num_frame_workers - 1) {
+    select_output_worker(ctx);
+    FrameWorkerData *const output_worker_data =
+        (FrameWorkerData *)ctx->frame_worker->data1;
+    if (!winterface->sync(ctx->frame_worker)) {
+      ctx->need_resync = 1;
+    } else {
+      check_resync(ctx, output_worker_data->pbi);
+    }
+    output_worker_data->received_frame = 0;
+    release_pending_output_frames(ctx);
+  }
+
+  AVxWorker *const worker = &ctx->frame_workers[ctx->next_submit_worker_id];
+  assert(worker != ctx->frame_worker);
+  FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
+  AV1Decoder *const pbi = frame_worker_data->pbi;
+  // Wait for the previous temporal unit of this worker to be fully released.
+  winterface->sync(worker);
+
+  if (frame_worker_data->scratch_buffer_size < data_sz) {
+    aom_free(frame_worker_data->scratch_buffer);
+    frame_worker_data->scratch_buffer = (uint8_t *)aom_malloc(data_sz);
+    if (frame_worker_data->scratch_buffer == NULL) {
+      frame_worker_data->scratch_buffer_size = 0;
+      set_error_detail(ctx, "Failed to allocate frame worker scratch buffer");
+      return AOM_CODEC_MEM_ERROR;
+    }
+    frame_worker_data->scratch_buffer_size = data_sz;
   }
+  memcpy(frame_worker_data->scratch_buffer, data, data_sz);
+  frame_worker_data->data = frame_worker_data->scratch_buffer;
+  frame_worker_data->data_size = data_sz;
+  frame_worker_data->user_priv = user_priv;
+  frame_worker_data->received_frame = 1;
+
+  pbi->common.tiles.large_scale = ctx->tile_mode;
+  pbi->dec_tile_row = ctx->decode_tile_row;
+  pbi->dec_tile_col = ctx->decode_tile_col;
+  pbi->ext_tile_debug = ctx->ext_tile_debug;
+  pbi->row_mt = ctx->row_mt;
+  pbi->is_annexb = ctx->is_annexb;
+  pbi->frame_sync_tu = ctx->num_temporal_units++;
+  pbi->frame_headers_left = count_frame_headers(data, data_sz, ctx->is_annexb);
+
+  worker->had_error = 0;
+  winterface->launch(worker);
+  ctx->next_submit_worker_id =
+      (ctx->next_submit_worker_id + 1) % ctx->num_frame_workers;
+  ++ctx->num_pending_frame_workers;
+  return AOM_CODEC_OK;
 }
 
 // This function enables the inspector to inspect non visible frames.
@@ -593,6 +877,8 @@ static aom_codec_err_t decoder_inspect(aom_codec_alg_priv_t *ctx,
                                        void *user_priv) {
   aom_codec_err_t res = AOM_CODEC_OK;
 
+  if (ctx->frame_parallel > 1) return AOM_CODEC_INCAPABLE;
+
   release_pending_output_frames(ctx);
 
   /* Sanity checks */
@@ -719,6 +1005,12 @@ static aom_codec_err_t decoder_decode(aom_codec_alg_priv_t *ctx,
     data_end = data_start + temporal_unit_size;
   }
 
+  if (ctx->num_frame_workers > 1) {
+    if (data_start == data_end) return AOM_CODEC_OK;
+    return decode_frame_parallel(ctx, data_start,
+                                 (size_t)(data_end - data_start), user_priv);
+  }
+
   // Decode in serial mode.
   while (data_start < data_end) {
     uint64_t frame_size;
@@ -757,8 +1049,13 @@ typedef struct {
 
 static void *AllocWithGetFrameBufferCb(void *priv, size_t size) {
   AllocCbParam *param = (AllocCbParam *)priv;
-  if (param->pool->get_fb_cb(param->pool->cb_priv, size, param->fb) < 0)
-    return NULL;
+  // The frame workers may allocate frame buffers concurrently in frame
+  // parallel mode.
+  lock_buffer_pool(param->pool);
+  const int ret =
+      param->pool->get_fb_cb(param->pool->cb_priv, size, param->fb);
+  unlock_buffer_pool(param->pool);
+  if (ret < 0) return NULL;
   if (param->fb->data == NULL || param->fb->size < size) return NULL;
   return param->fb->data;
 }
@@ -766,7 +1063,7 @@ static void *AllocWithGetFrameBufferCb(void *priv, size_t size) {
 // If grain_params->apply_grain is false, returns img. Otherwise, adds film
 // grain to img, saves the result in grain_img, and returns grain_img.
 static aom_image_t *add_grain_if_needed(aom_codec_alg_priv_t *ctx,
-                                        aom_image_t *img,
+                                        AV1Decoder *pbi, aom_image_t *img,
                                         aom_image_t *grain_img,
                                         aom_film_grain_t *grain_params) {
   if (!grain_params->apply_grain) return img;
@@ -787,8 +1084,12 @@ static aom_image_t *add_grain_if_needed(aom_codec_alg_priv_t *ctx,
 
   grain_img->user_priv = img->user_priv;
   grain_img->fb_priv = fb->priv;
-  if (av1_add_film_grain(grain_params, img, grain_img)) {
+  // The tile workers are idle once the frame has been decoded.
+  if (av1_add_film_grain_mt(grain_params, img, grain_img, pbi->tile_workers,
+                            pbi->num_workers)) {
+    lock_buffer_pool(pool);
     pool->release_fb_cb(pool->cb_priv, fb);
+    unlock_buffer_pool(pool);
     return NULL;
   }
 
@@ -805,21 +1106,11 @@ static void move_decoder_metadata_to_img(AV1Decoder *pbi, aom_image_t *img) {
   }
 }
 
-static aom_image_t *decoder_get_frame(aom_codec_alg_priv_t *ctx,
-                                      aom_codec_iter_t *iter) {
+// Returns the frame at position 'index' in the output queue of the current
+// frame worker.
+static aom_image_t *get_worker_frame(aom_codec_alg_priv_t *ctx,
+                                     uintptr_t *index) {
   aom_image_t *img = NULL;
-
-  if (!iter) {
-    return NULL;
-  }
-
-  // To avoid having to allocate any extra storage, treat 'iter' as
-  // simply a pointer to an integer index
-  uintptr_t *index = (uintptr_t *)iter;
-
-  if (ctx->frame_worker == NULL) {
-    return NULL;
-  }
   const AVxWorkerInterface *const winterface = aom_get_worker_interface();
   AVxWorker *const worker = ctx->frame_worker;
   FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
@@ -912,7 +1203,7 @@ static aom_image_t *decoder_get_frame(aom_codec_alg_priv_t *ctx,
   img->spatial_id = output_frame_buf->spatial_id;
   if (pbi->skip_film_grain) grain_params->apply_grain = 0;
   aom_image_t *res =
-      add_grain_if_needed(ctx, img, &ctx->image_with_grain, grain_params);
+      add_grain_if_needed(ctx, pbi, img, &ctx->image_with_grain, grain_params);
   if (!res) {
     pbi->error.error_code = AOM_CODEC_CORRUPT_FRAME;
     pbi->error.has_detail = 1;
@@ -924,6 +1215,39 @@ static aom_image_t *decoder_get_frame(aom_codec_alg_priv_t *ctx,
   return res;
 }
 
+static aom_image_t *decoder_get_frame(aom_codec_alg_priv_t *ctx,
+                                      aom_codec_iter_t *iter) {
+  if (!iter) {
+    return NULL;
+  }
+
+  // To avoid having to allocate any extra storage, treat 'iter' as
+  // simply a pointer to an integer index
+  uintptr_t *index = (uintptr_t *)iter;
+
+  if (ctx->frame_worker == NULL) {
+    return NULL;
+  }
+  if (ctx->num_frame_workers == 1) return get_worker_frame(ctx, index);
+
+  // Frame parallel mode. The frames of a temporal unit are output once all
+  // the frame workers are busy, or once the decoder is flushed.
+  for (;;) {
+    if (!ctx->output_worker_selected) {
+      if (!ctx->flushed &&
+          ctx->num_pending_frame_workers < ctx->num_frame_workers - 1) {
+        return NULL;
+      }
+      if (!select_output_worker(ctx)) return NULL;
+      *index = 0;
+    }
+    aom_image_t *const img = get_worker_frame(ctx, index);
+    if (img != NULL || !ctx->flushed) return img;
+    // Move on to the next temporal unit in flight.
+    release_pending_output_frames(ctx);
+  }
+}
+
 static aom_codec_err_t decoder_set_fb_fn(
     aom_codec_alg_priv_t *ctx, aom_get_frame_buffer_cb_fn_t cb_get,
     aom_release_frame_buffer_cb_fn_t cb_release, void *cb_priv) {
@@ -946,6 +1270,9 @@ static aom_codec_err_t ctrl_set_reference(aom_codec_alg_priv_t *ctx,
                                           va_list args) {
   av1_ref_frame_t *const data = va_arg(args, av1_ref_frame_t *);
 
+  // The references are owned by the frame workers in frame parallel mode.
+  if (ctx->num_frame_workers > 1) return AOM_CODEC_INCAPABLE;
+
   if (data) {
     av1_ref_frame_t *const frame = data;
     YV12_BUFFER_CONFIG sd;
@@ -1666,6 +1993,20 @@ static aom_codec_err_t ctrl_set_row_mt(aom_codec_alg_priv_t *ctx,
   return AOM_CODEC_OK;
 }
 
+static aom_codec_err_t ctrl_set_frame_parallel(aom_codec_alg_priv_t *ctx,
+                                               va_list args) {
+  const unsigned int frame_parallel = va_arg(args, unsigned int);
+  // The number of frame workers is fixed once the decoder is initialized.
+  if (ctx->frame_worker != NULL) return AOM_CODEC_ERROR;
+  if (frame_parallel > MAX_FRAME_PARALLEL) return AOM_CODEC_INVALID_PARAM;
+#if CONFIG_MULTITHREAD
+  ctx->frame_parallel = frame_parallel;
+#else
+  (void)frame_parallel;
+#endif
+  return AOM_CODEC_OK;
+}
+
 static aom_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
   { AV1_COPY_REFERENCE, ctrl_copy_reference },
 
@@ -1683,6 +2024,7 @@ static aom_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
   { AV1_SET_INSPECTION_CALLBACK, ctrl_set_inspection_callback },
   { AV1D_EXT_TILE_DEBUG, ctrl_ext_tile_debug },
   { AV1D_SET_ROW_MT, ctrl_set_row_mt },
+  { AV1D_SET_FRAME_PARALLEL, ctrl_set_frame_parallel },
   { AV1D_SET_EXT_REF_PTR, ctrl_set_ext_ref_ptr },
   { AV1D_SET_SKIP_FILM_GRAIN, ctrl_set_skip_film_grain },
 
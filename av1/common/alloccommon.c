@@ -101,20 +101,8 @@ static inline void free_cdef_bufs(uint16_t **colbuf, uint16_t **srcbuf) {
 static inline void free_cdef_row_sync(AV1CdefRowSync **cdef_row_mt,
                                       const int num_mi_rows) {
   if (*cdef_row_mt == NULL) return;
-#if CONFIG_MULTITHREAD
-  for (int row_idx = 0; row_idx < num_mi_rows; row_idx++) {
-    if ((*cdef_row_mt)[row_idx].row_mutex_ != NULL) {
-      pthread_mutex_destroy((*cdef_row_mt)[row_idx].row_mutex_);
-      aom_free((*cdef_row_mt)[row_idx].row_mutex_);
-    }
-    if ((*cdef_row_mt)[row_idx].row_cond_ != NULL) {
-      pthread_cond_destroy((*cdef_row_mt)[row_idx].row_cond_);
-      aom_free((*cdef_row_mt)[row_idx].row_cond_);
-    }
-  }
-#else
-  (void)num_mi_rows;
-#endif  // CONFIG_MULTITHREAD
+  for (int row_idx = 0; row_idx < num_mi_rows; row_idx++)
+    aom_progress_destroy(&(*cdef_row_mt)[row_idx].is_row_done);
   aom_free(*cdef_row_mt);
   *cdef_row_mt = NULL;
 }
@@ -176,17 +164,8 @@ static inline void alloc_cdef_row_sync(AV1_COMMON *const cm,
 
   CHECK_MEM_ERROR(cm, *cdef_row_mt,
                   aom_calloc(num_mi_rows, sizeof(**cdef_row_mt)));
-#if CONFIG_MULTITHREAD
-  for (int row_idx = 0; row_idx < num_mi_rows; row_idx++) {
-    CHECK_MEM_ERROR(cm, (*cdef_row_mt)[row_idx].row_mutex_,
-                    aom_malloc(sizeof(*(*cdef_row_mt)[row_idx].row_mutex_)));
-    pthread_mutex_init((*cdef_row_mt)[row_idx].row_mutex_, NULL);
-
-    CHECK_MEM_ERROR(cm, (*cdef_row_mt)[row_idx].row_cond_,
-                    aom_malloc(sizeof(*(*cdef_row_mt)[row_idx].row_cond_)));
-    pthread_cond_init((*cdef_row_mt)[row_idx].row_cond_, NULL);
-  }
-#endif  // CONFIG_MULTITHREAD
+  for (int row_idx = 0; row_idx < num_mi_rows; row_idx++)
+    aom_progress_init(&(*cdef_row_mt)[row_idx].is_row_done, 0);
 }
 
 void av1_alloc_cdef_buffers(AV1_COMMON *const cm,
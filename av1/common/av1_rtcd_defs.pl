@@ -250,6 +250,24 @@ specialize "av1_round_shift_array", qw/sse4_1 neon/;
 add_proto qw/void av1_resize_and_extend_frame/, "const YV12_BUFFER_CONFIG *src, YV12_BUFFER_CONFIG *dst, const InterpFilter filter, const int phase, const int num_planes";
 specialize qw/av1_resize_and_extend_frame ssse3 neon/;
 
+#
+# Decoder functions below this point.
+#
+if (aom_config("CONFIG_AV1_DECODER") eq "yes") {
+  # Film grain synthesis.
+  add_proto qw/void av1_add_film_grain_luma/, "uint8_t *luma, int luma_stride, const int *grain, int grain_stride, int width, int height, const int *scaling_lut, int scaling_shift, int min_val, int max_val";
+  specialize qw/av1_add_film_grain_luma sse4_1 avx2 neon/;
+
+  add_proto qw/void av1_add_film_grain_chroma/, "uint8_t *chroma, int chroma_stride, const uint8_t *luma, int luma_stride, const int *grain, int grain_stride, int width, int height, int subsampling_x, int subsampling_y, const int *scaling_lut, int luma_mult, int chroma_mult, int offset, int scaling_shift, int min_val, int max_val";
+  specialize qw/av1_add_film_grain_chroma sse4_1 avx2 neon/;
+
+  add_proto qw/void av1_highbd_add_film_grain_luma/, "uint16_t *luma, int luma_stride, const int *grain, int grain_stride, int width, int height, const int *scaling_lut, int scaling_shift, int min_val, int max_val";
+  specialize qw/av1_highbd_add_film_grain_luma sse4_1 avx2 neon/;
+
+  add_proto qw/void av1_highbd_add_film_grain_chroma/, "uint16_t *chroma, int chroma_stride, const uint16_t *luma, int luma_stride, const int *grain, int grain_stride, int width, int height, int subsampling_x, int subsampling_y, const int *scaling_lut, int luma_mult, int chroma_mult, int offset, int scaling_shift, int min_val, int max_val, int bd";
+  specialize qw/av1_highbd_add_film_grain_chroma sse4_1 avx2 neon/;
+}
+
 #
 # Encoder functions below this point.
 #
@@ -443,11 +461,16 @@ if (aom_config("CONFIG_AV1_ENCODER") eq "yes") {
   add_proto qw/void av1_nn_predict/, "const float *input_nodes, const NN_CONFIG *const nn_config, int reduce_prec, float *const output";
 
   add_proto qw/void av1_nn_fast_softmax_16/, "const float *input_nodes, float *output";
+  add_proto qw/void av1_nn_fc_batch/, "const float *input, int num_samples, int num_inputs, const float *weights, const float *bias, int num_outputs, int relu, float *output";
   if (aom_config("CONFIG_EXCLUDE_SIMD_MISMATCH") ne "yes") {
     specialize qw/av1_nn_predict sse3 avx2 neon/;
     specialize qw/av1_nn_fast_softmax_16 sse3/;
+    specialize qw/av1_nn_fc_batch avx2 neon/;
   }
 
+  add_proto qw/void av1_nn_fc_q/, "const int16_t *input, const int8_t *weights, int weights_stride, int num_outputs, int32_t *output";
+  specialize qw/av1_nn_fc_q avx2 neon/;
+
   # CNN functions
   if (aom_config("CONFIG_REALTIME_ONLY") ne "yes") {
     add_proto qw/void av1_cnn_activate/, "float **input, int channels, int width, int height, int stride, ACTIVATION layer_activation";
@@ -462,6 +485,10 @@ if (aom_config("CONFIG_AV1_ENCODER") eq "yes") {
     add_proto qw/void av1_cnn_batchnorm/, "float **image, int channels, int width, int height, int stride, const float *gamma, const float *beta, const float *mean, const float *std";
   }
 
+  # CDEF strength search
+  add_proto qw/void av1_cdef_add_best_mse/, "uint64_t *tot_mse, const uint64_t *mse, uint64_t offset, uint64_t best_mse, int n";
+  specialize qw/av1_cdef_add_best_mse avx2 neon/;
+
   # Temporal Denoiser
   if (aom_config("CONFIG_AV1_TEMPORAL_DENOISING") eq "yes") {
     add_proto qw/int av1_denoiser_filter/, "const uint8_t *sig, int sig_stride, const uint8_t *mc_avg, int mc_avg_stride, uint8_t *avg, int avg_stride, int increase_denoising, BLOCK_SIZE bs, int motion_magnitude";
@@ -567,14 +594,14 @@ if(aom_config("CONFIG_AV1_HIGHBITDEPTH") eq "yes") {
 
   add_proto qw/void av1_convolve_2d_scale/, "const uint8_t *src, int src_stride, uint8_t *dst, int dst_stride, int w, int h, const InterpFilterParams *filter_params_x, const InterpFilterParams *filter_params_y, const int subpel_x_qn, const int x_step_qn, const int subpel_y_qn, const int y_step_qn, ConvolveParams *conv_params";
 
-  specialize qw/av1_convolve_2d_sr sse2 avx2 neon neon_dotprod neon_i8mm sve2/;
+  specialize qw/av1_convolve_2d_sr sse2 avx2 avx512 neon neon_dotprod neon_i8mm sve2/;
   specialize qw/av1_convolve_2d_sr_intrabc neon/;
   specialize qw/av1_convolve_x_sr sse2 avx2 neon neon_dotprod neon_i8mm/;
   specialize qw/av1_convolve_x_sr_intrabc neon/;
   specialize qw/av1_convolve_y_sr sse2 avx2 neon neon_dotprod neon_i8mm/;
   specialize qw/av1_convolve_y_sr_intrabc neon/;
   specialize qw/av1_convolve_2d_scale sse4_1 neon neon_dotprod neon_i8mm/;
-  specialize qw/av1_dist_wtd_convolve_2d ssse3 avx2 neon neon_dotprod neon_i8mm/;
+  specialize qw/av1_dist_wtd_convolve_2d ssse3 avx2 avx512 neon neon_dotprod neon_i8mm/;
   specialize qw/av1_dist_wtd_convolve_2d_copy sse2 avx2 neon/;
   specialize qw/av1_dist_wtd_convolve_x sse2 avx2 neon neon_dotprod neon_i8mm/;
   specialize qw/av1_dist_wtd_convolve_y sse2 avx2 neon/;
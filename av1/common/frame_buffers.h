@@ -30,8 +30,10 @@ typedef struct InternalFrameBufferList {
   InternalFrameBuffer *int_fb;
 } InternalFrameBufferList;
 
-// Initializes |list|. Returns 0 on success.
-int av1_alloc_internal_frame_buffers(InternalFrameBufferList *list);
+// Initializes |list| with |num_buffers| buffers, which must be at least
+// #AOM_MAXIMUM_REF_BUFFERS + #AOM_MAXIMUM_WORK_BUFFERS. Returns 0 on success.
+int av1_alloc_internal_frame_buffers(InternalFrameBufferList *list,
+                                     int num_buffers);
 
 // Free any data allocated to the frame buffers.
 void av1_free_internal_frame_buffers(InternalFrameBufferList *list);
@@ -575,41 +575,60 @@ bool should_resize_by_half(int height, int width, int height2, int width2) {
   return (is_width_by_2 && is_height_by_2);
 }
 
-bool av1_resize_plane(const uint8_t *input, int height, int width,
-                      int in_stride, uint8_t *output, int height2, int width2,
-                      int out_stride) {
-  int i;
-  bool mem_status = true;
-  uint8_t *intbuf = (uint8_t *)aom_malloc(sizeof(uint8_t) * width2 * height);
-  uint8_t *tmpbuf =
-      (uint8_t *)aom_malloc(sizeof(uint8_t) * AOMMAX(width, height));
-  uint8_t *arrbuf = (uint8_t *)aom_malloc(sizeof(uint8_t) * height);
-  uint8_t *arrbuf2 = (uint8_t *)aom_malloc(sizeof(uint8_t) * height2);
-  if (intbuf == NULL || tmpbuf == NULL || arrbuf == NULL || arrbuf2 == NULL) {
-    mem_status = false;
-    goto Error;
-  }
+bool av1_resize_plane_rows(const uint8_t *input, int width, int in_stride,
+                           uint8_t *intbuf, int width2, int row_start,
+                           int row_end) {
   assert(width > 0);
-  assert(height > 0);
   assert(width2 > 0);
-  assert(height2 > 0);
-  for (i = 0; i < height; ++i)
+  uint8_t *tmpbuf = (uint8_t *)aom_malloc(sizeof(*tmpbuf) * width);
+  if (tmpbuf == NULL) return false;
+  for (int i = row_start; i < row_end; ++i)
     resize_multistep(input + in_stride * i, width, intbuf + width2 * i, width2,
                      tmpbuf);
-  for (i = 0; i < width2; ++i) {
-    fill_col_to_arr(intbuf + i, width2, height, arrbuf);
+  aom_free(tmpbuf);
+  return true;
+}
+
+bool av1_resize_plane_cols(const uint8_t *intbuf, int height, int width2,
+                           uint8_t *output, int height2, int out_stride,
+                           int col_start, int col_end) {
+  bool mem_status = true;
+  assert(height > 0);
+  assert(height2 > 0);
+  uint8_t *tmpbuf = (uint8_t *)aom_malloc(sizeof(*tmpbuf) * height);
+  uint8_t *arrbuf = (uint8_t *)aom_malloc(sizeof(*arrbuf) * height);
+  uint8_t *arrbuf2 = (uint8_t *)aom_malloc(sizeof(*arrbuf2) * height2);
+  if (tmpbuf == NULL || arrbuf == NULL || arrbuf2 == NULL) {
+    mem_status = false;
+    goto Error;
+  }
+  for (int i = col_start; i < col_end; ++i) {
+    fill_col_to_arr((uint8_t *)intbuf + i, width2, height, arrbuf);
     resize_multistep(arrbuf, height, arrbuf2, height2, tmpbuf);
     fill_arr_to_col(output + i, out_stride, height2, arrbuf2);
   }
 
 Error:
-  aom_free(intbuf);
   aom_free(tmpbuf);
   aom_free(arrbuf);
   aom_free(arrbuf2);
   return mem_status;
 }
 
+bool av1_resize_plane(const uint8_t *input, int height, int width,
+                      int in_stride, uint8_t *output, int height2, int width2,
+                      int out_stride) {
+  uint8_t *intbuf = (uint8_t *)aom_malloc(sizeof(uint8_t) * width2 * height);
+  if (intbuf == NULL) return false;
+  const bool mem_status =
+      av1_resize_plane_rows(input, width, in_stride, intbuf, width2, 0,
+                            height) &&
+      av1_resize_plane_cols(intbuf, height, width2, output, height2,
+                            out_stride, 0, width2);
+  aom_free(intbuf);
+  return mem_status;
+}
+
 static bool upscale_normative_rect(const uint8_t *const input, int height,
                                    int width, int in_stride, uint8_t *output,
                                    int height2, int width2, int out_stride,
@@ -932,33 +951,56 @@ static void highbd_fill_arr_to_col(uint16_t *img, int stride, int len,
   }
 }
 
-void av1_highbd_resize_plane(const uint8_t *input, int height, int width,
-                             int in_stride, uint8_t *output, int height2,
-                             int width2, int out_stride, int bd) {
-  int i;
-  uint16_t *intbuf = (uint16_t *)aom_malloc(sizeof(uint16_t) * width2 * height);
-  uint16_t *tmpbuf =
-      (uint16_t *)aom_malloc(sizeof(uint16_t) * AOMMAX(width, height));
-  uint16_t *arrbuf = (uint16_t *)aom_malloc(sizeof(uint16_t) * height);
-  uint16_t *arrbuf2 = (uint16_t *)aom_malloc(sizeof(uint16_t) * height2);
-  if (intbuf == NULL || tmpbuf == NULL || arrbuf == NULL || arrbuf2 == NULL)
-    goto Error;
-  for (i = 0; i < height; ++i) {
+bool av1_highbd_resize_plane_rows(const uint8_t *input, int width,
+                                  int in_stride, uint16_t *intbuf, int width2,
+                                  int row_start, int row_end, int bd) {
+  uint16_t *tmpbuf = (uint16_t *)aom_malloc(sizeof(*tmpbuf) * width);
+  if (tmpbuf == NULL) return false;
+  for (int i = row_start; i < row_end; ++i) {
     highbd_resize_multistep(CONVERT_TO_SHORTPTR(input + in_stride * i), width,
                             intbuf + width2 * i, width2, tmpbuf, bd);
   }
-  for (i = 0; i < width2; ++i) {
-    highbd_fill_col_to_arr(intbuf + i, width2, height, arrbuf);
+  aom_free(tmpbuf);
+  return true;
+}
+
+bool av1_highbd_resize_plane_cols(const uint16_t *intbuf, int height,
+                                  int width2, uint8_t *output, int height2,
+                                  int out_stride, int col_start, int col_end,
+                                  int bd) {
+  bool mem_status = true;
+  uint16_t *tmpbuf = (uint16_t *)aom_malloc(sizeof(*tmpbuf) * height);
+  uint16_t *arrbuf = (uint16_t *)aom_malloc(sizeof(*arrbuf) * height);
+  uint16_t *arrbuf2 = (uint16_t *)aom_malloc(sizeof(*arrbuf2) * height2);
+  if (tmpbuf == NULL || arrbuf == NULL || arrbuf2 == NULL) {
+    mem_status = false;
+    goto Error;
+  }
+  for (int i = col_start; i < col_end; ++i) {
+    highbd_fill_col_to_arr((uint16_t *)intbuf + i, width2, height, arrbuf);
     highbd_resize_multistep(arrbuf, height, arrbuf2, height2, tmpbuf, bd);
     highbd_fill_arr_to_col(CONVERT_TO_SHORTPTR(output + i), out_stride, height2,
                            arrbuf2);
   }
 
 Error:
-  aom_free(intbuf);
   aom_free(tmpbuf);
   aom_free(arrbuf);
   aom_free(arrbuf2);
+  return mem_status;
+}
+
+void av1_highbd_resize_plane(const uint8_t *input, int height, int width,
+                             int in_stride, uint8_t *output, int height2,
+                             int width2, int out_stride, int bd) {
+  uint16_t *intbuf = (uint16_t *)aom_malloc(sizeof(uint16_t) * width2 * height);
+  if (intbuf == NULL) return;
+  if (av1_highbd_resize_plane_rows(input, width, in_stride, intbuf, width2, 0,
+                                   height, bd)) {
+    av1_highbd_resize_plane_cols(intbuf, height, width2, output, height2,
+                                 out_stride, 0, width2, bd);
+  }
+  aom_free(intbuf);
 }
 
 static bool highbd_upscale_normative_rect(const uint8_t *const input,
@@ -1131,6 +1173,54 @@ bool av1_resize_and_extend_frame_nonnormative(const YV12_BUFFER_CONFIG *src,
   return true;
 }
 
+// Sets band to the rows [rows[is_uv][0], rows[is_uv][1]) of the planes of
+// frame, without borders.
+static void get_frame_band(const YV12_BUFFER_CONFIG *frame,
+                           const int rows[2][2], YV12_BUFFER_CONFIG *band) {
+  *band = *frame;
+  band->border = 0;
+  for (int i = 0; i < MAX_MB_PLANE; ++i) {
+    const int is_uv = i > 0;
+    band->buffers[i] += rows[is_uv][0] * frame->strides[is_uv];
+  }
+  for (int is_uv = 0; is_uv < 2; ++is_uv) {
+    band->crop_heights[is_uv] = rows[is_uv][1] - rows[is_uv][0];
+    band->heights[is_uv] = band->crop_heights[is_uv];
+    band->widths[is_uv] = band->crop_widths[is_uv];
+  }
+}
+
+void av1_resize_frame_band(const YV12_BUFFER_CONFIG *src,
+                           YV12_BUFFER_CONFIG *dst, const InterpFilter filter,
+                           const int phase, const int num_planes,
+                           int row_start, int row_end) {
+  assert(row_start % RESIZE_BAND_ALIGNMENT == 0);
+  assert(row_end == dst->y_crop_height || row_end % RESIZE_BAND_ALIGNMENT == 0);
+  int src_rows[2][2];
+  int dst_rows[2][2];
+  for (int is_uv = 0; is_uv < 2; ++is_uv) {
+    const int ss_y = is_uv ? dst->subsampling_y : 0;
+    const int src_h = src->crop_heights[is_uv];
+    const int dst_h = dst->crop_heights[is_uv];
+    dst_rows[is_uv][0] = row_start >> ss_y;
+    dst_rows[is_uv][1] =
+        row_end == dst->y_crop_height ? dst_h : row_end >> ss_y;
+    for (int k = 0; k < 2; ++k) {
+      // The scaling of the band only matches that of the frame if the band
+      // starts at a whole source row, i.e. at phase 0.
+      assert((int64_t)dst_rows[is_uv][k] * src_h % dst_h == 0);
+      src_rows[is_uv][k] =
+          (int)((int64_t)dst_rows[is_uv][k] * src_h / dst_h);
+    }
+  }
+  YV12_BUFFER_CONFIG src_band;
+  YV12_BUFFER_CONFIG dst_band;
+  get_frame_band(src, src_rows, &src_band);
+  get_frame_band(dst, dst_rows, &dst_band);
+  // The band has no border, so its borders are not extended.
+  av1_resize_and_extend_frame(&src_band, &dst_band, filter, phase, num_planes);
+}
+
 void av1_upscale_normative_rows(const AV1_COMMON *cm, const uint8_t *src,
                                 int src_stride, uint8_t *dst, int dst_stride,
                                 int plane, int rows) {
@@ -38,6 +38,27 @@ void av1_highbd_resize_plane(const uint8_t *input, int height, int width,
                              int in_stride, uint8_t *output, int height2,
                              int width2, int out_stride, int bd);
 
+// The two passes of av1_resize_plane(), which can be run on bands of rows and
+// of columns respectively. intbuf holds the plane scaled horizontally, width2
+// samples by height. av1_resize_plane_rows() scales rows [row_start, row_end)
+// of input into intbuf, then av1_resize_plane_cols() scales columns
+// [col_start, col_end) of intbuf into output. They return false on allocation
+// failure.
+bool av1_resize_plane_rows(const uint8_t *input, int width, int in_stride,
+                           uint8_t *intbuf, int width2, int row_start,
+                           int row_end);
+bool av1_resize_plane_cols(const uint8_t *intbuf, int height, int width2,
+                           uint8_t *output, int height2, int out_stride,
+                           int col_start, int col_end);
+// Same as above, for av1_highbd_resize_plane().
+bool av1_highbd_resize_plane_rows(const uint8_t *input, int width,
+                                  int in_stride, uint16_t *intbuf, int width2,
+                                  int row_start, int row_end, int bd);
+bool av1_highbd_resize_plane_cols(const uint16_t *intbuf, int height,
+                                  int width2, uint8_t *output, int height2,
+                                  int out_stride, int col_start, int col_end,
+                                  int bd);
+
 void av1_upscale_normative_rows(const AV1_COMMON *cm, const uint8_t *src,
                                 int src_stride, uint8_t *dst, int dst_stride,
                                 int plane, int rows);
@@ -54,6 +75,22 @@ bool av1_resize_and_extend_frame_nonnormative(const YV12_BUFFER_CONFIG *src,
                                               YV12_BUFFER_CONFIG *dst, int bd,
                                               int num_planes);
 
+// The luma rows of the bands of av1_resize_frame_band() start at multiples of
+// RESIZE_BAND_ALIGNMENT, which keeps the chroma rows of the bands aligned to
+// the period of every scaling ratio of av1_resize_and_extend_frame().
+#define RESIZE_BAND_ALIGNMENT 96
+
+// Scales luma rows [row_start, row_end) of dst, and the chroma rows they
+// cover, like av1_resize_and_extend_frame() does for the whole frame, so that
+// a frame can be scaled in bands processed in parallel. The borders of dst are
+// not extended. row_start must be a multiple of RESIZE_BAND_ALIGNMENT, and so
+// must row_end unless it is the height of dst. The scaling ratio must be one
+// av1_has_optimized_scaler() accepts.
+void av1_resize_frame_band(const YV12_BUFFER_CONFIG *src,
+                           YV12_BUFFER_CONFIG *dst, const InterpFilter filter,
+                           const int phase, const int num_planes,
+                           int row_start, int row_end);
+
 // Calculates the scaled dimensions from the given original dimensions and the
 // resize scale denominator.
 void av1_calculate_scaled_size(int *width, int *height, int resize_denom);
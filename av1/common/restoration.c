@@ -10,6 +10,7 @@
  *
  */
 
+#include <limits.h>
 #include <math.h>
 #include <stddef.h>
 
@@ -121,43 +122,51 @@ void av1_loop_restoration_precal(void) {
 
 static void extend_frame_lowbd(uint8_t *data, int width, int height,
                                ptrdiff_t stride, int border_horz,
-                               int border_vert) {
+                               int border_vert, int row_start, int row_end) {
   uint8_t *data_p;
   int i;
-  for (i = 0; i < height; ++i) {
+  for (i = row_start; i < row_end; ++i) {
     data_p = data + i * stride;
     memset(data_p - border_horz, data_p[0], border_horz);
     memset(data_p + width, data_p[width - 1], border_horz);
   }
   data_p = data - border_horz;
-  for (i = -border_vert; i < 0; ++i) {
-    memcpy(data_p + i * stride, data_p, width + 2 * border_horz);
+  if (row_start == 0) {
+    for (i = -border_vert; i < 0; ++i) {
+      memcpy(data_p + i * stride, data_p, width + 2 * border_horz);
+    }
   }
-  for (i = height; i < height + border_vert; ++i) {
-    memcpy(data_p + i * stride, data_p + (height - 1) * stride,
-           width + 2 * border_horz);
+  if (row_end == height) {
+    for (i = height; i < height + border_vert; ++i) {
+      memcpy(data_p + i * stride, data_p + (height - 1) * stride,
+             width + 2 * border_horz);
+    }
   }
 }
 
 #if CONFIG_AV1_HIGHBITDEPTH
 static void extend_frame_highbd(uint16_t *data, int width, int height,
                                 ptrdiff_t stride, int border_horz,
-                                int border_vert) {
+                                int border_vert, int row_start, int row_end) {
   uint16_t *data_p;
   int i, j;
-  for (i = 0; i < height; ++i) {
+  for (i = row_start; i < row_end; ++i) {
     data_p = data + i * stride;
     for (j = -border_horz; j < 0; ++j) data_p[j] = data_p[0];
     for (j = width; j < width + border_horz; ++j) data_p[j] = data_p[width - 1];
   }
   data_p = data - border_horz;
-  for (i = -border_vert; i < 0; ++i) {
-    memcpy(data_p + i * stride, data_p,
-           (width + 2 * border_horz) * sizeof(uint16_t));
+  if (row_start == 0) {
+    for (i = -border_vert; i < 0; ++i) {
+      memcpy(data_p + i * stride, data_p,
+             (width + 2 * border_horz) * sizeof(uint16_t));
+    }
   }
-  for (i = height; i < height + border_vert; ++i) {
-    memcpy(data_p + i * stride, data_p + (height - 1) * stride,
-           (width + 2 * border_horz) * sizeof(uint16_t));
+  if (row_end == height) {
+    for (i = height; i < height + border_vert; ++i) {
+      memcpy(data_p + i * stride, data_p + (height - 1) * stride,
+             (width + 2 * border_horz) * sizeof(uint16_t));
+    }
   }
 }
 
@@ -169,17 +178,26 @@ static void copy_rest_unit_highbd(int width, int height, const uint16_t *src,
 }
 #endif
 
-void av1_extend_frame(uint8_t *data, int width, int height, int stride,
-                      int border_horz, int border_vert, int highbd) {
+void av1_extend_frame_rows(uint8_t *data, int width, int height, int stride,
+                           int border_horz, int border_vert, int highbd,
+                           int row_start, int row_end) {
+  assert(row_start >= 0 && row_start <= row_end && row_end <= height);
 #if CONFIG_AV1_HIGHBITDEPTH
   if (highbd) {
     extend_frame_highbd(CONVERT_TO_SHORTPTR(data), width, height, stride,
-                        border_horz, border_vert);
+                        border_horz, border_vert, row_start, row_end);
     return;
   }
 #endif
   (void)highbd;
-  extend_frame_lowbd(data, width, height, stride, border_horz, border_vert);
+  extend_frame_lowbd(data, width, height, stride, border_horz, border_vert,
+                     row_start, row_end);
+}
+
+void av1_extend_frame(uint8_t *data, int width, int height, int stride,
+                      int border_horz, int border_vert, int highbd) {
+  av1_extend_frame_rows(data, width, height, stride, border_horz, border_vert,
+                        highbd, 0, height);
 }
 
 static void copy_rest_unit_lowbd(int width, int height, const uint8_t *src,
@@ -1071,7 +1089,8 @@ static void filter_frame_on_unit(const RestorationTileLimits *limits,
 void av1_loop_restoration_filter_frame_init(AV1LrStruct *lr_ctxt,
                                             YV12_BUFFER_CONFIG *frame,
                                             AV1_COMMON *cm, int optimized_lr,
-                                            int num_planes) {
+                                            int num_planes,
+                                            int do_extend_frame) {
   const SequenceHeader *const seq_params = cm->seq_params;
   const int bit_depth = seq_params->bit_depth;
   const int highbd = seq_params->use_highbitdepth;
@@ -1105,9 +1124,11 @@ void av1_loop_restoration_filter_frame_init(AV1LrStruct *lr_ctxt,
     assert(plane_w == frame->crop_widths[is_uv]);
     assert(plane_h == frame->crop_heights[is_uv]);
 
-    av1_extend_frame(frame->buffers[plane], plane_w, plane_h,
-                     frame->strides[is_uv], RESTORATION_BORDER,
-                     RESTORATION_BORDER, highbd);
+    if (do_extend_frame) {
+      av1_extend_frame(frame->buffers[plane], plane_w, plane_h,
+                       frame->strides[is_uv], RESTORATION_BORDER,
+                       RESTORATION_BORDER, highbd);
+    }
 
     FilterFrameCtxt *lr_plane_ctxt = &lr_ctxt->ctxt[plane];
     lr_plane_ctxt->ss_x = is_uv && seq_params->subsampling_x;
@@ -1203,7 +1224,8 @@ void av1_loop_restoration_filter_frame(YV12_BUFFER_CONFIG *frame,
   AV1LrStruct *loop_rest_ctxt = (AV1LrStruct *)lr_ctxt;
 
   av1_loop_restoration_filter_frame_init(loop_rest_ctxt, frame, cm,
-                                         optimized_lr, num_planes);
+                                         optimized_lr, num_planes,
+                                         /*do_extend_frame=*/1);
 
   foreach_rest_unit_in_planes(loop_rest_ctxt, cm, num_planes);
 
@@ -1440,7 +1462,8 @@ static void save_cdef_boundary_lines(const YV12_BUFFER_CONFIG *frame,
 }
 
 static void save_boundary_lines(const YV12_BUFFER_CONFIG *frame, int use_highbd,
-                                int plane, AV1_COMMON *cm, int after_cdef) {
+                                int plane, AV1_COMMON *cm, int after_cdef,
+                                int row_start, int row_end) {
   const int is_uv = plane > 0;
   const int ss_y = is_uv && cm->seq_params->subsampling_y;
   const int stripe_height = RESTORATION_PROC_UNIT_SIZE >> ss_y;
@@ -1467,23 +1490,26 @@ static void save_boundary_lines(const YV12_BUFFER_CONFIG *frame, int use_highbd,
     const int use_deblock_above = (stripe_idx > 0);
     const int use_deblock_below = (y1 < plane_height);
 
+    // Only the lines starting in [row_start, row_end) are saved. The lines
+    // saved for a stripe boundary never straddle a 64x64 filter block row.
     if (!after_cdef) {
       // Save deblocked context at internal stripe boundaries
-      if (use_deblock_above) {
-        save_deblock_boundary_lines(frame, cm, plane, y0 - RESTORATION_CTX_VERT,
-                                    stripe_idx, use_highbd, 1, boundaries);
+      const int above_row = y0 - RESTORATION_CTX_VERT;
+      if (use_deblock_above && above_row >= row_start && above_row < row_end) {
+        save_deblock_boundary_lines(frame, cm, plane, above_row, stripe_idx,
+                                    use_highbd, 1, boundaries);
       }
-      if (use_deblock_below) {
+      if (use_deblock_below && y1 >= row_start && y1 < row_end) {
         save_deblock_boundary_lines(frame, cm, plane, y1, stripe_idx,
                                     use_highbd, 0, boundaries);
       }
     } else {
       // Save CDEF context at frame boundaries
-      if (!use_deblock_above) {
+      if (!use_deblock_above && y0 >= row_start && y0 < row_end) {
         save_cdef_boundary_lines(frame, cm, plane, y0, stripe_idx, use_highbd,
                                  1, boundaries);
       }
-      if (!use_deblock_below) {
+      if (!use_deblock_below && y1 - 1 >= row_start && y1 - 1 < row_end) {
         save_cdef_boundary_lines(frame, cm, plane, y1 - 1, stripe_idx,
                                  use_highbd, 0, boundaries);
       }
@@ -1499,6 +1525,13 @@ void av1_loop_restoration_save_boundary_lines(const YV12_BUFFER_CONFIG *frame,
   const int num_planes = av1_num_planes(cm);
   const int use_highbd = cm->seq_params->use_highbitdepth;
   for (int p = 0; p < num_planes; ++p) {
-    save_boundary_lines(frame, use_highbd, p, cm, after_cdef);
+    save_boundary_lines(frame, use_highbd, p, cm, after_cdef, 0, INT_MAX);
   }
 }
+
+void av1_loop_restoration_save_plane_boundary_lines(
+    const YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm, int plane, int after_cdef,
+    int row_start, int row_end) {
+  save_boundary_lines(frame, cm->seq_params->use_highbitdepth, plane, cm,
+                      after_cdef, row_start, row_end);
+}
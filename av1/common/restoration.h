@@ -348,6 +348,12 @@ void av1_free_restoration_struct(RestorationInfo *rst_info);
 
 void av1_extend_frame(uint8_t *data, int width, int height, int stride,
                       int border_horz, int border_vert, int highbd);
+// Extends the rows [row_start, row_end) to the left and right. The top and
+// bottom borders are extended when the range contains the first and last row
+// respectively.
+void av1_extend_frame_rows(uint8_t *data, int width, int height, int stride,
+                           int border_horz, int border_vert, int highbd,
+                           int row_start, int row_end);
 void av1_decode_xq(const int *xqd, int *xq, const sgr_params_type *params);
 
 /*!\endcond */
@@ -435,10 +441,19 @@ int av1_loop_restoration_corners_in_sb(const struct AV1Common *cm, int plane,
 void av1_loop_restoration_save_boundary_lines(const YV12_BUFFER_CONFIG *frame,
                                               struct AV1Common *cm,
                                               int after_cdef);
+// Saves the boundary lines of one plane whose first row is in
+// [row_start, row_end), so that they can be saved as soon as the rows are
+// deblocked (after_cdef == 0) or filtered by CDEF (after_cdef == 1).
+void av1_loop_restoration_save_plane_boundary_lines(
+    const YV12_BUFFER_CONFIG *frame, struct AV1Common *cm, int plane,
+    int after_cdef, int row_start, int row_end);
+// If do_extend_frame is 0, the caller is responsible for extending the
+// borders of the planes to filter by RESTORATION_BORDER pixels.
 void av1_loop_restoration_filter_frame_init(AV1LrStruct *lr_ctxt,
                                             YV12_BUFFER_CONFIG *frame,
                                             struct AV1Common *cm,
-                                            int optimized_lr, int num_planes);
+                                            int optimized_lr, int num_planes,
+                                            int do_extend_frame);
 void av1_loop_restoration_copy_planes(AV1LrStruct *loop_rest_ctxt,
                                       struct AV1Common *cm, int num_planes);
 void av1_foreach_rest_unit_in_row(
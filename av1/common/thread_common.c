@@ -65,32 +65,10 @@ void av1_loop_filter_alloc(AV1LfSync *lf_sync, AV1_COMMON *cm, int rows,
                            int width, int num_workers) {
   lf_sync->rows = rows;
 #if CONFIG_MULTITHREAD
-  {
-    int i, j;
-
-    for (j = 0; j < MAX_MB_PLANE; j++) {
-      CHECK_MEM_ERROR(cm, lf_sync->mutex_[j],
-                      aom_malloc(sizeof(*(lf_sync->mutex_[j])) * rows));
-      if (lf_sync->mutex_[j]) {
-        for (i = 0; i < rows; ++i) {
-          pthread_mutex_init(&lf_sync->mutex_[j][i], NULL);
-        }
-      }
-
-      CHECK_MEM_ERROR(cm, lf_sync->cond_[j],
-                      aom_malloc(sizeof(*(lf_sync->cond_[j])) * rows));
-      if (lf_sync->cond_[j]) {
-        for (i = 0; i < rows; ++i) {
-          pthread_cond_init(&lf_sync->cond_[j][i], NULL);
-        }
-      }
-    }
-
-    CHECK_MEM_ERROR(cm, lf_sync->job_mutex,
-                    aom_malloc(sizeof(*(lf_sync->job_mutex))));
-    if (lf_sync->job_mutex) {
-      pthread_mutex_init(lf_sync->job_mutex, NULL);
-    }
+  CHECK_MEM_ERROR(cm, lf_sync->job_mutex,
+                  aom_malloc(sizeof(*(lf_sync->job_mutex))));
+  if (lf_sync->job_mutex) {
+    pthread_mutex_init(lf_sync->job_mutex, NULL);
   }
 #endif  // CONFIG_MULTITHREAD
   CHECK_MEM_ERROR(cm, lf_sync->lfdata,
@@ -98,8 +76,10 @@ void av1_loop_filter_alloc(AV1LfSync *lf_sync, AV1_COMMON *cm, int rows,
   lf_sync->num_workers = num_workers;
 
   for (int j = 0; j < MAX_MB_PLANE; j++) {
-    CHECK_MEM_ERROR(cm, lf_sync->cur_sb_col[j],
-                    aom_malloc(sizeof(*(lf_sync->cur_sb_col[j])) * rows));
+    if (!aom_progress_alloc_array(&lf_sync->cur_sb_col[j], rows, -1)) {
+      aom_internal_error(cm->error, AOM_CODEC_MEM_ERROR,
+                         "Failed to allocate lf_sync->cur_sb_col[j]");
+    }
   }
   CHECK_MEM_ERROR(
       cm, lf_sync->job_queue,
@@ -113,21 +93,6 @@ void av1_loop_filter_dealloc(AV1LfSync *lf_sync) {
   if (lf_sync != NULL) {
     int j;
 #if CONFIG_MULTITHREAD
-    int i;
-    for (j = 0; j < MAX_MB_PLANE; j++) {
-      if (lf_sync->mutex_[j] != NULL) {
-        for (i = 0; i < lf_sync->rows; ++i) {
-          pthread_mutex_destroy(&lf_sync->mutex_[j][i]);
-        }
-        aom_free(lf_sync->mutex_[j]);
-      }
-      if (lf_sync->cond_[j] != NULL) {
-        for (i = 0; i < lf_sync->rows; ++i) {
-          pthread_cond_destroy(&lf_sync->cond_[j][i]);
-        }
-        aom_free(lf_sync->cond_[j]);
-      }
-    }
     if (lf_sync->job_mutex != NULL) {
       pthread_mutex_destroy(lf_sync->job_mutex);
       aom_free(lf_sync->job_mutex);
@@ -135,7 +100,7 @@ void av1_loop_filter_dealloc(AV1LfSync *lf_sync) {
 #endif  // CONFIG_MULTITHREAD
     aom_free(lf_sync->lfdata);
     for (j = 0; j < MAX_MB_PLANE; j++) {
-      aom_free(lf_sync->cur_sb_col[j]);
+      aom_progress_free_array(&lf_sync->cur_sb_col[j], lf_sync->rows);
     }
 
     aom_free(lf_sync->job_queue);
@@ -174,13 +139,7 @@ static inline void cdef_row_mt_sync_read(AV1CdefSync *const cdef_sync,
                                          int row) {
   if (!row) return;
 #if CONFIG_MULTITHREAD
-  AV1CdefRowSync *const cdef_row_mt = cdef_sync->cdef_row_mt;
-  pthread_mutex_lock(cdef_row_mt[row - 1].row_mutex_);
-  while (cdef_row_mt[row - 1].is_row_done != 1)
-    pthread_cond_wait(cdef_row_mt[row - 1].row_cond_,
-                      cdef_row_mt[row - 1].row_mutex_);
-  cdef_row_mt[row - 1].is_row_done = 0;
-  pthread_mutex_unlock(cdef_row_mt[row - 1].row_mutex_);
+  aom_progress_wait(&cdef_sync->cdef_row_mt[row - 1].is_row_done, 1);
 #else
   (void)cdef_sync;
 #endif  // CONFIG_MULTITHREAD
@@ -189,11 +148,7 @@ static inline void cdef_row_mt_sync_read(AV1CdefSync *const cdef_sync,
 static inline void cdef_row_mt_sync_write(AV1CdefSync *const cdef_sync,
                                           int row) {
 #if CONFIG_MULTITHREAD
-  AV1CdefRowSync *const cdef_row_mt = cdef_sync->cdef_row_mt;
-  pthread_mutex_lock(cdef_row_mt[row].row_mutex_);
-  pthread_cond_signal(cdef_row_mt[row].row_cond_);
-  cdef_row_mt[row].is_row_done = 1;
-  pthread_mutex_unlock(cdef_row_mt[row].row_mutex_);
+  aom_progress_set(&cdef_sync->cdef_row_mt[row].is_row_done, 1);
 #else
   (void)cdef_sync;
   (void)row;
@@ -206,13 +161,7 @@ static inline void sync_read(AV1LfSync *const lf_sync, int r, int c,
   const int nsync = lf_sync->sync_range;
 
   if (r && !(c & (nsync - 1))) {
-    pthread_mutex_t *const mutex = &lf_sync->mutex_[plane][r - 1];
-    pthread_mutex_lock(mutex);
-
-    while (c > lf_sync->cur_sb_col[plane][r - 1] - nsync) {
-      pthread_cond_wait(&lf_sync->cond_[plane][r - 1], mutex);
-    }
-    pthread_mutex_unlock(mutex);
+    aom_progress_wait(&lf_sync->cur_sb_col[plane][r - 1], c + nsync);
   }
 #else
   (void)lf_sync;
@@ -238,17 +187,12 @@ static inline void sync_write(AV1LfSync *const lf_sync, int r, int c,
   }
 
   if (sig) {
-    pthread_mutex_lock(&lf_sync->mutex_[plane][r]);
-
     // When a thread encounters an error, cur_sb_col[plane][r] is set to maximum
-    // column number. In this case, the AOMMAX operation here ensures that
+    // column number. aom_progress_set() never decreases the value, so that
     // cur_sb_col[plane][r] is not overwritten with a smaller value thus
     // preventing the infinite waiting of threads in the relevant sync_read()
     // function.
-    lf_sync->cur_sb_col[plane][r] = AOMMAX(lf_sync->cur_sb_col[plane][r], cur);
-
-    pthread_cond_broadcast(&lf_sync->cond_[plane][r]);
-    pthread_mutex_unlock(&lf_sync->mutex_[plane][r]);
+    aom_progress_set(&lf_sync->cur_sb_col[plane][r], cur);
   }
 #else
   (void)lf_sync;
@@ -525,13 +469,7 @@ static inline void lr_sync_read(void *const lr_sync, int r, int c, int plane) {
   const int nsync = loop_res_sync->sync_range;
 
   if (r && !(c & (nsync - 1))) {
-    pthread_mutex_t *const mutex = &loop_res_sync->mutex_[plane][r - 1];
-    pthread_mutex_lock(mutex);
-
-    while (c > loop_res_sync->cur_sb_col[plane][r - 1] - nsync) {
-      pthread_cond_wait(&loop_res_sync->cond_[plane][r - 1], mutex);
-    }
-    pthread_mutex_unlock(mutex);
+    aom_progress_wait(&loop_res_sync->cur_sb_col[plane][r - 1], c + nsync);
   }
 #else
   (void)lr_sync;
@@ -558,18 +496,12 @@ static inline void lr_sync_write(void *const lr_sync, int r, int c,
   }
 
   if (sig) {
-    pthread_mutex_lock(&loop_res_sync->mutex_[plane][r]);
-
     // When a thread encounters an error, cur_sb_col[plane][r] is set to maximum
-    // column number. In this case, the AOMMAX operation here ensures that
+    // column number. aom_progress_set() never decreases the value, so that
     // cur_sb_col[plane][r] is not overwritten with a smaller value thus
     // preventing the infinite waiting of threads in the relevant sync_read()
     // function.
-    loop_res_sync->cur_sb_col[plane][r] =
-        AOMMAX(loop_res_sync->cur_sb_col[plane][r], cur);
-
-    pthread_cond_broadcast(&loop_res_sync->cond_[plane][r]);
-    pthread_mutex_unlock(&loop_res_sync->mutex_[plane][r]);
+    aom_progress_set(&loop_res_sync->cur_sb_col[plane][r], cur);
   }
 #else
   (void)lr_sync;
@@ -587,32 +519,10 @@ void av1_loop_restoration_alloc(AV1LrSync *lr_sync, AV1_COMMON *cm,
   lr_sync->rows = num_rows_lr;
   lr_sync->num_planes = num_planes;
 #if CONFIG_MULTITHREAD
-  {
-    int i, j;
-
-    for (j = 0; j < num_planes; j++) {
-      CHECK_MEM_ERROR(cm, lr_sync->mutex_[j],
-                      aom_malloc(sizeof(*(lr_sync->mutex_[j])) * num_rows_lr));
-      if (lr_sync->mutex_[j]) {
-        for (i = 0; i < num_rows_lr; ++i) {
-          pthread_mutex_init(&lr_sync->mutex_[j][i], NULL);
-        }
-      }
-
-      CHECK_MEM_ERROR(cm, lr_sync->cond_[j],
-                      aom_malloc(sizeof(*(lr_sync->cond_[j])) * num_rows_lr));
-      if (lr_sync->cond_[j]) {
-        for (i = 0; i < num_rows_lr; ++i) {
-          pthread_cond_init(&lr_sync->cond_[j][i], NULL);
-        }
-      }
-    }
-
-    CHECK_MEM_ERROR(cm, lr_sync->job_mutex,
-                    aom_malloc(sizeof(*(lr_sync->job_mutex))));
-    if (lr_sync->job_mutex) {
-      pthread_mutex_init(lr_sync->job_mutex, NULL);
-    }
+  CHECK_MEM_ERROR(cm, lr_sync->job_mutex,
+                  aom_malloc(sizeof(*(lr_sync->job_mutex))));
+  if (lr_sync->job_mutex) {
+    pthread_mutex_init(lr_sync->job_mutex, NULL);
   }
 #endif  // CONFIG_MULTITHREAD
   CHECK_MEM_ERROR(cm, lr_sync->lrworkerdata,
@@ -633,9 +543,10 @@ void av1_loop_restoration_alloc(AV1LrSync *lr_sync, AV1_COMMON *cm,
   }
 
   for (int j = 0; j < num_planes; j++) {
-    CHECK_MEM_ERROR(
-        cm, lr_sync->cur_sb_col[j],
-        aom_malloc(sizeof(*(lr_sync->cur_sb_col[j])) * num_rows_lr));
+    if (!aom_progress_alloc_array(&lr_sync->cur_sb_col[j], num_rows_lr, -1)) {
+      aom_internal_error(cm->error, AOM_CODEC_MEM_ERROR,
+                         "Failed to allocate lr_sync->cur_sb_col[j]");
+    }
   }
   CHECK_MEM_ERROR(
       cm, lr_sync->job_queue,
@@ -649,28 +560,13 @@ void av1_loop_restoration_dealloc(AV1LrSync *lr_sync) {
   if (lr_sync != NULL) {
     int j;
 #if CONFIG_MULTITHREAD
-    int i;
-    for (j = 0; j < MAX_MB_PLANE; j++) {
-      if (lr_sync->mutex_[j] != NULL) {
-        for (i = 0; i < lr_sync->rows; ++i) {
-          pthread_mutex_destroy(&lr_sync->mutex_[j][i]);
-        }
-        aom_free(lr_sync->mutex_[j]);
-      }
-      if (lr_sync->cond_[j] != NULL) {
-        for (i = 0; i < lr_sync->rows; ++i) {
-          pthread_cond_destroy(&lr_sync->cond_[j][i]);
-        }
-        aom_free(lr_sync->cond_[j]);
-      }
-    }
     if (lr_sync->job_mutex != NULL) {
       pthread_mutex_destroy(lr_sync->job_mutex);
       aom_free(lr_sync->job_mutex);
     }
 #endif  // CONFIG_MULTITHREAD
     for (j = 0; j < MAX_MB_PLANE; j++) {
-      aom_free(lr_sync->cur_sb_col[j]);
+      aom_progress_free_array(&lr_sync->cur_sb_col[j], lr_sync->rows);
     }
 
     aom_free(lr_sync->job_queue);
@@ -807,15 +703,60 @@ static void set_loop_restoration_done(AV1LrSync *const lr_sync,
   }
 }
 
+// Filters one row of restoration units and copies it back to the frame.
+static void loop_restoration_row(AV1LrSync *const lr_sync,
+                                 AV1LrStruct *const lr_ctxt,
+                                 const AV1LrMTInfo *const cur_job_info,
+                                 int32_t *rst_tmpbuf,
+                                 RestorationLineBuffers *rlbs,
+                                 int do_extend_border,
+                                 struct aom_internal_error_info *error_info) {
+  typedef void (*copy_fun)(const YV12_BUFFER_CONFIG *src_ybc,
+                           YV12_BUFFER_CONFIG *dst_ybc, int hstart, int hend,
+                           int vstart, int vend);
+  static const copy_fun copy_funs[MAX_MB_PLANE] = {
+    aom_yv12_partial_coloc_copy_y, aom_yv12_partial_coloc_copy_u,
+    aom_yv12_partial_coloc_copy_v
+  };
+
+  FilterFrameCtxt *ctxt = lr_ctxt->ctxt;
+  RestorationTileLimits limits;
+  sync_read_fn_t on_sync_read;
+  sync_write_fn_t on_sync_write;
+  limits.v_start = cur_job_info->v_start;
+  limits.v_end = cur_job_info->v_end;
+  const int lr_unit_row = cur_job_info->lr_unit_row;
+  const int plane = cur_job_info->plane;
+  const int plane_w = ctxt[plane].plane_w;
+
+  // sync_mode == 1 implies only sync read is required in LR Multi-threading
+  // sync_mode == 0 implies only sync write is required.
+  on_sync_read =
+      cur_job_info->sync_mode == 1 ? lr_sync_read : av1_lr_sync_read_dummy;
+  on_sync_write =
+      cur_job_info->sync_mode == 0 ? lr_sync_write : av1_lr_sync_write_dummy;
+
+  av1_foreach_rest_unit_in_row(
+      &limits, plane_w, lr_ctxt->on_rest_unit, lr_unit_row,
+      ctxt[plane].rsi->restoration_unit_size, ctxt[plane].rsi->horz_units,
+      ctxt[plane].rsi->vert_units, plane, &ctxt[plane], rst_tmpbuf, rlbs,
+      on_sync_read, on_sync_write, lr_sync, error_info);
+
+  copy_funs[plane](lr_ctxt->dst, lr_ctxt->frame, 0, plane_w,
+                   cur_job_info->v_copy_start, cur_job_info->v_copy_end);
+
+  if (do_extend_border) {
+    aom_extend_frame_borders_plane_row(lr_ctxt->frame, plane,
+                                       cur_job_info->v_copy_start,
+                                       cur_job_info->v_copy_end);
+  }
+}
+
 // Implement row loop restoration for each thread.
 static int loop_restoration_row_worker(void *arg1, void *arg2) {
   AV1LrSync *const lr_sync = (AV1LrSync *)arg1;
   LRWorkerData *lrworkerdata = (LRWorkerData *)arg2;
   AV1LrStruct *lr_ctxt = (AV1LrStruct *)lrworkerdata->lr_ctxt;
-  FilterFrameCtxt *ctxt = lr_ctxt->ctxt;
-  int lr_unit_row;
-  int plane;
-  int plane_w;
 #if CONFIG_MULTITHREAD
   pthread_mutex_t *job_mutex_ = lr_sync->job_mutex;
 #endif
@@ -841,51 +782,11 @@ static int loop_restoration_row_worker(void *arg1, void *arg2) {
   }
   error_info->setjmp = 1;
 
-  typedef void (*copy_fun)(const YV12_BUFFER_CONFIG *src_ybc,
-                           YV12_BUFFER_CONFIG *dst_ybc, int hstart, int hend,
-                           int vstart, int vend);
-  static const copy_fun copy_funs[MAX_MB_PLANE] = {
-    aom_yv12_partial_coloc_copy_y, aom_yv12_partial_coloc_copy_u,
-    aom_yv12_partial_coloc_copy_v
-  };
-
-  while (1) {
-    AV1LrMTInfo *cur_job_info = get_lr_job_info(lr_sync);
-    if (cur_job_info != NULL) {
-      RestorationTileLimits limits;
-      sync_read_fn_t on_sync_read;
-      sync_write_fn_t on_sync_write;
-      limits.v_start = cur_job_info->v_start;
-      limits.v_end = cur_job_info->v_end;
-      lr_unit_row = cur_job_info->lr_unit_row;
-      plane = cur_job_info->plane;
-      plane_w = ctxt[plane].plane_w;
-
-      // sync_mode == 1 implies only sync read is required in LR Multi-threading
-      // sync_mode == 0 implies only sync write is required.
-      on_sync_read =
-          cur_job_info->sync_mode == 1 ? lr_sync_read : av1_lr_sync_read_dummy;
-      on_sync_write = cur_job_info->sync_mode == 0 ? lr_sync_write
-                                                   : av1_lr_sync_write_dummy;
-
-      av1_foreach_rest_unit_in_row(
-          &limits, plane_w, lr_ctxt->on_rest_unit, lr_unit_row,
-          ctxt[plane].rsi->restoration_unit_size, ctxt[plane].rsi->horz_units,
-          ctxt[plane].rsi->vert_units, plane, &ctxt[plane],
-          lrworkerdata->rst_tmpbuf, lrworkerdata->rlbs, on_sync_read,
-          on_sync_write, lr_sync, error_info);
-
-      copy_funs[plane](lr_ctxt->dst, lr_ctxt->frame, 0, plane_w,
-                       cur_job_info->v_copy_start, cur_job_info->v_copy_end);
-
-      if (lrworkerdata->do_extend_border) {
-        aom_extend_frame_borders_plane_row(lr_ctxt->frame, plane,
-                                           cur_job_info->v_copy_start,
-                                           cur_job_info->v_copy_end);
-      }
-    } else {
-      break;
-    }
+  AV1LrMTInfo *cur_job_info;
+  while ((cur_job_info = get_lr_job_info(lr_sync)) != NULL) {
+    loop_restoration_row(lr_sync, lr_ctxt, cur_job_info,
+                         lrworkerdata->rst_tmpbuf, lrworkerdata->rlbs,
+                         lrworkerdata->do_extend_border, error_info);
   }
   error_info->setjmp = 0;
   return 1;
@@ -914,15 +815,13 @@ static inline void sync_lr_workers(AVxWorker *const workers,
   if (had_error) aom_internal_error_copy(cm->error, &error_info);
 }
 
-static void foreach_rest_unit_in_planes_mt(AV1LrStruct *lr_ctxt,
-                                           AVxWorker *workers, int num_workers,
-                                           AV1LrSync *lr_sync, AV1_COMMON *cm,
-                                           int do_extend_border) {
+// Allocates lr_sync if needed, resets it and fills its job queue.
+static void loop_restoration_mt_init(AV1LrStruct *lr_ctxt, int num_workers,
+                                     AV1LrSync *lr_sync, AV1_COMMON *cm) {
   FilterFrameCtxt *ctxt = lr_ctxt->ctxt;
 
   const int num_planes = av1_num_planes(cm);
 
-  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
   int num_rows_lr = 0;
 
   for (int plane = 0; plane < num_planes; plane++) {
@@ -947,14 +846,22 @@ static void foreach_rest_unit_in_planes_mt(AV1LrStruct *lr_ctxt,
 
   // Initialize cur_sb_col to -1 for all SB rows.
   for (i = 0; i < num_planes; i++) {
-    memset(lr_sync->cur_sb_col[i], -1,
-           sizeof(*(lr_sync->cur_sb_col[i])) * num_rows_lr);
+    aom_progress_reset_array(lr_sync->cur_sb_col[i], num_rows_lr, -1);
   }
 
   enqueue_lr_jobs(lr_sync, lr_ctxt, cm);
+}
+
+static void foreach_rest_unit_in_planes_mt(AV1LrStruct *lr_ctxt,
+                                           AVxWorker *workers, int num_workers,
+                                           AV1LrSync *lr_sync, AV1_COMMON *cm,
+                                           int do_extend_border) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+
+  loop_restoration_mt_init(lr_ctxt, num_workers, lr_sync, cm);
 
   // Set up looprestoration thread data.
-  for (i = num_workers - 1; i >= 0; --i) {
+  for (int i = num_workers - 1; i >= 0; --i) {
     AVxWorker *const worker = &workers[i];
     lr_sync->lrworkerdata[i].lr_ctxt = (void *)lr_ctxt;
     lr_sync->lrworkerdata[i].do_extend_border = do_extend_border;
@@ -986,7 +893,8 @@ void av1_loop_restoration_filter_frame_mt(YV12_BUFFER_CONFIG *frame,
   AV1LrStruct *loop_rest_ctxt = (AV1LrStruct *)lr_ctxt;
 
   av1_loop_restoration_filter_frame_init(loop_rest_ctxt, frame, cm,
-                                         optimized_lr, num_planes);
+                                         optimized_lr, num_planes,
+                                         /*do_extend_frame=*/1);
 
   foreach_rest_unit_in_planes_mt(loop_rest_ctxt, workers, num_workers, lr_sync,
                                  cm, do_extend_border);
@@ -1236,6 +1144,11 @@ void av1_cdef_frame_mt(AV1_COMMON *const cm, MACROBLOCKD *const xd,
                        num_planes);
 
   reset_cdef_job_info(cdef_sync);
+  // Rows are marked as done when their line buffers are copied, or all at
+  // once by a worker that encounters an error.
+  const int nvfb = (cm->mi_params.mi_rows + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
+  for (int fbr = 0; fbr < nvfb; fbr++)
+    aom_progress_reset(&cdef_sync->cdef_row_mt[fbr].is_row_done, 0);
   prepare_cdef_frame_workers(cm, xd, cdef_worker, cdef_sb_row_worker_hook,
                              workers, cdef_sync, num_workers,
                              cdef_init_fb_row_fn, do_extend_border);
@@ -1253,3 +1166,480 @@ int av1_get_intrabc_extra_top_right_sb_delay(const AV1_COMMON *cm) {
   // additional superblock delay when the intraBC tool is enabled.
   return cm->seq_params->sb_size == BLOCK_128X128 ? 2 : 4;
 }
+
+// Deallocate the in-loop filter pipeline synchronization data.
+void av1_filter_pipeline_dealloc(AV1FilterPipelineSync *pipeline_sync) {
+  if (pipeline_sync == NULL) return;
+#if CONFIG_MULTITHREAD
+  if (pipeline_sync->job_mutex != NULL) {
+    pthread_mutex_destroy(pipeline_sync->job_mutex);
+    aom_free(pipeline_sync->job_mutex);
+  }
+#endif  // CONFIG_MULTITHREAD
+  aom_free(pipeline_sync->job_queue);
+  for (int plane = 0; plane < MAX_MB_PLANE; plane++) {
+    aom_progress_free_array(&pipeline_sync->lf_row_done[plane],
+                            pipeline_sync->lf_rows);
+  }
+  aom_progress_free_array(&pipeline_sync->fb_row_done, pipeline_sync->fb_rows);
+  aom_free(pipeline_sync->workerdata);
+  av1_zero(*pipeline_sync);
+}
+
+static void filter_pipeline_alloc(AV1FilterPipelineSync *pipeline_sync,
+                                  AV1_COMMON *cm, int num_workers, int lf_rows,
+                                  int fb_rows, int num_jobs) {
+#if CONFIG_MULTITHREAD
+  CHECK_MEM_ERROR(cm, pipeline_sync->job_mutex,
+                  aom_malloc(sizeof(*(pipeline_sync->job_mutex))));
+  if (pipeline_sync->job_mutex) {
+    pthread_mutex_init(pipeline_sync->job_mutex, NULL);
+  }
+#endif  // CONFIG_MULTITHREAD
+  CHECK_MEM_ERROR(
+      cm, pipeline_sync->job_queue,
+      aom_malloc(sizeof(*(pipeline_sync->job_queue)) * num_jobs));
+  pipeline_sync->jobs_allocated = num_jobs;
+
+  pipeline_sync->lf_rows = lf_rows;
+  for (int plane = 0; plane < MAX_MB_PLANE; plane++) {
+    if (!aom_progress_alloc_array(&pipeline_sync->lf_row_done[plane], lf_rows,
+                                  0)) {
+      aom_internal_error(cm->error, AOM_CODEC_MEM_ERROR,
+                         "Failed to allocate pipeline_sync->lf_row_done");
+    }
+  }
+  pipeline_sync->fb_rows = fb_rows;
+  if (!aom_progress_alloc_array(&pipeline_sync->fb_row_done, fb_rows, 0)) {
+    aom_internal_error(cm->error, AOM_CODEC_MEM_ERROR,
+                       "Failed to allocate pipeline_sync->fb_row_done");
+  }
+
+  CHECK_MEM_ERROR(
+      cm, pipeline_sync->workerdata,
+      aom_calloc(num_workers, sizeof(*(pipeline_sync->workerdata))));
+  pipeline_sync->num_workers = num_workers;
+}
+
+static inline int filter_pipeline_has_lf(
+    const AV1FilterPipelineSync *pipeline_sync) {
+  return pipeline_sync->planes_to_lf[0] || pipeline_sync->planes_to_lf[1] ||
+         pipeline_sync->planes_to_lf[2];
+}
+
+// Returns the last superblock row whose deblocking must be complete before
+// CDEF can process the given filter block row. CDEF reads CDEF_VBORDER rows
+// below the filter block row, and the deblocking of the horizontal edges of
+// a superblock row reads and modifies up to 7 rows above it.
+static int fb_row_last_lf_row(int fbr, int lf_rows) {
+  const int last_row = (fbr + 1) * MI_SIZE_64X64 * MI_SIZE + CDEF_VBORDER + 6;
+  return AOMMIN(last_row >> (MAX_MIB_SIZE_LOG2 + MI_SIZE_LOG2), lf_rows - 1);
+}
+
+// Returns the last filter block row whose CDEF output must be complete before
+// the given row of restoration units is filtered. The filter reads
+// RESTORATION_BORDER rows below the units, and odd rows also copy back that
+// many rows of the unit row below.
+static int lr_job_last_fb_row(const AV1LrMTInfo *lr_job,
+                              const FilterFrameCtxt *ctxt, int fb_rows) {
+  const int last_row =
+      AOMMIN(lr_job->v_end + RESTORATION_BORDER, ctxt->plane_h) - 1;
+  const int fbr = (last_row << ctxt->ss_y) / (MI_SIZE_64X64 * MI_SIZE);
+  return AOMMIN(fbr, fb_rows - 1);
+}
+
+// Restoration unit rows are filtered in the order 0, 2, 1, 4, 3, ..., so that
+// an odd row is queued right after the two even rows it depends on.
+static int lr_row_in_pipeline_order(int pos, int num_rows) {
+  if (pos == 0) return 0;
+  if (pos & 1) {
+    const int row = pos + 1;
+    return row < num_rows ? row : row - 1;
+  }
+  return pos - 1;
+}
+
+// Fills the job queue in an order where each job only depends on the jobs
+// before it: the deblocking of each superblock row is followed by the filter
+// block rows it completes, which are followed by the restoration unit rows
+// they complete.
+static void enqueue_filter_pipeline_jobs(AV1FilterPipelineSync *pipeline_sync) {
+  const AV1LrStruct *const lr_ctxt = (AV1LrStruct *)pipeline_sync->lr_ctxt;
+  const int fb_rows = pipeline_sync->fb_rows;
+  AV1FilterJob *const job_queue = pipeline_sync->job_queue;
+  int num_jobs = 0;
+
+  // The LR jobs of each plane. enqueue_lr_jobs() stores the even rows of a
+  // plane contiguously, followed by the odd rows of all planes.
+  const AV1LrMTInfo *lr_even_rows[MAX_MB_PLANE] = { NULL, NULL, NULL };
+  const AV1LrMTInfo *lr_odd_rows[MAX_MB_PLANE] = { NULL, NULL, NULL };
+  int lr_rows[MAX_MB_PLANE] = { 0, 0, 0 };
+  int lr_next[MAX_MB_PLANE] = { 0, 0, 0 };
+  int lr_last_fbr[MAX_MB_PLANE] = { 0, 0, 0 };
+  if (pipeline_sync->do_loop_restoration) {
+    const AV1LrSync *const lr_sync = pipeline_sync->lr_sync;
+    for (int i = 0; i < lr_sync->jobs_enqueued; i++) {
+      const AV1LrMTInfo *const lr_job = &lr_sync->job_queue[i];
+      const int plane = lr_job->plane;
+      if (lr_job->lr_unit_row == 0) lr_even_rows[plane] = lr_job;
+      if (lr_job->lr_unit_row == 1) lr_odd_rows[plane] = lr_job;
+      lr_rows[plane] = AOMMAX(lr_rows[plane], lr_job->lr_unit_row + 1);
+    }
+  }
+
+  int next_fbr = 0;
+  for (int lf_row = 0; lf_row < pipeline_sync->lf_rows; lf_row++) {
+    for (int dir = 0; dir < 2; dir++) {
+      for (int plane = 0; plane < MAX_MB_PLANE; plane++) {
+        if (!pipeline_sync->planes_to_lf[plane]) continue;
+        AV1FilterJob *const job = &job_queue[num_jobs++];
+        job->type = FILTER_JOB_LF;
+        job->lf.mi_row = lf_row << MAX_MIB_SIZE_LOG2;
+        job->lf.plane = plane;
+        job->lf.dir = dir;
+        job->lf.lpf_opt_level = 0;
+      }
+    }
+
+    while (next_fbr < fb_rows &&
+           fb_row_last_lf_row(next_fbr, pipeline_sync->lf_rows) <= lf_row) {
+      AV1FilterJob *const job = &job_queue[num_jobs++];
+      job->type = FILTER_JOB_CDEF;
+      job->fbr = next_fbr;
+
+      for (int plane = 0; plane < MAX_MB_PLANE; plane++) {
+        while (lr_next[plane] < lr_rows[plane]) {
+          const int row =
+              lr_row_in_pipeline_order(lr_next[plane], lr_rows[plane]);
+          const AV1LrMTInfo *const lr_job =
+              (row & 1) ? &lr_odd_rows[plane][row >> 1]
+                        : &lr_even_rows[plane][row >> 1];
+          assert(lr_job->lr_unit_row == row && lr_job->plane == plane);
+          const int last_fbr = AOMMAX(
+              lr_last_fbr[plane],
+              lr_job_last_fb_row(lr_job, &lr_ctxt->ctxt[plane], fb_rows));
+          if (last_fbr > next_fbr) break;
+          lr_last_fbr[plane] = last_fbr;
+          AV1FilterJob *const lr_filter_job = &job_queue[num_jobs++];
+          lr_filter_job->type = FILTER_JOB_LR;
+          lr_filter_job->lr = *lr_job;
+          lr_filter_job->fbr = last_fbr;
+          lr_next[plane]++;
+        }
+      }
+      next_fbr++;
+    }
+  }
+  assert(next_fbr == fb_rows);
+  assert(num_jobs <= pipeline_sync->jobs_allocated);
+  pipeline_sync->jobs_enqueued = num_jobs;
+  pipeline_sync->jobs_dequeued = 0;
+}
+
+static AV1FilterJob *get_filter_job(AV1FilterPipelineSync *pipeline_sync) {
+  AV1FilterJob *cur_job = NULL;
+
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(pipeline_sync->job_mutex);
+
+  if (!pipeline_sync->mt_exit &&
+      pipeline_sync->jobs_dequeued < pipeline_sync->jobs_enqueued) {
+    cur_job = pipeline_sync->job_queue + pipeline_sync->jobs_dequeued;
+    pipeline_sync->jobs_dequeued++;
+  }
+
+  pthread_mutex_unlock(pipeline_sync->job_mutex);
+#else
+  (void)pipeline_sync;
+#endif
+
+  return cur_job;
+}
+
+// Called by a worker that encountered an error: aborts the processing of the
+// other workers and marks every row of every stage as done, so that no worker
+// waits indefinitely on a job that will not run.
+static void set_filter_pipeline_done(AV1FilterPipelineSync *pipeline_sync) {
+  AV1_COMMON *const cm = pipeline_sync->cm;
+  const int has_lf = filter_pipeline_has_lf(pipeline_sync);
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(pipeline_sync->job_mutex);
+  pipeline_sync->mt_exit = true;
+  pthread_mutex_unlock(pipeline_sync->job_mutex);
+  if (has_lf) {
+    pthread_mutex_lock(pipeline_sync->lf_sync->job_mutex);
+    pipeline_sync->lf_sync->lf_mt_exit = true;
+    pthread_mutex_unlock(pipeline_sync->lf_sync->job_mutex);
+  }
+  if (pipeline_sync->do_cdef) {
+    pthread_mutex_lock(pipeline_sync->cdef_sync->mutex_);
+    pipeline_sync->cdef_sync->cdef_mt_exit = true;
+    pthread_mutex_unlock(pipeline_sync->cdef_sync->mutex_);
+  }
+  if (pipeline_sync->do_loop_restoration) {
+    pthread_mutex_lock(pipeline_sync->lr_sync->job_mutex);
+    pipeline_sync->lr_sync->lr_mt_exit = true;
+    pthread_mutex_unlock(pipeline_sync->lr_sync->job_mutex);
+  }
+#endif  // CONFIG_MULTITHREAD
+
+  if (has_lf) {
+    av1_set_vert_loop_filter_done(cm, pipeline_sync->lf_sync,
+                                  MAX_MIB_SIZE_LOG2);
+  }
+  for (int plane = 0; plane < MAX_MB_PLANE; plane++) {
+    for (int row = 0; row < pipeline_sync->lf_rows; row++)
+      aom_progress_set(&pipeline_sync->lf_row_done[plane][row], 1);
+  }
+  if (pipeline_sync->do_cdef) {
+    set_cdef_init_fb_row_done(pipeline_sync->cdef_sync, pipeline_sync->fb_rows);
+  }
+  for (int fbr = 0; fbr < pipeline_sync->fb_rows; fbr++)
+    aom_progress_set(&pipeline_sync->fb_row_done[fbr], 1);
+  if (pipeline_sync->do_loop_restoration) {
+    AV1LrStruct *const lr_ctxt = (AV1LrStruct *)pipeline_sync->lr_ctxt;
+    set_loop_restoration_done(pipeline_sync->lr_sync, lr_ctxt->ctxt);
+  }
+}
+
+// Applies CDEF to a filter block row and prepares its rows for loop
+// restoration.
+static void filter_pipeline_fb_row(AV1FilterPipelineSync *pipeline_sync,
+                                   AV1FilterPipelineWorkerData *worker_data,
+                                   int fbr) {
+  AV1_COMMON *const cm = pipeline_sync->cm;
+  const YV12_BUFFER_CONFIG *const frame = pipeline_sync->frame;
+  AV1LrStruct *const lr_ctxt = (AV1LrStruct *)pipeline_sync->lr_ctxt;
+  const int num_planes = av1_num_planes(cm);
+  const int last_lf_row = fb_row_last_lf_row(fbr, pipeline_sync->lf_rows);
+
+  for (int plane = 0; plane < MAX_MB_PLANE; plane++) {
+    if (!pipeline_sync->planes_to_lf[plane]) continue;
+    for (int row = 0; row <= last_lf_row; row++)
+      aom_progress_wait(&pipeline_sync->lf_row_done[plane][row], 1);
+  }
+
+  // Rows of the filter block row in each plane.
+  int row_start[MAX_MB_PLANE], row_end[MAX_MB_PLANE];
+  for (int plane = 0; plane < num_planes; plane++) {
+    const int ss_y = plane > 0 && cm->seq_params->subsampling_y;
+    const int plane_h = frame->crop_heights[plane > 0];
+    row_start[plane] = (fbr * MI_SIZE_64X64 * MI_SIZE) >> ss_y;
+    row_end[plane] =
+        AOMMIN(((fbr + 1) * MI_SIZE_64X64 * MI_SIZE) >> ss_y, plane_h);
+    if (fbr == pipeline_sync->fb_rows - 1) row_end[plane] = plane_h;
+  }
+
+  const int save_boundary_lines =
+      pipeline_sync->do_loop_restoration && pipeline_sync->do_cdef;
+  if (save_boundary_lines) {
+    for (int plane = 0; plane < num_planes; plane++) {
+      if (cm->rst_info[plane].frame_restoration_type == RESTORE_NONE) continue;
+      av1_loop_restoration_save_plane_boundary_lines(
+          frame, cm, plane, 0, row_start[plane], row_end[plane]);
+    }
+  }
+
+  if (pipeline_sync->do_cdef) {
+    AV1CdefWorkerData *const cdef_data = worker_data->cdef_data;
+    av1_cdef_fb_row(cm, pipeline_sync->xd, cdef_data->linebuf,
+                    cdef_data->colbuf, cdef_data->srcbuf, fbr,
+                    av1_cdef_init_fb_row_mt, pipeline_sync->cdef_sync,
+                    &worker_data->error_info);
+  }
+
+  if (pipeline_sync->do_loop_restoration) {
+    for (int plane = 0; plane < num_planes; plane++) {
+      if (cm->rst_info[plane].frame_restoration_type == RESTORE_NONE) continue;
+      const FilterFrameCtxt *const ctxt = &lr_ctxt->ctxt[plane];
+      if (save_boundary_lines) {
+        av1_loop_restoration_save_plane_boundary_lines(
+            frame, cm, plane, 1, row_start[plane], row_end[plane]);
+      }
+      av1_extend_frame_rows(ctxt->data8, ctxt->plane_w, ctxt->plane_h,
+                            ctxt->data_stride, RESTORATION_BORDER,
+                            RESTORATION_BORDER, ctxt->highbd, row_start[plane],
+                            row_end[plane]);
+    }
+  }
+
+  aom_progress_set(&pipeline_sync->fb_row_done[fbr], 1);
+}
+
+// Hook function for each thread in the in-loop filter pipeline.
+static int filter_pipeline_worker(void *arg1, void *arg2) {
+  AV1FilterPipelineSync *const pipeline_sync = (AV1FilterPipelineSync *)arg1;
+  AV1FilterPipelineWorkerData *const worker_data =
+      (AV1FilterPipelineWorkerData *)arg2;
+  struct aom_internal_error_info *const error_info = &worker_data->error_info;
+
+  // The jmp_buf is valid only for the duration of the function that calls
+  // setjmp(). Therefore, this function must reset the 'setjmp' field to 0
+  // before it returns.
+  if (setjmp(error_info->jmp)) {
+    error_info->setjmp = 0;
+    set_filter_pipeline_done(pipeline_sync);
+    return 0;
+  }
+  error_info->setjmp = 1;
+
+  AV1FilterJob *cur_job;
+  while ((cur_job = get_filter_job(pipeline_sync)) != NULL) {
+    switch (cur_job->type) {
+      case FILTER_JOB_LF: {
+        LFWorkerData *const lf_data = worker_data->lf_data;
+        av1_thread_loop_filter_rows(
+            lf_data->frame_buffer, lf_data->cm, lf_data->planes, lf_data->xd,
+            cur_job->lf.mi_row, cur_job->lf.plane, cur_job->lf.dir,
+            cur_job->lf.lpf_opt_level, pipeline_sync->lf_sync, error_info,
+            lf_data->params_buf, lf_data->tx_buf, MAX_MIB_SIZE_LOG2);
+        if (cur_job->lf.dir == 1) {
+          const int row = cur_job->lf.mi_row >> MAX_MIB_SIZE_LOG2;
+          aom_progress_set(
+              &pipeline_sync->lf_row_done[cur_job->lf.plane][row], 1);
+        }
+        break;
+      }
+      case FILTER_JOB_CDEF:
+        filter_pipeline_fb_row(pipeline_sync, worker_data, cur_job->fbr);
+        break;
+      case FILTER_JOB_LR: {
+        for (int fbr = 0; fbr <= cur_job->fbr; fbr++)
+          aom_progress_wait(&pipeline_sync->fb_row_done[fbr], 1);
+        LRWorkerData *const lr_data = worker_data->lr_data;
+        loop_restoration_row(pipeline_sync->lr_sync,
+                             (AV1LrStruct *)pipeline_sync->lr_ctxt,
+                             &cur_job->lr, lr_data->rst_tmpbuf, lr_data->rlbs,
+                             /*do_extend_border=*/0, error_info);
+        break;
+      }
+      default: assert(0);
+    }
+  }
+  error_info->setjmp = 0;
+  return 1;
+}
+
+static inline void sync_filter_pipeline_workers(AVxWorker *const workers,
+                                                AV1_COMMON *const cm,
+                                                int num_workers) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  int had_error = workers[0].had_error;
+  struct aom_internal_error_info error_info;
+
+  // Read the error_info of main thread.
+  if (had_error) {
+    AVxWorker *const worker = &workers[0];
+    error_info = ((AV1FilterPipelineWorkerData *)worker->data2)->error_info;
+  }
+
+  // Wait till all rows are finished.
+  for (int i = num_workers - 1; i > 0; --i) {
+    AVxWorker *const worker = &workers[i];
+    if (!winterface->sync(worker)) {
+      had_error = 1;
+      error_info = ((AV1FilterPipelineWorkerData *)worker->data2)->error_info;
+    }
+  }
+  if (had_error) aom_internal_error_copy(cm->error, &error_info);
+}
+
+void av1_filter_frame_pipeline_mt(
+    YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm, MACROBLOCKD *xd,
+    AVxWorker *workers, int num_workers, AV1LfSync *lf_sync,
+    AV1CdefWorkerData *cdef_worker, AV1CdefSync *cdef_sync, AV1LrSync *lr_sync,
+    void *lr_ctxt, AV1FilterPipelineSync *pipeline_sync, int do_cdef,
+    int do_loop_restoration) {
+  assert(!av1_superres_scaled(cm));
+  assert(frame == &cm->cur_frame->buf);
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  const int num_planes = av1_num_planes(cm);
+  const int mi_rows = cm->mi_params.mi_rows;
+  const int lf_rows = CEIL_POWER_OF_TWO(mi_rows, MAX_MIB_SIZE_LOG2);
+  const int fb_rows = (mi_rows + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
+
+  int planes_to_lf[MAX_MB_PLANE];
+  if (check_planes_to_loop_filter(&cm->lf, planes_to_lf, 0, num_planes)) {
+    av1_loop_filter_frame_init(cm, 0, num_planes);
+    loop_filter_frame_mt_init(cm, 0, mi_rows, planes_to_lf, num_workers,
+                              lf_sync, 0, MAX_MIB_SIZE_LOG2);
+  } else {
+    av1_zero(planes_to_lf);
+  }
+
+  if (do_cdef) {
+    av1_setup_dst_planes(xd->plane, cm->seq_params->sb_size, frame, 0, 0, 0,
+                         num_planes);
+    reset_cdef_job_info(cdef_sync);
+    for (int fbr = 0; fbr < fb_rows; fbr++)
+      aom_progress_reset(&cdef_sync->cdef_row_mt[fbr].is_row_done, 0);
+    prepare_cdef_frame_workers(cm, xd, cdef_worker, filter_pipeline_worker,
+                               workers, cdef_sync, num_workers,
+                               av1_cdef_init_fb_row_mt,
+                               /*do_extend_border=*/0);
+  }
+
+  // The borders are extended row by row, once each filter block row is done.
+  if (do_loop_restoration) {
+    av1_loop_restoration_filter_frame_init((AV1LrStruct *)lr_ctxt, frame, cm,
+                                           /*optimized_lr=*/!do_cdef,
+                                           num_planes,
+                                           /*do_extend_frame=*/0);
+    loop_restoration_mt_init((AV1LrStruct *)lr_ctxt, num_workers, lr_sync, cm);
+  }
+
+  const int num_jobs = lf_rows * MAX_MB_PLANE * 2 + fb_rows +
+                       (do_loop_restoration ? lr_sync->jobs_enqueued : 0);
+  if (pipeline_sync->job_queue == NULL ||
+      num_jobs > pipeline_sync->jobs_allocated ||
+      lf_rows != pipeline_sync->lf_rows || fb_rows != pipeline_sync->fb_rows ||
+      num_workers > pipeline_sync->num_workers) {
+    av1_filter_pipeline_dealloc(pipeline_sync);
+    filter_pipeline_alloc(pipeline_sync, cm, num_workers, lf_rows, fb_rows,
+                          num_jobs);
+  }
+  for (int plane = 0; plane < MAX_MB_PLANE; plane++) {
+    aom_progress_reset_array(pipeline_sync->lf_row_done[plane], lf_rows, 0);
+  }
+  aom_progress_reset_array(pipeline_sync->fb_row_done, fb_rows, 0);
+  pipeline_sync->mt_exit = false;
+
+  pipeline_sync->frame = frame;
+  pipeline_sync->cm = cm;
+  pipeline_sync->xd = xd;
+  pipeline_sync->lf_sync = lf_sync;
+  pipeline_sync->cdef_sync = cdef_sync;
+  pipeline_sync->lr_sync = lr_sync;
+  pipeline_sync->lr_ctxt = lr_ctxt;
+  memcpy(pipeline_sync->planes_to_lf, planes_to_lf, sizeof(planes_to_lf));
+  pipeline_sync->do_cdef = do_cdef;
+  pipeline_sync->do_loop_restoration = do_loop_restoration;
+
+  enqueue_filter_pipeline_jobs(pipeline_sync);
+
+  for (int i = num_workers - 1; i >= 0; --i) {
+    AVxWorker *const worker = &workers[i];
+    AV1FilterPipelineWorkerData *const worker_data =
+        &pipeline_sync->workerdata[i];
+    worker_data->lf_data = NULL;
+    if (filter_pipeline_has_lf(pipeline_sync)) {
+      worker_data->lf_data = &lf_sync->lfdata[i];
+      loop_filter_data_reset(worker_data->lf_data, frame, cm, xd);
+    }
+    worker_data->cdef_data = do_cdef ? &cdef_worker[i] : NULL;
+    worker_data->lr_data =
+        do_loop_restoration ? &lr_sync->lrworkerdata[i] : NULL;
+
+    worker->hook = filter_pipeline_worker;
+    worker->data1 = pipeline_sync;
+    worker->data2 = worker_data;
+    worker->had_error = 0;
+    if (i == 0) {
+      winterface->execute(worker);
+    } else {
+      winterface->launch(worker);
+    }
+  }
+
+  sync_filter_pipeline_workers(workers, cm, num_workers);
+}
@@ -16,6 +16,7 @@
 
 #include "av1/common/av1_loopfilter.h"
 #include "av1/common/cdef.h"
+#include "aom_util/aom_progress.h"
 #include "aom_util/aom_pthread.h"
 #include "aom_util/aom_thread.h"
 
@@ -34,12 +35,8 @@ typedef struct AV1LfMTInfo {
 
 // Loopfilter row synchronization
 typedef struct AV1LfSyncData {
-#if CONFIG_MULTITHREAD
-  pthread_mutex_t *mutex_[MAX_MB_PLANE];
-  pthread_cond_t *cond_[MAX_MB_PLANE];
-#endif
   // Allocate memory to store the loop-filtered superblock index in each row.
-  int *cur_sb_col[MAX_MB_PLANE];
+  AVxProgress *cur_sb_col[MAX_MB_PLANE];
   // The optimal sync_range for different resolution and platform should be
   // determined by testing. Currently, it is chosen to be a power-of-2 number.
   int sync_range;
@@ -81,12 +78,8 @@ typedef struct LoopRestorationWorkerData {
 
 // Looprestoration row synchronization
 typedef struct AV1LrSyncData {
-#if CONFIG_MULTITHREAD
-  pthread_mutex_t *mutex_[MAX_MB_PLANE];
-  pthread_cond_t *cond_[MAX_MB_PLANE];
-#endif
   // Allocate memory to store the loop-restoration block index in each row.
-  int *cur_sb_col[MAX_MB_PLANE];
+  AVxProgress *cur_sb_col[MAX_MB_PLANE];
   // The optimal sync_range for different resolution and platform should be
   // determined by testing. Currently, it is chosen to be a power-of-2 number.
   int sync_range;
@@ -121,11 +114,8 @@ typedef struct AV1CdefWorker {
 } AV1CdefWorkerData;
 
 typedef struct AV1CdefRowSync {
-#if CONFIG_MULTITHREAD
-  pthread_mutex_t *row_mutex_;
-  pthread_cond_t *row_cond_;
-#endif  // CONFIG_MULTITHREAD
-  int is_row_done;
+  // Set to 1 once the line buffers of the row have been copied.
+  AVxProgress is_row_done;
 } AV1CdefRowSync;
 
 // Data related to CDEF search multi-thread synchronization.
@@ -147,6 +137,82 @@ typedef struct AV1CdefSyncData {
   bool cdef_mt_exit;
 } AV1CdefSync;
 
+// Jobs of the fused in-loop filter pipeline.
+typedef enum {
+  // Deblocking of one plane of a superblock row, in one direction.
+  FILTER_JOB_LF,
+  // CDEF of a 64x64 filter block row, followed by the loop restoration
+  // preparation of its rows: boundary line saving and border extension. The
+  // job runs even when CDEF is disabled.
+  FILTER_JOB_CDEF,
+  // Loop restoration of one row of restoration units of a plane.
+  FILTER_JOB_LR,
+} FilterJobType;
+
+typedef struct AV1FilterJob {
+  FilterJobType type;
+  // Valid for FILTER_JOB_LF.
+  AV1LfMTInfo lf;
+  // Valid for FILTER_JOB_LR.
+  AV1LrMTInfo lr;
+  // The filter block row processed by a FILTER_JOB_CDEF job, or the last
+  // filter block row a FILTER_JOB_LR job depends on.
+  int fbr;
+} AV1FilterJob;
+
+typedef struct AV1FilterPipelineWorkerData {
+  LFWorkerData *lf_data;
+  AV1CdefWorkerData *cdef_data;
+  LRWorkerData *lr_data;
+  struct aom_internal_error_info error_info;
+} AV1FilterPipelineWorkerData;
+
+// Synchronization of the fused in-loop filter pipeline, in which each filter
+// block row goes through deblocking, CDEF and loop restoration as soon as the
+// rows it depends on are ready, instead of filtering the whole frame once per
+// stage.
+//
+// The jobs of all the stages are dispatched from a single queue, sorted so
+// that a job only depends on jobs queued before it. The dependencies between
+// stages are tracked with the progress counters below; the ones within a
+// stage use the syncs of the stage.
+typedef struct AV1FilterPipelineSyncData {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t *job_mutex;
+#endif  // CONFIG_MULTITHREAD
+  AV1FilterJob *job_queue;
+  int jobs_allocated;
+  int jobs_enqueued;
+  int jobs_dequeued;
+
+  // Set to 1 once the horizontal deblocking of a superblock row is done, per
+  // plane.
+  AVxProgress *lf_row_done[MAX_MB_PLANE];
+  int lf_rows;
+  // Set to 1 once a filter block row is ready for loop restoration.
+  AVxProgress *fb_row_done;
+  int fb_rows;
+
+  AV1FilterPipelineWorkerData *workerdata;
+  int num_workers;
+
+  // Frame level data, set up before the workers are launched.
+  YV12_BUFFER_CONFIG *frame;
+  AV1_COMMON *cm;
+  MACROBLOCKD *xd;
+  AV1LfSync *lf_sync;
+  AV1CdefSync *cdef_sync;
+  AV1LrSync *lr_sync;
+  void *lr_ctxt;
+  int planes_to_lf[MAX_MB_PLANE];
+  int do_cdef;
+  int do_loop_restoration;
+
+  // Initialized to false, set to true by the worker thread that encounters an
+  // error in order to abort the processing of other worker threads.
+  bool mt_exit;
+} AV1FilterPipelineSync;
+
 void av1_cdef_frame_mt(AV1_COMMON *const cm, MACROBLOCKD *const xd,
                        AV1CdefWorkerData *const cdef_worker,
                        AVxWorker *const workers, AV1CdefSync *const cdef_sync,
@@ -199,6 +265,18 @@ void av1_loop_restoration_alloc(AV1LrSync *lr_sync, AV1_COMMON *cm,
                                 int num_planes, int width);
 int av1_get_intrabc_extra_top_right_sb_delay(const AV1_COMMON *cm);
 
+void av1_filter_pipeline_dealloc(AV1FilterPipelineSync *pipeline_sync);
+
+// Applies deblocking, CDEF and loop restoration to the frame with row
+// pipelining across the stages. Superres is not supported: the frame must be
+// coded at its upscaled resolution.
+void av1_filter_frame_pipeline_mt(
+    YV12_BUFFER_CONFIG *frame, struct AV1Common *cm, struct macroblockd *xd,
+    AVxWorker *workers, int num_workers, AV1LfSync *lf_sync,
+    AV1CdefWorkerData *cdef_worker, AV1CdefSync *cdef_sync, AV1LrSync *lr_sync,
+    void *lr_ctxt, AV1FilterPipelineSync *pipeline_sync, int do_cdef,
+    int do_loop_restoration);
+
 void av1_thread_loop_filter_rows(
     const YV12_BUFFER_CONFIG *const frame_buffer, AV1_COMMON *const cm,
     struct macroblockd_plane *planes, MACROBLOCKD *xd, int mi_row, int plane,
@@ -276,8 +354,7 @@ static inline void loop_filter_frame_mt_init(
 
   // Initialize cur_sb_col to -1 for all SB rows.
   for (int i = 0; i < MAX_MB_PLANE; i++) {
-    memset(lf_sync->cur_sb_col[i], -1,
-           sizeof(*(lf_sync->cur_sb_col[i])) * sb_rows);
+    aom_progress_reset_array(lf_sync->cur_sb_col[i], sb_rows, -1);
   }
 
   enqueue_lf_jobs(lf_sync, start_mi_row, end_mi_row, planes_to_lf,
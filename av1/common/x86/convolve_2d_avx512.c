@@ -0,0 +1,347 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <assert.h>
+#include <immintrin.h>  // AVX512
+
+#include "config/av1_rtcd.h"
+
+#include "aom_dsp/aom_dsp_common.h"
+#include "aom_dsp/aom_filter.h"
+#include "aom_ports/mem.h"
+#include "av1/common/convolve.h"
+#include "av1/common/filter.h"
+
+// The kernels below filter 32 pixels of a row at a time. Blocks narrower than
+// 32 pixels and 12-tap filters are handled by the AVX2 versions.
+
+// Byte pairs (i, i + 1), (i + 2, i + 3), ... selected from the 16 source bytes
+// of each 128-bit lane for the 8 output pixels of the lane.
+DECLARE_ALIGNED(64, static const uint8_t, filt_global_avx512[4][16]) = {
+  { 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8 },
+  { 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10 },
+  { 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12 },
+  { 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13, 14 },
+};
+
+// Returns the number of tap pairs, between 2 and 4, covering the non-zero taps
+// of an 8-tap kernel. The pairs are centered, i.e. they start at tap
+// 4 - num_pairs.
+static AOM_FORCE_INLINE int get_num_tap_pairs(
+    const InterpFilterParams *filter_params, int subpel_qn) {
+  const int16_t *const filter = av1_get_interp_filter_subpel_kernel(
+      filter_params, subpel_qn & SUBPEL_MASK);
+  if (filter[0] | filter[7]) return 4;
+  if (filter[1] | filter[6]) return 3;
+  return 2;
+}
+
+// Horizontal pass shared by the 2D convolutions: filters 'im_h' rows of 'w'
+// pixels into 'im_block', which has a stride of 'w'. As in the AVX2 code the
+// taps, which are all even, are halved so that the products fit
+// _mm512_maddubs_epi16(), and the rounding shift is reduced by one to
+// compensate.
+static AOM_FORCE_INLINE void convolve_2d_horiz_avx512(
+    const uint8_t *src, int src_stride, int16_t *im_block, int w, int im_h,
+    const InterpFilterParams *filter_params_x, const int subpel_x_qn,
+    const int num_pairs, const ConvolveParams *conv_params) {
+  const int bd = 8;
+  const int16_t *x_filter = av1_get_interp_filter_subpel_kernel(
+      filter_params_x, subpel_x_qn & SUBPEL_MASK);
+  const int first_tap = 4 - num_pairs;
+  const __m512i round_const = _mm512_set1_epi16(
+      ((1 << (conv_params->round_0 - 1)) >> 1) + (1 << (bd + FILTER_BITS - 2)));
+  // Spreads 40 loaded bytes so that 128-bit lane i starts at byte 8 * i.
+  const __m512i lane_idx = _mm512_set_epi64(4, 3, 3, 2, 2, 1, 1, 0);
+  __m512i coeffs[4], filt[4];
+  for (int k = 0; k < num_pairs; ++k) {
+    const int t = first_tap + 2 * k;
+    assert(!(x_filter[t] & 1) && !(x_filter[t + 1] & 1));
+    coeffs[k] = _mm512_set1_epi16(
+        (short)((uint8_t)(x_filter[t] >> 1) | ((x_filter[t + 1] >> 1) << 8)));
+    filt[k] = _mm512_broadcast_i32x4(
+        _mm_load_si128((const __m128i *)filt_global_avx512[k]));
+  }
+  src -= SUBPEL_TAPS / 2 - 1 - first_tap;
+
+  for (int y = 0; y < im_h; ++y) {
+    for (int x = 0; x < w; x += 32) {
+      // Masked loads do not fault on the bytes that are not loaded.
+      const __m512i data = _mm512_permutexvar_epi64(
+          lane_idx, _mm512_maskz_loadu_epi8(0xffffffffffULL, src + x));
+      __m512i res = _mm512_maddubs_epi16(_mm512_shuffle_epi8(data, filt[0]),
+                                         coeffs[0]);
+      for (int k = 1; k < num_pairs; ++k) {
+        res = _mm512_add_epi16(
+            res, _mm512_maddubs_epi16(_mm512_shuffle_epi8(data, filt[k]),
+                                      coeffs[k]));
+      }
+      res = _mm512_srai_epi16(_mm512_add_epi16(res, round_const),
+                              conv_params->round_0 - 1);
+      _mm512_storeu_si512((void *)(im_block + x), res);
+    }
+    src += src_stride;
+    im_block += w;
+  }
+}
+
+// Applies the vertical taps to the interleaved row pairs 's' of 32 16-bit
+// values. 'lo' receives columns 0-3 and 'hi' columns 4-7 of each 128-bit lane.
+static AOM_FORCE_INLINE void convolve_vert_32(const __m512i *s_lo,
+                                              const __m512i *s_hi,
+                                              const __m512i *coeffs,
+                                              const int num_pairs,
+                                              const __m512i offset,
+                                              __m512i *lo, __m512i *hi) {
+  *lo = offset;
+  *hi = offset;
+  for (int k = 0; k < num_pairs; ++k) {
+    *lo = _mm512_add_epi32(*lo, _mm512_madd_epi16(s_lo[k], coeffs[k]));
+    *hi = _mm512_add_epi32(*hi, _mm512_madd_epi16(s_hi[k], coeffs[k]));
+  }
+}
+
+static AOM_FORCE_INLINE __m512i round_shift_epi32(const __m512i v, int bits) {
+  return _mm512_srai_epi32(
+      _mm512_add_epi32(v, _mm512_set1_epi32((1 << bits) >> 1)), bits);
+}
+
+// Packs the 32-bit results of a row and stores them as 32 clipped pixels.
+static AOM_FORCE_INLINE void store_pixels_32(uint8_t *dst, const __m512i lo,
+                                             const __m512i hi) {
+  const __m512i res =
+      _mm512_max_epi16(_mm512_packs_epi32(lo, hi), _mm512_setzero_si512());
+  _mm256_storeu_si256((__m256i *)dst, _mm512_cvtusepi16_epi8(res));
+}
+
+// Packs the 32-bit results of two rows and stores them as 2 rows of 32 clipped
+// pixels.
+static AOM_FORCE_INLINE void store_pixels_2x32(uint8_t *dst, int dst_stride,
+                                               const __m512i lo0,
+                                               const __m512i hi0,
+                                               const __m512i lo1,
+                                               const __m512i hi1) {
+  // Each 128-bit lane holds 8 pixels of row 0 followed by 8 pixels of row 1.
+  const __m512i res = _mm512_packus_epi16(_mm512_packs_epi32(lo0, hi0),
+                                          _mm512_packs_epi32(lo1, hi1));
+  const __m512i rows = _mm512_permutexvar_epi64(
+      _mm512_set_epi64(7, 5, 3, 1, 6, 4, 2, 0), res);
+  _mm256_storeu_si256((__m256i *)dst, _mm512_castsi512_si256(rows));
+  _mm256_storeu_si256((__m256i *)(dst + dst_stride),
+                      _mm512_extracti64x4_epi64(rows, 1));
+}
+
+// Stores one row of the compound prediction, averaged with the previous one if
+// requested.
+static AOM_FORCE_INLINE void store_compound_row_32(
+    uint8_t *dst, CONV_BUF_TYPE *dst16, __m512i lo, __m512i hi,
+    const ConvolveParams *conv_params, const __m512i sub, const int bits,
+    const __m512i avg_wt, const int avg_shift) {
+  lo = round_shift_epi32(lo, conv_params->round_1);
+  hi = round_shift_epi32(hi, conv_params->round_1);
+  const __m512i res = _mm512_packus_epi32(lo, hi);
+  if (!conv_params->do_average) {
+    _mm512_storeu_si512((void *)dst16, res);
+    return;
+  }
+  // The compound prediction and the new one are below 1 << 14, so the
+  // weighted sum of each pair can be computed by _mm512_madd_epi16().
+  const __m512i ref = _mm512_loadu_si512((const void *)dst16);
+  lo = _mm512_srai_epi32(
+      _mm512_madd_epi16(_mm512_unpacklo_epi16(ref, res), avg_wt), avg_shift);
+  hi = _mm512_srai_epi32(
+      _mm512_madd_epi16(_mm512_unpackhi_epi16(ref, res), avg_wt), avg_shift);
+  lo = _mm512_sub_epi32(lo, sub);
+  hi = _mm512_sub_epi32(hi, sub);
+  store_pixels_32(dst, round_shift_epi32(lo, bits),
+                  round_shift_epi32(hi, bits));
+}
+
+// Vertical pass over 'im_block', two rows at a time so that the interleaved
+// row pairs are reused by the following rows.
+static AOM_FORCE_INLINE void convolve_2d_vert_avx512(
+    const int16_t *im_block, int w, int h, uint8_t *dst, int dst_stride,
+    const InterpFilterParams *filter_params_y, const int subpel_y_qn,
+    const int num_pairs, const int is_compound,
+    const ConvolveParams *conv_params) {
+  const int bd = 8;
+  const int16_t *y_filter = av1_get_interp_filter_subpel_kernel(
+      filter_params_y, subpel_y_qn & SUBPEL_MASK);
+  const int first_tap = 4 - num_pairs;
+  const int offset_bits = bd + 2 * FILTER_BITS - conv_params->round_0;
+  const int bits =
+      2 * FILTER_BITS - conv_params->round_0 - conv_params->round_1;
+  // For av1_convolve_2d_sr 'bits' is 0, and the offset removed after the
+  // rounding by round_1 can be removed from the accumulator instead.
+  const __m512i offset = _mm512_set1_epi32(
+      is_compound ? 1 << offset_bits
+                  : ((1 << conv_params->round_1) >> 1) -
+                        (1 << (offset_bits - 1)));
+  const __m512i sub =
+      _mm512_set1_epi32((1 << (offset_bits - conv_params->round_1)) +
+                        (1 << (offset_bits - conv_params->round_1 - 1)));
+  const int use_wt = conv_params->use_dist_wtd_comp_avg;
+  const __m512i avg_wt =
+      use_wt ? _mm512_set1_epi32(conv_params->fwd_offset |
+                                 (conv_params->bck_offset << 16))
+             : _mm512_set1_epi16(1);
+  const int avg_shift = use_wt ? DIST_PRECISION_BITS : 1;
+  __m512i coeffs[4];
+  for (int k = 0; k < num_pairs; ++k) {
+    const int t = first_tap + 2 * k;
+    coeffs[k] = _mm512_set1_epi32((int)((uint16_t)y_filter[t] |
+                                        ((uint32_t)(uint16_t)y_filter[t + 1]
+                                         << 16)));
+  }
+  assert(h % 2 == 0);
+  assert(is_compound || bits == 0);
+
+  for (int x = 0; x < w; x += 32) {
+    const int16_t *p = im_block + x;
+    __m512i e_lo[4], e_hi[4], o_lo[4], o_hi[4];
+    for (int k = 0; k < num_pairs - 1; ++k) {
+      const int16_t *const row = p + 2 * k * w;
+      const __m512i r0 = _mm512_loadu_si512((const void *)row);
+      const __m512i r1 = _mm512_loadu_si512((const void *)(row + w));
+      const __m512i r2 = _mm512_loadu_si512((const void *)(row + 2 * w));
+      e_lo[k] = _mm512_unpacklo_epi16(r0, r1);
+      e_hi[k] = _mm512_unpackhi_epi16(r0, r1);
+      o_lo[k] = _mm512_unpacklo_epi16(r1, r2);
+      o_hi[k] = _mm512_unpackhi_epi16(r1, r2);
+    }
+    for (int y = 0; y < h; y += 2) {
+      const int last = num_pairs - 1;
+      const int16_t *const row = p + (y + 2 * last) * w;
+      const __m512i r0 = _mm512_loadu_si512((const void *)row);
+      const __m512i r1 = _mm512_loadu_si512((const void *)(row + w));
+      const __m512i r2 = _mm512_loadu_si512((const void *)(row + 2 * w));
+      e_lo[last] = _mm512_unpacklo_epi16(r0, r1);
+      e_hi[last] = _mm512_unpackhi_epi16(r0, r1);
+      o_lo[last] = _mm512_unpacklo_epi16(r1, r2);
+      o_hi[last] = _mm512_unpackhi_epi16(r1, r2);
+
+      __m512i lo0, hi0, lo1, hi1;
+      convolve_vert_32(e_lo, e_hi, coeffs, num_pairs, offset, &lo0, &hi0);
+      convolve_vert_32(o_lo, o_hi, coeffs, num_pairs, offset, &lo1, &hi1);
+      if (is_compound) {
+        CONV_BUF_TYPE *const dst16 =
+            conv_params->dst + y * conv_params->dst_stride + x;
+        store_compound_row_32(dst + y * dst_stride + x, dst16, lo0, hi0,
+                              conv_params, sub, bits, avg_wt, avg_shift);
+        store_compound_row_32(dst + (y + 1) * dst_stride + x,
+                              dst16 + conv_params->dst_stride, lo1, hi1,
+                              conv_params, sub, bits, avg_wt, avg_shift);
+      } else {
+        // The rounding and the offset are folded in the accumulator.
+        const int round_1 = conv_params->round_1;
+        store_pixels_2x32(dst + y * dst_stride + x, dst_stride,
+                          _mm512_srai_epi32(lo0, round_1),
+                          _mm512_srai_epi32(hi0, round_1),
+                          _mm512_srai_epi32(lo1, round_1),
+                          _mm512_srai_epi32(hi1, round_1));
+      }
+
+      for (int k = 0; k < last; ++k) {
+        e_lo[k] = e_lo[k + 1];
+        e_hi[k] = e_hi[k + 1];
+        o_lo[k] = o_lo[k + 1];
+        o_hi[k] = o_hi[k + 1];
+      }
+    }
+  }
+}
+
+static AOM_FORCE_INLINE void convolve_2d_avx512(
+    const uint8_t *src, int src_stride, uint8_t *dst, int dst_stride, int w,
+    int h, const InterpFilterParams *filter_params_x,
+    const InterpFilterParams *filter_params_y, const int subpel_x_qn,
+    const int subpel_y_qn, const int is_compound,
+    const ConvolveParams *conv_params) {
+  DECLARE_ALIGNED(64, int16_t,
+                  im_block[(MAX_SB_SIZE + SUBPEL_TAPS - 1) * MAX_SB_SIZE]);
+  const int pairs_x = get_num_tap_pairs(filter_params_x, subpel_x_qn);
+  const int pairs_y = get_num_tap_pairs(filter_params_y, subpel_y_qn);
+  const int im_h = h + 2 * pairs_y - 1;
+  assert(w % 32 == 0 && w <= MAX_SB_SIZE && h <= MAX_SB_SIZE);
+  assert(conv_params->round_0 > 1);
+
+  src -= (pairs_y - 1) * src_stride;
+  // Dispatch on constant pair counts so that the filter loops are unrolled.
+  switch (pairs_x) {
+    case 4:
+      convolve_2d_horiz_avx512(src, src_stride, im_block, w, im_h,
+                               filter_params_x, subpel_x_qn, 4, conv_params);
+      break;
+    case 3:
+      convolve_2d_horiz_avx512(src, src_stride, im_block, w, im_h,
+                               filter_params_x, subpel_x_qn, 3, conv_params);
+      break;
+    default:
+      convolve_2d_horiz_avx512(src, src_stride, im_block, w, im_h,
+                               filter_params_x, subpel_x_qn, 2, conv_params);
+      break;
+  }
+  switch (pairs_y) {
+    case 4:
+      convolve_2d_vert_avx512(im_block, w, h, dst, dst_stride, filter_params_y,
+                              subpel_y_qn, 4, is_compound, conv_params);
+      break;
+    case 3:
+      convolve_2d_vert_avx512(im_block, w, h, dst, dst_stride, filter_params_y,
+                              subpel_y_qn, 3, is_compound, conv_params);
+      break;
+    default:
+      convolve_2d_vert_avx512(im_block, w, h, dst, dst_stride, filter_params_y,
+                              subpel_y_qn, 2, is_compound, conv_params);
+      break;
+  }
+}
+
+static AOM_FORCE_INLINE int use_avx512_path(
+    int w, const InterpFilterParams *filter_params_x,
+    const InterpFilterParams *filter_params_y) {
+  return w >= 32 && filter_params_x->taps == SUBPEL_TAPS &&
+         filter_params_y->taps == SUBPEL_TAPS;
+}
+
+void av1_convolve_2d_sr_avx512(
+    const uint8_t *src, int32_t src_stride, uint8_t *dst, int32_t dst_stride,
+    int32_t w, int32_t h, const InterpFilterParams *filter_params_x,
+    const InterpFilterParams *filter_params_y, const int32_t subpel_x_qn,
+    const int32_t subpel_y_qn, ConvolveParams *conv_params) {
+  if (!use_avx512_path(w, filter_params_x, filter_params_y)) {
+    av1_convolve_2d_sr_avx2(src, src_stride, dst, dst_stride, w, h,
+                            filter_params_x, filter_params_y, subpel_x_qn,
+                            subpel_y_qn, conv_params);
+    return;
+  }
+  assert(!conv_params->is_compound);
+  convolve_2d_avx512(src, src_stride, dst, dst_stride, w, h, filter_params_x,
+                     filter_params_y, subpel_x_qn, subpel_y_qn, 0,
+                     conv_params);
+}
+
+void av1_dist_wtd_convolve_2d_avx512(
+    const uint8_t *src, int src_stride, uint8_t *dst, int dst_stride, int w,
+    int h, const InterpFilterParams *filter_params_x,
+    const InterpFilterParams *filter_params_y, const int subpel_x_qn,
+    const int subpel_y_qn, ConvolveParams *conv_params) {
+  if (!use_avx512_path(w, filter_params_x, filter_params_y)) {
+    av1_dist_wtd_convolve_2d_avx2(src, src_stride, dst, dst_stride, w, h,
+                                  filter_params_x, filter_params_y,
+                                  subpel_x_qn, subpel_y_qn, conv_params);
+    return;
+  }
+  assert(conv_params->is_compound);
+  convolve_2d_avx512(src, src_stride, dst, dst_stride, w, h, filter_params_x,
+                     filter_params_y, subpel_x_qn, subpel_y_qn, 1,
+                     conv_params);
+}
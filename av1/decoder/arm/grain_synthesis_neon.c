@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <arm_neon.h>
+
+#include "config/av1_rtcd.h"
+
+#include "aom/aom_integer.h"
+#include "aom_ports/mem.h"
+
+// Returns clamp(pixel + ((scale * grain + rounding) >> shift), min, max),
+// where neg_shift holds -shift.
+static inline int32x4_t add_grain(int32x4_t pixel, int32x4_t scale,
+                                  const int *grain, int32x4_t rounding,
+                                  int32x4_t neg_shift, int32x4_t min_val,
+                                  int32x4_t max_val) {
+  int32x4_t noise = vmlaq_s32(rounding, scale, vld1q_s32(grain));
+  noise = vshlq_s32(noise, neg_shift);
+  const int32x4_t sum = vaddq_s32(pixel, noise);
+  return vminq_s32(vmaxq_s32(sum, min_val), max_val);
+}
+
+static inline int32x4_t lookup4(const int *lut, const int *index) {
+  DECLARE_ALIGNED(16, int, values[4]);
+  values[0] = lut[index[0]];
+  values[1] = lut[index[1]];
+  values[2] = lut[index[2]];
+  values[3] = lut[index[3]];
+  return vld1q_s32(values);
+}
+
+static inline int32x4_t lookup4_u8(const int *lut, const uint8_t *pixels) {
+  DECLARE_ALIGNED(16, int, values[4]);
+  values[0] = lut[pixels[0]];
+  values[1] = lut[pixels[1]];
+  values[2] = lut[pixels[2]];
+  values[3] = lut[pixels[3]];
+  return vld1q_s32(values);
+}
+
+static inline int32x4_t lookup4_u16(const int *lut, const uint16_t *pixels) {
+  DECLARE_ALIGNED(16, int, values[4]);
+  values[0] = lut[pixels[0]];
+  values[1] = lut[pixels[1]];
+  values[2] = lut[pixels[2]];
+  values[3] = lut[pixels[3]];
+  return vld1q_s32(values);
+}
+
+static inline int32x4_t widen_lo_u16(uint16x8_t v) {
+  return vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(v)));
+}
+
+static inline int32x4_t widen_hi_u16(uint16x8_t v) {
+  return vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(v)));
+}
+
+// Stores the scaling function indices of 4 chroma samples in index.
+static inline void chroma_index(int32x4_t average_luma, int32x4_t pixel,
+                                int32_t luma_mult, int32_t chroma_mult,
+                                int32x4_t offset, int32x4_t max_index,
+                                int *index) {
+  int32x4_t v = vmulq_n_s32(average_luma, luma_mult);
+  v = vmlaq_n_s32(v, pixel, chroma_mult);
+  v = vaddq_s32(vshrq_n_s32(v, 6), offset);
+  v = vminq_s32(vmaxq_s32(v, vdupq_n_s32(0)), max_index);
+  vst1q_s32(index, v);
+}
+
+void av1_add_film_grain_luma_neon(uint8_t *luma, int luma_stride,
+                                  const int *grain, int grain_stride,
+                                  int width, int height,
+                                  const int *scaling_lut, int scaling_shift,
+                                  int min_val, int max_val) {
+  const int w8 = width & ~7;
+  const int32x4_t rounding = vdupq_n_s32(1 << (scaling_shift - 1));
+  const int32x4_t neg_shift = vdupq_n_s32(-scaling_shift);
+  const int32x4_t vmin = vdupq_n_s32(min_val);
+  const int32x4_t vmax = vdupq_n_s32(max_val);
+  for (int i = 0; i < height; i++) {
+    uint8_t *row = luma + i * luma_stride;
+    const int *grain_row = grain + i * grain_stride;
+    for (int j = 0; j < w8; j += 8) {
+      const uint16x8_t pixels = vmovl_u8(vld1_u8(row + j));
+      const int32x4_t out_lo =
+          add_grain(widen_lo_u16(pixels), lookup4_u8(scaling_lut, row + j),
+                    grain_row + j, rounding, neg_shift, vmin, vmax);
+      const int32x4_t out_hi =
+          add_grain(widen_hi_u16(pixels), lookup4_u8(scaling_lut, row + j + 4),
+                    grain_row + j + 4, rounding, neg_shift, vmin, vmax);
+      const uint16x8_t out =
+          vcombine_u16(vqmovun_s32(out_lo), vqmovun_s32(out_hi));
+      vst1_u8(row + j, vqmovn_u16(out));
+    }
+  }
+  if (width > w8) {
+    av1_add_film_grain_luma_c(luma + w8, luma_stride, grain + w8, grain_stride,
+                              width - w8, height, scaling_lut, scaling_shift,
+                              min_val, max_val);
+  }
+}
+
+void av1_add_film_grain_chroma_neon(
+    uint8_t *chroma, int chroma_stride, const uint8_t *luma, int luma_stride,
+    const int *grain, int grain_stride, int width, int height,
+    int subsampling_x, int subsampling_y, const int *scaling_lut,
+    int luma_mult, int chroma_mult, int offset, int scaling_shift,
+    int min_val, int max_val) {
+  const int w8 = width & ~7;
+  const int32x4_t rounding = vdupq_n_s32(1 << (scaling_shift - 1));
+  const int32x4_t neg_shift = vdupq_n_s32(-scaling_shift);
+  const int32x4_t vmin = vdupq_n_s32(min_val);
+  const int32x4_t vmax = vdupq_n_s32(max_val);
+  const int32x4_t voffset = vdupq_n_s32(offset);
+  const int32x4_t max_index = vdupq_n_s32(255);
+  DECLARE_ALIGNED(16, int, index[8]);
+  for (int i = 0; i < height; i++) {
+    uint8_t *row = chroma + i * chroma_stride;
+    const uint8_t *luma_row = luma + (i << subsampling_y) * luma_stride;
+    const int *grain_row = grain + i * grain_stride;
+    for (int j = 0; j < w8; j += 8) {
+      uint16x8_t average;
+      if (subsampling_x) {
+        average = vrshrq_n_u16(vpaddlq_u8(vld1q_u8(luma_row + (j << 1))), 1);
+      } else {
+        average = vmovl_u8(vld1_u8(luma_row + j));
+      }
+      const uint16x8_t pixels = vmovl_u8(vld1_u8(row + j));
+      const int32x4_t lo = widen_lo_u16(pixels);
+      const int32x4_t hi = widen_hi_u16(pixels);
+      chroma_index(widen_lo_u16(average), lo, luma_mult, chroma_mult, voffset,
+                   max_index, index);
+      chroma_index(widen_hi_u16(average), hi, luma_mult, chroma_mult, voffset,
+                   max_index, index + 4);
+      const int32x4_t out_lo =
+          add_grain(lo, lookup4(scaling_lut, index), grain_row + j, rounding,
+                    neg_shift, vmin, vmax);
+      const int32x4_t out_hi =
+          add_grain(hi, lookup4(scaling_lut, index + 4), grain_row + j + 4,
+                    rounding, neg_shift, vmin, vmax);
+      const uint16x8_t out =
+          vcombine_u16(vqmovun_s32(out_lo), vqmovun_s32(out_hi));
+      vst1_u8(row + j, vqmovn_u16(out));
+    }
+  }
+  if (width > w8) {
+    av1_add_film_grain_chroma_c(
+        chroma + w8, chroma_stride, luma + (w8 << subsampling_x), luma_stride,
+        grain + w8, grain_stride, width - w8, height, subsampling_x,
+        subsampling_y, scaling_lut, luma_mult, chroma_mult, offset,
+        scaling_shift, min_val, max_val);
+  }
+}
+
+void av1_highbd_add_film_grain_luma_neon(uint16_t *luma, int luma_stride,
+                                         const int *grain, int grain_stride,
+                                         int width, int height,
+                                         const int *scaling_lut,
+                                         int scaling_shift, int min_val,
+                                         int max_val) {
+  const int w8 = width & ~7;
+  const int32x4_t rounding = vdupq_n_s32(1 << (scaling_shift - 1));
+  const int32x4_t neg_shift = vdupq_n_s32(-scaling_shift);
+  const int32x4_t vmin = vdupq_n_s32(min_val);
+  const int32x4_t vmax = vdupq_n_s32(max_val);
+  for (int i = 0; i < height; i++) {
+    uint16_t *row = luma + i * luma_stride;
+    const int *grain_row = grain + i * grain_stride;
+    for (int j = 0; j < w8; j += 8) {
+      const uint16x8_t pixels = vld1q_u16(row + j);
+      const int32x4_t out_lo =
+          add_grain(widen_lo_u16(pixels), lookup4_u16(scaling_lut, row + j),
+                    grain_row + j, rounding, neg_shift, vmin, vmax);
+      const int32x4_t out_hi =
+          add_grain(widen_hi_u16(pixels), lookup4_u16(scaling_lut, row + j + 4),
+                    grain_row + j + 4, rounding, neg_shift, vmin, vmax);
+      vst1q_u16(row + j,
+                vcombine_u16(vqmovun_s32(out_lo), vqmovun_s32(out_hi)));
+    }
+  }
+  if (width > w8) {
+    av1_highbd_add_film_grain_luma_c(luma + w8, luma_stride, grain + w8,
+                                     grain_stride, width - w8, height,
+                                     scaling_lut, scaling_shift, min_val,
+                                     max_val);
+  }
+}
+
+void av1_highbd_add_film_grain_chroma_neon(
+    uint16_t *chroma, int chroma_stride, const uint16_t *luma, int luma_stride,
+    const int *grain, int grain_stride, int width, int height,
+    int subsampling_x, int subsampling_y, const int *scaling_lut,
+    int luma_mult, int chroma_mult, int offset, int scaling_shift,
+    int min_val, int max_val, int bd) {
+  const int w8 = width & ~7;
+  const int32x4_t rounding = vdupq_n_s32(1 << (scaling_shift - 1));
+  const int32x4_t neg_shift = vdupq_n_s32(-scaling_shift);
+  const int32x4_t vmin = vdupq_n_s32(min_val);
+  const int32x4_t vmax = vdupq_n_s32(max_val);
+  const int32x4_t voffset = vdupq_n_s32(offset);
+  const int32x4_t max_index = vdupq_n_s32((256 << (bd - 8)) - 1);
+  DECLARE_ALIGNED(16, int, index[8]);
+  for (int i = 0; i < height; i++) {
+    uint16_t *row = chroma + i * chroma_stride;
+    const uint16_t *luma_row = luma + (i << subsampling_y) * luma_stride;
+    const int *grain_row = grain + i * grain_stride;
+    for (int j = 0; j < w8; j += 8) {
+      int32x4_t average_lo, average_hi;
+      if (subsampling_x) {
+        const uint16_t *l = luma_row + (j << 1);
+        average_lo = vreinterpretq_s32_u32(
+            vrshrq_n_u32(vpaddlq_u16(vld1q_u16(l)), 1));
+        average_hi = vreinterpretq_s32_u32(
+            vrshrq_n_u32(vpaddlq_u16(vld1q_u16(l + 8)), 1));
+      } else {
+        const uint16x8_t l = vld1q_u16(luma_row + j);
+        average_lo = widen_lo_u16(l);
+        average_hi = widen_hi_u16(l);
+      }
+      const uint16x8_t pixels = vld1q_u16(row + j);
+      const int32x4_t lo = widen_lo_u16(pixels);
+      const int32x4_t hi = widen_hi_u16(pixels);
+      chroma_index(average_lo, lo, luma_mult, chroma_mult, voffset, max_index,
+                   index);
+      chroma_index(average_hi, hi, luma_mult, chroma_mult, voffset, max_index,
+                   index + 4);
+      const int32x4_t out_lo =
+          add_grain(lo, lookup4(scaling_lut, index), grain_row + j, rounding,
+                    neg_shift, vmin, vmax);
+      const int32x4_t out_hi =
+          add_grain(hi, lookup4(scaling_lut, index + 4), grain_row + j + 4,
+                    rounding, neg_shift, vmin, vmax);
+      vst1q_u16(row + j,
+                vcombine_u16(vqmovun_s32(out_lo), vqmovun_s32(out_hi)));
+    }
+  }
+  if (width > w8) {
+    av1_highbd_add_film_grain_chroma_c(
+        chroma + w8, chroma_stride, luma + (w8 << subsampling_x), luma_stride,
+        grain + w8, grain_stride, width - w8, height, subsampling_x,
+        subsampling_y, scaling_lut, luma_mult, chroma_mult, offset,
+        scaling_shift, min_val, max_val, bd);
+  }
+}
@@ -29,6 +29,7 @@
 #include "aom_ports/mem.h"
 #include "aom_ports/mem_ops.h"
 #include "aom_scale/yv12config.h"
+#include "aom_util/aom_progress.h"
 #include "aom_util/aom_pthread.h"
 #include "aom_util/aom_thread.h"
 
@@ -2495,54 +2496,20 @@ static inline int get_sync_range(int width) {
 static inline void dec_row_mt_alloc(AV1DecRowMTSync *dec_row_mt_sync,
                                     AV1_COMMON *cm, int rows) {
   dec_row_mt_sync->allocated_sb_rows = rows;
-#if CONFIG_MULTITHREAD
-  {
-    int i;
-
-    CHECK_MEM_ERROR(cm, dec_row_mt_sync->mutex_,
-                    aom_malloc(sizeof(*(dec_row_mt_sync->mutex_)) * rows));
-    if (dec_row_mt_sync->mutex_) {
-      for (i = 0; i < rows; ++i) {
-        pthread_mutex_init(&dec_row_mt_sync->mutex_[i], NULL);
-      }
-    }
-
-    CHECK_MEM_ERROR(cm, dec_row_mt_sync->cond_,
-                    aom_malloc(sizeof(*(dec_row_mt_sync->cond_)) * rows));
-    if (dec_row_mt_sync->cond_) {
-      for (i = 0; i < rows; ++i) {
-        pthread_cond_init(&dec_row_mt_sync->cond_[i], NULL);
-      }
-    }
+  if (!aom_progress_alloc_array(&dec_row_mt_sync->cur_sb_col, rows, -1)) {
+    aom_internal_error(cm->error, AOM_CODEC_MEM_ERROR,
+                       "Failed to allocate dec_row_mt_sync->cur_sb_col");
   }
-#endif  // CONFIG_MULTITHREAD
-
-  CHECK_MEM_ERROR(cm, dec_row_mt_sync->cur_sb_col,
-                  aom_malloc(sizeof(*(dec_row_mt_sync->cur_sb_col)) * rows));
 
   // Set up nsync.
   dec_row_mt_sync->sync_range = get_sync_range(cm->width);
 }
 
-// Deallocate decoder row synchronization related mutex and data
+// Deallocate decoder row synchronization related data
 void av1_dec_row_mt_dealloc(AV1DecRowMTSync *dec_row_mt_sync) {
   if (dec_row_mt_sync != NULL) {
-#if CONFIG_MULTITHREAD
-    int i;
-    if (dec_row_mt_sync->mutex_ != NULL) {
-      for (i = 0; i < dec_row_mt_sync->allocated_sb_rows; ++i) {
-        pthread_mutex_destroy(&dec_row_mt_sync->mutex_[i]);
-      }
-      aom_free(dec_row_mt_sync->mutex_);
-    }
-    if (dec_row_mt_sync->cond_ != NULL) {
-      for (i = 0; i < dec_row_mt_sync->allocated_sb_rows; ++i) {
-        pthread_cond_destroy(&dec_row_mt_sync->cond_[i]);
-      }
-      aom_free(dec_row_mt_sync->cond_);
-    }
-#endif  // CONFIG_MULTITHREAD
-    aom_free(dec_row_mt_sync->cur_sb_col);
+    aom_progress_free_array(&dec_row_mt_sync->cur_sb_col,
+                            dec_row_mt_sync->allocated_sb_rows);
 
     // clear the structure as the source of this call may be a resize in which
     // case this call will be followed by an _alloc() which may fail.
@@ -2556,14 +2523,9 @@ static inline void sync_read(AV1DecRowMTSync *const dec_row_mt_sync, int r,
   const int nsync = dec_row_mt_sync->sync_range;
 
   if (r && !(c & (nsync - 1))) {
-    pthread_mutex_t *const mutex = &dec_row_mt_sync->mutex_[r - 1];
-    pthread_mutex_lock(mutex);
-
-    while (c > dec_row_mt_sync->cur_sb_col[r - 1] - nsync -
-                   dec_row_mt_sync->intrabc_extra_top_right_sb_delay) {
-      pthread_cond_wait(&dec_row_mt_sync->cond_[r - 1], mutex);
-    }
-    pthread_mutex_unlock(mutex);
+    aom_progress_wait(
+        &dec_row_mt_sync->cur_sb_col[r - 1],
+        c + nsync + dec_row_mt_sync->intrabc_extra_top_right_sb_delay);
   }
 #else
   (void)dec_row_mt_sync;
@@ -2586,14 +2548,7 @@ static inline void sync_write(AV1DecRowMTSync *const dec_row_mt_sync, int r,
     cur = sb_cols + nsync + dec_row_mt_sync->intrabc_extra_top_right_sb_delay;
   }
 
-  if (sig) {
-    pthread_mutex_lock(&dec_row_mt_sync->mutex_[r]);
-
-    dec_row_mt_sync->cur_sb_col[r] = cur;
-
-    pthread_cond_signal(&dec_row_mt_sync->cond_[r]);
-    pthread_mutex_unlock(&dec_row_mt_sync->mutex_[r]);
-  }
+  if (sig) aom_progress_set(&dec_row_mt_sync->cur_sb_col[r], cur);
 #else
   (void)dec_row_mt_sync;
   (void)r;
@@ -3707,8 +3662,8 @@ static inline void row_mt_frame_init(AV1Decoder *pbi, int tile_rows_start,
           tile_data->dec_row_mt_sync.mi_rows;
 
       // Initialize cur_sb_col to -1 for all SB rows.
-      memset(tile_data->dec_row_mt_sync.cur_sb_col, -1,
-             sizeof(*tile_data->dec_row_mt_sync.cur_sb_col) * max_sb_rows);
+      aom_progress_reset_array(tile_data->dec_row_mt_sync.cur_sb_col,
+                               max_sb_rows, -1);
     }
   }
 
@@ -5183,6 +5138,18 @@ uint32_t av1_decode_frame_headers_and_setup(AV1Decoder *pbi,
 
   if (trailing_bits_present) av1_check_trailing_bits(pbi, rb);
 
+  if (pbi->frame_sync != NULL) {
+    if (!cm->show_existing_frame)
+      av1_frame_sync_start_frame(pbi->frame_sync, cm->cur_frame);
+    // Let the next frame worker start as soon as the last frame header of
+    // this temporal unit is read. A superres frame changes its size when it
+    // is upscaled, so it is handed over once fully decoded instead.
+    if (pbi->frame_headers_left > 0 && --pbi->frame_headers_left == 0 &&
+        !av1_superres_scaled(cm)) {
+      av1_frame_sync_publish_state(pbi, /*frame_in_progress=*/1);
+    }
+  }
+
   if (!cm->tiles.single_tile_decoding &&
       (pbi->dec_tile_row >= 0 || pbi->dec_tile_col >= 0)) {
     pbi->dec_tile_row = -1;
@@ -5211,6 +5178,17 @@ uint32_t av1_decode_frame_headers_and_setup(AV1Decoder *pbi,
     return uncomp_hdr_size;
   }
 
+  if (pbi->frame_sync != NULL) {
+    // The reference frames may still be decoded by other frame workers.
+    for (int i = LAST_FRAME; i <= ALTREF_FRAME; ++i) {
+      const RefCntBuffer *const buf = get_ref_frame_buf(cm, i);
+      if (buf != NULL && av1_frame_sync_wait_frame(pbi->frame_sync, buf)) {
+        aom_internal_error(&pbi->error, AOM_CODEC_CORRUPT_FRAME,
+                           "Failed to decode reference frame");
+      }
+    }
+  }
+
   cm->mi_params.setup_mi(&cm->mi_params);
 
   av1_calculate_ref_frame_side(cm);
@@ -5290,12 +5268,6 @@ void av1_decode_tg_tiles_and_wrapup(AV1Decoder *pbi, const uint8_t *data,
   av1_alloc_cdef_sync(cm, &pbi->cdef_sync, pbi->num_workers);
 
   if (!cm->features.allow_intrabc && !tiles->single_tile_decoding) {
-    if (cm->lf.filter_level[0] || cm->lf.filter_level[1]) {
-      av1_loop_filter_frame_mt(&cm->cur_frame->buf, cm, &pbi->dcb.xd, 0,
-                               num_planes, 0, pbi->tile_workers,
-                               pbi->num_workers, &pbi->lf_row_sync, 0);
-    }
-
     const int do_cdef =
         !pbi->skip_loop_filter && !cm->features.coded_lossless &&
         (cm->cdef_info.cdef_bits || cm->cdef_info.cdef_strengths[0] ||
@@ -5309,52 +5281,73 @@ void av1_decode_tg_tiles_and_wrapup(AV1Decoder *pbi, const uint8_t *data,
     // Frame border extension is not required in the decoder
     // as it happens in extend_mc_border().
     int do_extend_border_mt = 0;
-    if (!optimized_loop_restoration) {
-      if (do_loop_restoration)
-        av1_loop_restoration_save_boundary_lines(&pbi->common.cur_frame->buf,
-                                                 cm, 0);
-
-      if (do_cdef) {
-        if (pbi->num_workers > 1) {
-          av1_cdef_frame_mt(cm, &pbi->dcb.xd, pbi->cdef_worker,
-                            pbi->tile_workers, &pbi->cdef_sync,
-                            pbi->num_workers, av1_cdef_init_fb_row_mt,
-                            do_extend_border_mt);
-        } else {
-          av1_cdef_frame(&pbi->common.cur_frame->buf, cm, &pbi->dcb.xd,
-                         av1_cdef_init_fb_row);
-        }
+
+    if (pbi->num_workers > 1 && !do_superres &&
+        (do_cdef || do_loop_restoration)) {
+      // Filter each superblock row through deblocking, CDEF and loop
+      // restoration as soon as its neighbors are ready, instead of running
+      // one pass over the frame per filter.
+      av1_filter_frame_pipeline_mt(
+          &cm->cur_frame->buf, cm, &pbi->dcb.xd, pbi->tile_workers,
+          pbi->num_workers, &pbi->lf_row_sync, pbi->cdef_worker,
+          &pbi->cdef_sync, &pbi->lr_row_sync, &pbi->lr_ctxt,
+          &pbi->filter_pipeline_sync, do_cdef, do_loop_restoration);
+    } else {
+      if (cm->lf.filter_level[0] || cm->lf.filter_level[1]) {
+        av1_loop_filter_frame_mt(&cm->cur_frame->buf, cm, &pbi->dcb.xd, 0,
+                                 num_planes, 0, pbi->tile_workers,
+                                 pbi->num_workers, &pbi->lf_row_sync, 0);
       }
 
-      superres_post_decode(pbi);
+      if (!optimized_loop_restoration) {
+        if (do_loop_restoration)
+          av1_loop_restoration_save_boundary_lines(&pbi->common.cur_frame->buf,
+                                                   cm, 0);
+
+        if (do_cdef) {
+          if (pbi->num_workers > 1) {
+            av1_cdef_frame_mt(cm, &pbi->dcb.xd, pbi->cdef_worker,
+                              pbi->tile_workers, &pbi->cdef_sync,
+                              pbi->num_workers, av1_cdef_init_fb_row_mt,
+                              do_extend_border_mt);
+          } else {
+            av1_cdef_frame(&pbi->common.cur_frame->buf, cm, &pbi->dcb.xd,
+                           av1_cdef_init_fb_row);
+          }
+        }
 
-      if (do_loop_restoration) {
-        av1_loop_restoration_save_boundary_lines(&pbi->common.cur_frame->buf,
-                                                 cm, 1);
-        if (pbi->num_workers > 1) {
-          av1_loop_restoration_filter_frame_mt(
-              (YV12_BUFFER_CONFIG *)xd->cur_buf, cm, optimized_loop_restoration,
-              pbi->tile_workers, pbi->num_workers, &pbi->lr_row_sync,
-              &pbi->lr_ctxt, do_extend_border_mt);
-        } else {
-          av1_loop_restoration_filter_frame((YV12_BUFFER_CONFIG *)xd->cur_buf,
-                                            cm, optimized_loop_restoration,
-                                            &pbi->lr_ctxt);
+        superres_post_decode(pbi);
+
+        if (do_loop_restoration) {
+          av1_loop_restoration_save_boundary_lines(&pbi->common.cur_frame->buf,
+                                                   cm, 1);
+          if (pbi->num_workers > 1) {
+            av1_loop_restoration_filter_frame_mt(
+                (YV12_BUFFER_CONFIG *)xd->cur_buf, cm,
+                optimized_loop_restoration, pbi->tile_workers,
+                pbi->num_workers, &pbi->lr_row_sync, &pbi->lr_ctxt,
+                do_extend_border_mt);
+          } else {
+            av1_loop_restoration_filter_frame(
+                (YV12_BUFFER_CONFIG *)xd->cur_buf, cm,
+                optimized_loop_restoration, &pbi->lr_ctxt);
+          }
         }
-      }
-    } else {
-      // In no cdef and no superres case. Provide an optimized version of
-      // loop_restoration_filter.
-      if (do_loop_restoration) {
-        if (pbi->num_workers > 1) {
-          av1_loop_restoration_filter_frame_mt(
-              (YV12_BUFFER_CONFIG *)xd->cur_buf, cm, optimized_loop_restoration,
-              pbi->tile_workers, pbi->num_workers, &pbi->lr_row_sync,
-              &pbi->lr_ctxt, do_extend_border_mt);
-        } else {
-          av1_loop_restoration_filter_frame((YV12_BUFFER_CONFIG *)xd->cur_buf,
-                                            cm, optimized_loop_restoration,
-                                            &pbi->lr_ctxt);
+      } else {
+        // In no cdef and no superres case. Provide an optimized version of
+        // loop_restoration_filter.
+        if (do_loop_restoration) {
+          if (pbi->num_workers > 1) {
+            av1_loop_restoration_filter_frame_mt(
+                (YV12_BUFFER_CONFIG *)xd->cur_buf, cm,
+                optimized_loop_restoration, pbi->tile_workers,
+                pbi->num_workers, &pbi->lr_row_sync, &pbi->lr_ctxt,
+                do_extend_border_mt);
+          } else {
+            av1_loop_restoration_filter_frame(
+                (YV12_BUFFER_CONFIG *)xd->cur_buf, cm,
+                optimized_loop_restoration, &pbi->lr_ctxt);
+          }
         }
       }
     }
@@ -219,6 +219,7 @@ void av1_decoder_remove(AV1Decoder *pbi) {
   if (pbi->num_workers > 0) {
     av1_loop_filter_dealloc(&pbi->lf_row_sync);
     av1_loop_restoration_dealloc(&pbi->lr_row_sync);
+    av1_filter_pipeline_dealloc(&pbi->filter_pipeline_sync);
     av1_dealloc_dec_jobs(&pbi->tile_mt_info);
   }
 
@@ -344,6 +345,9 @@ static void release_current_frame(AV1Decoder *pbi) {
   BufferPool *const pool = cm->buffer_pool;
 
   cm->cur_frame->buf.corrupted = 1;
+  // For a shown existing frame, cm->cur_frame is owned by another frame.
+  if (pbi->frame_sync != NULL && !cm->show_existing_frame)
+    av1_frame_sync_finish_frame(pbi->frame_sync, cm->cur_frame, 1);
   lock_buffer_pool(pool);
   decrease_ref_count(cm->cur_frame, pool);
   unlock_buffer_pool(pool);
@@ -488,6 +492,11 @@ int av1_receive_compressed_data(AV1Decoder *pbi, size_t size,
   cm->txb_count = 0;
 #endif
 
+  // The frame must be marked as done before update_frame_buffers() may release
+  // it to the buffer pool.
+  if (pbi->frame_sync != NULL && !cm->show_existing_frame)
+    av1_frame_sync_finish_frame(pbi->frame_sync, cm->cur_frame, 0);
+
   // Note: At this point, this function holds a reference to cm->cur_frame
   // in the buffer pool. This reference is consumed by update_frame_buffers().
   update_frame_buffers(pbi, frame_decoded);
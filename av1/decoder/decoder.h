@@ -17,6 +17,7 @@
 #include "aom/aom_codec.h"
 #include "aom_dsp/bitreader.h"
 #include "aom_scale/yv12config.h"
+#include "aom_util/aom_progress.h"
 #include "aom_util/aom_thread.h"
 
 #include "av1/common/av1_common_int.h"
@@ -138,12 +139,9 @@ typedef struct AV1DecRowMTJobInfo {
 } AV1DecRowMTJobInfo;
 
 typedef struct AV1DecRowMTSyncData {
-#if CONFIG_MULTITHREAD
-  pthread_mutex_t *mutex_;
-  pthread_cond_t *cond_;
-#endif
   int allocated_sb_rows;
-  int *cur_sb_col;
+  // Number of decoded superblocks in each superblock row.
+  AVxProgress *cur_sb_col;
   // Denotes the superblock interval at which conditional signalling should
   // happen. Also denotes the minimum number of extra superblocks of the top row
   // to be complete to start decoding the current superblock. A value of 1
@@ -229,6 +227,28 @@ typedef struct AV1DecTileMTData {
   int alloc_tile_cols;
 } AV1DecTileMT;
 
+// Decoder state that carries over from one temporal unit to the next. In frame
+// parallel mode it is handed from one frame worker to the next through
+// AV1FrameSync.
+typedef struct AV1DecPersistentState {
+  SequenceHeader seq_params;
+  int sequence_header_ready;
+  int sequence_header_changed;
+  int current_operating_point;
+  unsigned int number_temporal_layers;
+  unsigned int number_spatial_layers;
+  int decoding_first_frame;
+  int need_resync;
+  int valid_for_referencing[REF_FRAMES];
+  int is_fwd_kf_present;
+  int is_arf_frame_present;
+  RefCntBuffer *ref_frame_map[REF_FRAMES];
+  int ref_frame_id[REF_FRAMES];
+  int current_frame_id;
+  unsigned int frame_number;
+  FRAME_CONTEXT default_frame_context;
+} AV1DecPersistentState;
+
 typedef struct AV1Decoder {
   DecoderCodingBlock dcb;
 
@@ -237,6 +257,7 @@ typedef struct AV1Decoder {
   AVxWorker lf_worker;
   AV1LfSync lf_row_sync;
   AV1LrSync lr_row_sync;
+  AV1FilterPipelineSync filter_pipeline_sync;
   AV1LrStruct lr_ctxt;
   AV1CdefSync cdef_sync;
   AV1CdefWorkerData *cdef_worker;
@@ -369,6 +390,29 @@ typedef struct AV1Decoder {
    * Number of spatial layers: may be > 1 for SVC (scalable vector coding).
    */
   unsigned int number_spatial_layers;
+
+  /*!
+   * Frame parallel synchronization shared with the other frame workers. NULL
+   * unless the decoder runs in frame parallel mode.
+   */
+  AV1FrameSync *frame_sync;
+
+  /*!
+   * Index of the temporal unit being decoded in frame parallel mode.
+   */
+  unsigned int frame_sync_tu;
+
+  /*!
+   * Number of frame headers left in the current temporal unit before the
+   * decoder state can be handed over to the next frame worker. 0 if the state
+   * is only handed over once the whole temporal unit is decoded.
+   */
+  int frame_headers_left;
+
+  /*!
+   * Set once the state left by the current temporal unit has been published.
+   */
+  int state_published;
 } AV1Decoder;
 
 // Returns 0 on success. Sets pbi->common.error.error_code to a nonzero error
@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "aom_mem/aom_mem.h"
+#include "aom_util/aom_pthread.h"
+#include "av1/common/av1_common_int.h"
+#include "av1/decoder/decoder.h"
+#include "av1/decoder/dthread.h"
+
+int av1_frame_sync_alloc(AV1FrameSync *sync, BufferPool *pool) {
+  memset(sync, 0, sizeof(*sync));
+  sync->pool = pool;
+#if CONFIG_MULTITHREAD
+  sync->mutex_ = aom_malloc(sizeof(*sync->mutex_));
+  if (sync->mutex_ == NULL) return -1;
+  pthread_mutex_init(sync->mutex_, NULL);
+  sync->cond_ = aom_malloc(sizeof(*sync->cond_));
+  if (sync->cond_ == NULL) return -1;
+  pthread_cond_init(sync->cond_, NULL);
+#endif
+  sync->frame_done =
+      aom_malloc(pool->num_frame_bufs * sizeof(*sync->frame_done));
+  if (sync->frame_done == NULL) return -1;
+  for (int i = 0; i < pool->num_frame_bufs; ++i) sync->frame_done[i] = 1;
+  sync->state = aom_calloc(1, sizeof(*sync->state));
+  if (sync->state == NULL) return -1;
+  return 0;
+}
+
+void av1_frame_sync_dealloc(AV1FrameSync *sync) {
+  if (sync->state != NULL) {
+    lock_buffer_pool(sync->pool);
+    for (int i = 0; i < REF_FRAMES; ++i)
+      decrease_ref_count(sync->state->ref_frame_map[i], sync->pool);
+    unlock_buffer_pool(sync->pool);
+    aom_free(sync->state);
+  }
+  aom_free(sync->frame_done);
+#if CONFIG_MULTITHREAD
+  if (sync->mutex_ != NULL) {
+    pthread_mutex_destroy(sync->mutex_);
+    aom_free(sync->mutex_);
+  }
+  if (sync->cond_ != NULL) {
+    pthread_cond_destroy(sync->cond_);
+    aom_free(sync->cond_);
+  }
+#endif
+  memset(sync, 0, sizeof(*sync));
+}
+
+static inline int get_buf_idx(const AV1FrameSync *sync,
+                              const RefCntBuffer *buf) {
+  const int idx = (int)(buf - sync->pool->frame_bufs);
+  assert(idx >= 0 && idx < sync->pool->num_frame_bufs);
+  return idx;
+}
+
+static void set_frame_status(AV1FrameSync *sync, const RefCntBuffer *buf,
+                             int status) {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(sync->mutex_);
+#endif
+  sync->frame_done[get_buf_idx(sync, buf)] = status;
+#if CONFIG_MULTITHREAD
+  pthread_cond_broadcast(sync->cond_);
+  pthread_mutex_unlock(sync->mutex_);
+#endif
+}
+
+void av1_frame_sync_start_frame(AV1FrameSync *sync, const RefCntBuffer *buf) {
+  set_frame_status(sync, buf, 0);
+}
+
+void av1_frame_sync_finish_frame(AV1FrameSync *sync, const RefCntBuffer *buf,
+                                 int failed) {
+  set_frame_status(sync, buf, failed ? -1 : 1);
+}
+
+int av1_frame_sync_wait_frame(AV1FrameSync *sync, const RefCntBuffer *buf) {
+  const int idx = get_buf_idx(sync, buf);
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(sync->mutex_);
+  while (!sync->frame_done[idx]) pthread_cond_wait(sync->cond_, sync->mutex_);
+#endif
+  const int status = sync->frame_done[idx];
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(sync->mutex_);
+#endif
+  return status < 0 ? -1 : 0;
+}
+
+void av1_frame_sync_publish_state(AV1Decoder *pbi, int frame_in_progress) {
+  AV1FrameSync *const sync = pbi->frame_sync;
+  AV1_COMMON *const cm = &pbi->common;
+  BufferPool *const pool = cm->buffer_pool;
+  AV1DecPersistentState *const state = sync->state;
+
+  if (pbi->state_published) return;
+  pbi->state_published = 1;
+
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(sync->mutex_);
+#endif
+  // The previous state has already been consumed by this decoder (or is the
+  // initial state), so it can be overwritten without further checks.
+  state->seq_params = pbi->seq_params;
+  state->sequence_header_ready = pbi->sequence_header_ready;
+  state->sequence_header_changed = pbi->sequence_header_changed;
+  state->current_operating_point = pbi->current_operating_point;
+  state->number_temporal_layers = pbi->number_temporal_layers;
+  state->number_spatial_layers = pbi->number_spatial_layers;
+  state->decoding_first_frame = pbi->decoding_first_frame;
+  state->need_resync = pbi->need_resync;
+  memcpy(state->valid_for_referencing, pbi->valid_for_referencing,
+         sizeof(state->valid_for_referencing));
+  state->is_fwd_kf_present = pbi->is_fwd_kf_present;
+  state->is_arf_frame_present = pbi->is_arf_frame_present;
+  memcpy(state->ref_frame_id, cm->ref_frame_id, sizeof(state->ref_frame_id));
+  state->current_frame_id = cm->current_frame_id;
+  state->frame_number = cm->current_frame.frame_number;
+  state->default_frame_context = *cm->default_frame_context;
+
+  lock_buffer_pool(pool);
+  for (int i = 0; i < REF_FRAMES; ++i) {
+    RefCntBuffer *buf = cm->ref_frame_map[i];
+    // Apply the reference map update of the frame whose header was just read;
+    // update_frame_buffers() performs the same update for this decoder.
+    if (frame_in_progress &&
+        (cm->current_frame.refresh_frame_flags & (1 << i)))
+      buf = cm->cur_frame;
+    decrease_ref_count(state->ref_frame_map[i], pool);
+    state->ref_frame_map[i] = buf;
+    if (buf != NULL) ++buf->ref_count;
+  }
+  unlock_buffer_pool(pool);
+
+  if (frame_in_progress) {
+    state->decoding_first_frame = 0;
+    if (cm->show_frame &&
+        !cm->seq_params->order_hint_info.enable_order_hint)
+      ++state->frame_number;
+  }
+  sync->state_tu = pbi->frame_sync_tu;
+#if CONFIG_MULTITHREAD
+  pthread_cond_broadcast(sync->cond_);
+  pthread_mutex_unlock(sync->mutex_);
+#endif
+}
+
+void av1_frame_sync_inherit_state(AV1Decoder *pbi) {
+  AV1FrameSync *const sync = pbi->frame_sync;
+  AV1_COMMON *const cm = &pbi->common;
+  BufferPool *const pool = cm->buffer_pool;
+  const AV1DecPersistentState *const state = sync->state;
+
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(sync->mutex_);
+  while (sync->state_tu != pbi->frame_sync_tu - 1)
+    pthread_cond_wait(sync->cond_, sync->mutex_);
+#endif
+  pbi->seq_params = state->seq_params;
+  pbi->sequence_header_ready = state->sequence_header_ready;
+  pbi->sequence_header_changed = state->sequence_header_changed;
+  pbi->current_operating_point = state->current_operating_point;
+  pbi->number_temporal_layers = state->number_temporal_layers;
+  pbi->number_spatial_layers = state->number_spatial_layers;
+  pbi->decoding_first_frame = state->decoding_first_frame;
+  pbi->need_resync = state->need_resync;
+  memcpy(pbi->valid_for_referencing, state->valid_for_referencing,
+         sizeof(pbi->valid_for_referencing));
+  pbi->is_fwd_kf_present = state->is_fwd_kf_present;
+  pbi->is_arf_frame_present = state->is_arf_frame_present;
+  memcpy(cm->ref_frame_id, state->ref_frame_id, sizeof(cm->ref_frame_id));
+  cm->current_frame_id = state->current_frame_id;
+  cm->current_frame.frame_number = state->frame_number;
+  *cm->default_frame_context = state->default_frame_context;
+
+  lock_buffer_pool(pool);
+  for (int i = 0; i < REF_FRAMES; ++i) {
+    decrease_ref_count(cm->ref_frame_map[i], pool);
+    cm->ref_frame_map[i] = state->ref_frame_map[i];
+    if (cm->ref_frame_map[i] != NULL) ++cm->ref_frame_map[i]->ref_count;
+  }
+  unlock_buffer_pool(pool);
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(sync->mutex_);
+#endif
+
+  for (int i = 0; i < INTER_REFS_PER_FRAME; ++i)
+    cm->remapped_ref_idx[i] = INVALID_IDX;
+  pbi->state_published = 0;
+}
@@ -15,6 +15,7 @@
 #include "config/aom_config.h"
 
 #include "aom/internal/aom_codec_internal.h"
+#include "aom_util/aom_pthread.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -22,6 +23,9 @@ extern "C" {
 
 struct AV1Common;
 struct AV1Decoder;
+struct AV1DecPersistentState;
+struct BufferPool;
+struct RefCntBuffer;
 struct ThreadData;
 
 typedef struct DecWorkerData {
@@ -41,8 +45,58 @@ typedef struct FrameWorkerData {
   int received_frame;
   int frame_context_ready;  // Current frame's context is ready to read.
   int frame_decoded;        // Finished decoding current frame.
+  // Copy of the temporal unit in frame parallel mode, where the worker may
+  // still be decoding after aom_codec_decode() returns.
+  uint8_t *scratch_buffer;
+  size_t scratch_buffer_size;
 } FrameWorkerData;
 
+// Synchronization shared by the frame workers in frame parallel mode. Each
+// frame worker decodes one temporal unit. The decoder state that carries over
+// from one temporal unit to the next (reference map, sequence header, frame
+// ids, ...) is handed from worker to worker through 'state'. Reference frames
+// produced by other workers are waited for through the per frame buffer
+// 'frame_done' flags.
+typedef struct AV1FrameSync {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t *mutex_;
+  pthread_cond_t *cond_;
+#endif
+  struct BufferPool *pool;
+  // Indexed by the position of the frame buffer in pool->frame_bufs. Set to 0
+  // while the frame is being decoded, to 1 once it is complete and to -1 if
+  // it failed to decode.
+  int *frame_done;
+  // Decoder state as of the end of the frame headers of temporal unit
+  // 'state_tu'. Holds a reference on each buffer in its reference map.
+  struct AV1DecPersistentState *state;
+  unsigned int state_tu;
+} AV1FrameSync;
+
+// Allocates 'sync' for the frame buffers of 'pool'. Returns 0 on success.
+int av1_frame_sync_alloc(AV1FrameSync *sync, struct BufferPool *pool);
+// Releases the references held by the shared state and frees 'sync'.
+void av1_frame_sync_dealloc(AV1FrameSync *sync);
+
+// Marks 'buf' as being decoded / done decoding.
+void av1_frame_sync_start_frame(AV1FrameSync *sync,
+                                const struct RefCntBuffer *buf);
+void av1_frame_sync_finish_frame(AV1FrameSync *sync,
+                                 const struct RefCntBuffer *buf, int failed);
+// Blocks until 'buf' is done decoding. Returns -1 if it failed to decode, 0
+// otherwise.
+int av1_frame_sync_wait_frame(AV1FrameSync *sync,
+                              const struct RefCntBuffer *buf);
+
+// Stores the decoder state of 'pbi' as the state left by temporal unit
+// pbi->frame_sync_tu. If 'frame_in_progress' is set, the reference map and
+// frame counters are updated as if the current frame had been decoded.
+void av1_frame_sync_publish_state(struct AV1Decoder *pbi,
+                                  int frame_in_progress);
+// Blocks until the state left by the previous temporal unit is published and
+// loads it into 'pbi'.
+void av1_frame_sync_inherit_state(struct AV1Decoder *pbi);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -19,6 +19,9 @@
 #include <string.h>
 #include <stdlib.h>
 #include <assert.h>
+
+#include "config/av1_rtcd.h"
+
 #include "aom_dsp/aom_dsp_common.h"
 #include "aom_mem/aom_mem.h"
 #include "av1/decoder/grain_synthesis.h"
@@ -218,11 +221,8 @@ static const int gaussian_sequence[2048] = {
 
 static const int gauss_bits = 11;
 
-static int luma_subblock_size_y = 32;
-static int luma_subblock_size_x = 32;
-
-static int chroma_subblock_size_y = 16;
-static int chroma_subblock_size_x = 16;
+static const int luma_subblock_size_y = 32;
+static const int luma_subblock_size_x = 32;
 
 static const int min_luma_legal_range = 16;
 static const int max_luma_legal_range = 235;
@@ -230,21 +230,75 @@ static const int max_luma_legal_range = 235;
 static const int min_chroma_legal_range = 16;
 static const int max_chroma_legal_range = 240;
 
-static int scaling_lut_y[256];
-static int scaling_lut_cb[256];
-static int scaling_lut_cr[256];
+// Grain templates, scaling functions and blending parameters of a frame. They
+// are shared by all the threads adding grain to the frame and stay unchanged
+// while the grain is added.
+typedef struct {
+  const aom_film_grain_t *params;
+
+  uint8_t *luma;
+  uint8_t *cb;
+  uint8_t *cr;
+  int height;
+  int width;
+  int luma_stride;
+  int chroma_stride;
+  int use_high_bit_depth;
+  int chroma_subsamp_y;
+  int chroma_subsamp_x;
+  int chroma_subblock_size_y;
+  int chroma_subblock_size_x;
+
+  int left_pad;
+  int top_pad;
+  int ar_padding;
 
-static int grain_min;
-static int grain_max;
+  int *luma_grain_block;
+  int *cb_grain_block;
+  int *cr_grain_block;
+  int luma_grain_stride;
+  int chroma_grain_stride;
+
+  // Scaling functions, indexed by sample values at the frame bit depth.
+  int *scaling_lut_y;
+  int *scaling_lut_cb;
+  int *scaling_lut_cr;
+
+  int cb_mult;
+  int cb_luma_mult;
+  int cb_offset;
+  int cr_mult;
+  int cr_luma_mult;
+  int cr_offset;
+
+  int min_luma;
+  int max_luma;
+  int min_chroma;
+  int max_chroma;
+
+  int apply_y;
+  int apply_cb;
+  int apply_cr;
+
+  int grain_min;
+  int grain_max;
+} GrainFrame;
+
+// Grain of the block row above and of the block to the left, kept to blend
+// it with the grain of the current block where they overlap. Each thread has
+// its own.
+typedef struct {
+  int *y_line_buf;
+  int *cb_line_buf;
+  int *cr_line_buf;
 
-static uint16_t random_register = 0;  // random number generator register
+  int *y_col_buf;
+  int *cb_col_buf;
+  int *cr_col_buf;
+} GrainOverlapBuffers;
 
 static void dealloc_arrays(const aom_film_grain_t *params, int ***pred_pos_luma,
-                           int ***pred_pos_chroma, int **luma_grain_block,
-                           int **cb_grain_block, int **cr_grain_block,
-                           int **y_line_buf, int **cb_line_buf,
-                           int **cr_line_buf, int **y_col_buf, int **cb_col_buf,
-                           int **cr_col_buf) {
+                           int ***pred_pos_chroma, GrainFrame *fg) {
   int num_pos_luma = 2 * params->ar_coeff_lag * (params->ar_coeff_lag + 1);
   int num_pos_chroma = num_pos_luma;
   if (params->num_y_points > 0) ++num_pos_chroma;
@@ -265,57 +319,37 @@ static void dealloc_arrays(const aom_film_grain_t *params, int ***pred_pos_luma,
     *pred_pos_chroma = NULL;
   }
 
-  aom_free(*y_line_buf);
-  *y_line_buf = NULL;
-
-  aom_free(*cb_line_buf);
-  *cb_line_buf = NULL;
-
-  aom_free(*cr_line_buf);
-  *cr_line_buf = NULL;
-
-  aom_free(*y_col_buf);
-  *y_col_buf = NULL;
+  aom_free(fg->luma_grain_block);
+  fg->luma_grain_block = NULL;
 
-  aom_free(*cb_col_buf);
-  *cb_col_buf = NULL;
+  aom_free(fg->cb_grain_block);
+  fg->cb_grain_block = NULL;
 
-  aom_free(*cr_col_buf);
-  *cr_col_buf = NULL;
+  aom_free(fg->cr_grain_block);
+  fg->cr_grain_block = NULL;
 
-  aom_free(*luma_grain_block);
-  *luma_grain_block = NULL;
+  aom_free(fg->scaling_lut_y);
+  fg->scaling_lut_y = NULL;
 
-  aom_free(*cb_grain_block);
-  *cb_grain_block = NULL;
+  aom_free(fg->scaling_lut_cb);
+  fg->scaling_lut_cb = NULL;
 
-  aom_free(*cr_grain_block);
-  *cr_grain_block = NULL;
+  aom_free(fg->scaling_lut_cr);
+  fg->scaling_lut_cr = NULL;
 }
 
-static bool init_arrays(const aom_film_grain_t *params, int luma_stride,
-                        int chroma_stride, int ***pred_pos_luma_p,
-                        int ***pred_pos_chroma_p, int **luma_grain_block,
-                        int **cb_grain_block, int **cr_grain_block,
-                        int **y_line_buf, int **cb_line_buf, int **cr_line_buf,
-                        int **y_col_buf, int **cb_col_buf, int **cr_col_buf,
-                        int luma_grain_samples, int chroma_grain_samples,
-                        int chroma_subsamp_y, int chroma_subsamp_x) {
+static bool init_arrays(const aom_film_grain_t *params,
+                        int ***pred_pos_luma_p, int ***pred_pos_chroma_p,
+                        GrainFrame *fg, int luma_grain_samples,
+                        int chroma_grain_samples, int scaling_lut_size) {
   *pred_pos_luma_p = NULL;
   *pred_pos_chroma_p = NULL;
-  *luma_grain_block = NULL;
-  *cb_grain_block = NULL;
-  *cr_grain_block = NULL;
-  *y_line_buf = NULL;
-  *cb_line_buf = NULL;
-  *cr_line_buf = NULL;
-  *y_col_buf = NULL;
-  *cb_col_buf = NULL;
-  *cr_col_buf = NULL;
-
-  memset(scaling_lut_y, 0, sizeof(*scaling_lut_y) * 256);
-  memset(scaling_lut_cb, 0, sizeof(*scaling_lut_cb) * 256);
-  memset(scaling_lut_cr, 0, sizeof(*scaling_lut_cr) * 256);
+  fg->luma_grain_block = NULL;
+  fg->cb_grain_block = NULL;
+  fg->cr_grain_block = NULL;
+  fg->scaling_lut_y = NULL;
+  fg->scaling_lut_cb = NULL;
+  fg->scaling_lut_cr = NULL;
 
   int num_pos_luma = 2 * params->ar_coeff_lag * (params->ar_coeff_lag + 1);
   int num_pos_chroma = num_pos_luma;
@@ -326,14 +360,12 @@ static bool init_arrays(const aom_film_grain_t *params, int luma_stride,
 
   pred_pos_luma = (int **)aom_calloc(num_pos_luma, sizeof(*pred_pos_luma));
   if (!pred_pos_luma) return false;
+  *pred_pos_luma_p = pred_pos_luma;
 
   for (int row = 0; row < num_pos_luma; row++) {
     pred_pos_luma[row] = (int *)aom_malloc(sizeof(**pred_pos_luma) * 3);
     if (!pred_pos_luma[row]) {
-      dealloc_arrays(params, pred_pos_luma_p, pred_pos_chroma_p,
-                     luma_grain_block, cb_grain_block, cr_grain_block,
-                     y_line_buf, cb_line_buf, cr_line_buf, y_col_buf,
-                     cb_col_buf, cr_col_buf);
+      dealloc_arrays(params, pred_pos_luma_p, pred_pos_chroma_p, fg);
       return false;
     }
   }
@@ -341,19 +373,15 @@ static bool init_arrays(const aom_film_grain_t *params, int luma_stride,
   pred_pos_chroma =
       (int **)aom_calloc(num_pos_chroma, sizeof(*pred_pos_chroma));
   if (!pred_pos_chroma) {
-    dealloc_arrays(params, pred_pos_luma_p, pred_pos_chroma_p, luma_grain_block,
-                   cb_grain_block, cr_grain_block, y_line_buf, cb_line_buf,
-                   cr_line_buf, y_col_buf, cb_col_buf, cr_col_buf);
+    dealloc_arrays(params, pred_pos_luma_p, pred_pos_chroma_p, fg);
     return false;
   }
+  *pred_pos_chroma_p = pred_pos_chroma;
 
   for (int row = 0; row < num_pos_chroma; row++) {
     pred_pos_chroma[row] = (int *)aom_malloc(sizeof(**pred_pos_chroma) * 3);
     if (!pred_pos_chroma[row]) {
-      dealloc_arrays(params, pred_pos_luma_p, pred_pos_chroma_p,
-                     luma_grain_block, cb_grain_block, cr_grain_block,
-                     y_line_buf, cb_line_buf, cr_line_buf, y_col_buf,
-                     cb_col_buf, cr_col_buf);
+      dealloc_arrays(params, pred_pos_luma_p, pred_pos_chroma_p, fg);
       return false;
     }
   }
@@ -392,72 +420,112 @@ static bool init_arrays(const aom_film_grain_t *params, int luma_stride,
     pred_pos_chroma[pos_ar_index][2] = 1;
   }
 
-  *pred_pos_luma_p = pred_pos_luma;
-  *pred_pos_chroma_p = pred_pos_chroma;
+  fg->luma_grain_block =
+      (int *)aom_malloc(sizeof(*fg->luma_grain_block) * luma_grain_samples);
+  fg->cb_grain_block =
+      (int *)aom_malloc(sizeof(*fg->cb_grain_block) * chroma_grain_samples);
+  fg->cr_grain_block =
+      (int *)aom_malloc(sizeof(*fg->cr_grain_block) * chroma_grain_samples);
+
+  fg->scaling_lut_y =
+      (int *)aom_calloc(scaling_lut_size, sizeof(*fg->scaling_lut_y));
+  fg->scaling_lut_cb =
+      (int *)aom_calloc(scaling_lut_size, sizeof(*fg->scaling_lut_cb));
+  fg->scaling_lut_cr =
+      (int *)aom_calloc(scaling_lut_size, sizeof(*fg->scaling_lut_cr));
+  if (!(fg->luma_grain_block && fg->cb_grain_block && fg->cr_grain_block &&
+        fg->scaling_lut_y && fg->scaling_lut_cb && fg->scaling_lut_cr)) {
+    dealloc_arrays(params, pred_pos_luma_p, pred_pos_chroma_p, fg);
+    return false;
+  }
+  return true;
+}
+
+static void dealloc_overlap_buffers(GrainOverlapBuffers *bufs) {
+  aom_free(bufs->y_line_buf);
+  bufs->y_line_buf = NULL;
 
-  *y_line_buf = (int *)aom_malloc(sizeof(**y_line_buf) * luma_stride * 2);
-  *cb_line_buf = (int *)aom_malloc(sizeof(**cb_line_buf) * chroma_stride *
-                                   (2 >> chroma_subsamp_y));
-  *cr_line_buf = (int *)aom_malloc(sizeof(**cr_line_buf) * chroma_stride *
-                                   (2 >> chroma_subsamp_y));
-
-  *y_col_buf =
-      (int *)aom_malloc(sizeof(**y_col_buf) * (luma_subblock_size_y + 2) * 2);
-  *cb_col_buf =
-      (int *)aom_malloc(sizeof(**cb_col_buf) *
-                        (chroma_subblock_size_y + (2 >> chroma_subsamp_y)) *
+  aom_free(bufs->cb_line_buf);
+  bufs->cb_line_buf = NULL;
+
+  aom_free(bufs->cr_line_buf);
+  bufs->cr_line_buf = NULL;
+
+  aom_free(bufs->y_col_buf);
+  bufs->y_col_buf = NULL;
+
+  aom_free(bufs->cb_col_buf);
+  bufs->cb_col_buf = NULL;
+
+  aom_free(bufs->cr_col_buf);
+  bufs->cr_col_buf = NULL;
+}
+
+static bool init_overlap_buffers(GrainOverlapBuffers *bufs,
+                                 const GrainFrame *fg) {
+  const int chroma_subsamp_y = fg->chroma_subsamp_y;
+  const int chroma_subsamp_x = fg->chroma_subsamp_x;
+
+  bufs->y_line_buf =
+      (int *)aom_malloc(sizeof(*bufs->y_line_buf) * fg->luma_stride * 2);
+  bufs->cb_line_buf =
+      (int *)aom_malloc(sizeof(*bufs->cb_line_buf) * fg->chroma_stride *
+                        (2 >> chroma_subsamp_y));
+  bufs->cr_line_buf =
+      (int *)aom_malloc(sizeof(*bufs->cr_line_buf) * fg->chroma_stride *
+                        (2 >> chroma_subsamp_y));
+
+  bufs->y_col_buf = (int *)aom_malloc(sizeof(*bufs->y_col_buf) *
+                                      (luma_subblock_size_y + 2) * 2);
+  bufs->cb_col_buf =
+      (int *)aom_malloc(sizeof(*bufs->cb_col_buf) *
+                        (fg->chroma_subblock_size_y + (2 >> chroma_subsamp_y)) *
                         (2 >> chroma_subsamp_x));
-  *cr_col_buf =
-      (int *)aom_malloc(sizeof(**cr_col_buf) *
-                        (chroma_subblock_size_y + (2 >> chroma_subsamp_y)) *
+  bufs->cr_col_buf =
+      (int *)aom_malloc(sizeof(*bufs->cr_col_buf) *
+                        (fg->chroma_subblock_size_y + (2 >> chroma_subsamp_y)) *
                         (2 >> chroma_subsamp_x));
-
-  *luma_grain_block =
-      (int *)aom_malloc(sizeof(**luma_grain_block) * luma_grain_samples);
-  *cb_grain_block =
-      (int *)aom_malloc(sizeof(**cb_grain_block) * chroma_grain_samples);
-  *cr_grain_block =
-      (int *)aom_malloc(sizeof(**cr_grain_block) * chroma_grain_samples);
-  if (!(*pred_pos_luma_p && *pred_pos_chroma_p && *y_line_buf && *cb_line_buf &&
-        *cr_line_buf && *y_col_buf && *cb_col_buf && *cr_col_buf &&
-        *luma_grain_block && *cb_grain_block && *cr_grain_block)) {
-    dealloc_arrays(params, pred_pos_luma_p, pred_pos_chroma_p, luma_grain_block,
-                   cb_grain_block, cr_grain_block, y_line_buf, cb_line_buf,
-                   cr_line_buf, y_col_buf, cb_col_buf, cr_col_buf);
+  if (!(bufs->y_line_buf && bufs->cb_line_buf && bufs->cr_line_buf &&
+        bufs->y_col_buf && bufs->cb_col_buf && bufs->cr_col_buf)) {
+    dealloc_overlap_buffers(bufs);
     return false;
   }
   return true;
 }
 
 // get a number between 0 and 2^bits - 1
-static inline int get_random_number(int bits) {
+static inline int get_random_number(uint16_t *random_register, int bits) {
   uint16_t bit;
-  bit = ((random_register >> 0) ^ (random_register >> 1) ^
-         (random_register >> 3) ^ (random_register >> 12)) &
+  bit = ((*random_register >> 0) ^ (*random_register >> 1) ^
+         (*random_register >> 3) ^ (*random_register >> 12)) &
         1;
-  random_register = (random_register >> 1) | (bit << 15);
-  return (random_register >> (16 - bits)) & ((1 << bits) - 1);
+  *random_register = (*random_register >> 1) | (bit << 15);
+  return (*random_register >> (16 - bits)) & ((1 << bits) - 1);
 }
 
-static void init_random_generator(int luma_line, uint16_t seed) {
+// Returns the state of the random number generator at the start of a row of
+// blocks.
+static uint16_t init_random_generator(int luma_line, uint16_t seed) {
   // same for the picture
 
   uint16_t msb = (seed >> 8) & 255;
   uint16_t lsb = seed & 255;
 
-  random_register = (msb << 8) + lsb;
+  uint16_t random_register = (msb << 8) + lsb;
 
   //  changes for each row
   int luma_num = luma_line >> 5;
 
   random_register ^= ((luma_num * 37 + 178) & 255) << 8;
   random_register ^= ((luma_num * 173 + 105) & 255);
+  return random_register;
 }
 
 static void generate_luma_grain_block(
     const aom_film_grain_t *params, int **pred_pos_luma, int *luma_grain_block,
-    int luma_block_size_y, int luma_block_size_x, int luma_grain_stride,
-    int left_pad, int top_pad, int right_pad, int bottom_pad) {
+    uint16_t *random_register, int luma_block_size_y, int luma_block_size_x,
+    int luma_grain_stride, int left_pad, int top_pad, int right_pad,
+    int bottom_pad, int grain_min, int grain_max) {
   if (params->num_y_points == 0) {
     memset(luma_grain_block, 0,
            sizeof(*luma_grain_block) * luma_block_size_y * luma_grain_stride);
@@ -473,7 +541,7 @@ static void generate_luma_grain_block(
   for (int i = 0; i < luma_block_size_y; i++)
     for (int j = 0; j < luma_block_size_x; j++)
       luma_grain_block[i * luma_grain_stride + j] =
-          (gaussian_sequence[get_random_number(gauss_bits)] +
+          (gaussian_sequence[get_random_number(random_register, gauss_bits)] +
            ((1 << gauss_sec_shift) >> 1)) >>
           gauss_sec_shift;
 
@@ -498,7 +566,8 @@ static bool generate_chroma_grain_blocks(
     int *luma_grain_block, int *cb_grain_block, int *cr_grain_block,
     int luma_grain_stride, int chroma_block_size_y, int chroma_block_size_x,
     int chroma_grain_stride, int left_pad, int top_pad, int right_pad,
-    int bottom_pad, int chroma_subsamp_y, int chroma_subsamp_x) {
+    int bottom_pad, int chroma_subsamp_y, int chroma_subsamp_x, int grain_min,
+    int grain_max) {
   int bit_depth = params->bit_depth;
   int gauss_sec_shift = 12 - bit_depth + params->grain_scale_shift;
 
@@ -508,12 +577,14 @@ static bool generate_chroma_grain_blocks(
   int chroma_grain_block_size = chroma_block_size_y * chroma_grain_stride;
 
   if (params->num_cb_points || params->chroma_scaling_from_luma) {
-    init_random_generator(7 << 5, params->random_seed);
+    uint16_t random_register =
+        init_random_generator(7 << 5, params->random_seed);
 
     for (int i = 0; i < chroma_block_size_y; i++)
       for (int j = 0; j < chroma_block_size_x; j++)
         cb_grain_block[i * chroma_grain_stride + j] =
-            (gaussian_sequence[get_random_number(gauss_bits)] +
+            (gaussian_sequence[get_random_number(&random_register,
+                                                 gauss_bits)] +
              ((1 << gauss_sec_shift) >> 1)) >>
             gauss_sec_shift;
   } else {
@@ -522,12 +593,14 @@ static bool generate_chroma_grain_blocks(
   }
 
   if (params->num_cr_points || params->chroma_scaling_from_luma) {
-    init_random_generator(11 << 5, params->random_seed);
+    uint16_t random_register =
+        init_random_generator(11 << 5, params->random_seed);
 
     for (int i = 0; i < chroma_block_size_y; i++)
       for (int j = 0; j < chroma_block_size_x; j++)
         cr_grain_block[i * chroma_grain_stride + j] =
-            (gaussian_sequence[get_random_number(gauss_bits)] +
+            (gaussian_sequence[get_random_number(&random_register,
+                                                 gauss_bits)] +
              ((1 << gauss_sec_shift) >> 1)) >>
             gauss_sec_shift;
   } else {
@@ -613,7 +686,7 @@ static void init_scaling_function(const int scaling_points[][2], int num_points,
 
 // function that extracts samples from a LUT (and interpolates intemediate
 // frames for 10- and 12-bit video)
-static int scale_LUT(int *scaling_lut, int index, int bit_depth) {
+static int scale_LUT(const int *scaling_lut, int index, int bit_depth) {
   int x = index >> (bit_depth - 8);
 
   if (!(bit_depth - 8) || x == 255)
@@ -625,234 +698,184 @@ static int scale_LUT(int *scaling_lut, int index, int bit_depth) {
                              (bit_depth - 8));
 }
 
-static void add_noise_to_block(const aom_film_grain_t *params, uint8_t *luma,
-                               uint8_t *cb, uint8_t *cr, int luma_stride,
-                               int chroma_stride, int *luma_grain,
-                               int *cb_grain, int *cr_grain,
-                               int luma_grain_stride, int chroma_grain_stride,
-                               int half_luma_height, int half_luma_width,
-                               int bit_depth, int chroma_subsamp_y,
-                               int chroma_subsamp_x, int mc_identity) {
-  int cb_mult = params->cb_mult - 128;            // fixed scale
-  int cb_luma_mult = params->cb_luma_mult - 128;  // fixed scale
-  int cb_offset = params->cb_offset - 256;
-
-  int cr_mult = params->cr_mult - 128;            // fixed scale
-  int cr_luma_mult = params->cr_luma_mult - 128;  // fixed scale
-  int cr_offset = params->cr_offset - 256;
-
-  int rounding_offset = (1 << (params->scaling_shift - 1));
-
-  int apply_y = params->num_y_points > 0 ? 1 : 0;
-  int apply_cb =
-      (params->num_cb_points > 0 || params->chroma_scaling_from_luma) ? 1 : 0;
-  int apply_cr =
-      (params->num_cr_points > 0 || params->chroma_scaling_from_luma) ? 1 : 0;
-
-  if (params->chroma_scaling_from_luma) {
-    cb_mult = 0;        // fixed scale
-    cb_luma_mult = 64;  // fixed scale
-    cb_offset = 0;
-
-    cr_mult = 0;        // fixed scale
-    cr_luma_mult = 64;  // fixed scale
-    cr_offset = 0;
-  }
-
-  int min_luma, max_luma, min_chroma, max_chroma;
-
-  if (params->clip_to_restricted_range) {
-    min_luma = min_luma_legal_range;
-    max_luma = max_luma_legal_range;
+// Builds the scaling function of a component for every sample value at
+// bit_depth, so that adding grain only needs a table lookup per sample.
+static void init_scaling_lut(const int scaling_points[][2], int num_points,
+                             int bit_depth, int *scaling_lut) {
+  int lut_8bit[256] = { 0 };
+  init_scaling_function(scaling_points, num_points, lut_8bit);
+  for (int i = 0; i < (256 << (bit_depth - 8)); i++)
+    scaling_lut[i] = scale_LUT(lut_8bit, i, bit_depth);
+}
 
-    if (mc_identity) {
-      min_chroma = min_luma_legal_range;
-      max_chroma = max_luma_legal_range;
-    } else {
-      min_chroma = min_chroma_legal_range;
-      max_chroma = max_chroma_legal_range;
+void av1_add_film_grain_luma_c(uint8_t *luma, int luma_stride,
+                               const int *grain, int grain_stride, int width,
+                               int height, const int *scaling_lut,
+                               int scaling_shift, int min_val, int max_val) {
+  const int rounding_offset = (1 << (scaling_shift - 1));
+  for (int i = 0; i < height; i++) {
+    for (int j = 0; j < width; j++) {
+      const int pixel = luma[i * luma_stride + j];
+      luma[i * luma_stride + j] =
+          clamp(pixel + ((scaling_lut[pixel] * grain[i * grain_stride + j] +
+                          rounding_offset) >>
+                         scaling_shift),
+                min_val, max_val);
     }
-  } else {
-    min_luma = min_chroma = 0;
-    max_luma = max_chroma = 255;
   }
+}
 
-  for (int i = 0; i < (half_luma_height << (1 - chroma_subsamp_y)); i++) {
-    for (int j = 0; j < (half_luma_width << (1 - chroma_subsamp_x)); j++) {
+void av1_add_film_grain_chroma_c(uint8_t *chroma, int chroma_stride,
+                                 const uint8_t *luma, int luma_stride,
+                                 const int *grain, int grain_stride, int width,
+                                 int height, int subsampling_x,
+                                 int subsampling_y, const int *scaling_lut,
+                                 int luma_mult, int chroma_mult, int offset,
+                                 int scaling_shift, int min_val, int max_val) {
+  const int rounding_offset = (1 << (scaling_shift - 1));
+  for (int i = 0; i < height; i++) {
+    const uint8_t *luma_row = luma + (i << subsampling_y) * luma_stride;
+    for (int j = 0; j < width; j++) {
       int average_luma = 0;
-      if (chroma_subsamp_x) {
-        average_luma = (luma[(i << chroma_subsamp_y) * luma_stride +
-                             (j << chroma_subsamp_x)] +
-                        luma[(i << chroma_subsamp_y) * luma_stride +
-                             (j << chroma_subsamp_x) + 1] +
-                        1) >>
-                       1;
+      if (subsampling_x) {
+        average_luma = (luma_row[j << 1] + luma_row[(j << 1) + 1] + 1) >> 1;
       } else {
-        average_luma = luma[(i << chroma_subsamp_y) * luma_stride + j];
-      }
-
-      if (apply_cb) {
-        cb[i * chroma_stride + j] = clamp(
-            cb[i * chroma_stride + j] +
-                ((scale_LUT(scaling_lut_cb,
-                            clamp(((average_luma * cb_luma_mult +
-                                    cb_mult * cb[i * chroma_stride + j]) >>
-                                   6) +
-                                      cb_offset,
-                                  0, (256 << (bit_depth - 8)) - 1),
-                            8) *
-                      cb_grain[i * chroma_grain_stride + j] +
-                  rounding_offset) >>
-                 params->scaling_shift),
-            min_chroma, max_chroma);
-      }
-
-      if (apply_cr) {
-        cr[i * chroma_stride + j] = clamp(
-            cr[i * chroma_stride + j] +
-                ((scale_LUT(scaling_lut_cr,
-                            clamp(((average_luma * cr_luma_mult +
-                                    cr_mult * cr[i * chroma_stride + j]) >>
-                                   6) +
-                                      cr_offset,
-                                  0, (256 << (bit_depth - 8)) - 1),
-                            8) *
-                      cr_grain[i * chroma_grain_stride + j] +
-                  rounding_offset) >>
-                 params->scaling_shift),
-            min_chroma, max_chroma);
-      }
-    }
-  }
-
-  if (apply_y) {
-    for (int i = 0; i < (half_luma_height << 1); i++) {
-      for (int j = 0; j < (half_luma_width << 1); j++) {
-        luma[i * luma_stride + j] =
-            clamp(luma[i * luma_stride + j] +
-                      ((scale_LUT(scaling_lut_y, luma[i * luma_stride + j], 8) *
-                            luma_grain[i * luma_grain_stride + j] +
-                        rounding_offset) >>
-                       params->scaling_shift),
-                  min_luma, max_luma);
+        average_luma = luma_row[j];
       }
+      const int pixel = chroma[i * chroma_stride + j];
+      const int index = clamp(
+          ((average_luma * luma_mult + chroma_mult * pixel) >> 6) + offset, 0,
+          255);
+      chroma[i * chroma_stride + j] =
+          clamp(pixel + ((scaling_lut[index] * grain[i * grain_stride + j] +
+                          rounding_offset) >>
+                         scaling_shift),
+                min_val, max_val);
     }
   }
 }
 
-static void add_noise_to_block_hbd(
-    const aom_film_grain_t *params, uint16_t *luma, uint16_t *cb, uint16_t *cr,
-    int luma_stride, int chroma_stride, int *luma_grain, int *cb_grain,
-    int *cr_grain, int luma_grain_stride, int chroma_grain_stride,
-    int half_luma_height, int half_luma_width, int bit_depth,
-    int chroma_subsamp_y, int chroma_subsamp_x, int mc_identity) {
-  int cb_mult = params->cb_mult - 128;            // fixed scale
-  int cb_luma_mult = params->cb_luma_mult - 128;  // fixed scale
-  // offset value depends on the bit depth
-  int cb_offset = (params->cb_offset << (bit_depth - 8)) - (1 << bit_depth);
-
-  int cr_mult = params->cr_mult - 128;            // fixed scale
-  int cr_luma_mult = params->cr_luma_mult - 128;  // fixed scale
-  // offset value depends on the bit depth
-  int cr_offset = (params->cr_offset << (bit_depth - 8)) - (1 << bit_depth);
-
-  int rounding_offset = (1 << (params->scaling_shift - 1));
-
-  int apply_y = params->num_y_points > 0 ? 1 : 0;
-  int apply_cb =
-      (params->num_cb_points > 0 || params->chroma_scaling_from_luma) > 0 ? 1
-                                                                          : 0;
-  int apply_cr =
-      (params->num_cr_points > 0 || params->chroma_scaling_from_luma) > 0 ? 1
-                                                                          : 0;
-
-  if (params->chroma_scaling_from_luma) {
-    cb_mult = 0;        // fixed scale
-    cb_luma_mult = 64;  // fixed scale
-    cb_offset = 0;
-
-    cr_mult = 0;        // fixed scale
-    cr_luma_mult = 64;  // fixed scale
-    cr_offset = 0;
-  }
-
-  int min_luma, max_luma, min_chroma, max_chroma;
-
-  if (params->clip_to_restricted_range) {
-    min_luma = min_luma_legal_range << (bit_depth - 8);
-    max_luma = max_luma_legal_range << (bit_depth - 8);
-
-    if (mc_identity) {
-      min_chroma = min_luma_legal_range << (bit_depth - 8);
-      max_chroma = max_luma_legal_range << (bit_depth - 8);
-    } else {
-      min_chroma = min_chroma_legal_range << (bit_depth - 8);
-      max_chroma = max_chroma_legal_range << (bit_depth - 8);
+void av1_highbd_add_film_grain_luma_c(uint16_t *luma, int luma_stride,
+                                      const int *grain, int grain_stride,
+                                      int width, int height,
+                                      const int *scaling_lut,
+                                      int scaling_shift, int min_val,
+                                      int max_val) {
+  const int rounding_offset = (1 << (scaling_shift - 1));
+  for (int i = 0; i < height; i++) {
+    for (int j = 0; j < width; j++) {
+      const int pixel = luma[i * luma_stride + j];
+      luma[i * luma_stride + j] =
+          clamp(pixel + ((scaling_lut[pixel] * grain[i * grain_stride + j] +
+                          rounding_offset) >>
+                         scaling_shift),
+                min_val, max_val);
     }
-  } else {
-    min_luma = min_chroma = 0;
-    max_luma = max_chroma = (256 << (bit_depth - 8)) - 1;
   }
+}
 
-  for (int i = 0; i < (half_luma_height << (1 - chroma_subsamp_y)); i++) {
-    for (int j = 0; j < (half_luma_width << (1 - chroma_subsamp_x)); j++) {
+void av1_highbd_add_film_grain_chroma_c(
+    uint16_t *chroma, int chroma_stride, const uint16_t *luma, int luma_stride,
+    const int *grain, int grain_stride, int width, int height,
+    int subsampling_x, int subsampling_y, const int *scaling_lut,
+    int luma_mult, int chroma_mult, int offset, int scaling_shift,
+    int min_val, int max_val, int bd) {
+  const int rounding_offset = (1 << (scaling_shift - 1));
+  const int max_index = (256 << (bd - 8)) - 1;
+  for (int i = 0; i < height; i++) {
+    const uint16_t *luma_row = luma + (i << subsampling_y) * luma_stride;
+    for (int j = 0; j < width; j++) {
       int average_luma = 0;
-      if (chroma_subsamp_x) {
-        average_luma = (luma[(i << chroma_subsamp_y) * luma_stride +
-                             (j << chroma_subsamp_x)] +
-                        luma[(i << chroma_subsamp_y) * luma_stride +
-                             (j << chroma_subsamp_x) + 1] +
-                        1) >>
-                       1;
+      if (subsampling_x) {
+        average_luma = (luma_row[j << 1] + luma_row[(j << 1) + 1] + 1) >> 1;
       } else {
-        average_luma = luma[(i << chroma_subsamp_y) * luma_stride + j];
-      }
-
-      if (apply_cb) {
-        cb[i * chroma_stride + j] = clamp(
-            cb[i * chroma_stride + j] +
-                ((scale_LUT(scaling_lut_cb,
-                            clamp(((average_luma * cb_luma_mult +
-                                    cb_mult * cb[i * chroma_stride + j]) >>
-                                   6) +
-                                      cb_offset,
-                                  0, (256 << (bit_depth - 8)) - 1),
-                            bit_depth) *
-                      cb_grain[i * chroma_grain_stride + j] +
-                  rounding_offset) >>
-                 params->scaling_shift),
-            min_chroma, max_chroma);
-      }
-      if (apply_cr) {
-        cr[i * chroma_stride + j] = clamp(
-            cr[i * chroma_stride + j] +
-                ((scale_LUT(scaling_lut_cr,
-                            clamp(((average_luma * cr_luma_mult +
-                                    cr_mult * cr[i * chroma_stride + j]) >>
-                                   6) +
-                                      cr_offset,
-                                  0, (256 << (bit_depth - 8)) - 1),
-                            bit_depth) *
-                      cr_grain[i * chroma_grain_stride + j] +
-                  rounding_offset) >>
-                 params->scaling_shift),
-            min_chroma, max_chroma);
+        average_luma = luma_row[j];
       }
+      const int pixel = chroma[i * chroma_stride + j];
+      const int index = clamp(
+          ((average_luma * luma_mult + chroma_mult * pixel) >> 6) + offset, 0,
+          max_index);
+      chroma[i * chroma_stride + j] =
+          clamp(pixel + ((scaling_lut[index] * grain[i * grain_stride + j] +
+                          rounding_offset) >>
+                         scaling_shift),
+                min_val, max_val);
     }
   }
+}
 
-  if (apply_y) {
-    for (int i = 0; i < (half_luma_height << 1); i++) {
-      for (int j = 0; j < (half_luma_width << 1); j++) {
-        luma[i * luma_stride + j] =
-            clamp(luma[i * luma_stride + j] +
-                      ((scale_LUT(scaling_lut_y, luma[i * luma_stride + j],
-                                  bit_depth) *
-                            luma_grain[i * luma_grain_stride + j] +
-                        rounding_offset) >>
-                       params->scaling_shift),
-                  min_luma, max_luma);
-      }
+// Adds grain to the block at luma position (half_row << 1, half_col << 1) of
+// (half_luma_height << 1) x (half_luma_width << 1) samples, and to the
+// co-located chroma blocks.
+static void add_noise_to_block(const GrainFrame *fg, int half_row,
+                               int half_col, const int *luma_grain,
+                               const int *cb_grain, const int *cr_grain,
+                               int luma_grain_stride, int chroma_grain_stride,
+                               int half_luma_height, int half_luma_width) {
+  const aom_film_grain_t *params = fg->params;
+  const int chroma_subsamp_y = fg->chroma_subsamp_y;
+  const int chroma_subsamp_x = fg->chroma_subsamp_x;
+  const int luma_stride = fg->luma_stride;
+  const int chroma_stride = fg->chroma_stride;
+  const int luma_offset = (half_row << 1) * luma_stride + (half_col << 1);
+  const int chroma_offset =
+      (half_row << (1 - chroma_subsamp_y)) * chroma_stride +
+      (half_col << (1 - chroma_subsamp_x));
+  const int chroma_height = half_luma_height << (1 - chroma_subsamp_y);
+  const int chroma_width = half_luma_width << (1 - chroma_subsamp_x);
+
+  // The chroma grain is scaled according to the luma before grain is added
+  // to it.
+  if (fg->use_high_bit_depth) {
+    uint16_t *luma = (uint16_t *)fg->luma + luma_offset;
+    uint16_t *cb = (uint16_t *)fg->cb + chroma_offset;
+    uint16_t *cr = (uint16_t *)fg->cr + chroma_offset;
+    if (fg->apply_cb) {
+      av1_highbd_add_film_grain_chroma(
+          cb, chroma_stride, luma, luma_stride, cb_grain, chroma_grain_stride,
+          chroma_width, chroma_height, chroma_subsamp_x, chroma_subsamp_y,
+          fg->scaling_lut_cb, fg->cb_luma_mult, fg->cb_mult, fg->cb_offset,
+          params->scaling_shift, fg->min_chroma, fg->max_chroma,
+          params->bit_depth);
+    }
+    if (fg->apply_cr) {
+      av1_highbd_add_film_grain_chroma(
+          cr, chroma_stride, luma, luma_stride, cr_grain, chroma_grain_stride,
+          chroma_width, chroma_height, chroma_subsamp_x, chroma_subsamp_y,
+          fg->scaling_lut_cr, fg->cr_luma_mult, fg->cr_mult, fg->cr_offset,
+          params->scaling_shift, fg->min_chroma, fg->max_chroma,
+          params->bit_depth);
+    }
+    if (fg->apply_y) {
+      av1_highbd_add_film_grain_luma(
+          luma, luma_stride, luma_grain, luma_grain_stride,
+          half_luma_width << 1, half_luma_height << 1, fg->scaling_lut_y,
+          params->scaling_shift, fg->min_luma, fg->max_luma);
+    }
+  } else {
+    uint8_t *luma = fg->luma + luma_offset;
+    uint8_t *cb = fg->cb + chroma_offset;
+    uint8_t *cr = fg->cr + chroma_offset;
+    if (fg->apply_cb) {
+      av1_add_film_grain_chroma(
+          cb, chroma_stride, luma, luma_stride, cb_grain, chroma_grain_stride,
+          chroma_width, chroma_height, chroma_subsamp_x, chroma_subsamp_y,
+          fg->scaling_lut_cb, fg->cb_luma_mult, fg->cb_mult, fg->cb_offset,
+          params->scaling_shift, fg->min_chroma, fg->max_chroma);
+    }
+    if (fg->apply_cr) {
+      av1_add_film_grain_chroma(
+          cr, chroma_stride, luma, luma_stride, cr_grain, chroma_grain_stride,
+          chroma_width, chroma_height, chroma_subsamp_x, chroma_subsamp_y,
+          fg->scaling_lut_cr, fg->cr_luma_mult, fg->cr_mult, fg->cr_offset,
+          params->scaling_shift, fg->min_chroma, fg->max_chroma);
+    }
+    if (fg->apply_y) {
+      av1_add_film_grain_luma(luma, luma_stride, luma_grain,
+                              luma_grain_stride, half_luma_width << 1,
+                              half_luma_height << 1, fg->scaling_lut_y,
+                              params->scaling_shift, fg->min_luma,
+                              fg->max_luma);
     }
   }
 }
@@ -912,7 +935,7 @@ static void extend_even(uint8_t *dst, int dst_stride, int width, int height,
 static void ver_boundary_overlap(int *left_block, int left_stride,
                                  int *right_block, int right_stride,
                                  int *dst_block, int dst_stride, int width,
-                                 int height) {
+                                 int height, int grain_min, int grain_max) {
   if (width == 1) {
     while (height) {
       *dst_block = clamp((*left_block * 23 + *right_block * 22 + 16) >> 5,
@@ -941,7 +964,7 @@ static void ver_boundary_overlap(int *left_block, int left_stride,
 static void hor_boundary_overlap(int *top_block, int top_stride,
                                  int *bottom_block, int bottom_stride,
                                  int *dst_block, int dst_stride, int width,
-                                 int height) {
+                                 int height, int grain_min, int grain_max) {
   if (height == 1) {
     while (width) {
       *dst_block = clamp((*top_block * 23 + *bottom_block * 22 + 16) >> 5,
@@ -969,8 +992,491 @@ static void hor_boundary_overlap(int *top_block, int top_stride,
   }
 }
 
-int av1_add_film_grain(const aom_film_grain_t *params, const aom_image_t *src,
-                       aom_image_t *dst) {
+// Adds grain to the row of blocks that starts at luma row (y << 1). bufs must
+// hold the grain of the bottom of the row above. When apply_noise is 0, only
+// updates bufs as adding grain would, so that a thread can prepare them to
+// start at the next row.
+static void add_grain_to_block_row(const GrainFrame *fg,
+                                   GrainOverlapBuffers *bufs, int y,
+                                   int apply_noise) {
+  const aom_film_grain_t *params = fg->params;
+  const int height = fg->height;
+  const int width = fg->width;
+  const int luma_stride = fg->luma_stride;
+  const int chroma_stride = fg->chroma_stride;
+  const int chroma_subsamp_y = fg->chroma_subsamp_y;
+  const int chroma_subsamp_x = fg->chroma_subsamp_x;
+  const int chroma_subblock_size_y = fg->chroma_subblock_size_y;
+  const int chroma_subblock_size_x = fg->chroma_subblock_size_x;
+  const int left_pad = fg->left_pad;
+  const int top_pad = fg->top_pad;
+  const int ar_padding = fg->ar_padding;
+  int *luma_grain_block = fg->luma_grain_block;
+  int *cb_grain_block = fg->cb_grain_block;
+  int *cr_grain_block = fg->cr_grain_block;
+  const int luma_grain_stride = fg->luma_grain_stride;
+  const int chroma_grain_stride = fg->chroma_grain_stride;
+  const int grain_min = fg->grain_min;
+  const int grain_max = fg->grain_max;
+
+  int *y_line_buf = bufs->y_line_buf;
+  int *cb_line_buf = bufs->cb_line_buf;
+  int *cr_line_buf = bufs->cr_line_buf;
+  int *y_col_buf = bufs->y_col_buf;
+  int *cb_col_buf = bufs->cb_col_buf;
+  int *cr_col_buf = bufs->cr_col_buf;
+
+  int overlap = params->overlap_flag;
+
+  uint16_t random_register = init_random_generator(y * 2, params->random_seed);
+
+  for (int x = 0; x < width / 2; x += (luma_subblock_size_x >> 1)) {
+    int offset_y = get_random_number(&random_register, 8);
+    int offset_x = (offset_y >> 4) & 15;
+    offset_y &= 15;
+
+    int luma_offset_y = left_pad + 2 * ar_padding + (offset_y << 1);
+    int luma_offset_x = top_pad + 2 * ar_padding + (offset_x << 1);
+
+    int chroma_offset_y = top_pad + (2 >> chroma_subsamp_y) * ar_padding +
+                          offset_y * (2 >> chroma_subsamp_y);
+    int chroma_offset_x = left_pad + (2 >> chroma_subsamp_x) * ar_padding +
+                          offset_x * (2 >> chroma_subsamp_x);
+
+    if (overlap && x) {
+      ver_boundary_overlap(
+          y_col_buf, 2,
+          luma_grain_block + luma_offset_y * luma_grain_stride + luma_offset_x,
+          luma_grain_stride, y_col_buf, 2, 2,
+          AOMMIN(luma_subblock_size_y + 2, height - (y << 1)), grain_min,
+          grain_max);
+
+      ver_boundary_overlap(
+          cb_col_buf, 2 >> chroma_subsamp_x,
+          cb_grain_block + chroma_offset_y * chroma_grain_stride +
+              chroma_offset_x,
+          chroma_grain_stride, cb_col_buf, 2 >> chroma_subsamp_x,
+          2 >> chroma_subsamp_x,
+          AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
+                 (height - (y << 1)) >> chroma_subsamp_y),
+          grain_min, grain_max);
+
+      ver_boundary_overlap(
+          cr_col_buf, 2 >> chroma_subsamp_x,
+          cr_grain_block + chroma_offset_y * chroma_grain_stride +
+              chroma_offset_x,
+          chroma_grain_stride, cr_col_buf, 2 >> chroma_subsamp_x,
+          2 >> chroma_subsamp_x,
+          AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
+                 (height - (y << 1)) >> chroma_subsamp_y),
+          grain_min, grain_max);
+
+      if (apply_noise) {
+        int i = y ? 1 : 0;
+
+        add_noise_to_block(
+            fg, y + i, x, y_col_buf + i * 4,
+            cb_col_buf + i * (2 - chroma_subsamp_y) * (2 - chroma_subsamp_x),
+            cr_col_buf + i * (2 - chroma_subsamp_y) * (2 - chroma_subsamp_x),
+            2, (2 - chroma_subsamp_x),
+            AOMMIN(luma_subblock_size_y >> 1, height / 2 - y) - i, 1);
+      }
+    }
+
+    // The line buffers are overwritten below without being read when only
+    // the overlap buffers are updated.
+    if (overlap && y && apply_noise) {
+      if (x) {
+        hor_boundary_overlap(y_line_buf + (x << 1), luma_stride, y_col_buf, 2,
+                             y_line_buf + (x << 1), luma_stride, 2, 2,
+                             grain_min, grain_max);
+
+        hor_boundary_overlap(cb_line_buf + x * (2 >> chroma_subsamp_x),
+                             chroma_stride, cb_col_buf, 2 >> chroma_subsamp_x,
+                             cb_line_buf + x * (2 >> chroma_subsamp_x),
+                             chroma_stride, 2 >> chroma_subsamp_x,
+                             2 >> chroma_subsamp_y, grain_min, grain_max);
+
+        hor_boundary_overlap(cr_line_buf + x * (2 >> chroma_subsamp_x),
+                             chroma_stride, cr_col_buf, 2 >> chroma_subsamp_x,
+                             cr_line_buf + x * (2 >> chroma_subsamp_x),
+                             chroma_stride, 2 >> chroma_subsamp_x,
+                             2 >> chroma_subsamp_y, grain_min, grain_max);
+      }
+
+      hor_boundary_overlap(
+          y_line_buf + ((x ? x + 1 : 0) << 1), luma_stride,
+          luma_grain_block + luma_offset_y * luma_grain_stride + luma_offset_x +
+              (x ? 2 : 0),
+          luma_grain_stride, y_line_buf + ((x ? x + 1 : 0) << 1), luma_stride,
+          AOMMIN(luma_subblock_size_x - ((x ? 1 : 0) << 1),
+                 width - ((x ? x + 1 : 0) << 1)),
+          2, grain_min, grain_max);
+
+      hor_boundary_overlap(
+          cb_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
+          chroma_stride,
+          cb_grain_block + chroma_offset_y * chroma_grain_stride +
+              chroma_offset_x + ((x ? 1 : 0) << (1 - chroma_subsamp_x)),
+          chroma_grain_stride,
+          cb_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
+          chroma_stride,
+          AOMMIN(chroma_subblock_size_x -
+                     ((x ? 1 : 0) << (1 - chroma_subsamp_x)),
+                 (width - ((x ? x + 1 : 0) << 1)) >> chroma_subsamp_x),
+          2 >> chroma_subsamp_y, grain_min, grain_max);
+
+      hor_boundary_overlap(
+          cr_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
+          chroma_stride,
+          cr_grain_block + chroma_offset_y * chroma_grain_stride +
+              chroma_offset_x + ((x ? 1 : 0) << (1 - chroma_subsamp_x)),
+          chroma_grain_stride,
+          cr_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
+          chroma_stride,
+          AOMMIN(chroma_subblock_size_x -
+                     ((x ? 1 : 0) << (1 - chroma_subsamp_x)),
+                 (width - ((x ? x + 1 : 0) << 1)) >> chroma_subsamp_x),
+          2 >> chroma_subsamp_y, grain_min, grain_max);
+
+      add_noise_to_block(fg, y, x, y_line_buf + (x << 1),
+                         cb_line_buf + (x << (1 - chroma_subsamp_x)),
+                         cr_line_buf + (x << (1 - chroma_subsamp_x)),
+                         luma_stride, chroma_stride, 1,
+                         AOMMIN(luma_subblock_size_x >> 1, width / 2 - x));
+    }
+
+    if (apply_noise) {
+      int i = overlap && y ? 1 : 0;
+      int j = overlap && x ? 1 : 0;
+
+      add_noise_to_block(
+          fg, y + i, x + j,
+          luma_grain_block + (luma_offset_y + (i << 1)) * luma_grain_stride +
+              luma_offset_x + (j << 1),
+          cb_grain_block +
+              (chroma_offset_y + (i << (1 - chroma_subsamp_y))) *
+                  chroma_grain_stride +
+              chroma_offset_x + (j << (1 - chroma_subsamp_x)),
+          cr_grain_block +
+              (chroma_offset_y + (i << (1 - chroma_subsamp_y))) *
+                  chroma_grain_stride +
+              chroma_offset_x + (j << (1 - chroma_subsamp_x)),
+          luma_grain_stride, chroma_grain_stride,
+          AOMMIN(luma_subblock_size_y >> 1, height / 2 - y) - i,
+          AOMMIN(luma_subblock_size_x >> 1, width / 2 - x) - j);
+    }
+
+    if (overlap) {
+      if (x) {
+        // Copy overlapped column bufer to line buffer
+        copy_area(y_col_buf + (luma_subblock_size_y << 1), 2,
+                  y_line_buf + (x << 1), luma_stride, 2, 2);
+
+        copy_area(
+            cb_col_buf + (chroma_subblock_size_y << (1 - chroma_subsamp_x)),
+            2 >> chroma_subsamp_x,
+            cb_line_buf + (x << (1 - chroma_subsamp_x)), chroma_stride,
+            2 >> chroma_subsamp_x, 2 >> chroma_subsamp_y);
+
+        copy_area(
+            cr_col_buf + (chroma_subblock_size_y << (1 - chroma_subsamp_x)),
+            2 >> chroma_subsamp_x,
+            cr_line_buf + (x << (1 - chroma_subsamp_x)), chroma_stride,
+            2 >> chroma_subsamp_x, 2 >> chroma_subsamp_y);
+      }
+
+      // Copy grain to the line buffer for overlap with a bottom block
+      copy_area(
+          luma_grain_block +
+              (luma_offset_y + luma_subblock_size_y) * luma_grain_stride +
+              luma_offset_x + ((x ? 2 : 0)),
+          luma_grain_stride, y_line_buf + ((x ? x + 1 : 0) << 1), luma_stride,
+          AOMMIN(luma_subblock_size_x, width - (x << 1)) - (x ? 2 : 0), 2);
+
+      copy_area(cb_grain_block +
+                    (chroma_offset_y + chroma_subblock_size_y) *
+                        chroma_grain_stride +
+                    chroma_offset_x + (x ? 2 >> chroma_subsamp_x : 0),
+                chroma_grain_stride,
+                cb_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
+                chroma_stride,
+                AOMMIN(chroma_subblock_size_x,
+                       ((width - (x << 1)) >> chroma_subsamp_x)) -
+                    (x ? 2 >> chroma_subsamp_x : 0),
+                2 >> chroma_subsamp_y);
+
+      copy_area(cr_grain_block +
+                    (chroma_offset_y + chroma_subblock_size_y) *
+                        chroma_grain_stride +
+                    chroma_offset_x + (x ? 2 >> chroma_subsamp_x : 0),
+                chroma_grain_stride,
+                cr_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
+                chroma_stride,
+                AOMMIN(chroma_subblock_size_x,
+                       ((width - (x << 1)) >> chroma_subsamp_x)) -
+                    (x ? 2 >> chroma_subsamp_x : 0),
+                2 >> chroma_subsamp_y);
+
+      // Copy grain to the column buffer for overlap with the next block to
+      // the right
+
+      copy_area(luma_grain_block + luma_offset_y * luma_grain_stride +
+                    luma_offset_x + luma_subblock_size_x,
+                luma_grain_stride, y_col_buf, 2, 2,
+                AOMMIN(luma_subblock_size_y + 2, height - (y << 1)));
+
+      copy_area(cb_grain_block + chroma_offset_y * chroma_grain_stride +
+                    chroma_offset_x + chroma_subblock_size_x,
+                chroma_grain_stride, cb_col_buf, 2 >> chroma_subsamp_x,
+                2 >> chroma_subsamp_x,
+                AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
+                       (height - (y << 1)) >> chroma_subsamp_y));
+
+      copy_area(cr_grain_block + chroma_offset_y * chroma_grain_stride +
+                    chroma_offset_x + chroma_subblock_size_x,
+                chroma_grain_stride, cr_col_buf, 2 >> chroma_subsamp_x,
+                2 >> chroma_subsamp_x,
+                AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
+                       (height - (y << 1)) >> chroma_subsamp_y));
+    }
+  }
+}
+
+typedef struct {
+  const GrainFrame *fg;
+  GrainOverlapBuffers bufs;
+  // Range of block rows, in units of half luma rows.
+  int start_y;
+  int end_y;
+} GrainWorkerData;
+
+static int grain_worker_hook(void *arg1, void *unused) {
+  (void)unused;
+  GrainWorkerData *const data = (GrainWorkerData *)arg1;
+  const int block_row_height = luma_subblock_size_y >> 1;
+  // The grain of each block row is blended with the bottom of the grain of
+  // the row above, which depends only on the blocks of that row.
+  if (data->fg->params->overlap_flag && data->start_y > 0) {
+    add_grain_to_block_row(data->fg, &data->bufs,
+                           data->start_y - block_row_height, 0);
+  }
+  for (int y = data->start_y; y < data->end_y; y += block_row_height)
+    add_grain_to_block_row(data->fg, &data->bufs, y, 1);
+  return 1;
+}
+
+static int add_film_grain_run(const aom_film_grain_t *params, uint8_t *luma,
+                              uint8_t *cb, uint8_t *cr, int height, int width,
+                              int luma_stride, int chroma_stride,
+                              int use_high_bit_depth, int chroma_subsamp_y,
+                              int chroma_subsamp_x, int mc_identity,
+                              AVxWorker *workers, int num_workers) {
+  int **pred_pos_luma;
+  int **pred_pos_chroma;
+  GrainFrame fg;
+
+  av1_rtcd();
+
+  uint16_t random_register = params->random_seed;
+
+  int left_pad = 3;
+  int right_pad = 3;  // padding to offset for AR coefficients
+  int top_pad = 3;
+  int bottom_pad = 0;
+
+  int ar_padding = 3;  // maximum lag used for stabilization of AR coefficients
+
+  int chroma_subblock_size_y = luma_subblock_size_y >> chroma_subsamp_y;
+  int chroma_subblock_size_x = luma_subblock_size_x >> chroma_subsamp_x;
+
+  // Initial padding is only needed for generation of
+  // film grain templates (to stabilize the AR process)
+  // Only a 64x64 luma and 32x32 chroma part of a template
+  // is used later for adding grain, padding can be discarded
+
+  int luma_block_size_y =
+      top_pad + 2 * ar_padding + luma_subblock_size_y * 2 + bottom_pad;
+  int luma_block_size_x = left_pad + 2 * ar_padding + luma_subblock_size_x * 2 +
+                          2 * ar_padding + right_pad;
+
+  int chroma_block_size_y = top_pad + (2 >> chroma_subsamp_y) * ar_padding +
+                            chroma_subblock_size_y * 2 + bottom_pad;
+  int chroma_block_size_x = left_pad + (2 >> chroma_subsamp_x) * ar_padding +
+                            chroma_subblock_size_x * 2 +
+                            (2 >> chroma_subsamp_x) * ar_padding + right_pad;
+
+  int luma_grain_stride = luma_block_size_x;
+  int chroma_grain_stride = chroma_block_size_x;
+
+  int bit_depth = params->bit_depth;
+
+  const int grain_center = 128 << (bit_depth - 8);
+  const int grain_min = 0 - grain_center;
+  const int grain_max = grain_center - 1;
+
+  if (!init_arrays(params, &pred_pos_luma, &pred_pos_chroma, &fg,
+                   luma_block_size_y * luma_block_size_x,
+                   chroma_block_size_y * chroma_block_size_x,
+                   256 << (bit_depth - 8)))
+    return -1;
+
+  generate_luma_grain_block(params, pred_pos_luma, fg.luma_grain_block,
+                            &random_register, luma_block_size_y,
+                            luma_block_size_x, luma_grain_stride, left_pad,
+                            top_pad, right_pad, bottom_pad, grain_min,
+                            grain_max);
+
+  if (!generate_chroma_grain_blocks(
+          params, pred_pos_chroma, fg.luma_grain_block, fg.cb_grain_block,
+          fg.cr_grain_block, luma_grain_stride, chroma_block_size_y,
+          chroma_block_size_x, chroma_grain_stride, left_pad, top_pad,
+          right_pad, bottom_pad, chroma_subsamp_y, chroma_subsamp_x,
+          grain_min, grain_max)) {
+    dealloc_arrays(params, &pred_pos_luma, &pred_pos_chroma, &fg);
+    return -1;
+  }
+
+  init_scaling_lut(params->scaling_points_y, params->num_y_points, bit_depth,
+                   fg.scaling_lut_y);
+
+  if (params->chroma_scaling_from_luma) {
+    memcpy(fg.scaling_lut_cb, fg.scaling_lut_y,
+           sizeof(*fg.scaling_lut_y) * (256 << (bit_depth - 8)));
+    memcpy(fg.scaling_lut_cr, fg.scaling_lut_y,
+           sizeof(*fg.scaling_lut_y) * (256 << (bit_depth - 8)));
+  } else {
+    init_scaling_lut(params->scaling_points_cb, params->num_cb_points,
+                     bit_depth, fg.scaling_lut_cb);
+    init_scaling_lut(params->scaling_points_cr, params->num_cr_points,
+                     bit_depth, fg.scaling_lut_cr);
+  }
+
+  fg.params = params;
+  fg.luma = luma;
+  fg.cb = cb;
+  fg.cr = cr;
+  fg.height = height;
+  fg.width = width;
+  fg.luma_stride = luma_stride;
+  fg.chroma_stride = chroma_stride;
+  fg.use_high_bit_depth = use_high_bit_depth;
+  fg.chroma_subsamp_y = chroma_subsamp_y;
+  fg.chroma_subsamp_x = chroma_subsamp_x;
+  fg.chroma_subblock_size_y = chroma_subblock_size_y;
+  fg.chroma_subblock_size_x = chroma_subblock_size_x;
+  fg.left_pad = left_pad;
+  fg.top_pad = top_pad;
+  fg.ar_padding = ar_padding;
+  fg.luma_grain_stride = luma_grain_stride;
+  fg.chroma_grain_stride = chroma_grain_stride;
+  fg.grain_min = grain_min;
+  fg.grain_max = grain_max;
+
+  fg.cb_mult = params->cb_mult - 128;            // fixed scale
+  fg.cb_luma_mult = params->cb_luma_mult - 128;  // fixed scale
+  // offset value depends on the bit depth
+  fg.cb_offset = (params->cb_offset << (bit_depth - 8)) - (1 << bit_depth);
+
+  fg.cr_mult = params->cr_mult - 128;            // fixed scale
+  fg.cr_luma_mult = params->cr_luma_mult - 128;  // fixed scale
+  // offset value depends on the bit depth
+  fg.cr_offset = (params->cr_offset << (bit_depth - 8)) - (1 << bit_depth);
+
+  if (params->chroma_scaling_from_luma) {
+    fg.cb_mult = 0;        // fixed scale
+    fg.cb_luma_mult = 64;  // fixed scale
+    fg.cb_offset = 0;
+
+    fg.cr_mult = 0;        // fixed scale
+    fg.cr_luma_mult = 64;  // fixed scale
+    fg.cr_offset = 0;
+  }
+
+  if (params->clip_to_restricted_range) {
+    fg.min_luma = min_luma_legal_range << (bit_depth - 8);
+    fg.max_luma = max_luma_legal_range << (bit_depth - 8);
+
+    if (mc_identity) {
+      fg.min_chroma = min_luma_legal_range << (bit_depth - 8);
+      fg.max_chroma = max_luma_legal_range << (bit_depth - 8);
+    } else {
+      fg.min_chroma = min_chroma_legal_range << (bit_depth - 8);
+      fg.max_chroma = max_chroma_legal_range << (bit_depth - 8);
+    }
+  } else {
+    fg.min_luma = fg.min_chroma = 0;
+    fg.max_luma = fg.max_chroma = (256 << (bit_depth - 8)) - 1;
+  }
+
+  fg.apply_y = params->num_y_points > 0 ? 1 : 0;
+  fg.apply_cb =
+      (params->num_cb_points > 0 || params->chroma_scaling_from_luma) ? 1 : 0;
+  fg.apply_cr =
+      (params->num_cr_points > 0 || params->chroma_scaling_from_luma) ? 1 : 0;
+
+  // Split the block rows evenly between the workers.
+  const int block_row_height = luma_subblock_size_y >> 1;
+  const int num_block_rows =
+      (height / 2 + block_row_height - 1) / block_row_height;
+  if (workers == NULL) num_workers = 1;
+  num_workers = AOMMAX(AOMMIN(num_workers, num_block_rows), 1);
+
+  GrainWorkerData *const worker_data =
+      (GrainWorkerData *)aom_calloc(num_workers, sizeof(*worker_data));
+  if (!worker_data) {
+    dealloc_arrays(params, &pred_pos_luma, &pred_pos_chroma, &fg);
+    return -1;
+  }
+  int ret = 0;
+  for (int i = 0; i < num_workers; ++i) {
+    GrainWorkerData *const data = &worker_data[i];
+    data->fg = &fg;
+    data->start_y = num_block_rows * i / num_workers * block_row_height;
+    data->end_y = num_block_rows * (i + 1) / num_workers * block_row_height;
+    if (!init_overlap_buffers(&data->bufs, &fg)) ret = -1;
+  }
+
+  if (ret == 0) {
+    if (num_workers == 1) {
+      grain_worker_hook(&worker_data[0], NULL);
+    } else {
+      const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+      for (int i = num_workers - 1; i >= 0; --i) {
+        AVxWorker *const worker = &workers[i];
+        worker->hook = grain_worker_hook;
+        worker->data1 = &worker_data[i];
+        worker->data2 = NULL;
+        if (i == 0)
+          winterface->execute(worker);
+        else
+          winterface->launch(worker);
+      }
+      for (int i = num_workers - 1; i > 0; --i) winterface->sync(&workers[i]);
+    }
+  }
+
+  for (int i = 0; i < num_workers; ++i)
+    dealloc_overlap_buffers(&worker_data[i].bufs);
+  aom_free(worker_data);
+  dealloc_arrays(params, &pred_pos_luma, &pred_pos_chroma, &fg);
+  return ret;
+}
+
+int av1_add_film_grain_run(const aom_film_grain_t *params, uint8_t *luma,
+                           uint8_t *cb, uint8_t *cr, int height, int width,
+                           int luma_stride, int chroma_stride,
+                           int use_high_bit_depth, int chroma_subsamp_y,
+                           int chroma_subsamp_x, int mc_identity) {
+  return add_film_grain_run(params, luma, cb, cr, height, width, luma_stride,
+                            chroma_stride, use_high_bit_depth,
+                            chroma_subsamp_y, chroma_subsamp_x, mc_identity,
+                            NULL, 0);
+}
+
+int av1_add_film_grain_mt(const aom_film_grain_t *params,
+                          const aom_image_t *src, aom_image_t *dst,
+                          AVxWorker *workers, int num_workers) {
   uint8_t *luma, *cb, *cr;
   int height, width, luma_stride, chroma_stride;
   int use_high_bit_depth = 0;
@@ -1070,392 +1576,13 @@ int av1_add_film_grain(const aom_film_grain_t *params, const aom_image_t *src,
   luma_stride = dst->stride[AOM_PLANE_Y] >> use_high_bit_depth;
   chroma_stride = dst->stride[AOM_PLANE_U] >> use_high_bit_depth;
 
-  return av1_add_film_grain_run(
-      params, luma, cb, cr, height, width, luma_stride, chroma_stride,
-      use_high_bit_depth, chroma_subsamp_y, chroma_subsamp_x, mc_identity);
+  return add_film_grain_run(params, luma, cb, cr, height, width, luma_stride,
+                            chroma_stride, use_high_bit_depth,
+                            chroma_subsamp_y, chroma_subsamp_x, mc_identity,
+                            workers, num_workers);
 }
 
-int av1_add_film_grain_run(const aom_film_grain_t *params, uint8_t *luma,
-                           uint8_t *cb, uint8_t *cr, int height, int width,
-                           int luma_stride, int chroma_stride,
-                           int use_high_bit_depth, int chroma_subsamp_y,
-                           int chroma_subsamp_x, int mc_identity) {
-  int **pred_pos_luma;
-  int **pred_pos_chroma;
-  int *luma_grain_block;
-  int *cb_grain_block;
-  int *cr_grain_block;
-
-  int *y_line_buf;
-  int *cb_line_buf;
-  int *cr_line_buf;
-
-  int *y_col_buf;
-  int *cb_col_buf;
-  int *cr_col_buf;
-
-  random_register = params->random_seed;
-
-  int left_pad = 3;
-  int right_pad = 3;  // padding to offset for AR coefficients
-  int top_pad = 3;
-  int bottom_pad = 0;
-
-  int ar_padding = 3;  // maximum lag used for stabilization of AR coefficients
-
-  luma_subblock_size_y = 32;
-  luma_subblock_size_x = 32;
-
-  chroma_subblock_size_y = luma_subblock_size_y >> chroma_subsamp_y;
-  chroma_subblock_size_x = luma_subblock_size_x >> chroma_subsamp_x;
-
-  // Initial padding is only needed for generation of
-  // film grain templates (to stabilize the AR process)
-  // Only a 64x64 luma and 32x32 chroma part of a template
-  // is used later for adding grain, padding can be discarded
-
-  int luma_block_size_y =
-      top_pad + 2 * ar_padding + luma_subblock_size_y * 2 + bottom_pad;
-  int luma_block_size_x = left_pad + 2 * ar_padding + luma_subblock_size_x * 2 +
-                          2 * ar_padding + right_pad;
-
-  int chroma_block_size_y = top_pad + (2 >> chroma_subsamp_y) * ar_padding +
-                            chroma_subblock_size_y * 2 + bottom_pad;
-  int chroma_block_size_x = left_pad + (2 >> chroma_subsamp_x) * ar_padding +
-                            chroma_subblock_size_x * 2 +
-                            (2 >> chroma_subsamp_x) * ar_padding + right_pad;
-
-  int luma_grain_stride = luma_block_size_x;
-  int chroma_grain_stride = chroma_block_size_x;
-
-  int overlap = params->overlap_flag;
-  int bit_depth = params->bit_depth;
-
-  const int grain_center = 128 << (bit_depth - 8);
-  grain_min = 0 - grain_center;
-  grain_max = grain_center - 1;
-
-  if (!init_arrays(params, luma_stride, chroma_stride, &pred_pos_luma,
-                   &pred_pos_chroma, &luma_grain_block, &cb_grain_block,
-                   &cr_grain_block, &y_line_buf, &cb_line_buf, &cr_line_buf,
-                   &y_col_buf, &cb_col_buf, &cr_col_buf,
-                   luma_block_size_y * luma_block_size_x,
-                   chroma_block_size_y * chroma_block_size_x, chroma_subsamp_y,
-                   chroma_subsamp_x))
-    return -1;
-
-  generate_luma_grain_block(params, pred_pos_luma, luma_grain_block,
-                            luma_block_size_y, luma_block_size_x,
-                            luma_grain_stride, left_pad, top_pad, right_pad,
-                            bottom_pad);
-
-  if (!generate_chroma_grain_blocks(
-          params, pred_pos_chroma, luma_grain_block, cb_grain_block,
-          cr_grain_block, luma_grain_stride, chroma_block_size_y,
-          chroma_block_size_x, chroma_grain_stride, left_pad, top_pad,
-          right_pad, bottom_pad, chroma_subsamp_y, chroma_subsamp_x))
-    return -1;
-
-  init_scaling_function(params->scaling_points_y, params->num_y_points,
-                        scaling_lut_y);
-
-  if (params->chroma_scaling_from_luma) {
-    memcpy(scaling_lut_cb, scaling_lut_y, sizeof(*scaling_lut_y) * 256);
-    memcpy(scaling_lut_cr, scaling_lut_y, sizeof(*scaling_lut_y) * 256);
-  } else {
-    init_scaling_function(params->scaling_points_cb, params->num_cb_points,
-                          scaling_lut_cb);
-    init_scaling_function(params->scaling_points_cr, params->num_cr_points,
-                          scaling_lut_cr);
-  }
-  for (int y = 0; y < height / 2; y += (luma_subblock_size_y >> 1)) {
-    init_random_generator(y * 2, params->random_seed);
-
-    for (int x = 0; x < width / 2; x += (luma_subblock_size_x >> 1)) {
-      int offset_y = get_random_number(8);
-      int offset_x = (offset_y >> 4) & 15;
-      offset_y &= 15;
-
-      int luma_offset_y = left_pad + 2 * ar_padding + (offset_y << 1);
-      int luma_offset_x = top_pad + 2 * ar_padding + (offset_x << 1);
-
-      int chroma_offset_y = top_pad + (2 >> chroma_subsamp_y) * ar_padding +
-                            offset_y * (2 >> chroma_subsamp_y);
-      int chroma_offset_x = left_pad + (2 >> chroma_subsamp_x) * ar_padding +
-                            offset_x * (2 >> chroma_subsamp_x);
-
-      if (overlap && x) {
-        ver_boundary_overlap(
-            y_col_buf, 2,
-            luma_grain_block + luma_offset_y * luma_grain_stride +
-                luma_offset_x,
-            luma_grain_stride, y_col_buf, 2, 2,
-            AOMMIN(luma_subblock_size_y + 2, height - (y << 1)));
-
-        ver_boundary_overlap(
-            cb_col_buf, 2 >> chroma_subsamp_x,
-            cb_grain_block + chroma_offset_y * chroma_grain_stride +
-                chroma_offset_x,
-            chroma_grain_stride, cb_col_buf, 2 >> chroma_subsamp_x,
-            2 >> chroma_subsamp_x,
-            AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
-                   (height - (y << 1)) >> chroma_subsamp_y));
-
-        ver_boundary_overlap(
-            cr_col_buf, 2 >> chroma_subsamp_x,
-            cr_grain_block + chroma_offset_y * chroma_grain_stride +
-                chroma_offset_x,
-            chroma_grain_stride, cr_col_buf, 2 >> chroma_subsamp_x,
-            2 >> chroma_subsamp_x,
-            AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
-                   (height - (y << 1)) >> chroma_subsamp_y));
-
-        int i = y ? 1 : 0;
-
-        if (use_high_bit_depth) {
-          add_noise_to_block_hbd(
-              params,
-              (uint16_t *)luma + ((y + i) << 1) * luma_stride + (x << 1),
-              (uint16_t *)cb +
-                  ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                  (x << (1 - chroma_subsamp_x)),
-              (uint16_t *)cr +
-                  ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                  (x << (1 - chroma_subsamp_x)),
-              luma_stride, chroma_stride, y_col_buf + i * 4,
-              cb_col_buf + i * (2 - chroma_subsamp_y) * (2 - chroma_subsamp_x),
-              cr_col_buf + i * (2 - chroma_subsamp_y) * (2 - chroma_subsamp_x),
-              2, (2 - chroma_subsamp_x),
-              AOMMIN(luma_subblock_size_y >> 1, height / 2 - y) - i, 1,
-              bit_depth, chroma_subsamp_y, chroma_subsamp_x, mc_identity);
-        } else {
-          add_noise_to_block(
-              params, luma + ((y + i) << 1) * luma_stride + (x << 1),
-              cb + ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                  (x << (1 - chroma_subsamp_x)),
-              cr + ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                  (x << (1 - chroma_subsamp_x)),
-              luma_stride, chroma_stride, y_col_buf + i * 4,
-              cb_col_buf + i * (2 - chroma_subsamp_y) * (2 - chroma_subsamp_x),
-              cr_col_buf + i * (2 - chroma_subsamp_y) * (2 - chroma_subsamp_x),
-              2, (2 - chroma_subsamp_x),
-              AOMMIN(luma_subblock_size_y >> 1, height / 2 - y) - i, 1,
-              bit_depth, chroma_subsamp_y, chroma_subsamp_x, mc_identity);
-        }
-      }
-
-      if (overlap && y) {
-        if (x) {
-          hor_boundary_overlap(y_line_buf + (x << 1), luma_stride, y_col_buf, 2,
-                               y_line_buf + (x << 1), luma_stride, 2, 2);
-
-          hor_boundary_overlap(cb_line_buf + x * (2 >> chroma_subsamp_x),
-                               chroma_stride, cb_col_buf, 2 >> chroma_subsamp_x,
-                               cb_line_buf + x * (2 >> chroma_subsamp_x),
-                               chroma_stride, 2 >> chroma_subsamp_x,
-                               2 >> chroma_subsamp_y);
-
-          hor_boundary_overlap(cr_line_buf + x * (2 >> chroma_subsamp_x),
-                               chroma_stride, cr_col_buf, 2 >> chroma_subsamp_x,
-                               cr_line_buf + x * (2 >> chroma_subsamp_x),
-                               chroma_stride, 2 >> chroma_subsamp_x,
-                               2 >> chroma_subsamp_y);
-        }
-
-        hor_boundary_overlap(
-            y_line_buf + ((x ? x + 1 : 0) << 1), luma_stride,
-            luma_grain_block + luma_offset_y * luma_grain_stride +
-                luma_offset_x + (x ? 2 : 0),
-            luma_grain_stride, y_line_buf + ((x ? x + 1 : 0) << 1), luma_stride,
-            AOMMIN(luma_subblock_size_x - ((x ? 1 : 0) << 1),
-                   width - ((x ? x + 1 : 0) << 1)),
-            2);
-
-        hor_boundary_overlap(
-            cb_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
-            chroma_stride,
-            cb_grain_block + chroma_offset_y * chroma_grain_stride +
-                chroma_offset_x + ((x ? 1 : 0) << (1 - chroma_subsamp_x)),
-            chroma_grain_stride,
-            cb_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
-            chroma_stride,
-            AOMMIN(chroma_subblock_size_x -
-                       ((x ? 1 : 0) << (1 - chroma_subsamp_x)),
-                   (width - ((x ? x + 1 : 0) << 1)) >> chroma_subsamp_x),
-            2 >> chroma_subsamp_y);
-
-        hor_boundary_overlap(
-            cr_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
-            chroma_stride,
-            cr_grain_block + chroma_offset_y * chroma_grain_stride +
-                chroma_offset_x + ((x ? 1 : 0) << (1 - chroma_subsamp_x)),
-            chroma_grain_stride,
-            cr_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
-            chroma_stride,
-            AOMMIN(chroma_subblock_size_x -
-                       ((x ? 1 : 0) << (1 - chroma_subsamp_x)),
-                   (width - ((x ? x + 1 : 0) << 1)) >> chroma_subsamp_x),
-            2 >> chroma_subsamp_y);
-
-        if (use_high_bit_depth) {
-          add_noise_to_block_hbd(
-              params, (uint16_t *)luma + (y << 1) * luma_stride + (x << 1),
-              (uint16_t *)cb + (y << (1 - chroma_subsamp_y)) * chroma_stride +
-                  (x << ((1 - chroma_subsamp_x))),
-              (uint16_t *)cr + (y << (1 - chroma_subsamp_y)) * chroma_stride +
-                  (x << ((1 - chroma_subsamp_x))),
-              luma_stride, chroma_stride, y_line_buf + (x << 1),
-              cb_line_buf + (x << (1 - chroma_subsamp_x)),
-              cr_line_buf + (x << (1 - chroma_subsamp_x)), luma_stride,
-              chroma_stride, 1,
-              AOMMIN(luma_subblock_size_x >> 1, width / 2 - x), bit_depth,
-              chroma_subsamp_y, chroma_subsamp_x, mc_identity);
-        } else {
-          add_noise_to_block(
-              params, luma + (y << 1) * luma_stride + (x << 1),
-              cb + (y << (1 - chroma_subsamp_y)) * chroma_stride +
-                  (x << ((1 - chroma_subsamp_x))),
-              cr + (y << (1 - chroma_subsamp_y)) * chroma_stride +
-                  (x << ((1 - chroma_subsamp_x))),
-              luma_stride, chroma_stride, y_line_buf + (x << 1),
-              cb_line_buf + (x << (1 - chroma_subsamp_x)),
-              cr_line_buf + (x << (1 - chroma_subsamp_x)), luma_stride,
-              chroma_stride, 1,
-              AOMMIN(luma_subblock_size_x >> 1, width / 2 - x), bit_depth,
-              chroma_subsamp_y, chroma_subsamp_x, mc_identity);
-        }
-      }
-
-      int i = overlap && y ? 1 : 0;
-      int j = overlap && x ? 1 : 0;
-
-      if (use_high_bit_depth) {
-        add_noise_to_block_hbd(
-            params,
-            (uint16_t *)luma + ((y + i) << 1) * luma_stride + ((x + j) << 1),
-            (uint16_t *)cb +
-                ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                ((x + j) << (1 - chroma_subsamp_x)),
-            (uint16_t *)cr +
-                ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                ((x + j) << (1 - chroma_subsamp_x)),
-            luma_stride, chroma_stride,
-            luma_grain_block + (luma_offset_y + (i << 1)) * luma_grain_stride +
-                luma_offset_x + (j << 1),
-            cb_grain_block +
-                (chroma_offset_y + (i << (1 - chroma_subsamp_y))) *
-                    chroma_grain_stride +
-                chroma_offset_x + (j << (1 - chroma_subsamp_x)),
-            cr_grain_block +
-                (chroma_offset_y + (i << (1 - chroma_subsamp_y))) *
-                    chroma_grain_stride +
-                chroma_offset_x + (j << (1 - chroma_subsamp_x)),
-            luma_grain_stride, chroma_grain_stride,
-            AOMMIN(luma_subblock_size_y >> 1, height / 2 - y) - i,
-            AOMMIN(luma_subblock_size_x >> 1, width / 2 - x) - j, bit_depth,
-            chroma_subsamp_y, chroma_subsamp_x, mc_identity);
-      } else {
-        add_noise_to_block(
-            params, luma + ((y + i) << 1) * luma_stride + ((x + j) << 1),
-            cb + ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                ((x + j) << (1 - chroma_subsamp_x)),
-            cr + ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                ((x + j) << (1 - chroma_subsamp_x)),
-            luma_stride, chroma_stride,
-            luma_grain_block + (luma_offset_y + (i << 1)) * luma_grain_stride +
-                luma_offset_x + (j << 1),
-            cb_grain_block +
-                (chroma_offset_y + (i << (1 - chroma_subsamp_y))) *
-                    chroma_grain_stride +
-                chroma_offset_x + (j << (1 - chroma_subsamp_x)),
-            cr_grain_block +
-                (chroma_offset_y + (i << (1 - chroma_subsamp_y))) *
-                    chroma_grain_stride +
-                chroma_offset_x + (j << (1 - chroma_subsamp_x)),
-            luma_grain_stride, chroma_grain_stride,
-            AOMMIN(luma_subblock_size_y >> 1, height / 2 - y) - i,
-            AOMMIN(luma_subblock_size_x >> 1, width / 2 - x) - j, bit_depth,
-            chroma_subsamp_y, chroma_subsamp_x, mc_identity);
-      }
-
-      if (overlap) {
-        if (x) {
-          // Copy overlapped column bufer to line buffer
-          copy_area(y_col_buf + (luma_subblock_size_y << 1), 2,
-                    y_line_buf + (x << 1), luma_stride, 2, 2);
-
-          copy_area(
-              cb_col_buf + (chroma_subblock_size_y << (1 - chroma_subsamp_x)),
-              2 >> chroma_subsamp_x,
-              cb_line_buf + (x << (1 - chroma_subsamp_x)), chroma_stride,
-              2 >> chroma_subsamp_x, 2 >> chroma_subsamp_y);
-
-          copy_area(
-              cr_col_buf + (chroma_subblock_size_y << (1 - chroma_subsamp_x)),
-              2 >> chroma_subsamp_x,
-              cr_line_buf + (x << (1 - chroma_subsamp_x)), chroma_stride,
-              2 >> chroma_subsamp_x, 2 >> chroma_subsamp_y);
-        }
-
-        // Copy grain to the line buffer for overlap with a bottom block
-        copy_area(
-            luma_grain_block +
-                (luma_offset_y + luma_subblock_size_y) * luma_grain_stride +
-                luma_offset_x + ((x ? 2 : 0)),
-            luma_grain_stride, y_line_buf + ((x ? x + 1 : 0) << 1), luma_stride,
-            AOMMIN(luma_subblock_size_x, width - (x << 1)) - (x ? 2 : 0), 2);
-
-        copy_area(cb_grain_block +
-                      (chroma_offset_y + chroma_subblock_size_y) *
-                          chroma_grain_stride +
-                      chroma_offset_x + (x ? 2 >> chroma_subsamp_x : 0),
-                  chroma_grain_stride,
-                  cb_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
-                  chroma_stride,
-                  AOMMIN(chroma_subblock_size_x,
-                         ((width - (x << 1)) >> chroma_subsamp_x)) -
-                      (x ? 2 >> chroma_subsamp_x : 0),
-                  2 >> chroma_subsamp_y);
-
-        copy_area(cr_grain_block +
-                      (chroma_offset_y + chroma_subblock_size_y) *
-                          chroma_grain_stride +
-                      chroma_offset_x + (x ? 2 >> chroma_subsamp_x : 0),
-                  chroma_grain_stride,
-                  cr_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
-                  chroma_stride,
-                  AOMMIN(chroma_subblock_size_x,
-                         ((width - (x << 1)) >> chroma_subsamp_x)) -
-                      (x ? 2 >> chroma_subsamp_x : 0),
-                  2 >> chroma_subsamp_y);
-
-        // Copy grain to the column buffer for overlap with the next block to
-        // the right
-
-        copy_area(luma_grain_block + luma_offset_y * luma_grain_stride +
-                      luma_offset_x + luma_subblock_size_x,
-                  luma_grain_stride, y_col_buf, 2, 2,
-                  AOMMIN(luma_subblock_size_y + 2, height - (y << 1)));
-
-        copy_area(cb_grain_block + chroma_offset_y * chroma_grain_stride +
-                      chroma_offset_x + chroma_subblock_size_x,
-                  chroma_grain_stride, cb_col_buf, 2 >> chroma_subsamp_x,
-                  2 >> chroma_subsamp_x,
-                  AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
-                         (height - (y << 1)) >> chroma_subsamp_y));
-
-        copy_area(cr_grain_block + chroma_offset_y * chroma_grain_stride +
-                      chroma_offset_x + chroma_subblock_size_x,
-                  chroma_grain_stride, cr_col_buf, 2 >> chroma_subsamp_x,
-                  2 >> chroma_subsamp_x,
-                  AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
-                         (height - (y << 1)) >> chroma_subsamp_y));
-      }
-    }
-  }
-
-  dealloc_arrays(params, &pred_pos_luma, &pred_pos_chroma, &luma_grain_block,
-                 &cb_grain_block, &cr_grain_block, &y_line_buf, &cb_line_buf,
-                 &cr_line_buf, &y_col_buf, &cb_col_buf, &cr_col_buf);
-  return 0;
+int av1_add_film_grain(const aom_film_grain_t *params, const aom_image_t *src,
+                       aom_image_t *dst) {
+  return av1_add_film_grain_mt(params, src, dst, NULL, 0);
 }
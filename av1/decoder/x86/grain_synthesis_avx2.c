@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <immintrin.h>
+
+#include "config/av1_rtcd.h"
+
+#include "aom/aom_integer.h"
+#include "aom_dsp/x86/synonyms.h"
+
+// Returns clamp(pixel + ((scaling_lut[index] * grain + rounding) >> shift),
+// min, max).
+static inline __m256i add_grain(__m256i pixel, const int *scaling_lut,
+                                __m256i index, const int *grain,
+                                __m256i rounding, __m128i shift,
+                                __m256i min_val, __m256i max_val) {
+  const __m256i scale = _mm256_i32gather_epi32(scaling_lut, index, 4);
+  const __m256i g = _mm256_loadu_si256((const __m256i *)grain);
+  __m256i noise = _mm256_add_epi32(_mm256_mullo_epi32(scale, g), rounding);
+  noise = _mm256_sra_epi32(noise, shift);
+  const __m256i sum = _mm256_add_epi32(pixel, noise);
+  return _mm256_min_epi32(_mm256_max_epi32(sum, min_val), max_val);
+}
+
+// Returns the scaling function indices of 8 chroma samples.
+static inline __m256i chroma_index(__m256i average_luma, __m256i pixel,
+                                   __m256i luma_mult, __m256i chroma_mult,
+                                   __m256i offset, __m256i max_index) {
+  __m256i index = _mm256_add_epi32(_mm256_mullo_epi32(average_luma, luma_mult),
+                                   _mm256_mullo_epi32(pixel, chroma_mult));
+  index = _mm256_add_epi32(_mm256_srai_epi32(index, 6), offset);
+  index = _mm256_max_epi32(index, _mm256_setzero_si256());
+  return _mm256_min_epi32(index, max_index);
+}
+
+static inline __m128i pack_epi32_to_epu16(__m256i v) {
+  return _mm_packus_epi32(_mm256_castsi256_si128(v),
+                          _mm256_extracti128_si256(v, 1));
+}
+
+void av1_add_film_grain_luma_avx2(uint8_t *luma, int luma_stride,
+                                  const int *grain, int grain_stride,
+                                  int width, int height,
+                                  const int *scaling_lut, int scaling_shift,
+                                  int min_val, int max_val) {
+  const int w8 = width & ~7;
+  const __m256i rounding = _mm256_set1_epi32(1 << (scaling_shift - 1));
+  const __m128i shift = _mm_cvtsi32_si128(scaling_shift);
+  const __m256i vmin = _mm256_set1_epi32(min_val);
+  const __m256i vmax = _mm256_set1_epi32(max_val);
+  for (int i = 0; i < height; i++) {
+    uint8_t *row = luma + i * luma_stride;
+    const int *grain_row = grain + i * grain_stride;
+    for (int j = 0; j < w8; j += 8) {
+      const __m256i pixels = _mm256_cvtepu8_epi32(xx_loadl_64(row + j));
+      const __m256i out = add_grain(pixels, scaling_lut, pixels, grain_row + j,
+                                    rounding, shift, vmin, vmax);
+      const __m128i out16 = pack_epi32_to_epu16(out);
+      xx_storel_64(row + j, _mm_packus_epi16(out16, out16));
+    }
+  }
+  if (width > w8) {
+    av1_add_film_grain_luma_c(luma + w8, luma_stride, grain + w8, grain_stride,
+                              width - w8, height, scaling_lut, scaling_shift,
+                              min_val, max_val);
+  }
+}
+
+void av1_add_film_grain_chroma_avx2(
+    uint8_t *chroma, int chroma_stride, const uint8_t *luma, int luma_stride,
+    const int *grain, int grain_stride, int width, int height,
+    int subsampling_x, int subsampling_y, const int *scaling_lut,
+    int luma_mult, int chroma_mult, int offset, int scaling_shift,
+    int min_val, int max_val) {
+  const int w8 = width & ~7;
+  const __m256i rounding = _mm256_set1_epi32(1 << (scaling_shift - 1));
+  const __m128i shift = _mm_cvtsi32_si128(scaling_shift);
+  const __m256i vmin = _mm256_set1_epi32(min_val);
+  const __m256i vmax = _mm256_set1_epi32(max_val);
+  const __m256i vluma_mult = _mm256_set1_epi32(luma_mult);
+  const __m256i vchroma_mult = _mm256_set1_epi32(chroma_mult);
+  const __m256i voffset = _mm256_set1_epi32(offset);
+  const __m256i max_index = _mm256_set1_epi32(255);
+  const __m256i ones = _mm256_set1_epi16(1);
+  const __m256i one = _mm256_set1_epi32(1);
+  for (int i = 0; i < height; i++) {
+    uint8_t *row = chroma + i * chroma_stride;
+    const uint8_t *luma_row = luma + (i << subsampling_y) * luma_stride;
+    const int *grain_row = grain + i * grain_stride;
+    for (int j = 0; j < w8; j += 8) {
+      __m256i average;
+      if (subsampling_x) {
+        const __m256i l =
+            _mm256_cvtepu8_epi16(xx_loadu_128(luma_row + (j << 1)));
+        average = _mm256_srai_epi32(
+            _mm256_add_epi32(_mm256_madd_epi16(l, ones), one), 1);
+      } else {
+        average = _mm256_cvtepu8_epi32(xx_loadl_64(luma_row + j));
+      }
+      const __m256i pixels = _mm256_cvtepu8_epi32(xx_loadl_64(row + j));
+      const __m256i index = chroma_index(average, pixels, vluma_mult,
+                                         vchroma_mult, voffset, max_index);
+      const __m256i out = add_grain(pixels, scaling_lut, index, grain_row + j,
+                                    rounding, shift, vmin, vmax);
+      const __m128i out16 = pack_epi32_to_epu16(out);
+      xx_storel_64(row + j, _mm_packus_epi16(out16, out16));
+    }
+  }
+  if (width > w8) {
+    av1_add_film_grain_chroma_c(
+        chroma + w8, chroma_stride, luma + (w8 << subsampling_x), luma_stride,
+        grain + w8, grain_stride, width - w8, height, subsampling_x,
+        subsampling_y, scaling_lut, luma_mult, chroma_mult, offset,
+        scaling_shift, min_val, max_val);
+  }
+}
+
+void av1_highbd_add_film_grain_luma_avx2(uint16_t *luma, int luma_stride,
+                                         const int *grain, int grain_stride,
+                                         int width, int height,
+                                         const int *scaling_lut,
+                                         int scaling_shift, int min_val,
+                                         int max_val) {
+  const int w8 = width & ~7;
+  const __m256i rounding = _mm256_set1_epi32(1 << (scaling_shift - 1));
+  const __m128i shift = _mm_cvtsi32_si128(scaling_shift);
+  const __m256i vmin = _mm256_set1_epi32(min_val);
+  const __m256i vmax = _mm256_set1_epi32(max_val);
+  for (int i = 0; i < height; i++) {
+    uint16_t *row = luma + i * luma_stride;
+    const int *grain_row = grain + i * grain_stride;
+    for (int j = 0; j < w8; j += 8) {
+      const __m256i pixels = _mm256_cvtepu16_epi32(xx_loadu_128(row + j));
+      const __m256i out = add_grain(pixels, scaling_lut, pixels, grain_row + j,
+                                    rounding, shift, vmin, vmax);
+      xx_storeu_128(row + j, pack_epi32_to_epu16(out));
+    }
+  }
+  if (width > w8) {
+    av1_highbd_add_film_grain_luma_c(luma + w8, luma_stride, grain + w8,
+                                     grain_stride, width - w8, height,
+                                     scaling_lut, scaling_shift, min_val,
+                                     max_val);
+  }
+}
+
+void av1_highbd_add_film_grain_chroma_avx2(
+    uint16_t *chroma, int chroma_stride, const uint16_t *luma, int luma_stride,
+    const int *grain, int grain_stride, int width, int height,
+    int subsampling_x, int subsampling_y, const int *scaling_lut,
+    int luma_mult, int chroma_mult, int offset, int scaling_shift,
+    int min_val, int max_val, int bd) {
+  const int w8 = width & ~7;
+  const __m256i rounding = _mm256_set1_epi32(1 << (scaling_shift - 1));
+  const __m128i shift = _mm_cvtsi32_si128(scaling_shift);
+  const __m256i vmin = _mm256_set1_epi32(min_val);
+  const __m256i vmax = _mm256_set1_epi32(max_val);
+  const __m256i vluma_mult = _mm256_set1_epi32(luma_mult);
+  const __m256i vchroma_mult = _mm256_set1_epi32(chroma_mult);
+  const __m256i voffset = _mm256_set1_epi32(offset);
+  const __m256i max_index = _mm256_set1_epi32((256 << (bd - 8)) - 1);
+  const __m256i ones = _mm256_set1_epi16(1);
+  const __m256i one = _mm256_set1_epi32(1);
+  for (int i = 0; i < height; i++) {
+    uint16_t *row = chroma + i * chroma_stride;
+    const uint16_t *luma_row = luma + (i << subsampling_y) * luma_stride;
+    const int *grain_row = grain + i * grain_stride;
+    for (int j = 0; j < w8; j += 8) {
+      __m256i average;
+      if (subsampling_x) {
+        // Samples have at most 12 bits, so they can be added as signed.
+        const __m256i l =
+            _mm256_loadu_si256((const __m256i *)(luma_row + (j << 1)));
+        average = _mm256_srai_epi32(
+            _mm256_add_epi32(_mm256_madd_epi16(l, ones), one), 1);
+      } else {
+        average = _mm256_cvtepu16_epi32(xx_loadu_128(luma_row + j));
+      }
+      const __m256i pixels = _mm256_cvtepu16_epi32(xx_loadu_128(row + j));
+      const __m256i index = chroma_index(average, pixels, vluma_mult,
+                                         vchroma_mult, voffset, max_index);
+      const __m256i out = add_grain(pixels, scaling_lut, index, grain_row + j,
+                                    rounding, shift, vmin, vmax);
+      xx_storeu_128(row + j, pack_epi32_to_epu16(out));
+    }
+  }
+  if (width > w8) {
+    av1_highbd_add_film_grain_chroma_c(
+        chroma + w8, chroma_stride, luma + (w8 << subsampling_x), luma_stride,
+        grain + w8, grain_stride, width - w8, height, subsampling_x,
+        subsampling_y, scaling_lut, luma_mult, chroma_mult, offset,
+        scaling_shift, min_val, max_val, bd);
+  }
+}
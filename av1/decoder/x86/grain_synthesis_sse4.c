@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <smmintrin.h>  // SSE4.1
+
+#include "config/av1_rtcd.h"
+
+#include "aom/aom_integer.h"
+#include "aom_dsp/x86/synonyms.h"
+#include "aom_ports/mem.h"
+
+// Returns clamp(pixel + ((scale * grain + rounding) >> shift), min, max).
+static inline __m128i add_grain(__m128i pixel, __m128i scale, __m128i grain,
+                                __m128i rounding, __m128i shift,
+                                __m128i min_val, __m128i max_val) {
+  __m128i noise = _mm_add_epi32(_mm_mullo_epi32(scale, grain), rounding);
+  noise = _mm_sra_epi32(noise, shift);
+  const __m128i sum = _mm_add_epi32(pixel, noise);
+  return _mm_min_epi32(_mm_max_epi32(sum, min_val), max_val);
+}
+
+static inline __m128i lookup4(const int *lut, const int *index) {
+  return _mm_setr_epi32(lut[index[0]], lut[index[1]], lut[index[2]],
+                        lut[index[3]]);
+}
+
+// Stores the scaling function indices of 8 chroma samples in index.
+static inline void chroma_index(__m128i average_luma_lo,
+                                __m128i average_luma_hi, __m128i pixel_lo,
+                                __m128i pixel_hi, __m128i luma_mult,
+                                __m128i chroma_mult, __m128i offset,
+                                __m128i max_index, int *index) {
+  const __m128i zero = _mm_setzero_si128();
+  __m128i lo = _mm_add_epi32(_mm_mullo_epi32(average_luma_lo, luma_mult),
+                             _mm_mullo_epi32(pixel_lo, chroma_mult));
+  __m128i hi = _mm_add_epi32(_mm_mullo_epi32(average_luma_hi, luma_mult),
+                             _mm_mullo_epi32(pixel_hi, chroma_mult));
+  lo = _mm_add_epi32(_mm_srai_epi32(lo, 6), offset);
+  hi = _mm_add_epi32(_mm_srai_epi32(hi, 6), offset);
+  lo = _mm_min_epi32(_mm_max_epi32(lo, zero), max_index);
+  hi = _mm_min_epi32(_mm_max_epi32(hi, zero), max_index);
+  _mm_storeu_si128((__m128i *)index, lo);
+  _mm_storeu_si128((__m128i *)(index + 4), hi);
+}
+
+void av1_add_film_grain_luma_sse4_1(uint8_t *luma, int luma_stride,
+                                    const int *grain, int grain_stride,
+                                    int width, int height,
+                                    const int *scaling_lut, int scaling_shift,
+                                    int min_val, int max_val) {
+  const int w8 = width & ~7;
+  const __m128i rounding = _mm_set1_epi32(1 << (scaling_shift - 1));
+  const __m128i shift = _mm_cvtsi32_si128(scaling_shift);
+  const __m128i vmin = _mm_set1_epi32(min_val);
+  const __m128i vmax = _mm_set1_epi32(max_val);
+  for (int i = 0; i < height; i++) {
+    uint8_t *row = luma + i * luma_stride;
+    const int *grain_row = grain + i * grain_stride;
+    for (int j = 0; j < w8; j += 8) {
+      const __m128i pixels = xx_loadl_64(row + j);
+      const __m128i lo = _mm_cvtepu8_epi32(pixels);
+      const __m128i hi = _mm_cvtepu8_epi32(_mm_srli_si128(pixels, 4));
+      const __m128i scale_lo =
+          _mm_setr_epi32(scaling_lut[row[j + 0]], scaling_lut[row[j + 1]],
+                         scaling_lut[row[j + 2]], scaling_lut[row[j + 3]]);
+      const __m128i scale_hi =
+          _mm_setr_epi32(scaling_lut[row[j + 4]], scaling_lut[row[j + 5]],
+                         scaling_lut[row[j + 6]], scaling_lut[row[j + 7]]);
+      const __m128i out_lo =
+          add_grain(lo, scale_lo, xx_loadu_128(grain_row + j), rounding, shift,
+                    vmin, vmax);
+      const __m128i out_hi =
+          add_grain(hi, scale_hi, xx_loadu_128(grain_row + j + 4), rounding,
+                    shift, vmin, vmax);
+      const __m128i out = _mm_packus_epi32(out_lo, out_hi);
+      xx_storel_64(row + j, _mm_packus_epi16(out, out));
+    }
+  }
+  if (width > w8) {
+    av1_add_film_grain_luma_c(luma + w8, luma_stride, grain + w8, grain_stride,
+                              width - w8, height, scaling_lut, scaling_shift,
+                              min_val, max_val);
+  }
+}
+
+void av1_add_film_grain_chroma_sse4_1(
+    uint8_t *chroma, int chroma_stride, const uint8_t *luma, int luma_stride,
+    const int *grain, int grain_stride, int width, int height,
+    int subsampling_x, int subsampling_y, const int *scaling_lut,
+    int luma_mult, int chroma_mult, int offset, int scaling_shift,
+    int min_val, int max_val) {
+  const int w8 = width & ~7;
+  const __m128i rounding = _mm_set1_epi32(1 << (scaling_shift - 1));
+  const __m128i shift = _mm_cvtsi32_si128(scaling_shift);
+  const __m128i vmin = _mm_set1_epi32(min_val);
+  const __m128i vmax = _mm_set1_epi32(max_val);
+  const __m128i vluma_mult = _mm_set1_epi32(luma_mult);
+  const __m128i vchroma_mult = _mm_set1_epi32(chroma_mult);
+  const __m128i voffset = _mm_set1_epi32(offset);
+  const __m128i max_index = _mm_set1_epi32(255);
+  const __m128i ones = _mm_set1_epi16(1);
+  const __m128i one = _mm_set1_epi32(1);
+  DECLARE_ALIGNED(16, int, index[8]);
+  for (int i = 0; i < height; i++) {
+    uint8_t *row = chroma + i * chroma_stride;
+    const uint8_t *luma_row = luma + (i << subsampling_y) * luma_stride;
+    const int *grain_row = grain + i * grain_stride;
+    for (int j = 0; j < w8; j += 8) {
+      __m128i average_lo, average_hi;
+      if (subsampling_x) {
+        const __m128i l = xx_loadu_128(luma_row + (j << 1));
+        const __m128i l_lo = _mm_cvtepu8_epi16(l);
+        const __m128i l_hi = _mm_cvtepu8_epi16(_mm_srli_si128(l, 8));
+        average_lo = _mm_srai_epi32(
+            _mm_add_epi32(_mm_madd_epi16(l_lo, ones), one), 1);
+        average_hi = _mm_srai_epi32(
+            _mm_add_epi32(_mm_madd_epi16(l_hi, ones), one), 1);
+      } else {
+        const __m128i l = xx_loadl_64(luma_row + j);
+        average_lo = _mm_cvtepu8_epi32(l);
+        average_hi = _mm_cvtepu8_epi32(_mm_srli_si128(l, 4));
+      }
+      const __m128i pixels = xx_loadl_64(row + j);
+      const __m128i lo = _mm_cvtepu8_epi32(pixels);
+      const __m128i hi = _mm_cvtepu8_epi32(_mm_srli_si128(pixels, 4));
+      chroma_index(average_lo, average_hi, lo, hi, vluma_mult, vchroma_mult,
+                   voffset, max_index, index);
+      const __m128i out_lo =
+          add_grain(lo, lookup4(scaling_lut, index),
+                    xx_loadu_128(grain_row + j), rounding, shift, vmin, vmax);
+      const __m128i out_hi = add_grain(
+          hi, lookup4(scaling_lut, index + 4), xx_loadu_128(grain_row + j + 4),
+          rounding, shift, vmin, vmax);
+      const __m128i out = _mm_packus_epi32(out_lo, out_hi);
+      xx_storel_64(row + j, _mm_packus_epi16(out, out));
+    }
+  }
+  if (width > w8) {
+    av1_add_film_grain_chroma_c(
+        chroma + w8, chroma_stride, luma + (w8 << subsampling_x), luma_stride,
+        grain + w8, grain_stride, width - w8, height, subsampling_x,
+        subsampling_y, scaling_lut, luma_mult, chroma_mult, offset,
+        scaling_shift, min_val, max_val);
+  }
+}
+
+void av1_highbd_add_film_grain_luma_sse4_1(uint16_t *luma, int luma_stride,
+                                           const int *grain, int grain_stride,
+                                           int width, int height,
+                                           const int *scaling_lut,
+                                           int scaling_shift, int min_val,
+                                           int max_val) {
+  const int w8 = width & ~7;
+  const __m128i rounding = _mm_set1_epi32(1 << (scaling_shift - 1));
+  const __m128i shift = _mm_cvtsi32_si128(scaling_shift);
+  const __m128i vmin = _mm_set1_epi32(min_val);
+  const __m128i vmax = _mm_set1_epi32(max_val);
+  for (int i = 0; i < height; i++) {
+    uint16_t *row = luma + i * luma_stride;
+    const int *grain_row = grain + i * grain_stride;
+    for (int j = 0; j < w8; j += 8) {
+      const __m128i pixels = xx_loadu_128(row + j);
+      const __m128i lo = _mm_cvtepu16_epi32(pixels);
+      const __m128i hi = _mm_cvtepu16_epi32(_mm_srli_si128(pixels, 8));
+      const __m128i scale_lo =
+          _mm_setr_epi32(scaling_lut[row[j + 0]], scaling_lut[row[j + 1]],
+                         scaling_lut[row[j + 2]], scaling_lut[row[j + 3]]);
+      const __m128i scale_hi =
+          _mm_setr_epi32(scaling_lut[row[j + 4]], scaling_lut[row[j + 5]],
+                         scaling_lut[row[j + 6]], scaling_lut[row[j + 7]]);
+      const __m128i out_lo =
+          add_grain(lo, scale_lo, xx_loadu_128(grain_row + j), rounding, shift,
+                    vmin, vmax);
+      const __m128i out_hi =
+          add_grain(hi, scale_hi, xx_loadu_128(grain_row + j + 4), rounding,
+                    shift, vmin, vmax);
+      xx_storeu_128(row + j, _mm_packus_epi32(out_lo, out_hi));
+    }
+  }
+  if (width > w8) {
+    av1_highbd_add_film_grain_luma_c(luma + w8, luma_stride, grain + w8,
+                                     grain_stride, width - w8, height,
+                                     scaling_lut, scaling_shift, min_val,
+                                     max_val);
+  }
+}
+
+void av1_highbd_add_film_grain_chroma_sse4_1(
+    uint16_t *chroma, int chroma_stride, const uint16_t *luma, int luma_stride,
+    const int *grain, int grain_stride, int width, int height,
+    int subsampling_x, int subsampling_y, const int *scaling_lut,
+    int luma_mult, int chroma_mult, int offset, int scaling_shift,
+    int min_val, int max_val, int bd) {
+  const int w8 = width & ~7;
+  const __m128i rounding = _mm_set1_epi32(1 << (scaling_shift - 1));
+  const __m128i shift = _mm_cvtsi32_si128(scaling_shift);
+  const __m128i vmin = _mm_set1_epi32(min_val);
+  const __m128i vmax = _mm_set1_epi32(max_val);
+  const __m128i vluma_mult = _mm_set1_epi32(luma_mult);
+  const __m128i vchroma_mult = _mm_set1_epi32(chroma_mult);
+  const __m128i voffset = _mm_set1_epi32(offset);
+  const __m128i max_index = _mm_set1_epi32((256 << (bd - 8)) - 1);
+  const __m128i ones = _mm_set1_epi16(1);
+  const __m128i one = _mm_set1_epi32(1);
+  DECLARE_ALIGNED(16, int, index[8]);
+  for (int i = 0; i < height; i++) {
+    uint16_t *row = chroma + i * chroma_stride;
+    const uint16_t *luma_row = luma + (i << subsampling_y) * luma_stride;
+    const int *grain_row = grain + i * grain_stride;
+    for (int j = 0; j < w8; j += 8) {
+      __m128i average_lo, average_hi;
+      if (subsampling_x) {
+        // Samples have at most 12 bits, so they can be added as signed.
+        const __m128i l_lo = xx_loadu_128(luma_row + (j << 1));
+        const __m128i l_hi = xx_loadu_128(luma_row + (j << 1) + 8);
+        average_lo = _mm_srai_epi32(
+            _mm_add_epi32(_mm_madd_epi16(l_lo, ones), one), 1);
+        average_hi = _mm_srai_epi32(
+            _mm_add_epi32(_mm_madd_epi16(l_hi, ones), one), 1);
+      } else {
+        const __m128i l = xx_loadu_128(luma_row + j);
+        average_lo = _mm_cvtepu16_epi32(l);
+        average_hi = _mm_cvtepu16_epi32(_mm_srli_si128(l, 8));
+      }
+      const __m128i pixels = xx_loadu_128(row + j);
+      const __m128i lo = _mm_cvtepu16_epi32(pixels);
+      const __m128i hi = _mm_cvtepu16_epi32(_mm_srli_si128(pixels, 8));
+      chroma_index(average_lo, average_hi, lo, hi, vluma_mult, vchroma_mult,
+                   voffset, max_index, index);
+      const __m128i out_lo =
+          add_grain(lo, lookup4(scaling_lut, index),
+                    xx_loadu_128(grain_row + j), rounding, shift, vmin, vmax);
+      const __m128i out_hi = add_grain(
+          hi, lookup4(scaling_lut, index + 4), xx_loadu_128(grain_row + j + 4),
+          rounding, shift, vmin, vmax);
+      xx_storeu_128(row + j, _mm_packus_epi32(out_lo, out_hi));
+    }
+  }
+  if (width > w8) {
+    av1_highbd_add_film_grain_chroma_c(
+        chroma + w8, chroma_stride, luma + (w8 << subsampling_x), luma_stride,
+        grain + w8, grain_stride, width - w8, height, subsampling_x,
+        subsampling_y, scaling_lut, luma_mult, chroma_mult, offset,
+        scaling_shift, min_val, max_val, bd);
+  }
+}
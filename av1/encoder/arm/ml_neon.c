@@ -15,6 +15,7 @@
 
 #include "config/aom_config.h"
 #include "config/av1_rtcd.h"
+#include "aom_dsp/arm/sum_neon.h"
 #include "av1/encoder/ml.h"
 
 static void nn_activate8(float32x4_t *out_h, float32x4_t *out_l,
@@ -337,3 +338,145 @@ void av1_nn_predict_neon(const float *input_nodes,
   }
   if (reduce_prec) av1_nn_output_prec_reduce(output, nn_config->num_outputs);
 }
+
+void av1_nn_fc_q_neon(const int16_t *input, const int8_t *weights,
+                      int weights_stride, int num_outputs, int32_t *output) {
+  assert(weights_stride % NN_Q_INPUT_ALIGN == 0);
+  for (int node = 0; node < num_outputs; ++node) {
+    int32x4_t sum0 = vdupq_n_s32(0);
+    int32x4_t sum1 = vdupq_n_s32(0);
+    for (int i = 0; i < weights_stride; i += 16) {
+      const int8x16_t w = vld1q_s8(weights + i);
+      const int16x8_t w_lo = vmovl_s8(vget_low_s8(w));
+      const int16x8_t w_hi = vmovl_s8(vget_high_s8(w));
+      const int16x8_t in_lo = vld1q_s16(input + i);
+      const int16x8_t in_hi = vld1q_s16(input + i + 8);
+      sum0 = vmlal_s16(sum0, vget_low_s16(w_lo), vget_low_s16(in_lo));
+      sum1 = vmlal_s16(sum1, vget_high_s16(w_lo), vget_high_s16(in_lo));
+      sum0 = vmlal_s16(sum0, vget_low_s16(w_hi), vget_low_s16(in_hi));
+      sum1 = vmlal_s16(sum1, vget_high_s16(w_hi), vget_high_s16(in_hi));
+    }
+    output[node] = horizontal_add_s32x4(vaddq_s32(sum0, sum1));
+    weights += weights_stride;
+  }
+}
+
+// Returns the sums of the lanes of a0, a1, a2 and a3.
+static inline float32x4_t horizontal_add_4x4_f32(float32x4_t a0,
+                                                 float32x4_t a1,
+                                                 float32x4_t a2,
+                                                 float32x4_t a3) {
+#if AOM_ARCH_AARCH64
+  return vpaddq_f32(vpaddq_f32(a0, a1), vpaddq_f32(a2, a3));
+#else
+  const float32x2_t sum0 = vadd_f32(vget_low_f32(a0), vget_high_f32(a0));
+  const float32x2_t sum1 = vadd_f32(vget_low_f32(a1), vget_high_f32(a1));
+  const float32x2_t sum2 = vadd_f32(vget_low_f32(a2), vget_high_f32(a2));
+  const float32x2_t sum3 = vadd_f32(vget_low_f32(a3), vget_high_f32(a3));
+  return vcombine_f32(vpadd_f32(sum0, sum1), vpadd_f32(sum2, sum3));
+#endif
+}
+
+static inline float horizontal_add_f32(float32x4_t a) {
+#if AOM_ARCH_AARCH64
+  return vaddvq_f32(a);
+#else
+  float32x2_t sum = vadd_f32(vget_low_f32(a), vget_high_f32(a));
+  sum = vpadd_f32(sum, sum);
+  return vget_lane_f32(sum, 0);
+#endif
+}
+
+// Computes nodes node to node + 3 of 2 samples at a time, so that each load
+// of input is used for 4 nodes and each load of weights for 2 samples, with 8
+// accumulators.
+static inline void nn_fc_2x4(const float *input, int num_inputs,
+                             const float *weights, const float *bias, int node,
+                             int num_outputs, int relu, float *output) {
+  const float *const in0 = input;
+  const float *const in1 = input + num_inputs;
+  const float *const w0 = weights + node * num_inputs;
+  const float *const w1 = w0 + num_inputs;
+  const float *const w2 = w1 + num_inputs;
+  const float *const w3 = w2 + num_inputs;
+  float32x4_t acc00 = vdupq_n_f32(0), acc01 = vdupq_n_f32(0);
+  float32x4_t acc02 = vdupq_n_f32(0), acc03 = vdupq_n_f32(0);
+  float32x4_t acc10 = vdupq_n_f32(0), acc11 = vdupq_n_f32(0);
+  float32x4_t acc12 = vdupq_n_f32(0), acc13 = vdupq_n_f32(0);
+  int i = 0;
+  for (; i + 4 <= num_inputs; i += 4) {
+    const float32x4_t x0 = vld1q_f32(in0 + i);
+    const float32x4_t x1 = vld1q_f32(in1 + i);
+    const float32x4_t y0 = vld1q_f32(w0 + i);
+    const float32x4_t y1 = vld1q_f32(w1 + i);
+    const float32x4_t y2 = vld1q_f32(w2 + i);
+    const float32x4_t y3 = vld1q_f32(w3 + i);
+    acc00 = vmlaq_f32(acc00, x0, y0);
+    acc01 = vmlaq_f32(acc01, x0, y1);
+    acc02 = vmlaq_f32(acc02, x0, y2);
+    acc03 = vmlaq_f32(acc03, x0, y3);
+    acc10 = vmlaq_f32(acc10, x1, y0);
+    acc11 = vmlaq_f32(acc11, x1, y1);
+    acc12 = vmlaq_f32(acc12, x1, y2);
+    acc13 = vmlaq_f32(acc13, x1, y3);
+  }
+  float32x4_t out0 = horizontal_add_4x4_f32(acc00, acc01, acc02, acc03);
+  float32x4_t out1 = horizontal_add_4x4_f32(acc10, acc11, acc12, acc13);
+  for (; i < num_inputs; ++i) {
+    const float y[4] = { w0[i], w1[i], w2[i], w3[i] };
+    const float32x4_t yv = vld1q_f32(y);
+    out0 = vmlaq_n_f32(out0, yv, in0[i]);
+    out1 = vmlaq_n_f32(out1, yv, in1[i]);
+  }
+  const float32x4_t b = vld1q_f32(bias + node);
+  out0 = vaddq_f32(out0, b);
+  out1 = vaddq_f32(out1, b);
+  if (relu) {
+    out0 = vmaxq_f32(out0, vdupq_n_f32(0));
+    out1 = vmaxq_f32(out1, vdupq_n_f32(0));
+  }
+  vst1q_f32(output + node, out0);
+  vst1q_f32(output + num_outputs + node, out1);
+}
+
+// Computes one node of one sample.
+static inline float nn_fc_1x1(const float *input, int num_inputs,
+                              const float *node_weights, float bias,
+                              int relu) {
+  float32x4_t acc = vdupq_n_f32(0);
+  int i = 0;
+  for (; i + 4 <= num_inputs; i += 4) {
+    acc = vmlaq_f32(acc, vld1q_f32(input + i), vld1q_f32(node_weights + i));
+  }
+  float val = bias + horizontal_add_f32(acc);
+  for (; i < num_inputs; ++i) val += input[i] * node_weights[i];
+  return relu ? AOMMAX(val, 0.0f) : val;
+}
+
+void av1_nn_fc_batch_neon(const float *input, int num_samples, int num_inputs,
+                          const float *weights, const float *bias,
+                          int num_outputs, int relu, float *output) {
+  int sample = 0;
+  for (; sample + 2 <= num_samples; sample += 2) {
+    int node = 0;
+    for (; node + 4 <= num_outputs; node += 4) {
+      nn_fc_2x4(input, num_inputs, weights, bias, node, num_outputs, relu,
+                output);
+    }
+    for (; node < num_outputs; ++node) {
+      const float *const node_weights = weights + node * num_inputs;
+      output[node] =
+          nn_fc_1x1(input, num_inputs, node_weights, bias[node], relu);
+      output[num_outputs + node] = nn_fc_1x1(
+          input + num_inputs, num_inputs, node_weights, bias[node], relu);
+    }
+    input += 2 * num_inputs;
+    output += 2 * num_outputs;
+  }
+  if (sample < num_samples) {
+    for (int node = 0; node < num_outputs; ++node) {
+      output[node] = nn_fc_1x1(input, num_inputs, weights + node * num_inputs,
+                               bias[node], relu);
+    }
+  }
+}
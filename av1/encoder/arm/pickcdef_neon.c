@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <arm_neon.h>
+
+#include "config/aom_config.h"
+#include "config/av1_rtcd.h"
+#include "aom_dsp/aom_dsp_common.h"
+
+void av1_cdef_add_best_mse_neon(uint64_t *tot_mse, const uint64_t *mse,
+                                uint64_t offset, uint64_t best_mse, int n) {
+  const uint64x2_t offset_v = vdupq_n_u64(offset);
+  const uint64x2_t best_v = vdupq_n_u64(best_mse);
+  int k = 0;
+  for (; k + 4 <= n; k += 4) {
+    const uint64x2_t curr0 = vaddq_u64(vld1q_u64(mse + k), offset_v);
+    const uint64x2_t curr1 = vaddq_u64(vld1q_u64(mse + k + 2), offset_v);
+    // min(curr, best) = curr - max(curr - best, 0), which avoids the 64-bit
+    // comparisons that Armv7 lacks.
+    const uint64x2_t min0 = vsubq_u64(curr0, vqsubq_u64(curr0, best_v));
+    const uint64x2_t min1 = vsubq_u64(curr1, vqsubq_u64(curr1, best_v));
+    vst1q_u64(tot_mse + k, vaddq_u64(vld1q_u64(tot_mse + k), min0));
+    vst1q_u64(tot_mse + k + 2, vaddq_u64(vld1q_u64(tot_mse + k + 2), min1));
+  }
+  for (; k < n; k++) {
+    const uint64_t curr = offset + mse[k];
+    tot_mse[k] += AOMMIN(curr, best_mse);
+  }
+}
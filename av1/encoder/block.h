@@ -376,6 +376,12 @@ typedef struct {
   uint8_t *tmp_best_mask_buf;
 } CompoundTypeRdBuffers;
 
+#if !CONFIG_REALTIME_ONLY
+//! Number of blocks of the quad tree used by the intra frame partitioning CNN:
+//! one 64x64, four 32x32, sixteen 16x16 and sixty-four 8x8 blocks.
+#define CNN_QUAD_TREE_NODES (1 + 4 + 16 + 64)
+#endif
+
 /*! \brief Holds some parameters related to partitioning schemes in AV1.
  */
 // TODO(chiyotsai@google.com): Consolidate this with SIMPLE_MOTION_DATA_TREE
@@ -394,6 +400,15 @@ typedef struct {
   float cnn_buffer[CNN_OUT_BUF_SIZE];
   //! log of the quantization parameter of the ancestor BLOCK_64X64.
   float log_q;
+  /*! \brief Outputs of the DNN for the blocks of the partition block quad
+   * tree, indexed by quad_tree_idx.
+   *
+   * The blocks of depth d, i.e. of size 64x64 >> d, are valid if bit d of
+   * cnn_logits_valid is set.
+   */
+  float cnn_logits[CNN_QUAD_TREE_NODES];
+  //! Depths of the quad tree for which cnn_logits is valid.
+  int cnn_logits_valid;
 #endif
 
   /*! \brief Variance of the subblocks in the superblock.
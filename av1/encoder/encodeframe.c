@@ -1739,17 +1739,113 @@ static void populate_thresh_to_force_zeromv_skip(AV1_COMP *cpi) {
   }
 }
 
-static void free_block_hash_buffers(uint32_t *block_hash_values[2][2],
-                                    int8_t *is_block_same[2][3]) {
+// Runs the current stage of the hash table construction on all the bands.
+static void run_hash_table_build_stage(AV1_COMP *cpi, HashTableBuildCtx *ctx,
+                                       HASH_TABLE_BUILD_STAGE stage) {
+  ctx->stage = stage;
+  if (ctx->num_bands > 1) {
+    av1_hash_table_build_mt(cpi, ctx, cpi->mt_info.num_workers);
+  } else {
+    av1_hash_table_build_band(ctx, 0);
+  }
+}
+
+// The hash table of the previous picture is updated rather than rebuilt when
+// at most 1 / HASH_TABLE_UPDATE_MAX_CHANGED_RATIO of its superblocks changed.
+// The update runs on a single thread, while the build is multithreaded.
+#define HASH_TABLE_UPDATE_MAX_CHANGED_RATIO 4
+
+// Builds the hash table of the blocks of the source frame used by the hash
+// based IntraBC motion search. The table of the previous source frame is kept
+// if the frames are the same, e.g. when the frame is recoded, and updated if
+// they only differ in a few superblocks, as is common for screen content.
+static void build_intrabc_hash_table(AV1_COMP *cpi,
+                                     IntraBCHashInfo *intrabc_hash_info) {
+  AV1_COMMON *const cm = &cpi->common;
+  hash_table *const p_hash_table = &intrabc_hash_info->intrabc_hash_table;
+  const int pic_width = cpi->source->y_crop_width;
+  const int pic_height = cpi->source->y_crop_height;
+  const size_t num_pels = (size_t)pic_width * pic_height;
+  // Hash data generated for screen contents is used for intraBC ME
+  const int min_alloc_size = block_size_wide[cm->mi_params.mi_alloc_bsize];
+  const int max_sb_size =
+      (1 << (cm->seq_params->mib_size_log2 + MI_SIZE_LOG2));
+  const int num_cells = ((pic_width + max_sb_size - 1) / max_sb_size) *
+                        ((pic_height + max_sb_size - 1) / max_sb_size);
+  AVxArena *const arena = &cpi->frame_arena;
+  const AVxArenaMark arena_mark = aom_arena_mark(arena);
+
+  uint8_t *changed_cells;
+  CHECK_MEM_ERROR(cm, changed_cells, aom_arena_malloc(arena, num_cells));
+  av1_hash_table_init(intrabc_hash_info);
+  const int num_changed_cells = av1_hash_table_find_changed_cells(
+      p_hash_table, cpi->source, min_alloc_size, max_sb_size, changed_cells);
+  if (num_changed_cells == 0) {
+    aom_arena_release(arena, arena_mark);
+    return;
+  }
+
+  HashTableBuildCtx ctx;
+  ctx.intrabc_hash_info = intrabc_hash_info;
+  ctx.picture = cpi->source;
+  ctx.num_bands = AOMMAX(cpi->mt_info.num_workers, 1);
   for (int k = 0; k < 2; ++k) {
     for (int j = 0; j < 2; ++j) {
-      aom_free(block_hash_values[k][j]);
+      CHECK_MEM_ERROR(
+          cm, ctx.block_hash_values[k][j],
+          aom_arena_malloc(arena,
+                           num_pels * sizeof(*ctx.block_hash_values[0][0])));
     }
-
     for (int j = 0; j < 3; ++j) {
-      aom_free(is_block_same[k][j]);
+      CHECK_MEM_ERROR(
+          cm, ctx.is_block_same[k][j],
+          aom_arena_malloc(arena, num_pels * sizeof(*ctx.is_block_same[0][0])));
     }
   }
+
+  const int update = num_changed_cells > 0 &&
+                     num_changed_cells * HASH_TABLE_UPDATE_MAX_CHANGED_RATIO <=
+                         num_cells;
+  if (update) {
+    if (!av1_hash_table_update(&ctx, changed_cells)) {
+      aom_internal_error(cm->error, AOM_CODEC_MEM_ERROR,
+                         "Error updating intrabc_hash_table");
+    }
+  } else {
+    if (!av1_hash_table_create(p_hash_table)) {
+      aom_internal_error(cm->error, AOM_CODEC_MEM_ERROR,
+                         "Error allocating intrabc_hash_table");
+    }
+    ctx.block_size = 2;
+    ctx.dst_idx = 0;
+    run_hash_table_build_stage(cpi, &ctx, HASH_TABLE_GENERATE);
+    for (int size = 4; size <= max_sb_size; size *= 2) {
+      ctx.block_size = size;
+      ctx.dst_idx = !ctx.dst_idx;
+      run_hash_table_build_stage(cpi, &ctx, HASH_TABLE_GENERATE);
+      if (size >= min_alloc_size) {
+        if (!av1_hash_table_begin_block_size(p_hash_table, size,
+                                             ctx.num_bands)) {
+          aom_internal_error(cm->error, AOM_CODEC_MEM_ERROR,
+                             "Error adding data to intrabc_hash_table");
+        }
+        run_hash_table_build_stage(cpi, &ctx, HASH_TABLE_COUNT);
+        if (!av1_hash_table_assign_buckets(p_hash_table, size,
+                                           ctx.num_bands)) {
+          aom_internal_error(cm->error, AOM_CODEC_MEM_ERROR,
+                             "Error adding data to intrabc_hash_table");
+        }
+        run_hash_table_build_stage(cpi, &ctx, HASH_TABLE_FILL);
+      }
+    }
+  }
+  if (!av1_hash_table_set_picture(p_hash_table, cpi->source, min_alloc_size,
+                                  max_sb_size,
+                                  update ? changed_cells : NULL)) {
+    aom_internal_error(cm->error, AOM_CODEC_MEM_ERROR,
+                       "Error allocating intrabc_hash_table");
+  }
+  aom_arena_release(arena, arena_mark);
 }
 
 /*!\brief Encoder setup(only for the current frame), encoding, and recontruction
@@ -1814,74 +1910,9 @@ static inline void encode_frame_internal(AV1_COMP *cpi) {
       features->allow_warped_motion = 0;
   }
 
-  int hash_table_created = 0;
   if (!is_stat_generation_stage(cpi) && av1_use_hash_me(cpi) &&
       !cpi->sf.rt_sf.use_nonrd_pick_mode) {
-    // TODO(any): move this outside of the recoding loop to avoid recalculating
-    // the hash table.
-    // add to hash table
-    const int pic_width = cpi->source->y_crop_width;
-    const int pic_height = cpi->source->y_crop_height;
-    uint32_t *block_hash_values[2][2] = { { NULL } };
-    int8_t *is_block_same[2][3] = { { NULL } };
-    int k, j;
-    bool error = false;
-
-    for (k = 0; k < 2 && !error; ++k) {
-      for (j = 0; j < 2; ++j) {
-        block_hash_values[k][j] = (uint32_t *)aom_malloc(
-            sizeof(*block_hash_values[0][0]) * pic_width * pic_height);
-        if (!block_hash_values[k][j]) {
-          error = true;
-          break;
-        }
-      }
-
-      for (j = 0; j < 3 && !error; ++j) {
-        is_block_same[k][j] = (int8_t *)aom_malloc(
-            sizeof(*is_block_same[0][0]) * pic_width * pic_height);
-        if (!is_block_same[k][j]) error = true;
-      }
-    }
-
-    av1_hash_table_init(intrabc_hash_info);
-    if (error ||
-        !av1_hash_table_create(&intrabc_hash_info->intrabc_hash_table)) {
-      free_block_hash_buffers(block_hash_values, is_block_same);
-      aom_internal_error(cm->error, AOM_CODEC_MEM_ERROR,
-                         "Error allocating intrabc_hash_table and buffers");
-    }
-    hash_table_created = 1;
-    av1_generate_block_2x2_hash_value(intrabc_hash_info, cpi->source,
-                                      block_hash_values[0], is_block_same[0]);
-    // Hash data generated for screen contents is used for intraBC ME
-    const int min_alloc_size = block_size_wide[mi_params->mi_alloc_bsize];
-    const int max_sb_size =
-        (1 << (cm->seq_params->mib_size_log2 + MI_SIZE_LOG2));
-    int src_idx = 0;
-    for (int size = 4; size <= max_sb_size; size *= 2, src_idx = !src_idx) {
-      const int dst_idx = !src_idx;
-      av1_generate_block_hash_value(
-          intrabc_hash_info, cpi->source, size, block_hash_values[src_idx],
-          block_hash_values[dst_idx], is_block_same[src_idx],
-          is_block_same[dst_idx]);
-      if (size >= min_alloc_size) {
-        if (!av1_add_to_hash_map_by_row_with_precal_data(
-                &intrabc_hash_info->intrabc_hash_table,
-                block_hash_values[dst_idx], is_block_same[dst_idx][2],
-                pic_width, pic_height, size)) {
-          error = true;
-          break;
-        }
-      }
-    }
-
-    free_block_hash_buffers(block_hash_values, is_block_same);
-
-    if (error) {
-      aom_internal_error(cm->error, AOM_CODEC_MEM_ERROR,
-                         "Error adding data to intrabc_hash_table");
-    }
+    build_intrabc_hash_table(cpi, intrabc_hash_info);
   }
 
   const CommonQuantParams *quant_params = &cm->quant_params;
@@ -2303,9 +2334,6 @@ static inline void encode_frame_internal(AV1_COMP *cpi) {
       }
     }
   }
-  if (hash_table_created) {
-    av1_hash_table_destroy(&intrabc_hash_info->intrabc_hash_table);
-  }
 }
 
 /*!\brief Setup reference frame buffers and encode a frame
@@ -73,6 +73,7 @@
 #include "av1/encoder/hybrid_fwd_txfm.h"
 #include "av1/encoder/intra_mode_search.h"
 #include "av1/encoder/mv_prec.h"
+#include "av1/encoder/partition_strategy.h"
 #include "av1/encoder/pass2_strategy.h"
 #include "av1/encoder/pickcdef.h"
 #include "av1/encoder/picklpf.h"
@@ -90,11 +91,17 @@
 #include "av1/encoder/superres_scale.h"
 #include "av1/encoder/thirdpass.h"
 #include "av1/encoder/tpl_model.h"
+#include "av1/encoder/tx_search.h"
 #include "av1/encoder/reconinter_enc.h"
 #include "av1/encoder/var_based_part.h"
 
 #define DEFAULT_EXPLICIT_ORDER_HINT_BITS 7
 
+// Initial block sizes of the scratch arenas. The arenas grow to the peak
+// requirement of the encoder within the first few frames.
+#define FRAME_ARENA_BLOCK_SIZE (256 * 1024)
+#define GOP_ARENA_BLOCK_SIZE (64 * 1024)
+
 // #define OUTPUT_YUV_REC
 #ifdef OUTPUT_YUV_REC
 FILE *yuv_rec_file;
@@ -239,6 +246,10 @@ void av1_initialize_enc(unsigned int usage, enum aom_rc_mode end_usage) {
   aom_scale_rtcd();
   av1_init_intra_predictors();
   av1_init_me_luts();
+#if !CONFIG_REALTIME_ONLY
+  av1_init_partition_nn_models();
+#endif
+  av1_init_tx_nn_models();
   if (!is_allintra) av1_init_wedge_masks();
   if (!is_allintra || end_usage != AOM_Q) av1_rc_init_minq_luts();
 }
@@ -1017,6 +1028,7 @@ AV1_PRIMARY *av1_create_primary_compressor(
   ppi->b_calculate_psnr = CONFIG_INTERNAL_STATS;
   ppi->frames_left = oxcf->input_cfg.limit;
   ppi->num_fp_contexts = 1;
+  av1_motion_field_cache_init(&ppi->motion_field_cache);
 
   init_config_sequence(ppi, oxcf);
 
@@ -1370,6 +1382,8 @@ AV1_COMP *av1_create_compressor(AV1_PRIMARY *ppi, const AV1EncoderConfig *oxcf,
   av1_zero(*cpi);
 
   cpi->ppi = ppi;
+  aom_arena_init(&cpi->frame_arena, FRAME_ARENA_BLOCK_SIZE);
+  aom_arena_init(&cpi->gop_arena, GOP_ARENA_BLOCK_SIZE);
 
   AV1_COMMON *volatile const cm = &cpi->common;
   cm->seq_params = &ppi->seq_params;
@@ -1637,6 +1651,7 @@ void av1_remove_primary_compressor(AV1_PRIMARY *ppi) {
 #if !CONFIG_REALTIME_ONLY
   av1_tf_info_free(&ppi->tf_info);
 #endif  // !CONFIG_REALTIME_ONLY
+  av1_motion_field_cache_free(&ppi->motion_field_cache);
 
   for (int i = 0; i < MAX_NUM_OPERATING_POINTS; ++i) {
     aom_free(ppi->level_params.level_info[i]);
@@ -1657,6 +1672,10 @@ void av1_remove_primary_compressor(AV1_PRIMARY *ppi) {
 
 #if !CONFIG_REALTIME_ONLY
   av1_tpl_dealloc(&tpl_data->tpl_mt_sync);
+  for (int i = 0; i < INTER_REFS_PER_FRAME; ++i) {
+    av1_free_flow_field(tpl_data->flow_buf[i]);
+    tpl_data->flow_buf[i] = NULL;
+  }
 #endif
 
   av1_terminate_workers(ppi);
@@ -1710,7 +1729,6 @@ void av1_remove_compressor(AV1_COMP *cpi) {
 #if CONFIG_MULTITHREAD
   pthread_mutex_t *const enc_row_mt_mutex_ = mt_info->enc_row_mt.mutex_;
   pthread_cond_t *const enc_row_mt_cond_ = mt_info->enc_row_mt.cond_;
-  pthread_mutex_t *const gm_mt_mutex_ = mt_info->gm_sync.mutex_;
   pthread_mutex_t *const tpl_error_mutex_ = mt_info->tpl_row_mt.mutex_;
   pthread_mutex_t *const pack_bs_mt_mutex_ = mt_info->pack_bs_sync.mutex_;
   if (enc_row_mt_mutex_ != NULL) {
@@ -1721,10 +1739,6 @@ void av1_remove_compressor(AV1_COMP *cpi) {
     pthread_cond_destroy(enc_row_mt_cond_);
     aom_free(enc_row_mt_cond_);
   }
-  if (gm_mt_mutex_ != NULL) {
-    pthread_mutex_destroy(gm_mt_mutex_);
-    aom_free(gm_mt_mutex_);
-  }
   if (tpl_error_mutex_ != NULL) {
     pthread_mutex_destroy(tpl_error_mutex_);
     aom_free(tpl_error_mutex_);
@@ -1740,6 +1754,7 @@ void av1_remove_compressor(AV1_COMP *cpi) {
     av1_row_mt_sync_mem_dealloc(&cpi->ppi->intra_row_mt_sync);
     av1_loop_filter_dealloc(&mt_info->lf_row_sync);
     av1_cdef_mt_dealloc(&mt_info->cdef_sync);
+    av1_task_pool_dealloc(&mt_info->task_pool);
 #if !CONFIG_REALTIME_ONLY
     av1_loop_restoration_dealloc(&mt_info->lr_row_sync);
     av1_tf_mt_dealloc(&mt_info->tf_sync);
@@ -1756,6 +1771,9 @@ void av1_remove_compressor(AV1_COMP *cpi) {
 
   av1_remove_common(cm);
 
+  aom_arena_free(&cpi->frame_arena);
+  aom_arena_free(&cpi->gop_arena);
+
   aom_free(cpi);
 
 #ifdef OUTPUT_YUV_REC
@@ -1826,6 +1844,7 @@ int av1_set_reference_enc(AV1_COMP *cpi, int idx, YV12_BUFFER_CONFIG *sd) {
   YV12_BUFFER_CONFIG *cfg = get_ref_frame(cm, idx);
   if (cfg) {
     aom_yv12_copy_frame(sd, cfg, num_planes);
+    av1_invalidate_scaled_ref_cache(cpi, cm->ref_frame_map[idx]);
     return 0;
   } else {
     return -1;
@@ -2024,7 +2043,8 @@ static void init_motion_estimation(AV1_COMP *cpi) {
                              cpi->oxcf.frm_dim_cfg.height != cm->height) ||
                             av1_superres_scaled(cm))
                                ? y_stride
-                               : cpi->ppi->lookahead->buf->img.y_stride;
+                               : av1_lookahead_own_y_stride(
+                                     cpi->ppi->lookahead->buf);
   int fpf_y_stride =
       cm->cur_frame != NULL ? cm->cur_frame->buf.y_stride : y_stride;
 
@@ -2828,6 +2848,10 @@ static int encode_with_recode_loop(AV1_COMP *cpi, size_t *size, uint8_t *dest) {
 #if CONFIG_TUNE_VMAF
   if (oxcf->tune_cfg.tuning == AOM_TUNE_VMAF_NEG_MAX_GAIN) {
     av1_vmaf_neg_preprocessing(cpi, cpi->unscaled_source);
+#if !CONFIG_REALTIME_ONLY
+    aom_invalidate_pyramid(cpi->unscaled_source->y_pyramid);
+    av1_invalidate_corner_list(cpi->unscaled_source->corners);
+#endif  // !CONFIG_REALTIME_ONLY
   }
 #endif
 
@@ -3878,9 +3902,18 @@ static int encode_frame_to_data_rate(AV1_COMP *cpi, size_t *size,
   }
 
 #if !CONFIG_REALTIME_ONLY
-  if (cpi->oxcf.tool_cfg.enable_global_motion && !frame_is_intra_only(cm)) {
-    // Flush any stale global motion information, which may be left over
-    // from a previous frame
+  // The pyramid of a source buffer is invalidated whenever a frame is written
+  // to the buffer, so that a pyramid computed earlier for this frame, e.g. by
+  // the tpl model, is reused by global motion search. Only the rtc temporal
+  // filter and the temporal denoiser filter the source in place while it is
+  // encoded, which may leave stale global motion information from a previous
+  // encode of the buffer.
+  int source_filtered_in_place = cpi->sf.rt_sf.use_rtc_tf;
+#if CONFIG_AV1_TEMPORAL_DENOISING
+  source_filtered_in_place |= cpi->oxcf.noise_sensitivity > 0;
+#endif  // CONFIG_AV1_TEMPORAL_DENOISING
+  if (cpi->oxcf.tool_cfg.enable_global_motion && !frame_is_intra_only(cm) &&
+      source_filtered_in_place) {
     aom_invalidate_pyramid(cpi->source->y_pyramid);
     av1_invalidate_corner_list(cpi->source->corners);
   }
@@ -4080,9 +4113,12 @@ static int apply_denoise_2d(AV1_COMP *cpi, const YV12_BUFFER_CONFIG *sd,
     }
     memset(cpi->film_grain_table, 0, sizeof(*cpi->film_grain_table));
   }
-  if (aom_denoise_and_model_run(cpi->denoise_and_model, sd,
-                                &cm->film_grain_params,
-                                cpi->oxcf.enable_dnl_denoising)) {
+  // The encoder workers are idle until the frame is encoded.
+  const PrimaryMultiThreadInfo *const p_mt_info = &cpi->ppi->p_mt_info;
+  if (aom_denoise_and_model_run_mt(
+          cpi->denoise_and_model, sd, &cm->film_grain_params,
+          cpi->oxcf.enable_dnl_denoising, p_mt_info->workers,
+          p_mt_info->num_workers)) {
     if (cm->film_grain_params.apply_grain) {
       aom_film_grain_table_append(cpi->film_grain_table, time_stamp, end_time,
                                   &cm->film_grain_params);
@@ -4094,7 +4130,8 @@ static int apply_denoise_2d(AV1_COMP *cpi, const YV12_BUFFER_CONFIG *sd,
 
 int av1_receive_raw_frame(AV1_COMP *cpi, aom_enc_frame_flags_t frame_flags,
                           const YV12_BUFFER_CONFIG *sd, int64_t time_stamp,
-                          int64_t end_time) {
+                          int64_t end_time,
+                          struct lookahead_input_buffer *ext) {
   AV1_COMMON *const cm = &cpi->common;
   const SequenceHeader *const seq_params = cm->seq_params;
   int res = 0;
@@ -4155,7 +4192,8 @@ int av1_receive_raw_frame(AV1_COMP *cpi, aom_enc_frame_flags_t frame_flags,
 #endif  //  CONFIG_DENOISE
 
   if (av1_lookahead_push(cpi->ppi->lookahead, sd, time_stamp, end_time,
-                         use_highbitdepth, cpi->alloc_pyramid, frame_flags)) {
+                         use_highbitdepth, cpi->alloc_pyramid, frame_flags,
+                         ext)) {
     aom_set_error(cm->error, AOM_CODEC_ERROR, "av1_lookahead_push() failed");
     res = -1;
   }
@@ -4711,6 +4749,15 @@ int av1_get_compressed_data(AV1_COMP *cpi, AV1_COMP_DATA *const cpi_data) {
   }
   cm->error->setjmp = 1;
 
+  // Scratch buffers do not outlive the call that allocates them, so resetting
+  // the arenas only reclaims the memory of stages aborted by an error and
+  // merges the blocks allocated while the arenas were growing.
+  aom_arena_reset(&cpi->frame_arena);
+  if (cpi->gf_frame_index == 0 ||
+      cpi->gf_frame_index >= cpi->ppi->gf_group.size) {
+    aom_arena_reset(&cpi->gop_arena);
+  }
+
 #if CONFIG_INTERNAL_STATS
   cpi->frame_recode_hits = 0;
   cpi->time_compress_data = 0;
@@ -4761,6 +4808,8 @@ int av1_get_compressed_data(AV1_COMP *cpi, AV1_COMP_DATA *const cpi_data) {
     aom_internal_error(cpi->common.error, AOM_CODEC_ERROR,
                        "Failed to allocate new cur_frame");
   }
+  // The buffer may have held a reference frame which was scaled.
+  av1_invalidate_scaled_ref_cache(cpi, cm->cur_frame);
 
 #if CONFIG_COLLECT_COMPONENT_TIMING
   // Accumulate 2nd pass time in 2-pass case or 1 pass time in 1-pass case.
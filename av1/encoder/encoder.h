@@ -21,6 +21,8 @@
 #include "config/aom_config.h"
 
 #include "aom/aomcx.h"
+#include "aom_mem/aom_arena.h"
+#include "aom_util/aom_progress.h"
 #include "aom_util/aom_pthread.h"
 
 #include "av1/common/alloccommon.h"
@@ -45,11 +47,13 @@
 #include "av1/encoder/level.h"
 #include "av1/encoder/lookahead.h"
 #include "av1/encoder/mcomp.h"
+#include "av1/encoder/motion_field_cache.h"
 #include "av1/encoder/pickcdef.h"
 #include "av1/encoder/ratectrl.h"
 #include "av1/encoder/rd.h"
 #include "av1/encoder/speed_features.h"
 #include "av1/encoder/svc_layercontext.h"
+#include "av1/encoder/task_pool.h"
 #include "av1/encoder/temporal_filter.h"
 #include "av1/encoder/thirdpass.h"
 #include "av1/encoder/tokenize.h"
@@ -1381,21 +1385,12 @@ typedef struct {
  * \brief Encoder parameters for synchronization of row based multi-threading
  */
 typedef struct {
-#if CONFIG_MULTITHREAD
-  /**
-   * \name Synchronization objects for top-right dependency.
-   */
-  /**@{*/
-  pthread_mutex_t *mutex_; /*!< Mutex lock object */
-  pthread_cond_t *cond_;   /*!< Condition variable */
-  /**@}*/
-#endif  // CONFIG_MULTITHREAD
   /*!
    * Buffer to store the superblock whose encoding is complete.
    * num_finished_cols[i] stores the number of superblocks which finished
-   * encoding in the ith superblock row.
+   * encoding in the ith superblock row. Used for the top-right dependency.
    */
-  int *num_finished_cols;
+  AVxProgress *num_finished_cols;
   /*!
    * Denotes the superblock interval at which conditional signalling should
    * happen. Also denotes the minimum number of extra superblocks of the top row
@@ -1824,6 +1819,11 @@ typedef struct MultiThreadInfo {
    */
   AV1CdefWorkerData *cdef_worker;
 
+  /*!
+   * Work-stealing task pool shared by the multi-threaded stages.
+   */
+  AV1TaskPool task_pool;
+
   /*!
    * Buffers to be stored/restored before/after parallel encode.
    */
@@ -2403,6 +2403,34 @@ typedef struct {
   bool has_lossless_segment;
 } EncSegmentationInfo;
 
+/*!\cond */
+// Scaled copy of a reference frame kept by av1_scale_references().
+typedef struct {
+  // Reference frame buffer the copy was scaled from. The cache holds no
+  // reference to it: the entry is dropped once the buffer is no longer a
+  // reference frame, or is reused for a new frame.
+  const RefCntBuffer *src;
+  // Scaled copy, to which the cache holds a reference.
+  RefCntBuffer *buf;
+  InterpFilter filter;
+  int phase;
+  bool use_optimized_scaler;
+  // Set once buf holds the scaled frame.
+  bool ready;
+  // Value of ScaledRefCache::counter when the entry was last used.
+  unsigned int last_used;
+} ScaledRefCacheEntry;
+
+typedef struct {
+  // At most one entry per reference frame type, so that the cache holds no
+  // more frame buffers than scaled_ref_buf can.
+  ScaledRefCacheEntry entries[INTER_REFS_PER_FRAME];
+  int num_entries;
+  // Incremented by each call to av1_scale_references().
+  unsigned int counter;
+} ScaledRefCache;
+/*!\endcond */
+
 /*!
  * \brief Frame time stamps.
  */
@@ -2731,6 +2759,12 @@ typedef struct AV1_PRIMARY {
    * Info and resources used by temporal filtering.
    */
   TEMPORAL_FILTER_INFO tf_info;
+
+  /*!
+   * Motion found between pairs of source frames by the temporal filter and
+   * the TPL model, reused by later searches of the same pairs.
+   */
+  MotionFieldCache motion_field_cache;
   /*!
    * Elements part of the sequence header, that are applicable for all the
    * frames in the video.
@@ -3011,6 +3045,13 @@ typedef struct AV1_COMP {
    */
   RefCntBuffer *scaled_ref_buf[INTER_REFS_PER_FRAME];
 
+  /*!
+   * Scaled copies of the reference frames, kept across frames so that a
+   * reference used at the same size by several frames or spatial layers is
+   * only scaled once.
+   */
+  ScaledRefCache scaled_ref_cache;
+
   /*!
    * Pointer to the buffer holding the last show frame.
    */
@@ -3314,6 +3355,19 @@ typedef struct AV1_COMP {
    */
   AV1LrPickStruct pick_lr_ctxt;
 
+  /*!
+   * Scratch memory for buffers that do not outlive the encoding of a frame,
+   * e.g. the temporal filter, CDEF search and loop restoration search
+   * buffers. Reset at the start of av1_get_compressed_data().
+   */
+  AVxArena frame_arena;
+
+  /*!
+   * Scratch memory for the buffers of the GOP level TPL passes. Reset when a
+   * new GF group is started.
+   */
+  AVxArena gop_arena;
+
   /*!
    * Pointer to list of tables with film grain parameters.
    */
@@ -3807,15 +3861,19 @@ int av1_init_parallel_frame_context(const AV1_COMP_DATA *const first_cpi_data,
  * \param[in,out] sd             Contain raw frame data
  * \param[in]     time_stamp     Time stamp of the frame
  * \param[in]     end_time_stamp End time stamp
+ * \param[in,out] ext            Application frame backing \p sd, which the
+ *                               encoder may reference instead of copying it,
+ *                               or NULL. See av1_lookahead_push().
  *
  * \return Returns a value to indicate if the frame data is received
  * successfully.
- * \note The caller can assume that a copy of this frame is made and not just a
- * copy of the pointer.
+ * \note Unless \p ext->release_cb is cleared, the caller can assume that a
+ * copy of this frame is made and not just a copy of the pointer.
  */
 int av1_receive_raw_frame(AV1_COMP *cpi, aom_enc_frame_flags_t frame_flags,
                           const YV12_BUFFER_CONFIG *sd, int64_t time_stamp,
-                          int64_t end_time_stamp);
+                          int64_t end_time_stamp,
+                          struct lookahead_input_buffer *ext);
 
 /*!\brief Encode a frame
  *
@@ -274,23 +274,17 @@ static inline void dealloc_compressor_data(AV1_COMP *cpi) {
   av1_free_pmc(cpi->td.firstpass_ctx, num_planes);
   cpi->td.firstpass_ctx = NULL;
 
-  const int is_highbitdepth = cpi->tf_ctx.is_highbitdepth;
-  // This call ensures that the buffers allocated by tf_alloc_and_reset_data()
-  // in av1_temporal_filter() for single-threaded encode are freed in case an
-  // error is encountered during temporal filtering (due to early termination
-  // tf_dealloc_data() in av1_temporal_filter() would not be invoked).
-  tf_dealloc_data(&cpi->td.tf_data, is_highbitdepth);
-
-  // This call ensures that tpl_tmp_buffers for single-threaded encode are freed
-  // in case of an error during tpl.
+  // The temporal filter, tpl, CDEF search and loop restoration search
+  // buffers are allocated from cpi->frame_arena and cpi->gop_arena. In case
+  // of an error during these stages, the memory is reclaimed by the next
+  // arena reset, or freed with the arenas in av1_remove_compressor().
+  tf_dealloc_data(&cpi->td.tf_data);
   tpl_dealloc_temp_buffers(&cpi->td.tpl_tmp_buffers);
 
   // This call ensures that the global motion (gm) data buffers for
   // single-threaded encode are freed in case of an error during gm.
   gm_dealloc_data(&cpi->td.gm_data);
 
-  // This call ensures that CDEF search context buffers are deallocated in case
-  // of an error during cdef search.
   av1_cdef_dealloc_data(cpi->cdef_search_ctx);
   aom_free(cpi->cdef_search_ctx);
   cpi->cdef_search_ctx = NULL;
@@ -314,10 +308,8 @@ static inline void dealloc_compressor_data(AV1_COMP *cpi) {
   }
 
   for (int plane = 0; plane < num_planes; plane++) {
-    aom_free(cpi->pick_lr_ctxt.rusi[plane]);
     cpi->pick_lr_ctxt.rusi[plane] = NULL;
   }
-  aom_free(cpi->pick_lr_ctxt.dgd_avg);
   cpi->pick_lr_ctxt.dgd_avg = NULL;
 
   aom_free_frame_buffer(&cpi->trial_frame_rst);
@@ -456,11 +448,6 @@ static inline YV12_BUFFER_CONFIG *realloc_and_scale_source(AV1_COMP *cpi,
 // Deallocate allocated thread_data.
 static inline void free_thread_data(AV1_PRIMARY *ppi) {
   PrimaryMultiThreadInfo *const p_mt_info = &ppi->p_mt_info;
-  const int num_tf_workers =
-      AOMMIN(p_mt_info->num_mod_workers[MOD_TF], p_mt_info->num_workers);
-  const int num_tpl_workers =
-      AOMMIN(p_mt_info->num_mod_workers[MOD_TPL], p_mt_info->num_workers);
-  const int is_highbitdepth = ppi->seq_params.use_highbitdepth;
   const int num_planes = ppi->seq_params.monochrome ? 1 : MAX_MB_PLANE;
   for (int t = 1; t < p_mt_info->num_workers; ++t) {
     EncWorkerData *const thread_data = &p_mt_info->tile_thr_data[t];
@@ -494,15 +481,6 @@ static inline void free_thread_data(AV1_PRIMARY *ppi) {
     td->firstpass_ctx = NULL;
     av1_free_shared_coeff_buffer(&td->shared_coeff_buf);
     av1_free_sms_tree(td);
-    // This call ensures that the buffers allocated by tf_alloc_and_reset_data()
-    // in prepare_tf_workers() for MT encode are freed in case an error is
-    // encountered during temporal filtering (due to early termination
-    // tf_dealloc_thread_data() in av1_tf_do_filtering_mt() would not be
-    // invoked).
-    if (t < num_tf_workers) tf_dealloc_data(&td->tf_data, is_highbitdepth);
-    // This call ensures that tpl_tmp_buffers for MT encode are freed in case of
-    // an error during tpl.
-    if (t < num_tpl_workers) tpl_dealloc_temp_buffers(&td->tpl_tmp_buffers);
     // This call ensures that the buffers in gm_data for MT encode are freed in
     // case of an error during gm.
     gm_dealloc_data(&td->gm_data);
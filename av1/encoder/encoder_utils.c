@@ -20,6 +20,7 @@
 #include "av1/encoder/encoder_alloc.h"
 #include "av1/encoder/encodetxb.h"
 #include "av1/encoder/encoder_utils.h"
+#include "av1/encoder/ethread.h"
 #include "av1/encoder/grain_test_vectors.h"
 #include "av1/encoder/mv_prec.h"
 #include "av1/encoder/rc_utils.h"
@@ -687,12 +688,148 @@ void av1_update_film_grain_parameters(struct AV1_COMP *cpi,
   }
 }
 
+void av1_invalidate_scaled_ref_cache(AV1_COMP *cpi, const RefCntBuffer *src) {
+  ScaledRefCache *const cache = &cpi->scaled_ref_cache;
+  int i = 0;
+  while (i < cache->num_entries) {
+    ScaledRefCacheEntry *const entry = &cache->entries[i];
+    if (src == NULL || entry->src == src) {
+      --entry->buf->ref_count;
+      *entry = cache->entries[--cache->num_entries];
+    } else {
+      ++i;
+    }
+  }
+}
+
+// Returns whether a reference frame buffer is still a reference frame.
+static bool is_ref_frame_buf(const AV1_COMMON *cm, const RefCntBuffer *buf) {
+  for (int i = 0; i < REF_FRAMES; ++i) {
+    if (cm->ref_frame_map[i] == buf) return true;
+  }
+  return false;
+}
+
+// Drops the entries of the cache that can no longer be used: those of
+// buffers which are no longer reference frames, and those which were not
+// scaled because a previous call failed.
+static void prune_scaled_ref_cache(AV1_COMP *cpi) {
+  ScaledRefCache *const cache = &cpi->scaled_ref_cache;
+  int i = 0;
+  while (i < cache->num_entries) {
+    ScaledRefCacheEntry *const entry = &cache->entries[i];
+    if (!entry->ready || !is_ref_frame_buf(&cpi->common, entry->src)) {
+      --entry->buf->ref_count;
+      *entry = cache->entries[--cache->num_entries];
+    } else {
+      ++i;
+    }
+  }
+}
+
+static ScaledRefCacheEntry *find_scaled_ref(ScaledRefCache *cache,
+                                            const RefCntBuffer *src,
+                                            int width, int height,
+                                            InterpFilter filter, int phase,
+                                            bool use_optimized_scaler) {
+  for (int i = 0; i < cache->num_entries; ++i) {
+    ScaledRefCacheEntry *const entry = &cache->entries[i];
+    if (entry->src == src && entry->buf->buf.y_crop_width == width &&
+        entry->buf->buf.y_crop_height == height && entry->filter == filter &&
+        entry->phase == phase &&
+        entry->use_optimized_scaler == use_optimized_scaler) {
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+// Makes room for a new entry if the cache is full, by evicting the least
+// recently used entry that the current frame does not use.
+static void make_room_in_scaled_ref_cache(ScaledRefCache *cache) {
+  if (cache->num_entries < INTER_REFS_PER_FRAME) return;
+  int lru = -1;
+  for (int i = 0; i < cache->num_entries; ++i) {
+    const ScaledRefCacheEntry *const entry = &cache->entries[i];
+    if (entry->last_used == cache->counter) continue;
+    if (lru < 0 || entry->last_used < cache->entries[lru].last_used) lru = i;
+  }
+  // The current frame uses fewer scaled references than the cache holds.
+  assert(lru >= 0);
+  --cache->entries[lru].buf->ref_count;
+  cache->entries[lru] = cache->entries[--cache->num_entries];
+}
+
+static bool use_optimized_scaler_for(const AV1_COMMON *cm,
+                                     const YV12_BUFFER_CONFIG *ref,
+                                     const YV12_BUFFER_CONFIG *scaled,
+                                     int use_optimized_scaler) {
+  bool has_optimized_scaler =
+      av1_has_optimized_scaler(ref->y_crop_width, ref->y_crop_height,
+                               scaled->y_crop_width, scaled->y_crop_height);
+  if (av1_num_planes(cm) > 1) {
+    has_optimized_scaler =
+        has_optimized_scaler &&
+        av1_has_optimized_scaler(ref->uv_crop_width, ref->uv_crop_height,
+                                 scaled->uv_crop_width, scaled->uv_crop_height);
+  }
+#if CONFIG_AV1_HIGHBITDEPTH
+  return use_optimized_scaler && has_optimized_scaler &&
+         cm->seq_params->bit_depth == AOM_BITS_8;
+#else
+  return use_optimized_scaler && has_optimized_scaler;
+#endif
+}
+
+static void scale_frames(AV1_COMP *cpi, const AV1ScaleFrameJob *jobs,
+                         int num_jobs) {
+  AV1_COMMON *const cm = &cpi->common;
+  const int num_planes = av1_num_planes(cm);
+  // The task pool is not set up for the first pass.
+  const int num_workers =
+      is_stat_generation_stage(cpi) ? 1 : cpi->mt_info.num_workers;
+  if (num_jobs == 0) return;
+  if (num_workers > 1) {
+    av1_scale_frames_mt(cpi, jobs, num_jobs, num_workers);
+    return;
+  }
+  for (int i = 0; i < num_jobs; ++i) {
+    const AV1ScaleFrameJob *const job = &jobs[i];
+    if (job->use_optimized_scaler) {
+      av1_resize_and_extend_frame(job->src, job->dst, job->filter, job->phase,
+                                  num_planes);
+    } else if (!av1_resize_and_extend_frame_nonnormative(
+                   job->src, job->dst, (int)cm->seq_params->bit_depth,
+                   num_planes)) {
+      aom_internal_error(cm->error, AOM_CODEC_MEM_ERROR,
+                         "Failed to allocate buffer during resize");
+    }
+  }
+}
+
 void av1_scale_references(AV1_COMP *cpi, const InterpFilter filter,
                           const int phase, const int use_optimized_scaler) {
   AV1_COMMON *cm = &cpi->common;
   const int num_planes = av1_num_planes(cm);
+  const bool use_cache = av1_use_scaled_ref_cache(cpi);
+  ScaledRefCache *const cache = &cpi->scaled_ref_cache;
+  AV1ScaleFrameJob jobs[INTER_REFS_PER_FRAME];
+  int num_jobs = 0;
   MV_REFERENCE_FRAME ref_frame;
 
+  if (use_cache) {
+    prune_scaled_ref_cache(cpi);
+    ++cache->counter;
+    // Scaled references are looked up in the cache instead of being kept by
+    // release_scaled_references().
+    for (int i = 0; i < INTER_REFS_PER_FRAME; ++i) {
+      if (cpi->scaled_ref_buf[i] != NULL) {
+        --cpi->scaled_ref_buf[i]->ref_count;
+        cpi->scaled_ref_buf[i] = NULL;
+      }
+    }
+  }
+
   for (ref_frame = LAST_FRAME; ref_frame <= ALTREF_FRAME; ++ref_frame) {
     // Need to convert from AOM_REFFRAME to index into ref_mask (subtract 1).
     if (cpi->ref_frame_flags & av1_ref_frame_flag_list[ref_frame]) {
@@ -740,6 +877,22 @@ void av1_scale_references(AV1_COMP *cpi, const InterpFilter filter,
                                "Failed to allocate frame buffer");
           }
         }
+        const RefCntBuffer *const ref_buf = get_ref_frame_buf(cm, ref_frame);
+        ScaledRefCacheEntry *entry = NULL;
+        if (use_cache) {
+          // A copy scaled for a previous frame, or for another reference
+          // type of the current frame, is reused.
+          entry = find_scaled_ref(cache, ref_buf, cm->width, cm->height,
+                                  filter, phase, use_optimized_scaler);
+          if (entry != NULL) {
+            entry->last_used = cache->counter;
+            cpi->scaled_ref_buf[ref_frame - 1] = entry->buf;
+            ++entry->buf->ref_count;
+            alloc_frame_mvs(cm, entry->buf);
+            continue;
+          }
+          make_room_in_scaled_ref_cache(cache);
+        }
         int force_scaling = 0;
         RefCntBuffer *new_fb = cpi->scaled_ref_buf[ref_frame - 1];
         if (new_fb == NULL) {
@@ -766,40 +919,28 @@ void av1_scale_references(AV1_COMP *cpi, const InterpFilter filter,
             aom_internal_error(cm->error, AOM_CODEC_MEM_ERROR,
                                "Failed to allocate frame buffer");
           }
-          bool has_optimized_scaler = av1_has_optimized_scaler(
-              ref->y_crop_width, ref->y_crop_height, new_fb->buf.y_crop_width,
-              new_fb->buf.y_crop_height);
-          if (num_planes > 1) {
-            has_optimized_scaler =
-                has_optimized_scaler &&
-                av1_has_optimized_scaler(
-                    ref->uv_crop_width, ref->uv_crop_height,
-                    new_fb->buf.uv_crop_width, new_fb->buf.uv_crop_height);
-          }
-#if CONFIG_AV1_HIGHBITDEPTH
-          if (use_optimized_scaler && has_optimized_scaler &&
-              cm->seq_params->bit_depth == AOM_BITS_8) {
-            av1_resize_and_extend_frame(ref, &new_fb->buf, filter, phase,
-                                        num_planes);
-          } else if (!av1_resize_and_extend_frame_nonnormative(
-                         ref, &new_fb->buf, (int)cm->seq_params->bit_depth,
-                         num_planes)) {
-            aom_internal_error(cm->error, AOM_CODEC_MEM_ERROR,
-                               "Failed to allocate buffer during resize");
-          }
-#else
-          if (use_optimized_scaler && has_optimized_scaler) {
-            av1_resize_and_extend_frame(ref, &new_fb->buf, filter, phase,
-                                        num_planes);
-          } else if (!av1_resize_and_extend_frame_nonnormative(
-                         ref, &new_fb->buf, (int)cm->seq_params->bit_depth,
-                         num_planes)) {
-            aom_internal_error(cm->error, AOM_CODEC_MEM_ERROR,
-                               "Failed to allocate buffer during resize");
-          }
-#endif
+          AV1ScaleFrameJob *const job = &jobs[num_jobs++];
+          job->src = ref;
+          job->dst = &new_fb->buf;
+          job->filter = filter;
+          job->phase = phase;
+          job->use_optimized_scaler = use_optimized_scaler_for(
+              cm, ref, &new_fb->buf, use_optimized_scaler);
           cpi->scaled_ref_buf[ref_frame - 1] = new_fb;
           alloc_frame_mvs(cm, new_fb);
+          if (use_cache) {
+            // The reference acquired in the get_free_fb() call above is
+            // transferred to the cache.
+            entry = &cache->entries[cache->num_entries++];
+            entry->src = ref_buf;
+            entry->buf = new_fb;
+            entry->filter = filter;
+            entry->phase = phase;
+            entry->use_optimized_scaler = use_optimized_scaler;
+            entry->ready = false;
+            entry->last_used = cache->counter;
+            ++new_fb->ref_count;
+          }
         }
       } else {
         RefCntBuffer *buf = get_ref_frame_buf(cm, ref_frame);
@@ -812,6 +953,11 @@ void av1_scale_references(AV1_COMP *cpi, const InterpFilter filter,
       if (!has_no_stats_stage(cpi)) cpi->scaled_ref_buf[ref_frame - 1] = NULL;
     }
   }
+
+  scale_frames(cpi, jobs, num_jobs);
+  if (use_cache) {
+    for (int i = 0; i < cache->num_entries; ++i) cache->entries[i].ready = true;
+  }
 }
 
 BLOCK_SIZE av1_select_sb_size(const AV1EncoderConfig *const oxcf, int width,
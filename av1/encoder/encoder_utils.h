@@ -1011,7 +1011,25 @@ static inline void set_size_independent_vars(AV1_COMP *cpi) {
       features->allow_warped_motion, cpi->oxcf.motion_mode_cfg.enable_obmc);
 }
 
+// Whether av1_scale_references() keeps the scaled copies of the references
+// in cpi->scaled_ref_cache for the next frames. Frame parallel encoding
+// scales the references of several frames at once, and is not supported.
+static inline bool av1_use_scaled_ref_cache(const AV1_COMP *cpi) {
+  return !is_stat_generation_stage(cpi) && cpi->ppi->num_fp_contexts == 1;
+}
+
 static inline void release_scaled_references(AV1_COMP *cpi) {
+  if (av1_use_scaled_ref_cache(cpi)) {
+    // The scaled copies still in use are kept by the cache.
+    for (int i = 0; i < INTER_REFS_PER_FRAME; ++i) {
+      RefCntBuffer *const buf = cpi->scaled_ref_buf[i];
+      if (buf != NULL) {
+        --buf->ref_count;
+        cpi->scaled_ref_buf[i] = NULL;
+      }
+    }
+    return;
+  }
   // Scaled references should only need to be released under certain conditions:
   // if the reference will be updated, or if the scaled reference has same
   // resolution. For now only apply this to Golden for non-svc RTC mode.
@@ -1082,6 +1100,11 @@ void av1_update_film_grain_parameters(struct AV1_COMP *cpi,
 void av1_scale_references(AV1_COMP *cpi, const InterpFilter filter,
                           const int phase, const int use_optimized_scaler);
 
+// Drops the scaled copies of the reference frame buffer src from
+// cpi->scaled_ref_cache, or all of them if src is NULL. Must be called when
+// the content of a frame buffer is replaced.
+void av1_invalidate_scaled_ref_cache(AV1_COMP *cpi, const RefCntBuffer *src);
+
 void av1_setup_frame(AV1_COMP *cpi);
 
 BLOCK_SIZE av1_select_sb_size(const AV1EncoderConfig *const oxcf, int width,
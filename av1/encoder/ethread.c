@@ -12,8 +12,12 @@
 #include <assert.h>
 #include <stdbool.h>
 
+#include "config/aom_scale_rtcd.h"
+
+#include "aom_dsp/pyramid.h"
 #include "aom_util/aom_pthread.h"
 
+#include "av1/common/resize.h"
 #include "av1/common/warped_motion.h"
 #include "av1/common/thread_common.h"
 
@@ -32,6 +36,7 @@
 #include "av1/encoder/global_motion_facade.h"
 #include "av1/encoder/intra_mode_search_utils.h"
 #include "av1/encoder/picklpf.h"
+#include "av1/encoder/pickrst.h"
 #include "av1/encoder/rdopt.h"
 #include "aom_dsp/aom_dsp_common.h"
 #include "av1/encoder/temporal_filter.h"
@@ -121,14 +126,9 @@ void av1_row_mt_sync_read(AV1EncRowMultiThreadSync *row_mt_sync, int r, int c) {
   const int nsync = row_mt_sync->sync_range;
 
   if (r) {
-    pthread_mutex_t *const mutex = &row_mt_sync->mutex_[r - 1];
-    pthread_mutex_lock(mutex);
-
-    while (c > row_mt_sync->num_finished_cols[r - 1] - nsync -
-                   row_mt_sync->intrabc_extra_top_right_sb_delay) {
-      pthread_cond_wait(&row_mt_sync->cond_[r - 1], mutex);
-    }
-    pthread_mutex_unlock(mutex);
+    aom_progress_wait(
+        &row_mt_sync->num_finished_cols[r - 1],
+        c + nsync + row_mt_sync->intrabc_extra_top_right_sb_delay);
   }
 #else
   (void)row_mt_sync;
@@ -153,18 +153,12 @@ void av1_row_mt_sync_write(AV1EncRowMultiThreadSync *row_mt_sync, int r, int c,
   }
 
   if (sig) {
-    pthread_mutex_lock(&row_mt_sync->mutex_[r]);
-
     // When a thread encounters an error, num_finished_cols[r] is set to maximum
-    // column number. In this case, the AOMMAX operation here ensures that
+    // column number. aom_progress_set() never decreases the value, so that
     // num_finished_cols[r] is not overwritten with a smaller value thus
     // preventing the infinite waiting of threads in the relevant sync_read()
     // function.
-    row_mt_sync->num_finished_cols[r] =
-        AOMMAX(row_mt_sync->num_finished_cols[r], cur);
-
-    pthread_cond_signal(&row_mt_sync->cond_[r]);
-    pthread_mutex_unlock(&row_mt_sync->mutex_[r]);
+    aom_progress_set(&row_mt_sync->num_finished_cols[r], cur);
   }
 #else
   (void)row_mt_sync;
@@ -177,28 +171,10 @@ void av1_row_mt_sync_write(AV1EncRowMultiThreadSync *row_mt_sync, int r, int c,
 // Allocate memory for row synchronization
 static void row_mt_sync_mem_alloc(AV1EncRowMultiThreadSync *row_mt_sync,
                                   AV1_COMMON *cm, int rows) {
-#if CONFIG_MULTITHREAD
-  int i;
-
-  CHECK_MEM_ERROR(cm, row_mt_sync->mutex_,
-                  aom_malloc(sizeof(*row_mt_sync->mutex_) * rows));
-  if (row_mt_sync->mutex_) {
-    for (i = 0; i < rows; ++i) {
-      pthread_mutex_init(&row_mt_sync->mutex_[i], NULL);
-    }
-  }
-
-  CHECK_MEM_ERROR(cm, row_mt_sync->cond_,
-                  aom_malloc(sizeof(*row_mt_sync->cond_) * rows));
-  if (row_mt_sync->cond_) {
-    for (i = 0; i < rows; ++i) {
-      pthread_cond_init(&row_mt_sync->cond_[i], NULL);
-    }
+  if (!aom_progress_alloc_array(&row_mt_sync->num_finished_cols, rows, -1)) {
+    aom_internal_error(cm->error, AOM_CODEC_MEM_ERROR,
+                       "Failed to allocate row_mt_sync->num_finished_cols");
   }
-#endif  // CONFIG_MULTITHREAD
-
-  CHECK_MEM_ERROR(cm, row_mt_sync->num_finished_cols,
-                  aom_malloc(sizeof(*row_mt_sync->num_finished_cols) * rows));
 
   row_mt_sync->rows = rows;
   // Set up nsync.
@@ -208,23 +184,7 @@ static void row_mt_sync_mem_alloc(AV1EncRowMultiThreadSync *row_mt_sync,
 // Deallocate row based multi-threading synchronization related mutex and data
 void av1_row_mt_sync_mem_dealloc(AV1EncRowMultiThreadSync *row_mt_sync) {
   if (row_mt_sync != NULL) {
-#if CONFIG_MULTITHREAD
-    int i;
-
-    if (row_mt_sync->mutex_ != NULL) {
-      for (i = 0; i < row_mt_sync->rows; ++i) {
-        pthread_mutex_destroy(&row_mt_sync->mutex_[i]);
-      }
-      aom_free(row_mt_sync->mutex_);
-    }
-    if (row_mt_sync->cond_ != NULL) {
-      for (i = 0; i < row_mt_sync->rows; ++i) {
-        pthread_cond_destroy(&row_mt_sync->cond_[i]);
-      }
-      aom_free(row_mt_sync->cond_);
-    }
-#endif  // CONFIG_MULTITHREAD
-    aom_free(row_mt_sync->num_finished_cols);
+    aom_progress_free_array(&row_mt_sync->num_finished_cols, row_mt_sync->rows);
 
     // clear the structure as the source of this call may be dynamic change
     // in tiles in which case this call will be followed by an _alloc()
@@ -863,12 +823,14 @@ void av1_init_mt_sync(AV1_COMP *cpi, int is_first_pass) {
   }
 
   if (!is_first_pass) {
-    // Initialize global motion MT object.
-    AV1GlobalMotionSync *gm_sync = &mt_info->gm_sync;
-    if (gm_sync->mutex_ == NULL) {
-      CHECK_MEM_ERROR(cm, gm_sync->mutex_,
-                      aom_malloc(sizeof(*(gm_sync->mutex_))));
-      if (gm_sync->mutex_) pthread_mutex_init(gm_sync->mutex_, NULL);
+    // Initialize the task pool shared by the MT stages.
+    AV1TaskPool *task_pool = &mt_info->task_pool;
+    if (task_pool->num_deques < mt_info->num_workers) {
+      av1_task_pool_dealloc(task_pool);
+      if (!av1_task_pool_alloc(task_pool, mt_info->num_workers)) {
+        aom_internal_error(cm->error, AOM_CODEC_MEM_ERROR,
+                           "Failed to allocate task_pool");
+      }
     }
 #if !CONFIG_REALTIME_ONLY
     // Initialize temporal filtering MT object.
@@ -1513,6 +1475,14 @@ static inline void sync_enc_workers(MultiThreadInfo *const mt_info,
   xd->error_info = cm->error;
 }
 
+// Hook function for each thread running the tasks of the encoder task pool.
+static int task_pool_worker_hook(void *arg1, void *arg2) {
+  EncWorkerData *const thread_data = (EncWorkerData *)arg1;
+  AV1TaskPool *const task_pool = (AV1TaskPool *)arg2;
+  return av1_task_pool_run(task_pool, thread_data->thread_id, thread_data,
+                           &thread_data->error_info);
+}
+
 static inline void accumulate_counters_enc_workers(AV1_COMP *cpi,
                                                    int num_workers) {
   for (int i = num_workers - 1; i >= 0; i--) {
@@ -1960,8 +1930,8 @@ void av1_encode_tiles_row_mt(AV1_COMP *cpi) {
       AV1EncRowMultiThreadSync *const row_mt_sync = &this_tile->row_mt_sync;
 
       // Initialize num_finished_cols to -1 for all rows.
-      memset(row_mt_sync->num_finished_cols, -1,
-             sizeof(*row_mt_sync->num_finished_cols) * max_sb_rows_in_tile);
+      aom_progress_reset_array(row_mt_sync->num_finished_cols,
+                               max_sb_rows_in_tile, -1);
       row_mt_sync->next_mi_row = this_tile->tile_info.mi_row_start;
       row_mt_sync->num_threads_working = 0;
       row_mt_sync->intrabc_extra_top_right_sb_delay =
@@ -2039,8 +2009,8 @@ void av1_fp_encode_tiles_row_mt(AV1_COMP *cpi) {
       AV1EncRowMultiThreadSync *const row_mt_sync = &this_tile->row_mt_sync;
 
       // Initialize num_finished_cols to -1 for all rows.
-      memset(row_mt_sync->num_finished_cols, -1,
-             sizeof(*row_mt_sync->num_finished_cols) * max_mb_rows);
+      aom_progress_reset_array(row_mt_sync->num_finished_cols, max_mb_rows,
+                               -1);
       row_mt_sync->next_mi_row = this_tile->tile_info.mi_row_start;
       row_mt_sync->num_threads_working = 0;
 
@@ -2080,12 +2050,7 @@ void av1_tpl_row_mt_sync_read(AV1TplRowMultiThreadSync *tpl_row_mt_sync, int r,
   int nsync = tpl_row_mt_sync->sync_range;
 
   if (r) {
-    pthread_mutex_t *const mutex = &tpl_row_mt_sync->mutex_[r - 1];
-    pthread_mutex_lock(mutex);
-
-    while (c > tpl_row_mt_sync->num_finished_cols[r - 1] - nsync)
-      pthread_cond_wait(&tpl_row_mt_sync->cond_[r - 1], mutex);
-    pthread_mutex_unlock(mutex);
+    aom_progress_wait(&tpl_row_mt_sync->num_finished_cols[r - 1], c + nsync);
   }
 #else
   (void)tpl_row_mt_sync;
@@ -2110,18 +2075,12 @@ void av1_tpl_row_mt_sync_write(AV1TplRowMultiThreadSync *tpl_row_mt_sync, int r,
   }
 
   if (sig) {
-    pthread_mutex_lock(&tpl_row_mt_sync->mutex_[r]);
-
     // When a thread encounters an error, num_finished_cols[r] is set to maximum
-    // column number. In this case, the AOMMAX operation here ensures that
+    // column number. aom_progress_set() never decreases the value, so that
     // num_finished_cols[r] is not overwritten with a smaller value thus
     // preventing the infinite waiting of threads in the relevant sync_read()
     // function.
-    tpl_row_mt_sync->num_finished_cols[r] =
-        AOMMAX(tpl_row_mt_sync->num_finished_cols[r], cur);
-
-    pthread_cond_signal(&tpl_row_mt_sync->cond_[r]);
-    pthread_mutex_unlock(&tpl_row_mt_sync->mutex_[r]);
+    aom_progress_set(&tpl_row_mt_sync->num_finished_cols[r], cur);
   }
 #else
   (void)tpl_row_mt_sync;
@@ -2213,20 +2172,7 @@ static int tpl_worker_hook(void *arg1, void *unused) {
 void av1_tpl_dealloc(AV1TplRowMultiThreadSync *tpl_sync) {
   assert(tpl_sync != NULL);
 
-#if CONFIG_MULTITHREAD
-  if (tpl_sync->mutex_ != NULL) {
-    for (int i = 0; i < tpl_sync->rows; ++i)
-      pthread_mutex_destroy(&tpl_sync->mutex_[i]);
-    aom_free(tpl_sync->mutex_);
-  }
-  if (tpl_sync->cond_ != NULL) {
-    for (int i = 0; i < tpl_sync->rows; ++i)
-      pthread_cond_destroy(&tpl_sync->cond_[i]);
-    aom_free(tpl_sync->cond_);
-  }
-#endif  // CONFIG_MULTITHREAD
-
-  aom_free(tpl_sync->num_finished_cols);
+  aom_progress_free_array(&tpl_sync->num_finished_cols, tpl_sync->rows);
   // clear the structure as the source of this call may be a resize in which
   // case this call will be followed by an _alloc() which may fail.
   av1_zero(*tpl_sync);
@@ -2236,25 +2182,10 @@ void av1_tpl_dealloc(AV1TplRowMultiThreadSync *tpl_sync) {
 static void av1_tpl_alloc(AV1TplRowMultiThreadSync *tpl_sync, AV1_COMMON *cm,
                           int mb_rows) {
   tpl_sync->rows = mb_rows;
-#if CONFIG_MULTITHREAD
-  {
-    CHECK_MEM_ERROR(cm, tpl_sync->mutex_,
-                    aom_malloc(sizeof(*tpl_sync->mutex_) * mb_rows));
-    if (tpl_sync->mutex_) {
-      for (int i = 0; i < mb_rows; ++i)
-        pthread_mutex_init(&tpl_sync->mutex_[i], NULL);
-    }
-
-    CHECK_MEM_ERROR(cm, tpl_sync->cond_,
-                    aom_malloc(sizeof(*tpl_sync->cond_) * mb_rows));
-    if (tpl_sync->cond_) {
-      for (int i = 0; i < mb_rows; ++i)
-        pthread_cond_init(&tpl_sync->cond_[i], NULL);
-    }
+  if (!aom_progress_alloc_array(&tpl_sync->num_finished_cols, mb_rows, -1)) {
+    aom_internal_error(cm->error, AOM_CODEC_MEM_ERROR,
+                       "Failed to allocate tpl_sync->num_finished_cols");
   }
-#endif  // CONFIG_MULTITHREAD
-  CHECK_MEM_ERROR(cm, tpl_sync->num_finished_cols,
-                  aom_malloc(sizeof(*tpl_sync->num_finished_cols) * mb_rows));
 
   // Set up nsync.
   tpl_sync->sync_range = 1;
@@ -2291,6 +2222,7 @@ static inline void prepare_tpl_workers(AV1_COMP *cpi, AVxWorkerHook hook,
       // called from tpl, hence set the buffers to defaults.
       av1_init_obmc_buffer(&thread_data->td->mb.obmc_buffer);
       if (!tpl_alloc_temp_buffers(&thread_data->td->tpl_tmp_buffers,
+                                  &cpi->gop_arena,
                                   cpi->ppi->tpl_data.tpl_bsize_1d)) {
         aom_internal_error(cpi->common.error, AOM_CODEC_MEM_ERROR,
                            "Error allocating tpl data");
@@ -2338,9 +2270,9 @@ void av1_mc_flow_dispenser_mt(AV1_COMP *cpi) {
   mt_info->tpl_row_mt.tpl_mt_exit = false;
 
   // Initialize cur_mb_col to -1 for all MB rows.
-  memset(tpl_sync->num_finished_cols, -1,
-         sizeof(*tpl_sync->num_finished_cols) * mb_rows);
+  aom_progress_reset_array(tpl_sync->num_finished_cols, mb_rows, -1);
 
+  const AVxArenaMark arena_mark = aom_arena_mark(&cpi->gop_arena);
   prepare_tpl_workers(cpi, tpl_worker_hook, num_workers);
   launch_workers(&cpi->mt_info, num_workers);
   sync_enc_workers(&cpi->mt_info, cm, num_workers);
@@ -2352,6 +2284,7 @@ void av1_mc_flow_dispenser_mt(AV1_COMP *cpi) {
     ThreadData *td = thread_data->td;
     if (td != &cpi->td) tpl_dealloc_temp_buffers(&td->tpl_tmp_buffers);
   }
+  aom_arena_release(&cpi->gop_arena, arena_mark);
 }
 
 // Deallocate memory for temporal filter multi-thread synchronization.
@@ -2469,7 +2402,8 @@ static void prepare_tf_workers(AV1_COMP *cpi, AVxWorkerHook hook,
       // called from tf, hence set the buffers to defaults.
       av1_init_obmc_buffer(&thread_data->td->mb.obmc_buffer);
       if (!tf_alloc_and_reset_data(&thread_data->td->tf_data,
-                                   cpi->tf_ctx.num_pels, is_highbitdepth)) {
+                                   &cpi->frame_arena, cpi->tf_ctx.num_pels,
+                                   is_highbitdepth)) {
         aom_internal_error(cpi->common.error, AOM_CODEC_MEM_ERROR,
                            "Error allocating temporal filter data");
       }
@@ -2478,13 +2412,12 @@ static void prepare_tf_workers(AV1_COMP *cpi, AVxWorkerHook hook,
 }
 
 // Deallocate thread specific data for temporal filter.
-static void tf_dealloc_thread_data(AV1_COMP *cpi, int num_workers,
-                                   int is_highbitdepth) {
+static void tf_dealloc_thread_data(AV1_COMP *cpi, int num_workers) {
   MultiThreadInfo *mt_info = &cpi->mt_info;
   for (int i = num_workers - 1; i >= 0; i--) {
     EncWorkerData *thread_data = &mt_info->tile_thr_data[i];
     ThreadData *td = thread_data->td;
-    if (td != &cpi->td) tf_dealloc_data(&td->tf_data, is_highbitdepth);
+    if (td != &cpi->td) tf_dealloc_data(&td->tf_data);
   }
 }
 
@@ -2512,135 +2445,60 @@ void av1_tf_do_filtering_mt(AV1_COMP *cpi) {
   int num_workers =
       AOMMIN(mt_info->num_mod_workers[MOD_TF], mt_info->num_workers);
 
+  const AVxArenaMark arena_mark = aom_arena_mark(&cpi->frame_arena);
   prepare_tf_workers(cpi, tf_worker_hook, num_workers, is_highbitdepth);
   launch_workers(mt_info, num_workers);
   sync_enc_workers(mt_info, cm, num_workers);
   tf_accumulate_frame_diff(cpi, num_workers);
-  tf_dealloc_thread_data(cpi, num_workers, is_highbitdepth);
+  tf_dealloc_thread_data(cpi, num_workers);
+  aom_arena_release(&cpi->frame_arena, arena_mark);
 }
 
 // Checks if a job is available in the current direction. If a job is available,
 // frame_idx will be populated and returns 1, else returns 0.
-static inline int get_next_gm_job(AV1_COMP *cpi, int *frame_idx, int cur_dir) {
-  GlobalMotionInfo *gm_info = &cpi->gm_info;
-  GlobalMotionJobInfo *job_info = &cpi->mt_info.gm_sync.job_info;
-
-  int total_refs = gm_info->num_ref_frames[cur_dir];
-  int8_t cur_frame_to_process = job_info->next_frame_to_process[cur_dir];
-
-  if (cur_frame_to_process < total_refs && !job_info->early_exit[cur_dir]) {
-    *frame_idx = gm_info->reference_frames[cur_dir][cur_frame_to_process].frame;
-    job_info->next_frame_to_process[cur_dir] += 1;
-    return 1;
-  }
-  return 0;
-}
-
-// Switches the current direction and calls the function get_next_gm_job() if
-// the speed feature 'prune_ref_frame_for_gm_search' is not set.
-static inline void switch_direction(AV1_COMP *cpi, int *frame_idx,
-                                    int *cur_dir) {
-  if (cpi->sf.gm_sf.prune_ref_frame_for_gm_search) return;
-  // Switch the direction and get next job
-  *cur_dir = !(*cur_dir);
-  get_next_gm_job(cpi, frame_idx, *(cur_dir));
-}
-
-// Hook function for each thread in global motion multi-threading.
-static int gm_mt_worker_hook(void *arg1, void *unused) {
-  (void)unused;
-
-  EncWorkerData *thread_data = (EncWorkerData *)arg1;
+// Task function computing the global motion w.r.t. one reference frame.
+static void gm_mt_task(void *arg, void *worker_data,
+                       struct aom_internal_error_info *error_info) {
+  const GlobalMotionTask *const gm_task = (const GlobalMotionTask *)arg;
+  EncWorkerData *const thread_data = (EncWorkerData *)worker_data;
   AV1_COMP *cpi = thread_data->cpi;
   GlobalMotionInfo *gm_info = &cpi->gm_info;
-  AV1GlobalMotionSync *gm_sync = &cpi->mt_info.gm_sync;
-  GlobalMotionJobInfo *job_info = &gm_sync->job_info;
-  int thread_id = thread_data->thread_id;
+  GlobalMotionJobInfo *job_info = &cpi->mt_info.gm_sync.job_info;
   GlobalMotionData *gm_thread_data = &thread_data->td->gm_data;
-#if CONFIG_MULTITHREAD
-  pthread_mutex_t *gm_mt_mutex_ = gm_sync->mutex_;
-#endif
+  const int dir = gm_task->dir;
+  const int ref_buf_idx = gm_task->ref_buf_idx;
 
-  MACROBLOCKD *const xd = &thread_data->td->mb.e_mbd;
-  struct aom_internal_error_info *const error_info = &thread_data->error_info;
-  xd->error_info = error_info;
+  // The tasks of a direction are chained when early exit is possible, so
+  // early_exit[dir] was written by a task which has already finished.
+  if (job_info->early_exit[dir]) return;
 
-  // The jmp_buf is valid only for the duration of the function that calls
-  // setjmp(). Therefore, this function must reset the 'setjmp' field to 0
-  // before it returns.
-  if (setjmp(error_info->jmp)) {
-    error_info->setjmp = 0;
-#if CONFIG_MULTITHREAD
-    pthread_mutex_lock(gm_mt_mutex_);
-    gm_sync->gm_mt_exit = true;
-    pthread_mutex_unlock(gm_mt_mutex_);
-#endif
-    return 0;
-  }
-  error_info->setjmp = 1;
+  thread_data->td->mb.e_mbd.error_info = error_info;
 
-  int cur_dir = job_info->thread_id_to_dir[thread_id];
-  bool gm_mt_exit = false;
-  while (1) {
-    int ref_buf_idx = -1;
+  // Compute global motion for the given ref_buf_idx.
+  av1_compute_gm_for_valid_ref_frames(
+      cpi, error_info, gm_info->ref_buf, ref_buf_idx,
+      gm_thread_data->motion_models, gm_thread_data->segment_map,
+      gm_info->segment_map_w, gm_info->segment_map_h);
 
-#if CONFIG_MULTITHREAD
-    pthread_mutex_lock(gm_mt_mutex_);
-#endif
-
-    gm_mt_exit = gm_sync->gm_mt_exit;
-    // Populates ref_buf_idx(the reference frame type) for which global motion
-    // estimation will be done.
-    if (!gm_mt_exit && !get_next_gm_job(cpi, &ref_buf_idx, cur_dir)) {
-      // No jobs are available for the current direction. Switch
-      // to other direction and get the next job, if available.
-      switch_direction(cpi, &ref_buf_idx, &cur_dir);
-    }
-
-#if CONFIG_MULTITHREAD
-    pthread_mutex_unlock(gm_mt_mutex_);
-#endif
-
-    // When gm_mt_exit is set to true, other workers need not pursue any
-    // further jobs.
-    if (gm_mt_exit || ref_buf_idx == -1) break;
-
-    // Compute global motion for the given ref_buf_idx.
-    av1_compute_gm_for_valid_ref_frames(
-        cpi, error_info, gm_info->ref_buf, ref_buf_idx,
-        gm_thread_data->motion_models, gm_thread_data->segment_map,
-        gm_info->segment_map_w, gm_info->segment_map_h);
-
-#if CONFIG_MULTITHREAD
-    pthread_mutex_lock(gm_mt_mutex_);
-#endif
-    // If global motion w.r.t. current ref frame is
-    // INVALID/TRANSLATION/IDENTITY, skip the evaluation of global motion w.r.t
-    // the remaining ref frames in that direction.
-    if (cpi->sf.gm_sf.prune_ref_frame_for_gm_search &&
-        cpi->common.global_motion[ref_buf_idx].wmtype <= TRANSLATION)
-      job_info->early_exit[cur_dir] = 1;
-
-#if CONFIG_MULTITHREAD
-    pthread_mutex_unlock(gm_mt_mutex_);
-#endif
-  }
-  error_info->setjmp = 0;
-  return 1;
+  // If global motion w.r.t. current ref frame is
+  // INVALID/TRANSLATION/IDENTITY, skip the evaluation of global motion w.r.t
+  // the remaining ref frames in that direction.
+  if (cpi->sf.gm_sf.prune_ref_frame_for_gm_search &&
+      cpi->common.global_motion[ref_buf_idx].wmtype <= TRANSLATION)
+    job_info->early_exit[dir] = 1;
 }
 
 // Assigns global motion hook function and thread data to each worker.
 static inline void prepare_gm_workers(AV1_COMP *cpi, AVxWorkerHook hook,
                                       int num_workers) {
   MultiThreadInfo *mt_info = &cpi->mt_info;
-  mt_info->gm_sync.gm_mt_exit = false;
   for (int i = num_workers - 1; i >= 0; i--) {
     AVxWorker *worker = &mt_info->workers[i];
     EncWorkerData *thread_data = &mt_info->tile_thr_data[i];
 
     worker->hook = hook;
     worker->data1 = thread_data;
-    worker->data2 = NULL;
+    worker->data2 = &mt_info->task_pool;
 
     thread_data->thread_id = i;
     // Set the starting tile for each thread.
@@ -2658,14 +2516,35 @@ static inline void prepare_gm_workers(AV1_COMP *cpi, AVxWorkerHook hook,
   }
 }
 
-// Assigns available threads to past/future direction.
-static inline void assign_thread_to_dir(int8_t *thread_id_to_dir,
-                                        int num_workers) {
-  int8_t frame_dir_idx = 0;
+// Initializes the global motion tasks and submits them to the task pool.
+static void submit_gm_tasks(AV1_COMP *cpi) {
+  GlobalMotionInfo *gm_info = &cpi->gm_info;
+  GlobalMotionJobInfo *job_info = &cpi->mt_info.gm_sync.job_info;
+  AV1TaskPool *task_pool = &cpi->mt_info.task_pool;
+
+  if (!av1_task_pool_reserve(task_pool, MAX_DIRECTIONS * (REF_FRAMES - 1))) {
+    aom_internal_error(cpi->common.error, AOM_CODEC_MEM_ERROR,
+                       "Failed to reserve task_pool");
+  }
+  av1_task_pool_reset(task_pool);
+  av1_zero(job_info->early_exit);
 
-  for (int i = 0; i < num_workers; i++) {
-    thread_id_to_dir[i] = frame_dir_idx++;
-    if (frame_dir_idx == MAX_DIRECTIONS) frame_dir_idx = 0;
+  for (int dir = 0; dir < MAX_DIRECTIONS; dir++) {
+    for (int i = 0; i < gm_info->num_ref_frames[dir]; i++) {
+      GlobalMotionTask *gm_task = &job_info->tasks[dir][i];
+      av1_task_init(&gm_task->task, gm_mt_task, gm_task);
+      gm_task->dir = dir;
+      gm_task->ref_buf_idx = gm_info->reference_frames[dir][i].frame;
+      // Whether a reference frame is evaluated depends on the result for the
+      // previous one in the same direction.
+      if (cpi->sf.gm_sf.prune_ref_frame_for_gm_search && i > 0)
+        av1_task_add_dependency(&job_info->tasks[dir][i - 1].task,
+                                &gm_task->task);
+    }
+  }
+  for (int dir = 0; dir < MAX_DIRECTIONS; dir++) {
+    for (int i = 0; i < gm_info->num_ref_frames[dir]; i++)
+      av1_task_pool_submit(task_pool, &job_info->tasks[dir][i].task);
   }
 }
 
@@ -2692,14 +2571,10 @@ static inline void gm_dealloc_thread_data(AV1_COMP *cpi, int num_workers) {
 
 // Implements multi-threading for global motion.
 void av1_global_motion_estimation_mt(AV1_COMP *cpi) {
-  GlobalMotionJobInfo *job_info = &cpi->mt_info.gm_sync.job_info;
-
-  av1_zero(*job_info);
-
   int num_workers = compute_gm_workers(cpi);
 
-  assign_thread_to_dir(job_info->thread_id_to_dir, num_workers);
-  prepare_gm_workers(cpi, gm_mt_worker_hook, num_workers);
+  submit_gm_tasks(cpi);
+  prepare_gm_workers(cpi, task_pool_worker_hook, num_workers);
   launch_workers(&cpi->mt_info, num_workers);
   sync_enc_workers(&cpi->mt_info, &cpi->common, num_workers);
   gm_dealloc_thread_data(cpi, num_workers);
@@ -2875,8 +2750,7 @@ void av1_calc_mb_wiener_var_mt(AV1_COMP *cpi, int num_workers,
   intra_row_mt_sync->intrabc_extra_top_right_sb_delay = 0;
   intra_row_mt_sync->num_threads_working = num_workers;
   intra_row_mt_sync->next_mi_row = 0;
-  memset(intra_row_mt_sync->num_finished_cols, -1,
-         sizeof(*intra_row_mt_sync->num_finished_cols) * mi_rows);
+  aom_progress_reset_array(intra_row_mt_sync->num_finished_cols, mi_rows, -1);
   mt_info->enc_row_mt.mb_wiener_mt_exit = false;
 
   prepare_wiener_var_workers(cpi, cal_mb_wiener_var_hook, num_workers);
@@ -3245,131 +3119,499 @@ void av1_cdef_mt_dealloc(AV1CdefSync *cdef_sync) {
 #endif  // CONFIG_MULTITHREAD
 }
 
-// Updates the row and column indices of the next job to be processed.
-// Also updates end_of_frame flag when the processing of all blocks is complete.
-static void update_next_job_info(AV1CdefSync *cdef_sync, int nvfb, int nhfb) {
-  cdef_sync->fbc++;
-  if (cdef_sync->fbc == nhfb) {
-    cdef_sync->fbr++;
-    if (cdef_sync->fbr == nvfb) {
-      cdef_sync->end_of_frame = 1;
-    } else {
-      cdef_sync->fbc = 0;
-    }
-  }
-}
-
-// Initializes cdef_sync parameters.
-static inline void cdef_reset_job_info(AV1CdefSync *cdef_sync) {
-#if CONFIG_MULTITHREAD
-  if (cdef_sync->mutex_) pthread_mutex_init(cdef_sync->mutex_, NULL);
-#endif  // CONFIG_MULTITHREAD
-  cdef_sync->end_of_frame = 0;
-  cdef_sync->fbr = 0;
-  cdef_sync->fbc = 0;
-  cdef_sync->cdef_mt_exit = false;
+// Task function computing the MSE of one 64x64 block in CDEF search.
+static void cdef_search_mt_task(void *arg, void *worker_data,
+                                struct aom_internal_error_info *error_info) {
+  const CdefSearchTask *const cdef_task = (const CdefSearchTask *)arg;
+  EncWorkerData *const thread_data = (EncWorkerData *)worker_data;
+  av1_cdef_mse_calc_block(thread_data->cpi->cdef_search_ctx, error_info,
+                          cdef_task->fbr, cdef_task->fbc, cdef_task->sb_count);
 }
 
-// Checks if a job is available. If job is available,
-// populates next job information and returns 1, else returns 0.
-static inline int cdef_get_next_job(AV1CdefSync *cdef_sync,
-                                    CdefSearchCtx *cdef_search_ctx,
-                                    volatile int *cur_fbr,
-                                    volatile int *cur_fbc,
-                                    volatile int *sb_count) {
-#if CONFIG_MULTITHREAD
-  pthread_mutex_lock(cdef_sync->mutex_);
-#endif  // CONFIG_MULTITHREAD
-  int do_next_block = 0;
+// Initializes a task for each non-skip 64x64 block and submits them to the
+// task pool.
+static void submit_cdef_search_tasks(AV1_COMP *cpi) {
+  CdefSearchCtx *cdef_search_ctx = cpi->cdef_search_ctx;
+  AV1TaskPool *task_pool = &cpi->mt_info.task_pool;
   const int nvfb = cdef_search_ctx->nvfb;
   const int nhfb = cdef_search_ctx->nhfb;
 
-  // If a block is skip, do not process the block and
-  // check the skip condition for the next block.
-  while (!cdef_sync->cdef_mt_exit && !cdef_sync->end_of_frame &&
-         cdef_sb_skip(cdef_search_ctx->mi_params, cdef_sync->fbr,
-                      cdef_sync->fbc)) {
-    update_next_job_info(cdef_sync, nvfb, nhfb);
+  if (!av1_task_pool_reserve(task_pool, nvfb * nhfb)) {
+    aom_internal_error(cpi->common.error, AOM_CODEC_MEM_ERROR,
+                       "Failed to reserve task_pool");
   }
+  av1_task_pool_reset(task_pool);
 
-  // Populates information needed for current job and update the row,
-  // column indices of the next block to be processed.
-  if (!cdef_sync->cdef_mt_exit && cdef_sync->end_of_frame == 0) {
-    do_next_block = 1;
-    *cur_fbr = cdef_sync->fbr;
-    *cur_fbc = cdef_sync->fbc;
-    *sb_count = cdef_search_ctx->sb_count;
-    cdef_search_ctx->sb_count++;
-    update_next_job_info(cdef_sync, nvfb, nhfb);
-  }
-#if CONFIG_MULTITHREAD
-  pthread_mutex_unlock(cdef_sync->mutex_);
-#endif  // CONFIG_MULTITHREAD
-  return do_next_block;
-}
-
-// Hook function for each thread in CDEF search multi-threading.
-static int cdef_filter_block_worker_hook(void *arg1, void *arg2) {
-  EncWorkerData *thread_data = (EncWorkerData *)arg1;
-  AV1CdefSync *const cdef_sync = (AV1CdefSync *)arg2;
-
-#if CONFIG_MULTITHREAD
-  pthread_mutex_t *cdef_mutex_ = cdef_sync->mutex_;
-#endif
-  struct aom_internal_error_info *const error_info = &thread_data->error_info;
-  CdefSearchCtx *cdef_search_ctx = thread_data->cpi->cdef_search_ctx;
-
-  // The jmp_buf is valid only for the duration of the function that calls
-  // setjmp(). Therefore, this function must reset the 'setjmp' field to 0
-  // before it returns.
-  if (setjmp(error_info->jmp)) {
-    error_info->setjmp = 0;
-#if CONFIG_MULTITHREAD
-    pthread_mutex_lock(cdef_mutex_);
-    cdef_sync->cdef_mt_exit = true;
-    pthread_mutex_unlock(cdef_mutex_);
-#endif
-    return 0;
-  }
-  error_info->setjmp = 1;
-
-  volatile int cur_fbr, cur_fbc, sb_count;
-  while (cdef_get_next_job(cdef_sync, cdef_search_ctx, &cur_fbr, &cur_fbc,
-                           &sb_count)) {
-    av1_cdef_mse_calc_block(cdef_search_ctx, error_info, cur_fbr, cur_fbc,
-                            sb_count);
+  // The MSEs are stored in raster scan order of the non-skip blocks, so the
+  // index of each block is assigned here rather than in processing order.
+  int sb_count = 0;
+  for (int fbr = 0; fbr < nvfb; fbr++) {
+    for (int fbc = 0; fbc < nhfb; fbc++) {
+      if (cdef_sb_skip(cdef_search_ctx->mi_params, fbr, fbc)) continue;
+      CdefSearchTask *cdef_task = &cdef_search_ctx->tasks[sb_count];
+      av1_task_init(&cdef_task->task, cdef_search_mt_task, cdef_task);
+      cdef_task->fbr = fbr;
+      cdef_task->fbc = fbc;
+      cdef_task->sb_count = sb_count++;
+      av1_task_pool_submit(task_pool, &cdef_task->task);
+    }
   }
-  error_info->setjmp = 0;
-  return 1;
+  cdef_search_ctx->sb_count = sb_count;
 }
 
-// Assigns CDEF search hook function and thread data to each worker.
-static void prepare_cdef_workers(AV1_COMP *cpi, AVxWorkerHook hook,
-                                 int num_workers) {
+// Assigns the task pool hook function and thread data to each worker.
+static void prepare_task_pool_workers(AV1_COMP *cpi, AVxWorkerHook hook,
+                                      int num_workers) {
   MultiThreadInfo *mt_info = &cpi->mt_info;
   for (int i = num_workers - 1; i >= 0; i--) {
     AVxWorker *worker = &mt_info->workers[i];
     EncWorkerData *thread_data = &mt_info->tile_thr_data[i];
 
     thread_data->cpi = cpi;
+    thread_data->thread_id = i;
+    thread_data->td = i == 0 ? &cpi->td : thread_data->original_td;
     worker->hook = hook;
     worker->data1 = thread_data;
-    worker->data2 = &mt_info->cdef_sync;
+    worker->data2 = &mt_info->task_pool;
   }
 }
 
 // Implements multi-threading for CDEF search.
 void av1_cdef_mse_calc_frame_mt(AV1_COMP *cpi) {
   MultiThreadInfo *mt_info = &cpi->mt_info;
-  AV1CdefSync *cdef_sync = &mt_info->cdef_sync;
   const int num_workers = mt_info->num_mod_workers[MOD_CDEF_SEARCH];
 
-  cdef_reset_job_info(cdef_sync);
-  prepare_cdef_workers(cpi, cdef_filter_block_worker_hook, num_workers);
+  submit_cdef_search_tasks(cpi);
+  prepare_task_pool_workers(cpi, task_pool_worker_hook, num_workers);
   launch_workers(mt_info, num_workers);
   sync_enc_workers(mt_info, &cpi->common, num_workers);
 }
 
+// Task accumulating the MSE of the candidate strengths over a band of blocks
+// in the current step of the CDEF strength search.
+typedef struct {
+  AV1Task task;
+  int band;
+} CdefStrengthSearchTask;
+
+static void cdef_strength_search_mt_task(
+    void *arg, void *worker_data, struct aom_internal_error_info *error_info) {
+  const CdefStrengthSearchTask *const strength_task =
+      (const CdefStrengthSearchTask *)arg;
+  EncWorkerData *const thread_data = (EncWorkerData *)worker_data;
+  (void)error_info;
+  av1_cdef_strength_search_band(thread_data->cpi->cdef_search_ctx,
+                                strength_task->band, thread_data->thread_id);
+}
+
+// Implements multi-threading for a step of the CDEF strength search, with one
+// task per band of 64x64 blocks.
+void av1_cdef_strength_search_mt(AV1_COMP *cpi, int num_bands,
+                                 int num_workers) {
+  AV1_COMMON *const cm = &cpi->common;
+  MultiThreadInfo *mt_info = &cpi->mt_info;
+  AV1TaskPool *task_pool = &mt_info->task_pool;
+
+  const AVxArenaMark arena_mark = aom_arena_mark(&cpi->frame_arena);
+  CdefStrengthSearchTask *strength_tasks;
+  CHECK_MEM_ERROR(cm, strength_tasks,
+                  aom_arena_malloc(&cpi->frame_arena,
+                                   num_bands * sizeof(*strength_tasks)));
+  if (!av1_task_pool_reserve(task_pool, num_bands)) {
+    aom_internal_error(cm->error, AOM_CODEC_MEM_ERROR,
+                       "Failed to reserve task_pool");
+  }
+  av1_task_pool_reset(task_pool);
+  for (int band = 0; band < num_bands; band++) {
+    CdefStrengthSearchTask *strength_task = &strength_tasks[band];
+    av1_task_init(&strength_task->task, cdef_strength_search_mt_task,
+                  strength_task);
+    strength_task->band = band;
+    av1_task_pool_submit(task_pool, &strength_task->task);
+  }
+
+  prepare_task_pool_workers(cpi, task_pool_worker_hook, num_workers);
+  launch_workers(mt_info, num_workers);
+  sync_enc_workers(mt_info, cm, num_workers);
+  aom_arena_release(&cpi->frame_arena, arena_mark);
+}
+
+// Task running the current stage of the hash table construction on a band.
+typedef struct {
+  AV1Task task;
+  HashTableBuildCtx *ctx;
+  int band;
+} HashTableBuildTask;
+
+static void hash_table_build_mt_task(
+    void *arg, void *worker_data, struct aom_internal_error_info *error_info) {
+  const HashTableBuildTask *const hash_task = (const HashTableBuildTask *)arg;
+  (void)worker_data;
+  (void)error_info;
+  av1_hash_table_build_band(hash_task->ctx, hash_task->band);
+}
+
+// Implements multi-threading for a stage of the IntraBC hash table
+// construction, with one task per band.
+void av1_hash_table_build_mt(AV1_COMP *cpi, HashTableBuildCtx *ctx,
+                             int num_workers) {
+  AV1_COMMON *const cm = &cpi->common;
+  MultiThreadInfo *mt_info = &cpi->mt_info;
+  AV1TaskPool *task_pool = &mt_info->task_pool;
+  const int num_bands = ctx->num_bands;
+
+  const AVxArenaMark arena_mark = aom_arena_mark(&cpi->frame_arena);
+  HashTableBuildTask *hash_tasks;
+  CHECK_MEM_ERROR(cm, hash_tasks,
+                  aom_arena_malloc(&cpi->frame_arena,
+                                   num_bands * sizeof(*hash_tasks)));
+  if (!av1_task_pool_reserve(task_pool, num_bands)) {
+    aom_internal_error(cm->error, AOM_CODEC_MEM_ERROR,
+                       "Failed to reserve task_pool");
+  }
+  av1_task_pool_reset(task_pool);
+  for (int band = 0; band < num_bands; band++) {
+    HashTableBuildTask *hash_task = &hash_tasks[band];
+    av1_task_init(&hash_task->task, hash_table_build_mt_task, hash_task);
+    hash_task->ctx = ctx;
+    hash_task->band = band;
+    av1_task_pool_submit(task_pool, &hash_task->task);
+  }
+
+  prepare_task_pool_workers(cpi, task_pool_worker_hook, num_workers);
+  launch_workers(mt_info, num_workers);
+  sync_enc_workers(mt_info, cm, num_workers);
+  aom_arena_release(&cpi->frame_arena, arena_mark);
+}
+
+// Task scaling a band of a frame: a band of rows with av1_resize_frame_band(),
+// or a pass of the non-normative scaler on a band of rows or columns of a
+// plane.
+typedef struct {
+  AV1Task task;
+  const AV1ScaleFrameJob *job;
+  int plane;
+  // Plane scaled horizontally by the non-normative scaler.
+  uint8_t *intbuf;
+  int start;
+  int end;
+} ScaleFrameTask;
+
+static void scale_frame_band_task(void *arg, void *worker_data,
+                                  struct aom_internal_error_info *error_info) {
+  const ScaleFrameTask *const scale_task = (const ScaleFrameTask *)arg;
+  const EncWorkerData *const thread_data = (const EncWorkerData *)worker_data;
+  const AV1ScaleFrameJob *const job = scale_task->job;
+  (void)error_info;
+  av1_resize_frame_band(job->src, job->dst, job->filter, job->phase,
+                        av1_num_planes(&thread_data->cpi->common),
+                        scale_task->start, scale_task->end);
+}
+
+static void resize_plane_rows_task(void *arg, void *worker_data,
+                                   struct aom_internal_error_info *error_info) {
+  const ScaleFrameTask *const scale_task = (const ScaleFrameTask *)arg;
+  const EncWorkerData *const thread_data = (const EncWorkerData *)worker_data;
+  const YV12_BUFFER_CONFIG *const src = scale_task->job->src;
+  const YV12_BUFFER_CONFIG *const dst = scale_task->job->dst;
+  const int plane = scale_task->plane;
+  const int is_uv = plane > 0;
+  bool mem_status;
+#if CONFIG_AV1_HIGHBITDEPTH
+  if (src->flags & YV12_FLAG_HIGHBITDEPTH) {
+    mem_status = av1_highbd_resize_plane_rows(
+        src->buffers[plane], src->crop_widths[is_uv], src->strides[is_uv],
+        (uint16_t *)scale_task->intbuf, dst->crop_widths[is_uv],
+        scale_task->start, scale_task->end,
+        (int)thread_data->cpi->common.seq_params->bit_depth);
+  } else {
+    mem_status = av1_resize_plane_rows(
+        src->buffers[plane], src->crop_widths[is_uv], src->strides[is_uv],
+        scale_task->intbuf, dst->crop_widths[is_uv], scale_task->start,
+        scale_task->end);
+  }
+#else
+  (void)thread_data;
+  mem_status = av1_resize_plane_rows(
+      src->buffers[plane], src->crop_widths[is_uv], src->strides[is_uv],
+      scale_task->intbuf, dst->crop_widths[is_uv], scale_task->start,
+      scale_task->end);
+#endif
+  if (!mem_status) {
+    aom_internal_error(error_info, AOM_CODEC_MEM_ERROR,
+                       "Failed to allocate buffer during resize");
+  }
+}
+
+static void resize_plane_cols_task(void *arg, void *worker_data,
+                                   struct aom_internal_error_info *error_info) {
+  const ScaleFrameTask *const scale_task = (const ScaleFrameTask *)arg;
+  const EncWorkerData *const thread_data = (const EncWorkerData *)worker_data;
+  const YV12_BUFFER_CONFIG *const src = scale_task->job->src;
+  YV12_BUFFER_CONFIG *const dst = scale_task->job->dst;
+  const int plane = scale_task->plane;
+  const int is_uv = plane > 0;
+  bool mem_status;
+#if CONFIG_AV1_HIGHBITDEPTH
+  if (src->flags & YV12_FLAG_HIGHBITDEPTH) {
+    mem_status = av1_highbd_resize_plane_cols(
+        (const uint16_t *)scale_task->intbuf, src->crop_heights[is_uv],
+        dst->crop_widths[is_uv], dst->buffers[plane], dst->crop_heights[is_uv],
+        dst->strides[is_uv], scale_task->start, scale_task->end,
+        (int)thread_data->cpi->common.seq_params->bit_depth);
+  } else {
+    mem_status = av1_resize_plane_cols(
+        scale_task->intbuf, src->crop_heights[is_uv], dst->crop_widths[is_uv],
+        dst->buffers[plane], dst->crop_heights[is_uv], dst->strides[is_uv],
+        scale_task->start, scale_task->end);
+  }
+#else
+  (void)thread_data;
+  mem_status = av1_resize_plane_cols(
+      scale_task->intbuf, src->crop_heights[is_uv], dst->crop_widths[is_uv],
+      dst->buffers[plane], dst->crop_heights[is_uv], dst->strides[is_uv],
+      scale_task->start, scale_task->end);
+#endif
+  if (!mem_status) {
+    aom_internal_error(error_info, AOM_CODEC_MEM_ERROR,
+                       "Failed to allocate buffer during resize");
+  }
+}
+
+// Splits [0, length) in at most num_bands bands starting at multiples of
+// 'align', and submits a task running func on each band.
+static void submit_scale_frame_tasks(AV1TaskPool *task_pool,
+                                     ScaleFrameTask *tasks, int *num_tasks,
+                                     AV1TaskFunc func,
+                                     const AV1ScaleFrameJob *job, int plane,
+                                     uint8_t *intbuf, int length, int align,
+                                     int num_bands) {
+  const int num_units = (length + align - 1) / align;
+  const int band_length =
+      (num_units + num_bands - 1) / num_bands * align;
+  for (int start = 0; start < length; start += band_length) {
+    ScaleFrameTask *const scale_task = &tasks[(*num_tasks)++];
+    av1_task_init(&scale_task->task, func, scale_task);
+    scale_task->job = job;
+    scale_task->plane = plane;
+    scale_task->intbuf = intbuf;
+    scale_task->start = start;
+    scale_task->end = AOMMIN(start + band_length, length);
+    av1_task_pool_submit(task_pool, &scale_task->task);
+  }
+}
+
+static void run_scale_frame_tasks(AV1_COMP *cpi, int num_workers) {
+  prepare_task_pool_workers(cpi, task_pool_worker_hook, num_workers);
+  launch_workers(&cpi->mt_info, num_workers);
+  sync_enc_workers(&cpi->mt_info, &cpi->common, num_workers);
+}
+
+// Implements multi-threading for the scaling of frames. Frames scaled by
+// av1_resize_and_extend_frame() are split in bands of rows. The non-normative
+// scaler first scales the bands of rows of each plane horizontally, then the
+// bands of columns vertically, in a second run of the task pool.
+void av1_scale_frames_mt(AV1_COMP *cpi, const AV1ScaleFrameJob *jobs,
+                         int num_jobs, int num_workers) {
+  AV1_COMMON *const cm = &cpi->common;
+  AV1TaskPool *const task_pool = &cpi->mt_info.task_pool;
+  AVxArena *const arena = &cpi->frame_arena;
+  const int num_planes = av1_num_planes(cm);
+  const int max_tasks = num_jobs * num_planes * num_workers;
+
+  const AVxArenaMark arena_mark = aom_arena_mark(arena);
+  ScaleFrameTask *tasks;
+  CHECK_MEM_ERROR(cm, tasks,
+                  aom_arena_malloc(arena, max_tasks * sizeof(*tasks)));
+  uint8_t *intbufs[INTER_REFS_PER_FRAME][MAX_MB_PLANE];
+  if (!av1_task_pool_reserve(task_pool, max_tasks)) {
+    aom_internal_error(cm->error, AOM_CODEC_MEM_ERROR,
+                       "Failed to reserve task_pool");
+  }
+  assert(num_jobs <= INTER_REFS_PER_FRAME);
+
+  int num_tasks = 0;
+  bool has_cols_pass = false;
+  av1_task_pool_reset(task_pool);
+  for (int j = 0; j < num_jobs; ++j) {
+    const AV1ScaleFrameJob *const job = &jobs[j];
+    if (job->use_optimized_scaler) {
+      submit_scale_frame_tasks(task_pool, tasks, &num_tasks,
+                               scale_frame_band_task, job, 0, NULL,
+                               job->dst->y_crop_height, RESIZE_BAND_ALIGNMENT,
+                               num_workers);
+      continue;
+    }
+    const size_t sample_size =
+        (job->src->flags & YV12_FLAG_HIGHBITDEPTH) ? sizeof(uint16_t) : 1;
+    for (int plane = 0; plane < num_planes; ++plane) {
+      const int is_uv = plane > 0;
+      const int height = job->src->crop_heights[is_uv];
+      CHECK_MEM_ERROR(
+          cm, intbufs[j][plane],
+          aom_arena_malloc(arena, (size_t)job->dst->crop_widths[is_uv] *
+                                      height * sample_size));
+      submit_scale_frame_tasks(task_pool, tasks, &num_tasks,
+                               resize_plane_rows_task, job, plane,
+                               intbufs[j][plane], height, 1, num_workers);
+    }
+    has_cols_pass = true;
+  }
+  run_scale_frame_tasks(cpi, num_workers);
+
+  if (has_cols_pass) {
+    num_tasks = 0;
+    av1_task_pool_reset(task_pool);
+    for (int j = 0; j < num_jobs; ++j) {
+      const AV1ScaleFrameJob *const job = &jobs[j];
+      if (job->use_optimized_scaler) continue;
+      for (int plane = 0; plane < num_planes; ++plane) {
+        submit_scale_frame_tasks(
+            task_pool, tasks, &num_tasks, resize_plane_cols_task, job, plane,
+            intbufs[j][plane], job->dst->crop_widths[plane > 0], 1,
+            num_workers);
+      }
+    }
+    run_scale_frame_tasks(cpi, num_workers);
+  }
+
+  for (int j = 0; j < num_jobs; ++j) {
+    aom_extend_frame_borders(jobs[j].dst, num_planes);
+  }
+  aom_arena_release(arena, arena_mark);
+}
+
+#if !CONFIG_REALTIME_ONLY
+// Task computing the image pyramid of a frame.
+typedef struct {
+  AV1Task task;
+  const YV12_BUFFER_CONFIG *frame;
+  int n_levels;
+} PyramidTask;
+
+static void compute_pyramid_task(void *arg, void *worker_data,
+                                 struct aom_internal_error_info *error_info) {
+  const PyramidTask *const pyr_task = (const PyramidTask *)arg;
+  const EncWorkerData *const thread_data = (const EncWorkerData *)worker_data;
+  const YV12_BUFFER_CONFIG *const frame = pyr_task->frame;
+  if (aom_compute_pyramid(frame, thread_data->cpi->common.seq_params->bit_depth,
+                          pyr_task->n_levels, frame->y_pyramid) < 0) {
+    aom_internal_error(error_info, AOM_CODEC_MEM_ERROR,
+                       "Failed to compute image pyramid");
+  }
+}
+
+// Implements multi-threading for the computation of the image pyramids of
+// several frames, one frame per task. The levels of a pyramid depend on each
+// other, so the pyramid of a single frame is computed by one worker.
+void av1_compute_pyramids_mt(AV1_COMP *cpi,
+                             const YV12_BUFFER_CONFIG *const *frames,
+                             int num_frames, int n_levels) {
+  AV1_COMMON *const cm = &cpi->common;
+  MultiThreadInfo *const mt_info = &cpi->mt_info;
+  AV1TaskPool *const task_pool = &mt_info->task_pool;
+  PyramidTask tasks[MAX_PYRAMID_FRAMES_MT];
+  assert(num_frames <= MAX_PYRAMID_FRAMES_MT);
+
+  if (!av1_task_pool_reserve(task_pool, num_frames)) {
+    aom_internal_error(cm->error, AOM_CODEC_MEM_ERROR,
+                       "Failed to reserve task_pool");
+  }
+  av1_task_pool_reset(task_pool);
+
+  int num_tasks = 0;
+  for (int i = 0; i < num_frames; ++i) {
+    const YV12_BUFFER_CONFIG *const frame = frames[i];
+    ImagePyramid *const pyr = frame->y_pyramid;
+    // Skip the frames the pyramid of which is already computed, e.g. by an
+    // earlier consumer, and the frames listed several times.
+    if (pyr == NULL ||
+        aom_get_pyramid_filled_levels(pyr) >= AOMMIN(n_levels, pyr->max_levels))
+      continue;
+    int is_duplicate = 0;
+    for (int j = 0; j < num_tasks; ++j) is_duplicate |= tasks[j].frame == frame;
+    if (is_duplicate) continue;
+
+    PyramidTask *const pyr_task = &tasks[num_tasks++];
+    av1_task_init(&pyr_task->task, compute_pyramid_task, pyr_task);
+    pyr_task->frame = frame;
+    pyr_task->n_levels = n_levels;
+    av1_task_pool_submit(task_pool, &pyr_task->task);
+  }
+  if (num_tasks == 0) return;
+
+  const int num_workers = AOMMIN(num_tasks, mt_info->num_workers);
+  prepare_task_pool_workers(cpi, task_pool_worker_hook, num_workers);
+  launch_workers(mt_info, num_workers);
+  sync_enc_workers(mt_info, cm, num_workers);
+}
+
+// Task searching the restoration units in one row of units of a plane.
+typedef struct {
+  AV1Task task;
+  struct RestSearchCtxt *rsc;
+  int unit_row;
+} LrSearchTask;
+
+static void lr_search_mt_task(void *arg, void *worker_data,
+                              struct aom_internal_error_info *error_info) {
+  const LrSearchTask *const lr_task = (const LrSearchTask *)arg;
+  const EncWorkerData *const thread_data = (const EncWorkerData *)worker_data;
+  av1_search_rest_unit_row(lr_task->rsc, lr_task->unit_row,
+                           thread_data->thread_id, error_info);
+}
+
+// Implements multi-threading for the loop restoration search of a plane, with
+// one task per row of restoration units. Only the parts of the search which do
+// not depend on the delta-coding reference parameters are done here; the
+// restoration units are then costed serially in encoding order, so the result
+// does not depend on the number of workers.
+//
+// Filtering a restoration unit temporarily overwrites the rows of the degraded
+// frame around its processing stripe boundaries, which the neighboring rows of
+// units read. Hence each odd row of units waits for the even rows above and
+// below it, so that adjacent rows are never searched at the same time.
+void av1_pick_rst_search_mt(AV1_COMP *cpi, struct RestSearchCtxt *rsc,
+                            int num_unit_rows, int num_workers) {
+  AV1_COMMON *const cm = &cpi->common;
+  MultiThreadInfo *const mt_info = &cpi->mt_info;
+  AV1TaskPool *const task_pool = &mt_info->task_pool;
+
+  const AVxArenaMark arena_mark = aom_arena_mark(&cpi->frame_arena);
+  LrSearchTask *lr_tasks;
+  CHECK_MEM_ERROR(cm, lr_tasks,
+                  aom_arena_malloc(&cpi->frame_arena,
+                                   num_unit_rows * sizeof(*lr_tasks)));
+  if (!av1_task_pool_reserve(task_pool, num_unit_rows)) {
+    aom_internal_error(cm->error, AOM_CODEC_MEM_ERROR,
+                       "Failed to reserve task_pool");
+  }
+  av1_task_pool_reset(task_pool);
+  for (int unit_row = 0; unit_row < num_unit_rows; unit_row++) {
+    LrSearchTask *lr_task = &lr_tasks[unit_row];
+    av1_task_init(&lr_task->task, lr_search_mt_task, lr_task);
+    lr_task->rsc = rsc;
+    lr_task->unit_row = unit_row;
+  }
+  for (int unit_row = 1; unit_row < num_unit_rows; unit_row += 2) {
+    av1_task_add_dependency(&lr_tasks[unit_row - 1].task,
+                            &lr_tasks[unit_row].task);
+    if (unit_row + 1 < num_unit_rows) {
+      av1_task_add_dependency(&lr_tasks[unit_row + 1].task,
+                              &lr_tasks[unit_row].task);
+    }
+  }
+  for (int unit_row = 0; unit_row < num_unit_rows; unit_row++)
+    av1_task_pool_submit(task_pool, &lr_tasks[unit_row].task);
+
+  num_workers = AOMMIN(num_workers, num_unit_rows);
+  prepare_task_pool_workers(cpi, task_pool_worker_hook, num_workers);
+  launch_workers(mt_info, num_workers);
+  sync_enc_workers(mt_info, cm, num_workers);
+  aom_arena_release(&cpi->frame_arena, arena_mark);
+}
+#endif  // !CONFIG_REALTIME_ONLY
+
 // Computes num_workers for temporal filter multi-threading.
 static inline int compute_num_tf_workers(const AV1_COMP *cpi) {
   // For single-pass encode, using no. of workers as per tf block size was not
@@ -109,8 +109,51 @@ void av1_init_tile_thread_data(AV1_PRIMARY *ppi, int is_first_pass);
 
 void av1_cdef_mse_calc_frame_mt(AV1_COMP *cpi);
 
+void av1_cdef_strength_search_mt(AV1_COMP *cpi, int num_bands,
+                                 int num_workers);
+
 void av1_cdef_mt_dealloc(AV1CdefSync *cdef_sync);
 
+void av1_hash_table_build_mt(AV1_COMP *cpi, HashTableBuildCtx *ctx,
+                             int num_workers);
+
+// Scaling of a frame by av1_scale_frames_mt().
+typedef struct {
+  const YV12_BUFFER_CONFIG *src;
+  YV12_BUFFER_CONFIG *dst;
+  InterpFilter filter;
+  int phase;
+  // Whether the frame is scaled by av1_resize_and_extend_frame() rather than
+  // by av1_resize_and_extend_frame_nonnormative().
+  bool use_optimized_scaler;
+} AV1ScaleFrameJob;
+
+// Scales the frames of the jobs and extends their borders. The frames are
+// split in bands of rows, or of rows and then columns for the non-normative
+// scaler, processed by num_workers workers.
+void av1_scale_frames_mt(AV1_COMP *cpi, const AV1ScaleFrameJob *jobs,
+                         int num_jobs, int num_workers);
+
+#if !CONFIG_REALTIME_ONLY
+// Maximum number of frames passed to av1_compute_pyramids_mt().
+#define MAX_PYRAMID_FRAMES_MT (INTER_REFS_PER_FRAME + 1)
+
+// Computes the first n_levels levels of the image pyramids of the frames, the
+// pyramids of different frames on different workers. Frames without a pyramid,
+// or the pyramid of which is already computed, are skipped.
+void av1_compute_pyramids_mt(AV1_COMP *cpi,
+                             const YV12_BUFFER_CONFIG *const *frames,
+                             int num_frames, int n_levels);
+
+struct RestSearchCtxt;
+
+// Computes the search results of the restoration units of the plane being
+// searched in 'rsc' which do not depend on the delta-coding reference
+// parameters, one row of units per task.
+void av1_pick_rst_search_mt(AV1_COMP *cpi, struct RestSearchCtxt *rsc,
+                            int num_unit_rows, int num_workers);
+#endif  // !CONFIG_REALTIME_ONLY
+
 void av1_write_tile_obu_mt(
     AV1_COMP *const cpi, uint8_t *const dst, uint32_t *total_size,
     struct aom_write_bit_buffer *saved_wb, uint8_t obu_extn_header,
@@ -19,6 +19,8 @@
 extern "C" {
 #endif
 
+// Copies 'src' to 'dst' and extends the borders of 'dst'. When 'src' and 'dst'
+// are the same frame, only the borders are extended.
 void av1_copy_and_extend_frame(const YV12_BUFFER_CONFIG *src,
                                YV12_BUFFER_CONFIG *dst);
 
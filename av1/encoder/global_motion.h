@@ -15,7 +15,9 @@
 #include "aom/aom_integer.h"
 #include "aom_dsp/flow_estimation/flow_estimation.h"
 #include "aom_util/aom_pthread.h"
+#include "av1/common/enums.h"
 #include "av1/encoder/enc_enums.h"
+#include "av1/encoder/task_pool.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -42,35 +44,30 @@ typedef struct {
   uint8_t *segment_map;
 } GlobalMotionData;
 
+// Task computing the global motion w.r.t. one reference frame.
 typedef struct {
-  // Holds the mapping of each thread to past/future direction.
-  // thread_id_to_dir[i] indicates the direction id (past - 0/future - 1)
-  // assigned to the ith thread.
-  int8_t thread_id_to_dir[MAX_NUM_THREADS];
+  AV1Task task;
+  // Direction (past - 0/future - 1) of the reference frame.
+  int8_t dir;
+  // Reference frame type for which global motion is computed.
+  int8_t ref_buf_idx;
+} GlobalMotionTask;
 
+typedef struct {
   // A flag which holds the early exit status based on the speed feature
   // 'prune_ref_frame_for_gm_search'. early_exit[i] will be set if the speed
   // feature based early exit happens in the direction 'i'.
   int8_t early_exit[MAX_DIRECTIONS];
 
-  // Counter for the next reference frame to be processed.
-  // next_frame_to_process[i] will hold the count of next reference frame to be
-  // processed in the direction 'i'.
-  int8_t next_frame_to_process[MAX_DIRECTIONS];
+  // tasks[i][j] computes the global motion w.r.t. the jth reference frame in
+  // the direction 'i'. When 'prune_ref_frame_for_gm_search' is set, the tasks
+  // of a direction are chained so that they run in order of distance.
+  GlobalMotionTask tasks[MAX_DIRECTIONS][REF_FRAMES - 1];
 } GlobalMotionJobInfo;
 
 typedef struct {
   // Data related to assigning jobs for global motion multi-threading.
   GlobalMotionJobInfo job_info;
-
-#if CONFIG_MULTITHREAD
-  // Mutex lock used while dispatching jobs.
-  pthread_mutex_t *mutex_;
-#endif
-
-  // Initialized to false, set to true by the worker thread that encounters an
-  // error in order to abort the processing of other worker threads.
-  bool gm_mt_exit;
 } AV1GlobalMotionSync;
 
 void av1_convert_model_to_params(const double *params,
@@ -11,9 +11,12 @@
 
 #include <assert.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
 
 #include "config/av1_rtcd.h"
 
+#include "aom_ports/bitops.h"
 #include "av1/encoder/block.h"
 #include "av1/encoder/hash.h"
 #include "av1/encoder/hash_motion.h"
@@ -21,6 +24,7 @@
 #define kSrcBits 16
 #define kBlockSizeBits 3
 #define kMaxAddr (1 << (kSrcBits + kBlockSizeBits))
+#define kBucketsPerBlockSize (1 << kSrcBits)
 
 // TODO(youzhou@microsoft.com): is higher than 8 bits screen content supported?
 // If yes, fix this function
@@ -93,100 +97,71 @@ static int hash_block_size_to_index(int block_size) {
   }
 }
 
+// Returns the start of band 'band' when 'size' rows or columns are split in
+// 'num_bands' bands.
+static int get_band_start(int size, int band, int num_bands) {
+  return (int)((int64_t)size * band / num_bands);
+}
+
 void av1_hash_table_init(IntraBCHashInfo *intrabc_hash_info) {
   if (!intrabc_hash_info->g_crc_initialized) {
     av1_crc_calculator_init(&intrabc_hash_info->crc_calculator1, 24, 0x5D6DCB);
     av1_crc_calculator_init(&intrabc_hash_info->crc_calculator2, 24, 0x864CFB);
     intrabc_hash_info->g_crc_initialized = 1;
   }
-  intrabc_hash_info->intrabc_hash_table.p_lookup_table = NULL;
-}
-
-static void clear_all(hash_table *p_hash_table) {
-  if (p_hash_table->p_lookup_table == NULL) {
-    return;
-  }
-  for (int i = 0; i < kMaxAddr; i++) {
-    if (p_hash_table->p_lookup_table[i] != NULL) {
-      aom_vector_destroy(p_hash_table->p_lookup_table[i]);
-      aom_free(p_hash_table->p_lookup_table[i]);
-      p_hash_table->p_lookup_table[i] = NULL;
-    }
-  }
 }
 
 void av1_hash_table_destroy(hash_table *p_hash_table) {
-  clear_all(p_hash_table);
-  aom_free(p_hash_table->p_lookup_table);
-  p_hash_table->p_lookup_table = NULL;
+  aom_free(p_hash_table->bucket_start);
+  aom_free(p_hash_table->blocks);
+  aom_free(p_hash_table->band_counts);
+  aom_free(p_hash_table->picture);
+  aom_free(p_hash_table->spare_bucket_start);
+  aom_free(p_hash_table->spare_blocks);
+  aom_free(p_hash_table->changed_blocks);
+  memset(p_hash_table, 0, sizeof(*p_hash_table));
 }
 
 bool av1_hash_table_create(hash_table *p_hash_table) {
-  if (p_hash_table->p_lookup_table != NULL) {
-    clear_all(p_hash_table);
-    return true;
-  }
-  p_hash_table->p_lookup_table =
-      (Vector **)aom_calloc(kMaxAddr, sizeof(p_hash_table->p_lookup_table[0]));
-  if (!p_hash_table->p_lookup_table) return false;
-  return true;
-}
-
-static bool hash_table_add_to_table(hash_table *p_hash_table,
-                                    uint32_t hash_value,
-                                    block_hash *curr_block_hash) {
-  if (p_hash_table->p_lookup_table[hash_value] == NULL) {
-    p_hash_table->p_lookup_table[hash_value] =
-        aom_malloc(sizeof(p_hash_table->p_lookup_table[0][0]));
-    if (p_hash_table->p_lookup_table[hash_value] == NULL) {
-      return false;
-    }
-    if (aom_vector_setup(p_hash_table->p_lookup_table[hash_value], 10,
-                         sizeof(curr_block_hash[0])) == VECTOR_ERROR)
-      return false;
-    if (aom_vector_push_back(p_hash_table->p_lookup_table[hash_value],
-                             curr_block_hash) == VECTOR_ERROR)
-      return false;
-  } else {
-    if (aom_vector_push_back(p_hash_table->p_lookup_table[hash_value],
-                             curr_block_hash) == VECTOR_ERROR)
-      return false;
+  if (p_hash_table->bucket_start == NULL) {
+    p_hash_table->bucket_start = (uint32_t *)aom_malloc(
+        (kMaxAddr + 1) * sizeof(*p_hash_table->bucket_start));
+    if (!p_hash_table->bucket_start) return false;
   }
+  p_hash_table->num_buckets = 0;
+  p_hash_table->bucket_start[0] = 0;
+  p_hash_table->has_picture = false;
   return true;
 }
 
 int32_t av1_hash_table_count(const hash_table *p_hash_table,
                              uint32_t hash_value) {
-  if (p_hash_table->p_lookup_table[hash_value] == NULL) {
-    return 0;
-  } else {
-    return (int32_t)(p_hash_table->p_lookup_table[hash_value]->size);
-  }
+  if (hash_value >= p_hash_table->num_buckets) return 0;
+  return (int32_t)(p_hash_table->bucket_start[hash_value + 1] -
+                   p_hash_table->bucket_start[hash_value]);
 }
 
-Iterator av1_hash_get_first_iterator(hash_table *p_hash_table,
-                                     uint32_t hash_value) {
+const block_hash *av1_hash_get_first_block(const hash_table *p_hash_table,
+                                           uint32_t hash_value) {
   assert(av1_hash_table_count(p_hash_table, hash_value) > 0);
-  return aom_vector_begin(p_hash_table->p_lookup_table[hash_value]);
+  return &p_hash_table->blocks[p_hash_table->bucket_start[hash_value]];
 }
 
-void av1_generate_block_2x2_hash_value(IntraBCHashInfo *intrabc_hash_info,
-                                       const YV12_BUFFER_CONFIG *picture,
-                                       uint32_t *pic_block_hash[2],
-                                       int8_t *pic_block_same_info[3]) {
+// Generates the hash values of the 2x2 blocks at x_start <= x < x_stop and
+// y_start <= y < y_stop.
+static void generate_block_2x2_hash_value_rect(
+    CRC_CALCULATOR *calc_1, CRC_CALCULATOR *calc_2,
+    const YV12_BUFFER_CONFIG *picture, uint32_t *pic_block_hash[2],
+    int8_t *pic_block_same_info[3], int x_start, int x_stop, int y_start,
+    int y_stop) {
   const int width = 2;
-  const int height = 2;
-  const int x_end = picture->y_crop_width - width + 1;
-  const int y_end = picture->y_crop_height - height + 1;
-  CRC_CALCULATOR *calc_1 = &intrabc_hash_info->crc_calculator1;
-  CRC_CALCULATOR *calc_2 = &intrabc_hash_info->crc_calculator2;
-
+  const int pic_width = picture->y_crop_width;
   const int length = width * 2;
   if (picture->flags & YV12_FLAG_HIGHBITDEPTH) {
     uint16_t p[4];
-    int pos = 0;
-    for (int y_pos = 0; y_pos < y_end; y_pos++) {
-      for (int x_pos = 0; x_pos < x_end; x_pos++) {
+    for (int y_pos = y_start; y_pos < y_stop; y_pos++) {
+      int pos = y_pos * pic_width + x_start;
+      for (int x_pos = x_start; x_pos < x_stop; x_pos++) {
         get_pixels_in_1D_short_array_by_block_2x2(
             CONVERT_TO_SHORTPTR(picture->y_buffer) + y_pos * picture->y_stride +
                 x_pos,
@@ -200,13 +175,12 @@ void av1_generate_block_2x2_hash_value(IntraBCHashInfo *intrabc_hash_info,
             av1_get_crc_value(calc_2, (uint8_t *)p, length * sizeof(p[0]));
         pos++;
       }
-      pos += width - 1;
     }
   } else {
     uint8_t p[4];
-    int pos = 0;
-    for (int y_pos = 0; y_pos < y_end; y_pos++) {
-      for (int x_pos = 0; x_pos < x_end; x_pos++) {
+    for (int y_pos = y_start; y_pos < y_stop; y_pos++) {
+      int pos = y_pos * pic_width + x_start;
+      for (int x_pos = x_start; x_pos < x_stop; x_pos++) {
         get_pixels_in_1D_char_array_by_block_2x2(
             picture->y_buffer + y_pos * picture->y_stride + x_pos,
             picture->y_stride, p);
@@ -219,34 +193,27 @@ void av1_generate_block_2x2_hash_value(IntraBCHashInfo *intrabc_hash_info,
             av1_get_crc_value(calc_2, p, length * sizeof(p[0]));
         pos++;
       }
-      pos += width - 1;
     }
   }
 }
 
-void av1_generate_block_hash_value(IntraBCHashInfo *intrabc_hash_info,
-                                   const YV12_BUFFER_CONFIG *picture,
-                                   int block_size,
-                                   uint32_t *src_pic_block_hash[2],
-                                   uint32_t *dst_pic_block_hash[2],
-                                   int8_t *src_pic_block_same_info[3],
-                                   int8_t *dst_pic_block_same_info[3]) {
-  CRC_CALCULATOR *calc_1 = &intrabc_hash_info->crc_calculator1;
-  CRC_CALCULATOR *calc_2 = &intrabc_hash_info->crc_calculator2;
-
-  const int pic_width = picture->y_crop_width;
-  const int x_end = picture->y_crop_width - block_size + 1;
-  const int y_end = picture->y_crop_height - block_size + 1;
-
+// Generates the hash values of the blocks of block_size at x_start <= x <
+// x_stop and y_start <= y < y_stop from those of block_size / 2.
+static void generate_block_hash_value_rect(
+    CRC_CALCULATOR *calc_1, CRC_CALCULATOR *calc_2, int pic_width,
+    int block_size, uint32_t *src_pic_block_hash[2],
+    uint32_t *dst_pic_block_hash[2], int8_t *src_pic_block_same_info[3],
+    int8_t *dst_pic_block_same_info[3], int x_start, int x_stop, int y_start,
+    int y_stop) {
   const int src_size = block_size >> 1;
   const int quad_size = block_size >> 2;
 
   uint32_t p[4];
   const int length = sizeof(p);
 
-  int pos = 0;
-  for (int y_pos = 0; y_pos < y_end; y_pos++) {
-    for (int x_pos = 0; x_pos < x_end; x_pos++) {
+  for (int y_pos = y_start; y_pos < y_stop; y_pos++) {
+    int pos = y_pos * pic_width + x_start;
+    for (int x_pos = x_start; x_pos < x_stop; x_pos++) {
       p[0] = src_pic_block_hash[0][pos];
       p[1] = src_pic_block_hash[0][pos + src_size];
       p[2] = src_pic_block_hash[0][pos + src_size * pic_width];
@@ -278,21 +245,178 @@ void av1_generate_block_hash_value(IntraBCHashInfo *intrabc_hash_info,
           src_pic_block_same_info[1][pos + src_size * pic_width + src_size];
       pos++;
     }
-    pos += block_size - 1;
   }
 
   if (block_size >= 4) {
     const int size_minus_1 = block_size - 1;
-    pos = 0;
-    for (int y_pos = 0; y_pos < y_end; y_pos++) {
-      for (int x_pos = 0; x_pos < x_end; x_pos++) {
+    for (int y_pos = y_start; y_pos < y_stop; y_pos++) {
+      int pos = y_pos * pic_width + x_start;
+      for (int x_pos = x_start; x_pos < x_stop; x_pos++) {
         dst_pic_block_same_info[2][pos] =
             (!dst_pic_block_same_info[0][pos] &&
              !dst_pic_block_same_info[1][pos]) ||
             (((x_pos & size_minus_1) == 0) && ((y_pos & size_minus_1) == 0));
         pos++;
       }
-      pos += block_size - 1;
+    }
+  }
+}
+
+void av1_generate_block_2x2_hash_value(IntraBCHashInfo *intrabc_hash_info,
+                                       const YV12_BUFFER_CONFIG *picture,
+                                       uint32_t *pic_block_hash[2],
+                                       int8_t *pic_block_same_info[3],
+                                       int band, int num_bands) {
+  const int x_end = picture->y_crop_width - 2 + 1;
+  const int y_end = picture->y_crop_height - 2 + 1;
+  // av1_get_crc_value() updates the calculator, so use a copy per band.
+  CRC_CALCULATOR crc_calculator1 = intrabc_hash_info->crc_calculator1;
+  CRC_CALCULATOR crc_calculator2 = intrabc_hash_info->crc_calculator2;
+  generate_block_2x2_hash_value_rect(
+      &crc_calculator1, &crc_calculator2, picture, pic_block_hash,
+      pic_block_same_info, 0, x_end, get_band_start(y_end, band, num_bands),
+      get_band_start(y_end, band + 1, num_bands));
+}
+
+void av1_generate_block_hash_value(IntraBCHashInfo *intrabc_hash_info,
+                                   const YV12_BUFFER_CONFIG *picture,
+                                   int block_size,
+                                   uint32_t *src_pic_block_hash[2],
+                                   uint32_t *dst_pic_block_hash[2],
+                                   int8_t *src_pic_block_same_info[3],
+                                   int8_t *dst_pic_block_same_info[3],
+                                   int band, int num_bands) {
+  const int x_end = picture->y_crop_width - block_size + 1;
+  const int y_end = picture->y_crop_height - block_size + 1;
+  // av1_get_crc_value() updates the calculator, so use a copy per band.
+  CRC_CALCULATOR crc_calculator1 = intrabc_hash_info->crc_calculator1;
+  CRC_CALCULATOR crc_calculator2 = intrabc_hash_info->crc_calculator2;
+  generate_block_hash_value_rect(
+      &crc_calculator1, &crc_calculator2, picture->y_crop_width, block_size,
+      src_pic_block_hash, dst_pic_block_hash, src_pic_block_same_info,
+      dst_pic_block_same_info, 0, x_end,
+      get_band_start(y_end, band, num_bands),
+      get_band_start(y_end, band + 1, num_bands));
+}
+
+// Allocates and clears the bucket counts of num_bands bands.
+static bool alloc_band_counts(hash_table *p_hash_table, int num_bands) {
+  const size_t counts_size = (size_t)num_bands * kBucketsPerBlockSize;
+  if (num_bands > p_hash_table->band_counts_alloc_size) {
+    aom_free(p_hash_table->band_counts);
+    p_hash_table->band_counts = (uint32_t *)aom_malloc(
+        counts_size * sizeof(*p_hash_table->band_counts));
+    if (!p_hash_table->band_counts) {
+      p_hash_table->band_counts_alloc_size = 0;
+      return false;
+    }
+    p_hash_table->band_counts_alloc_size = num_bands;
+  }
+  memset(p_hash_table->band_counts, 0,
+         counts_size * sizeof(*p_hash_table->band_counts));
+  return true;
+}
+
+bool av1_hash_table_begin_block_size(hash_table *p_hash_table, int block_size,
+                                     int num_bands) {
+  const int size_index = hash_block_size_to_index(block_size);
+  assert(size_index >= 0);
+  assert(((uint32_t)size_index << kSrcBits) >= p_hash_table->num_buckets);
+  (void)size_index;
+  return alloc_band_counts(p_hash_table, num_bands);
+}
+
+// Grows *blocks to hold at least 'size' blocks, keeping the first 'keep' ones.
+static bool grow_blocks(block_hash **blocks, size_t *alloc_size, size_t size,
+                        size_t keep) {
+  if (size <= *alloc_size) return true;
+  block_hash *const new_blocks =
+      (block_hash *)aom_malloc(size * sizeof(*new_blocks));
+  if (!new_blocks) return false;
+  if (keep > 0) memcpy(new_blocks, *blocks, keep * sizeof(*new_blocks));
+  aom_free(*blocks);
+  *blocks = new_blocks;
+  *alloc_size = size;
+  return true;
+}
+
+void av1_hash_table_count_band(hash_table *p_hash_table,
+                               uint32_t *pic_hash[2], const int8_t *pic_is_same,
+                               int pic_width, int pic_height, int block_size,
+                               int band, int num_bands) {
+  const int x_end = AOMMAX(pic_width - block_size + 1, 0);
+  const int y_end = pic_height - block_size + 1;
+  const int x_start = get_band_start(x_end, band, num_bands);
+  const int x_stop = get_band_start(x_end, band + 1, num_bands);
+  const uint32_t crc_mask = (1 << kSrcBits) - 1;
+  uint32_t *const counts =
+      p_hash_table->band_counts + (size_t)band * kBucketsPerBlockSize;
+
+  // The counts do not depend on the scan order, so scan in raster order.
+  for (int y_pos = 0; y_pos < y_end; y_pos++) {
+    const int8_t *const is_same = pic_is_same + y_pos * pic_width;
+    const uint32_t *const hash = pic_hash[0] + y_pos * pic_width;
+    for (int x_pos = x_start; x_pos < x_stop; x_pos++) {
+      if (is_same[x_pos]) counts[hash[x_pos] & crc_mask]++;
+    }
+  }
+}
+
+bool av1_hash_table_assign_buckets(hash_table *p_hash_table, int block_size,
+                                   int num_bands) {
+  const uint32_t first_bucket = (uint32_t)hash_block_size_to_index(block_size)
+                                << kSrcBits;
+  uint32_t *const bucket_start = p_hash_table->bucket_start;
+  uint64_t total = bucket_start[p_hash_table->num_buckets];
+
+  // The buckets of the block sizes which were not added are empty.
+  for (uint32_t i = p_hash_table->num_buckets; i < first_bucket; i++) {
+    bucket_start[i] = (uint32_t)total;
+  }
+  // Within a bucket, the blocks of a band follow those of the previous bands.
+  for (int i = 0; i < kBucketsPerBlockSize; i++) {
+    bucket_start[first_bucket + i] = (uint32_t)total;
+    for (int band = 0; band < num_bands; band++) {
+      uint32_t *const count =
+          &p_hash_table->band_counts[(size_t)band * kBucketsPerBlockSize + i];
+      const uint32_t band_count = *count;
+      *count = (uint32_t)total;
+      total += band_count;
+    }
+  }
+  if (total > UINT32_MAX) return false;
+  p_hash_table->num_buckets = first_bucket + kBucketsPerBlockSize;
+  bucket_start[p_hash_table->num_buckets] = (uint32_t)total;
+
+  // The blocks of the smaller block sizes are kept.
+  return grow_blocks(&p_hash_table->blocks, &p_hash_table->blocks_alloc_size,
+                     (size_t)total, bucket_start[first_bucket]);
+}
+
+void av1_hash_table_fill_band(hash_table *p_hash_table, uint32_t *pic_hash[2],
+                              const int8_t *pic_is_same, int pic_width,
+                              int pic_height, int block_size, int band,
+                              int num_bands) {
+  const int x_end = AOMMAX(pic_width - block_size + 1, 0);
+  const int y_end = pic_height - block_size + 1;
+  const int x_start = get_band_start(x_end, band, num_bands);
+  const int x_stop = get_band_start(x_end, band + 1, num_bands);
+  const uint32_t crc_mask = (1 << kSrcBits) - 1;
+  uint32_t *const next_block =
+      p_hash_table->band_counts + (size_t)band * kBucketsPerBlockSize;
+  block_hash *const blocks = p_hash_table->blocks;
+
+  // Column by column, so that the blocks of a bucket are ordered by x then y.
+  for (int x_pos = x_start; x_pos < x_stop; x_pos++) {
+    for (int y_pos = 0; y_pos < y_end; y_pos++) {
+      const int pos = y_pos * pic_width + x_pos;
+      if (pic_is_same[pos]) {
+        block_hash *const curr_block_hash =
+            &blocks[next_block[pic_hash[0][pos] & crc_mask]++];
+        curr_block_hash->x = x_pos;
+        curr_block_hash->y = y_pos;
+        curr_block_hash->hash_value2 = pic_hash[1][pos];
+      }
     }
   }
 }
@@ -302,36 +426,427 @@ bool av1_add_to_hash_map_by_row_with_precal_data(hash_table *p_hash_table,
                                                  int8_t *pic_is_same,
                                                  int pic_width, int pic_height,
                                                  int block_size) {
+  if (!av1_hash_table_begin_block_size(p_hash_table, block_size, 1))
+    return false;
+  av1_hash_table_count_band(p_hash_table, pic_hash, pic_is_same, pic_width,
+                            pic_height, block_size, 0, 1);
+  if (!av1_hash_table_assign_buckets(p_hash_table, block_size, 1)) return false;
+  av1_hash_table_fill_band(p_hash_table, pic_hash, pic_is_same, pic_width,
+                           pic_height, block_size, 0, 1);
+  return true;
+}
+
+void av1_hash_table_build_band(HashTableBuildCtx *ctx, int band) {
+  IntraBCHashInfo *const intrabc_hash_info = ctx->intrabc_hash_info;
+  hash_table *const p_hash_table = &intrabc_hash_info->intrabc_hash_table;
+  const YV12_BUFFER_CONFIG *const picture = ctx->picture;
+  const int src_idx = !ctx->dst_idx;
+  const int dst_idx = ctx->dst_idx;
+  switch (ctx->stage) {
+    case HASH_TABLE_GENERATE:
+      if (ctx->block_size == 2) {
+        av1_generate_block_2x2_hash_value(
+            intrabc_hash_info, picture, ctx->block_hash_values[dst_idx],
+            ctx->is_block_same[dst_idx], band, ctx->num_bands);
+      } else {
+        av1_generate_block_hash_value(
+            intrabc_hash_info, picture, ctx->block_size,
+            ctx->block_hash_values[src_idx], ctx->block_hash_values[dst_idx],
+            ctx->is_block_same[src_idx], ctx->is_block_same[dst_idx], band,
+            ctx->num_bands);
+      }
+      break;
+    case HASH_TABLE_COUNT:
+      av1_hash_table_count_band(p_hash_table, ctx->block_hash_values[dst_idx],
+                                ctx->is_block_same[dst_idx][2],
+                                picture->y_crop_width, picture->y_crop_height,
+                                ctx->block_size, band, ctx->num_bands);
+      break;
+    case HASH_TABLE_FILL:
+      av1_hash_table_fill_band(p_hash_table, ctx->block_hash_values[dst_idx],
+                               ctx->is_block_same[dst_idx][2],
+                               picture->y_crop_width, picture->y_crop_height,
+                               ctx->block_size, band, ctx->num_bands);
+      break;
+    default: assert(0);
+  }
+}
+
+// Returns the number of cells of 1 << cell_size_log2 samples covering 'size'
+// samples.
+static int get_num_cells(int size, int cell_size_log2) {
+  return (size + (1 << cell_size_log2) - 1) >> cell_size_log2;
+}
+
+// Returns whether the block of block_size at (x_pos, y_pos) overlaps a changed
+// cell. Blocks are not larger than the cells, so they overlap at most 2x2
+// cells.
+static int is_block_changed(const uint8_t *changed_cells, int cols,
+                            int cell_size_log2, int x_pos, int y_pos,
+                            int block_size) {
+  const int col0 = x_pos >> cell_size_log2;
+  const int col1 = (x_pos + block_size - 1) >> cell_size_log2;
+  const int row0 = y_pos >> cell_size_log2;
+  const int row1 = (y_pos + block_size - 1) >> cell_size_log2;
+  const uint8_t *row = changed_cells + row0 * cols;
+  if (row[col0] || row[col1]) return 1;
+  if (row1 == row0) return 0;
+  row += cols;
+  return row[col0] || row[col1];
+}
+
+// Returns whether the cell at (col, row) or one of its right, bottom and
+// bottom right neighbors changed, i.e. whether blocks starting in the cell
+// may overlap a changed cell.
+static int cell_has_changed_blocks(const uint8_t *changed_cells, int cols,
+                                   int rows, int col, int row) {
+  for (int r = row; r <= AOMMIN(row + 1, rows - 1); r++) {
+    for (int c = col; c <= AOMMIN(col + 1, cols - 1); c++) {
+      if (changed_cells[r * cols + c]) return 1;
+    }
+  }
+  return 0;
+}
+
+// Returns whether the cell at (col, row) or one of its 8 neighbors changed,
+// i.e. whether the hash values of the blocks starting in the cell may be
+// needed to generate those of the blocks overlapping a changed cell.
+static int cell_near_change(const uint8_t *changed_cells, int cols, int rows,
+                            int col, int row) {
+  for (int r = AOMMAX(row - 1, 0); r <= AOMMIN(row + 1, rows - 1); r++) {
+    for (int c = AOMMAX(col - 1, 0); c <= AOMMIN(col + 1, cols - 1); c++) {
+      if (changed_cells[r * cols + c]) return 1;
+    }
+  }
+  return 0;
+}
+
+int av1_hash_table_find_changed_cells(const hash_table *p_hash_table,
+                                      const YV12_BUFFER_CONFIG *picture,
+                                      int min_block_size, int max_block_size,
+                                      uint8_t *changed_cells) {
+  const int use_highbitdepth = (picture->flags & YV12_FLAG_HIGHBITDEPTH) != 0;
+  const int pic_width = picture->y_crop_width;
+  const int pic_height = picture->y_crop_height;
+  if (!p_hash_table->has_picture || p_hash_table->pic_width != pic_width ||
+      p_hash_table->pic_height != pic_height ||
+      p_hash_table->pic_use_highbitdepth != use_highbitdepth ||
+      p_hash_table->min_block_size != min_block_size ||
+      p_hash_table->max_block_size != max_block_size) {
+    return -1;
+  }
+
+  const int cell_size_log2 = get_msb(max_block_size);
+  const int cols = get_num_cells(pic_width, cell_size_log2);
+  const int rows = get_num_cells(pic_height, cell_size_log2);
+  const int bytes_per_sample = use_highbitdepth ? 2 : 1;
+  const uint8_t *const src =
+      use_highbitdepth ? (const uint8_t *)CONVERT_TO_SHORTPTR(picture->y_buffer)
+                       : picture->y_buffer;
+  const ptrdiff_t src_stride = (ptrdiff_t)picture->y_stride * bytes_per_sample;
+  const ptrdiff_t ref_stride = (ptrdiff_t)pic_width * bytes_per_sample;
+  int num_changed = 0;
+  for (int row = 0; row < rows; row++) {
+    const int y_start = row << cell_size_log2;
+    const int y_stop = AOMMIN(y_start + max_block_size, pic_height);
+    for (int col = 0; col < cols; col++) {
+      const int x_start = col << cell_size_log2;
+      const size_t row_bytes =
+          (size_t)AOMMIN(max_block_size, pic_width - x_start) *
+          bytes_per_sample;
+      const uint8_t *s =
+          src + y_start * src_stride + x_start * bytes_per_sample;
+      const uint8_t *r = p_hash_table->picture + y_start * ref_stride +
+                         x_start * bytes_per_sample;
+      int changed = 0;
+      for (int y_pos = y_start; y_pos < y_stop; y_pos++) {
+        if (memcmp(s, r, row_bytes)) {
+          changed = 1;
+          break;
+        }
+        s += src_stride;
+        r += ref_stride;
+      }
+      changed_cells[row * cols + col] = changed;
+      num_changed += changed;
+    }
+  }
+  return num_changed;
+}
+
+// Counts the blocks of block_size which overlap a changed cell in each bucket
+// if blocks is NULL. Otherwise, adds them to blocks at next_block[bucket], by
+// x then y.
+static void scan_changed_blocks(uint32_t *pic_hash[2],
+                                const int8_t *pic_is_same, int pic_width,
+                                int pic_height, int block_size,
+                                const uint8_t *changed_cells,
+                                int cell_size_log2, uint32_t *next_block,
+                                block_hash *blocks) {
   const int x_end = pic_width - block_size + 1;
   const int y_end = pic_height - block_size + 1;
+  const int cols = get_num_cells(pic_width, cell_size_log2);
+  const int rows = get_num_cells(pic_height, cell_size_log2);
+  const uint32_t crc_mask = (1 << kSrcBits) - 1;
+  for (int x_pos = 0; x_pos < x_end; x_pos++) {
+    const int col = x_pos >> cell_size_log2;
+    for (int row = 0; row < rows; row++) {
+      if (!cell_has_changed_blocks(changed_cells, cols, rows, col, row)) {
+        continue;
+      }
+      const int y_stop = AOMMIN((row + 1) << cell_size_log2, y_end);
+      for (int y_pos = row << cell_size_log2; y_pos < y_stop; y_pos++) {
+        const int pos = y_pos * pic_width + x_pos;
+        if (!pic_is_same[pos] ||
+            !is_block_changed(changed_cells, cols, cell_size_log2, x_pos, y_pos,
+                              block_size)) {
+          continue;
+        }
+        const uint32_t bucket = pic_hash[0][pos] & crc_mask;
+        if (blocks) {
+          block_hash *const curr_block_hash = &blocks[next_block[bucket]];
+          curr_block_hash->x = x_pos;
+          curr_block_hash->y = y_pos;
+          curr_block_hash->hash_value2 = pic_hash[1][pos];
+        }
+        next_block[bucket]++;
+      }
+    }
+  }
+}
 
-  const int8_t *src_is_added = pic_is_same;
-  const uint32_t *src_hash[2] = { pic_hash[0], pic_hash[1] };
+// Adds the buckets of block_size to the spare buffers of the table. The blocks
+// of the previous picture which do not overlap a changed cell are kept, and
+// merged with the blocks overlapping a changed cell, which are taken from
+// pic_hash and pic_is_same, so that the blocks of a bucket are ordered by x
+// then y as when the table is built. *num_new_buckets is the number of buckets
+// of the spare buffers filled so far.
+static bool update_block_size(hash_table *p_hash_table, uint32_t *pic_hash[2],
+                              const int8_t *pic_is_same, int pic_width,
+                              int pic_height, int block_size,
+                              const uint8_t *changed_cells,
+                              uint32_t *num_new_buckets) {
+  const int cell_size_log2 = get_msb(p_hash_table->max_block_size);
+  const int cols = get_num_cells(pic_width, cell_size_log2);
+  const uint32_t first_bucket = (uint32_t)hash_block_size_to_index(block_size)
+                                << kSrcBits;
+  const uint32_t *const old_start = p_hash_table->bucket_start + first_bucket;
+  const block_hash *const old_blocks = p_hash_table->blocks;
+  if (!alloc_band_counts(p_hash_table, 2)) return false;
+  uint32_t *const num_kept = p_hash_table->band_counts;
+  uint32_t *const changed_start = num_kept + kBucketsPerBlockSize;
+
+  for (int i = 0; i < kBucketsPerBlockSize; i++) {
+    for (uint32_t j = old_start[i]; j < old_start[i + 1]; j++) {
+      num_kept[i] += !is_block_changed(changed_cells, cols, cell_size_log2,
+                                       old_blocks[j].x, old_blocks[j].y,
+                                       block_size);
+    }
+  }
+  scan_changed_blocks(pic_hash, pic_is_same, pic_width, pic_height, block_size,
+                      changed_cells, cell_size_log2, changed_start, NULL);
 
-  int add_value = hash_block_size_to_index(block_size);
-  assert(add_value >= 0);
-  add_value <<= kSrcBits;
-  const int crc_mask = (1 << kSrcBits) - 1;
+  uint32_t *const new_start = p_hash_table->spare_bucket_start;
+  uint64_t total = new_start[*num_new_buckets];
+  for (uint32_t i = *num_new_buckets; i < first_bucket; i++) {
+    new_start[i] = (uint32_t)total;
+  }
+  uint32_t num_changed = 0;
+  for (int i = 0; i < kBucketsPerBlockSize; i++) {
+    new_start[first_bucket + i] = (uint32_t)total;
+    total += num_kept[i] + changed_start[i];
+    const uint32_t count = changed_start[i];
+    changed_start[i] = num_changed;
+    num_changed += count;
+  }
+  if (total > UINT32_MAX) return false;
+  *num_new_buckets = first_bucket + kBucketsPerBlockSize;
+  new_start[*num_new_buckets] = (uint32_t)total;
+  if (!grow_blocks(&p_hash_table->spare_blocks,
+                   &p_hash_table->spare_blocks_alloc_size, (size_t)total,
+                   new_start[first_bucket]) ||
+      !grow_blocks(&p_hash_table->changed_blocks,
+                   &p_hash_table->changed_blocks_alloc_size, num_changed, 0)) {
+    return false;
+  }
 
-  for (int x_pos = 0; x_pos < x_end; x_pos++) {
-    for (int y_pos = 0; y_pos < y_end; y_pos++) {
-      const int pos = y_pos * pic_width + x_pos;
-      // valid data
-      if (src_is_added[pos]) {
-        block_hash curr_block_hash;
-        curr_block_hash.x = x_pos;
-        curr_block_hash.y = y_pos;
-
-        const uint32_t hash_value1 = (src_hash[0][pos] & crc_mask) + add_value;
-        curr_block_hash.hash_value2 = src_hash[1][pos];
-
-        if (!hash_table_add_to_table(p_hash_table, hash_value1,
-                                     &curr_block_hash)) {
-          return false;
+  // num_kept is reused as the end of the changed blocks of each bucket.
+  uint32_t *const changed_end = num_kept;
+  memcpy(changed_end, changed_start,
+         kBucketsPerBlockSize * sizeof(*changed_end));
+  scan_changed_blocks(pic_hash, pic_is_same, pic_width, pic_height, block_size,
+                      changed_cells, cell_size_log2, changed_end,
+                      p_hash_table->changed_blocks);
+
+  for (int i = 0; i < kBucketsPerBlockSize; i++) {
+    const block_hash *old_block = old_blocks + old_start[i];
+    const block_hash *const old_end = old_blocks + old_start[i + 1];
+    const block_hash *changed_block =
+        p_hash_table->changed_blocks + changed_start[i];
+    const block_hash *const changed_block_end =
+        p_hash_table->changed_blocks + changed_end[i];
+    block_hash *dst = p_hash_table->spare_blocks + new_start[first_bucket + i];
+    for (; old_block < old_end; old_block++) {
+      if (is_block_changed(changed_cells, cols, cell_size_log2, old_block->x,
+                           old_block->y, block_size)) {
+        continue;
+      }
+      while (changed_block < changed_block_end &&
+             (changed_block->x < old_block->x ||
+              (changed_block->x == old_block->x &&
+               changed_block->y < old_block->y))) {
+        *dst++ = *changed_block++;
+      }
+      *dst++ = *old_block;
+    }
+    while (changed_block < changed_block_end) *dst++ = *changed_block++;
+    assert(dst ==
+           p_hash_table->spare_blocks + new_start[first_bucket + i + 1]);
+  }
+  return true;
+}
+
+bool av1_hash_table_update(HashTableBuildCtx *ctx,
+                           const uint8_t *changed_cells) {
+  IntraBCHashInfo *const intrabc_hash_info = ctx->intrabc_hash_info;
+  hash_table *const p_hash_table = &intrabc_hash_info->intrabc_hash_table;
+  const YV12_BUFFER_CONFIG *const picture = ctx->picture;
+  const int pic_width = picture->y_crop_width;
+  const int pic_height = picture->y_crop_height;
+  const int cell_size = p_hash_table->max_block_size;
+  const int cell_size_log2 = get_msb(cell_size);
+  const int cols = get_num_cells(pic_width, cell_size_log2);
+  const int rows = get_num_cells(pic_height, cell_size_log2);
+  CRC_CALCULATOR crc_calculator1 = intrabc_hash_info->crc_calculator1;
+  CRC_CALCULATOR crc_calculator2 = intrabc_hash_info->crc_calculator2;
+
+  // The table does not describe a picture until the update is complete.
+  p_hash_table->has_picture = false;
+  if (p_hash_table->spare_bucket_start == NULL) {
+    p_hash_table->spare_bucket_start = (uint32_t *)aom_malloc(
+        (kMaxAddr + 1) * sizeof(*p_hash_table->spare_bucket_start));
+    if (!p_hash_table->spare_bucket_start) return false;
+  }
+  p_hash_table->spare_bucket_start[0] = 0;
+  uint32_t num_new_buckets = 0;
+
+  ctx->dst_idx = 1;
+  for (int size = 2; size <= p_hash_table->max_block_size; size *= 2) {
+    const int x_end = pic_width - size + 1;
+    const int y_end = pic_height - size + 1;
+    ctx->block_size = size;
+    ctx->dst_idx = !ctx->dst_idx;
+    const int src_idx = !ctx->dst_idx;
+    const int dst_idx = ctx->dst_idx;
+    for (int row = 0; row < rows; row++) {
+      const int y_start = row << cell_size_log2;
+      const int y_stop = AOMMIN(y_start + cell_size, y_end);
+      for (int col = 0; col < cols; col++) {
+        const int x_start = col << cell_size_log2;
+        const int x_stop = AOMMIN(x_start + cell_size, x_end);
+        if (x_start >= x_stop || y_start >= y_stop ||
+            !cell_near_change(changed_cells, cols, rows, col, row)) {
+          continue;
+        }
+        if (size == 2) {
+          generate_block_2x2_hash_value_rect(
+              &crc_calculator1, &crc_calculator2, picture,
+              ctx->block_hash_values[dst_idx], ctx->is_block_same[dst_idx],
+              x_start, x_stop, y_start, y_stop);
+        } else {
+          generate_block_hash_value_rect(
+              &crc_calculator1, &crc_calculator2, pic_width, size,
+              ctx->block_hash_values[src_idx], ctx->block_hash_values[dst_idx],
+              ctx->is_block_same[src_idx], ctx->is_block_same[dst_idx],
+              x_start, x_stop, y_start, y_stop);
+        }
+      }
+    }
+    if (size >= p_hash_table->min_block_size &&
+        !update_block_size(p_hash_table, ctx->block_hash_values[dst_idx],
+                           ctx->is_block_same[dst_idx][2], pic_width,
+                           pic_height, size, changed_cells,
+                           &num_new_buckets)) {
+      return false;
+    }
+  }
+  assert(num_new_buckets == p_hash_table->num_buckets);
+
+  uint32_t *const bucket_start = p_hash_table->bucket_start;
+  p_hash_table->bucket_start = p_hash_table->spare_bucket_start;
+  p_hash_table->spare_bucket_start = bucket_start;
+  block_hash *const blocks = p_hash_table->blocks;
+  p_hash_table->blocks = p_hash_table->spare_blocks;
+  p_hash_table->spare_blocks = blocks;
+  const size_t blocks_alloc_size = p_hash_table->blocks_alloc_size;
+  p_hash_table->blocks_alloc_size = p_hash_table->spare_blocks_alloc_size;
+  p_hash_table->spare_blocks_alloc_size = blocks_alloc_size;
+  return true;
+}
+
+bool av1_hash_table_set_picture(hash_table *p_hash_table,
+                                const YV12_BUFFER_CONFIG *picture,
+                                int min_block_size, int max_block_size,
+                                const uint8_t *changed_cells) {
+  const int use_highbitdepth = (picture->flags & YV12_FLAG_HIGHBITDEPTH) != 0;
+  const int pic_width = picture->y_crop_width;
+  const int pic_height = picture->y_crop_height;
+  const int bytes_per_sample = use_highbitdepth ? 2 : 1;
+  const uint8_t *const src =
+      use_highbitdepth ? (const uint8_t *)CONVERT_TO_SHORTPTR(picture->y_buffer)
+                       : picture->y_buffer;
+  const ptrdiff_t src_stride = (ptrdiff_t)picture->y_stride * bytes_per_sample;
+  const ptrdiff_t dst_stride = (ptrdiff_t)pic_width * bytes_per_sample;
+
+  if (changed_cells == NULL) {
+    const size_t size = (size_t)dst_stride * pic_height;
+    p_hash_table->has_picture = false;
+    if (size > p_hash_table->picture_alloc_size) {
+      aom_free(p_hash_table->picture);
+      p_hash_table->picture = (uint8_t *)aom_malloc(size);
+      if (!p_hash_table->picture) {
+        p_hash_table->picture_alloc_size = 0;
+        return false;
+      }
+      p_hash_table->picture_alloc_size = size;
+    }
+    p_hash_table->pic_width = pic_width;
+    p_hash_table->pic_height = pic_height;
+    p_hash_table->pic_use_highbitdepth = use_highbitdepth;
+    p_hash_table->min_block_size = min_block_size;
+    p_hash_table->max_block_size = max_block_size;
+    for (int y_pos = 0; y_pos < pic_height; y_pos++) {
+      memcpy(p_hash_table->picture + y_pos * dst_stride,
+             src + y_pos * src_stride, (size_t)dst_stride);
+    }
+  } else {
+    assert(p_hash_table->pic_width == pic_width &&
+           p_hash_table->pic_height == pic_height &&
+           p_hash_table->pic_use_highbitdepth == use_highbitdepth &&
+           p_hash_table->min_block_size == min_block_size &&
+           p_hash_table->max_block_size == max_block_size);
+    const int cell_size_log2 = get_msb(max_block_size);
+    const int cols = get_num_cells(pic_width, cell_size_log2);
+    const int rows = get_num_cells(pic_height, cell_size_log2);
+    for (int row = 0; row < rows; row++) {
+      const int y_start = row << cell_size_log2;
+      const int y_stop = AOMMIN(y_start + max_block_size, pic_height);
+      for (int col = 0; col < cols; col++) {
+        if (!changed_cells[row * cols + col]) continue;
+        const int x_start = col << cell_size_log2;
+        const size_t row_bytes =
+            (size_t)AOMMIN(max_block_size, pic_width - x_start) *
+            bytes_per_sample;
+        for (int y_pos = y_start; y_pos < y_stop; y_pos++) {
+          memcpy(p_hash_table->picture + y_pos * dst_stride +
+                     x_start * bytes_per_sample,
+                 src + y_pos * src_stride + x_start * bytes_per_sample,
+                 row_bytes);
         }
       }
     }
   }
+  p_hash_table->has_picture = true;
   return true;
 }
 
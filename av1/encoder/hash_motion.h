@@ -19,7 +19,6 @@
 #include "aom/aom_integer.h"
 #include "aom_scale/yv12config.h"
 #include "av1/encoder/hash.h"
-#include "third_party/vector/vector.h"
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -36,8 +35,46 @@ typedef struct _block_hash {
   uint32_t hash_value2;
 } block_hash;
 
+// Index of the blocks of a picture by hash value. The blocks of a bucket are
+// stored contiguously in 'blocks', from blocks[bucket_start[hash_value]] up to
+// blocks[bucket_start[hash_value + 1]]. The buckets are filled one block size
+// at a time in increasing hash value order, i.e. from the smallest block size,
+// using a counting sort. The buffers are kept when the table is reset so that
+// they can be reused by the next frame.
 typedef struct _hash_table {
-  Vector **p_lookup_table;
+  uint32_t *bucket_start;
+  // Number of buckets filled so far. bucket_start[num_buckets] is the number
+  // of blocks in the table.
+  uint32_t num_buckets;
+  block_hash *blocks;
+  size_t blocks_alloc_size;
+  // Number of blocks per bucket of the block size being added, for each column
+  // band of the picture. Turned into the position of the next block of each
+  // bucket and band by av1_hash_table_assign_buckets().
+  uint32_t *band_counts;
+  int band_counts_alloc_size;
+
+  // Luma samples of the picture the table holds the blocks of, to which the
+  // next picture is compared by av1_hash_table_find_changed_cells(). Only
+  // valid when has_picture is set.
+  uint8_t *picture;
+  size_t picture_alloc_size;
+  bool has_picture;
+  int pic_width;
+  int pic_height;
+  int pic_use_highbitdepth;
+  // Smallest and largest block sizes added to the table.
+  int min_block_size;
+  int max_block_size;
+  // Buffers av1_hash_table_update() rebuilds the table in, swapped with
+  // bucket_start and blocks once done.
+  uint32_t *spare_bucket_start;
+  block_hash *spare_blocks;
+  size_t spare_blocks_alloc_size;
+  // Blocks of the changed regions of the block size being updated, sorted by
+  // bucket.
+  block_hash *changed_blocks;
+  size_t changed_blocks_alloc_size;
 } hash_table;
 
 struct intrabc_hash_info;
@@ -60,25 +97,111 @@ void av1_hash_table_destroy(hash_table *p_hash_table);
 bool av1_hash_table_create(hash_table *p_hash_table);
 int32_t av1_hash_table_count(const hash_table *p_hash_table,
                              uint32_t hash_value);
-Iterator av1_hash_get_first_iterator(hash_table *p_hash_table,
-                                     uint32_t hash_value);
+// Returns the first of the av1_hash_table_count() blocks with hash_value.
+const block_hash *av1_hash_get_first_block(const hash_table *p_hash_table,
+                                           uint32_t hash_value);
+// The hash values of the blocks are generated for the rows of the picture
+// in band 'band' of 'num_bands' row bands, so that bands can be processed in
+// parallel. The blocks of a size are generated from those of half the size.
 void av1_generate_block_2x2_hash_value(IntraBCHashInfo *intra_bc_hash_info,
                                        const YV12_BUFFER_CONFIG *picture,
                                        uint32_t *pic_block_hash[2],
-                                       int8_t *pic_block_same_info[3]);
+                                       int8_t *pic_block_same_info[3],
+                                       int band, int num_bands);
 void av1_generate_block_hash_value(IntraBCHashInfo *intra_bc_hash_info,
                                    const YV12_BUFFER_CONFIG *picture,
                                    int block_size,
                                    uint32_t *src_pic_block_hash[2],
                                    uint32_t *dst_pic_block_hash[2],
                                    int8_t *src_pic_block_same_info[3],
-                                   int8_t *dst_pic_block_same_info[3]);
+                                   int8_t *dst_pic_block_same_info[3],
+                                   int band, int num_bands);
 bool av1_add_to_hash_map_by_row_with_precal_data(hash_table *p_hash_table,
                                                  uint32_t *pic_hash[2],
                                                  int8_t *pic_is_same,
                                                  int pic_width, int pic_height,
                                                  int block_size);
 
+// av1_add_to_hash_map_by_row_with_precal_data() split in steps, so that the
+// blocks of num_bands column bands of the picture can be counted and added in
+// parallel:
+// - av1_hash_table_begin_block_size()
+// - av1_hash_table_count_band() for each band
+// - av1_hash_table_assign_buckets()
+// - av1_hash_table_fill_band() for each band
+// Block sizes must be added in increasing order. The functions returning bool
+// return false on allocation failure.
+bool av1_hash_table_begin_block_size(hash_table *p_hash_table, int block_size,
+                                     int num_bands);
+void av1_hash_table_count_band(hash_table *p_hash_table,
+                               uint32_t *pic_hash[2], const int8_t *pic_is_same,
+                               int pic_width, int pic_height, int block_size,
+                               int band, int num_bands);
+bool av1_hash_table_assign_buckets(hash_table *p_hash_table, int block_size,
+                                   int num_bands);
+void av1_hash_table_fill_band(hash_table *p_hash_table, uint32_t *pic_hash[2],
+                              const int8_t *pic_is_same, int pic_width,
+                              int pic_height, int block_size, int band,
+                              int num_bands);
+
+// Stages of the construction of the hash table of a picture. Each stage is
+// run on every band of the picture before the next one starts.
+typedef enum {
+  // Generate the hash values of the blocks of a band of rows.
+  HASH_TABLE_GENERATE,
+  // Count the blocks of a band of columns in each bucket.
+  HASH_TABLE_COUNT,
+  // Add the blocks of a band of columns to their buckets.
+  HASH_TABLE_FILL,
+} HASH_TABLE_BUILD_STAGE;
+
+typedef struct {
+  IntraBCHashInfo *intrabc_hash_info;
+  const YV12_BUFFER_CONFIG *picture;
+  // [two buffers used ping-pong][first hash/second hash]
+  uint32_t *block_hash_values[2][2];
+  // [two buffers used ping-pong][row same/column same/added to the table]
+  int8_t *is_block_same[2][3];
+  // Size of the blocks of the current stage, from 2 up to the superblock size.
+  int block_size;
+  // Buffers holding the blocks of block_size. Those of block_size / 2 are in
+  // the other buffers.
+  int dst_idx;
+  HASH_TABLE_BUILD_STAGE stage;
+  int num_bands;
+} HashTableBuildCtx;
+
+// Runs the current stage of the hash table construction on one band.
+void av1_hash_table_build_band(HashTableBuildCtx *ctx, int band);
+
+// Successive pictures of screen content often differ in a few regions only, in
+// which case the table of the previous picture can be updated rather than
+// rebuilt. Pictures are compared in cells of max_block_size x max_block_size
+// luma samples, in raster order.
+//
+// Compares 'picture' to the picture of the table. Sets the cells which differ
+// in changed_cells and returns their number, or returns -1 if the table can
+// not be updated for 'picture', e.g. because the dimensions or the block sizes
+// of the table differ.
+int av1_hash_table_find_changed_cells(const hash_table *p_hash_table,
+                                      const YV12_BUFFER_CONFIG *picture,
+                                      int min_block_size, int max_block_size,
+                                      uint8_t *changed_cells);
+// Updates the table of the previous picture for ctx->picture, which only
+// differs in changed_cells. The hash values of the blocks around the changed
+// cells are generated in the buffers of ctx. Returns false on allocation
+// failure, in which case the table must be rebuilt.
+bool av1_hash_table_update(HashTableBuildCtx *ctx,
+                           const uint8_t *changed_cells);
+// Records 'picture' as the picture of the table, which holds its blocks of
+// min_block_size up to max_block_size. If changed_cells is not NULL, the table
+// was updated by av1_hash_table_update() and only those cells are copied.
+// Returns false on allocation failure.
+bool av1_hash_table_set_picture(hash_table *p_hash_table,
+                                const YV12_BUFFER_CONFIG *picture,
+                                int min_block_size, int max_block_size,
+                                const uint8_t *changed_cells);
+
 // check whether the block starts from (x_start, y_start) with the size of
 // block_size x block_size has the same color in all rows
 int av1_hash_is_horizontal_perfect(const YV12_BUFFER_CONFIG *picture,
@@ -13,6 +13,8 @@
 
 #include "config/aom_config.h"
 
+#include "aom_dsp/flow_estimation/corner_detect.h"
+#include "aom_dsp/pyramid.h"
 #include "aom_scale/yv12config.h"
 #include "av1/common/common.h"
 #include "av1/encoder/encoder.h"
@@ -30,12 +32,72 @@ static struct lookahead_entry *pop(struct lookahead_ctx *ctx, int *idx) {
   return buf;
 }
 
+// Points the entry back to its own buffer, and hands the application frame it
+// referenced back to the application.
+static void release_input_buffer(struct lookahead_entry *buf) {
+  YV12_BUFFER_CONFIG *const img = &buf->img;
+  if (!img->use_external_reference_buffers) return;
+  img->y_buffer = img->store_buf_adr[0];
+  img->u_buffer = img->store_buf_adr[1];
+  img->v_buffer = img->store_buf_adr[2];
+  img->y_stride = buf->store_strides[0];
+  img->uv_stride = buf->store_strides[1];
+  img->use_external_reference_buffers = 0;
+  buf->extend_pending = 0;
+  buf->ext.release_cb(buf->ext.cb_priv, buf->ext.user_priv);
+  buf->ext.release_cb = NULL;
+}
+
+// Returns whether the frame 'src', backed by the application frame 'ext', can
+// be referenced by the entry instead of being copied to its buffer.
+static bool can_reference_input_buffer(
+    const struct lookahead_entry *buf, const YV12_BUFFER_CONFIG *src,
+    const struct lookahead_input_buffer *ext) {
+  const YV12_BUFFER_CONFIG *const img = &buf->img;
+  // The extension to the right and at the bottom may exceed the border, see
+  // av1_copy_and_extend_frame().
+  const int border = img->border;
+  const int extend_right =
+      AOMMAX(img->y_width + border, ALIGN_POWER_OF_TWO(img->y_width, 6)) -
+      img->y_crop_width;
+  const int extend_bottom =
+      AOMMAX(img->y_height + border, ALIGN_POWER_OF_TWO(img->y_height, 6)) -
+      img->y_crop_height;
+  // NV12 and monochrome input are converted by the copy.
+  return src->v_buffer != NULL && !src->monochrome &&
+         src->y_crop_width == img->y_crop_width &&
+         src->y_crop_height == img->y_crop_height &&
+         src->uv_crop_width == img->uv_crop_width &&
+         src->uv_crop_height == img->uv_crop_height &&
+         src->subsampling_x == img->subsampling_x &&
+         src->subsampling_y == img->subsampling_y &&
+         (src->flags & YV12_FLAG_HIGHBITDEPTH) ==
+             (img->flags & YV12_FLAG_HIGHBITDEPTH) &&
+         ext->border >= AOMMAX(extend_right, extend_bottom) &&
+         src->y_stride >= src->y_crop_width + 2 * ext->border &&
+         src->uv_stride >=
+             src->uv_crop_width + 2 * (ext->border >> src->subsampling_x);
+}
+
+// Extends the borders of a referenced application frame on first use.
+static struct lookahead_entry *extend_pending_border(
+    struct lookahead_entry *buf) {
+  if (buf != NULL && buf->extend_pending) {
+    av1_copy_and_extend_frame(&buf->img, &buf->img);
+    buf->extend_pending = 0;
+  }
+  return buf;
+}
+
 void av1_lookahead_destroy(struct lookahead_ctx *ctx) {
   if (ctx) {
     if (ctx->buf) {
       int i;
 
-      for (i = 0; i < ctx->max_sz; i++) aom_free_frame_buffer(&ctx->buf[i].img);
+      for (i = 0; i < ctx->max_sz; i++) {
+        release_input_buffer(&ctx->buf[i]);
+        aom_free_frame_buffer(&ctx->buf[i].img);
+      }
       free(ctx->buf);
     }
     free(ctx);
@@ -98,9 +160,31 @@ int av1_lookahead_full(const struct lookahead_ctx *ctx) {
   return ctx->read_ctxs[ENCODE_STAGE].sz >= ctx->read_ctxs[ENCODE_STAGE].pop_sz;
 }
 
+static int finish_push(struct lookahead_ctx *ctx, struct lookahead_entry *buf,
+                       const YV12_BUFFER_CONFIG *src, int64_t ts_start,
+                       int64_t ts_end, aom_enc_frame_flags_t flags) {
+  buf->ts_start = ts_start;
+  buf->ts_end = ts_end;
+  buf->display_idx = ctx->push_frame_count;
+  buf->flags = flags;
+  ++ctx->push_frame_count;
+#if !CONFIG_REALTIME_ONLY
+  // The buffer may have held an earlier frame.
+  aom_invalidate_pyramid(buf->img.y_pyramid);
+  av1_invalidate_corner_list(buf->img.corners);
+#endif  // !CONFIG_REALTIME_ONLY
+  aom_remove_metadata_from_frame_buffer(&buf->img);
+  if (src->metadata &&
+      aom_copy_metadata_to_frame_buffer(&buf->img, src->metadata)) {
+    return 1;
+  }
+  return 0;
+}
+
 int av1_lookahead_push(struct lookahead_ctx *ctx, const YV12_BUFFER_CONFIG *src,
                        int64_t ts_start, int64_t ts_end, int use_highbitdepth,
-                       bool alloc_pyramid, aom_enc_frame_flags_t flags) {
+                       bool alloc_pyramid, aom_enc_frame_flags_t flags,
+                       struct lookahead_input_buffer *ext) {
   int width = src->y_crop_width;
   int height = src->y_crop_height;
   int uv_width = src->uv_crop_width;
@@ -119,6 +203,26 @@ int av1_lookahead_push(struct lookahead_ctx *ctx, const YV12_BUFFER_CONFIG *src,
   }
 
   struct lookahead_entry *buf = pop(ctx, &ctx->write_idx);
+  release_input_buffer(buf);
+
+  if (ext != NULL && can_reference_input_buffer(buf, src, ext)) {
+    YV12_BUFFER_CONFIG *const img = &buf->img;
+    img->store_buf_adr[0] = img->y_buffer;
+    img->store_buf_adr[1] = img->u_buffer;
+    img->store_buf_adr[2] = img->v_buffer;
+    buf->store_strides[0] = img->y_stride;
+    buf->store_strides[1] = img->uv_stride;
+    img->y_buffer = src->y_buffer;
+    img->u_buffer = src->u_buffer;
+    img->v_buffer = src->v_buffer;
+    img->y_stride = src->y_stride;
+    img->uv_stride = src->uv_stride;
+    img->use_external_reference_buffers = 1;
+    buf->ext = *ext;
+    buf->extend_pending = 1;
+    ext->release_cb = NULL;
+    return finish_push(ctx, buf, src, ts_start, ts_end, flags);
+  }
 
   new_dimensions = width != buf->img.y_crop_width ||
                    height != buf->img.y_crop_height ||
@@ -151,18 +255,7 @@ int av1_lookahead_push(struct lookahead_ctx *ctx, const YV12_BUFFER_CONFIG *src,
     buf->img.subsampling_y = src->subsampling_y;
   }
   av1_copy_and_extend_frame(src, &buf->img);
-
-  buf->ts_start = ts_start;
-  buf->ts_end = ts_end;
-  buf->display_idx = ctx->push_frame_count;
-  buf->flags = flags;
-  ++ctx->push_frame_count;
-  aom_remove_metadata_from_frame_buffer(&buf->img);
-  if (src->metadata &&
-      aom_copy_metadata_to_frame_buffer(&buf->img, src->metadata)) {
-    return 1;
-  }
-  return 0;
+  return finish_push(ctx, buf, src, ts_start, ts_end, flags);
 }
 
 struct lookahead_entry *av1_lookahead_pop(struct lookahead_ctx *ctx, int drain,
@@ -176,7 +269,7 @@ struct lookahead_entry *av1_lookahead_pop(struct lookahead_ctx *ctx, int drain,
       read_ctx->sz--;
     }
   }
-  return buf;
+  return extend_pending_border(buf);
 }
 
 struct lookahead_entry *av1_lookahead_peek(struct lookahead_ctx *ctx, int index,
@@ -204,7 +297,7 @@ struct lookahead_entry *av1_lookahead_peek(struct lookahead_ctx *ctx, int index,
     }
   }
 
-  return buf;
+  return extend_pending_border(buf);
 }
 
 unsigned int av1_lookahead_depth(struct lookahead_ctx *ctx,
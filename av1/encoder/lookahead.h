@@ -19,6 +19,7 @@
 
 #include "aom_scale/yv12config.h"
 #include "aom/aom_integer.h"
+#include "aom/aomcx.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -30,12 +31,29 @@ extern "C" {
 #define MAX_TOTAL_BUFFERS (MAX_LAG_BUFFERS + MAX_LAP_BUFFERS)
 #define LAP_LAG_IN_FRAMES 17
 
+// Frame owned by the application, see AV1E_SET_INPUT_BUFFER_CB.
+struct lookahead_input_buffer {
+  aom_release_input_buffer_cb_fn_t release_cb;
+  void *cb_priv;
+  void *user_priv;
+  // Border, in luma pixels, allocated around each plane.
+  int border;
+};
+
 struct lookahead_entry {
   YV12_BUFFER_CONFIG img;
   int64_t ts_start;
   int64_t ts_end;
   int display_idx;
   aom_enc_frame_flags_t flags;
+  // Application frame referenced by 'img' while
+  // img.use_external_reference_buffers is set. The plane pointers and strides
+  // of the entry's own buffer are kept in img.store_buf_adr and
+  // 'store_strides'.
+  struct lookahead_input_buffer ext;
+  int store_strides[2];
+  // Whether the borders of 'img' are still to be extended.
+  int extend_pending;
 };
 
 // The max of past frames we want to keep in the queue.
@@ -83,7 +101,12 @@ int av1_lookahead_full(const struct lookahead_ctx *ctx);
 /**\brief Enqueue a source buffer
  *
  * This function will copy the source image into a new framebuffer with
- * the expected stride/border.
+ * the expected stride/border. If \p ext is not NULL and the image has the
+ * size, format and border of the lookahead buffers, the image is referenced
+ * instead, and \p ext->release_cb is set to NULL to indicate that the
+ * lookahead calls it when the image is no longer used. The borders of a
+ * referenced image are extended in place when the frame is first returned by
+ * av1_lookahead_pop() or av1_lookahead_peek().
  *
  * \param[in] ctx               Pointer to the lookahead context
  * \param[in] src               Pointer to the image to enqueue
@@ -93,10 +116,12 @@ int av1_lookahead_full(const struct lookahead_ctx *ctx);
  * \param[in] alloc_pyramid     Whether to allocate a downsampling pyramid
  *                              for each frame buffer
  * \param[in] flags             Flags set on this frame
+ * \param[in,out] ext           Application frame backing \p src, or NULL
  */
 int av1_lookahead_push(struct lookahead_ctx *ctx, const YV12_BUFFER_CONFIG *src,
                        int64_t ts_start, int64_t ts_end, int use_highbitdepth,
-                       bool alloc_pyramid, aom_enc_frame_flags_t flags);
+                       bool alloc_pyramid, aom_enc_frame_flags_t flags,
+                       struct lookahead_input_buffer *ext);
 
 /**\brief Get the next source buffer to encode
  *
@@ -131,6 +156,16 @@ unsigned int av1_lookahead_depth(struct lookahead_ctx *ctx,
  */
 int av1_lookahead_pop_sz(struct lookahead_ctx *ctx, COMPRESSOR_STAGE stage);
 
+/**\brief Get the luma stride of the lookahead's own buffer for \p entry,
+ * which differs from entry->img.y_stride while an application frame is
+ * referenced.
+ */
+static inline int av1_lookahead_own_y_stride(
+    const struct lookahead_entry *entry) {
+  return entry->img.use_external_reference_buffers ? entry->store_strides[0]
+                                                   : entry->img.y_stride;
+}
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
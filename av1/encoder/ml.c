@@ -11,9 +11,12 @@
 
 #include <assert.h>
 #include <math.h>
+#include <string.h>
 
 #include "aom_dsp/aom_dsp_common.h"
 #include "aom_dsp/mathutils.h"
+#include "aom_mem/aom_mem.h"
+#include "aom_ports/mem.h"
 #include "av1/encoder/ml.h"
 
 void av1_nn_output_prec_reduce(float *const output, int num_output) {
@@ -69,6 +72,194 @@ void av1_nn_predict_c(const float *input_nodes,
   if (reduce_prec) av1_nn_output_prec_reduce(output, nn_config->num_outputs);
 }
 
+void av1_nn_fc_batch_c(const float *input, int num_samples, int num_inputs,
+                       const float *weights, const float *bias,
+                       int num_outputs, int relu, float *output) {
+  for (int sample = 0; sample < num_samples; ++sample) {
+    for (int node = 0; node < num_outputs; ++node) {
+      // Same order of operations as av1_nn_predict_c().
+      float val = bias[node];
+      for (int i = 0; i < num_inputs; ++i)
+        val += weights[node * num_inputs + i] * input[i];
+      if (relu) val = val > 0.0f ? val : 0.0f;
+      output[node] = val;
+    }
+    input += num_inputs;
+    output += num_outputs;
+  }
+}
+
+void av1_nn_predict_batch(const float *input_nodes, int num_samples,
+                          const NN_CONFIG *const nn_config, int reduce_prec,
+                          float *output) {
+  float buf[2][NN_BATCH_SIZE * NN_MAX_NODES_PER_LAYER];
+  const int num_layers = nn_config->num_hidden_layers;
+  assert(num_layers <= NN_MAX_HIDDEN_LAYERS);
+  for (int start = 0; start < num_samples; start += NN_BATCH_SIZE) {
+    const int batch_size = AOMMIN(NN_BATCH_SIZE, num_samples - start);
+    const float *layer_input = input_nodes + start * nn_config->num_inputs;
+    float *const batch_output = output + start * nn_config->num_outputs;
+    int num_input_nodes = nn_config->num_inputs;
+    int buf_index = 0;
+    for (int layer = 0; layer <= num_layers; ++layer) {
+      const int is_output_layer = layer == num_layers;
+      const int num_output_nodes = is_output_layer
+                                       ? nn_config->num_outputs
+                                       : nn_config->num_hidden_nodes[layer];
+      assert(num_output_nodes <= NN_MAX_NODES_PER_LAYER);
+      float *const layer_output =
+          is_output_layer ? batch_output : buf[buf_index];
+      // ReLU as activation function of the hidden layers.
+      av1_nn_fc_batch(layer_input, batch_size, num_input_nodes,
+                      nn_config->weights[layer], nn_config->bias[layer],
+                      num_output_nodes, !is_output_layer, layer_output);
+      num_input_nodes = num_output_nodes;
+      layer_input = layer_output;
+      buf_index = 1 - buf_index;
+    }
+  }
+  if (reduce_prec) {
+    av1_nn_output_prec_reduce(output, num_samples * nn_config->num_outputs);
+  }
+}
+
+void av1_nn_fc_q_c(const int16_t *input, const int8_t *weights,
+                   int weights_stride, int num_outputs, int32_t *output) {
+  for (int node = 0; node < num_outputs; ++node) {
+    int32_t val = 0;
+    for (int i = 0; i < weights_stride; ++i) val += weights[i] * input[i];
+    output[node] = val;
+    weights += weights_stride;
+  }
+}
+
+bool av1_nn_quantize(const NN_CONFIG *nn_config, NN_CONFIG_Q *nn_config_q) {
+  memset(nn_config_q, 0, sizeof(*nn_config_q));
+  nn_config_q->num_inputs = nn_config->num_inputs;
+  nn_config_q->num_outputs = nn_config->num_outputs;
+  nn_config_q->num_hidden_layers = nn_config->num_hidden_layers;
+  int num_inputs = nn_config->num_inputs;
+  for (int layer = 0; layer <= nn_config->num_hidden_layers; ++layer) {
+    const int is_output_layer = layer == nn_config->num_hidden_layers;
+    const int num_outputs = is_output_layer
+                                ? nn_config->num_outputs
+                                : nn_config->num_hidden_nodes[layer];
+    if (!is_output_layer) nn_config_q->num_hidden_nodes[layer] = num_outputs;
+    if (num_inputs > NN_MAX_NODES_PER_LAYER) {
+      av1_nn_free_quantized(nn_config_q);
+      return false;
+    }
+    const int stride =
+        (num_inputs + NN_Q_INPUT_ALIGN - 1) & ~(NN_Q_INPUT_ALIGN - 1);
+    int8_t *const weights_q =
+        (int8_t *)aom_calloc((size_t)num_outputs * stride, sizeof(*weights_q));
+    float *const scales = (float *)aom_malloc(num_outputs * sizeof(*scales));
+    float *const input_scales =
+        (float *)aom_malloc(num_inputs * sizeof(*input_scales));
+    nn_config_q->weights_stride[layer] = stride;
+    nn_config_q->weights[layer] = weights_q;
+    nn_config_q->weight_scales[layer] = scales;
+    nn_config_q->input_scales[layer] = input_scales;
+    nn_config_q->bias[layer] = nn_config->bias[layer];
+    if (weights_q == NULL || scales == NULL || input_scales == NULL) {
+      av1_nn_free_quantized(nn_config_q);
+      return false;
+    }
+    const float *const weights = nn_config->weights[layer];
+    for (int i = 0; i < num_inputs; ++i) {
+      float max_weight = 0.0f;
+      for (int node = 0; node < num_outputs; ++node) {
+        max_weight = AOMMAX(max_weight, fabsf(weights[node * num_inputs + i]));
+      }
+      input_scales[i] = max_weight;
+    }
+    for (int node = 0; node < num_outputs; ++node) {
+      const float *const node_weights = weights + node * num_inputs;
+      float max_weight = 0.0f;
+      for (int i = 0; i < num_inputs; ++i) {
+        if (input_scales[i] == 0.0f) continue;
+        max_weight =
+            AOMMAX(max_weight, fabsf(node_weights[i]) / input_scales[i]);
+      }
+      scales[node] = max_weight / 127.0f;
+      const float inv_scale = max_weight > 0.0f ? 127.0f / max_weight : 0.0f;
+      for (int i = 0; i < num_inputs; ++i) {
+        if (input_scales[i] == 0.0f) continue;
+        weights_q[node * stride + i] =
+            (int8_t)lrintf(node_weights[i] / input_scales[i] * inv_scale);
+      }
+    }
+    num_inputs = num_outputs;
+  }
+  return true;
+}
+
+void av1_nn_free_quantized(NN_CONFIG_Q *nn_config_q) {
+  for (int layer = 0; layer <= NN_MAX_HIDDEN_LAYERS; ++layer) {
+    aom_free(nn_config_q->weights[layer]);
+    aom_free(nn_config_q->weight_scales[layer]);
+    aom_free(nn_config_q->input_scales[layer]);
+    nn_config_q->weights[layer] = NULL;
+    nn_config_q->weight_scales[layer] = NULL;
+    nn_config_q->input_scales[layer] = NULL;
+  }
+}
+
+// Quantizes the n nodes of input, multiplied by input_scales, to int16 in
+// output, padded with 0 up to stride nodes. Returns the scale of the quantized
+// nodes.
+static float quantize_nodes(const float *input, const float *input_scales,
+                            int n, int stride, int16_t *output) {
+  float scaled[NN_MAX_NODES_PER_LAYER];
+  float max_val = 0.0f;
+  for (int i = 0; i < n; ++i) {
+    scaled[i] = input[i] * input_scales[i];
+    max_val = AOMMAX(max_val, fabsf(scaled[i]));
+  }
+  const float inv_scale = max_val > 0.0f ? INT16_MAX / max_val : 0.0f;
+  for (int i = 0; i < n; ++i) {
+    output[i] = (int16_t)lrintf(scaled[i] * inv_scale);
+  }
+  for (int i = n; i < stride; ++i) output[i] = 0;
+  return max_val / INT16_MAX;
+}
+
+void av1_nn_predict_q(const float *input_nodes,
+                      const NN_CONFIG_Q *const nn_config_q, int reduce_prec,
+                      float *const output) {
+  DECLARE_ALIGNED(32, int16_t, input_q[NN_MAX_NODES_PER_LAYER]);
+  int32_t acc[NN_MAX_NODES_PER_LAYER];
+  float buf[NN_MAX_NODES_PER_LAYER];
+  int num_inputs = nn_config_q->num_inputs;
+  const int num_layers = nn_config_q->num_hidden_layers;
+  assert(num_layers <= NN_MAX_HIDDEN_LAYERS);
+  for (int layer = 0; layer <= num_layers; ++layer) {
+    const int is_output_layer = layer == num_layers;
+    const int num_outputs = is_output_layer
+                                ? nn_config_q->num_outputs
+                                : nn_config_q->num_hidden_nodes[layer];
+    const int stride = nn_config_q->weights_stride[layer];
+    assert(num_outputs <= NN_MAX_NODES_PER_LAYER);
+    const float input_scale =
+        quantize_nodes(input_nodes, nn_config_q->input_scales[layer],
+                       num_inputs, stride, input_q);
+    av1_nn_fc_q(input_q, nn_config_q->weights[layer], stride, num_outputs,
+                acc);
+    const float *const scales = nn_config_q->weight_scales[layer];
+    const float *const bias = nn_config_q->bias[layer];
+    float *const output_nodes = is_output_layer ? output : buf;
+    for (int node = 0; node < num_outputs; ++node) {
+      float val = (float)acc[node] * (scales[node] * input_scale) + bias[node];
+      // ReLU as activation function of the hidden layers.
+      if (!is_output_layer) val = AOMMAX(val, 0.0f);
+      output_nodes[node] = val;
+    }
+    num_inputs = num_outputs;
+    input_nodes = buf;
+  }
+  if (reduce_prec) av1_nn_output_prec_reduce(output, nn_config_q->num_outputs);
+}
+
 #if CONFIG_NN_V2
 // Applies the ReLu activation to one fc layer
 // output[i] = Max(input[i],0.0f)
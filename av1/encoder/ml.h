@@ -16,6 +16,8 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
+
 #include "config/av1_rtcd.h"
 
 #define NN_MAX_HIDDEN_LAYERS 10
@@ -34,6 +36,82 @@ struct NN_CONFIG {
 };
 // Typedef from struct NN_CONFIG to NN_CONFIG is in rtcd_defs
 
+// The number of weights of a node of an NN_CONFIG_Q is a multiple of
+// NN_Q_INPUT_ALIGN, so that av1_nn_fc_q() has no partial vectors to process.
+#define NN_Q_INPUT_ALIGN 16
+
+// Fixed-point version of an NN_CONFIG, evaluated by av1_nn_predict_q(). The
+// weights of each node are quantized to int8 with a per-node scale, and the
+// nodes of each layer to int16 with a per-layer scale computed at prediction
+// time, so that the products are accumulated in int32. As the features of a
+// model can differ by orders of magnitude, each input of a layer is first
+// multiplied by the largest of its weights, which the weights are divided by,
+// so that the quantization error of the inputs is spread evenly across them.
+typedef struct NN_CONFIG_Q {
+  int num_inputs;         // Number of input nodes, i.e. features.
+  int num_outputs;        // Number of output nodes.
+  int num_hidden_layers;  // Number of hidden layers, maximum 10.
+  // Number of nodes for each hidden layer.
+  int num_hidden_nodes[NN_MAX_HIDDEN_LAYERS];
+  // Number of weights of a node of each layer: the number of inputs of the
+  // layer rounded up to a multiple of NN_Q_INPUT_ALIGN. The extra weights
+  // are 0.
+  int weights_stride[NN_MAX_HIDDEN_LAYERS + 1];
+  // Quantized weight parameters, indexed by layer. Weight i of node j is
+  // weights[layer][j * weights_stride[layer] + i] * weight_scales[layer][j].
+  int8_t *weights[NN_MAX_HIDDEN_LAYERS + 1];
+  float *weight_scales[NN_MAX_HIDDEN_LAYERS + 1];
+  // Factors the inputs of each layer are multiplied by before quantization.
+  float *input_scales[NN_MAX_HIDDEN_LAYERS + 1];
+  // Bias parameters, indexed by layer.
+  const float *bias[NN_MAX_HIDDEN_LAYERS + 1];
+} NN_CONFIG_Q;
+
+// Quantizes nn_config into nn_config_q, which keeps pointers to the bias
+// parameters of nn_config. Returns false on allocation failure, or if a
+// layer has more than NN_MAX_NODES_PER_LAYER inputs.
+bool av1_nn_quantize(const NN_CONFIG *nn_config, NN_CONFIG_Q *nn_config_q);
+
+// Frees the buffers allocated by av1_nn_quantize().
+void av1_nn_free_quantized(NN_CONFIG_Q *nn_config_q);
+
+// Calculates the prediction of a model quantized by av1_nn_quantize(). The
+// output approximates that of av1_nn_predict() for the original model.
+void av1_nn_predict_q(const float *input_nodes,
+                      const NN_CONFIG_Q *const nn_config_q, int reduce_prec,
+                      float *const output);
+
+// Evaluates nn_config with av1_nn_predict_q() if use_quantized is set and
+// nn_config_q, its quantized version, could be set up, or with
+// av1_nn_predict() otherwise.
+static inline void av1_nn_predict_select(const float *input_nodes,
+                                         const NN_CONFIG *const nn_config,
+                                         const NN_CONFIG_Q *const nn_config_q,
+                                         int use_quantized, int reduce_prec,
+                                         float *const output) {
+  if (use_quantized && nn_config_q->weights[0] != NULL) {
+    av1_nn_predict_q(input_nodes, nn_config_q, reduce_prec, output);
+  } else {
+    av1_nn_predict(input_nodes, nn_config, reduce_prec, output);
+  }
+}
+
+// Number of samples av1_nn_predict_batch() propagates through the layers of
+// a model at a time.
+#define NN_BATCH_SIZE 16
+
+// Calculates the predictions of nn_config for num_samples sets of input
+// nodes. The nn_config->num_inputs nodes of sample i are at
+// input_nodes[i * nn_config->num_inputs], and its nn_config->num_outputs
+// outputs are written to output[i * nn_config->num_outputs]. Evaluating many
+// samples at once lets the layers be computed as matrix-matrix products,
+// which make better use of SIMD registers than the matrix-vector products of
+// av1_nn_predict(). The output matches that of av1_nn_predict() for each
+// sample, up to the rounding differences of the SIMD versions.
+void av1_nn_predict_batch(const float *input_nodes, int num_samples,
+                          const NN_CONFIG *const nn_config, int reduce_prec,
+                          float *output);
+
 #if CONFIG_NN_V2
 // Fully-connectedly layer configuration
 struct FC_LAYER {
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <assert.h>
+
+#include "aom_mem/aom_mem.h"
+#include "av1/encoder/motion_field_cache.h"
+
+static void reset_field(MotionField *field) {
+  field->src_display_idx = -1;
+  field->ref_display_idx = -1;
+  field->last_used = 0;
+}
+
+void av1_motion_field_cache_init(MotionFieldCache *cache) {
+  for (int i = 0; i < MOTION_FIELD_CACHE_SIZE; ++i) {
+    reset_field(&cache->fields[i]);
+    cache->fields[i].blocks = NULL;
+  }
+  cache->cols = 0;
+  cache->rows = 0;
+  cache->clock = 0;
+}
+
+void av1_motion_field_cache_free(MotionFieldCache *cache) {
+  for (int i = 0; i < MOTION_FIELD_CACHE_SIZE; ++i) {
+    aom_free(cache->fields[i].blocks);
+  }
+  av1_motion_field_cache_init(cache);
+}
+
+static int get_num_blocks(int length) {
+  return (length + MOTION_FIELD_BLOCK_SIZE - 1) >> MOTION_FIELD_BLOCK_SIZE_LOG2;
+}
+
+static int find_field(const MotionFieldCache *cache, int src, int ref) {
+  for (int i = 0; i < MOTION_FIELD_CACHE_SIZE; ++i) {
+    const MotionField *const field = &cache->fields[i];
+    if (field->src_display_idx == src && field->ref_display_idx == ref) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+MotionField *av1_motion_field_cache_get(MotionFieldCache *cache, int width,
+                                        int height, int src, int ref) {
+  assert(src >= 0 && ref >= 0);
+  const int cols = get_num_blocks(width);
+  const int rows = get_num_blocks(height);
+  if (cols != cache->cols || rows != cache->rows) {
+    av1_motion_field_cache_free(cache);
+    cache->cols = cols;
+    cache->rows = rows;
+  }
+
+  int idx = find_field(cache, src, ref);
+  if (idx < 0) {
+    // Replace the least recently used field. Unused fields have a last_used
+    // of 0 and are taken first.
+    idx = 0;
+    for (int i = 1; i < MOTION_FIELD_CACHE_SIZE; ++i) {
+      if (cache->fields[i].last_used < cache->fields[idx].last_used) idx = i;
+    }
+    MotionField *const field = &cache->fields[idx];
+    const int num_blocks = cols * rows;
+    if (field->blocks == NULL) {
+      field->blocks = aom_malloc(num_blocks * sizeof(*field->blocks));
+      if (field->blocks == NULL) return NULL;
+    }
+    for (int i = 0; i < num_blocks; ++i) {
+      field->blocks[i].mv = kZeroMv;
+      field->blocks[i].err = MOTION_FIELD_INVALID_ERR;
+    }
+    field->src_display_idx = src;
+    field->ref_display_idx = ref;
+  }
+
+  MotionField *const field = &cache->fields[idx];
+  field->last_used = ++cache->clock;
+  return field;
+}
+
+const MotionField *av1_motion_field_cache_find(const MotionFieldCache *cache,
+                                               int width, int height, int src,
+                                               int ref) {
+  if (get_num_blocks(width) != cache->cols ||
+      get_num_blocks(height) != cache->rows) {
+    return NULL;
+  }
+  const int idx = find_field(cache, src, ref);
+  return idx < 0 ? NULL : &cache->fields[idx];
+}
+
+int av1_motion_field_lookup(const MotionFieldCache *cache,
+                            const MotionField *field,
+                            const MotionField *reverse_field, int row, int col,
+                            MV *mv, uint32_t *err) {
+  if (row >= cache->rows || col >= cache->cols) return 0;
+  const int pos = row * cache->cols + col;
+  if (field != NULL && field->blocks[pos].err != MOTION_FIELD_INVALID_ERR) {
+    *mv = field->blocks[pos].mv;
+    *err = field->blocks[pos].err;
+    return 1;
+  }
+  if (reverse_field != NULL &&
+      reverse_field->blocks[pos].err != MOTION_FIELD_INVALID_ERR) {
+    mv->row = -reverse_field->blocks[pos].mv.row;
+    mv->col = -reverse_field->blocks[pos].mv.col;
+    *err = reverse_field->blocks[pos].err;
+    return 1;
+  }
+  return 0;
+}
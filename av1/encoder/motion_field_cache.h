@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#ifndef AOM_AV1_ENCODER_MOTION_FIELD_CACHE_H_
+#define AOM_AV1_ENCODER_MOTION_FIELD_CACHE_H_
+
+#include <stdint.h>
+
+#include "av1/common/mv.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The same pairs of source frames are motion searched several times before a
+// frame is coded: by the temporal filter, and by each run of the TPL model
+// (the GOP length decision runs it up to 3 times before the final one). The
+// motion field cache keeps the motion found for a pair of frames, identified
+// by their display indices, so that a later search of the pair, or of the
+// reverse pair, can start from it with a smaller search range.
+//
+// The fields are stored on a grid of MOTION_FIELD_BLOCK_SIZE luma blocks,
+// which is the block size of the TPL model and of the temporal filter
+// sub-blocks.
+#define MOTION_FIELD_BLOCK_SIZE_LOG2 4
+#define MOTION_FIELD_BLOCK_SIZE (1 << MOTION_FIELD_BLOCK_SIZE_LOG2)
+
+// Number of frame pairs kept. The least recently used pair is replaced when
+// the cache is full.
+#define MOTION_FIELD_CACHE_SIZE 64
+
+// Step parameter of the motion searches starting from the motion of a
+// reliable field block, which only refine it: the first step of the search
+// is 8 full pels.
+#define MOTION_FIELD_REFINE_STEP_PARAM 7
+
+// Returns the largest per pixel error of the blocks the motion of which is
+// reliable enough to only be refined by later searches.
+static inline uint32_t av1_motion_field_reliable_err(int min_frame_size,
+                                                     int bit_depth) {
+  return (uint32_t)((min_frame_size >= 720) ? 12 : 3) << (bit_depth - 8);
+}
+
+// Error of the blocks not searched yet.
+#define MOTION_FIELD_INVALID_ERR UINT32_MAX
+
+typedef struct {
+  // Motion vector in 1/8 pel, from the block of the source frame to the
+  // reference frame.
+  MV mv;
+  // Motion search error of the block, per pixel.
+  uint32_t err;
+} MotionFieldBlock;
+
+typedef struct {
+  // Display indices of the source and the reference frames. src_display_idx
+  // is -1 for an unused field.
+  int src_display_idx;
+  int ref_display_idx;
+  // Value of MotionFieldCache.clock when the field was last requested.
+  uint64_t last_used;
+  MotionFieldBlock *blocks;
+} MotionField;
+
+typedef struct MotionFieldCache {
+  MotionField fields[MOTION_FIELD_CACHE_SIZE];
+  // Dimensions of the fields, in blocks. All the fields are dropped when the
+  // frame dimensions change.
+  int cols;
+  int rows;
+  uint64_t clock;
+} MotionFieldCache;
+
+void av1_motion_field_cache_init(MotionFieldCache *cache);
+void av1_motion_field_cache_free(MotionFieldCache *cache);
+
+// Returns the field of the blocks of the frame with display index src in the
+// frame with display index ref, creating it if the cache does not hold it.
+// The blocks of a new field are invalid. Returns NULL on allocation failure.
+// Must not be called while the fields are accessed by other threads.
+MotionField *av1_motion_field_cache_get(MotionFieldCache *cache, int width,
+                                        int height, int src, int ref);
+
+// Returns the field of src in ref if the cache holds it, or NULL.
+const MotionField *av1_motion_field_cache_find(const MotionFieldCache *cache,
+                                               int width, int height, int src,
+                                               int ref);
+
+// Stores the motion of the block at (row, col) in units of
+// MOTION_FIELD_BLOCK_SIZE. Blocks outside the field are ignored.
+static inline void av1_motion_field_store(const MotionFieldCache *cache,
+                                          MotionField *field, int row, int col,
+                                          MV mv, uint32_t err) {
+  if (field == NULL || row >= cache->rows || col >= cache->cols) return;
+  MotionFieldBlock *const block = &field->blocks[row * cache->cols + col];
+  block->mv = mv;
+  block->err = err;
+}
+
+// Looks up the motion of the block at (row, col) of the source frame of
+// 'field' in its reference frame. If the block is not valid in 'field', the
+// motion is derived from the co-located block of 'reverse_field', the field
+// of the reference frame in the source frame, by negating its vector. Either
+// field may be NULL. Returns 0 if neither field holds the block.
+int av1_motion_field_lookup(const MotionFieldCache *cache,
+                            const MotionField *field,
+                            const MotionField *reverse_field, int row, int col,
+                            MV *mv, uint32_t *err);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AOM_AV1_ENCODER_MOTION_FIELD_CACHE_H_
@@ -15,6 +15,8 @@
 #include "av1/encoder/thirdpass.h"
 #include "config/aom_dsp_rtcd.h"
 
+#include "aom_ports/aom_once.h"
+
 #include "av1/common/enums.h"
 #include "av1/common/reconinter.h"
 
@@ -78,6 +80,34 @@ static bool ext_ml_model_decision_after_part_ab(
     int *const partition_vert4_allowed, unsigned int pb_source_variance,
     int mi_row, int mi_col);
 
+// Fixed-point versions of the models of av1_ml_prune_rect_partition() and
+// av1_ml_prune_4_partition(), indexed like their block sizes. The models of
+// av1_ml_predict_breakout() are kept in floating point: their features are
+// not normalized, and the int8 weights cannot represent the large terms that
+// cancel each other out in their hidden nodes accurately enough.
+static NN_CONFIG_Q rect_partition_nnconfig_q[5];
+static NN_CONFIG_Q four_partition_nnconfig_q[3];
+
+static void init_partition_nn_models(void) {
+  const NN_CONFIG *const rect_nnconfigs[5] = {
+    &av1_rect_partition_nnconfig_8, &av1_rect_partition_nnconfig_16,
+    &av1_rect_partition_nnconfig_32, &av1_rect_partition_nnconfig_64,
+    &av1_rect_partition_nnconfig_128
+  };
+  const NN_CONFIG *const four_nnconfigs[3] = { &av1_4_partition_nnconfig_16,
+                                               &av1_4_partition_nnconfig_32,
+                                               &av1_4_partition_nnconfig_64 };
+  // A model which fails to be quantized is evaluated in floating point.
+  for (int i = 0; i < 5; ++i) {
+    av1_nn_quantize(rect_nnconfigs[i], &rect_partition_nnconfig_q[i]);
+  }
+  for (int i = 0; i < 3; ++i) {
+    av1_nn_quantize(four_nnconfigs[i], &four_partition_nnconfig_q[i]);
+  }
+}
+
+void av1_init_partition_nn_models(void) { aom_once(init_partition_nn_models); }
+
 static inline int convert_bsize_to_idx(BLOCK_SIZE bsize) {
   switch (bsize) {
     case BLOCK_128X128: return 0;
@@ -129,6 +159,110 @@ static void write_features_to_file(const char *const path,
   fclose(pfile);
 }
 
+// Sets the features of the DNN of intra_mode_cnn_partition() for the block of
+// the partition block quad tree at quad_tree_idx, of size bsize.
+static void get_intra_cnn_dnn_features(const PartitionSearchInfo *part_info,
+                                       BLOCK_SIZE bsize, int quad_tree_idx,
+                                       float *dnn_features) {
+  const float *branch_0 = part_info->cnn_buffer;
+  const float *branch_1 = branch_0 + CNN_BRANCH_0_OUT_SIZE;
+  const float *branch_2 = branch_1 + CNN_BRANCH_1_OUT_SIZE;
+  const float *branch_3 = branch_2 + CNN_BRANCH_2_OUT_SIZE;
+
+  if (bsize == BLOCK_64X64) {
+    int f_idx = 0;
+    for (int ch_idx = 0; ch_idx < CNN_BRANCH_0_OUT_CH; ch_idx++) {
+      dnn_features[f_idx++] = branch_0[ch_idx];
+    }
+
+    const int spa_stride = 2 * 2;
+    for (int lin_idx = 0; lin_idx < spa_stride; lin_idx++) {
+      for (int ch_idx = 0; ch_idx < CNN_BRANCH_1_OUT_CH; ch_idx++) {
+        dnn_features[f_idx++] = branch_1[lin_idx + ch_idx * spa_stride];
+      }
+    }
+    dnn_features[f_idx++] = part_info->log_q;
+  } else if (bsize == BLOCK_32X32) {
+    int f_idx = 0;
+    for (int idx = 0; idx < CNN_BRANCH_0_OUT_CH; idx++) {
+      dnn_features[f_idx++] = branch_0[idx];
+    }
+
+    const int curr_lin_idx = quad_to_linear_1[quad_tree_idx - 1];
+    const int spa_stride = 2 * 2;
+    for (int ch_idx = 0; ch_idx < CNN_BRANCH_1_OUT_CH; ch_idx++) {
+      dnn_features[f_idx++] = branch_1[curr_lin_idx + ch_idx * spa_stride];
+    }
+    dnn_features[f_idx++] = part_info->log_q;
+  } else if (bsize == BLOCK_16X16) {
+    int f_idx = 0;
+    const int prev_quad_idx = (quad_tree_idx - 1) / 4;
+    const int prev_lin_idx = quad_to_linear_1[prev_quad_idx - 1];
+    const int prev_spa_stride = 2 * 2;
+    for (int ch_idx = 0; ch_idx < CNN_BRANCH_1_OUT_CH; ch_idx++) {
+      dnn_features[f_idx++] = branch_1[prev_lin_idx + ch_idx * prev_spa_stride];
+    }
+
+    const int curr_lin_idx = quad_to_linear_2[quad_tree_idx - 5];
+    const int spa_stride = 4 * 4;
+    for (int ch_idx = 0; ch_idx < CNN_BRANCH_2_OUT_CH; ch_idx++) {
+      dnn_features[f_idx++] = branch_2[curr_lin_idx + ch_idx * spa_stride];
+    }
+    dnn_features[f_idx++] = part_info->log_q;
+  } else if (bsize == BLOCK_8X8) {
+    int f_idx = 0;
+    const int prev_quad_idx = (quad_tree_idx - 1) / 4;
+    const int prev_lin_idx = quad_to_linear_2[prev_quad_idx - 5];
+    const int prev_spa_stride = 4 * 4;
+    for (int ch_idx = 0; ch_idx < CNN_BRANCH_2_OUT_CH; ch_idx++) {
+      dnn_features[f_idx++] = branch_2[prev_lin_idx + ch_idx * prev_spa_stride];
+    }
+
+    const int curr_lin_idx = quad_to_linear_3[quad_tree_idx - 21];
+    const int spa_stride = 8 * 8;
+    for (int ch_idx = 0; ch_idx < CNN_BRANCH_3_OUT_CH; ch_idx++) {
+      dnn_features[f_idx++] = branch_3[curr_lin_idx + ch_idx * spa_stride];
+    }
+    dnn_features[f_idx++] = part_info->log_q;
+  } else {
+    assert(0 && "Invalid bsize in intra_cnn partition");
+  }
+}
+
+// Evaluates the DNN of intra_mode_cnn_partition() for all the blocks at depth
+// 'depth' of the partition block quad tree, i.e. of size 64x64 >> depth, and
+// stores their outputs in part_info->cnn_logits.
+static void compute_intra_cnn_logits(PartitionSearchInfo *part_info,
+                                     int depth) {
+  static const BLOCK_SIZE kBlockSizes[4] = { BLOCK_64X64, BLOCK_32X32,
+                                             BLOCK_16X16, BLOCK_8X8 };
+  static const NN_CONFIG *const kDnnConfigs[4] = {
+    &av1_intra_mode_cnn_partition_branch_0_dnn_config,
+    &av1_intra_mode_cnn_partition_branch_1_dnn_config,
+    &av1_intra_mode_cnn_partition_branch_2_dnn_config,
+    &av1_intra_mode_cnn_partition_branch_3_dnn_config,
+  };
+  const NN_CONFIG *const dnn_config = kDnnConfigs[depth];
+  assert(dnn_config->num_outputs == 1);
+  // The blocks at depth d are at indices (4^d - 1) / 3 to (4^(d + 1) - 4) / 3
+  // of the quad tree.
+  const int num_blocks = 1 << (2 * depth);
+  const int first_idx = (num_blocks - 1) / 3;
+  const int num_features = dnn_config->num_inputs;
+  float dnn_features[NN_BATCH_SIZE * 100];
+  assert(num_features <= 100);
+  for (int start = 0; start < num_blocks; start += NN_BATCH_SIZE) {
+    const int batch_size = AOMMIN(NN_BATCH_SIZE, num_blocks - start);
+    for (int i = 0; i < batch_size; ++i) {
+      get_intra_cnn_dnn_features(part_info, kBlockSizes[depth],
+                                 first_idx + start + i,
+                                 &dnn_features[i * num_features]);
+    }
+    av1_nn_predict_batch(dnn_features, batch_size, dnn_config, 1,
+                         &part_info->cnn_logits[first_idx + start]);
+  }
+}
+
 // TODO(chiyotsai@google.com): This is very much a work in progress. We still
 // need to the following:
 //   -- add support for hdres
@@ -220,91 +354,21 @@ static void intra_mode_cnn_partition(const AV1_COMMON *const cm, MACROBLOCK *x,
     }
 
     part_info->cnn_output_valid = 1;
+    part_info->cnn_logits_valid = 0;
   }
 
   if (!part_info->cnn_output_valid) {
     return;
   }
 
-  const NN_CONFIG *dnn_configs[5] = {
-    NULL,
-    &av1_intra_mode_cnn_partition_branch_0_dnn_config,
-    &av1_intra_mode_cnn_partition_branch_1_dnn_config,
-    &av1_intra_mode_cnn_partition_branch_2_dnn_config,
-    &av1_intra_mode_cnn_partition_branch_3_dnn_config,
-  };
-
-  const NN_CONFIG *dnn_config = dnn_configs[bsize_idx];
-
-  float dnn_features[100];
-  float logits[4] = { 0.0f };
-
-  const float *branch_0 = part_info->cnn_buffer;
-  const float *branch_1 = branch_0 + CNN_BRANCH_0_OUT_SIZE;
-  const float *branch_2 = branch_1 + CNN_BRANCH_1_OUT_SIZE;
-  const float *branch_3 = branch_2 + CNN_BRANCH_2_OUT_SIZE;
-
-  if (bsize == BLOCK_64X64) {
-    int f_idx = 0;
-    for (int ch_idx = 0; ch_idx < CNN_BRANCH_0_OUT_CH; ch_idx++) {
-      dnn_features[f_idx++] = branch_0[ch_idx];
-    }
-
-    const int spa_stride = 2 * 2;
-    for (int lin_idx = 0; lin_idx < spa_stride; lin_idx++) {
-      for (int ch_idx = 0; ch_idx < CNN_BRANCH_1_OUT_CH; ch_idx++) {
-        dnn_features[f_idx++] = branch_1[lin_idx + ch_idx * spa_stride];
-      }
-    }
-    dnn_features[f_idx++] = part_info->log_q;
-  } else if (bsize == BLOCK_32X32) {
-    int f_idx = 0;
-    for (int idx = 0; idx < CNN_BRANCH_0_OUT_CH; idx++) {
-      dnn_features[f_idx++] = branch_0[idx];
-    }
-
-    const int curr_lin_idx = quad_to_linear_1[quad_tree_idx - 1];
-    const int spa_stride = 2 * 2;
-    for (int ch_idx = 0; ch_idx < CNN_BRANCH_1_OUT_CH; ch_idx++) {
-      dnn_features[f_idx++] = branch_1[curr_lin_idx + ch_idx * spa_stride];
-    }
-    dnn_features[f_idx++] = part_info->log_q;
-  } else if (bsize == BLOCK_16X16) {
-    int f_idx = 0;
-    const int prev_quad_idx = (quad_tree_idx - 1) / 4;
-    const int prev_lin_idx = quad_to_linear_1[prev_quad_idx - 1];
-    const int prev_spa_stride = 2 * 2;
-    for (int ch_idx = 0; ch_idx < CNN_BRANCH_1_OUT_CH; ch_idx++) {
-      dnn_features[f_idx++] = branch_1[prev_lin_idx + ch_idx * prev_spa_stride];
-    }
-
-    const int curr_lin_idx = quad_to_linear_2[quad_tree_idx - 5];
-    const int spa_stride = 4 * 4;
-    for (int ch_idx = 0; ch_idx < CNN_BRANCH_2_OUT_CH; ch_idx++) {
-      dnn_features[f_idx++] = branch_2[curr_lin_idx + ch_idx * spa_stride];
-    }
-    dnn_features[f_idx++] = part_info->log_q;
-  } else if (bsize == BLOCK_8X8) {
-    int f_idx = 0;
-    const int prev_quad_idx = (quad_tree_idx - 1) / 4;
-    const int prev_lin_idx = quad_to_linear_2[prev_quad_idx - 5];
-    const int prev_spa_stride = 4 * 4;
-    for (int ch_idx = 0; ch_idx < CNN_BRANCH_2_OUT_CH; ch_idx++) {
-      dnn_features[f_idx++] = branch_2[prev_lin_idx + ch_idx * prev_spa_stride];
-    }
-
-    const int curr_lin_idx = quad_to_linear_3[quad_tree_idx - 21];
-    const int spa_stride = 8 * 8;
-    for (int ch_idx = 0; ch_idx < CNN_BRANCH_3_OUT_CH; ch_idx++) {
-      dnn_features[f_idx++] = branch_3[curr_lin_idx + ch_idx * spa_stride];
-    }
-    dnn_features[f_idx++] = part_info->log_q;
-  } else {
-    assert(0 && "Invalid bsize in intra_cnn partition");
+  // The DNN is evaluated for all the blocks of the same size in the
+  // superblock at once, the first time one of them is searched.
+  const int depth = bsize_idx - 1;
+  if (!(part_info->cnn_logits_valid & (1 << depth))) {
+    compute_intra_cnn_logits(part_info, depth);
+    part_info->cnn_logits_valid |= 1 << depth;
   }
-
-  // Make decision
-  av1_nn_predict(dnn_features, dnn_config, 1, logits);
+  const float *const logits = &part_info->cnn_logits[quad_tree_idx];
 
   const int is_720p_or_larger = AOMMIN(cm->width, cm->height) >= 720;
   const int is_480p_or_larger = AOMMIN(cm->width, cm->height) >= 480;
@@ -1124,27 +1188,33 @@ void av1_ml_prune_rect_partition(AV1_COMP *const cpi, const MACROBLOCK *const x,
   if (bsize < BLOCK_8X8 || best_rd >= 1000000000) return;
   best_rd = AOMMAX(best_rd, 1);
   const NN_CONFIG *nn_config = NULL;
+  const NN_CONFIG_Q *nn_config_q = NULL;
   const float prob_thresholds[5] = { 0.01f, 0.01f, 0.004f, 0.002f, 0.002f };
   float cur_thresh = 0.0f;
   switch (bsize) {
     case BLOCK_8X8:
       nn_config = &av1_rect_partition_nnconfig_8;
+      nn_config_q = &rect_partition_nnconfig_q[0];
       cur_thresh = prob_thresholds[0];
       break;
     case BLOCK_16X16:
       nn_config = &av1_rect_partition_nnconfig_16;
+      nn_config_q = &rect_partition_nnconfig_q[1];
       cur_thresh = prob_thresholds[1];
       break;
     case BLOCK_32X32:
       nn_config = &av1_rect_partition_nnconfig_32;
+      nn_config_q = &rect_partition_nnconfig_q[2];
       cur_thresh = prob_thresholds[2];
       break;
     case BLOCK_64X64:
       nn_config = &av1_rect_partition_nnconfig_64;
+      nn_config_q = &rect_partition_nnconfig_q[3];
       cur_thresh = prob_thresholds[3];
       break;
     case BLOCK_128X128:
       nn_config = &av1_rect_partition_nnconfig_128;
+      nn_config_q = &rect_partition_nnconfig_q[4];
       cur_thresh = prob_thresholds[4];
       break;
     default: assert(0 && "Unexpected bsize.");
@@ -1200,7 +1270,8 @@ void av1_ml_prune_rect_partition(AV1_COMP *const cpi, const MACROBLOCK *const x,
 
   // 2. Do the prediction and prune 0-2 partitions based on their probabilities
   float raw_scores[3] = { 0.0f };
-  av1_nn_predict(features, nn_config, 1, raw_scores);
+  av1_nn_predict_select(features, nn_config, nn_config_q,
+                        cpi->sf.hl_sf.use_quantized_nn, 1, raw_scores);
   float probs[3] = { 0.0f };
   av1_nn_softmax(raw_scores, probs, 3);
 
@@ -1336,11 +1407,21 @@ void av1_ml_prune_4_partition(AV1_COMP *const cpi, MACROBLOCK *const x,
   int64_t *horz_rd = rect_part_rd[HORZ4];
   int64_t *vert_rd = rect_part_rd[VERT4];
   const NN_CONFIG *nn_config = NULL;
+  const NN_CONFIG_Q *nn_config_q = NULL;
   // 4-way partitions are only allowed for these three square block sizes.
   switch (bsize) {
-    case BLOCK_16X16: nn_config = &av1_4_partition_nnconfig_16; break;
-    case BLOCK_32X32: nn_config = &av1_4_partition_nnconfig_32; break;
-    case BLOCK_64X64: nn_config = &av1_4_partition_nnconfig_64; break;
+    case BLOCK_16X16:
+      nn_config = &av1_4_partition_nnconfig_16;
+      nn_config_q = &four_partition_nnconfig_q[0];
+      break;
+    case BLOCK_32X32:
+      nn_config = &av1_4_partition_nnconfig_32;
+      nn_config_q = &four_partition_nnconfig_q[1];
+      break;
+    case BLOCK_64X64:
+      nn_config = &av1_4_partition_nnconfig_64;
+      nn_config_q = &four_partition_nnconfig_q[2];
+      break;
     default: assert(0 && "Unexpected bsize.");
   }
   if (!nn_config) return;
@@ -1436,7 +1517,8 @@ void av1_ml_prune_4_partition(AV1_COMP *const cpi, MACROBLOCK *const x,
 
   // Calculate scores using the NN model.
   float score[LABELS] = { 0.0f };
-  av1_nn_predict(features, nn_config, 1, score);
+  av1_nn_predict_select(features, nn_config, nn_config_q,
+                        cpi->sf.hl_sf.use_quantized_nn, 1, score);
   int int_score[LABELS];
   int max_score = -1000;
   for (int i = 0; i < LABELS; ++i) {
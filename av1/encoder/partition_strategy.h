@@ -68,6 +68,11 @@ void av1_ml_prune_4_partition(AV1_COMP *const cpi, MACROBLOCK *const x,
                               int *part4_allowed,
                               unsigned int pb_source_variance);
 
+// Quantizes the models of av1_ml_prune_rect_partition(),
+// av1_ml_prune_4_partition() and av1_ml_predict_breakout() for
+// sf->hl_sf.use_quantized_nn. Only the first call has an effect.
+void av1_init_partition_nn_models(void);
+
 // ML-based partition search breakout after PARTITION_NONE.
 void av1_ml_predict_breakout(AV1_COMP *const cpi, const MACROBLOCK *const x,
                              const RD_STATS *const rd_stats,
@@ -81,36 +81,111 @@ static inline void get_cdef_filter_strengths(CDEF_PICK_METHOD pick_method,
     cdef_strength = pri_strength * CDEF_SEC_STRENGTHS + sec_strength;        \
   } while (0)
 
-/* Search for the best strength to add as an option, knowing we
-   already selected nb_strengths options. */
-static uint64_t search_one(int *lev, int nb_strengths,
-                           uint64_t mse[][TOTAL_STRENGTHS], int sb_count,
-                           CDEF_PICK_METHOD pick_method) {
-  uint64_t tot_mse[TOTAL_STRENGTHS];
-  const int total_strengths = nb_cdef_strengths[pick_method];
-  int i, j;
-  uint64_t best_tot_mse = (uint64_t)1 << 63;
-  int best_id = 0;
-  memset(tot_mse, 0, sizeof(tot_mse));
-  for (i = 0; i < sb_count; i++) {
-    int gi;
-    uint64_t best_mse = (uint64_t)1 << 63;
-    /* Find best mse among already selected options. */
-    for (gi = 0; gi < nb_strengths; gi++) {
-      if (mse[i][lev[gi]] < best_mse) {
-        best_mse = mse[i][lev[gi]];
+void av1_cdef_add_best_mse_c(uint64_t *tot_mse, const uint64_t *mse,
+                             uint64_t offset, uint64_t best_mse, int n) {
+  for (int k = 0; k < n; k++) {
+    const uint64_t curr = offset + mse[k];
+    tot_mse[k] += AOMMIN(curr, best_mse);
+  }
+}
+
+// Accumulates in tot_mse the MSE of the blocks [start, end) when each
+// candidate strength (pair) is added to the selected ones.
+static void accumulate_strength_mse(const CdefSearchCtx *cdef_search_ctx,
+                                    int start, int end,
+                                    uint64_t tot_mse[][TOTAL_STRENGTHS]) {
+  const int total_strengths = cdef_search_ctx->total_strengths;
+  const int nb_strengths = cdef_search_ctx->search_nb_strengths;
+  const int *lev0 = cdef_search_ctx->search_lev[0];
+  uint64_t(*mse0)[TOTAL_STRENGTHS] = cdef_search_ctx->mse[0];
+  if (cdef_search_ctx->num_planes > 1) {
+    const int *lev1 = cdef_search_ctx->search_lev[1];
+    uint64_t(*mse1)[TOTAL_STRENGTHS] = cdef_search_ctx->mse[1];
+    for (int i = start; i < end; i++) {
+      uint64_t best_mse = (uint64_t)1 << 63;
+      /* Find best mse among already selected options. */
+      for (int gi = 0; gi < nb_strengths; gi++) {
+        const uint64_t curr = mse0[i][lev0[gi]] + mse1[i][lev1[gi]];
+        if (curr < best_mse) best_mse = curr;
+      }
+      /* Find best mse when adding each possible new option. */
+      for (int j = 0; j < total_strengths; j++) {
+        av1_cdef_add_best_mse(tot_mse[j], mse1[i], mse0[i][j], best_mse,
+                              total_strengths);
+      }
+    }
+  } else {
+    for (int i = start; i < end; i++) {
+      uint64_t best_mse = (uint64_t)1 << 63;
+      /* Find best mse among already selected options. */
+      for (int gi = 0; gi < nb_strengths; gi++) {
+        if (mse0[i][lev0[gi]] < best_mse) best_mse = mse0[i][lev0[gi]];
       }
+      /* Find best mse when adding each possible new option. */
+      av1_cdef_add_best_mse(tot_mse[0], mse0[i], 0, best_mse, total_strengths);
     }
-    /* Find best mse when adding each possible new option. */
-    for (j = 0; j < total_strengths; j++) {
-      uint64_t best = best_mse;
-      if (mse[i][j] < best) best = mse[i][j];
-      tot_mse[j] += best;
+  }
+}
+
+void av1_cdef_strength_search_band(CdefSearchCtx *cdef_search_ctx, int band,
+                                   int thread_id) {
+  const int start = band * CDEF_STRENGTH_SEARCH_BAND_SIZE;
+  const int end =
+      AOMMIN(start + CDEF_STRENGTH_SEARCH_BAND_SIZE, cdef_search_ctx->sb_count);
+  accumulate_strength_mse(cdef_search_ctx, start, end,
+                          cdef_search_ctx->search_tot_mse[thread_id]);
+}
+
+// Computes the total MSE of the frame when each candidate strength (pair) is
+// added to the nb_strengths selected ones. With several workers, each one
+// accumulates bands of blocks in its own buffer and the buffers are summed,
+// which gives the same result as the single-threaded accumulation.
+static void compute_strength_mse(AV1_COMP *cpi, const int *lev0,
+                                 const int *lev1, int nb_strengths,
+                                 uint64_t tot_mse[][TOTAL_STRENGTHS]) {
+  CdefSearchCtx *cdef_search_ctx = cpi->cdef_search_ctx;
+  const int total_strengths = cdef_search_ctx->total_strengths;
+  const int num_rows = cdef_search_ctx->num_planes > 1 ? total_strengths : 1;
+  const int num_workers = cdef_search_ctx->search_num_workers;
+  const size_t row_size = total_strengths * sizeof(tot_mse[0][0]);
+  cdef_search_ctx->search_lev[0] = lev0;
+  cdef_search_ctx->search_lev[1] = lev1;
+  cdef_search_ctx->search_nb_strengths = nb_strengths;
+  for (int j = 0; j < num_rows; j++) memset(tot_mse[j], 0, row_size);
+  if (num_workers <= 1) {
+    accumulate_strength_mse(cdef_search_ctx, 0, cdef_search_ctx->sb_count,
+                            tot_mse);
+    return;
+  }
+
+  for (int w = 0; w < num_workers; w++) {
+    for (int j = 0; j < num_rows; j++)
+      memset(cdef_search_ctx->search_tot_mse[w][j], 0, row_size);
+  }
+  const int num_bands =
+      (cdef_search_ctx->sb_count + CDEF_STRENGTH_SEARCH_BAND_SIZE - 1) /
+      CDEF_STRENGTH_SEARCH_BAND_SIZE;
+  av1_cdef_strength_search_mt(cpi, num_bands, num_workers);
+  for (int w = 0; w < num_workers; w++) {
+    for (int j = 0; j < num_rows; j++) {
+      for (int k = 0; k < total_strengths; k++)
+        tot_mse[j][k] += cdef_search_ctx->search_tot_mse[w][j][k];
     }
   }
+}
+
+/* Search for the best strength to add as an option, knowing we
+   already selected nb_strengths options. */
+static uint64_t search_one(AV1_COMP *cpi, int *lev, int nb_strengths) {
+  uint64_t tot_mse[1][TOTAL_STRENGTHS];
+  const int total_strengths = cpi->cdef_search_ctx->total_strengths;
+  int j;
+  uint64_t best_tot_mse = (uint64_t)1 << 63;
+  int best_id = 0;
+  compute_strength_mse(cpi, lev, NULL, nb_strengths, tot_mse);
   for (j = 0; j < total_strengths; j++) {
-    if (tot_mse[j] < best_tot_mse) {
-      best_tot_mse = tot_mse[j];
+    if (tot_mse[0][j] < best_tot_mse) {
+      best_tot_mse = tot_mse[0][j];
       best_id = j;
     }
   }
@@ -120,39 +195,15 @@ static uint64_t search_one(int *lev, int nb_strengths,
 
 /* Search for the best luma+chroma strength to add as an option, knowing we
    already selected nb_strengths options. */
-static uint64_t search_one_dual(int *lev0, int *lev1, int nb_strengths,
-                                uint64_t (**mse)[TOTAL_STRENGTHS], int sb_count,
-                                CDEF_PICK_METHOD pick_method) {
+static uint64_t search_one_dual(AV1_COMP *cpi, int *lev0, int *lev1,
+                                int nb_strengths) {
   uint64_t tot_mse[TOTAL_STRENGTHS][TOTAL_STRENGTHS];
-  int i, j;
+  int j;
   uint64_t best_tot_mse = (uint64_t)1 << 63;
   int best_id0 = 0;
   int best_id1 = 0;
-  const int total_strengths = nb_cdef_strengths[pick_method];
-  memset(tot_mse, 0, sizeof(tot_mse));
-  for (i = 0; i < sb_count; i++) {
-    int gi;
-    uint64_t best_mse = (uint64_t)1 << 63;
-    /* Find best mse among already selected options. */
-    for (gi = 0; gi < nb_strengths; gi++) {
-      uint64_t curr = mse[0][i][lev0[gi]];
-      curr += mse[1][i][lev1[gi]];
-      if (curr < best_mse) {
-        best_mse = curr;
-      }
-    }
-    /* Find best mse when adding each possible new option. */
-    for (j = 0; j < total_strengths; j++) {
-      int k;
-      for (k = 0; k < total_strengths; k++) {
-        uint64_t best = best_mse;
-        uint64_t curr = mse[0][i][j];
-        curr += mse[1][i][k];
-        if (curr < best) best = curr;
-        tot_mse[j][k] += best;
-      }
-    }
-  }
+  const int total_strengths = cpi->cdef_search_ctx->total_strengths;
+  compute_strength_mse(cpi, lev0, lev1, nb_strengths, tot_mse);
   for (j = 0; j < total_strengths; j++) {
     int k;
     for (k = 0; k < total_strengths; k++) {
@@ -168,57 +219,57 @@ static uint64_t search_one_dual(int *lev0, int *lev1, int nb_strengths,
   return best_tot_mse;
 }
 
-/* Search for the set of strengths that minimizes mse. */
-static uint64_t joint_strength_search(int *best_lev, int nb_strengths,
-                                      uint64_t mse[][TOTAL_STRENGTHS],
-                                      int sb_count,
-                                      CDEF_PICK_METHOD pick_method) {
+/* Search for the set of strengths that minimizes mse. The first start entries
+   of best_lev are taken as already selected. */
+static uint64_t joint_strength_search(AV1_COMP *cpi, int *best_lev,
+                                      int nb_strengths, int start,
+                                      int refine_iters) {
   uint64_t best_tot_mse;
+  const CDEF_PICK_METHOD pick_method = cpi->cdef_search_ctx->pick_method;
   int fast = (pick_method >= CDEF_FAST_SEARCH_LVL1 &&
               pick_method <= CDEF_FAST_SEARCH_LVL5);
   int i;
+  assert(start < nb_strengths);
   best_tot_mse = (uint64_t)1 << 63;
   /* Greedy search: add one strength options at a time. */
-  for (i = 0; i < nb_strengths; i++) {
-    best_tot_mse = search_one(best_lev, i, mse, sb_count, pick_method);
+  for (i = start; i < nb_strengths; i++) {
+    best_tot_mse = search_one(cpi, best_lev, i);
   }
   /* Trying to refine the greedy search by reconsidering each
      already-selected option. */
   if (!fast) {
-    for (i = 0; i < 4 * nb_strengths; i++) {
+    for (i = 0; i < refine_iters; i++) {
       int j;
       for (j = 0; j < nb_strengths - 1; j++) best_lev[j] = best_lev[j + 1];
-      best_tot_mse =
-          search_one(best_lev, nb_strengths - 1, mse, sb_count, pick_method);
+      best_tot_mse = search_one(cpi, best_lev, nb_strengths - 1);
     }
   }
   return best_tot_mse;
 }
 
-/* Search for the set of luma+chroma strengths that minimizes mse. */
-static uint64_t joint_strength_search_dual(int *best_lev0, int *best_lev1,
-                                           int nb_strengths,
-                                           uint64_t (**mse)[TOTAL_STRENGTHS],
-                                           int sb_count,
-                                           CDEF_PICK_METHOD pick_method) {
+/* Search for the set of luma+chroma strengths that minimizes mse. The first
+   start entries of best_lev0 and best_lev1 are taken as already selected. */
+static uint64_t joint_strength_search_dual(AV1_COMP *cpi, int *best_lev0,
+                                           int *best_lev1, int nb_strengths,
+                                           int start, int refine_iters) {
   uint64_t best_tot_mse;
   int i;
+  assert(start < nb_strengths);
   best_tot_mse = (uint64_t)1 << 63;
   /* Greedy search: add one strength options at a time. */
-  for (i = 0; i < nb_strengths; i++) {
-    best_tot_mse =
-        search_one_dual(best_lev0, best_lev1, i, mse, sb_count, pick_method);
+  for (i = start; i < nb_strengths; i++) {
+    best_tot_mse = search_one_dual(cpi, best_lev0, best_lev1, i);
   }
   /* Trying to refine the greedy search by reconsidering each
      already-selected option. */
-  for (i = 0; i < 4 * nb_strengths; i++) {
+  for (i = 0; i < refine_iters; i++) {
     int j;
     for (j = 0; j < nb_strengths - 1; j++) {
       best_lev0[j] = best_lev0[j + 1];
       best_lev1[j] = best_lev1[j + 1];
     }
-    best_tot_mse = search_one_dual(best_lev0, best_lev1, nb_strengths - 1, mse,
-                                   sb_count, pick_method);
+    best_tot_mse =
+        search_one_dual(cpi, best_lev0, best_lev1, nb_strengths - 1);
   }
   return best_tot_mse;
 }
@@ -637,22 +688,31 @@ static void cdef_mse_calc_frame(CdefSearchCtx *cdef_search_ctx,
 // Inputs:
 //   cdef_search_ctx: Pointer to the structure containing parameters
 //   related to CDEF search context.
+//   arena: Arena the buffers are allocated from.
 // Returns:
 //   Nothing will be returned. Contents of cdef_search_ctx will be modified.
-static void cdef_alloc_data(AV1_COMMON *cm, CdefSearchCtx *cdef_search_ctx) {
+static void cdef_alloc_data(AV1_COMMON *cm, CdefSearchCtx *cdef_search_ctx,
+                            AVxArena *arena) {
   const int nvfb = cdef_search_ctx->nvfb;
   const int nhfb = cdef_search_ctx->nhfb;
   CHECK_MEM_ERROR(
       cm, cdef_search_ctx->sb_index,
-      aom_malloc(nvfb * nhfb * sizeof(cdef_search_ctx->sb_index[0])));
+      aom_arena_malloc(arena,
+                       nvfb * nhfb * sizeof(cdef_search_ctx->sb_index[0])));
   cdef_search_ctx->sb_count = 0;
-  CHECK_MEM_ERROR(cm, cdef_search_ctx->mse[0],
-                  aom_malloc(sizeof(**cdef_search_ctx->mse) * nvfb * nhfb));
-  CHECK_MEM_ERROR(cm, cdef_search_ctx->mse[1],
-                  aom_malloc(sizeof(**cdef_search_ctx->mse) * nvfb * nhfb));
+  CHECK_MEM_ERROR(
+      cm, cdef_search_ctx->mse[0],
+      aom_arena_malloc(arena, sizeof(**cdef_search_ctx->mse) * nvfb * nhfb));
+  CHECK_MEM_ERROR(
+      cm, cdef_search_ctx->mse[1],
+      aom_arena_malloc(arena, sizeof(**cdef_search_ctx->mse) * nvfb * nhfb));
+  CHECK_MEM_ERROR(
+      cm, cdef_search_ctx->tasks,
+      aom_arena_malloc(arena, sizeof(*cdef_search_ctx->tasks) * nvfb * nhfb));
 }
 
-// Deallocates the memory allocated for members of CdefSearchCtx.
+// Releases the buffers of CdefSearchCtx. The memory is owned by the arena it
+// was allocated from; this only clears the pointers.
 // Inputs:
 //   cdef_search_ctx: Pointer to the structure containing parameters
 //   related to CDEF search context.
@@ -660,12 +720,13 @@ static void cdef_alloc_data(AV1_COMMON *cm, CdefSearchCtx *cdef_search_ctx) {
 //   Nothing will be returned.
 void av1_cdef_dealloc_data(CdefSearchCtx *cdef_search_ctx) {
   if (cdef_search_ctx) {
-    aom_free(cdef_search_ctx->mse[0]);
     cdef_search_ctx->mse[0] = NULL;
-    aom_free(cdef_search_ctx->mse[1]);
     cdef_search_ctx->mse[1] = NULL;
-    aom_free(cdef_search_ctx->sb_index);
     cdef_search_ctx->sb_index = NULL;
+    cdef_search_ctx->tasks = NULL;
+    cdef_search_ctx->search_tot_mse = NULL;
+    cdef_search_ctx->search_lev[0] = NULL;
+    cdef_search_ctx->search_lev[1] = NULL;
   }
 }
 
@@ -861,14 +922,15 @@ void av1_cdef_search(AV1_COMP *cpi) {
 
   if (!cpi->cdef_search_ctx)
     CHECK_MEM_ERROR(cm, cpi->cdef_search_ctx,
-                    aom_malloc(sizeof(*cpi->cdef_search_ctx)));
+                    aom_calloc(1, sizeof(*cpi->cdef_search_ctx)));
   CdefSearchCtx *cdef_search_ctx = cpi->cdef_search_ctx;
 
   // Initialize parameters related to CDEF search context.
   cdef_params_init(&cm->cur_frame->buf, cpi->source, cm, xd, cdef_search_ctx,
                    pick_method);
   // Allocate CDEF search context buffers.
-  cdef_alloc_data(cm, cdef_search_ctx);
+  const AVxArenaMark arena_mark = aom_arena_mark(&cpi->frame_arena);
+  cdef_alloc_data(cm, cdef_search_ctx, &cpi->frame_arena);
   // Frame level mse calculation.
   if (cpi->mt_info.num_workers > 1) {
     av1_cdef_mse_calc_frame_mt(cpi);
@@ -881,6 +943,26 @@ void av1_cdef_search(AV1_COMP *cpi) {
   uint64_t best_rd = UINT64_MAX;
   CdefInfo *const cdef_info = &cm->cdef_info;
   int sb_count = cdef_search_ctx->sb_count;
+  const int num_bands = (sb_count + CDEF_STRENGTH_SEARCH_BAND_SIZE - 1) /
+                        CDEF_STRENGTH_SEARCH_BAND_SIZE;
+  cdef_search_ctx->search_num_workers =
+      cpi->mt_info.num_workers > 1
+          ? AOMMIN(cpi->mt_info.num_mod_workers[MOD_CDEF_SEARCH], num_bands)
+          : 1;
+  if (cdef_search_ctx->search_num_workers > 1) {
+    CHECK_MEM_ERROR(
+        cm, cdef_search_ctx->search_tot_mse,
+        aom_arena_malloc(&cpi->frame_arena,
+                         cdef_search_ctx->search_num_workers *
+                             sizeof(*cdef_search_ctx->search_tot_mse)));
+  }
+  // Start from the strengths of the previous frame if they were chosen with
+  // the same search method.
+  const int reuse_prev_strengths =
+      cpi->sf.lpf_sf.cdef_reuse_prev_strengths && !frame_is_intra_only(cm) &&
+      cdef_search_ctx->prev_nb_strengths > 0 &&
+      cdef_search_ctx->prev_pick_method == (int)pick_method &&
+      cdef_search_ctx->prev_num_planes == num_planes;
   uint64_t(*mse[2])[TOTAL_STRENGTHS];
   mse[0] = cdef_search_ctx->mse[0];
   mse[1] = cdef_search_ctx->mse[1];
@@ -897,13 +979,23 @@ void av1_cdef_search(AV1_COMP *cpi) {
     int best_lev0[CDEF_MAX_STRENGTHS] = { 0 };
     int best_lev1[CDEF_MAX_STRENGTHS] = { 0 };
     const int nb_strengths = 1 << i;
+    int start = 0;
+    int refine_iters = 4 * nb_strengths;
+    if (reuse_prev_strengths) {
+      start = AOMMIN(cdef_search_ctx->prev_nb_strengths, nb_strengths - 1);
+      refine_iters = nb_strengths;
+      memcpy(best_lev0, cdef_search_ctx->prev_lev[0],
+             start * sizeof(best_lev0[0]));
+      memcpy(best_lev1, cdef_search_ctx->prev_lev[1],
+             start * sizeof(best_lev1[0]));
+    }
     uint64_t tot_mse;
     if (num_planes > 1) {
-      tot_mse = joint_strength_search_dual(best_lev0, best_lev1, nb_strengths,
-                                           mse, sb_count, pick_method);
+      tot_mse = joint_strength_search_dual(cpi, best_lev0, best_lev1,
+                                           nb_strengths, start, refine_iters);
     } else {
-      tot_mse = joint_strength_search(best_lev0, nb_strengths, mse[0], sb_count,
-                                      pick_method);
+      tot_mse = joint_strength_search(cpi, best_lev0, nb_strengths, start,
+                                      refine_iters);
     }
 
     const int total_bits = sb_count * i + nb_strengths * CDEF_STRENGTH_BITS *
@@ -939,6 +1031,14 @@ void av1_cdef_search(AV1_COMP *cpi) {
     mi_params->mi_grid_base[cdef_search_ctx->sb_index[i]]->cdef_strength =
         best_gi;
   }
+  memcpy(cdef_search_ctx->prev_lev[0], cdef_info->cdef_strengths,
+         cdef_info->nb_cdef_strengths * sizeof(cdef_info->cdef_strengths[0]));
+  memcpy(cdef_search_ctx->prev_lev[1], cdef_info->cdef_uv_strengths,
+         cdef_info->nb_cdef_strengths *
+             sizeof(cdef_info->cdef_uv_strengths[0]));
+  cdef_search_ctx->prev_nb_strengths = cdef_info->nb_cdef_strengths;
+  cdef_search_ctx->prev_pick_method = pick_method;
+  cdef_search_ctx->prev_num_planes = num_planes;
   if (fast) {
     for (int j = 0; j < cdef_info->nb_cdef_strengths; j++) {
       const int luma_strength = cdef_info->cdef_strengths[j];
@@ -955,4 +1055,5 @@ void av1_cdef_search(AV1_COMP *cpi) {
   cdef_info->cdef_damping = damping;
   // Deallocate CDEF search context buffers.
   av1_cdef_dealloc_data(cdef_search_ctx);
+  aom_arena_release(&cpi->frame_arena, arena_mark);
 }
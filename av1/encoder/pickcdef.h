@@ -13,6 +13,7 @@
 
 #include "av1/common/cdef.h"
 #include "av1/encoder/speed_features.h"
+#include "av1/encoder/task_pool.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -73,6 +74,23 @@ typedef uint64_t (*compute_cdef_dist_t)(void *dst, int dstride, uint16_t *src,
                                         BLOCK_SIZE bsize, int coeff_shift,
                                         int row, int col);
 
+/*!\cond */
+// Number of 64x64 blocks in a band of the multi-threaded CDEF strength search.
+#define CDEF_STRENGTH_SEARCH_BAND_SIZE 64
+
+// Task computing the MSE of one non-skip 64x64 block in the multi-threaded
+// CDEF search.
+typedef struct {
+  AV1Task task;
+  // Row index in units of 64x64 block
+  int fbr;
+  // Column index in units of 64x64 block
+  int fbc;
+  // Index of the block in raster scan order of the non-skip blocks
+  int sb_count;
+} CdefSearchTask;
+/*!\endcond */
+
 /*! \brief CDEF search context.
  */
 typedef struct {
@@ -164,6 +182,46 @@ typedef struct {
    * Holds the count of cdef filtered blocks
    */
   int sb_count;
+  /*!
+   * Tasks of the multi-threaded search, one per 64x64 block
+   */
+  CdefSearchTask *tasks;
+  /*!
+   * Strengths already selected in the current step of the strength search.
+   * search_lev[0] holds the luma strengths and search_lev[1] the chroma ones
+   */
+  const int *search_lev[2];
+  /*!
+   * Number of strengths in search_lev
+   */
+  int search_nb_strengths;
+  /*!
+   * Number of workers of the multi-threaded strength search
+   */
+  int search_num_workers;
+  /*!
+   * Total MSE of each candidate strength pair accumulated by each worker in
+   * the current step of the strength search. Only the first row is used when
+   * there is a single plane
+   */
+  uint64_t (*search_tot_mse)[TOTAL_STRENGTHS][TOTAL_STRENGTHS];
+  /*!
+   * Strength indices chosen for the previous frame, used as the starting set
+   * of the search when lpf_sf.cdef_reuse_prev_strengths is enabled
+   */
+  int prev_lev[2][CDEF_MAX_STRENGTHS];
+  /*!
+   * Number of strengths in prev_lev, 0 if there is no previous frame
+   */
+  int prev_nb_strengths;
+  /*!
+   * Search method the strengths in prev_lev were chosen with
+   */
+  int prev_pick_method;
+  /*!
+   * Number of planes of the previous frame
+   */
+  int prev_num_planes;
   /*!
    * Indicates if 16bit frame buffers are to be used i.e., the content bit-depth
    * is > 8-bit
@@ -218,6 +276,9 @@ void av1_cdef_dealloc_data(CdefSearchCtx *cdef_search_ctx);
 void av1_cdef_mse_calc_block(CdefSearchCtx *cdef_search_ctx,
                              struct aom_internal_error_info *error_info,
                              int fbr, int fbc, int sb_count);
+
+void av1_cdef_strength_search_band(CdefSearchCtx *cdef_search_ctx, int band,
+                                   int thread_id);
 /*!\endcond */
 
 /*!\brief AV1 CDEF parameter search
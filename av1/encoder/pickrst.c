@@ -29,6 +29,7 @@
 
 #include "av1/encoder/av1_quantize.h"
 #include "av1/encoder/encoder.h"
+#include "av1/encoder/ethread.h"
 #include "av1/encoder/picklpf.h"
 #include "av1/encoder/pickrst.h"
 
@@ -104,7 +105,19 @@ static uint64_t var_restoration_unit(const RestorationTileLimits *limits,
       limits->v_end - limits->v_start);
 }
 
+// Search results of a restoration unit which do not depend on the reference
+// parameters used for delta-coding, and so can be computed for all units of a
+// plane in parallel before the units are costed up in encoding order.
 typedef struct {
+  int64_t sse[RESTORE_SWITCHABLE_TYPES];
+  WienerInfo wiener;
+  SgrprojInfo sgrproj;
+  // Set if the Wiener filter is rejected before being costed, based on the
+  // source variance or on the filter score.
+  bool wiener_pruned;
+} RestUnitPrecalc;
+
+typedef struct RestSearchCtxt {
   const YV12_BUFFER_CONFIG *src;
   YV12_BUFFER_CONFIG *dst;
 
@@ -154,6 +167,15 @@ typedef struct {
   // call of Wiener filter.
   int16_t *dgd_avg;
   int16_t *src_avg;
+
+  // Multithreaded search. When 'precalc' is not NULL, the results of each RU
+  // of the plane are computed by av1_search_rest_unit_row() before the serial
+  // costing pass of restoration_search() reads them.
+  RestUnitPrecalc *precalc;
+  const bool *disable_lr_filter;
+  // Per-thread scratch buffers, indexed by thread id.
+  int32_t **thread_tmpbuf;
+  int16_t **thread_dgd_avg;
 } RestSearchCtxt;
 
 static inline void rsc_on_tile(void *priv) {
@@ -199,9 +221,10 @@ static inline void init_rsc(const YV12_BUFFER_CONFIG *src, const AV1_COMMON *cm,
   rsc->dgd_stride = dgd->strides[is_uv];
 }
 
-static int64_t try_restoration_unit(const RestSearchCtxt *rsc,
-                                    const RestorationTileLimits *limits,
-                                    const RestorationUnitInfo *rui) {
+static int64_t try_restoration_unit(
+    const RestSearchCtxt *rsc, const RestorationTileLimits *limits,
+    const RestorationUnitInfo *rui, int32_t *tmpbuf,
+    struct aom_internal_error_info *error_info) {
   const AV1_COMMON *const cm = rsc->cm;
   const int plane = rsc->plane;
   const int is_uv = plane > 0;
@@ -220,7 +243,7 @@ static int64_t try_restoration_unit(const RestSearchCtxt *rsc,
       is_uv && cm->seq_params->subsampling_x,
       is_uv && cm->seq_params->subsampling_y, highbd, bit_depth,
       fts->buffers[plane], fts->strides[is_uv], rsc->dst->buffers[plane],
-      rsc->dst->strides[is_uv], cm->rst_tmpbuf, optimized_lr, cm->error);
+      rsc->dst->strides[is_uv], tmpbuf, optimized_lr, error_info);
 
   return sse_restoration_unit(limits, rsc->src, rsc->dst, plane, highbd);
 }
@@ -891,29 +914,17 @@ static int count_sgrproj_bits(SgrprojInfo *sgrproj_info,
   return bits;
 }
 
-static inline void search_sgrproj(const RestorationTileLimits *limits,
-                                  int rest_unit_idx, void *priv,
-                                  int32_t *tmpbuf, RestorationLineBuffers *rlbs,
-                                  struct aom_internal_error_info *error_info) {
-  (void)rlbs;
-  RestSearchCtxt *rsc = (RestSearchCtxt *)priv;
-  RestUnitSearchInfo *rusi = &rsc->rusi[rest_unit_idx];
-
-  const MACROBLOCK *const x = rsc->x;
+// Finds the self-guided filter parameters for the RU, and the SSE of the RU
+// filtered with them.
+static void compute_sgrproj_unit(const RestSearchCtxt *rsc,
+                                 const RestorationTileLimits *limits,
+                                 int32_t *tmpbuf,
+                                 struct aom_internal_error_info *error_info,
+                                 SgrprojInfo *sgrproj, int64_t *sse) {
   const AV1_COMMON *const cm = rsc->cm;
   const int highbd = cm->seq_params->use_highbitdepth;
   const int bit_depth = cm->seq_params->bit_depth;
 
-  const int64_t bits_none = x->mode_costs.sgrproj_restore_cost[0];
-  // Prune evaluation of RESTORE_SGRPROJ if 'skip_sgr_eval' is set
-  if (rsc->skip_sgr_eval) {
-    rsc->total_bits[RESTORE_SGRPROJ] += bits_none;
-    rsc->total_sse[RESTORE_SGRPROJ] += rsc->sse[RESTORE_NONE];
-    rusi->best_rtype[RESTORE_SGRPROJ - 1] = RESTORE_NONE;
-    rsc->sse[RESTORE_SGRPROJ] = INT64_MAX;
-    return;
-  }
-
   uint8_t *dgd_start =
       rsc->dgd_buffer + limits->v_start * rsc->dgd_stride + limits->h_start;
   const uint8_t *src_start =
@@ -925,7 +936,7 @@ static inline void search_sgrproj(const RestorationTileLimits *limits,
   const int procunit_width = RESTORATION_PROC_UNIT_SIZE >> ss_x;
   const int procunit_height = RESTORATION_PROC_UNIT_SIZE >> ss_y;
 
-  rusi->sgrproj = search_selfguided_restoration(
+  *sgrproj = search_selfguided_restoration(
       dgd_start, limits->h_end - limits->h_start,
       limits->v_end - limits->v_start, rsc->dgd_stride, src_start,
       rsc->src_stride, highbd, bit_depth, procunit_width, procunit_height,
@@ -933,9 +944,41 @@ static inline void search_sgrproj(const RestorationTileLimits *limits,
 
   RestorationUnitInfo rui;
   rui.restoration_type = RESTORE_SGRPROJ;
-  rui.sgrproj_info = rusi->sgrproj;
+  rui.sgrproj_info = *sgrproj;
+
+  *sse = try_restoration_unit(rsc, limits, &rui, tmpbuf, error_info);
+}
+
+static inline void search_sgrproj(const RestorationTileLimits *limits,
+                                  int rest_unit_idx, void *priv,
+                                  int32_t *tmpbuf, RestorationLineBuffers *rlbs,
+                                  struct aom_internal_error_info *error_info) {
+  (void)rlbs;
+  RestSearchCtxt *rsc = (RestSearchCtxt *)priv;
+  RestUnitSearchInfo *rusi = &rsc->rusi[rest_unit_idx];
+
+  const MACROBLOCK *const x = rsc->x;
+  const AV1_COMMON *const cm = rsc->cm;
+  const int bit_depth = cm->seq_params->bit_depth;
+
+  const int64_t bits_none = x->mode_costs.sgrproj_restore_cost[0];
+  // Prune evaluation of RESTORE_SGRPROJ if 'skip_sgr_eval' is set
+  if (rsc->skip_sgr_eval) {
+    rsc->total_bits[RESTORE_SGRPROJ] += bits_none;
+    rsc->total_sse[RESTORE_SGRPROJ] += rsc->sse[RESTORE_NONE];
+    rusi->best_rtype[RESTORE_SGRPROJ - 1] = RESTORE_NONE;
+    rsc->sse[RESTORE_SGRPROJ] = INT64_MAX;
+    return;
+  }
 
-  rsc->sse[RESTORE_SGRPROJ] = try_restoration_unit(rsc, limits, &rui);
+  if (rsc->precalc) {
+    const RestUnitPrecalc *precalc = &rsc->precalc[rest_unit_idx];
+    rusi->sgrproj = precalc->sgrproj;
+    rsc->sse[RESTORE_SGRPROJ] = precalc->sse[RESTORE_SGRPROJ];
+  } else {
+    compute_sgrproj_unit(rsc, limits, tmpbuf, error_info, &rusi->sgrproj,
+                         &rsc->sse[RESTORE_SGRPROJ]);
+  }
 
   const int64_t bits_sgr =
       x->mode_costs.sgrproj_restore_cost[1] +
@@ -1492,9 +1535,11 @@ static int count_wiener_bits(int wiener_win, WienerInfo *wiener_info,
 
 static int64_t finer_search_wiener(const RestSearchCtxt *rsc,
                                    const RestorationTileLimits *limits,
-                                   RestorationUnitInfo *rui, int wiener_win) {
+                                   RestorationUnitInfo *rui, int wiener_win,
+                                   int32_t *tmpbuf,
+                                   struct aom_internal_error_info *error_info) {
   const int plane_off = (WIENER_WIN - wiener_win) >> 1;
-  int64_t err = try_restoration_unit(rsc, limits, rui);
+  int64_t err = try_restoration_unit(rsc, limits, rui, tmpbuf, error_info);
 
   if (rsc->lpf_sf->disable_wiener_coeff_refine_search) return err;
 
@@ -1517,7 +1562,7 @@ static int64_t finer_search_wiener(const RestSearchCtxt *rsc,
           plane_wiener->hfilter[p] -= s;
           plane_wiener->hfilter[WIENER_WIN - p - 1] -= s;
           plane_wiener->hfilter[WIENER_HALFWIN] += 2 * s;
-          err2 = try_restoration_unit(rsc, limits, rui);
+          err2 = try_restoration_unit(rsc, limits, rui, tmpbuf, error_info);
           if (err2 > err) {
             plane_wiener->hfilter[p] += s;
             plane_wiener->hfilter[WIENER_WIN - p - 1] += s;
@@ -1537,7 +1582,7 @@ static int64_t finer_search_wiener(const RestSearchCtxt *rsc,
           plane_wiener->hfilter[p] += s;
           plane_wiener->hfilter[WIENER_WIN - p - 1] += s;
           plane_wiener->hfilter[WIENER_HALFWIN] -= 2 * s;
-          err2 = try_restoration_unit(rsc, limits, rui);
+          err2 = try_restoration_unit(rsc, limits, rui, tmpbuf, error_info);
           if (err2 > err) {
             plane_wiener->hfilter[p] -= s;
             plane_wiener->hfilter[WIENER_WIN - p - 1] -= s;
@@ -1558,7 +1603,7 @@ static int64_t finer_search_wiener(const RestSearchCtxt *rsc,
           plane_wiener->vfilter[p] -= s;
           plane_wiener->vfilter[WIENER_WIN - p - 1] -= s;
           plane_wiener->vfilter[WIENER_HALFWIN] += 2 * s;
-          err2 = try_restoration_unit(rsc, limits, rui);
+          err2 = try_restoration_unit(rsc, limits, rui, tmpbuf, error_info);
           if (err2 > err) {
             plane_wiener->vfilter[p] += s;
             plane_wiener->vfilter[WIENER_WIN - p - 1] += s;
@@ -1578,7 +1623,7 @@ static int64_t finer_search_wiener(const RestSearchCtxt *rsc,
           plane_wiener->vfilter[p] += s;
           plane_wiener->vfilter[WIENER_WIN - p - 1] += s;
           plane_wiener->vfilter[WIENER_HALFWIN] -= 2 * s;
-          err2 = try_restoration_unit(rsc, limits, rui);
+          err2 = try_restoration_unit(rsc, limits, rui, tmpbuf, error_info);
           if (err2 > err) {
             plane_wiener->vfilter[p] -= s;
             plane_wiener->vfilter[WIENER_WIN - p - 1] -= s;
@@ -1597,19 +1642,15 @@ static int64_t finer_search_wiener(const RestSearchCtxt *rsc,
   return err;
 }
 
-static inline void search_wiener(const RestorationTileLimits *limits,
-                                 int rest_unit_idx, void *priv, int32_t *tmpbuf,
-                                 RestorationLineBuffers *rlbs,
-                                 struct aom_internal_error_info *error_info) {
-  (void)tmpbuf;
-  (void)rlbs;
-  (void)error_info;
-  RestSearchCtxt *rsc = (RestSearchCtxt *)priv;
-  RestUnitSearchInfo *rusi = &rsc->rusi[rest_unit_idx];
-
-  const MACROBLOCK *const x = rsc->x;
-  const int64_t bits_none = x->mode_costs.wiener_restore_cost[0];
-
+// Finds the Wiener filter for the RU, and the SSE of the RU filtered with it.
+// Returns false if the filter is rejected before being costed, based on the
+// source variance or on the filter score.
+static bool compute_wiener_unit(const RestSearchCtxt *rsc,
+                                const RestorationTileLimits *limits,
+                                int64_t sse_none, int16_t *dgd_avg,
+                                int16_t *src_avg, int32_t *tmpbuf,
+                                struct aom_internal_error_info *error_info,
+                                WienerInfo *wiener, int64_t *sse) {
   // Skip Wiener search for low variance contents
   if (rsc->lpf_sf->prune_wiener_based_on_src_var) {
     const int scale[3] = { 0, 1, 2 };
@@ -1625,15 +1666,8 @@ static inline void search_wiener(const RestorationTileLimits *limits,
         var_restoration_unit(limits, rsc->src, rsc->plane, highbd);
     // Do not perform Wiener search if source variance is lower than threshold
     // or if the reconstruction error is zero
-    int prune_wiener = (src_var < thresh) || (rsc->sse[RESTORE_NONE] == 0);
-    if (prune_wiener) {
-      rsc->total_bits[RESTORE_WIENER] += bits_none;
-      rsc->total_sse[RESTORE_WIENER] += rsc->sse[RESTORE_NONE];
-      rusi->best_rtype[RESTORE_WIENER - 1] = RESTORE_NONE;
-      rsc->sse[RESTORE_WIENER] = INT64_MAX;
-      if (rsc->lpf_sf->prune_sgr_based_on_wiener == 2) rsc->skip_sgr_eval = 1;
-      return;
-    }
+    int prune_wiener = (src_var < thresh) || (sse_none == 0);
+    if (prune_wiener) return false;
   }
 
   const int wiener_win =
@@ -1656,20 +1690,20 @@ static inline void search_wiener(const RestorationTileLimits *limits,
     // functions. Optimize intrinsics of HBD design similar to LBD (i.e.,
     // pre-calculate d and s buffers and avoid most of the C operations).
     av1_compute_stats_highbd(reduced_wiener_win, rsc->dgd_buffer,
-                             rsc->src_buffer, rsc->dgd_avg, rsc->src_avg,
+                             rsc->src_buffer, dgd_avg, src_avg,
                              limits->h_start, limits->h_end, limits->v_start,
                              limits->v_end, rsc->dgd_stride, rsc->src_stride, M,
                              H, cm->seq_params->bit_depth);
   } else {
     av1_compute_stats(reduced_wiener_win, rsc->dgd_buffer, rsc->src_buffer,
-                      rsc->dgd_avg, rsc->src_avg, limits->h_start,
-                      limits->h_end, limits->v_start, limits->v_end,
-                      rsc->dgd_stride, rsc->src_stride, M, H,
+                      dgd_avg, src_avg, limits->h_start, limits->h_end,
+                      limits->v_start, limits->v_end, rsc->dgd_stride,
+                      rsc->src_stride, M, H,
                       rsc->lpf_sf->use_downsampled_wiener_stats);
   }
 #else
   av1_compute_stats(reduced_wiener_win, rsc->dgd_buffer, rsc->src_buffer,
-                    rsc->dgd_avg, rsc->src_avg, limits->h_start, limits->h_end,
+                    dgd_avg, src_avg, limits->h_start, limits->h_end,
                     limits->v_start, limits->v_end, rsc->dgd_stride,
                     rsc->src_stride, M, H,
                     rsc->lpf_sf->use_downsampled_wiener_stats);
@@ -1688,17 +1722,12 @@ static inline void search_wiener(const RestorationTileLimits *limits,
   // reduction in the function, the filter is reverted back to identity
   if (compute_score(reduced_wiener_win, M, H, rui.wiener_info.vfilter,
                     rui.wiener_info.hfilter) > 0) {
-    rsc->total_bits[RESTORE_WIENER] += bits_none;
-    rsc->total_sse[RESTORE_WIENER] += rsc->sse[RESTORE_NONE];
-    rusi->best_rtype[RESTORE_WIENER - 1] = RESTORE_NONE;
-    rsc->sse[RESTORE_WIENER] = INT64_MAX;
-    if (rsc->lpf_sf->prune_sgr_based_on_wiener == 2) rsc->skip_sgr_eval = 1;
-    return;
+    return false;
   }
 
-  rsc->sse[RESTORE_WIENER] =
-      finer_search_wiener(rsc, limits, &rui, reduced_wiener_win);
-  rusi->wiener = rui.wiener_info;
+  *sse = finer_search_wiener(rsc, limits, &rui, reduced_wiener_win, tmpbuf,
+                             error_info);
+  *wiener = rui.wiener_info;
 
   if (reduced_wiener_win != WIENER_WIN) {
     assert(rui.wiener_info.vfilter[0] == 0 &&
@@ -1706,6 +1735,44 @@ static inline void search_wiener(const RestorationTileLimits *limits,
     assert(rui.wiener_info.hfilter[0] == 0 &&
            rui.wiener_info.hfilter[WIENER_WIN - 1] == 0);
   }
+  return true;
+}
+
+static inline void search_wiener(const RestorationTileLimits *limits,
+                                 int rest_unit_idx, void *priv, int32_t *tmpbuf,
+                                 RestorationLineBuffers *rlbs,
+                                 struct aom_internal_error_info *error_info) {
+  (void)rlbs;
+  RestSearchCtxt *rsc = (RestSearchCtxt *)priv;
+  RestUnitSearchInfo *rusi = &rsc->rusi[rest_unit_idx];
+
+  const MACROBLOCK *const x = rsc->x;
+  const int64_t bits_none = x->mode_costs.wiener_restore_cost[0];
+
+  bool found;
+  if (rsc->precalc) {
+    const RestUnitPrecalc *precalc = &rsc->precalc[rest_unit_idx];
+    found = !precalc->wiener_pruned;
+    if (found) {
+      rusi->wiener = precalc->wiener;
+      rsc->sse[RESTORE_WIENER] = precalc->sse[RESTORE_WIENER];
+    }
+  } else {
+    found = compute_wiener_unit(rsc, limits, rsc->sse[RESTORE_NONE],
+                                rsc->dgd_avg, rsc->src_avg, tmpbuf, error_info,
+                                &rusi->wiener, &rsc->sse[RESTORE_WIENER]);
+  }
+  if (!found) {
+    rsc->total_bits[RESTORE_WIENER] += bits_none;
+    rsc->total_sse[RESTORE_WIENER] += rsc->sse[RESTORE_NONE];
+    rusi->best_rtype[RESTORE_WIENER - 1] = RESTORE_NONE;
+    rsc->sse[RESTORE_WIENER] = INT64_MAX;
+    if (rsc->lpf_sf->prune_sgr_based_on_wiener == 2) rsc->skip_sgr_eval = 1;
+    return;
+  }
+
+  const int wiener_win =
+      (rsc->plane == AOM_PLANE_Y) ? WIENER_WIN : WIENER_WIN_CHROMA;
 
   const int64_t bits_wiener =
       x->mode_costs.wiener_restore_cost[1] +
@@ -1747,16 +1814,19 @@ static inline void search_norestore(
     const RestorationTileLimits *limits, int rest_unit_idx, void *priv,
     int32_t *tmpbuf, RestorationLineBuffers *rlbs,
     struct aom_internal_error_info *error_info) {
-  (void)rest_unit_idx;
   (void)tmpbuf;
   (void)rlbs;
   (void)error_info;
 
   RestSearchCtxt *rsc = (RestSearchCtxt *)priv;
 
-  const int highbd = rsc->cm->seq_params->use_highbitdepth;
-  rsc->sse[RESTORE_NONE] = sse_restoration_unit(
-      limits, rsc->src, &rsc->cm->cur_frame->buf, rsc->plane, highbd);
+  if (rsc->precalc) {
+    rsc->sse[RESTORE_NONE] = rsc->precalc[rest_unit_idx].sse[RESTORE_NONE];
+  } else {
+    const int highbd = rsc->cm->seq_params->use_highbitdepth;
+    rsc->sse[RESTORE_NONE] = sse_restoration_unit(
+        limits, rsc->src, &rsc->cm->cur_frame->buf, rsc->plane, highbd);
+  }
 
   rsc->total_sse[RESTORE_NONE] += rsc->sse[RESTORE_NONE];
 }
@@ -1852,19 +1922,91 @@ static inline void copy_unit_info(RestorationType frame_rtype,
     rui->sgrproj_info = rusi->sgrproj;
 }
 
+// Returns the limits of the RU at unit position (rrow, rcol) of the plane
+// being searched.
+static RestorationTileLimits get_rest_unit_limits(const RestSearchCtxt *rsc,
+                                                  int rrow, int rcol) {
+  const AV1_COMMON *const cm = rsc->cm;
+  const int is_uv = rsc->plane > 0;
+  const int ss_y = is_uv && cm->seq_params->subsampling_y;
+  const int ru_size = cm->rst_info[rsc->plane].restoration_unit_size;
+  const int ext_size = ru_size * 3 / 2;
+  RestorationTileLimits limits;
+
+  int y0 = rrow * ru_size;
+  int remaining_h = rsc->plane_h - y0;
+  int h = (remaining_h < ext_size) ? remaining_h : ru_size;
+
+  limits.v_start = y0;
+  limits.v_end = y0 + h;
+  assert(limits.v_end <= rsc->plane_h);
+  // Offset upwards to align with the restoration processing stripe
+  const int voffset = RESTORATION_UNIT_OFFSET >> ss_y;
+  limits.v_start = AOMMAX(0, limits.v_start - voffset);
+  if (limits.v_end < rsc->plane_h) limits.v_end -= voffset;
+
+  int x0 = rcol * ru_size;
+  int remaining_w = rsc->plane_w - x0;
+  int w = (remaining_w < ext_size) ? remaining_w : ru_size;
+
+  limits.h_start = x0;
+  limits.h_end = x0 + w;
+  assert(limits.h_end <= rsc->plane_w);
+  return limits;
+}
+
+void av1_search_rest_unit_row(RestSearchCtxt *rsc, int unit_row,
+                              int thread_id,
+                              struct aom_internal_error_info *error_info) {
+  const AV1_COMMON *const cm = rsc->cm;
+  const RestorationInfo *rsi = &cm->rst_info[rsc->plane];
+  const bool *disable_lr_filter = rsc->disable_lr_filter;
+  const int highbd = cm->seq_params->use_highbitdepth;
+  int32_t *tmpbuf = rsc->thread_tmpbuf[thread_id];
+  int16_t *dgd_avg = rsc->thread_dgd_avg[thread_id];
+  int16_t *src_avg = NULL;
+  if (dgd_avg != NULL) {
+    src_avg = dgd_avg + 3 * RESTORATION_UNITSIZE_MAX * RESTORATION_UNITSIZE_MAX;
+  }
+
+  if (disable_lr_filter[RESTORE_NONE]) return;
+
+  for (int rcol = 0; rcol < rsi->horz_units; rcol++) {
+    const RestorationTileLimits limits =
+        get_rest_unit_limits(rsc, unit_row, rcol);
+    RestUnitPrecalc *precalc =
+        &rsc->precalc[unit_row * rsi->horz_units + rcol];
+
+    precalc->sse[RESTORE_NONE] = sse_restoration_unit(
+        &limits, rsc->src, &cm->cur_frame->buf, rsc->plane, highbd);
+
+    precalc->wiener_pruned = true;
+    if (!disable_lr_filter[RESTORE_WIENER]) {
+      precalc->wiener_pruned = !compute_wiener_unit(
+          rsc, &limits, precalc->sse[RESTORE_NONE], dgd_avg, src_avg, tmpbuf,
+          error_info, &precalc->wiener, &precalc->sse[RESTORE_WIENER]);
+    }
+
+    // Whether 'skip_sgr_eval' gets set usually depends on the cost of the
+    // Wiener filter, and so on the reference parameters. The self-guided
+    // filter is therefore searched unless the Wiener filter is pruned, in
+    // which case the outcome is already known.
+    const bool skip_sgr = !disable_lr_filter[RESTORE_WIENER] &&
+                          precalc->wiener_pruned &&
+                          rsc->lpf_sf->prune_sgr_based_on_wiener == 2;
+    if (!disable_lr_filter[RESTORE_SGRPROJ] && !skip_sgr) {
+      compute_sgrproj_unit(rsc, &limits, tmpbuf, error_info, &precalc->sgrproj,
+                           &precalc->sse[RESTORE_SGRPROJ]);
+    }
+  }
+}
+
 static void restoration_search(AV1_COMMON *cm, int plane, RestSearchCtxt *rsc,
                                bool *disable_lr_filter) {
   const BLOCK_SIZE sb_size = cm->seq_params->sb_size;
   const int mib_size_log2 = cm->seq_params->mib_size_log2;
   const CommonTileParams *tiles = &cm->tiles;
-  const int is_uv = plane > 0;
-  const int ss_y = is_uv && cm->seq_params->subsampling_y;
   RestorationInfo *rsi = &cm->rst_info[plane];
-  const int ru_size = rsi->restoration_unit_size;
-  const int ext_size = ru_size * 3 / 2;
-
-  int plane_w, plane_h;
-  av1_get_upsampled_plane_size(cm, is_uv, &plane_w, &plane_h);
 
   static const rest_unit_visitor_t funs[RESTORE_TYPES] = {
     search_norestore, search_wiener, search_sgrproj, search_switchable
@@ -1904,29 +2046,10 @@ static void restoration_search(AV1_COMMON *cm, int plane, RestSearchCtxt *rsc,
 
           if (!has_lr_info) continue;
 
-          RestorationTileLimits limits;
           for (int rrow = rrow0; rrow < rrow1; rrow++) {
-            int y0 = rrow * ru_size;
-            int remaining_h = plane_h - y0;
-            int h = (remaining_h < ext_size) ? remaining_h : ru_size;
-
-            limits.v_start = y0;
-            limits.v_end = y0 + h;
-            assert(limits.v_end <= plane_h);
-            // Offset upwards to align with the restoration processing stripe
-            const int voffset = RESTORATION_UNIT_OFFSET >> ss_y;
-            limits.v_start = AOMMAX(0, limits.v_start - voffset);
-            if (limits.v_end < plane_h) limits.v_end -= voffset;
-
             for (int rcol = rcol0; rcol < rcol1; rcol++) {
-              int x0 = rcol * ru_size;
-              int remaining_w = plane_w - x0;
-              int w = (remaining_w < ext_size) ? remaining_w : ru_size;
-
-              limits.h_start = x0;
-              limits.h_end = x0 + w;
-              assert(limits.h_end <= plane_w);
-
+              const RestorationTileLimits limits =
+                  get_rest_unit_limits(rsc, rrow, rcol);
               const int unit_idx = rrow * rsi->horz_units + rcol;
 
               rsc->skip_sgr_eval = 0;
@@ -1966,8 +2089,10 @@ static inline void av1_derive_flags_for_lr_processing(
 // Allocate both decoder-side and encoder-side info structs for a single plane.
 // The unit size passed in should be the minimum size which we are going to
 // search; before each search, set_restoration_unit_size() must be called to
-// configure the actual size.
+// configure the actual size. The encoder-side structs are allocated from
+// 'arena'.
 static RestUnitSearchInfo *allocate_search_structs(AV1_COMMON *cm,
+                                                   AVxArena *arena,
                                                    RestorationInfo *rsi,
                                                    int is_uv,
                                                    int min_luma_unit_size) {
@@ -1993,9 +2118,9 @@ static RestUnitSearchInfo *allocate_search_structs(AV1_COMMON *cm,
                       16, sizeof(*rsi->unit_info) * max_num_units));
 
   RestUnitSearchInfo *rusi;
-  CHECK_MEM_ERROR(
-      cm, rusi,
-      (RestUnitSearchInfo *)aom_memalign(16, sizeof(*rusi) * max_num_units));
+  CHECK_MEM_ERROR(cm, rusi,
+                  (RestUnitSearchInfo *)aom_arena_memalign(
+                      arena, 16, sizeof(*rusi) * max_num_units));
 
   // If the restoration unit dimensions are not multiples of
   // rsi->restoration_unit_size then some elements of the rusi array may be
@@ -2052,9 +2177,11 @@ void av1_pick_filter_restoration(const YV12_BUFFER_CONFIG *src, AV1_COMP *cpi) {
   min_lr_unit_size =
       AOMMAX(min_lr_unit_size, block_size_wide[cm->seq_params->sb_size]);
 
+  const AVxArenaMark arena_mark = aom_arena_mark(&cpi->frame_arena);
   for (int plane = 0; plane < num_planes; ++plane) {
-    cpi->pick_lr_ctxt.rusi[plane] = allocate_search_structs(
-        cm, &cm->rst_info[plane], plane > 0, min_lr_unit_size);
+    cpi->pick_lr_ctxt.rusi[plane] =
+        allocate_search_structs(cm, &cpi->frame_arena, &cm->rst_info[plane],
+                                plane > 0, min_lr_unit_size);
   }
 
   x->rdmult = cpi->rd.RDMULT;
@@ -2092,8 +2219,9 @@ void av1_pick_filter_restoration(const YV12_BUFFER_CONFIG *src, AV1_COMP *cpi) {
   if (allocate_buffers) {
     const int buf_size = sizeof(*cpi->pick_lr_ctxt.dgd_avg) * 6 *
                          RESTORATION_UNITSIZE_MAX * RESTORATION_UNITSIZE_MAX;
-    CHECK_MEM_ERROR(cm, cpi->pick_lr_ctxt.dgd_avg,
-                    (int16_t *)aom_memalign(32, buf_size));
+    CHECK_MEM_ERROR(
+        cm, cpi->pick_lr_ctxt.dgd_avg,
+        (int16_t *)aom_arena_memalign(&cpi->frame_arena, 32, buf_size));
 
     rsc.dgd_avg = cpi->pick_lr_ctxt.dgd_avg;
     // When LRU width isn't multiple of 16, the 256 bits load instruction used
@@ -2108,6 +2236,50 @@ void av1_pick_filter_restoration(const YV12_BUFFER_CONFIG *src, AV1_COMP *cpi) {
   }
 #endif
 
+  // Derive the flags to enable/disable Loop restoration filters based on the
+  // speed features 'disable_wiener_filter' and 'disable_sgr_filter'.
+  bool disable_lr_filter[RESTORE_TYPES] = { false };
+  av1_derive_flags_for_lr_processing(lpf_sf, disable_lr_filter);
+
+  // The search of each plane is multithreaded over rows of RUs, with the
+  // workers using the scratch buffers of the loop restoration filter workers.
+  MultiThreadInfo *const mt_info = &cpi->mt_info;
+  const int num_workers = AOMMIN(mt_info->num_mod_workers[MOD_LR],
+                                 mt_info->lr_row_sync.num_workers);
+  rsc.precalc = NULL;
+  rsc.disable_lr_filter = disable_lr_filter;
+  rsc.thread_tmpbuf = NULL;
+  rsc.thread_dgd_avg = NULL;
+  if (num_workers > 1) {
+    int plane_w, plane_h;
+    av1_get_upsampled_plane_size(cm, 0, &plane_w, &plane_h);
+    const int max_num_units = av1_lr_count_units(min_lr_unit_size, plane_w) *
+                              av1_lr_count_units(min_lr_unit_size, plane_h);
+    CHECK_MEM_ERROR(cm, rsc.precalc,
+                    aom_arena_memalign(&cpi->frame_arena, 16,
+                                       sizeof(*rsc.precalc) * max_num_units));
+    CHECK_MEM_ERROR(cm, rsc.thread_tmpbuf,
+                    aom_arena_malloc(&cpi->frame_arena,
+                                     sizeof(*rsc.thread_tmpbuf) * num_workers));
+    CHECK_MEM_ERROR(
+        cm, rsc.thread_dgd_avg,
+        aom_arena_malloc(&cpi->frame_arena,
+                         sizeof(*rsc.thread_dgd_avg) * num_workers));
+    for (int i = 0; i < num_workers; i++) {
+      rsc.thread_tmpbuf[i] = mt_info->lr_row_sync.lrworkerdata[i].rst_tmpbuf;
+      rsc.thread_dgd_avg[i] = rsc.dgd_avg;
+      if (i > 0 && rsc.dgd_avg != NULL) {
+        const int buf_size = sizeof(*rsc.dgd_avg) * 6 *
+                             RESTORATION_UNITSIZE_MAX *
+                             RESTORATION_UNITSIZE_MAX;
+        CHECK_MEM_ERROR(
+            cm, rsc.thread_dgd_avg[i],
+            (int16_t *)aom_arena_memalign(&cpi->frame_arena, 32, buf_size));
+        memset(rsc.thread_dgd_avg[i], 0, buf_size);
+      }
+    }
+  }
+
   // Initialize all planes, so that any planes we skip searching will still have
   // valid data
   for (int plane = 0; plane < num_planes; plane++) {
@@ -2129,11 +2301,6 @@ void av1_pick_filter_restoration(const YV12_BUFFER_CONFIG *src, AV1_COMP *cpi) {
     plane_end = AOM_PLANE_V;
   }
 
-  // Derive the flags to enable/disable Loop restoration filters based on the
-  // speed features 'disable_wiener_filter' and 'disable_sgr_filter'.
-  bool disable_lr_filter[RESTORE_TYPES] = { false };
-  av1_derive_flags_for_lr_processing(lpf_sf, disable_lr_filter);
-
   for (int plane = plane_start; plane <= plane_end; plane++) {
     const YV12_BUFFER_CONFIG *dgd = &cm->cur_frame->buf;
     const int is_uv = plane != AOM_PLANE_Y;
@@ -2157,6 +2324,10 @@ void av1_pick_filter_restoration(const YV12_BUFFER_CONFIG *src, AV1_COMP *cpi) {
       init_rsc(src, &cpi->common, x, lpf_sf, plane,
                cpi->pick_lr_ctxt.rusi[plane], &cpi->trial_frame_rst, &rsc);
 
+      if (rsc.precalc != NULL) {
+        av1_pick_rst_search_mt(cpi, &rsc, cm->rst_info[plane].vert_units,
+                               num_workers);
+      }
       restoration_search(cm, plane, &rsc, disable_lr_filter);
 
       const int plane_num_units = cm->rst_info[plane].num_rest_units;
@@ -2225,19 +2396,9 @@ void av1_pick_filter_restoration(const YV12_BUFFER_CONFIG *src, AV1_COMP *cpi) {
                               best_luma_unit_size);
   }
 
-#if HAVE_AVX2 || HAVE_SVE
-#if HAVE_AVX2
-  bool free_buffers = !cpi->sf.lpf_sf.disable_wiener_filter && !highbd;
-#elif HAVE_SVE
-  bool free_buffers = !cpi->sf.lpf_sf.disable_wiener_filter;
-#endif
-  if (free_buffers) {
-    aom_free(cpi->pick_lr_ctxt.dgd_avg);
-    cpi->pick_lr_ctxt.dgd_avg = NULL;
-  }
-#endif
+  cpi->pick_lr_ctxt.dgd_avg = NULL;
   for (int plane = 0; plane < num_planes; plane++) {
-    aom_free(cpi->pick_lr_ctxt.rusi[plane]);
     cpi->pick_lr_ctxt.rusi[plane] = NULL;
   }
+  aom_arena_release(&cpi->frame_arena, arena_mark);
 }
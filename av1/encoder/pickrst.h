@@ -19,6 +19,7 @@ extern "C" {
 
 struct yv12_buffer_config;
 struct AV1_COMP;
+struct RestSearchCtxt;
 
 // Enable extra debugging for loop restoration costing?
 //
@@ -84,6 +85,16 @@ static inline uint16_t find_average_highbd(const uint16_t *src, int h_start,
 }
 #endif
 
+/*!\cond */
+// Computes the search results of the restoration units in row 'unit_row' of
+// the plane being searched which do not depend on the reference parameters
+// used for delta-coding. Used by the multithreaded search, where 'thread_id'
+// selects the scratch buffers of the calling worker.
+void av1_search_rest_unit_row(struct RestSearchCtxt *rsc, int unit_row,
+                              int thread_id,
+                              struct aom_internal_error_info *error_info);
+/*!\endcond */
+
 /*!\brief Algorithm for AV1 loop restoration search and estimation.
  *
  * \ingroup in_loop_restoration
@@ -1973,6 +1973,8 @@ static inline void init_hl_sf(HIGH_LEVEL_SPEED_FEATURES *hl_sf) {
   hl_sf->accurate_bit_estimate = 0;
   hl_sf->weight_calc_level_in_tf = 0;
   hl_sf->allow_sub_blk_me_in_tf = 0;
+  hl_sf->use_quantized_nn = 0;
+  hl_sf->use_motion_field_cache = 0;
 }
 
 static inline void init_fp_sf(FIRST_PASS_SPEED_FEATURES *fp_sf) {
@@ -1995,6 +1997,7 @@ static inline void init_tpl_sf(TPL_SPEED_FEATURES *tpl_sf) {
   tpl_sf->use_y_only_rate_distortion = 0;
   tpl_sf->use_sad_for_mode_decision = 0;
   tpl_sf->reduce_num_frames = 0;
+  tpl_sf->use_flow_for_motion = 0;
 }
 
 static inline void init_gm_sf(GLOBAL_MOTION_SPEED_FEATURES *gm_sf) {
@@ -2242,6 +2245,7 @@ static inline void init_lpf_sf(LOOP_FILTER_SPEED_FEATURES *lpf_sf) {
   lpf_sf->lpf_pick = LPF_PICK_FROM_FULL_IMAGE;
   lpf_sf->use_coarse_filter_level_search = 0;
   lpf_sf->cdef_pick_method = CDEF_FULL_SEARCH;
+  lpf_sf->cdef_reuse_prev_strengths = 0;
   // Set decoder side speed feature to use less dual sgr modes
   lpf_sf->dual_sgr_penalty_level = 0;
   // Enable Wiener and Self-guided Loop restoration filters by default.
@@ -482,6 +482,23 @@ typedef struct HIGH_LEVEL_SPEED_FEATURES {
    * 1: Conditionally allow motion estimation based on 4x4 sub-blocks variance.
    */
   int allow_sub_blk_me_in_tf;
+
+  /*!
+   * Decide how the partition and transform type pruning models are
+   * evaluated.
+   * 0: in floating point, with av1_nn_predict().
+   * 1: in fixed point, with av1_nn_predict_q(), which is faster but may take
+   * slightly different decisions.
+   */
+  int use_quantized_nn;
+
+  /*!
+   * Whether the motion found between pairs of source frames by the temporal
+   * filter and the TPL model is kept in the motion field cache, and used as
+   * the starting point of a smaller motion search when the same pair, or the
+   * reverse pair, is searched again.
+   */
+  int use_motion_field_cache;
 } HIGH_LEVEL_SPEED_FEATURES;
 
 /*!
@@ -566,6 +583,12 @@ typedef struct TPL_SPEED_FEATURES {
   // Skip tpl processing for frames of type LF_UPDATE.
   // This sf is disabled for the first GF group of the key-frame interval.
   int reduce_num_frames;
+
+  // Use the dense optical flow of the source frames, computed on the image
+  // pyramids shared with global motion search, as the motion of the blocks
+  // instead of searching it. Requires the pyramids, which are only allocated
+  // when global motion is enabled.
+  int use_flow_for_motion;
 } TPL_SPEED_FEATURES;
 
 typedef struct GLOBAL_MOTION_SPEED_FEATURES {
@@ -1501,6 +1524,10 @@ typedef struct LOOP_FILTER_SPEED_FEATURES {
   // Control how the CDEF strength is determined.
   CDEF_PICK_METHOD cdef_pick_method;
 
+  // Start the CDEF strength search of inter frames from the strengths chosen
+  // for the previous frame, and refine the set once instead of four times.
+  int cdef_reuse_prev_strengths;
+
   // Decoder side speed feature to add penalty for use of dual-sgr filters.
   // Takes values 0 - 10, 0 indicating no penalty and each additional level
   // adding a penalty of 1%
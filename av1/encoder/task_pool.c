@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <assert.h>
+#include <setjmp.h>
+#include <string.h>
+
+#include "aom_mem/aom_mem.h"
+#include "av1/encoder/task_pool.h"
+
+int av1_task_pool_alloc(AV1TaskPool *pool, int num_workers) {
+  assert(num_workers > 0);
+  memset(pool, 0, sizeof(*pool));
+#if CONFIG_MULTITHREAD
+  pool->mutex_ = aom_malloc(sizeof(*pool->mutex_));
+  if (pool->mutex_ == NULL) goto fail;
+  pthread_mutex_init(pool->mutex_, NULL);
+  pool->cond_ = aom_malloc(sizeof(*pool->cond_));
+  if (pool->cond_ == NULL) goto fail;
+  pthread_cond_init(pool->cond_, NULL);
+#endif  // CONFIG_MULTITHREAD
+  pool->deques = aom_calloc(num_workers, sizeof(*pool->deques));
+  if (pool->deques == NULL) goto fail;
+  pool->num_deques = num_workers;
+#if CONFIG_MULTITHREAD
+  for (int i = 0; i < num_workers; i++) {
+    AV1TaskDeque *const deque = &pool->deques[i];
+    deque->mutex_ = aom_malloc(sizeof(*deque->mutex_));
+    if (deque->mutex_ == NULL) goto fail;
+    pthread_mutex_init(deque->mutex_, NULL);
+  }
+#endif  // CONFIG_MULTITHREAD
+  return 1;
+
+fail:
+  av1_task_pool_dealloc(pool);
+  return 0;
+}
+
+int av1_task_pool_reserve(AV1TaskPool *pool, int max_tasks) {
+  if (max_tasks <= pool->capacity) return 1;
+  // Every task of a run may end up in the same deque.
+  for (int i = 0; i < pool->num_deques; i++) {
+    AV1TaskDeque *const deque = &pool->deques[i];
+    aom_free(deque->tasks);
+    deque->tasks = aom_malloc(max_tasks * sizeof(*deque->tasks));
+    if (deque->tasks == NULL) {
+      pool->capacity = 0;
+      return 0;
+    }
+  }
+  pool->capacity = max_tasks;
+  return 1;
+}
+
+void av1_task_pool_dealloc(AV1TaskPool *pool) {
+  if (pool->deques != NULL) {
+    for (int i = 0; i < pool->num_deques; i++) {
+      AV1TaskDeque *const deque = &pool->deques[i];
+#if CONFIG_MULTITHREAD
+      if (deque->mutex_ != NULL) {
+        pthread_mutex_destroy(deque->mutex_);
+        aom_free(deque->mutex_);
+      }
+#endif  // CONFIG_MULTITHREAD
+      aom_free(deque->tasks);
+    }
+    aom_free(pool->deques);
+  }
+#if CONFIG_MULTITHREAD
+  if (pool->mutex_ != NULL) {
+    pthread_mutex_destroy(pool->mutex_);
+    aom_free(pool->mutex_);
+  }
+  if (pool->cond_ != NULL) {
+    pthread_cond_destroy(pool->cond_);
+    aom_free(pool->cond_);
+  }
+#endif  // CONFIG_MULTITHREAD
+  memset(pool, 0, sizeof(*pool));
+}
+
+void av1_task_pool_reset(AV1TaskPool *pool) {
+  for (int i = 0; i < pool->num_deques; i++) {
+    pool->deques[i].top = 0;
+    pool->deques[i].bottom = 0;
+  }
+  pool->num_pending = 0;
+  pool->push_count = 0;
+  pool->num_waiting = 0;
+  pool->next_deque = 0;
+  pool->exit = false;
+}
+
+void av1_task_init(AV1Task *task, AV1TaskFunc func, void *arg) {
+  task->func = func;
+  task->arg = arg;
+  task->num_deps = 0;
+  task->num_successors = 0;
+}
+
+void av1_task_add_dependency(AV1Task *task, AV1Task *successor) {
+  assert(task->num_successors < AV1_TASK_MAX_SUCCESSORS);
+  task->successors[task->num_successors++] = successor;
+  successor->num_deps++;
+}
+
+// Pushes a ready task to the bottom of a deque. The caller must hold the pool
+// mutex.
+static void push_task(AV1TaskPool *pool, AV1TaskDeque *deque, AV1Task *task) {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(deque->mutex_);
+#endif
+  assert(deque->bottom < pool->capacity);
+  deque->tasks[deque->bottom++] = task;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(deque->mutex_);
+#endif
+  pool->push_count++;
+}
+
+// Pops the most recently pushed task of the worker's own deque, which is the
+// one most likely to share data with the task that just finished.
+static AV1Task *pop_task(AV1TaskDeque *deque) {
+  AV1Task *task = NULL;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(deque->mutex_);
+#endif
+  if (deque->bottom > deque->top) task = deque->tasks[--deque->bottom];
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(deque->mutex_);
+#endif
+  return task;
+}
+
+// Steals the oldest task of another worker's deque.
+static AV1Task *steal_task(AV1TaskDeque *deque) {
+  AV1Task *task = NULL;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(deque->mutex_);
+#endif
+  if (deque->bottom > deque->top) task = deque->tasks[deque->top++];
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(deque->mutex_);
+#endif
+  return task;
+}
+
+static AV1Task *get_next_task(AV1TaskPool *pool, int worker_id) {
+  AV1Task *task = pop_task(&pool->deques[worker_id]);
+  for (int i = 1; task == NULL && i < pool->num_deques; i++) {
+    task = steal_task(&pool->deques[(worker_id + i) % pool->num_deques]);
+  }
+  return task;
+}
+
+void av1_task_pool_submit(AV1TaskPool *pool, AV1Task *task) {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(pool->mutex_);
+#endif
+  pool->num_pending++;
+  assert(pool->num_pending <= pool->capacity);
+  if (task->num_deps == 0) {
+    push_task(pool, &pool->deques[pool->next_deque], task);
+    pool->next_deque = (pool->next_deque + 1) % pool->num_deques;
+  }
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(pool->mutex_);
+#endif
+}
+
+// Releases the successors of a finished task into the worker's own deque.
+static void finish_task(AV1TaskPool *pool, AV1TaskDeque *deque,
+                        AV1Task *task) {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(pool->mutex_);
+#endif
+  int num_ready = 0;
+  for (int i = 0; i < task->num_successors; i++) {
+    AV1Task *const successor = task->successors[i];
+    assert(successor->num_deps > 0);
+    if (--successor->num_deps == 0) {
+      push_task(pool, deque, successor);
+      num_ready++;
+    }
+  }
+  pool->num_pending--;
+#if CONFIG_MULTITHREAD
+  // The worker runs one of the released tasks itself; wake the others for the
+  // rest, or for exiting at the end of the run.
+  if (pool->num_waiting > 0 && (num_ready > 1 || pool->num_pending == 0))
+    pthread_cond_broadcast(pool->cond_);
+  pthread_mutex_unlock(pool->mutex_);
+#else
+  (void)num_ready;
+#endif
+}
+
+int av1_task_pool_run(AV1TaskPool *pool, int worker_id, void *worker_data,
+                      struct aom_internal_error_info *error_info) {
+  assert(worker_id >= 0 && worker_id < pool->num_deques);
+
+  // The jmp_buf is valid only for the duration of the function that calls
+  // setjmp(). Therefore, this function must reset the 'setjmp' field to 0
+  // before it returns.
+  if (setjmp(error_info->jmp)) {
+    error_info->setjmp = 0;
+#if CONFIG_MULTITHREAD
+    pthread_mutex_lock(pool->mutex_);
+    pool->exit = true;
+    pthread_cond_broadcast(pool->cond_);
+    pthread_mutex_unlock(pool->mutex_);
+#else
+    pool->exit = true;
+#endif
+    return 0;
+  }
+  error_info->setjmp = 1;
+
+  while (1) {
+#if CONFIG_MULTITHREAD
+    pthread_mutex_lock(pool->mutex_);
+#endif
+    const bool done = pool->exit || pool->num_pending == 0;
+    const unsigned int push_count = pool->push_count;
+#if CONFIG_MULTITHREAD
+    pthread_mutex_unlock(pool->mutex_);
+#endif
+    if (done) break;
+
+    AV1Task *const task = get_next_task(pool, worker_id);
+    if (task == NULL) {
+#if CONFIG_MULTITHREAD
+      // Nothing to run until another worker releases a task. Sleep unless a
+      // task was pushed after the deques were scanned.
+      pthread_mutex_lock(pool->mutex_);
+      while (!pool->exit && pool->num_pending > 0 &&
+             pool->push_count == push_count) {
+        pool->num_waiting++;
+        pthread_cond_wait(pool->cond_, pool->mutex_);
+        pool->num_waiting--;
+      }
+      pthread_mutex_unlock(pool->mutex_);
+#else
+      assert(0 && "Task dependencies can never be satisfied.");
+      break;
+#endif
+      continue;
+    }
+
+    task->func(task->arg, worker_data, error_info);
+    finish_task(pool, &pool->deques[worker_id], task);
+  }
+  error_info->setjmp = 0;
+  return 1;
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#ifndef AOM_AV1_ENCODER_TASK_POOL_H_
+#define AOM_AV1_ENCODER_TASK_POOL_H_
+
+#include <stdbool.h>
+
+#include "config/aom_config.h"
+
+#include "aom/internal/aom_codec_internal.h"
+#include "aom_util/aom_pthread.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Maximum number of tasks that may depend on a single task.
+#define AV1_TASK_MAX_SUCCESSORS 2
+
+// Function executed for a task. 'arg' is the task's argument and
+// 'worker_data' is the per-worker data passed to av1_task_pool_run() by the
+// worker running the task. Errors are reported through aom_internal_error()
+// on 'error_info', which aborts the remaining tasks of the run.
+typedef void (*AV1TaskFunc)(void *arg, void *worker_data,
+                            struct aom_internal_error_info *error_info);
+
+typedef struct AV1Task {
+  AV1TaskFunc func;
+  void *arg;
+  // Number of unfinished tasks this task waits for. The task becomes ready to
+  // run when this drops to 0.
+  int num_deps;
+  // Tasks waiting for this task to finish.
+  int num_successors;
+  struct AV1Task *successors[AV1_TASK_MAX_SUCCESSORS];
+} AV1Task;
+
+// Double-ended queue of ready tasks owned by one worker. The owner pushes and
+// pops at the bottom, other workers steal from the top.
+typedef struct AV1TaskDeque {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t *mutex_;
+#endif
+  AV1Task **tasks;
+  int top;
+  int bottom;
+} AV1TaskDeque;
+
+// Work-stealing task pool shared by the encoder multi-threaded stages.
+//
+// A run starts with av1_task_pool_reset() followed by av1_task_pool_submit()
+// of every task of the run, possibly from several stages. Each worker then
+// calls av1_task_pool_run(), which returns once all submitted tasks have
+// finished, or after an error. Dependencies between tasks (e.g. superblock row
+// wavefronts, or a stage consuming the output of another) are expressed with
+// av1_task_add_dependency(), so that independent work of different stages can
+// overlap instead of being separated by a barrier.
+typedef struct AV1TaskPool {
+#if CONFIG_MULTITHREAD
+  // Protects the counters below and the dependency counts of the tasks.
+  pthread_mutex_t *mutex_;
+  // Signaled when tasks become ready or when the run ends.
+  pthread_cond_t *cond_;
+#endif
+  AV1TaskDeque *deques;
+  int num_deques;
+  // Maximum number of tasks in a run.
+  int capacity;
+  // Number of submitted tasks that have not finished yet.
+  int num_pending;
+  // Incremented each time a task is pushed to a deque.
+  unsigned int push_count;
+  // Number of workers waiting on cond_.
+  int num_waiting;
+  // Deque receiving the next submitted task.
+  int next_deque;
+  // Set by the worker that encounters an error in order to abort the run.
+  bool exit;
+} AV1TaskPool;
+
+// Allocates a pool for 'num_workers' workers. Returns 0 on allocation failure.
+int av1_task_pool_alloc(AV1TaskPool *pool, int num_workers);
+
+// Grows the pool, if needed, so that it can hold 'max_tasks' tasks per run.
+// Must not be called during a run. Returns 0 on allocation failure.
+int av1_task_pool_reserve(AV1TaskPool *pool, int max_tasks);
+
+void av1_task_pool_dealloc(AV1TaskPool *pool);
+
+// Prepares the pool for a new run.
+void av1_task_pool_reset(AV1TaskPool *pool);
+
+void av1_task_init(AV1Task *task, AV1TaskFunc func, void *arg);
+
+// Makes 'successor' wait for 'task'. Both tasks must be initialized and not
+// yet submitted.
+void av1_task_add_dependency(AV1Task *task, AV1Task *successor);
+
+// Adds 'task' to the current run. All the tasks of a run must be submitted
+// before the workers start running it.
+void av1_task_pool_submit(AV1TaskPool *pool, AV1Task *task);
+
+// Executes tasks of the current run on behalf of worker 'worker_id' until all
+// of them have finished. Returns 0 if a task reported an error through
+// 'error_info', 1 otherwise.
+int av1_task_pool_run(AV1TaskPool *pool, int worker_id, void *worker_data,
+                      struct aom_internal_error_info *error_info);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AOM_AV1_ENCODER_TASK_POOL_H_
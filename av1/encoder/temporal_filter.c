@@ -17,8 +17,10 @@
 #include "config/aom_scale_rtcd.h"
 
 #include "aom_dsp/aom_dsp_common.h"
+#include "aom_dsp/flow_estimation/corner_detect.h"
 #include "aom_dsp/mathutils.h"
 #include "aom_dsp/odintrin.h"
+#include "aom_dsp/pyramid.h"
 #include "aom_mem/aom_mem.h"
 #include "aom_ports/aom_timer.h"
 #include "aom_ports/mem.h"
@@ -124,6 +126,11 @@ static int get_q(const AV1_COMP *cpi) {
  *                                    previous frame.
  * \param[in]   allow_me_for_sub_blks Flag to indicate whether motion search at
  *                                    16x16 sub-block level is needed or not.
+ * \param[in]   motion_field          Motion field of the frame to be filtered
+ *                                    in the reference frame, in which the
+ *                                    results are stored, or NULL
+ * \param[in]   reverse_motion_field  Motion field of the reference frame in
+ *                                    the frame to be filtered, or NULL
  * \param[out]  subblock_mvs          Pointer to the motion vectors for
  *                                    4 sub-blocks
  * \param[out]  subblock_mses         Pointer to the search errors (MSE) for
@@ -137,10 +144,15 @@ static void tf_motion_search(AV1_COMP *cpi, MACROBLOCK *mb,
                              const YV12_BUFFER_CONFIG *ref_frame,
                              const BLOCK_SIZE block_size, const int mb_row,
                              const int mb_col, MV *ref_mv,
-                             bool allow_me_for_sub_blks, MV *subblock_mvs,
-                             int *subblock_mses) {
+                             bool allow_me_for_sub_blks,
+                             MotionField *motion_field,
+                             const MotionField *reverse_motion_field,
+                             MV *subblock_mvs, int *subblock_mses) {
   // Frame information
   const int min_frame_size = AOMMIN(cpi->common.width, cpi->common.height);
+  // Motion search errors up to this threshold are considered reliable.
+  const uint32_t thresh =
+      av1_motion_field_reliable_err(min_frame_size, mb->e_mbd.bd);
 
   // Block information (ONLY Y-plane is used for motion search).
   const int mb_height = block_size_high[block_size];
@@ -161,8 +173,9 @@ static void tf_motion_search(AV1_COMP *cpi, MACROBLOCK *mb,
   // Parameters used for motion search.
   FULLPEL_MOTION_SEARCH_PARAMS full_ms_params;
   SUBPEL_MOTION_SEARCH_PARAMS ms_params;
-  const int step_param = av1_init_search_range(
+  const int full_step_param = av1_init_search_range(
       AOMMAX(frame_to_filter->y_crop_width, frame_to_filter->y_crop_height));
+  int step_param = full_step_param;
   const SUBPEL_SEARCH_TYPE subpel_search_type = USE_8_TAPS;
   const int force_integer_mv = cpi->common.features.cur_frame_force_integer_mv;
   const MV_COST_TYPE mv_cost_type =
@@ -172,6 +185,34 @@ static void tf_motion_search(AV1_COMP *cpi, MACROBLOCK *mb,
 
   // Starting position for motion search.
   FULLPEL_MV start_mv = get_fullmv_from_mv(ref_mv);
+
+  // Motion of the sub-blocks found by earlier searches of the frame pair. The
+  // search of the block starts from the most reliable one and only refines
+  // it.
+  const MotionFieldCache *const mf_cache = &cpi->ppi->motion_field_cache;
+  const int mf_row = mb_row * 2;
+  const int mf_col = mb_col * 2;
+  MV prior_mvs[4];
+  bool has_prior[4] = { false, false, false, false };
+  if (motion_field != NULL || reverse_motion_field != NULL) {
+    assert(block_size_wide[block_size] == 2 * MOTION_FIELD_BLOCK_SIZE);
+    assert(block_size_high[block_size] == 2 * MOTION_FIELD_BLOCK_SIZE);
+    uint32_t best_prior_err = MOTION_FIELD_INVALID_ERR;
+    for (int i = 0; i < 4; ++i) {
+      uint32_t err;
+      has_prior[i] = av1_motion_field_lookup(
+                         mf_cache, motion_field, reverse_motion_field,
+                         mf_row + (i >> 1), mf_col + (i & 1), &prior_mvs[i],
+                         &err) &&
+                     err <= thresh;
+      if (has_prior[i] && err < best_prior_err) {
+        best_prior_err = err;
+        start_mv = get_fullmv_from_mv(&prior_mvs[i]);
+        step_param = AOMMAX(full_step_param, MOTION_FIELD_REFINE_STEP_PARAM);
+      }
+    }
+  }
+
   // Baseline position for motion search (used for rate distortion comparison).
   const MV baseline_mv = kZeroMv;
 
@@ -252,7 +293,6 @@ static void tf_motion_search(AV1_COMP *cpi, MACROBLOCK *mb,
       const int subblock_height = block_size_high[subblock_size];
       const int subblock_width = block_size_wide[subblock_size];
       const int subblock_pels = subblock_height * subblock_width;
-      start_mv = get_fullmv_from_mv(ref_mv);
 
       int subblock_idx = 0;
       for (int i = 0; i < mb_height; i += subblock_height) {
@@ -260,6 +300,13 @@ static void tf_motion_search(AV1_COMP *cpi, MACROBLOCK *mb,
           const int offset = i * y_stride + j;
           mb->plane[0].src.buf = frame_to_filter->y_buffer + y_offset + offset;
           mbd->plane[0].pre[0].buf = ref_frame->y_buffer + y_offset + offset;
+          start_mv = get_fullmv_from_mv(ref_mv);
+          step_param = full_step_param;
+          if (has_prior[subblock_idx]) {
+            start_mv = get_fullmv_from_mv(&prior_mvs[subblock_idx]);
+            step_param =
+                AOMMAX(full_step_param, MOTION_FIELD_REFINE_STEP_PARAM);
+          }
           av1_make_default_fullpel_ms_params(
               &full_ms_params, cpi, mb, subblock_size, &baseline_mv, start_mv,
               search_site_cfg, search_method,
@@ -314,9 +361,13 @@ static void tf_motion_search(AV1_COMP *cpi, MACROBLOCK *mb,
       subblock_mses[i] = block_mse;
     }
   }
+  for (int i = 0; i < 4; ++i) {
+    av1_motion_field_store(mf_cache, motion_field, mf_row + (i >> 1),
+                           mf_col + (i & 1), subblock_mvs[i],
+                           (uint32_t)subblock_mses[i]);
+  }
   // Do not pass down the reference motion vector if error is too large.
-  const int thresh = (min_frame_size >= 720) ? 12 : 3;
-  if (block_mse > (thresh << (mbd->bd - 8))) {
+  if ((uint32_t)block_mse > thresh) {
     *ref_mv = kZeroMv;
   }
 }
@@ -932,7 +983,9 @@ void av1_tf_do_filtering_row(AV1_COMP *cpi, ThreadData *td, int mb_row) {
       } else {  // Other reference frames.
         tf_motion_search(cpi, mb, frame_to_filter, frames[frame], block_size,
                          mb_row, mb_col, &ref_mv, allow_me_for_sub_blks,
-                         subblock_mvs, subblock_mses);
+                         tf_ctx->motion_fields[frame],
+                         tf_ctx->reverse_motion_fields[frame], subblock_mvs,
+                         subblock_mses);
       }
 
       // Perform weighted averaging.
@@ -1033,6 +1086,40 @@ static void tf_do_filtering(AV1_COMP *cpi) {
   tf_restore_state(mbd, input_mb_mode_info, input_buffer, num_planes);
 }
 
+// Gets the motion fields of the frame to be filtered in the other frames of the
+// buffer from the motion field cache, and the motion fields of those frames in
+// the frame to be filtered if the cache holds them. display_idx holds the
+// display indices of the frames of the buffer.
+static void tf_setup_motion_fields(AV1_COMP *cpi, const int *display_idx) {
+  TemporalFilterCtx *tf_ctx = &cpi->tf_ctx;
+  MotionFieldCache *const cache = &cpi->ppi->motion_field_cache;
+  const int num_frames = tf_ctx->num_frames;
+  const int filter_frame_idx = tf_ctx->filter_frame_idx;
+  const YV12_BUFFER_CONFIG *const frame_to_filter =
+      tf_ctx->frames[filter_frame_idx];
+  const int width = frame_to_filter->y_crop_width;
+  const int height = frame_to_filter->y_crop_height;
+  const int src = display_idx[filter_frame_idx];
+
+  for (int frame = 0; frame < num_frames; ++frame) {
+    tf_ctx->motion_fields[frame] = NULL;
+    tf_ctx->reverse_motion_fields[frame] = NULL;
+  }
+  if (!cpi->sf.hl_sf.use_motion_field_cache) return;
+
+  // Get the fields to store to first, as they may replace fields of the cache.
+  for (int frame = 0; frame < num_frames; ++frame) {
+    if (frame == filter_frame_idx) continue;
+    tf_ctx->motion_fields[frame] = av1_motion_field_cache_get(
+        cache, width, height, src, display_idx[frame]);
+  }
+  for (int frame = 0; frame < num_frames; ++frame) {
+    if (frame == filter_frame_idx) continue;
+    tf_ctx->reverse_motion_fields[frame] = av1_motion_field_cache_find(
+        cache, width, height, display_idx[frame], src);
+  }
+}
+
 /*!\brief Setups the frame buffer for temporal filtering. This fuction
  * determines how many frames will be used for temporal filtering and then
  * groups them into a buffer. This function will also estimate the noise level
@@ -1195,16 +1282,19 @@ static void tf_setup_filtering_buffer(AV1_COMP *cpi,
   num_frames = num_before + 1 + num_after;
 
   // Setup the frame buffer.
+  int display_idx[MAX_LAG_BUFFERS];
   for (int frame = 0; frame < num_frames; ++frame) {
     const int lookahead_idx = frame - num_before + filter_frame_lookahead_idx;
     struct lookahead_entry *buf = av1_lookahead_peek(
         cpi->ppi->lookahead, lookahead_idx, cpi->compressor_stage);
     assert(buf != NULL);
     frames[frame] = &buf->img;
+    display_idx[frame] = buf->display_idx;
   }
   tf_ctx->num_frames = num_frames;
   tf_ctx->filter_frame_idx = num_before;
   assert(frames[tf_ctx->filter_frame_idx] == to_filter_frame);
+  tf_setup_motion_fields(cpi, display_idx);
 
   av1_setup_src_planes(&cpi->td.mb, &to_filter_buf->img, 0, 0, num_planes,
                        cpi->common.seq_params->sb_size);
@@ -1421,8 +1511,9 @@ void av1_temporal_filter(AV1_COMP *cpi, const int filter_frame_lookahead_idx,
               compute_frame_diff, output_frame);
 
   // Allocate and reset temporal filter buffers.
-  const int is_highbitdepth = tf_ctx->is_highbitdepth;
-  if (!tf_alloc_and_reset_data(tf_data, tf_ctx->num_pels, is_highbitdepth)) {
+  const AVxArenaMark arena_mark = aom_arena_mark(&cpi->frame_arena);
+  if (!tf_alloc_and_reset_data(tf_data, &cpi->frame_arena, tf_ctx->num_pels,
+                               tf_ctx->is_highbitdepth)) {
     aom_internal_error(cpi->common.error, AOM_CODEC_MEM_ERROR,
                        "Error allocating temporal filter data");
   }
@@ -1437,7 +1528,8 @@ void av1_temporal_filter(AV1_COMP *cpi, const int filter_frame_lookahead_idx,
     *frame_diff = tf_data->diff;
   }
   // Deallocate temporal filter buffers.
-  tf_dealloc_data(tf_data, is_highbitdepth);
+  tf_dealloc_data(tf_data);
+  aom_arena_release(&cpi->frame_arena, arena_mark);
 }
 
 int av1_is_temporal_filter_on(const AV1EncoderConfig *oxcf) {
@@ -1497,6 +1589,10 @@ void av1_tf_info_filtering(TEMPORAL_FILTER_INFO *tf_info, AV1_COMP *cpi,
         av1_temporal_filter(cpi, lookahead_idx, gf_index,
                             &tf_info->frame_diff[buf_idx], out_buf);
         aom_extend_frame_borders(out_buf, av1_num_planes(cm));
+#if !CONFIG_REALTIME_ONLY
+        aom_invalidate_pyramid(out_buf->y_pyramid);
+        av1_invalidate_corner_list(out_buf->corners);
+#endif  // !CONFIG_REALTIME_ONLY
         tf_info->tf_buf_gf_index[buf_idx] = gf_index;
         tf_info->tf_buf_display_index_offset[buf_idx] = lookahead_idx;
         tf_info->tf_buf_valid[buf_idx] = 1;
@@ -14,7 +14,9 @@
 
 #include <stdbool.h>
 
+#include "aom_mem/aom_arena.h"
 #include "aom_util/aom_pthread.h"
+#include "av1/encoder/motion_field_cache.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -146,6 +148,17 @@ typedef struct {
    * Quantization factor used in temporal filtering.
    */
   int q_factor;
+  /*!
+   * Motion fields of the frame to be filtered in each frame of the buffer, in
+   * which the motion search results are stored. NULL when the motion field
+   * cache is not used.
+   */
+  MotionField *motion_fields[MAX_LAG_BUFFERS];
+  /*!
+   * Motion fields of each frame of the buffer in the frame to be filtered,
+   * found by earlier searches, or NULL.
+   */
+  const MotionField *reverse_motion_fields[MAX_LAG_BUFFERS];
 } TemporalFilterCtx;
 
 /*!
@@ -354,25 +367,26 @@ int av1_check_show_filtered_frame(const YV12_BUFFER_CONFIG *frame,
 // Allocates memory for members of TemporalFilterData.
 // Inputs:
 //   tf_data: Pointer to the structure containing temporal filter related data.
+//   arena: Arena the buffers are allocated from.
 //   num_pels: Number of pixels in the block across all planes.
 //   is_high_bitdepth: Whether the frame is high-bitdepth or not.
 // Returns:
 //   True if allocation is successful and false otherwise.
 static inline bool tf_alloc_and_reset_data(TemporalFilterData *tf_data,
-                                           int num_pels, int is_high_bitdepth) {
-  tf_data->tmp_mbmi = (MB_MODE_INFO *)aom_calloc(1, sizeof(*tf_data->tmp_mbmi));
-  tf_data->accum =
-      (uint32_t *)aom_memalign(16, num_pels * sizeof(*tf_data->accum));
-  tf_data->count =
-      (uint16_t *)aom_memalign(16, num_pels * sizeof(*tf_data->count));
+                                           AVxArena *arena, int num_pels,
+                                           int is_high_bitdepth) {
+  tf_data->tmp_mbmi =
+      (MB_MODE_INFO *)aom_arena_calloc(arena, 1, sizeof(*tf_data->tmp_mbmi));
+  tf_data->accum = (uint32_t *)aom_arena_memalign(
+      arena, 16, num_pels * sizeof(*tf_data->accum));
+  tf_data->count = (uint16_t *)aom_arena_memalign(
+      arena, 16, num_pels * sizeof(*tf_data->count));
   if (is_high_bitdepth)
     tf_data->pred = CONVERT_TO_BYTEPTR(
-        aom_memalign(32, num_pels * 2 * sizeof(*tf_data->pred)));
+        aom_arena_memalign(arena, 32, num_pels * 2 * sizeof(*tf_data->pred)));
   else
-    tf_data->pred =
-        (uint8_t *)aom_memalign(32, num_pels * sizeof(*tf_data->pred));
-  // In case of an allocation failure, other successfully allocated buffers will
-  // be freed by the tf_dealloc_data() call in encoder_destroy().
+    tf_data->pred = (uint8_t *)aom_arena_memalign(
+        arena, 32, num_pels * sizeof(*tf_data->pred));
   if (!(tf_data->tmp_mbmi && tf_data->accum && tf_data->count && tf_data->pred))
     return false;
   memset(&tf_data->diff, 0, sizeof(tf_data->diff));
@@ -395,23 +409,16 @@ static inline void tf_setup_macroblockd(MACROBLOCKD *mbd,
   mbd->mi[0]->motion_mode = SIMPLE_TRANSLATION;
 }
 
-// Deallocates the memory allocated for members of TemporalFilterData.
+// Releases the buffers of TemporalFilterData. The memory is owned by the arena
+// it was allocated from; this only clears the pointers.
 // Inputs:
 //   tf_data: Pointer to the structure containing temporal filter related data.
-//   is_high_bitdepth: Whether the frame is high-bitdepth or not.
 // Returns:
 //   Nothing will be returned.
-static inline void tf_dealloc_data(TemporalFilterData *tf_data,
-                                   int is_high_bitdepth) {
-  if (is_high_bitdepth)
-    tf_data->pred = (uint8_t *)CONVERT_TO_SHORTPTR(tf_data->pred);
-  aom_free(tf_data->tmp_mbmi);
+static inline void tf_dealloc_data(TemporalFilterData *tf_data) {
   tf_data->tmp_mbmi = NULL;
-  aom_free(tf_data->accum);
   tf_data->accum = NULL;
-  aom_free(tf_data->count);
   tf_data->count = NULL;
-  aom_free(tf_data->pred);
   tf_data->pred = NULL;
 }
 
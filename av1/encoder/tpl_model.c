@@ -11,6 +11,7 @@
 
 #include <assert.h>
 #include <float.h>
+#include <math.h>
 #include <stdint.h>
 
 #include "av1/encoder/thirdpass.h"
@@ -253,7 +254,7 @@ static uint32_t motion_estimation(AV1_COMP *cpi, MACROBLOCK *x,
                                   uint8_t *ref_frame_buf, int stride,
                                   int ref_stride, int width, int ref_width,
                                   BLOCK_SIZE bsize, MV center_mv,
-                                  int_mv *best_mv) {
+                                  int refine_only, int_mv *best_mv) {
   AV1_COMMON *cm = &cpi->common;
   MACROBLOCKD *const xd = &x->e_mbd;
   TPL_SPEED_FEATURES *tpl_sf = &cpi->sf.tpl_sf;
@@ -275,12 +276,15 @@ static uint32_t motion_estimation(AV1_COMP *cpi, MACROBLOCK *x,
 
   step_param = tpl_sf->reduce_first_step_size;
   step_param = AOMMIN(step_param, MAX_MVSEARCH_STEPS - 2);
+  // Only refine center_mv when it comes from a reliable earlier search.
+  if (refine_only) {
+    step_param = AOMMAX(step_param, MOTION_FIELD_REFINE_STEP_PARAM);
+  }
 
+  // Source frames referenced from the application may use a stride that
+  // neither cached config matches, so fall back to the per-thread config.
   const search_site_config *search_site_cfg =
-      cpi->mv_search_params.search_site_cfg[SS_CFG_SRC];
-  if (search_site_cfg->stride != ref_stride)
-    search_site_cfg = cpi->mv_search_params.search_site_cfg[SS_CFG_LOOKAHEAD];
-  assert(search_site_cfg->stride == ref_stride);
+      av1_get_search_site_config(cpi, x, tpl_sf->search_method);
 
   FULLPEL_MOTION_SEARCH_PARAMS full_ms_params;
   av1_make_default_fullpel_ms_params(&full_ms_params, cpi, x, bsize, &center_mv,
@@ -315,6 +319,34 @@ static uint32_t motion_estimation(AV1_COMP *cpi, MACROBLOCK *x,
   return bestsme;
 }
 
+// Returns the motion of the block at (mi_row, mi_col) given by the flow field
+// of the current frame in the reference frame rf_idx, at the precision of the
+// tpl motion search.
+static MV get_flow_mv(const AV1_COMP *cpi, const MACROBLOCK *x, int rf_idx,
+                      int mi_row, int mi_col, int bw, int bh) {
+  const TplParams *tpl_data = &cpi->ppi->tpl_data;
+  const ImagePyramid *src_pyr = x->e_mbd.cur_buf->y_pyramid;
+  const ImagePyramid *ref_pyr = tpl_data->src_ref_frame[rf_idx]->y_pyramid;
+  double u, v;
+  av1_get_block_flow(src_pyr, ref_pyr, tpl_data->flow[rf_idx], mi_col * MI_SIZE,
+                     mi_row * MI_SIZE, bw, bh, &u, &v);
+
+  // Round to the precision the subpel search would have stopped at.
+  int precision_log2 = cpi->sf.tpl_sf.subpel_force_stop;
+  if (!cpi->common.features.allow_high_precision_mv) {
+    precision_log2 = AOMMAX(precision_log2, QUARTER_PEL);
+  }
+  const double steps_per_pel = 8 >> precision_log2;
+  MV mv = { (int16_t)((int)round(v * steps_per_pel) << precision_log2),
+            (int16_t)((int)round(u * steps_per_pel) << precision_log2) };
+  const SubpelMvLimits mv_limits = { GET_MV_SUBPEL(x->mv_limits.col_min),
+                                     GET_MV_SUBPEL(x->mv_limits.col_max),
+                                     GET_MV_SUBPEL(x->mv_limits.row_min),
+                                     GET_MV_SUBPEL(x->mv_limits.row_max) };
+  clamp_mv(&mv, &mv_limits);
+  return mv;
+}
+
 typedef struct {
   int_mv mv;
   int sad;
@@ -712,6 +744,12 @@ static inline void mode_estimation(AV1_COMP *cpi, TplTxfmStats *tpl_txfm_stats,
   int rf_idx;
   int_mv single_mv[INTER_REFS_PER_FRAME];
 
+  // Position of the block in the motion fields.
+  const int mf_row = mi_row >> (MOTION_FIELD_BLOCK_SIZE_LOG2 - MI_SIZE_LOG2);
+  const int mf_col = mi_col >> (MOTION_FIELD_BLOCK_SIZE_LOG2 - MI_SIZE_LOG2);
+  const uint32_t reliable_err =
+      av1_motion_field_reliable_err(AOMMIN(cm->width, cm->height), xd->bd);
+
   best_mv[0].as_int = INVALID_MV;
   best_mv[1].as_int = INVALID_MV;
 
@@ -789,6 +827,33 @@ static inline void mode_estimation(AV1_COMP *cpi, TplTxfmStats *tpl_txfm_stats,
       }
     }
 
+    // The motion given by the flow field, or found by an earlier search of the
+    // frame pair, e.g. by the tpl model run for the GOP length decision, is
+    // used as is. The motion found for the reverse pair is only refined, when
+    // it is reliable.
+    const MotionFieldCache *const mf_cache = &cpi->ppi->motion_field_cache;
+    int refine_only = 0;
+    MV prior_mv;
+    uint32_t prior_err;
+    if (tpl_data->flow[rf_idx] != NULL) {
+      best_rfidx_mv.as_mv =
+          get_flow_mv(cpi, x, rf_idx, mi_row, mi_col, bw, bh);
+      refmv_count = 0;
+    } else if (av1_motion_field_lookup(mf_cache, tpl_data->motion_field[rf_idx],
+                                       NULL, mf_row, mf_col, &prior_mv,
+                                       &prior_err)) {
+      best_rfidx_mv.as_mv = prior_mv;
+      refmv_count = 0;
+    } else if (av1_motion_field_lookup(mf_cache, NULL,
+                                       tpl_data->reverse_motion_field[rf_idx],
+                                       mf_row, mf_col, &prior_mv,
+                                       &prior_err) &&
+               prior_err <= reliable_err) {
+      center_mvs[0].mv.as_mv = prior_mv;
+      refmv_count = 1;
+      refine_only = 1;
+    }
+
     // Prune starting mvs
     if (tpl_sf->prune_starting_mv && refmv_count > 1) {
       // Get each center mv's sad.
@@ -817,7 +882,7 @@ static inline void mode_estimation(AV1_COMP *cpi, TplTxfmStats *tpl_txfm_stats,
       int_mv this_mv;
       uint32_t thissme = motion_estimation(
           cpi, x, src_mb_buffer, ref_mb, src_stride, ref_stride, src_width,
-          ref_width, bsize, center_mvs[idx].mv.as_mv, &this_mv);
+          ref_width, bsize, center_mvs[idx].mv.as_mv, refine_only, &this_mv);
 
       if (thissme < bestsme) {
         bestsme = thissme;
@@ -827,6 +892,12 @@ static inline void mode_estimation(AV1_COMP *cpi, TplTxfmStats *tpl_txfm_stats,
 
     tpl_stats->mv[rf_idx].as_int = best_rfidx_mv.as_int;
     single_mv[rf_idx] = best_rfidx_mv;
+    if (refmv_count > 0) {
+      av1_motion_field_store(
+          mf_cache, tpl_data->motion_field[rf_idx], mf_row, mf_col,
+          best_rfidx_mv.as_mv,
+          ROUND_POWER_OF_TWO(bestsme, num_pels_log2_lookup[bsize]));
+    }
 
     inter_cost = get_inter_cost(
         cpi, xd, src_mb_buffer, src_stride, tpl_tmp_buffers, bsize, tx_size,
@@ -1275,6 +1346,133 @@ static inline int get_gop_length(const GF_GROUP *gf_group) {
   return gop_length;
 }
 
+// Gets the motion fields of the current frame in its reference frames from the
+// motion field cache, and those of the reference frames in the current frame
+// if the cache holds them.
+static inline void tpl_setup_motion_fields(AV1_COMP *cpi,
+                                           const TplDepFrame *tpl_frame) {
+  TplParams *const tpl_data = &cpi->ppi->tpl_data;
+  MotionFieldCache *const cache = &cpi->ppi->motion_field_cache;
+  const int width = tpl_frame->gf_picture->y_crop_width;
+  const int height = tpl_frame->gf_picture->y_crop_height;
+  // The display indices of the tpl frames count from
+  // cm->current_frame.frame_number, which is reset on key frames, while those
+  // of the cache count from the first frame.
+  const int display_offset = cpi->frame_index_set.show_frame_count -
+                             (int)cpi->common.current_frame.frame_number;
+  const int src = (int)tpl_frame->frame_display_index + display_offset;
+  int ref_display_idx[INTER_REFS_PER_FRAME];
+
+  for (int idx = 0; idx < INTER_REFS_PER_FRAME; ++idx) {
+    tpl_data->motion_field[idx] = NULL;
+    tpl_data->reverse_motion_field[idx] = NULL;
+    ref_display_idx[idx] = -1;
+  }
+  if (!cpi->sf.hl_sf.use_motion_field_cache) return;
+
+  for (int idx = 0; idx < INTER_REFS_PER_FRAME; ++idx) {
+    if (tpl_data->ref_frame[idx] == NULL ||
+        tpl_data->src_ref_frame[idx] == NULL) {
+      continue;
+    }
+    const TplDepFrame *ref_tpl_frame =
+        &tpl_data->tpl_frame[tpl_frame->ref_map_index[idx]];
+    const int ref = (int)ref_tpl_frame->frame_display_index + display_offset;
+    if (ref < 0 || ref == src) continue;
+    // Several reference frame types may refer to the same frame, the results
+    // of which are only stored once.
+    int is_duplicate = 0;
+    for (int i = 0; i < idx; ++i) is_duplicate |= ref_display_idx[i] == ref;
+    if (is_duplicate) continue;
+    ref_display_idx[idx] = ref;
+    tpl_data->motion_field[idx] =
+        av1_motion_field_cache_get(cache, width, height, src, ref);
+  }
+  for (int idx = 0; idx < INTER_REFS_PER_FRAME; ++idx) {
+    if (ref_display_idx[idx] < 0) continue;
+    tpl_data->reverse_motion_field[idx] = av1_motion_field_cache_find(
+        cache, width, height, ref_display_idx[idx], src);
+  }
+}
+
+// Returns the source frame of the reference frame idx if the flow field of the
+// current frame in it can be computed, or NULL.
+static const YV12_BUFFER_CONFIG *get_flow_ref_frame(const TplParams *tpl_data,
+                                                    int idx, int width,
+                                                    int height) {
+  const YV12_BUFFER_CONFIG *ref = tpl_data->src_ref_frame[idx];
+  if (tpl_data->ref_frame[idx] == NULL || ref == NULL ||
+      ref->y_pyramid == NULL || ref->y_crop_width != width ||
+      ref->y_crop_height != height) {
+    return NULL;
+  }
+  return ref;
+}
+
+// Computes the flow fields of the current frame in its reference frames when
+// tpl_sf.use_flow_for_motion is set and the frames have image pyramids.
+static inline void tpl_setup_flow_fields(AV1_COMP *cpi,
+                                         const TplDepFrame *tpl_frame) {
+  TplParams *const tpl_data = &cpi->ppi->tpl_data;
+  const YV12_BUFFER_CONFIG *src = tpl_frame->gf_picture;
+  const int width = src->y_crop_width;
+  const int height = src->y_crop_height;
+
+  for (int idx = 0; idx < INTER_REFS_PER_FRAME; ++idx) {
+    tpl_data->flow[idx] = NULL;
+  }
+  if (!cpi->sf.tpl_sf.use_flow_for_motion || src->y_pyramid == NULL ||
+      AOMMIN(width, height) < DISFLOW_PATCH_SIZE) {
+    return;
+  }
+
+  // The pyramids are kept with the frames, so that global motion search and
+  // later tpl runs reuse them. Compute those still missing on the workers.
+  if (cpi->mt_info.num_workers > 1) {
+    const YV12_BUFFER_CONFIG *frames[MAX_PYRAMID_FRAMES_MT];
+    int num_frames = 0;
+    frames[num_frames++] = src;
+    for (int idx = 0; idx < INTER_REFS_PER_FRAME; ++idx) {
+      const YV12_BUFFER_CONFIG *ref =
+          get_flow_ref_frame(tpl_data, idx, width, height);
+      if (ref != NULL) frames[num_frames++] = ref;
+    }
+    av1_compute_pyramids_mt(cpi, frames, num_frames, DISFLOW_PYRAMID_LEVELS);
+  }
+
+  for (int idx = 0; idx < INTER_REFS_PER_FRAME; ++idx) {
+    const YV12_BUFFER_CONFIG *ref =
+        get_flow_ref_frame(tpl_data, idx, width, height);
+    if (ref == NULL) continue;
+    // Several reference frame types may refer to the same frame.
+    for (int i = 0; i < idx; ++i) {
+      if (tpl_data->flow[i] != NULL && tpl_data->src_ref_frame[i] == ref) {
+        tpl_data->flow[idx] = tpl_data->flow[i];
+      }
+    }
+    if (tpl_data->flow[idx] != NULL) continue;
+
+    FlowField *flow = tpl_data->flow_buf[idx];
+    if (flow != NULL &&
+        (flow->width != width >> DISFLOW_FLOW_BLOCK_SIZE_LOG2 ||
+         flow->height != height >> DISFLOW_FLOW_BLOCK_SIZE_LOG2)) {
+      av1_free_flow_field(flow);
+      flow = NULL;
+    }
+    if (flow == NULL) {
+      flow = av1_alloc_flow_field(width, height);
+      tpl_data->flow_buf[idx] = flow;
+    }
+    if (flow == NULL ||
+        !av1_compute_flow_field(src, ref, cpi->common.seq_params->bit_depth,
+                                flow)) {
+      aom_internal_error(cpi->common.error, AOM_CODEC_MEM_ERROR,
+                         "Error computing tpl flow field");
+    }
+    tpl_data->flow[idx] = flow;
+  }
+}
+
 // Initialize the mc_flow parameters used in computing tpl data.
 static inline void init_mc_flow_dispenser(AV1_COMP *cpi, int frame_idx,
                                           int pframe_qindex) {
@@ -1355,6 +1553,9 @@ static inline void init_mc_flow_dispenser(AV1_COMP *cpi, int frame_idx,
     }
   }
 
+  tpl_setup_motion_fields(cpi, tpl_frame);
+  tpl_setup_flow_fields(cpi, tpl_frame);
+
   // Make a temporary mbmi for tpl model
   MB_MODE_INFO mbmi;
   memset(&mbmi, 0, sizeof(mbmi));
@@ -1846,7 +2047,9 @@ int av1_tpl_setup_stats(AV1_COMP *cpi, int gop_eval,
   av1_init_tpl_stats(tpl_data);
 
   TplBuffers *tpl_tmp_buffers = &cpi->td.tpl_tmp_buffers;
-  if (!tpl_alloc_temp_buffers(tpl_tmp_buffers, tpl_data->tpl_bsize_1d)) {
+  const AVxArenaMark arena_mark = aom_arena_mark(&cpi->gop_arena);
+  if (!tpl_alloc_temp_buffers(tpl_tmp_buffers, &cpi->gop_arena,
+                              tpl_data->tpl_bsize_1d)) {
     aom_internal_error(cpi->common.error, AOM_CODEC_MEM_ERROR,
                        "Error allocating tpl data");
   }
@@ -1934,6 +2137,7 @@ int av1_tpl_setup_stats(AV1_COMP *cpi, int gop_eval,
 #endif
 
   tpl_dealloc_temp_buffers(tpl_tmp_buffers);
+  aom_arena_release(&cpi->gop_arena, arena_mark);
 
   if (!approx_gop_eval) {
     tpl_data->ready = 1;
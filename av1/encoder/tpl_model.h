@@ -29,13 +29,17 @@ struct TPL_INFO;
 
 #include "config/aom_config.h"
 
+#include "aom_mem/aom_arena.h"
 #include "aom_scale/yv12config.h"
+#include "aom_util/aom_progress.h"
 #include "aom_util/aom_pthread.h"
 
 #include "av1/common/mv.h"
 #include "av1/common/scale.h"
 #include "av1/encoder/block.h"
 #include "av1/encoder/lookahead.h"
+#include "aom_dsp/flow_estimation/disflow.h"
+#include "av1/encoder/motion_field_cache.h"
 #include "av1/encoder/ratectrl.h"
 
 static inline BLOCK_SIZE convert_length_to_bsize(int length) {
@@ -52,15 +56,10 @@ static inline BLOCK_SIZE convert_length_to_bsize(int length) {
 }
 
 typedef struct AV1TplRowMultiThreadSync {
-#if CONFIG_MULTITHREAD
-  // Synchronization objects for top-right dependency.
-  pthread_mutex_t *mutex_;
-  pthread_cond_t *cond_;
-#endif
   // Buffer to store the macroblock whose encoding is complete.
   // num_finished_cols[i] stores the number of macroblocks which finished
-  // encoding in the ith macroblock row.
-  int *num_finished_cols;
+  // encoding in the ith macroblock row. Used for the top-right dependency.
+  AVxProgress *num_finished_cols;
   // Number of extra macroblocks of the top row to be complete for encoding
   // of the current macroblock to start. A value of 1 indicates top-right
   // dependency.
@@ -235,6 +234,30 @@ typedef struct TplParams {
    */
   const YV12_BUFFER_CONFIG *ref_frame[INTER_REFS_PER_FRAME];
 
+  /*!
+   * Motion fields of the current frame in each reference frame, in which the
+   * motion search results are stored. NULL when the motion field cache is not
+   * used.
+   */
+  MotionField *motion_field[INTER_REFS_PER_FRAME];
+
+  /*!
+   * Motion fields of each reference frame in the current frame, found by
+   * earlier searches, or NULL.
+   */
+  const MotionField *reverse_motion_field[INTER_REFS_PER_FRAME];
+
+  /*!
+   * Dense flow fields of the current frame in each reference frame, which give
+   * the motion of the blocks when tpl_sf.use_flow_for_motion is set, or NULL.
+   */
+  const FlowField *flow[INTER_REFS_PER_FRAME];
+
+  /*!
+   * Buffers of the flow fields, allocated on first use.
+   */
+  FlowField *flow_buf[INTER_REFS_PER_FRAME];
+
   /*!
    * Parameters related to synchronization for top-right dependency in row based
    * multi-threading of tpl
@@ -416,35 +439,33 @@ void av1_setup_tpl_buffers(struct AV1_PRIMARY *const ppi,
                            CommonModeInfoParams *const mi_params, int width,
                            int height, int byte_alignment, int lag_in_frames);
 
+// The buffers are owned by the arena they were allocated from; this only
+// clears the pointers.
 static inline void tpl_dealloc_temp_buffers(TplBuffers *tpl_tmp_buffers) {
-  aom_free(tpl_tmp_buffers->predictor8);
   tpl_tmp_buffers->predictor8 = NULL;
-  aom_free(tpl_tmp_buffers->src_diff);
   tpl_tmp_buffers->src_diff = NULL;
-  aom_free(tpl_tmp_buffers->coeff);
   tpl_tmp_buffers->coeff = NULL;
-  aom_free(tpl_tmp_buffers->qcoeff);
   tpl_tmp_buffers->qcoeff = NULL;
-  aom_free(tpl_tmp_buffers->dqcoeff);
   tpl_tmp_buffers->dqcoeff = NULL;
 }
 
 static inline bool tpl_alloc_temp_buffers(TplBuffers *tpl_tmp_buffers,
+                                          AVxArena *arena,
                                           uint8_t tpl_bsize_1d) {
   // Number of pixels in a tpl block
   const int tpl_block_pels = tpl_bsize_1d * tpl_bsize_1d;
 
   // Allocate temporary buffers used in mode estimation.
-  tpl_tmp_buffers->predictor8 = (uint8_t *)aom_memalign(
-      32, tpl_block_pels * 2 * sizeof(*tpl_tmp_buffers->predictor8));
-  tpl_tmp_buffers->src_diff = (int16_t *)aom_memalign(
-      32, tpl_block_pels * sizeof(*tpl_tmp_buffers->src_diff));
-  tpl_tmp_buffers->coeff = (tran_low_t *)aom_memalign(
-      32, tpl_block_pels * sizeof(*tpl_tmp_buffers->coeff));
-  tpl_tmp_buffers->qcoeff = (tran_low_t *)aom_memalign(
-      32, tpl_block_pels * sizeof(*tpl_tmp_buffers->qcoeff));
-  tpl_tmp_buffers->dqcoeff = (tran_low_t *)aom_memalign(
-      32, tpl_block_pels * sizeof(*tpl_tmp_buffers->dqcoeff));
+  tpl_tmp_buffers->predictor8 = (uint8_t *)aom_arena_memalign(
+      arena, 32, tpl_block_pels * 2 * sizeof(*tpl_tmp_buffers->predictor8));
+  tpl_tmp_buffers->src_diff = (int16_t *)aom_arena_memalign(
+      arena, 32, tpl_block_pels * sizeof(*tpl_tmp_buffers->src_diff));
+  tpl_tmp_buffers->coeff = (tran_low_t *)aom_arena_memalign(
+      arena, 32, tpl_block_pels * sizeof(*tpl_tmp_buffers->coeff));
+  tpl_tmp_buffers->qcoeff = (tran_low_t *)aom_arena_memalign(
+      arena, 32, tpl_block_pels * sizeof(*tpl_tmp_buffers->qcoeff));
+  tpl_tmp_buffers->dqcoeff = (tran_low_t *)aom_arena_memalign(
+      arena, 32, tpl_block_pels * sizeof(*tpl_tmp_buffers->dqcoeff));
 
   if (!(tpl_tmp_buffers->predictor8 && tpl_tmp_buffers->src_diff &&
         tpl_tmp_buffers->coeff && tpl_tmp_buffers->qcoeff &&
@@ -9,6 +9,7 @@
  * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
  */
 
+#include "aom_ports/aom_once.h"
 #include "av1/common/cfl.h"
 #include "av1/common/reconintra.h"
 #include "av1/encoder/block.h"
@@ -1475,10 +1476,36 @@ static inline void unset_bit_mask(uint16_t *mask, int val) {
   *mask &= ~(1 << val);
 }
 
+#if !CONFIG_NN_V2
+// Fixed-point versions of the models of prune_tx_2D(), indexed by TX_SIZE.
+static NN_CONFIG_Q tx_type_nnconfig_q_hor[TX_SIZES_ALL];
+static NN_CONFIG_Q tx_type_nnconfig_q_ver[TX_SIZES_ALL];
+
+static void init_tx_nn_models(void) {
+  // A model which fails to be quantized is evaluated in floating point.
+  for (int tx_size = 0; tx_size < TX_SIZES_ALL; ++tx_size) {
+    if (av1_tx_type_nnconfig_map_hor[tx_size] != NULL) {
+      av1_nn_quantize(av1_tx_type_nnconfig_map_hor[tx_size],
+                      &tx_type_nnconfig_q_hor[tx_size]);
+    }
+    if (av1_tx_type_nnconfig_map_ver[tx_size] != NULL) {
+      av1_nn_quantize(av1_tx_type_nnconfig_map_ver[tx_size],
+                      &tx_type_nnconfig_q_ver[tx_size]);
+    }
+  }
+}
+#endif  // !CONFIG_NN_V2
+
+void av1_init_tx_nn_models(void) {
+#if !CONFIG_NN_V2
+  aom_once(init_tx_nn_models);
+#endif
+}
+
 static void prune_tx_2D(MACROBLOCK *x, BLOCK_SIZE bsize, TX_SIZE tx_size,
                         int blk_row, int blk_col, TxSetType tx_set_type,
                         TX_TYPE_PRUNE_MODE prune_2d_txfm_mode, int *txk_map,
-                        uint16_t *allowed_tx_mask) {
+                        uint16_t *allowed_tx_mask, int use_quantized_nn) {
   // This table is used because the search order is different from the enum
   // order.
   static const int tx_type_table_2D[16] = {
@@ -1520,11 +1547,16 @@ static void prune_tx_2D(MACROBLOCK *x, BLOCK_SIZE bsize, TX_SIZE tx_size,
                                   &vfeatures[vfeatures_num - 1]);
 
 #if CONFIG_NN_V2
+  (void)use_quantized_nn;
   av1_nn_predict_v2(hfeatures, nn_config_hor, 0, hscores);
   av1_nn_predict_v2(vfeatures, nn_config_ver, 0, vscores);
 #else
-  av1_nn_predict(hfeatures, nn_config_hor, 1, hscores);
-  av1_nn_predict(vfeatures, nn_config_ver, 1, vscores);
+  av1_nn_predict_select(hfeatures, nn_config_hor,
+                        &tx_type_nnconfig_q_hor[tx_size], use_quantized_nn, 1,
+                        hscores);
+  av1_nn_predict_select(vfeatures, nn_config_ver,
+                        &tx_type_nnconfig_q_ver[tx_size], use_quantized_nn, 1,
+                        vscores);
 #endif
 
   for (int i = 0; i < 4; i++) {
@@ -1868,7 +1900,8 @@ static inline uint16_t get_tx_mask(
       if (txfm_params->prune_2d_txfm_mode >= TX_TYPE_PRUNE_1 && is_inter &&
           num_allowed > allowed_tx_count) {
         prune_tx_2D(x, plane_bsize, tx_size, blk_row, blk_col, tx_set_type,
-                    txfm_params->prune_2d_txfm_mode, txk_map, &allowed_tx_mask);
+                    txfm_params->prune_2d_txfm_mode, txk_map, &allowed_tx_mask,
+                    cpi->sf.hl_sf.use_quantized_nn);
       }
     }
   }
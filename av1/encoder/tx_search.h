@@ -219,6 +219,14 @@ int av1_txfm_search(const AV1_COMP *cpi, MACROBLOCK *x, BLOCK_SIZE bsize,
                     RD_STATS *rd_stats, RD_STATS *rd_stats_y,
                     RD_STATS *rd_stats_uv, int mode_rate, int64_t ref_best_rd);
 
+/*!\brief Sets up the fixed-point transform type pruning models.
+ *
+ * \ingroup transform_search
+ * Quantizes the models used to prune 2D transform types when
+ * sf->hl_sf.use_quantized_nn is set. Only the first call has an effect.
+ */
+void av1_init_tx_nn_models(void);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
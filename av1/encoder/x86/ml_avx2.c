@@ -238,3 +238,175 @@ void av1_nn_predict_avx2(const float *input_nodes,
   }
   if (reduce_prec) av1_nn_output_prec_reduce(output, nn_config->num_outputs);
 }
+
+// Returns the products of the 16 weights with the 16 input nodes, summed in
+// pairs.
+static inline __m256i madd_16(const int8_t *weights, const __m256i input) {
+  const __m256i w =
+      _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)weights));
+  return _mm256_madd_epi16(w, input);
+}
+
+void av1_nn_fc_q_avx2(const int16_t *input, const int8_t *weights,
+                      int weights_stride, int num_outputs, int32_t *output) {
+  assert(weights_stride % NN_Q_INPUT_ALIGN == 0);
+  int node = 0;
+  // Four nodes at a time.
+  for (; node + 4 <= num_outputs; node += 4) {
+    const int8_t *const w = weights + node * weights_stride;
+    __m256i sum0 = _mm256_setzero_si256();
+    __m256i sum1 = _mm256_setzero_si256();
+    __m256i sum2 = _mm256_setzero_si256();
+    __m256i sum3 = _mm256_setzero_si256();
+    for (int i = 0; i < weights_stride; i += 16) {
+      const __m256i in = _mm256_loadu_si256((const __m256i *)(input + i));
+      sum0 = _mm256_add_epi32(sum0, madd_16(w + i, in));
+      sum1 = _mm256_add_epi32(sum1, madd_16(w + weights_stride + i, in));
+      sum2 = _mm256_add_epi32(sum2, madd_16(w + 2 * weights_stride + i, in));
+      sum3 = _mm256_add_epi32(sum3, madd_16(w + 3 * weights_stride + i, in));
+    }
+    const __m256i sum01 = _mm256_hadd_epi32(sum0, sum1);
+    const __m256i sum23 = _mm256_hadd_epi32(sum2, sum3);
+    const __m256i sum = _mm256_hadd_epi32(sum01, sum23);
+    const __m128i res = _mm_add_epi32(_mm256_castsi256_si128(sum),
+                                      _mm256_extracti128_si256(sum, 1));
+    _mm_storeu_si128((__m128i *)(output + node), res);
+  }
+  for (; node < num_outputs; ++node) {
+    const int8_t *const w = weights + node * weights_stride;
+    __m256i sum = _mm256_setzero_si256();
+    for (int i = 0; i < weights_stride; i += 16) {
+      const __m256i in = _mm256_loadu_si256((const __m256i *)(input + i));
+      sum = _mm256_add_epi32(sum, madd_16(w + i, in));
+    }
+    __m128i res = _mm_add_epi32(_mm256_castsi256_si128(sum),
+                                _mm256_extracti128_si256(sum, 1));
+    res = _mm_hadd_epi32(res, res);
+    res = _mm_hadd_epi32(res, res);
+    output[node] = _mm_cvtsi128_si32(res);
+  }
+}
+
+// Loads the n < 8 first floats of p, and zeroes the other lanes.
+static inline __m256 load_partial_ps(const float *p, int n) {
+  static const int32_t kMask[16] = { -1, -1, -1, -1, -1, -1, -1, -1,
+                                     0,  0,  0,  0,  0,  0,  0,  0 };
+  const __m256i mask = _mm256_loadu_si256((const __m256i *)(kMask + 8 - n));
+  return _mm256_maskload_ps(p, mask);
+}
+
+// Returns the sums of the lanes of a0, a1, a2 and a3.
+static inline __m128 hadd_4x8_ps(__m256 a0, __m256 a1, __m256 a2, __m256 a3) {
+  const __m256 sum01 = _mm256_hadd_ps(a0, a1);
+  const __m256 sum23 = _mm256_hadd_ps(a2, a3);
+  const __m256 sum = _mm256_hadd_ps(sum01, sum23);
+  return _mm_add_ps(_mm256_castps256_ps128(sum),
+                    _mm256_extractf128_ps(sum, 1));
+}
+
+static inline float hadd_8_ps(__m256 a) {
+  __m128 sum =
+      _mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+  sum = _mm_hadd_ps(sum, sum);
+  sum = _mm_hadd_ps(sum, sum);
+  return _mm_cvtss_f32(sum);
+}
+
+// Computes nodes node to node + 3 of 2 samples at a time, so that each load
+// of input is used for 4 nodes and each load of weights for 2 samples, with 8
+// accumulators.
+static inline void nn_fc_2x4(const float *input, int num_inputs,
+                             const float *weights, const float *bias, int node,
+                             int num_outputs, int relu, float *output) {
+  const float *const in0 = input;
+  const float *const in1 = input + num_inputs;
+  const float *const w0 = weights + node * num_inputs;
+  const float *const w1 = w0 + num_inputs;
+  const float *const w2 = w1 + num_inputs;
+  const float *const w3 = w2 + num_inputs;
+  __m256 acc00 = _mm256_setzero_ps(), acc01 = _mm256_setzero_ps();
+  __m256 acc02 = _mm256_setzero_ps(), acc03 = _mm256_setzero_ps();
+  __m256 acc10 = _mm256_setzero_ps(), acc11 = _mm256_setzero_ps();
+  __m256 acc12 = _mm256_setzero_ps(), acc13 = _mm256_setzero_ps();
+  for (int i = 0; i < num_inputs; i += 8) {
+    const int n = num_inputs - i;
+    __m256 x0, x1, y0, y1, y2, y3;
+    if (n >= 8) {
+      x0 = _mm256_loadu_ps(in0 + i);
+      x1 = _mm256_loadu_ps(in1 + i);
+      y0 = _mm256_loadu_ps(w0 + i);
+      y1 = _mm256_loadu_ps(w1 + i);
+      y2 = _mm256_loadu_ps(w2 + i);
+      y3 = _mm256_loadu_ps(w3 + i);
+    } else {
+      x0 = load_partial_ps(in0 + i, n);
+      x1 = load_partial_ps(in1 + i, n);
+      y0 = load_partial_ps(w0 + i, n);
+      y1 = load_partial_ps(w1 + i, n);
+      y2 = load_partial_ps(w2 + i, n);
+      y3 = load_partial_ps(w3 + i, n);
+    }
+    acc00 = _mm256_add_ps(acc00, _mm256_mul_ps(x0, y0));
+    acc01 = _mm256_add_ps(acc01, _mm256_mul_ps(x0, y1));
+    acc02 = _mm256_add_ps(acc02, _mm256_mul_ps(x0, y2));
+    acc03 = _mm256_add_ps(acc03, _mm256_mul_ps(x0, y3));
+    acc10 = _mm256_add_ps(acc10, _mm256_mul_ps(x1, y0));
+    acc11 = _mm256_add_ps(acc11, _mm256_mul_ps(x1, y1));
+    acc12 = _mm256_add_ps(acc12, _mm256_mul_ps(x1, y2));
+    acc13 = _mm256_add_ps(acc13, _mm256_mul_ps(x1, y3));
+  }
+  const __m128 b = _mm_loadu_ps(bias + node);
+  __m128 out0 = _mm_add_ps(hadd_4x8_ps(acc00, acc01, acc02, acc03), b);
+  __m128 out1 = _mm_add_ps(hadd_4x8_ps(acc10, acc11, acc12, acc13), b);
+  if (relu) {
+    out0 = _mm_max_ps(out0, _mm_setzero_ps());
+    out1 = _mm_max_ps(out1, _mm_setzero_ps());
+  }
+  _mm_storeu_ps(output + node, out0);
+  _mm_storeu_ps(output + num_outputs + node, out1);
+}
+
+// Computes one node of one sample.
+static inline float nn_fc_1x1(const float *input, int num_inputs,
+                              const float *node_weights, float bias,
+                              int relu) {
+  __m256 acc = _mm256_setzero_ps();
+  for (int i = 0; i < num_inputs; i += 8) {
+    const int n = num_inputs - i;
+    const __m256 x = n >= 8 ? _mm256_loadu_ps(input + i)
+                            : load_partial_ps(input + i, n);
+    const __m256 y = n >= 8 ? _mm256_loadu_ps(node_weights + i)
+                            : load_partial_ps(node_weights + i, n);
+    acc = _mm256_add_ps(acc, _mm256_mul_ps(x, y));
+  }
+  const float val = bias + hadd_8_ps(acc);
+  return relu ? AOMMAX(val, 0.0f) : val;
+}
+
+void av1_nn_fc_batch_avx2(const float *input, int num_samples, int num_inputs,
+                          const float *weights, const float *bias,
+                          int num_outputs, int relu, float *output) {
+  int sample = 0;
+  for (; sample + 2 <= num_samples; sample += 2) {
+    int node = 0;
+    for (; node + 4 <= num_outputs; node += 4) {
+      nn_fc_2x4(input, num_inputs, weights, bias, node, num_outputs, relu,
+                output);
+    }
+    for (; node < num_outputs; ++node) {
+      const float *const node_weights = weights + node * num_inputs;
+      output[node] =
+          nn_fc_1x1(input, num_inputs, node_weights, bias[node], relu);
+      output[num_outputs + node] = nn_fc_1x1(
+          input + num_inputs, num_inputs, node_weights, bias[node], relu);
+    }
+    input += 2 * num_inputs;
+    output += 2 * num_outputs;
+  }
+  if (sample < num_samples) {
+    for (int node = 0; node < num_outputs; ++node) {
+      output[node] = nn_fc_1x1(input, num_inputs, weights + node * num_inputs,
+                               bias[node], relu);
+    }
+  }
+}
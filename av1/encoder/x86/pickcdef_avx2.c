@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <immintrin.h>
+
+#include "config/av1_rtcd.h"
+#include "aom_dsp/aom_dsp_common.h"
+
+void av1_cdef_add_best_mse_avx2(uint64_t *tot_mse, const uint64_t *mse,
+                                uint64_t offset, uint64_t best_mse, int n) {
+  // AVX2 only has a signed 64-bit comparison: flipping the sign bit of both
+  // operands turns it into an unsigned one.
+  const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+  const __m256i offset_v = _mm256_set1_epi64x((int64_t)offset);
+  const __m256i best_v = _mm256_set1_epi64x((int64_t)best_mse);
+  const __m256i best_s = _mm256_xor_si256(best_v, sign);
+  int k = 0;
+  for (; k + 4 <= n; k += 4) {
+    const __m256i curr = _mm256_add_epi64(
+        _mm256_loadu_si256((const __m256i *)(mse + k)), offset_v);
+    const __m256i gt =
+        _mm256_cmpgt_epi64(_mm256_xor_si256(curr, sign), best_s);
+    const __m256i min = _mm256_blendv_epi8(curr, best_v, gt);
+    const __m256i tot = _mm256_loadu_si256((const __m256i *)(tot_mse + k));
+    _mm256_storeu_si256((__m256i *)(tot_mse + k), _mm256_add_epi64(tot, min));
+  }
+  for (; k < n; k++) {
+    const uint64_t curr = offset + mse[k];
+    tot_mse[k] += AOMMIN(curr, best_mse);
+  }
+}
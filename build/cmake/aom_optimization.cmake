@@ -22,9 +22,12 @@ function(get_msvc_intrinsic_flag flag translated_flag)
     set(${translated_flag} "/arch:AVX" PARENT_SCOPE)
   elseif("${flag}" STREQUAL "-mavx2")
     set(${translated_flag} "/arch:AVX2" PARENT_SCOPE)
+  elseif("${flag}" STREQUAL "${AOM_AVX512_INTRIN_FLAG}")
+    set(${translated_flag} "/arch:AVX512" PARENT_SCOPE)
   else()
 
-    # MSVC does not need flags for intrinsics flavors other than AVX/AVX2.
+    # MSVC does not need flags for intrinsics flavors other than AVX/AVX2/
+    # AVX-512.
     unset(${translated_flag} PARENT_SCOPE)
   endif()
 endfunction()
@@ -120,7 +120,29 @@ elseif("${AOM_TARGET_CPU}" MATCHES "^x86")
     set(RTCD_ARCH_X86_64 "yes")
   endif()
 
-  set(X86_FLAVORS "MMX;SSE;SSE2;SSE3;SSSE3;SSE4_1;SSE4_2;AVX;AVX2")
+  set(X86_FLAVORS "MMX;SSE;SSE2;SSE3;SSSE3;SSE4_1;SSE4_2;AVX;AVX2;AVX512")
+  # The AVX-512 kernels use the F, CD, BW, DQ and VL subsets, which are all
+  # available on the CPUs that support AVX-512 for integer SIMD.
+  set(AOM_AVX512_INTRIN_FLAG
+      "-mavx512f -mavx512cd -mavx512bw -mavx512dq -mavx512vl")
+
+  # Older compilers may not support the AVX-512 intrinsics.
+  if(ENABLE_AVX512 AND NOT MSVC)
+    set(OLD_CMAKE_REQURED_FLAGS ${CMAKE_REQUIRED_FLAGS})
+    set(CMAKE_REQUIRED_FLAGS
+        "${CMAKE_REQUIRED_FLAGS} ${AOM_AVX512_INTRIN_FLAG}")
+    unset(FLAG_SUPPORTED)
+    aom_check_source_compiles("x86_avx512_available" "
+#include <immintrin.h>
+__m512i function(__m512i a, __m512i b) {
+  return _mm512_sad_epu8(_mm512_abs_epi16(a), b)\;
+}" FLAG_SUPPORTED)
+    set(CMAKE_REQUIRED_FLAGS ${OLD_CMAKE_REQURED_FLAGS})
+    if(NOT ${FLAG_SUPPORTED})
+      set(ENABLE_AVX512 0)
+    endif()
+  endif()
+
   foreach(flavor ${X86_FLAVORS})
     if(ENABLE_${flavor} AND NOT disable_remaining_flavors)
       set(HAVE_${flavor} 1)
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include "common/async_writer.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config/aom_config.h"
+
+#include "aom_util/aom_pthread.h"
+
+typedef struct AsyncWriterPacket {
+  struct AsyncWriterPacket *next;
+  aom_codec_cx_pkt_t pkt;
+  // The frame data follows.
+} AsyncWriterPacket;
+
+struct AsyncWriter {
+  async_writer_write_fn write;
+  void *priv;
+  size_t max_queued_bytes;
+
+#if CONFIG_MULTITHREAD
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  // Signaled when a packet is queued, written or when the writer stops.
+  pthread_cond_t cond;
+  int thread_created;
+  AsyncWriterPacket *head;
+  AsyncWriterPacket *tail;
+  size_t queued_bytes;
+  // Whether the thread is writing a packet it has taken off the queue.
+  int busy;
+  int stop;
+#endif  // CONFIG_MULTITHREAD
+};
+
+#if CONFIG_MULTITHREAD
+static THREADFN writer_loop(void *arg) {
+  AsyncWriter *const writer = (AsyncWriter *)arg;
+  for (;;) {
+    pthread_mutex_lock(&writer->mutex);
+    while (writer->head == NULL && !writer->stop) {
+      pthread_cond_wait(&writer->cond, &writer->mutex);
+    }
+    AsyncWriterPacket *const packet = writer->head;
+    if (packet == NULL) {
+      pthread_mutex_unlock(&writer->mutex);
+      break;
+    }
+    writer->head = packet->next;
+    if (writer->head == NULL) writer->tail = NULL;
+    writer->busy = 1;
+    pthread_mutex_unlock(&writer->mutex);
+
+    writer->write(writer->priv, &packet->pkt);
+
+    pthread_mutex_lock(&writer->mutex);
+    writer->queued_bytes -= packet->pkt.data.frame.sz;
+    writer->busy = 0;
+    pthread_cond_broadcast(&writer->cond);
+    pthread_mutex_unlock(&writer->mutex);
+    free(packet);
+  }
+  return THREAD_EXIT_SUCCESS;
+}
+#endif  // CONFIG_MULTITHREAD
+
+AsyncWriter *async_writer_create(async_writer_write_fn write, void *priv,
+                                 size_t max_queued_bytes) {
+  AsyncWriter *const writer = (AsyncWriter *)calloc(1, sizeof(*writer));
+  if (writer == NULL) return NULL;
+  writer->write = write;
+  writer->priv = priv;
+  writer->max_queued_bytes = max_queued_bytes;
+#if CONFIG_MULTITHREAD
+  if (pthread_mutex_init(&writer->mutex, NULL)) {
+    free(writer);
+    return NULL;
+  }
+  if (pthread_cond_init(&writer->cond, NULL)) {
+    pthread_mutex_destroy(&writer->mutex);
+    free(writer);
+    return NULL;
+  }
+  // Fall back to writing synchronously if the thread cannot be started.
+  writer->thread_created =
+      !pthread_create(&writer->thread, NULL, writer_loop, writer);
+#endif  // CONFIG_MULTITHREAD
+  return writer;
+}
+
+int async_writer_push(AsyncWriter *writer, const aom_codec_cx_pkt_t *pkt) {
+  assert(pkt->kind == AOM_CODEC_CX_FRAME_PKT);
+#if CONFIG_MULTITHREAD
+  if (writer->thread_created) {
+    const size_t sz = pkt->data.frame.sz;
+    AsyncWriterPacket *const packet =
+        (AsyncWriterPacket *)malloc(sizeof(*packet) + sz);
+    if (packet == NULL) return -1;
+    packet->next = NULL;
+    packet->pkt = *pkt;
+    packet->pkt.data.frame.buf = packet + 1;
+    if (sz > 0) memcpy(packet + 1, pkt->data.frame.buf, sz);
+
+    pthread_mutex_lock(&writer->mutex);
+    // Always accept a packet into an empty queue, however large it is.
+    while (writer->queued_bytes > 0 &&
+           writer->queued_bytes + sz > writer->max_queued_bytes) {
+      pthread_cond_wait(&writer->cond, &writer->mutex);
+    }
+    if (writer->tail)
+      writer->tail->next = packet;
+    else
+      writer->head = packet;
+    writer->tail = packet;
+    writer->queued_bytes += sz;
+    pthread_cond_broadcast(&writer->cond);
+    pthread_mutex_unlock(&writer->mutex);
+    return 0;
+  }
+#endif  // CONFIG_MULTITHREAD
+  writer->write(writer->priv, pkt);
+  return 0;
+}
+
+void async_writer_flush(AsyncWriter *writer) {
+#if CONFIG_MULTITHREAD
+  if (!writer->thread_created) return;
+  pthread_mutex_lock(&writer->mutex);
+  while (writer->head != NULL || writer->busy) {
+    pthread_cond_wait(&writer->cond, &writer->mutex);
+  }
+  pthread_mutex_unlock(&writer->mutex);
+#else
+  (void)writer;
+#endif  // CONFIG_MULTITHREAD
+}
+
+void async_writer_destroy(AsyncWriter *writer) {
+  if (writer == NULL) return;
+#if CONFIG_MULTITHREAD
+  if (writer->thread_created) {
+    // The thread drains the queue before it exits.
+    pthread_mutex_lock(&writer->mutex);
+    writer->stop = 1;
+    pthread_cond_broadcast(&writer->cond);
+    pthread_mutex_unlock(&writer->mutex);
+    pthread_join(writer->thread, NULL);
+  }
+  pthread_cond_destroy(&writer->cond);
+  pthread_mutex_destroy(&writer->mutex);
+#endif  // CONFIG_MULTITHREAD
+  free(writer);
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+#ifndef AOM_COMMON_ASYNC_WRITER_H_
+#define AOM_COMMON_ASYNC_WRITER_H_
+
+#include <stddef.h>
+
+#include "aom/aom_encoder.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Hands encoded frame packets to a background thread, which passes them to a
+// write function in the order they were queued. The queue holds at most
+// max_queued_bytes of frame data, so a slow output device stalls the encoder
+// only once the queue is full. Without thread support, packets are written
+// when they are queued.
+typedef struct AsyncWriter AsyncWriter;
+
+typedef void (*async_writer_write_fn)(void *priv,
+                                      const aom_codec_cx_pkt_t *pkt);
+
+AsyncWriter *async_writer_create(async_writer_write_fn write, void *priv,
+                                 size_t max_queued_bytes);
+
+// Queues a copy of pkt, which must be an AOM_CODEC_CX_FRAME_PKT, blocking while
+// the queue is full. Returns 0 on success, or -1 if the copy cannot be
+// allocated.
+int async_writer_push(AsyncWriter *writer, const aom_codec_cx_pkt_t *pkt);
+
+// Waits until every queued packet has been written.
+void async_writer_flush(AsyncWriter *writer);
+
+// Flushes the writer and frees it.
+void async_writer_destroy(AsyncWriter *writer);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AOM_COMMON_ASYNC_WRITER_H_
@@ -0,0 +1,374 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+// Expose posix_madvise(), fileno() and ftello() in strict C modes. This must be
+// before any #include statements.
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "common/input_prefetch.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config/aom_config.h"
+
+#include "aom_util/aom_pthread.h"
+#include "common/y4minput.h"
+
+#if HAVE_UNISTD_H && !defined(_WIN32)
+#define INPUT_PREFETCH_MMAP 1
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define INPUT_PREFETCH_MMAP 0
+#endif
+
+// Number of frames the reader thread may get ahead of the encoder, counting
+// the frame the encoder holds.
+#define PREFETCH_FRAMES 4
+
+typedef struct {
+  // The frame as returned to the caller.
+  aom_image_t img;
+  // Raw input: the image read_yuv_frame() fills in.
+  aom_image_t raw;
+  // Y4M input: the buffers y4m_input_fetch_frame_into() fills in.
+  unsigned char *dst;
+  unsigned char *aux;
+  // Input offset just past this frame.
+  int64_t pos;
+} PrefetchFrame;
+
+struct InputPrefetch {
+  struct AvxInputContext *input_ctx;
+  int64_t pos;
+
+  // Memory-mapped input.
+  unsigned char *map;
+  size_t map_size;
+  size_t offset;
+  size_t frame_size;
+  aom_image_t layout;
+
+#if CONFIG_MULTITHREAD
+  // Read-ahead thread. The thread fills frames[num_read % PREFETCH_FRAMES]
+  // while num_read - num_released < PREFETCH_FRAMES. The caller holds the
+  // last frame it took until its next call to input_prefetch_read().
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  int thread_created;
+  PrefetchFrame frames[PREFETCH_FRAMES];
+  int num_read;
+  int num_taken;
+  int num_released;
+  int holding;
+  int end_of_input;
+  int stop;
+#endif  // CONFIG_MULTITHREAD
+};
+
+#if INPUT_PREFETCH_MMAP
+// Number of frames ahead of the encoder the kernel is asked to read.
+#define PREFETCH_MAP_FRAMES 4
+
+// Sets the plane pointers of img, which describes a raw frame, to point into
+// the frame data at buf, laid out as read_yuv_frame() reads it.
+static void set_raw_planes(aom_image_t *img, unsigned char *buf) {
+  const int bytespp = (img->fmt & AOM_IMG_FMT_HIGHBITDEPTH) ? 2 : 1;
+  for (int plane = 0; plane < 3; ++plane) {
+    const int w = aom_img_plane_width(img, plane) * bytespp;
+    const int h = aom_img_plane_height(img, plane);
+    int idx = plane;
+    if (plane > 0 && img->fmt == AOM_IMG_FMT_YV12) idx = 3 - plane;
+    img->planes[idx] = buf;
+    img->stride[idx] = w;
+    buf += (size_t)w * h;
+  }
+}
+
+static void advise_read_ahead(const InputPrefetch *prefetch) {
+  const size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+  const size_t start = prefetch->offset & ~(page_size - 1);
+  size_t end = prefetch->offset + PREFETCH_MAP_FRAMES * prefetch->frame_size;
+  if (end > prefetch->map_size) end = prefetch->map_size;
+  if (end <= start) return;
+  posix_madvise(prefetch->map + start, end - start, POSIX_MADV_WILLNEED);
+}
+
+// Returns 1 if the input is a regular file whose frames can be returned in
+// place, and maps it.
+static int map_input(InputPrefetch *prefetch) {
+  struct AvxInputContext *const input_ctx = prefetch->input_ctx;
+  if (input_ctx->file_type == FILE_TYPE_Y4M) {
+    if (!y4m_input_can_reference(&input_ctx->y4m)) return 0;
+  } else {
+    // Only planar formats are returned in place: NV12 interleaves its chroma
+    // planes.
+    switch (input_ctx->fmt) {
+      case AOM_IMG_FMT_I420:
+      case AOM_IMG_FMT_YV12:
+      case AOM_IMG_FMT_I422:
+      case AOM_IMG_FMT_I444:
+      case AOM_IMG_FMT_I42016:
+      case AOM_IMG_FMT_I42216:
+      case AOM_IMG_FMT_I44416: break;
+      default: return 0;
+    }
+  }
+
+  const int fd = fileno(input_ctx->file);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) return 0;
+  if (st.st_size <= 0 || (uint64_t)st.st_size > SIZE_MAX) return 0;
+  const off_t file_pos = ftello(input_ctx->file);
+  if (file_pos < 0) return 0;
+  // Raw input: bytes still held in the detection buffer come before the file
+  // position. The Y4M reader consumes them with the stream header.
+  const size_t buffered =
+      input_ctx->file_type == FILE_TYPE_Y4M
+          ? 0
+          : input_ctx->detect.buf_read - input_ctx->detect.position;
+  if ((uint64_t)file_pos < buffered) return 0;
+
+  // The encoder may write to the frames it is given, e.g. when denoising, so
+  // the pages are mapped copy-on-write.
+  void *map = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE, fd, 0);
+  if (map == MAP_FAILED) return 0;
+  prefetch->map = (unsigned char *)map;
+  prefetch->map_size = (size_t)st.st_size;
+  prefetch->offset = (size_t)file_pos - buffered;
+  posix_madvise(map, prefetch->map_size, POSIX_MADV_SEQUENTIAL);
+
+  if (input_ctx->file_type == FILE_TYPE_Y4M) {
+    prefetch->frame_size = input_ctx->y4m.dst_buf_read_sz;
+  } else {
+    // aom_img_wrap() only fills in the format fields here: the planes are
+    // set for each frame.
+    if (!aom_img_wrap(&prefetch->layout, input_ctx->fmt, input_ctx->width,
+                      input_ctx->height, 1, prefetch->map)) {
+      munmap(map, prefetch->map_size);
+      prefetch->map = NULL;
+      return 0;
+    }
+    prefetch->layout.img_data = NULL;
+    const int bytespp = (input_ctx->fmt & AOM_IMG_FMT_HIGHBITDEPTH) ? 2 : 1;
+    prefetch->frame_size = 0;
+    for (int plane = 0; plane < 3; ++plane) {
+      prefetch->frame_size +=
+          (size_t)aom_img_plane_width(&prefetch->layout, plane) * bytespp *
+          aom_img_plane_height(&prefetch->layout, plane);
+    }
+  }
+  prefetch->pos = (int64_t)prefetch->offset;
+  advise_read_ahead(prefetch);
+  return 1;
+}
+
+static int read_mapped_frame(InputPrefetch *prefetch, aom_image_t *img) {
+  const struct AvxInputContext *const input_ctx = prefetch->input_ctx;
+  const unsigned char *const data = prefetch->map + prefetch->offset;
+  const size_t left = prefetch->map_size - prefetch->offset;
+  size_t frame_size;
+  if (input_ctx->file_type == FILE_TYPE_Y4M) {
+    frame_size = y4m_input_reference_frame(&input_ctx->y4m, data, left, img);
+    if (frame_size == 0) return 0;
+  } else {
+    // Like read_yuv_frame(), a partial frame at the end is not encoded.
+    frame_size = prefetch->frame_size;
+    if (left < frame_size) return 0;
+    *img = prefetch->layout;
+    set_raw_planes(img, (unsigned char *)data);
+  }
+  prefetch->offset += frame_size;
+  prefetch->pos = (int64_t)prefetch->offset;
+  advise_read_ahead(prefetch);
+  return 1;
+}
+#endif  // INPUT_PREFETCH_MMAP
+
+#if CONFIG_MULTITHREAD
+static int read_frame_into(InputPrefetch *prefetch, PrefetchFrame *frame) {
+  struct AvxInputContext *const input_ctx = prefetch->input_ctx;
+  if (input_ctx->file_type == FILE_TYPE_Y4M) {
+    if (y4m_input_fetch_frame_into(&input_ctx->y4m, input_ctx->file,
+                                   frame->dst, frame->aux, &frame->img) < 1) {
+      return 0;
+    }
+  } else {
+    if (read_yuv_frame(input_ctx, &frame->raw)) return 0;
+    frame->img = frame->raw;
+    frame->img.img_data = NULL;
+    frame->img.img_data_owner = 0;
+    frame->img.self_allocd = 0;
+  }
+  frame->pos = ftello(input_ctx->file);
+  return 1;
+}
+
+static THREADFN read_ahead_worker(void *arg) {
+  InputPrefetch *const prefetch = (InputPrefetch *)arg;
+  for (;;) {
+    pthread_mutex_lock(&prefetch->mutex);
+    while (prefetch->num_read - prefetch->num_released == PREFETCH_FRAMES &&
+           !prefetch->stop) {
+      pthread_cond_wait(&prefetch->cond, &prefetch->mutex);
+    }
+    const int stop = prefetch->stop;
+    const int index = prefetch->num_read % PREFETCH_FRAMES;
+    pthread_mutex_unlock(&prefetch->mutex);
+    if (stop) break;
+
+    // The frame is not visible to the caller until num_read is incremented.
+    const int ok = read_frame_into(prefetch, &prefetch->frames[index]);
+
+    pthread_mutex_lock(&prefetch->mutex);
+    if (ok)
+      ++prefetch->num_read;
+    else
+      prefetch->end_of_input = 1;
+    pthread_cond_signal(&prefetch->cond);
+    pthread_mutex_unlock(&prefetch->mutex);
+    if (!ok) break;
+  }
+  return THREAD_EXIT_SUCCESS;
+}
+
+static int alloc_frames(InputPrefetch *prefetch) {
+  const struct AvxInputContext *const input_ctx = prefetch->input_ctx;
+  for (int i = 0; i < PREFETCH_FRAMES; ++i) {
+    PrefetchFrame *const frame = &prefetch->frames[i];
+    if (input_ctx->file_type == FILE_TYPE_Y4M) {
+      const y4m_input *const y4m = &input_ctx->y4m;
+      const size_t bytes_per_sample = y4m->bit_depth > 8 ? 2 : 1;
+      frame->dst = (unsigned char *)malloc(y4m->dst_buf_sz * bytes_per_sample);
+      if (!frame->dst) return 0;
+      if (y4m->aux_buf_sz > 0) {
+        frame->aux = (unsigned char *)malloc(y4m->aux_buf_sz);
+        if (!frame->aux) return 0;
+      }
+    } else if (!aom_img_alloc(&frame->raw, input_ctx->fmt, input_ctx->width,
+                              input_ctx->height, 32)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+static void free_frames(InputPrefetch *prefetch) {
+  for (int i = 0; i < PREFETCH_FRAMES; ++i) {
+    PrefetchFrame *const frame = &prefetch->frames[i];
+    free(frame->dst);
+    free(frame->aux);
+    aom_img_free(&frame->raw);
+  }
+}
+
+static int start_read_ahead(InputPrefetch *prefetch) {
+  if (!alloc_frames(prefetch)) return 0;
+  if (pthread_mutex_init(&prefetch->mutex, NULL)) return 0;
+  if (pthread_cond_init(&prefetch->cond, NULL)) {
+    pthread_mutex_destroy(&prefetch->mutex);
+    return 0;
+  }
+  if (pthread_create(&prefetch->thread, NULL, read_ahead_worker, prefetch)) {
+    pthread_cond_destroy(&prefetch->cond);
+    pthread_mutex_destroy(&prefetch->mutex);
+    return 0;
+  }
+  prefetch->thread_created = 1;
+  return 1;
+}
+
+static int read_prefetched_frame(InputPrefetch *prefetch, aom_image_t *img) {
+  pthread_mutex_lock(&prefetch->mutex);
+  if (prefetch->holding) {
+    ++prefetch->num_released;
+    prefetch->holding = 0;
+    pthread_cond_signal(&prefetch->cond);
+  }
+  while (prefetch->num_taken == prefetch->num_read &&
+         !prefetch->end_of_input) {
+    pthread_cond_wait(&prefetch->cond, &prefetch->mutex);
+  }
+  const int got_frame = prefetch->num_taken < prefetch->num_read;
+  if (got_frame) {
+    const PrefetchFrame *const frame =
+        &prefetch->frames[prefetch->num_taken % PREFETCH_FRAMES];
+    ++prefetch->num_taken;
+    prefetch->holding = 1;
+    *img = frame->img;
+    prefetch->pos = frame->pos;
+  }
+  pthread_mutex_unlock(&prefetch->mutex);
+  return got_frame;
+}
+#endif  // CONFIG_MULTITHREAD
+
+InputPrefetch *input_prefetch_create(struct AvxInputContext *input_ctx) {
+  if (input_ctx->file_type != FILE_TYPE_RAW &&
+      input_ctx->file_type != FILE_TYPE_Y4M) {
+    return NULL;
+  }
+  InputPrefetch *prefetch = (InputPrefetch *)calloc(1, sizeof(*prefetch));
+  if (!prefetch) return NULL;
+  prefetch->input_ctx = input_ctx;
+  prefetch->pos = -1;
+#if INPUT_PREFETCH_MMAP
+  if (map_input(prefetch)) return prefetch;
+#endif
+#if CONFIG_MULTITHREAD
+  if (start_read_ahead(prefetch)) return prefetch;
+  free_frames(prefetch);
+#endif
+  free(prefetch);
+  return NULL;
+}
+
+int input_prefetch_read(InputPrefetch *prefetch, aom_image_t *img) {
+#if INPUT_PREFETCH_MMAP
+  if (prefetch->map) return read_mapped_frame(prefetch, img);
+#endif
+#if CONFIG_MULTITHREAD
+  if (prefetch->thread_created) return read_prefetched_frame(prefetch, img);
+#endif
+  (void)img;
+  return 0;
+}
+
+int64_t input_prefetch_tell(const InputPrefetch *prefetch) {
+  return prefetch->pos;
+}
+
+void input_prefetch_destroy(InputPrefetch *prefetch) {
+  if (!prefetch) return;
+#if INPUT_PREFETCH_MMAP
+  if (prefetch->map) munmap(prefetch->map, prefetch->map_size);
+#endif
+#if CONFIG_MULTITHREAD
+  if (prefetch->thread_created) {
+    pthread_mutex_lock(&prefetch->mutex);
+    prefetch->stop = 1;
+    pthread_cond_signal(&prefetch->cond);
+    pthread_mutex_unlock(&prefetch->mutex);
+    pthread_join(prefetch->thread, NULL);
+    pthread_cond_destroy(&prefetch->cond);
+    pthread_mutex_destroy(&prefetch->mutex);
+    free_frames(prefetch);
+  }
+#endif
+  free(prefetch);
+}
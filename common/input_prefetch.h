@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+#ifndef AOM_COMMON_INPUT_PREFETCH_H_
+#define AOM_COMMON_INPUT_PREFETCH_H_
+
+#include "aom/aom_image.h"
+#include "common/tools_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Reads raw and Y4M encoder input ahead of the encoder. Regular files are
+// memory-mapped, and frames that need no conversion are returned in place,
+// without being copied. Other inputs are read by a background thread into a
+// small ring of frames, so that reading and converting the next frames
+// overlaps with encoding.
+typedef struct InputPrefetch InputPrefetch;
+
+// Takes over reading from input_ctx->file, which must be positioned at the
+// first frame, with input_ctx->fmt, width and height set. Returns NULL if the
+// input cannot be prefetched, in which case the caller keeps reading the file
+// directly.
+InputPrefetch *input_prefetch_create(struct AvxInputContext *input_ctx);
+
+// Points img at the next frame and returns 1, or returns 0 at the end of the
+// input. The frame data is owned by the prefetcher and stays valid until the
+// next call.
+int input_prefetch_read(InputPrefetch *prefetch, aom_image_t *img);
+
+// Returns the offset in the input just past the last frame returned, or -1 if
+// it is not known.
+int64_t input_prefetch_tell(const InputPrefetch *prefetch);
+
+void input_prefetch_destroy(InputPrefetch *prefetch);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AOM_COMMON_INPUT_PREFETCH_H_
@@ -116,6 +116,7 @@ struct AvxInputContext {
   struct AvxRational framerate;
 #if CONFIG_AV1_ENCODER
   y4m_input y4m;
+  struct InputPrefetch *prefetch;
 #endif
   aom_color_range_t color_range;
 };
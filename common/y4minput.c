@@ -1158,13 +1158,48 @@ void y4m_input_close(y4m_input *_y4m) {
   free(_y4m->aux_buf);
 }
 
-int y4m_input_fetch_frame(y4m_input *_y4m, FILE *_fin, aom_image_t *_img) {
-  char frame[6];
+/*Fills in _img to point at the converted frame in _buf.
+  We don't use aom_img_wrap() because it forces padding for odd picture
+   sizes, which would require a separate fread call for every row.*/
+static void y4m_input_set_img(const y4m_input *_y4m, unsigned char *_buf,
+                              aom_image_t *_img) {
   int pic_sz;
   int c_w;
   int c_h;
   int c_sz;
   int bytes_per_sample = _y4m->bit_depth > 8 ? 2 : 1;
+  memset(_img, 0, sizeof(*_img));
+  /*Y4M has the planes in Y'CbCr order, which libaom calls Y, U, and V.*/
+  _img->fmt = _y4m->aom_fmt;
+  _img->w = _img->d_w = _y4m->pic_w;
+  _img->h = _img->d_h = _y4m->pic_h;
+  _img->bit_depth = _y4m->bit_depth;
+  _img->x_chroma_shift = _y4m->dst_c_dec_h >> 1;
+  _img->y_chroma_shift = _y4m->dst_c_dec_v >> 1;
+  _img->bps = _y4m->bps;
+
+  /*Set up the buffer pointers.*/
+  pic_sz = _y4m->pic_w * _y4m->pic_h * bytes_per_sample;
+  c_w = (_y4m->pic_w + _y4m->dst_c_dec_h - 1) / _y4m->dst_c_dec_h;
+  c_w *= bytes_per_sample;
+  c_h = (_y4m->pic_h + _y4m->dst_c_dec_v - 1) / _y4m->dst_c_dec_v;
+  c_sz = c_w * c_h;
+  _img->stride[AOM_PLANE_Y] = _y4m->pic_w * bytes_per_sample;
+  _img->stride[AOM_PLANE_U] = _img->stride[AOM_PLANE_V] = c_w;
+  _img->planes[AOM_PLANE_Y] = _buf;
+  _img->planes[AOM_PLANE_U] = _buf + pic_sz;
+  _img->planes[AOM_PLANE_V] = _buf + pic_sz + c_sz;
+}
+
+int y4m_input_fetch_frame(y4m_input *_y4m, FILE *_fin, aom_image_t *_img) {
+  return y4m_input_fetch_frame_into(_y4m, _fin, _y4m->dst_buf, _y4m->aux_buf,
+                                    _img);
+}
+
+int y4m_input_fetch_frame_into(y4m_input *_y4m, FILE *_fin,
+                               unsigned char *_dst, unsigned char *_aux,
+                               aom_image_t *_img) {
+  char frame[6];
   /*Read and skip the frame header.*/
   if (!file_read(frame, 6, _fin)) return 0;
   if (memcmp(frame, "FRAME", 5)) {
@@ -1182,40 +1217,48 @@ int y4m_input_fetch_frame(y4m_input *_y4m, FILE *_fin, aom_image_t *_img) {
     }
   }
   /*Read the frame data that needs no conversion.*/
-  if (!file_read(_y4m->dst_buf, _y4m->dst_buf_read_sz, _fin)) {
+  if (!file_read(_dst, _y4m->dst_buf_read_sz, _fin)) {
     fprintf(stderr, "Error reading Y4M frame data.\n");
     return -1;
   }
   /*Read the frame data that does need conversion.*/
-  if (!file_read(_y4m->aux_buf, _y4m->aux_buf_read_sz, _fin)) {
+  if (!file_read(_aux, _y4m->aux_buf_read_sz, _fin)) {
     fprintf(stderr, "Error reading Y4M frame data.\n");
     return -1;
   }
   /*Now convert the just read frame.*/
-  (*_y4m->convert)(_y4m, _y4m->dst_buf, _y4m->aux_buf);
-  /*Fill in the frame buffer pointers.
-    We don't use aom_img_wrap() because it forces padding for odd picture
-     sizes, which would require a separate fread call for every row.*/
-  memset(_img, 0, sizeof(*_img));
-  /*Y4M has the planes in Y'CbCr order, which libaom calls Y, U, and V.*/
-  _img->fmt = _y4m->aom_fmt;
-  _img->w = _img->d_w = _y4m->pic_w;
-  _img->h = _img->d_h = _y4m->pic_h;
-  _img->bit_depth = _y4m->bit_depth;
-  _img->x_chroma_shift = _y4m->dst_c_dec_h >> 1;
-  _img->y_chroma_shift = _y4m->dst_c_dec_v >> 1;
-  _img->bps = _y4m->bps;
-
-  /*Set up the buffer pointers.*/
-  pic_sz = _y4m->pic_w * _y4m->pic_h * bytes_per_sample;
-  c_w = (_y4m->pic_w + _y4m->dst_c_dec_h - 1) / _y4m->dst_c_dec_h;
-  c_w *= bytes_per_sample;
-  c_h = (_y4m->pic_h + _y4m->dst_c_dec_v - 1) / _y4m->dst_c_dec_v;
-  c_sz = c_w * c_h;
-  _img->stride[AOM_PLANE_Y] = _y4m->pic_w * bytes_per_sample;
-  _img->stride[AOM_PLANE_U] = _img->stride[AOM_PLANE_V] = c_w;
-  _img->planes[AOM_PLANE_Y] = _y4m->dst_buf;
-  _img->planes[AOM_PLANE_U] = _y4m->dst_buf + pic_sz;
-  _img->planes[AOM_PLANE_V] = _y4m->dst_buf + pic_sz + c_sz;
+  (*_y4m->convert)(_y4m, _dst, _aux);
+  y4m_input_set_img(_y4m, _dst, _img);
   return 1;
 }
+
+int y4m_input_can_reference(const y4m_input *_y4m) {
+  return _y4m->convert == y4m_convert_null && _y4m->aux_buf_read_sz == 0;
+}
+
+size_t y4m_input_reference_frame(const y4m_input *_y4m,
+                                 const unsigned char *_data, size_t _size,
+                                 aom_image_t *_img) {
+  size_t header_sz;
+  assert(y4m_input_can_reference(_y4m));
+  if (_size == 0) return 0;
+  if (_size < 6 || memcmp(_data, "FRAME", 5)) {
+    fprintf(stderr, "Loss of framing in Y4M input data\n");
+    return 0;
+  }
+  /*Skip the frame header, including any parameters.*/
+  for (header_sz = 5; header_sz < _size && header_sz < 85; header_sz++) {
+    if (_data[header_sz] == '\n') break;
+  }
+  if (header_sz == _size || _data[header_sz] != '\n') {
+    fprintf(stderr, "Error parsing Y4M frame header\n");
+    return 0;
+  }
+  header_sz++;
+  if (_size - header_sz < _y4m->dst_buf_read_sz) {
+    fprintf(stderr, "Error reading Y4M frame data.\n");
+    return 0;
+  }
+  y4m_input_set_img(_y4m, (unsigned char *)_data + header_sz, _img);
+  return header_sz + _y4m->dst_buf_read_sz;
+}
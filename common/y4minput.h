@@ -74,6 +74,21 @@ int y4m_input_open(y4m_input *y4m_ctx, FILE *file, char *skip_buffer,
                    int only_420);
 void y4m_input_close(y4m_input *_y4m);
 int y4m_input_fetch_frame(y4m_input *_y4m, FILE *_fin, aom_image_t *img);
+/*Like y4m_input_fetch_frame(), but reads the frame into _dst, which must hold
+   dst_buf_sz samples, using _aux (aux_buf_sz bytes) for the data that needs
+   conversion. Only reads _y4m, so several buffers may be filled in turn.*/
+int y4m_input_fetch_frame_into(y4m_input *_y4m, FILE *_fin,
+                               unsigned char *_dst, unsigned char *_aux,
+                               aom_image_t *img);
+/*Returns 1 if frames are stored in the layout described by the aom_image_t,
+   so that y4m_input_reference_frame() can be used.*/
+int y4m_input_can_reference(const y4m_input *_y4m);
+/*Points img at the frame at the start of the _size bytes of frame data in
+   _data, without copying it. Returns the number of bytes taken by the frame,
+   or 0 at the end of the data or on error.*/
+size_t y4m_input_reference_frame(const y4m_input *_y4m,
+                                 const unsigned char *_data, size_t _size,
+                                 aom_image_t *img);
 
 #ifdef __cplusplus
 }  // extern "C"
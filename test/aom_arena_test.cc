@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include "aom_mem/aom_arena.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+const size_t kBlockSize = 1024;
+
+TEST(AomArenaTest, Alignment) {
+  AVxArena arena;
+  aom_arena_init(&arena, kBlockSize);
+  for (size_t align = 1; align <= 256; align *= 2) {
+    uint8_t *const buf =
+        static_cast<uint8_t *>(aom_arena_memalign(&arena, align, 3));
+    ASSERT_NE(buf, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(buf) % align, 0u) << align;
+    memset(buf, 0xff, 3);
+  }
+  const uint8_t *const zero =
+      static_cast<const uint8_t *>(aom_arena_calloc(&arena, 10, 7));
+  ASSERT_NE(zero, nullptr);
+  for (int i = 0; i < 70; ++i) EXPECT_EQ(zero[i], 0);
+  aom_arena_free(&arena);
+}
+
+TEST(AomArenaTest, Overflow) {
+  AVxArena arena;
+  aom_arena_init(&arena, kBlockSize);
+  EXPECT_EQ(aom_arena_memalign(&arena, 64, SIZE_MAX), nullptr);
+  EXPECT_EQ(aom_arena_memalign(&arena, 64, SIZE_MAX - 64), nullptr);
+  EXPECT_EQ(aom_arena_calloc(&arena, 32, SIZE_MAX / 32), nullptr);
+  EXPECT_EQ(aom_arena_calloc(&arena, SIZE_MAX, SIZE_MAX), nullptr);
+  AVxArenaStats stats;
+  aom_arena_get_stats(&arena, &stats);
+  EXPECT_EQ(stats.reserved, 0u);
+  aom_arena_free(&arena);
+}
+
+TEST(AomArenaTest, MarkRelease) {
+  AVxArena arena;
+  aom_arena_init(&arena, kBlockSize);
+  void *const first = aom_arena_memalign(&arena, 16, 100);
+  ASSERT_NE(first, nullptr);
+
+  const AVxArenaMark mark = aom_arena_mark(&arena);
+  void *const second = aom_arena_memalign(&arena, 16, 100);
+  ASSERT_NE(second, nullptr);
+  // Spills into a second block.
+  ASSERT_NE(aom_arena_memalign(&arena, 16, 4 * kBlockSize), nullptr);
+  AVxArenaStats stats;
+  aom_arena_get_stats(&arena, &stats);
+  EXPECT_EQ(stats.num_system_allocs, 2u);
+  const size_t peak = stats.used;
+
+  aom_arena_release(&arena, mark);
+  aom_arena_get_stats(&arena, &stats);
+  EXPECT_LT(stats.used, peak);
+  EXPECT_EQ(stats.peak_used, peak);
+
+  // The same sequence reuses the same memory.
+  EXPECT_EQ(aom_arena_memalign(&arena, 16, 100), second);
+  ASSERT_NE(aom_arena_memalign(&arena, 16, 4 * kBlockSize), nullptr);
+  aom_arena_get_stats(&arena, &stats);
+  EXPECT_EQ(stats.num_system_allocs, 2u);
+  EXPECT_EQ(stats.used, peak);
+  aom_arena_free(&arena);
+}
+
+TEST(AomArenaTest, ResetMergesBlocks) {
+  AVxArena arena;
+  aom_arena_init(&arena, kBlockSize);
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_NE(aom_arena_memalign(&arena, 32, kBlockSize), nullptr);
+  }
+  AVxArenaStats stats;
+  aom_arena_get_stats(&arena, &stats);
+  const unsigned int num_allocs = stats.num_system_allocs;
+  EXPECT_GT(num_allocs, 1u);
+  EXPECT_GE(stats.reserved, 8 * kBlockSize);
+
+  // The reset allocates one block covering all the previous ones, after which
+  // the same usage no longer allocates.
+  aom_arena_reset(&arena);
+  aom_arena_get_stats(&arena, &stats);
+  EXPECT_EQ(stats.used, 0u);
+  EXPECT_EQ(stats.num_system_allocs, num_allocs + 1);
+  for (int iter = 0; iter < 3; ++iter) {
+    for (int i = 0; i < 8; ++i) {
+      ASSERT_NE(aom_arena_memalign(&arena, 32, kBlockSize), nullptr);
+    }
+    aom_arena_reset(&arena);
+  }
+  aom_arena_get_stats(&arena, &stats);
+  EXPECT_EQ(stats.num_system_allocs, num_allocs + 1);
+  aom_arena_free(&arena);
+  aom_arena_get_stats(&arena, &stats);
+  EXPECT_EQ(stats.reserved, 0u);
+}
+
+}  // namespace
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <atomic>
+
+#include "config/aom_config.h"
+
+#include "aom_util/aom_progress.h"
+#include "aom_util/aom_thread.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(AomProgressTest, SetNeverDecreases) {
+  AVxProgress progress;
+  aom_progress_init(&progress, -1);
+  EXPECT_EQ(aom_progress_get(&progress), -1);
+  aom_progress_set(&progress, 5);
+  EXPECT_EQ(aom_progress_get(&progress), 5);
+  aom_progress_set(&progress, 3);
+  EXPECT_EQ(aom_progress_get(&progress), 5);
+  // Already reached targets do not block.
+  aom_progress_wait(&progress, 5);
+  aom_progress_reset(&progress, 0);
+  EXPECT_EQ(aom_progress_get(&progress), 0);
+  aom_progress_destroy(&progress);
+}
+
+#if CONFIG_MULTITHREAD
+const int kNumWorkers = 4;
+const int kRows = 32;
+const int kCols = 64;
+
+struct WavefrontData {
+  AVxProgress *progress;
+  int values[kRows][kCols];
+  std::atomic<int> errors;
+};
+
+// Processes the rows assigned to a worker, each position depending on the
+// top-right position of the previous row.
+int WavefrontHook(void *arg1, void *arg2) {
+  WavefrontData *const data = static_cast<WavefrontData *>(arg1);
+  const int worker_id = *static_cast<int *>(arg2);
+  for (int r = worker_id; r < kRows; r += kNumWorkers) {
+    for (int c = 0; c < kCols; ++c) {
+      if (r > 0) {
+        const int above_right = c + 1 < kCols ? c + 1 : kCols - 1;
+        aom_progress_wait(&data->progress[r - 1], c + 1);
+        if (data->values[r - 1][above_right] != r - 1 + above_right) {
+          ++data->errors;
+        }
+      }
+      data->values[r][c] = r + c;
+      aom_progress_set(&data->progress[r], c < kCols - 1 ? c : kCols + 1);
+    }
+  }
+  return 1;
+}
+
+TEST(AomProgressTest, Wavefront) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  AVxWorker workers[kNumWorkers];
+  int worker_ids[kNumWorkers];
+  WavefrontData *const data = new WavefrontData();
+  ASSERT_EQ(aom_progress_alloc_array(&data->progress, kRows, -1), 1);
+  for (int i = 0; i < kNumWorkers; ++i) {
+    winterface->init(&workers[i]);
+    ASSERT_TRUE(winterface->reset(&workers[i]));
+  }
+
+  for (int iter = 0; iter < 10; ++iter) {
+    aom_progress_reset_array(data->progress, kRows, -1);
+    for (int r = 0; r < kRows; ++r) {
+      for (int c = 0; c < kCols; ++c) data->values[r][c] = -1;
+    }
+    data->errors = 0;
+    for (int i = 0; i < kNumWorkers; ++i) {
+      worker_ids[i] = i;
+      workers[i].hook = WavefrontHook;
+      workers[i].data1 = data;
+      workers[i].data2 = &worker_ids[i];
+      winterface->launch(&workers[i]);
+    }
+    for (int i = 0; i < kNumWorkers; ++i) {
+      EXPECT_TRUE(winterface->sync(&workers[i]));
+    }
+    EXPECT_EQ(data->errors, 0);
+  }
+
+  for (int i = 0; i < kNumWorkers; ++i) winterface->end(&workers[i]);
+  aom_progress_free_array(&data->progress, kRows);
+  EXPECT_EQ(data->progress, nullptr);
+  delete data;
+}
+#endif  // CONFIG_MULTITHREAD
+
+}  // namespace
@@ -1318,6 +1318,11 @@ INSTANTIATE_TEST_SUITE_P(AVX2, AV1Convolve2DTest,
                          BuildLowbdParams(av1_convolve_2d_sr_avx2));
 #endif
 
+#if HAVE_AVX512
+INSTANTIATE_TEST_SUITE_P(AVX512, AV1Convolve2DTest,
+                         BuildLowbdParams(av1_convolve_2d_sr_avx512));
+#endif
+
 #if HAVE_NEON
 INSTANTIATE_TEST_SUITE_P(NEON, AV1Convolve2DTest,
                          BuildLowbdParams(av1_convolve_2d_sr_neon));
@@ -2375,6 +2380,11 @@ INSTANTIATE_TEST_SUITE_P(AVX2, AV1Convolve2DCompoundTest,
                          BuildLowbdLumaParams(av1_dist_wtd_convolve_2d_avx2));
 #endif
 
+#if HAVE_AVX512
+INSTANTIATE_TEST_SUITE_P(AVX512, AV1Convolve2DCompoundTest,
+                         BuildLowbdLumaParams(av1_dist_wtd_convolve_2d_avx512));
+#endif
+
 #if HAVE_NEON
 INSTANTIATE_TEST_SUITE_P(NEON, AV1Convolve2DCompoundTest,
                          BuildLowbdLumaParams(av1_dist_wtd_convolve_2d_neon));
@@ -208,6 +208,194 @@ TEST_P(NnPredictTest, DISABLED_Speed) {
                             10000000);
 }
 
+// The prediction of a batch of samples matches those of the samples.
+TEST(NnPredictBatchTest, MatchesSingle) {
+  libaom_test::ACMRandom rng(libaom_test::ACMRandom::DeterministicSeed());
+  static float weights[NN_MAX_HIDDEN_LAYERS + 1]
+                      [NN_MAX_NODES_PER_LAYER * NN_MAX_NODES_PER_LAYER];
+  static float bias[NN_MAX_HIDDEN_LAYERS + 1][NN_MAX_NODES_PER_LAYER];
+  const int kNumSamples = 2 * NN_BATCH_SIZE + 3;
+  static float inputs[kNumSamples * NN_MAX_NODES_PER_LAYER];
+  static float outputs[kNumSamples * NN_MAX_NODES_PER_LAYER];
+  for (const NN_CONFIG &shape : kShapes) {
+    NN_CONFIG nn_config = shape;
+    for (int layer = 0; layer <= shape.num_hidden_layers; ++layer) {
+      for (float &w : weights[layer]) {
+        w = ((float)rng.Rand31() - (1 << 30)) / (1u << 31);
+      }
+      for (float &b : bias[layer]) {
+        b = ((float)rng.Rand31() - (1 << 30)) / (1u << 31);
+      }
+      nn_config.weights[layer] = weights[layer];
+      nn_config.bias[layer] = bias[layer];
+    }
+    for (int num_samples = 1; num_samples <= kNumSamples; num_samples += 5) {
+      for (int i = 0; i < num_samples * shape.num_inputs; ++i) {
+        inputs[i] = ((float)rng.Rand31() - (1 << 30)) / (1u << 31);
+      }
+      av1_nn_predict_batch(inputs, num_samples, &nn_config, 0, outputs);
+      for (int sample = 0; sample < num_samples; ++sample) {
+        float outputs_ref[NN_MAX_NODES_PER_LAYER];
+        av1_nn_predict_c(&inputs[sample * shape.num_inputs], &nn_config, 0,
+                         outputs_ref);
+        for (int node = 0; node < shape.num_outputs; ++node) {
+          ASSERT_NEAR(outputs[sample * shape.num_outputs + node],
+                      outputs_ref[node],
+                      epsilon * AOMMAX(fabsf(outputs_ref[node]), 1.0f))
+              << "shape " << shape.num_inputs << "x" << shape.num_outputs
+              << " sample " << sample << " node " << node;
+        }
+      }
+    }
+  }
+}
+
+typedef void (*NnFcBatch_Func)(const float *input, int num_samples,
+                               int num_inputs, const float *weights,
+                               const float *bias, int num_outputs, int relu,
+                               float *output);
+
+class NnFcBatchTest : public ::testing::TestWithParam<NnFcBatch_Func> {
+ protected:
+  libaom_test::ACMRandom rng_;
+};
+GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(NnFcBatchTest);
+
+TEST_P(NnFcBatchTest, RandomValues) {
+  const NnFcBatch_Func target_func = GetParam();
+  static float input[NN_BATCH_SIZE * NN_MAX_NODES_PER_LAYER];
+  static float weights[NN_MAX_NODES_PER_LAYER * NN_MAX_NODES_PER_LAYER];
+  float bias[NN_MAX_NODES_PER_LAYER];
+  static float output_ref[NN_BATCH_SIZE * NN_MAX_NODES_PER_LAYER];
+  static float output_test[NN_BATCH_SIZE * NN_MAX_NODES_PER_LAYER];
+  for (int num_inputs = 1; num_inputs <= NN_MAX_NODES_PER_LAYER;
+       num_inputs += 7) {
+    for (int num_outputs = 1; num_outputs <= 40; num_outputs += 3) {
+      for (int num_samples = 1; num_samples <= NN_BATCH_SIZE; ++num_samples) {
+        for (int i = 0; i < num_samples * num_inputs; ++i) {
+          input[i] = ((float)rng_.Rand31() - (1 << 30)) / (1u << 31);
+        }
+        for (int i = 0; i < num_outputs * num_inputs; ++i) {
+          weights[i] = ((float)rng_.Rand31() - (1 << 30)) / (1u << 31);
+        }
+        for (int i = 0; i < num_outputs; ++i) {
+          bias[i] = ((float)rng_.Rand31() - (1 << 30)) / (1u << 31);
+        }
+        const int relu = num_samples & 1;
+        av1_nn_fc_batch_c(input, num_samples, num_inputs, weights, bias,
+                          num_outputs, relu, output_ref);
+        target_func(input, num_samples, num_inputs, weights, bias,
+                    num_outputs, relu, output_test);
+        for (int i = 0; i < num_samples * num_outputs; ++i) {
+          ASSERT_NEAR(output_test[i], output_ref[i],
+                      epsilon * AOMMAX(fabsf(output_ref[i]), 1.0f))
+              << num_samples << "x" << num_inputs << "x" << num_outputs
+              << " output " << i;
+        }
+      }
+    }
+  }
+}
+
+// The fixed-point prediction of a model approximates its floating point
+// prediction.
+TEST(NnPredictQTest, MatchesFloat) {
+  libaom_test::ACMRandom rng(libaom_test::ACMRandom::DeterministicSeed());
+  static float weights[NN_MAX_HIDDEN_LAYERS + 1]
+                      [NN_MAX_NODES_PER_LAYER * NN_MAX_NODES_PER_LAYER];
+  static float bias[NN_MAX_HIDDEN_LAYERS + 1][NN_MAX_NODES_PER_LAYER];
+  for (const NN_CONFIG &shape : kShapes) {
+    NN_CONFIG nn_config = shape;
+    for (int layer = 0; layer <= shape.num_hidden_layers; ++layer) {
+      for (float &w : weights[layer]) {
+        w = ((float)rng.Rand31() - (1 << 30)) / (1u << 31);
+      }
+      for (float &b : bias[layer]) {
+        b = ((float)rng.Rand31() - (1 << 30)) / (1u << 31);
+      }
+      nn_config.weights[layer] = weights[layer];
+      nn_config.bias[layer] = bias[layer];
+    }
+    NN_CONFIG_Q nn_config_q;
+    ASSERT_TRUE(av1_nn_quantize(&nn_config, &nn_config_q));
+
+    const int kIters = 1000;
+    double sum_error = 0, sum_output = 0;
+    int num_same_decisions = 0;
+    for (int iter = 0; iter < kIters; ++iter) {
+      float inputs[NN_MAX_NODES_PER_LAYER];
+      // Features of different orders of magnitude, like those of the
+      // encoder's models.
+      for (int i = 0; i < shape.num_inputs; ++i) {
+        inputs[i] = ((float)rng.Rand31() - (1 << 30)) / (1u << 31) *
+                    (float)(1 << (4 * (i % 4)));
+      }
+      float outputs_ref[NN_MAX_NODES_PER_LAYER];
+      float outputs_q[NN_MAX_NODES_PER_LAYER];
+      av1_nn_predict_c(inputs, &nn_config, 0, outputs_ref);
+      av1_nn_predict_q(inputs, &nn_config_q, 0, outputs_q);
+      int best_ref = 0, best_q = 0;
+      for (int node = 0; node < shape.num_outputs; ++node) {
+        sum_error += fabsf(outputs_q[node] - outputs_ref[node]);
+        sum_output += fabsf(outputs_ref[node]);
+        if (outputs_ref[node] > outputs_ref[best_ref]) best_ref = node;
+        if (outputs_q[node] > outputs_q[best_q]) best_q = node;
+      }
+      num_same_decisions += best_ref == best_q;
+    }
+    // The models are used to take decisions: the largest output of both
+    // predictions should almost always be the same.
+    EXPECT_LE(sum_error, 0.01 * sum_output)
+        << "shape " << shape.num_inputs << "x" << shape.num_outputs;
+    EXPECT_GE(num_same_decisions, kIters * 97 / 100)
+        << "shape " << shape.num_inputs << "x" << shape.num_outputs;
+    av1_nn_free_quantized(&nn_config_q);
+  }
+}
+
+typedef void (*NnFcQ_Func)(const int16_t *input, const int8_t *weights,
+                           int weights_stride, int num_outputs,
+                           int32_t *output);
+
+class NnFcQTest : public ::testing::TestWithParam<NnFcQ_Func> {
+ protected:
+  libaom_test::ACMRandom rng_;
+};
+GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(NnFcQTest);
+
+TEST_P(NnFcQTest, RandomValues) {
+  const NnFcQ_Func target_func = GetParam();
+  DECLARE_ALIGNED(32, int16_t, input[NN_MAX_NODES_PER_LAYER]);
+  static int8_t weights[NN_MAX_NODES_PER_LAYER * NN_MAX_NODES_PER_LAYER];
+  int32_t output_ref[NN_MAX_NODES_PER_LAYER];
+  int32_t output_test[NN_MAX_NODES_PER_LAYER];
+  for (int stride = NN_Q_INPUT_ALIGN; stride <= NN_MAX_NODES_PER_LAYER;
+       stride += NN_Q_INPUT_ALIGN) {
+    for (int num_outputs = 1; num_outputs <= NN_MAX_NODES_PER_LAYER;
+         num_outputs += 3) {
+      for (int iter = 0; iter < 10; ++iter) {
+        // Extreme values half of the time.
+        const bool extreme = iter & 1;
+        for (int i = 0; i < stride; ++i) {
+          input[i] = extreme ? (rng_(2) ? INT16_MAX : -INT16_MAX)
+                             : static_cast<int16_t>(rng_.Rand16());
+        }
+        for (int i = 0; i < num_outputs * stride; ++i) {
+          weights[i] = extreme ? (rng_(2) ? 127 : -127)
+                               : static_cast<int8_t>(rng_.Rand8());
+        }
+        av1_nn_fc_q_c(input, weights, stride, num_outputs, output_ref);
+        target_func(input, weights, stride, num_outputs, output_test);
+        for (int node = 0; node < num_outputs; ++node) {
+          ASSERT_EQ(output_test[node], output_ref[node])
+              << "stride " << stride << " num_outputs " << num_outputs
+              << " node " << node;
+        }
+      }
+    }
+  }
+}
+
 #if !CONFIG_EXCLUDE_SIMD_MISMATCH
 #if HAVE_SSE3
 INSTANTIATE_TEST_SUITE_P(SSE3, NnPredictTest,
@@ -223,6 +411,24 @@ INSTANTIATE_TEST_SUITE_P(AVX2, NnPredictTest,
 INSTANTIATE_TEST_SUITE_P(NEON, NnPredictTest,
                          ::testing::Values(av1_nn_predict_neon));
 #endif
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, NnFcBatchTest,
+                         ::testing::Values(av1_nn_fc_batch_avx2));
+#endif
+
+#if HAVE_NEON
+INSTANTIATE_TEST_SUITE_P(NEON, NnFcBatchTest,
+                         ::testing::Values(av1_nn_fc_batch_neon));
+#endif
 #endif  // !CONFIG_EXCLUDE_SIMD_MISMATCH
 
+#if HAVE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, NnFcQTest, ::testing::Values(av1_nn_fc_q_avx2));
+#endif
+
+#if HAVE_NEON
+INSTANTIATE_TEST_SUITE_P(NEON, NnFcQTest, ::testing::Values(av1_nn_fc_q_neon));
+#endif
+
 }  // namespace
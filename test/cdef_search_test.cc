@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include "gtest/gtest.h"
+
+#include "config/aom_config.h"
+#include "config/av1_rtcd.h"
+
+#include "av1/common/cdef.h"
+#include "test/acm_random.h"
+
+namespace {
+
+// Number of strengths evaluated by the full CDEF search.
+const int kTotalStrengths = CDEF_PRI_STRENGTHS * CDEF_SEC_STRENGTHS;
+
+typedef void (*CdefAddBestMse_Func)(uint64_t *tot_mse, const uint64_t *mse,
+                                    uint64_t offset, uint64_t best_mse, int n);
+
+class CdefAddBestMseTest
+    : public ::testing::TestWithParam<CdefAddBestMse_Func> {
+ protected:
+  // Random value of up to the given number of bits.
+  uint64_t RandBits(int bits) {
+    uint64_t v = 0;
+    for (int i = 0; i < 4; ++i) v = (v << 16) | rng_.Rand16();
+    return bits == 64 ? v : v & ((static_cast<uint64_t>(1) << bits) - 1);
+  }
+
+  libaom_test::ACMRandom rng_;
+};
+GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(CdefAddBestMseTest);
+
+TEST_P(CdefAddBestMseTest, RandomValues) {
+  const CdefAddBestMse_Func target_func = GetParam();
+  uint64_t mse[kTotalStrengths];
+  uint64_t tot_mse_ref[kTotalStrengths];
+  uint64_t tot_mse_test[kTotalStrengths];
+  for (int n = 1; n <= kTotalStrengths; ++n) {
+    for (int iter = 0; iter < 100; ++iter) {
+      // Values above 2^63 half of the time, to check that the comparison is
+      // unsigned.
+      const int bits = (iter & 1) ? 64 : 40;
+      for (int k = 0; k < n; ++k) {
+        mse[k] = RandBits(bits - 1);
+        tot_mse_ref[k] = tot_mse_test[k] = RandBits(bits - 1);
+      }
+      const uint64_t offset = RandBits(bits - 1);
+      // The initial best MSE of the search is 2^63.
+      const uint64_t best_mse = rng_(4) == 0
+                                    ? static_cast<uint64_t>(1) << 63
+                                    : offset + RandBits(bits - 1);
+      av1_cdef_add_best_mse_c(tot_mse_ref, mse, offset, best_mse, n);
+      target_func(tot_mse_test, mse, offset, best_mse, n);
+      for (int k = 0; k < n; ++k) {
+        ASSERT_EQ(tot_mse_test[k], tot_mse_ref[k]) << "n " << n << " k " << k;
+      }
+    }
+  }
+}
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, CdefAddBestMseTest,
+                         ::testing::Values(av1_cdef_add_best_mse_avx2));
+#endif
+
+#if HAVE_NEON
+INSTANTIATE_TEST_SUITE_P(NEON, CdefAddBestMseTest,
+                         ::testing::Values(av1_cdef_add_best_mse_neon));
+#endif
+
+}  // namespace
@@ -12,6 +12,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <string>
+#include <vector>
 
 #include "aom_mem/aom_mem.h"
 #include "gtest/gtest.h"
@@ -179,4 +180,100 @@ AV1_INSTANTIATE_TEST_SUITE(AV1DecodeMultiThreadedLSTestLarge,
                            ::testing::Values(1), ::testing::Values(0, 3),
                            ::testing::Values(0, 1));
 
+class AV1DecodeFrameParallelTest
+    : public ::libaom_test::CodecTestWith2Params<int, int>,
+      public ::libaom_test::EncoderTest {
+ protected:
+  AV1DecodeFrameParallelTest()
+      : EncoderTest(GET_PARAM(0)), frame_parallel_(GET_PARAM(1)),
+        threads_(GET_PARAM(2)) {
+    aom_codec_dec_cfg_t cfg = aom_codec_dec_cfg_t();
+    cfg.threads = 1;
+    cfg.allow_lowbitdepth = 1;
+    serial_dec_ = codec_->CreateDecoder(cfg, 0);
+    cfg.threads = threads_;
+    frame_parallel_dec_ = codec_->CreateDecoder(cfg, 0);
+    frame_parallel_dec_->Control(AV1D_SET_FRAME_PARALLEL, frame_parallel_);
+  }
+
+  ~AV1DecodeFrameParallelTest() override {
+    delete serial_dec_;
+    delete frame_parallel_dec_;
+  }
+
+  void SetUp() override { InitializeConfig(libaom_test::kTwoPassGood); }
+
+  void PreEncodeFrameHook(libaom_test::VideoSource *video,
+                          libaom_test::Encoder *encoder) override {
+    if (video->frame() == 0) {
+      encoder->Control(AOME_SET_CPUUSED, 5);
+      encoder->Control(AV1E_SET_TILE_COLUMNS, 1);
+    }
+  }
+
+  void AddFrames(::libaom_test::Decoder *dec, std::vector<std::string> *md5s) {
+    ::libaom_test::DxDataIterator dec_iter = dec->GetDxData();
+    const aom_image_t *img;
+    while ((img = dec_iter.Next()) != nullptr) {
+      ::libaom_test::MD5 md5;
+      md5.Add(img);
+      md5s->push_back(md5.Get());
+    }
+  }
+
+  void Decode(::libaom_test::Decoder *dec, const uint8_t *data, size_t size,
+              std::vector<std::string> *md5s) {
+    const aom_codec_err_t res = dec->DecodeFrame(data, size);
+    if (res != AOM_CODEC_OK) {
+      abort_ = true;
+      ASSERT_EQ(AOM_CODEC_OK, res) << dec->DecodeError();
+    }
+    AddFrames(dec, md5s);
+  }
+
+  void FramePktHook(const aom_codec_cx_pkt_t *pkt) override {
+    const uint8_t *data = static_cast<const uint8_t *>(pkt->data.frame.buf);
+    Decode(serial_dec_, data, pkt->data.frame.sz, &serial_md5s_);
+    Decode(frame_parallel_dec_, data, pkt->data.frame.sz,
+           &frame_parallel_md5s_);
+  }
+
+  void DoTest() {
+    const aom_rational timebase = { 33333333, 1000000000 };
+    cfg_.g_timebase = timebase;
+    cfg_.rc_target_bitrate = 500;
+    cfg_.g_lag_in_frames = 12;
+    cfg_.rc_end_usage = AOM_VBR;
+
+    libaom_test::I420VideoSource video("hantro_collage_w352h288.yuv", 352, 288,
+                                       timebase.den, timebase.num, 0, 20);
+    ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+
+    // Flush the temporal units still in flight.
+    ASSERT_NO_FATAL_FAILURE(
+        Decode(frame_parallel_dec_, nullptr, 0, &frame_parallel_md5s_));
+    ASSERT_EQ(serial_md5s_.size(), 20u);
+    ASSERT_EQ(frame_parallel_md5s_.size(), serial_md5s_.size());
+    for (size_t i = 0; i < serial_md5s_.size(); ++i) {
+      ASSERT_EQ(serial_md5s_[i], frame_parallel_md5s_[i]) << "frame " << i;
+    }
+  }
+
+  std::vector<std::string> serial_md5s_;
+  std::vector<std::string> frame_parallel_md5s_;
+  ::libaom_test::Decoder *serial_dec_;
+  ::libaom_test::Decoder *frame_parallel_dec_;
+
+ private:
+  int frame_parallel_;
+  int threads_;
+};
+
+// Decode the same stream serially and with several temporal units in flight,
+// and check that the output frames are identical and in the same order.
+TEST_P(AV1DecodeFrameParallelTest, MD5Match) { DoTest(); }
+
+AV1_INSTANTIATE_TEST_SUITE(AV1DecodeFrameParallelTest,
+                           ::testing::Values(2, 4, 8), ::testing::Values(1, 4));
+
 }  // namespace
@@ -12,6 +12,7 @@
 #include "gtest/gtest.h"
 
 #include <cstdlib>
+#include <cstring>
 #include <memory>
 #include <new>
 
@@ -152,3 +153,40 @@ TEST(EC_TEST, random_ec_test) {
   od_ec_enc_clear(&enc);
   EXPECT_EQ(ret, 0);
 }
+
+// Decodes streams of every length from an exactly sized buffer so the refill
+// is exercised both in the middle of the data and across the end of it.
+TEST(EC_TEST, refill_near_buffer_end) {
+  static const uint16_t kCdf[5] = { AOM_CDF4(4096, 20480, 30720) };
+  od_ec_enc enc;
+  od_ec_dec dec;
+  srand(0x5eed);
+  od_ec_enc_init(&enc, 1);
+  for (int sz = 1; sz <= 512; sz++) {
+    std::unique_ptr<unsigned[]> data(new (std::nothrow) unsigned[sz]);
+    ASSERT_NE(data, nullptr);
+    std::unique_ptr<uint32_t[]> tell(new (std::nothrow) uint32_t[sz]);
+    ASSERT_NE(tell, nullptr);
+    od_ec_enc_reset(&enc);
+    for (int j = 0; j < sz; j++) {
+      data[j] = rand() & 3;
+      od_ec_encode_cdf_q15(&enc, data[j], kCdf, 4);
+      tell[j] = od_ec_enc_tell_frac(&enc);
+    }
+    uint32_t ptr_sz;
+    const unsigned char *ptr = od_ec_enc_done(&enc, &ptr_sz);
+    ASSERT_NE(ptr, nullptr);
+    std::unique_ptr<unsigned char[]> buf(new (std::nothrow)
+                                             unsigned char[ptr_sz]);
+    ASSERT_NE(buf, nullptr);
+    memcpy(buf.get(), ptr, ptr_sz);
+    od_ec_dec_init(&dec, buf.get(), ptr_sz);
+    for (int j = 0; j < sz; j++) {
+      ASSERT_EQ(od_ec_decode_cdf_q15(&dec, kCdf, 4), (int)data[j])
+          << "at position " << j << " of " << sz;
+      ASSERT_EQ(od_ec_dec_tell_frac(&dec), tell[j])
+          << "at position " << j << " of " << sz;
+    }
+  }
+  od_ec_enc_clear(&enc);
+}
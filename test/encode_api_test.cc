@@ -990,6 +990,161 @@ TEST(EncodeAPI, AllIntraAndNoRefLast) {
   aom_img_free(image);
   ASSERT_EQ(aom_codec_destroy(&enc), AOM_CODEC_OK);
 }
+
+TEST(EncodeAPI, ScratchMemStats) {
+  aom_codec_iface_t *iface = aom_codec_av1_cx();
+  aom_codec_enc_cfg_t cfg;
+  ASSERT_EQ(aom_codec_enc_config_default(iface, &cfg, AOM_USAGE_GOOD_QUALITY),
+            AOM_CODEC_OK);
+  cfg.g_w = 176;
+  cfg.g_h = 144;
+  cfg.g_lag_in_frames = 8;
+  cfg.kf_max_dist = 8;
+
+  aom_codec_ctx_t enc;
+  ASSERT_EQ(aom_codec_enc_init(&enc, iface, &cfg, 0), AOM_CODEC_OK);
+  ASSERT_EQ(aom_codec_control(&enc, AOME_SET_CPUUSED, 6), AOM_CODEC_OK);
+  aom_scratch_mem_stats_t stats;
+  ASSERT_EQ(aom_codec_control(&enc, AV1E_GET_SCRATCH_MEM_STATS, &stats),
+            AOM_CODEC_OK);
+  EXPECT_EQ(stats.frame_peak, 0u);
+  EXPECT_EQ(stats.num_system_allocs, 0u);
+
+  aom_image_t *image = CreateGrayImage(AOM_IMG_FMT_I420, cfg.g_w, cfg.g_h);
+  ASSERT_NE(image, nullptr);
+  unsigned int num_system_allocs = 0;
+  for (int frame = 0; frame < 32; ++frame) {
+    // Moving texture, so that temporal filtering and CDEF have work to do.
+    for (unsigned int i = 0; i < image->d_h; ++i) {
+      for (unsigned int j = 0; j < image->d_w; ++j) {
+        image->planes[0][i * image->stride[0] + j] =
+            static_cast<unsigned char>(((i + frame) * 7) ^ (j * 13));
+      }
+    }
+    ASSERT_EQ(aom_codec_encode(&enc, image, frame, 1, 0), AOM_CODEC_OK);
+    ASSERT_EQ(aom_codec_control(&enc, AV1E_GET_SCRATCH_MEM_STATS, &stats),
+              AOM_CODEC_OK);
+    // By the third key frame interval, the scratch memory has reached its
+    // peak size and is reused without further system allocations.
+    if (frame == 16) num_system_allocs = stats.num_system_allocs;
+  }
+  EXPECT_GT(stats.frame_peak, 0u);
+  EXPECT_GE(stats.frame_reserved, stats.frame_peak);
+  EXPECT_GT(stats.gop_peak, 0u);
+  EXPECT_GE(stats.gop_reserved, stats.gop_peak);
+  EXPECT_EQ(stats.num_system_allocs, num_system_allocs);
+
+  aom_img_free(image);
+  ASSERT_EQ(aom_codec_destroy(&enc), AOM_CODEC_OK);
+}
 #endif  // !CONFIG_REALTIME_ONLY
 
+struct InputBufferReleases {
+  int num_released[16];
+  aom_image_t *images[16];
+};
+
+// Overwrites the released image, so that later reads by the encoder change
+// the output.
+void ReleaseInputBuffer(void *cb_priv, void *user_priv) {
+  InputBufferReleases *const releases =
+      static_cast<InputBufferReleases *>(cb_priv);
+  const int index = static_cast<int>(reinterpret_cast<intptr_t>(user_priv));
+  ++releases->num_released[index];
+  aom_image_t *const image = releases->images[index];
+  memset(image->img_data, 0x55, image->sz);
+}
+
+// Encodes moving content with the given usage, referencing the input images
+// when 'reference_input' is set, and returns the size and checksum of the
+// output.
+void EncodeWithInputBuffers(unsigned int usage, bool reference_input,
+                            size_t *size, uint32_t *checksum) {
+  const int kNumFrames = 16;
+  // Enough for the borders of all the usages.
+  const unsigned int kBorder = 288;
+  aom_codec_iface_t *iface = aom_codec_av1_cx();
+  aom_codec_enc_cfg_t cfg;
+  ASSERT_EQ(aom_codec_enc_config_default(iface, &cfg, usage), AOM_CODEC_OK);
+  // Not a multiple of 8, so that the encoder reads the extended borders.
+  cfg.g_w = 170;
+  cfg.g_h = 126;
+  aom_codec_ctx_t enc;
+  ASSERT_EQ(aom_codec_enc_init(&enc, iface, &cfg, 0), AOM_CODEC_OK);
+  const int speed = usage == AOM_USAGE_REALTIME ? 10 : 6;
+  ASSERT_EQ(aom_codec_control(&enc, AOME_SET_CPUUSED, speed), AOM_CODEC_OK);
+
+  InputBufferReleases releases = {};
+  if (reference_input) {
+    aom_input_buffer_cb_t input_buffer_cb = { ReleaseInputBuffer, &releases,
+                                              kBorder };
+    ASSERT_EQ(
+        aom_codec_control(&enc, AV1E_SET_INPUT_BUFFER_CB, &input_buffer_cb),
+        AOM_CODEC_OK);
+  }
+  *size = 0;
+  *checksum = 0;
+  for (int frame = 0; frame <= kNumFrames; ++frame) {
+    aom_image_t *image = nullptr;
+    if (frame < kNumFrames) {
+      image = aom_img_alloc_with_border(nullptr, AOM_IMG_FMT_I420, cfg.g_w,
+                                        cfg.g_h, 32, 32, kBorder);
+      ASSERT_NE(image, nullptr);
+      for (int plane = 0; plane < 3; ++plane) {
+        const int w = aom_img_plane_width(image, plane);
+        const int h = aom_img_plane_height(image, plane);
+        for (int i = 0; i < h; ++i) {
+          for (int j = 0; j < w; ++j) {
+            image->planes[plane][i * image->stride[plane] + j] =
+                static_cast<unsigned char>(((i + 2 * frame) * 7) ^
+                                           ((j + frame) * 13) ^ plane);
+          }
+        }
+      }
+      image->user_priv =
+          reinterpret_cast<void *>(static_cast<intptr_t>(frame));
+      releases.images[frame] = image;
+    }
+    ASSERT_EQ(aom_codec_encode(&enc, image, frame, 1, 0), AOM_CODEC_OK);
+    aom_codec_iter_t iter = nullptr;
+    const aom_codec_cx_pkt_t *pkt;
+    while ((pkt = aom_codec_get_cx_data(&enc, &iter)) != nullptr) {
+      if (pkt->kind != AOM_CODEC_CX_FRAME_PKT) continue;
+      const uint8_t *const buf =
+          static_cast<const uint8_t *>(pkt->data.frame.buf);
+      for (size_t i = 0; i < pkt->data.frame.sz; ++i) {
+        *checksum = *checksum * 31 + buf[i];
+      }
+      *size += pkt->data.frame.sz;
+    }
+  }
+  ASSERT_EQ(aom_codec_destroy(&enc), AOM_CODEC_OK);
+  for (int frame = 0; frame < kNumFrames; ++frame) {
+    // Every image is released once, at the latest by aom_codec_destroy().
+    EXPECT_EQ(releases.num_released[frame], reference_input ? 1 : 0) << frame;
+    aom_img_free(releases.images[frame]);
+  }
+}
+
+TEST(EncodeAPI, InputBufferCallback) {
+  const unsigned int usages[] = {
+#if !CONFIG_REALTIME_ONLY
+    AOM_USAGE_GOOD_QUALITY,
+#endif
+    AOM_USAGE_REALTIME
+  };
+  for (const unsigned int usage : usages) {
+    SCOPED_TRACE(usage);
+    size_t copy_size, reference_size;
+    uint32_t copy_checksum, reference_checksum;
+    ASSERT_NO_FATAL_FAILURE(
+        EncodeWithInputBuffers(usage, false, &copy_size, &copy_checksum));
+    ASSERT_NO_FATAL_FAILURE(EncodeWithInputBuffers(
+        usage, true, &reference_size, &reference_checksum));
+    EXPECT_GT(copy_size, 0u);
+    EXPECT_EQ(reference_size, copy_size);
+    EXPECT_EQ(reference_checksum, copy_checksum);
+  }
+}
+
 }  // namespace
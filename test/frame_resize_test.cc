@@ -12,9 +12,12 @@
 #include <memory>
 #include <new>
 
+#include "config/aom_scale_rtcd.h"
 #include "config/av1_rtcd.h"
 #include "aom_ports/aom_timer.h"
 #include "aom_ports/bitops.h"
+#include "aom_scale/yv12config.h"
+#include "av1/common/resize.h"
 #include "gtest/gtest.h"
 #include "test/acm_random.h"
 #include "test/util.h"
@@ -269,4 +272,95 @@ INSTANTIATE_TEST_SUITE_P(
                        ::testing::ValuesIn(kFrameDim)));
 #endif
 
+// Scaling a plane row pass and column pass in several bands each must match
+// av1_resize_plane().
+TEST(AV1ResizePlaneBandsTest, MatchesWholePlane) {
+  const int kWidth = 150;
+  const int kHeight = 98;
+  const int kDims[][2] = { { 75, 49 }, { 100, 66 }, { 47, 97 }, { 201, 77 } };
+  libaom_test::ACMRandom rng;
+  std::unique_ptr<uint8_t[]> src(new (std::nothrow) uint8_t[kWidth * kHeight]);
+  ASSERT_NE(src, nullptr);
+  for (int i = 0; i < kWidth * kHeight; ++i) src[i] = rng.Rand8();
+  for (const auto &dim : kDims) {
+    const int width2 = dim[0];
+    const int height2 = dim[1];
+    const int size2 = width2 * height2;
+    std::unique_ptr<uint8_t[]> ref(new (std::nothrow) uint8_t[size2]);
+    std::unique_ptr<uint8_t[]> out(new (std::nothrow) uint8_t[size2]);
+    std::unique_ptr<uint8_t[]> intbuf(
+        new (std::nothrow) uint8_t[width2 * kHeight]);
+    ASSERT_NE(ref, nullptr);
+    ASSERT_NE(out, nullptr);
+    ASSERT_NE(intbuf, nullptr);
+    ASSERT_TRUE(av1_resize_plane(src.get(), kHeight, kWidth, kWidth, ref.get(),
+                                 height2, width2, width2));
+    const int row_split = kHeight / 3;
+    const int col_split = width2 / 2;
+    ASSERT_TRUE(av1_resize_plane_rows(src.get(), kWidth, kWidth, intbuf.get(),
+                                      width2, row_split, kHeight));
+    ASSERT_TRUE(av1_resize_plane_rows(src.get(), kWidth, kWidth, intbuf.get(),
+                                      width2, 0, row_split));
+    ASSERT_TRUE(av1_resize_plane_cols(intbuf.get(), kHeight, width2, out.get(),
+                                      height2, width2, col_split, width2));
+    ASSERT_TRUE(av1_resize_plane_cols(intbuf.get(), kHeight, width2, out.get(),
+                                      height2, width2, 0, col_split));
+    AssertOutputBufferEq(ref.get(), out.get(), width2, height2);
+  }
+}
+
+// Scaling a frame in bands of rows must match av1_resize_and_extend_frame().
+TEST(AV1ResizeFrameBandTest, MatchesWholeFrame) {
+  const int kWidth = 352;
+  const int kHeight = 288;
+  // Optimized scaler ratios, and whether chroma is subsampled.
+  const int kDims[][3] = { { 176, 144, 1 }, { 264, 216, 1 }, { 704, 576, 1 },
+                           { 176, 144, 0 }, { 264, 216, 0 } };
+  libaom_test::ACMRandom rng;
+  for (const auto &dim : kDims) {
+    const int ss = dim[2];
+    YV12_BUFFER_CONFIG src, ref, out;
+    memset(&src, 0, sizeof(src));
+    memset(&ref, 0, sizeof(ref));
+    memset(&out, 0, sizeof(out));
+    ASSERT_EQ(aom_alloc_frame_buffer(&src, kWidth, kHeight, ss, ss, 0,
+                                     AOM_BORDER_IN_PIXELS, 0, false, 0),
+              0);
+    ASSERT_EQ(aom_alloc_frame_buffer(&ref, dim[0], dim[1], ss, ss, 0,
+                                     AOM_BORDER_IN_PIXELS, 0, false, 0),
+              0);
+    ASSERT_EQ(aom_alloc_frame_buffer(&out, dim[0], dim[1], ss, ss, 0,
+                                     AOM_BORDER_IN_PIXELS, 0, false, 0),
+              0);
+    for (int plane = 0; plane < 3; ++plane) {
+      const int is_uv = plane > 0;
+      for (int i = 0; i < src.crop_heights[is_uv]; ++i) {
+        for (int j = 0; j < src.crop_widths[is_uv]; ++j) {
+          src.buffers[plane][i * src.strides[is_uv] + j] = rng.Rand8();
+        }
+      }
+    }
+    aom_extend_frame_borders(&src, 3);
+    av1_resize_and_extend_frame(&src, &ref, EIGHTTAP_SMOOTH, 8, 3);
+    for (int row = 0; row < out.y_crop_height; row += RESIZE_BAND_ALIGNMENT) {
+      const int row_end =
+          AOMMIN(row + RESIZE_BAND_ALIGNMENT, out.y_crop_height);
+      av1_resize_frame_band(&src, &out, EIGHTTAP_SMOOTH, 8, 3, row, row_end);
+    }
+    for (int plane = 0; plane < 3; ++plane) {
+      const int is_uv = plane > 0;
+      for (int i = 0; i < ref.crop_heights[is_uv]; ++i) {
+        ASSERT_EQ(memcmp(ref.buffers[plane] + i * ref.strides[is_uv],
+                         out.buffers[plane] + i * out.strides[is_uv],
+                         ref.crop_widths[is_uv]),
+                  0)
+            << dim[0] << "x" << dim[1] << " plane " << plane << " row " << i;
+      }
+    }
+    aom_free_frame_buffer(&src);
+    aom_free_frame_buffer(&ref);
+    aom_free_frame_buffer(&out);
+  }
+}
+
 }  // namespace
@@ -0,0 +1,316 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <tuple>
+
+#include "gtest/gtest.h"
+
+#include "config/aom_config.h"
+#include "config/av1_rtcd.h"
+
+#include "aom/aom_image.h"
+#include "aom_util/aom_thread.h"
+#include "av1/decoder/grain_synthesis.h"
+#include "av1/encoder/grain_test_vectors.h"
+#include "test/acm_random.h"
+#include "test/util.h"
+
+using libaom_test::ACMRandom;
+
+namespace {
+
+const int kNumWorkers = 3;
+
+int PlaneWidth(const aom_image_t *img, int plane) {
+  return plane ? (img->d_w + img->x_chroma_shift) >> img->x_chroma_shift
+               : img->d_w;
+}
+
+int PlaneHeight(const aom_image_t *img, int plane) {
+  return plane ? (img->d_h + img->y_chroma_shift) >> img->y_chroma_shift
+               : img->d_h;
+}
+
+// Fills the visible area of every plane of img with random samples.
+void FillImage(aom_image_t *img, ACMRandom *rnd) {
+  const int hbd = (img->fmt & AOM_IMG_FMT_HIGHBITDEPTH) != 0;
+  const int mask = (1 << img->bit_depth) - 1;
+  for (int plane = 0; plane < 3; ++plane) {
+    const int w = PlaneWidth(img, plane);
+    const int h = PlaneHeight(img, plane);
+    for (int i = 0; i < h; ++i) {
+      uint8_t *const row = img->planes[plane] + i * img->stride[plane];
+      for (int j = 0; j < w; ++j) {
+        if (hbd) {
+          reinterpret_cast<uint16_t *>(row)[j] = rnd->Rand16() & mask;
+        } else {
+          row[j] = rnd->Rand8();
+        }
+      }
+    }
+  }
+}
+
+bool ImagesEqual(const aom_image_t *a, const aom_image_t *b) {
+  const int bytes = (a->fmt & AOM_IMG_FMT_HIGHBITDEPTH) ? 2 : 1;
+  for (int plane = 0; plane < 3; ++plane) {
+    const int w = PlaneWidth(a, plane);
+    const int h = PlaneHeight(a, plane);
+    for (int i = 0; i < h; ++i) {
+      if (memcmp(a->planes[plane] + i * a->stride[plane],
+                 b->planes[plane] + i * b->stride[plane], w * bytes)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Image format and bit depth.
+typedef std::tuple<aom_img_fmt_t, int> GrainSynthesisParam;
+
+class GrainSynthesisMTTest
+    : public ::testing::TestWithParam<GrainSynthesisParam> {
+ protected:
+  void SetUp() override {
+    const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+    for (int i = 0; i < kNumWorkers; ++i) {
+      winterface->init(&workers_[i]);
+      ASSERT_TRUE(winterface->reset(&workers_[i]));
+    }
+  }
+
+  void TearDown() override {
+    const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+    for (int i = 0; i < kNumWorkers; ++i) winterface->end(&workers_[i]);
+  }
+
+  AVxWorker workers_[kNumWorkers];
+};
+
+// The grain added by several workers must match the single-threaded result.
+TEST_P(GrainSynthesisMTTest, MatchesSingleThreaded) {
+  const aom_img_fmt_t fmt = GET_PARAM(0);
+  const int bit_depth = GET_PARAM(1);
+  // Five rows of luma grain blocks, the last of which is partial.
+  const int kWidth = 200;
+  const int kHeight = 146;
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+
+  aom_image_t *const src = aom_img_alloc(nullptr, fmt, kWidth, kHeight, 32);
+  aom_image_t *const dst_ref = aom_img_alloc(nullptr, fmt, kWidth, kHeight, 32);
+  aom_image_t *const dst = aom_img_alloc(nullptr, fmt, kWidth, kHeight, 32);
+  ASSERT_NE(src, nullptr);
+  ASSERT_NE(dst_ref, nullptr);
+  ASSERT_NE(dst, nullptr);
+  src->bit_depth = bit_depth;
+  src->mc = AOM_CICP_MC_BT_709;
+
+  for (size_t i = 0; i < sizeof(film_grain_test_vectors) /
+                             sizeof(film_grain_test_vectors[0]);
+       ++i) {
+    for (int overlap = 0; overlap <= 1; ++overlap) {
+      aom_film_grain_t params = film_grain_test_vectors[i];
+      params.bit_depth = bit_depth;
+      params.overlap_flag = overlap;
+      FillImage(src, &rnd);
+      ASSERT_EQ(av1_add_film_grain_mt(&params, src, dst_ref, nullptr, 0), 0);
+      for (int num_workers = 1; num_workers <= kNumWorkers; ++num_workers) {
+        ASSERT_EQ(
+            av1_add_film_grain_mt(&params, src, dst, workers_, num_workers), 0);
+        ASSERT_TRUE(ImagesEqual(dst_ref, dst))
+            << "vector " << i << " overlap " << overlap << " workers "
+            << num_workers;
+      }
+    }
+  }
+
+  aom_img_free(src);
+  aom_img_free(dst_ref);
+  aom_img_free(dst);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    AV1, GrainSynthesisMTTest,
+    ::testing::Values(std::make_tuple(AOM_IMG_FMT_I420, 8),
+                      std::make_tuple(AOM_IMG_FMT_I422, 8),
+                      std::make_tuple(AOM_IMG_FMT_I444, 8),
+                      std::make_tuple(AOM_IMG_FMT_I42016, 10),
+                      std::make_tuple(AOM_IMG_FMT_I44416, 12)));
+
+typedef void (*AddGrainLumaFunc)(uint8_t *luma, int luma_stride,
+                                 const int *grain, int grain_stride, int width,
+                                 int height, const int *scaling_lut,
+                                 int scaling_shift, int min_val, int max_val);
+typedef void (*AddGrainChromaFunc)(uint8_t *chroma, int chroma_stride,
+                                   const uint8_t *luma, int luma_stride,
+                                   const int *grain, int grain_stride,
+                                   int width, int height, int subsampling_x,
+                                   int subsampling_y, const int *scaling_lut,
+                                   int luma_mult, int chroma_mult, int offset,
+                                   int scaling_shift, int min_val, int max_val);
+typedef void (*HighbdAddGrainLumaFunc)(uint16_t *luma, int luma_stride,
+                                       const int *grain, int grain_stride,
+                                       int width, int height,
+                                       const int *scaling_lut,
+                                       int scaling_shift, int min_val,
+                                       int max_val);
+typedef void (*HighbdAddGrainChromaFunc)(
+    uint16_t *chroma, int chroma_stride, const uint16_t *luma, int luma_stride,
+    const int *grain, int grain_stride, int width, int height,
+    int subsampling_x, int subsampling_y, const int *scaling_lut,
+    int luma_mult, int chroma_mult, int offset, int scaling_shift,
+    int min_val, int max_val, int bd);
+
+typedef std::tuple<AddGrainLumaFunc, AddGrainChromaFunc,
+                   HighbdAddGrainLumaFunc, HighbdAddGrainChromaFunc>
+    AddGrainFuncs;
+
+// Compares the noise kernels against their C versions with random samples,
+// grain, scaling functions and chroma scaling parameters.
+class AddFilmGrainTest : public ::testing::TestWithParam<AddGrainFuncs> {
+ protected:
+  static const int kSize = 72;
+  static const int kIterations = 2000;
+
+  void SetUp() override { rnd_.Reset(ACMRandom::DeterministicSeed()); }
+
+  // Sets up a random block configuration for the given bit depth.
+  void RandomizeBlock(int bit_depth) {
+    const int max_val = (1 << bit_depth) - 1;
+    const int grain_center = 128 << (bit_depth - 8);
+    width_ = rnd_.PseudoUniform(41);
+    height_ = rnd_.PseudoUniform(35);
+    subsampling_x_ = rnd_.PseudoUniform(2);
+    subsampling_y_ = subsampling_x_ ? rnd_.PseudoUniform(2) : 0;
+    scaling_shift_ = 8 + rnd_.PseudoUniform(4);
+    if (rnd_.PseudoUniform(2)) {
+      min_val_ = 16 << (bit_depth - 8);
+      max_val_ = 235 << (bit_depth - 8);
+    } else {
+      min_val_ = 0;
+      max_val_ = max_val;
+    }
+    luma_mult_ = rnd_.PseudoUniform(256) - 128;
+    chroma_mult_ = rnd_.PseudoUniform(256) - 128;
+    offset_ = (rnd_.PseudoUniform(512) << (bit_depth - 8)) - (1 << bit_depth);
+    for (int i = 0; i < (256 << (bit_depth - 8)); ++i) {
+      scaling_lut_[i] = rnd_.Rand8();
+    }
+    for (int i = 0; i < kSize * kSize; ++i) {
+      grain_[i] = rnd_.PseudoUniform(2 * grain_center) - grain_center;
+      luma8_[i] = rnd_.Rand8();
+      ref8_[i] = out8_[i] = rnd_.Rand8();
+      luma16_[i] = rnd_.Rand16() & max_val;
+      ref16_[i] = out16_[i] = rnd_.Rand16() & max_val;
+    }
+  }
+
+  ACMRandom rnd_;
+  int width_, height_;
+  int subsampling_x_, subsampling_y_;
+  int scaling_shift_;
+  int min_val_, max_val_;
+  int luma_mult_, chroma_mult_, offset_;
+  int scaling_lut_[256 << 4];
+  int grain_[kSize * kSize];
+  uint8_t luma8_[kSize * kSize];
+  uint8_t ref8_[kSize * kSize];
+  uint8_t out8_[kSize * kSize];
+  uint16_t luma16_[kSize * kSize];
+  uint16_t ref16_[kSize * kSize];
+  uint16_t out16_[kSize * kSize];
+};
+GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(AddFilmGrainTest);
+
+TEST_P(AddFilmGrainTest, Lowbd) {
+  const AddGrainLumaFunc luma_func = std::get<0>(GetParam());
+  const AddGrainChromaFunc chroma_func = std::get<1>(GetParam());
+  for (int iter = 0; iter < kIterations; ++iter) {
+    RandomizeBlock(8);
+    if (iter & 1) {
+      av1_add_film_grain_chroma_c(
+          ref8_, kSize, luma8_, kSize, grain_, kSize, width_, height_,
+          subsampling_x_, subsampling_y_, scaling_lut_, luma_mult_,
+          chroma_mult_, offset_, scaling_shift_, min_val_, max_val_);
+      chroma_func(out8_, kSize, luma8_, kSize, grain_, kSize, width_, height_,
+                  subsampling_x_, subsampling_y_, scaling_lut_, luma_mult_,
+                  chroma_mult_, offset_, scaling_shift_, min_val_, max_val_);
+    } else {
+      av1_add_film_grain_luma_c(ref8_, kSize, grain_, kSize, width_, height_,
+                                scaling_lut_, scaling_shift_, min_val_,
+                                max_val_);
+      luma_func(out8_, kSize, grain_, kSize, width_, height_, scaling_lut_,
+                scaling_shift_, min_val_, max_val_);
+    }
+    ASSERT_EQ(memcmp(ref8_, out8_, sizeof(ref8_)), 0)
+        << "iteration " << iter << " width " << width_ << " height "
+        << height_;
+  }
+}
+
+TEST_P(AddFilmGrainTest, Highbd) {
+  const HighbdAddGrainLumaFunc luma_func = std::get<2>(GetParam());
+  const HighbdAddGrainChromaFunc chroma_func = std::get<3>(GetParam());
+  for (int iter = 0; iter < kIterations; ++iter) {
+    const int bit_depth = (iter >> 1) % 3 == 0 ? 12 : 10;
+    RandomizeBlock(bit_depth);
+    if (iter & 1) {
+      av1_highbd_add_film_grain_chroma_c(
+          ref16_, kSize, luma16_, kSize, grain_, kSize, width_, height_,
+          subsampling_x_, subsampling_y_, scaling_lut_, luma_mult_,
+          chroma_mult_, offset_, scaling_shift_, min_val_, max_val_,
+          bit_depth);
+      chroma_func(out16_, kSize, luma16_, kSize, grain_, kSize, width_,
+                  height_, subsampling_x_, subsampling_y_, scaling_lut_,
+                  luma_mult_, chroma_mult_, offset_, scaling_shift_, min_val_,
+                  max_val_, bit_depth);
+    } else {
+      av1_highbd_add_film_grain_luma_c(ref16_, kSize, grain_, kSize, width_,
+                                       height_, scaling_lut_, scaling_shift_,
+                                       min_val_, max_val_);
+      luma_func(out16_, kSize, grain_, kSize, width_, height_, scaling_lut_,
+                scaling_shift_, min_val_, max_val_);
+    }
+    ASSERT_EQ(memcmp(ref16_, out16_, sizeof(ref16_)), 0)
+        << "iteration " << iter << " bit depth " << bit_depth << " width "
+        << width_ << " height " << height_;
+  }
+}
+
+#if HAVE_SSE4_1
+INSTANTIATE_TEST_SUITE_P(
+    SSE4_1, AddFilmGrainTest,
+    ::testing::Values(std::make_tuple(
+        av1_add_film_grain_luma_sse4_1, av1_add_film_grain_chroma_sse4_1,
+        av1_highbd_add_film_grain_luma_sse4_1,
+        av1_highbd_add_film_grain_chroma_sse4_1)));
+#endif  // HAVE_SSE4_1
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_SUITE_P(
+    AVX2, AddFilmGrainTest,
+    ::testing::Values(std::make_tuple(av1_add_film_grain_luma_avx2,
+                                      av1_add_film_grain_chroma_avx2,
+                                      av1_highbd_add_film_grain_luma_avx2,
+                                      av1_highbd_add_film_grain_chroma_avx2)));
+#endif  // HAVE_AVX2
+
+#if HAVE_NEON
+INSTANTIATE_TEST_SUITE_P(
+    NEON, AddFilmGrainTest,
+    ::testing::Values(std::make_tuple(av1_add_film_grain_luma_neon,
+                                      av1_add_film_grain_chroma_neon,
+                                      av1_highbd_add_film_grain_luma_neon,
+                                      av1_highbd_add_film_grain_chroma_neon)));
+#endif  // HAVE_NEON
+
+}  // namespace
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include "av1/encoder/motion_field_cache.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+constexpr int kWidth = 100;
+constexpr int kHeight = 60;
+
+class MotionFieldCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override { av1_motion_field_cache_init(&cache_); }
+  void TearDown() override { av1_motion_field_cache_free(&cache_); }
+
+  MotionFieldCache cache_;
+};
+
+TEST_F(MotionFieldCacheTest, StoreAndLookup) {
+  MotionField *field = av1_motion_field_cache_get(&cache_, kWidth, kHeight,
+                                                  /*src=*/3, /*ref=*/5);
+  ASSERT_NE(field, nullptr);
+  EXPECT_EQ(cache_.cols, 7);
+  EXPECT_EQ(cache_.rows, 4);
+
+  MV mv;
+  uint32_t err;
+  EXPECT_FALSE(
+      av1_motion_field_lookup(&cache_, field, nullptr, 1, 2, &mv, &err));
+
+  const MV stored = { -12, 34 };
+  av1_motion_field_store(&cache_, field, 1, 2, stored, 7);
+  // Blocks outside the field are ignored.
+  av1_motion_field_store(&cache_, field, 4, 0, stored, 7);
+  ASSERT_TRUE(
+      av1_motion_field_lookup(&cache_, field, nullptr, 1, 2, &mv, &err));
+  EXPECT_EQ(mv.row, stored.row);
+  EXPECT_EQ(mv.col, stored.col);
+  EXPECT_EQ(err, 7u);
+  EXPECT_FALSE(
+      av1_motion_field_lookup(&cache_, field, nullptr, 4, 0, &mv, &err));
+
+  // The same field is returned for the same pair, with its blocks.
+  EXPECT_EQ(av1_motion_field_cache_get(&cache_, kWidth, kHeight, 3, 5), field);
+  EXPECT_EQ(av1_motion_field_cache_find(&cache_, kWidth, kHeight, 3, 5), field);
+  EXPECT_EQ(av1_motion_field_cache_find(&cache_, kWidth, kHeight, 5, 3),
+            nullptr);
+  ASSERT_TRUE(
+      av1_motion_field_lookup(&cache_, field, nullptr, 1, 2, &mv, &err));
+
+  // The reverse pair negates the motion.
+  const MotionField *reverse =
+      av1_motion_field_cache_find(&cache_, kWidth, kHeight, 3, 5);
+  ASSERT_TRUE(
+      av1_motion_field_lookup(&cache_, nullptr, reverse, 1, 2, &mv, &err));
+  EXPECT_EQ(mv.row, -stored.row);
+  EXPECT_EQ(mv.col, -stored.col);
+  EXPECT_EQ(err, 7u);
+
+  // The fields are dropped when the frame dimensions change.
+  EXPECT_EQ(av1_motion_field_cache_find(&cache_, 2 * kWidth, kHeight, 3, 5),
+            nullptr);
+  field = av1_motion_field_cache_get(&cache_, 2 * kWidth, kHeight, 1, 2);
+  ASSERT_NE(field, nullptr);
+  EXPECT_EQ(av1_motion_field_cache_find(&cache_, 2 * kWidth, kHeight, 3, 5),
+            nullptr);
+}
+
+TEST_F(MotionFieldCacheTest, ReplacesLeastRecentlyUsed) {
+  const MV stored = { 1, 2 };
+  for (int i = 0; i < MOTION_FIELD_CACHE_SIZE; ++i) {
+    MotionField *field =
+        av1_motion_field_cache_get(&cache_, kWidth, kHeight, i, i + 1);
+    ASSERT_NE(field, nullptr);
+    av1_motion_field_store(&cache_, field, 0, 0, stored, 1);
+  }
+  // Use the first pair again, so that the second one is the least recently
+  // used.
+  ASSERT_NE(av1_motion_field_cache_get(&cache_, kWidth, kHeight, 0, 1),
+            nullptr);
+  MotionField *field = av1_motion_field_cache_get(
+      &cache_, kWidth, kHeight, MOTION_FIELD_CACHE_SIZE, 0);
+  ASSERT_NE(field, nullptr);
+  EXPECT_EQ(av1_motion_field_cache_find(&cache_, kWidth, kHeight, 1, 2),
+            nullptr);
+  EXPECT_NE(av1_motion_field_cache_find(&cache_, kWidth, kHeight, 0, 1),
+            nullptr);
+
+  // The blocks of the replaced field are invalid.
+  MV mv;
+  uint32_t err;
+  for (int row = 0; row < cache_.rows; ++row) {
+    for (int col = 0; col < cache_.cols; ++col) {
+      EXPECT_FALSE(av1_motion_field_lookup(&cache_, field, nullptr, row, col,
+                                           &mv, &err));
+    }
+  }
+}
+
+}  // namespace
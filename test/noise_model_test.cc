@@ -1376,3 +1376,130 @@ REGISTER_TYPED_TEST_SUITE_P(WienerDenoiseTest, InvalidBlockSize,
 // requirement.
 INSTANTIATE_TYPED_TEST_SUITE_P(WienerDenoiseTestInstatiation, WienerDenoiseTest,
                                AllBitDepthParams, );
+
+template <typename T>
+class DenoiseAndModelMTTest : public ::testing::Test, public T {
+ public:
+  static void SetUpTestSuite() { aom_dsp_rtcd(); }
+
+ protected:
+  static const int kNumWorkers = 3;
+  static const int kBlockSize = 32;
+  // Not a multiple of the block size, so that the last row and column of
+  // blocks are partial.
+  static const int kWidth = 200;
+  static const int kHeight = 146;
+
+  void SetUp() override {
+    const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+    for (int i = 0; i < kNumWorkers; ++i) {
+      winterface->init(&workers_[i]);
+      ASSERT_TRUE(winterface->reset(&workers_[i]));
+    }
+    for (int i = 0; i < 2; ++i) {
+      memset(&frames_[i], 0, sizeof(frames_[i]));
+      ASSERT_EQ(aom_alloc_frame_buffer(&frames_[i], kWidth, kHeight, 1, 1,
+                                       T::kUseHighBD, 32, 32, false, 0),
+                0);
+    }
+  }
+
+  void TearDown() override {
+    const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+    for (int i = 0; i < kNumWorkers; ++i) winterface->end(&workers_[i]);
+    for (int i = 0; i < 2; ++i) aom_free_frame_buffer(&frames_[i]);
+  }
+
+  // Fills both frames with the same noisy gradient.
+  void FillFrames(libaom_test::ACMRandom *random) {
+    const int max_value = (1 << T::kBitDepth) - 1;
+    const int scale = 1 << (T::kBitDepth - 8);
+    for (int plane = 0; plane < 3; ++plane) {
+      const int w = plane ? frames_[0].uv_crop_width : frames_[0].y_crop_width;
+      const int h =
+          plane ? frames_[0].uv_crop_height : frames_[0].y_crop_height;
+      for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+          const int value = std::min(
+              std::max((x + y) * scale + (int)randn(random, 4 * scale), 0),
+              max_value);
+          for (int i = 0; i < 2; ++i) {
+            const int stride = frames_[i].strides[plane > 0];
+            if (T::kUseHighBD) {
+              CONVERT_TO_SHORTPTR(frames_[i].buffers[plane])
+              [y * stride + x] = value;
+            } else {
+              frames_[i].buffers[plane][y * stride + x] = (uint8_t)value;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  bool FramesEqual() const {
+    const int bytes = T::kUseHighBD ? 2 : 1;
+    for (int plane = 0; plane < 3; ++plane) {
+      const int w = plane ? frames_[0].uv_crop_width : frames_[0].y_crop_width;
+      const int h =
+          plane ? frames_[0].uv_crop_height : frames_[0].y_crop_height;
+      const int stride = frames_[0].strides[plane > 0];
+      const uint8_t *a = frames_[0].buffers[plane];
+      const uint8_t *b = frames_[1].buffers[plane];
+      if (T::kUseHighBD) {
+        a = reinterpret_cast<uint8_t *>(CONVERT_TO_SHORTPTR(a));
+        b = reinterpret_cast<uint8_t *>(CONVERT_TO_SHORTPTR(b));
+      }
+      for (int y = 0; y < h; ++y) {
+        if (memcmp(a + y * stride * bytes, b + y * stride * bytes,
+                   w * bytes)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  AVxWorker workers_[kNumWorkers];
+  YV12_BUFFER_CONFIG frames_[2];
+};
+
+TYPED_TEST_SUITE_P(DenoiseAndModelMTTest);
+
+// The denoised frames and the grain parameters estimated with several workers
+// must match the single-threaded results.
+TYPED_TEST_P(DenoiseAndModelMTTest, MatchesSingleThreaded) {
+  libaom_test::ACMRandom random;
+  for (int num_workers = 1; num_workers <= this->kNumWorkers; ++num_workers) {
+    aom_denoise_and_model_t *const ref_ctx = aom_denoise_and_model_alloc(
+        TypeParam::kBitDepth, this->kBlockSize, 4.f);
+    aom_denoise_and_model_t *const ctx = aom_denoise_and_model_alloc(
+        TypeParam::kBitDepth, this->kBlockSize, 4.f);
+    ASSERT_NE(ref_ctx, nullptr);
+    ASSERT_NE(ctx, nullptr);
+    // The noise model of the second frame depends on that of the first.
+    for (int frame = 0; frame < 2; ++frame) {
+      this->FillFrames(&random);
+      aom_film_grain_t ref_grain;
+      aom_film_grain_t grain;
+      memset(&ref_grain, 0, sizeof(ref_grain));
+      memset(&grain, 0, sizeof(grain));
+      const int ref_ret = aom_denoise_and_model_run(ref_ctx, &this->frames_[0],
+                                                    &ref_grain, 1);
+      const int ret = aom_denoise_and_model_run_mt(
+          ctx, &this->frames_[1], &grain, 1, this->workers_, num_workers);
+      EXPECT_EQ(ref_ret, ret);
+      EXPECT_EQ(memcmp(&ref_grain, &grain, sizeof(grain)), 0)
+          << "frame " << frame << " workers " << num_workers;
+      EXPECT_TRUE(this->FramesEqual())
+          << "frame " << frame << " workers " << num_workers;
+    }
+    aom_denoise_and_model_free(ref_ctx);
+    aom_denoise_and_model_free(ctx);
+  }
+}
+
+REGISTER_TYPED_TEST_SUITE_P(DenoiseAndModelMTTest, MatchesSingleThreaded);
+
+INSTANTIATE_TYPED_TEST_SUITE_P(DenoiseAndModelMTTestInstatiation,
+                               DenoiseAndModelMTTest, AllBitDepthParams, );
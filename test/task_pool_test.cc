@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <atomic>
+
+#include "config/aom_config.h"
+
+#include "aom/internal/aom_codec_internal.h"
+#include "aom_util/aom_thread.h"
+#include "av1/encoder/task_pool.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+const int kNumWorkers = 4;
+const int kRows = 12;
+const int kCols = 20;
+
+struct WavefrontTask {
+  AV1Task task;
+  // Tasks this one depends on, or nullptr.
+  const WavefrontTask *left;
+  const WavefrontTask *above_right;
+  std::atomic<int> done;
+  std::atomic<int> num_runs;
+  // Set if the task ran before one of its dependencies finished.
+  std::atomic<int> out_of_order;
+  bool fail;
+};
+
+void WavefrontTaskFunc(void *arg, void *worker_data,
+                       struct aom_internal_error_info *error_info) {
+  WavefrontTask *const task = static_cast<WavefrontTask *>(arg);
+  std::atomic<int> *const num_tasks_run =
+      static_cast<std::atomic<int> *>(worker_data);
+  if ((task->left != nullptr && !task->left->done) ||
+      (task->above_right != nullptr && !task->above_right->done)) {
+    task->out_of_order = 1;
+  }
+  if (task->fail) {
+    aom_internal_error(error_info, AOM_CODEC_ERROR, "Task failed");
+  }
+  ++task->num_runs;
+  ++*num_tasks_run;
+  task->done = 1;
+}
+
+struct RunData {
+  AV1TaskPool *pool;
+  int worker_id;
+  std::atomic<int> *num_tasks_run;
+  struct aom_internal_error_info error_info;
+};
+
+int RunHook(void *arg1, void *arg2) {
+  (void)arg2;
+  RunData *const data = static_cast<RunData *>(arg1);
+  return av1_task_pool_run(data->pool, data->worker_id, data->num_tasks_run,
+                           &data->error_info);
+}
+
+class TaskPoolTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_EQ(av1_task_pool_alloc(&pool_, kNumWorkers), 1);
+    ASSERT_EQ(av1_task_pool_reserve(&pool_, kRows * kCols), 1);
+    const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+    for (int i = 0; i < kNumWorkers; ++i) {
+      winterface->init(&workers_[i]);
+      ASSERT_TRUE(winterface->reset(&workers_[i]));
+    }
+  }
+
+  void TearDown() override {
+    const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+    for (int i = 0; i < kNumWorkers; ++i) winterface->end(&workers_[i]);
+    av1_task_pool_dealloc(&pool_);
+  }
+
+  // Submits a wavefront of tasks where each task depends on its left and
+  // above-right neighbors, as in superblock row multi-threading.
+  void SubmitWavefront(int fail_row, int fail_col) {
+    av1_task_pool_reset(&pool_);
+    for (int r = 0; r < kRows; ++r) {
+      for (int c = 0; c < kCols; ++c) {
+        WavefrontTask *const task = &tasks_[r][c];
+        av1_task_init(&task->task, WavefrontTaskFunc, task);
+        task->left = nullptr;
+        task->above_right = nullptr;
+        task->done = 0;
+        task->num_runs = 0;
+        task->out_of_order = 0;
+        task->fail = r == fail_row && c == fail_col;
+        if (c > 0) {
+          task->left = &tasks_[r][c - 1];
+          av1_task_add_dependency(&tasks_[r][c - 1].task, &task->task);
+        }
+        if (r > 0 && c + 1 < kCols) {
+          task->above_right = &tasks_[r - 1][c + 1];
+          av1_task_add_dependency(&tasks_[r - 1][c + 1].task, &task->task);
+        }
+      }
+    }
+    for (int r = 0; r < kRows; ++r) {
+      for (int c = 0; c < kCols; ++c) {
+        av1_task_pool_submit(&pool_, &tasks_[r][c].task);
+      }
+    }
+  }
+
+  // Runs the submitted tasks on all the workers and returns the number of
+  // workers that reported an error.
+  int Run() {
+    const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+    num_tasks_run_ = 0;
+    for (int i = kNumWorkers - 1; i >= 0; --i) {
+      run_data_[i].pool = &pool_;
+      run_data_[i].worker_id = i;
+      run_data_[i].num_tasks_run = &num_tasks_run_;
+      run_data_[i].error_info = {};
+      workers_[i].hook = RunHook;
+      workers_[i].data1 = &run_data_[i];
+      workers_[i].data2 = nullptr;
+      workers_[i].had_error = 0;
+      if (i == 0) {
+        winterface->execute(&workers_[i]);
+      } else {
+        winterface->launch(&workers_[i]);
+      }
+    }
+    int num_errors = workers_[0].had_error;
+    for (int i = 1; i < kNumWorkers; ++i) {
+      if (!winterface->sync(&workers_[i])) ++num_errors;
+    }
+    return num_errors;
+  }
+
+  AV1TaskPool pool_;
+  AVxWorker workers_[kNumWorkers];
+  RunData run_data_[kNumWorkers];
+  WavefrontTask tasks_[kRows][kCols];
+  std::atomic<int> num_tasks_run_;
+};
+
+TEST_F(TaskPoolTest, Wavefront) {
+  for (int iter = 0; iter < 20; ++iter) {
+    SubmitWavefront(-1, -1);
+    ASSERT_EQ(Run(), 0);
+    EXPECT_EQ(num_tasks_run_, kRows * kCols);
+    for (int r = 0; r < kRows; ++r) {
+      for (int c = 0; c < kCols; ++c) {
+        EXPECT_EQ(tasks_[r][c].num_runs, 1) << r << "," << c;
+        EXPECT_EQ(tasks_[r][c].out_of_order, 0) << r << "," << c;
+      }
+    }
+  }
+}
+
+TEST_F(TaskPoolTest, ErrorAbortsRun) {
+  SubmitWavefront(kRows / 2, kCols / 2);
+  ASSERT_EQ(Run(), 1);
+  // Tasks depending on the failed one never run.
+  EXPECT_EQ(tasks_[kRows / 2][kCols / 2].num_runs, 0);
+  EXPECT_EQ(tasks_[kRows - 1][kCols - 1].num_runs, 0);
+  EXPECT_LT(num_tasks_run_, kRows * kCols);
+
+  // The pool can be reused after an error.
+  SubmitWavefront(-1, -1);
+  ASSERT_EQ(Run(), 0);
+  EXPECT_EQ(num_tasks_run_, kRows * kCols);
+}
+
+}  // namespace
@@ -261,6 +261,62 @@ TEST(Y4MHeaderTest, FullRangeHeader) {
   y4m_input_close(&y4m);
 }
 
+// Two 4x4 frames, the second with a frame parameter.
+static const char kY4MTwoFrames[] =
+    "YUV4MPEG2 W4 H4 F30:1 Ip A0:0 C420jpeg\n"
+    "FRAME\n"
+    "012345678912345601230123"
+    "FRAME Ip\n"
+    "abcdefghijklmnopqrstuvwx";
+
+TEST(Y4MReferenceTest, MatchesFetchFrame) {
+  libaom_test::TempOutFile tmpfile;
+  FILE *f = tmpfile.file();
+  ASSERT_NE(f, nullptr);
+  // Leave out the terminating nul.
+  fwrite(kY4MTwoFrames, 1, sizeof(kY4MTwoFrames) - 1, f);
+  fflush(f);
+  EXPECT_EQ(fseek(f, 0, 0), 0);
+
+  y4m_input y4m;
+  ASSERT_EQ(y4m_input_open(&y4m, f, nullptr, 0, AOM_CSP_UNKNOWN,
+                           /*only_420=*/1),
+            0);
+  EXPECT_EQ(y4m_input_can_reference(&y4m), 1);
+  const long header_end = ftell(f);
+  const unsigned char *data =
+      reinterpret_cast<const unsigned char *>(kY4MTwoFrames) + header_end;
+  size_t size = sizeof(kY4MTwoFrames) - 1 - header_end;
+
+  for (int frame = 0; frame < 2; ++frame) {
+    aom_image_t fetched, referenced;
+    ASSERT_EQ(y4m_input_fetch_frame(&y4m, f, &fetched), 1);
+    const size_t frame_size =
+        y4m_input_reference_frame(&y4m, data, size, &referenced);
+    ASSERT_GT(frame_size, 0u);
+    EXPECT_EQ(referenced.fmt, fetched.fmt);
+    EXPECT_EQ(referenced.d_w, fetched.d_w);
+    EXPECT_EQ(referenced.d_h, fetched.d_h);
+    for (int plane = 0; plane < 3; ++plane) {
+      EXPECT_EQ(referenced.stride[plane], fetched.stride[plane]);
+      const int h = plane ? 2 : 4;
+      for (int r = 0; r < h; ++r) {
+        EXPECT_EQ(memcmp(referenced.planes[plane] +
+                             r * referenced.stride[plane],
+                         fetched.planes[plane] + r * fetched.stride[plane],
+                         referenced.stride[plane]),
+                  0);
+      }
+    }
+    data += frame_size;
+    size -= frame_size;
+  }
+  EXPECT_EQ(size, 0u);
+  aom_image_t img;
+  EXPECT_EQ(y4m_input_reference_frame(&y4m, data, size, &img), 0u);
+  y4m_input_close(&y4m);
+}
+
 TEST(Y4MHeaderTest, WriteStudioColorRange) {
   char buf[128];
   struct AvxRational framerate = { /*numerator=*/30, /*denominator=*/1 };